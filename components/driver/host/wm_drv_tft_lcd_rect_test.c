@@ -0,0 +1,233 @@
+/**
+ * @file wm_drv_tft_lcd_rect_test.c
+ *
+ * @brief TFT LCD Partial Refresh Rectangle Merge Host Test
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wm_drv_tft_lcd_rect.h"
+
+#define TEST_X_RES      320
+#define TEST_Y_RES      240
+#define TEST_PIXEL_SIZE 2 /* RGB565 */
+#define TEST_FRAMES     200
+#define TEST_MAX_RECTS  8
+#define TEST_RECTS_MAX  16
+
+static uint8_t g_dirty[TEST_Y_RES][TEST_X_RES];
+static int g_fail;
+
+static void test_report(const char *name, int ok, const char *detail)
+{
+    printf("%-24s %s %s\n", name, ok ? "PASS" : "FAIL", detail);
+    g_fail += !ok;
+}
+
+static wm_lcd_rect_t test_rect(int x, int y, int w, int h)
+{
+    wm_lcd_rect_t r;
+
+    r.x1 = x;
+    r.y1 = y;
+    r.x2 = x + w - 1 < TEST_X_RES ? x + w - 1 : TEST_X_RES - 1;
+    r.y2 = y + h - 1 < TEST_Y_RES ? y + h - 1 : TEST_Y_RES - 1;
+
+    return r;
+}
+
+static void test_mark(const wm_lcd_rect_t *r)
+{
+    int y;
+
+    for (y = r->y1; y <= r->y2; y++) {
+        memset(&g_dirty[y][r->x1], 1, r->x2 - r->x1 + 1);
+    }
+}
+
+/* Every dirty pixel is sent, the list is in bounds and sorted top to bottom */
+static int test_check(const wm_lcd_rect_t *rects, int num, int max_rects, uint32_t *dirty)
+{
+    int i, x, y;
+
+    if (num < 1 || num > max_rects) {
+        return 0;
+    }
+
+    for (i = 0; i < num; i++) {
+        if (rects[i].x1 > rects[i].x2 || rects[i].y1 > rects[i].y2 || rects[i].x2 >= TEST_X_RES ||
+            rects[i].y2 >= TEST_Y_RES || (i > 0 && rects[i - 1].y1 > rects[i].y1)) {
+            return 0;
+        }
+    }
+
+    *dirty = 0;
+    for (y = 0; y < TEST_Y_RES; y++) {
+        for (x = 0; x < TEST_X_RES; x++) {
+            if (!g_dirty[y][x]) {
+                continue;
+            }
+            (*dirty)++;
+            for (i = 0; i < num; i++) {
+                if (x >= rects[i].x1 && x <= rects[i].x2 && y >= rects[i].y1 && y <= rects[i].y2) {
+                    break;
+                }
+            }
+            if (i == num) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* A frame with a few small updates: a moving sprite, a clock, random widgets */
+static int test_frame(int frame, wm_lcd_rect_t *rects, int max_rects, int merge_percent)
+{
+    wm_lcd_rect_t r;
+    int num = 0;
+    int n, i;
+
+    memset(g_dirty, 0, sizeof(g_dirty));
+
+    /* sprite moving across the screen, its old and new position are dirty */
+    r   = test_rect((frame * 3) % (TEST_X_RES - 32), 100, 32, 32);
+    num = wm_lcd_rect_add(rects, num, max_rects, merge_percent, r);
+    test_mark(&r);
+    r   = test_rect((frame * 3 + 3) % (TEST_X_RES - 32), 100, 32, 32);
+    num = wm_lcd_rect_add(rects, num, max_rects, merge_percent, r);
+    test_mark(&r);
+
+    /* clock digits in the corner */
+    if (frame % 10 == 0) {
+        r   = test_rect(260, 4, 56, 16);
+        num = wm_lcd_rect_add(rects, num, max_rects, merge_percent, r);
+        test_mark(&r);
+    }
+
+    n = rand() % 4;
+    for (i = 0; i < n; i++) {
+        r   = test_rect(rand() % TEST_X_RES, rand() % TEST_Y_RES, 4 + rand() % 40, 4 + rand() % 24);
+        num = wm_lcd_rect_add(rects, num, max_rects, merge_percent, r);
+        test_mark(&r);
+    }
+
+    wm_lcd_rect_sort(rects, num);
+
+    return num;
+}
+
+static void test_simulation(int max_rects, int merge_percent)
+{
+    wm_lcd_rect_t rects[TEST_RECTS_MAX];
+    uint64_t sent_bytes  = 0;
+    uint64_t dirty_bytes = 0;
+    uint64_t full_bytes  = (uint64_t)TEST_X_RES * TEST_Y_RES * TEST_PIXEL_SIZE * TEST_FRAMES;
+    uint32_t dirty       = 0;
+    char name[32];
+    char detail[128];
+    int ok = 1;
+    int frame, num, i;
+
+    srand(1);
+    for (frame = 0; frame < TEST_FRAMES && ok; frame++) {
+        num = test_frame(frame, rects, max_rects, merge_percent);
+        ok  = test_check(rects, num, max_rects, &dirty);
+        for (i = 0; i < num; i++) {
+            sent_bytes += wm_lcd_rect_area(&rects[i]) * TEST_PIXEL_SIZE;
+        }
+        dirty_bytes += (uint64_t)dirty * TEST_PIXEL_SIZE;
+    }
+
+    /* merging only adds clean pixels, yet far less than full frames are sent */
+    ok &= sent_bytes >= dirty_bytes && sent_bytes * 4 < full_bytes;
+
+    snprintf(name, sizeof(name), "sim %d rects %d%%", max_rects, merge_percent);
+    snprintf(detail, sizeof(detail), "%d frames, sent %llu KB, dirty %llu KB, full frames %llu KB", TEST_FRAMES,
+             (unsigned long long)(sent_bytes / 1024), (unsigned long long)(dirty_bytes / 1024),
+             (unsigned long long)(full_bytes / 1024));
+    test_report(name, ok, detail);
+}
+
+static void test_cases(void)
+{
+    wm_lcd_rect_t rects[TEST_RECTS_MAX];
+    wm_lcd_rect_t r;
+    int num;
+    int ok;
+
+    /* side by side rectangles add no clean pixel and become one */
+    num = wm_lcd_rect_add(rects, 0, TEST_MAX_RECTS, 0, test_rect(10, 10, 20, 10));
+    num = wm_lcd_rect_add(rects, num, TEST_MAX_RECTS, 0, test_rect(30, 10, 20, 10));
+    ok  = num == 1 && rects[0].x1 == 10 && rects[0].x2 == 49 && rects[0].y1 == 10 && rects[0].y2 == 19;
+    test_report("adjacent", ok, "merged without waste");
+
+    /* a contained rectangle disappears */
+    num = wm_lcd_rect_add(rects, 0, TEST_MAX_RECTS, 0, test_rect(0, 0, 100, 100));
+    num = wm_lcd_rect_add(rects, num, TEST_MAX_RECTS, 0, test_rect(20, 20, 10, 10));
+    ok  = num == 1 && wm_lcd_rect_area(&rects[0]) == 100 * 100;
+    test_report("contained", ok, "absorbed");
+
+    /* far apart rectangles stay apart below the threshold */
+    num = wm_lcd_rect_add(rects, 0, TEST_MAX_RECTS, 25, test_rect(0, 0, 10, 10));
+    num = wm_lcd_rect_add(rects, num, TEST_MAX_RECTS, 25, test_rect(300, 200, 10, 10));
+    test_report("far apart", num == 2, "kept apart");
+
+    /* a growing rectangle reaches a second neighbour and takes it in as well */
+    num = wm_lcd_rect_add(rects, 0, TEST_MAX_RECTS, 10, test_rect(0, 0, 10, 10));
+    num = wm_lcd_rect_add(rects, num, TEST_MAX_RECTS, 10, test_rect(20, 0, 10, 10));
+    num = wm_lcd_rect_add(rects, num, TEST_MAX_RECTS, 10, test_rect(10, 0, 10, 10));
+    ok  = num == 1 && rects[0].x1 == 0 && rects[0].x2 == 29;
+    test_report("cascade", ok, "merged into one");
+
+    /* with a single slot everything ends in the bounding box */
+    num = wm_lcd_rect_add(rects, 0, 1, 0, test_rect(5, 50, 10, 10));
+    num = wm_lcd_rect_add(rects, num, 1, 0, test_rect(200, 7, 10, 10));
+    num = wm_lcd_rect_add(rects, num, 1, 0, test_rect(100, 230, 10, 10));
+    r   = rects[0];
+    ok  = num == 1 && r.x1 == 5 && r.y1 == 7 && r.x2 == 209 && r.y2 == 239;
+    test_report("max_rects 1", ok, "bounding box");
+
+    /* sorting keeps the rectangles and orders them by their top row */
+    rects[0] = test_rect(0, 90, 5, 5);
+    rects[1] = test_rect(0, 10, 5, 5);
+    rects[2] = test_rect(0, 50, 5, 5);
+    wm_lcd_rect_sort(rects, 3);
+    ok = rects[0].y1 == 10 && rects[1].y1 == 50 && rects[2].y1 == 90;
+    test_report("sort", ok, "top to bottom");
+}
+
+int main(void)
+{
+    test_cases();
+
+    test_simulation(TEST_MAX_RECTS, 25);
+    test_simulation(TEST_MAX_RECTS, 0);
+    test_simulation(TEST_MAX_RECTS, 100);
+    test_simulation(1, 25);
+    test_simulation(TEST_RECTS_MAX, 25);
+
+    printf("%s\n", g_fail ? "FAILED" : "ALL PASSED");
+
+    return g_fail ? 1 : 0;
+}
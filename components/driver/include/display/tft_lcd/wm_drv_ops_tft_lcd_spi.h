@@ -137,7 +137,10 @@ typedef struct {
     wm_tft_lcd_cfg_t panel_cfg;       /**< The LCD configuration which is clone from the hw structure panel_cfg */
     wm_lcd_tx_callback_t tx_done_cb;  /**< Callback function for LCD transmission completion */
     void *usr_data;                   /**< Callback function argument for LCD transmission completion */
-    bool dma_sending;                 /**< Indicates if DMA is running by LCD module, to avoid Async and Async conflicts */
+    bool dma_sending;                 /**< Indicates a DMA is started and its completion is not collected yet */
+    wm_os_sem_t *dma_done_sem;        /**< Released by the DMA ISR, the next SPI access sleeps on it instead of polling */
+    bool tx_bitmap;                   /**< A bitmap is being sent, as opposed to commands and their data */
+    bool dma_notify;                  /**< The DMA in flight ends a bitmap, its completion calls tx_done_cb */
 } wm_drv_tft_lcd_spi_t;
 
 int lcd_io_backlight_on(wm_dt_hw_tft_lcd_spi_t *hw);
@@ -148,8 +151,10 @@ int lcd_io_dcx_stop(wm_dt_hw_tft_lcd_spi_t *hw);
 int lcd_io_reset(wm_dt_hw_tft_lcd_spi_t *hw);
 
 void lcd_spim_callback(int result, void *data);
+void lcd_release_tx(wm_device_t *dev);
 int lcd_send_bytes_with_sdhspi(wm_device_t *dev, uint8_t *buf, int length);
 int lcd_send_data(wm_device_t *dev, uint8_t *buf, int length);
+int lcd_send_bitmap(wm_device_t *dev, uint8_t *buf, int length);
 int lcd_send_command(wm_device_t *dev, uint16_t cmd, wm_lcd_cmd_type_t cmd_type);
 int lcd_init_cmd(wm_device_t *dev, const uint8_t *cmd_table, int size);
 
@@ -49,6 +49,11 @@ extern "C" {
 
 #define WM_ADC_GET_RESULT(value) (value = value & WM_ADC_RESULT_MASK)
 
+/**
+ * @brief ADC max raw conversions averaged into one continuous mode sample
+ */
+#define WM_DRV_ADC_OVERSAMPLE_MAX 64
+
 /**
  * @}
  */
@@ -70,6 +75,17 @@ extern "C" {
 
 typedef void (*wm_drv_adc_callback_t)(uint8_t channel, int *buf, uint16_t len, void *user_data);
 
+/**
+ * @typedef wm_drv_adc_continuous_callback_t
+ * @brief ADC continuous mode callback type, called in the dma interrupt each time half of the ring buffer is filled.
+ *        buf holds len samples of channel in adc result register format, full is false for the first half and true
+ *        for the second half. Hand the half over to a task, e.g. by a queue, and convert it there with
+ *        wm_drv_adc_cal_voltage_bulk(). The half must be consumed before the DMA comes back to it, one half
+ *        buffer time later.
+ */
+typedef void (*wm_drv_adc_continuous_callback_t)(wm_adc_channel_t channel, int *buf, uint32_t len, bool full,
+                                                 void *user_data);
+
 /**
  * @}
  */
@@ -94,6 +110,23 @@ typedef struct {
     wm_dt_hw_adc_cfg_t cfg[0];
 } wm_drv_adc_cfg_t;
 
+/**
+ * @struct wm_drv_adc_continuous_cfg_t
+ * @brief ADC continuous mode cfg type
+ */
+
+typedef struct {
+    const wm_adc_channel_t *scan; /**< channels in scan order, each one is sampled for one half of the ring buffer */
+    uint8_t scan_count;           /**< 1 ~ WM_ADC_MAX_CHANNEL_COUNT, only a single channel is sampled without any gap */
+    int *buf;                     /**< ring buffer, 4 bytes aligned */
+    uint32_t len;                 /**< ring buffer sample count, half of it must be a multiple of oversample */
+    uint8_t oversample;           /**< raw conversions averaged into one sample, 1 ~ WM_DRV_ADC_OVERSAMPLE_MAX,
+                                       the sample rate is the conversion rate divided by it, 1 leaves the
+                                       dma interrupt without any per sample work */
+    wm_drv_adc_continuous_callback_t callback;
+    void *user_data;
+} wm_drv_adc_continuous_cfg_t;
+
 /**
  * @}
  */
@@ -119,7 +152,7 @@ typedef struct {
 wm_device_t *wm_drv_adc_init(char *dev_name);
 
 /**
- * @brief Deinit adc dev.
+ * @brief Deinit adc dev, continuous sampling still running is stopped first.
  *
  * @param [in] dev use @arg wm_device_t 
  * @return
@@ -235,6 +268,46 @@ int wm_drv_adc_chip_voltage_read_vdd(wm_device_t *dev, int *voltage);
  */
 int wm_drv_adc_cal_voltage(wm_device_t *dev, int vol);
 
+/**
+ * @brief Calculate voltage values in place based on register values.
+ *
+ * @param [in] dev use @arg wm_device_t
+ * @param [in,out] buf adc result register values in, unit: millivolt out
+ * @param [in] count value count of buf
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ */
+int wm_drv_adc_cal_voltage_bulk(wm_device_t *dev, int *buf, uint32_t count);
+
+/**
+ * @brief Start adc continuous sampling, the adc fills the ring buffer through a circular dma chain and
+ *        the callback is called for each half of it instead of for each sample.
+ *        Convert the delivered samples with wm_drv_adc_cal_voltage_bulk() in task context.
+ *
+ * @param [in] dev use @arg wm_device_t
+ * @param [in] cfg use @arg wm_drv_adc_continuous_cfg_t, the scan channels must be set by wm_drv_adc_cfg
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ * @note The adc has one converter and no scan sequencer, the dma request follows the channel. A scan of several
+ *       channels is therefore not gap free: each half is a one shot dma transfer of its own, the next channel and
+ *       transfer are started from the dma interrupt of the previous half. The conversions done until then are lost,
+ *       and the first conversions of each half run while the filter settles on the new channel. Only a single
+ *       channel is sampled back to back by one circular dma chain.
+ */
+int wm_drv_adc_start_continuous(wm_device_t *dev, const wm_drv_adc_continuous_cfg_t *cfg);
+
+/**
+ * @brief Stop adc continuous sampling, no callback is called after it returns.
+ *
+ * @param [in] dev use @arg wm_device_t
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ */
+int wm_drv_adc_stop_continuous(wm_device_t *dev);
+
 /**
  * @}
  */
@@ -86,6 +86,11 @@ extern "C" {
  */
 #define WM_DRV_DMA_FIRST_DESC             (true)
 
+/**
+ * @brief DMA max bytes of one chain desc, longer chain segments are split into several descs
+ */
+#define WM_DRV_DMA_CHAIN_DESC_LEN_MAX     (0xFFF0)
+
 /// TODO, WM_HAL_DMA_UT define in other space
 #define WM_DRV_DMA_UT
 #ifdef WM_DRV_DMA_UT
@@ -282,6 +287,30 @@ typedef struct wm_drv_dma_xfer_cfg_s {
     uint32_t reserved    : 5;  /* [31:27] reserved */
 } wm_drv_dma_xfer_cfg_t;
 
+/**
+ * @typedef wm_drv_dma_chain_t
+ * @brief dma drv desc chain, a linked list of transfers started as a whole
+ */
+typedef struct wm_drv_dma_chain_s wm_drv_dma_chain_t;
+
+/**
+ * @typedef wm_drv_dma_chain_callback_t
+ * @brief dma drv chain done callback, seg is the index of the finished segment
+ */
+typedef void (*wm_drv_dma_chain_callback_t)(wm_drv_dma_chain_t *chain, uint32_t seg, void *user_data);
+
+/**
+ * @struct wm_drv_dma_chain_cfg_t
+ * @brief dma drv chain config
+ */
+typedef struct wm_drv_dma_chain_cfg_s {
+    uint8_t ch;                     /* wm_drv_dma_ch_t, applied by wm_drv_dma_request_ch */
+    uint8_t req_src;                /* wm_drv_dma_req_src_t, not used for memory to memory */
+    bool circular;                  /* last segment links back to the first one, e.g. ping-pong buffers */
+    wm_drv_dma_chain_callback_t cb; /* called once when the chain is done, or after each segment if circular */
+    void *cb_priv;
+} wm_drv_dma_chain_cfg_t;
+
 /**
  * @struct wm_drv_dma_irq_priv_t
  * @brief dma drv irq info
@@ -301,6 +330,7 @@ typedef struct wm_drv_dma_ctx_s {
     wm_drv_dma_irq_priv_t irq_priv;
     wm_drv_dma_ch_cb_info_t user_ch_cb[WM_DRV_DMA_CH_MAX];
     void *desc[WM_DRV_DMA_CH_MAX];
+    wm_drv_dma_chain_t *chain[WM_DRV_DMA_CH_MAX];
 } wm_drv_dma_ctx_t;
 
 /**
@@ -415,6 +445,50 @@ wm_drv_dma_status_t wm_drv_dma_get_status(wm_device_t *dma_dev, wm_dma_ch_t ch,
  */
 wm_drv_dma_status_t wm_drv_dma_transfer(wm_device_t *dma_dev, wm_dma_ch_t ch, wm_drv_dma_xfer_cfg_t *dma_xfer);
 
+/**
+ * @brief          create an empty dma desc chain
+ * @param[in]      dma_dev device reference
+ * @param[in]      cfg chain config, the channel must be applied by wm_drv_dma_request_ch
+ * @param[out]     chain created chain
+ * @return         dma chain create operation status
+ */
+wm_drv_dma_status_t wm_drv_dma_chain_create(wm_device_t *dma_dev, wm_drv_dma_chain_cfg_t *cfg, wm_drv_dma_chain_t **chain);
+
+/**
+ * @brief          append a segment to the chain, segments longer than WM_DRV_DMA_CHAIN_DESC_LEN_MAX
+ *                 are split into several descs and still reported as one segment
+ * @param[in]      chain chain reference, must not be running
+ * @param[in]      src source address
+ * @param[in]      dest destination address
+ * @param[in]      len transfer len in bytes
+ * @param[in]      src_mode WM_DRV_DMA_ADDR_FIXED or WM_DRV_DMA_ADDR_INC
+ * @param[in]      dest_mode WM_DRV_DMA_ADDR_FIXED or WM_DRV_DMA_ADDR_INC
+ * @return         dma chain add operation status
+ */
+wm_drv_dma_status_t wm_drv_dma_chain_add(wm_drv_dma_chain_t *chain, uint32_t src, uint32_t dest, uint32_t len,
+                                         wm_drv_dma_addr_mode_t src_mode, wm_drv_dma_addr_mode_t dest_mode);
+
+/**
+ * @brief          config and start the whole chain on its channel, the chain can be started again once done
+ * @param[in]      chain chain reference
+ * @return         dma chain start operation status
+ */
+wm_drv_dma_status_t wm_drv_dma_chain_start(wm_drv_dma_chain_t *chain);
+
+/**
+ * @brief          stop the chain, no callback is called after it returns
+ * @param[in]      chain chain reference
+ * @return         dma chain stop operation status
+ */
+wm_drv_dma_status_t wm_drv_dma_chain_stop(wm_drv_dma_chain_t *chain);
+
+/**
+ * @brief          stop the chain and free it with all its descs
+ * @param[in]      chain chain reference
+ * @return         dma chain delete operation status
+ */
+wm_drv_dma_status_t wm_drv_dma_chain_delete(wm_drv_dma_chain_t *chain);
+
 /**
  * @}
  */
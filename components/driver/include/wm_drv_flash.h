@@ -53,6 +53,24 @@ typedef struct {
     uint32_t unique_id[FLASH_UNIQUE_ID_SIZE / 4]; /**< store flash unique id */
 } wm_drv_flash_info_t;
 
+/**
+ * @struct wm_drv_flash_stats_t
+ * @brief flash throughput counters, accumulated since init or the last reset
+ *
+ * Times are measured with the system tick around each API call, divide the bytes by the
+ * time of a long enough run to get the throughput.
+ */
+typedef struct {
+    uint32_t read_bytes;    /**< bytes read */
+    uint32_t read_ms;       /**< time spent in read */
+    uint32_t program_bytes; /**< bytes programmed, including the sector data kept by read-modify-write */
+    uint32_t program_ms;    /**< time spent in write and write_with_erase, including their erases */
+    uint32_t erase_sectors; /**< sector erase commands */
+    uint32_t erase_blocks;  /**< 32K or 64K block erase commands */
+    uint32_t erase_bytes;   /**< bytes erased by sector and block erase commands */
+    uint32_t erase_ms;      /**< time spent in erase_region and erase_sector */
+} wm_drv_flash_stats_t;
+
 /**
  * @}
  */
@@ -172,6 +190,31 @@ int wm_drv_flash_erase_sector(wm_device_t *dev, uint32_t sector_idx, uint32_t se
   */
 int wm_drv_flash_erase_chip(wm_device_t *dev);
 
+/**
+  * @brief     get the throughput counters of the flash
+  *
+  * @param [in] dev  flash driver device
+  * @param [out] stats store the counters
+  *
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - WM_ERR_INVALID_PARAM: invalid argument
+  *    - others: failed
+  */
+int wm_drv_flash_get_stats(wm_device_t *dev, wm_drv_flash_stats_t *stats);
+
+/**
+  * @brief     clear the throughput counters of the flash
+  *
+  * @param [in] dev  flash driver device
+  *
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - WM_ERR_INVALID_PARAM: invalid argument
+  *    - others: failed
+  */
+int wm_drv_flash_reset_stats(wm_device_t *dev);
+
 /**
   * @brief     Initialize flash driver
   *
@@ -40,6 +40,8 @@ typedef struct {
     int (*erase_region)(wm_device_t *dev, uint32_t offset, uint32_t erase_len);
     int (*erase_sector)(wm_device_t *dev, uint32_t sector_idx, uint32_t sector_count);
     int (*erase_chip)(wm_device_t *dev);
+    int (*get_stats)(wm_device_t *dev, wm_drv_flash_stats_t *stats);
+    int (*reset_stats)(wm_device_t *dev);
 } wm_drv_flash_ops_t;
 
 #ifdef __cplusplus
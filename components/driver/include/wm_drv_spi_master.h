@@ -86,6 +86,12 @@ typedef struct {
     uint8_t dummy_bits; /**< [input] dummy length, unit is bit, must set SPI_TRANS_DUMMY_BITS flag if want to use this member */
 } spim_transceive_ex_t;
 
+typedef struct {
+    const wm_dt_hw_spim_dev_cfg_t *config; /**< [input] device config of this transaction, include the CS pin */
+    spim_transceive_ex_t desc;             /**< [input] transaction, cmd/addr/dummy bits are valid only if their flags set */
+    uint32_t clk_div;                      /**< [private] clock divider of config, computed by the driver on submit */
+} spim_batch_transceive_t;
+
 /**
  * @}
  */
@@ -134,6 +140,25 @@ int wm_drv_spim_transceive_sync(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t
 int wm_drv_spim_transceive_async(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t *config, spim_transceive_t *desc,
                                  wm_spim_callback_t callback, void *usr_data);
 
+/**
+  * @brief transceive a batch of transactions asynchronously, the transactions run back to back from
+  *        the transfer done interrupt, callback will be trigger once after the last one done or the first one failed
+  *
+  * @param[in] dev  SPI device pointer
+  * @param[in] batch transactions, each one may address a different device, must keep valid until callback
+  * @param[in] count number of transactions in batch
+  * @param[in] callback the function will be trigger after the batch done
+  * @param[in] usr_data the argument for callback function
+  *
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - others: failed
+  *
+  * @note each transaction len must not exceed WM_SPI_MAX_DMA_TXRX_LEN
+  */
+int wm_drv_spim_transceive_batch_async(wm_device_t *dev, spim_batch_transceive_t *batch, uint32_t count,
+                                       wm_spim_callback_t callback, void *usr_data);
+
 /**
   * @brief     Initialize SPI master driver
   *
@@ -118,6 +118,34 @@ typedef struct {
     wm_lcd_rotate_t rotation; /**< Current display orientation */
 } wm_lcd_capabilitys_t;
 
+#define WM_LCD_REFRESH_RECTS_MAX (16) /**< Most dirty rectangles a partial refresh tracks */
+
+/**
+ * @brief Configuration of the partial refresh, see @ref wm_drv_tft_lcd_refresh_create
+ */
+typedef struct {
+    uint8_t *fb;              /**< Frame buffer of the whole display in RAM, rows of the current rotation one after
+                                *  another, x_resolution * y_resolution * WM_CFG_TFT_LCD_PIXEL_WIDTH bytes */
+    uint32_t band_size;       /**< Size in bytes of each of the two transmission buffers, a dirty region is sent
+                                *  in bands of rows fitting in it. 0: 10 rows of the display */
+    uint8_t max_rects;        /**< Dirty rectangles kept apart, more are merged into the cheapest neighbour.
+                                *  1 to WM_LCD_REFRESH_RECTS_MAX, 0: 8 */
+    uint8_t merge_percent;    /**< Two rectangles are merged when the clean pixels their bounding box adds are at
+                                *  most this percent of the box. 0 only merges overlapping boxes adding nothing,
+                                *  100 always merges */
+    uint16_t min_interval_ms; /**< Shortest time between two flushes, an earlier flush keeps the regions dirty.
+                                *  0: no limit */
+} wm_lcd_refresh_cfg_t;
+
+/**
+ * @brief Traffic counters of the partial refresh
+ */
+typedef struct {
+    uint32_t flushes;  /**< Flushes which sent at least one region */
+    uint32_t rects;    /**< Regions sent */
+    uint32_t tx_bytes; /**< Pixel bytes sent */
+} wm_lcd_refresh_stats_t;
+
 /**
  * @}
  */
@@ -148,6 +176,11 @@ typedef struct {
  */
 typedef void (*wm_lcd_tx_callback_t)(int result, void *data);
 
+/**
+ * @brief Partial refresh handle, created by @ref wm_drv_tft_lcd_refresh_create
+ */
+typedef struct wm_lcd_refresh wm_lcd_refresh_t;
+
 /**
  * @}
  */
@@ -194,7 +227,9 @@ int wm_drv_tft_lcd_deinit(wm_device_t *dev);
  *
  * @note This funciton using cpu polling for the transmission by default.  it will utilize DMA
  * if the transmission callback is reigstered via the API @ref wm_drv_tft_lcd_register_tx_callback
- * and the buf size is exceeds 32 bytes.
+ * and the buf size is at least 128 bytes. With the callback registered, it is invoked exactly once for
+ * each bitmap sent successfully, either from the DMA ISR or, for a short bitmap sent by cpu, before this
+ * function returns. The buffer must stay untouched until then.
  */
 int wm_drv_tft_lcd_draw_bitmap(wm_device_t *dev, wm_lcd_data_desc_t data_desc);
 
@@ -285,6 +320,71 @@ int wm_drv_tft_lcd_register_tx_callback(wm_device_t *dev, wm_lcd_tx_callback_t f
  */
 int wm_drv_tft_lcd_unregister_tx_callback(wm_device_t *dev);
 
+/**
+ * @brief Create a partial refresh for a frame buffer of the whole display.
+ * The application draws into the frame buffer and marks the changed areas with
+ * @ref wm_drv_tft_lcd_refresh_mark_dirty, @ref wm_drv_tft_lcd_refresh_flush then sends only those
+ * areas, merging nearby ones so that few windows are set on the panel.
+ *
+ * @param[in]  dev     The pointer to the TFT LCD driver device.
+ * @param[in]  cfg     The refresh configuration, type of @ref wm_lcd_refresh_cfg_t
+ * @param[out] refresh The created partial refresh handle
+ *
+ * @return WM_ERR_SUCCESS on success, WM_ERR_NO_MEM if the transmission buffers can not be allocated,
+ *         others error code on failure.
+ *
+ * @note The partial refresh takes over the tx callback of the device to send the regions by DMA,
+ * do not use @ref wm_drv_tft_lcd_register_tx_callback while it exists. The frame buffer layout
+ * follows the rotation at creation time, recreate the refresh after changing the rotation.
+ */
+int wm_drv_tft_lcd_refresh_create(wm_device_t *dev, const wm_lcd_refresh_cfg_t *cfg, wm_lcd_refresh_t **refresh);
+
+/**
+ * @brief Delete a partial refresh and release the tx callback of the device.
+ *
+ * @param[in] refresh The partial refresh handle
+ *
+ * @return WM_ERR_SUCCESS on success, others error code on failure.
+ */
+int wm_drv_tft_lcd_refresh_delete(wm_lcd_refresh_t *refresh);
+
+/**
+ * @brief Mark an area of the frame buffer as changed, it is sent by the next flush.
+ *
+ * @param[in] refresh The partial refresh handle
+ * @param[in] x_start Start pixel in the X direction, clipped to the display
+ * @param[in] y_start Start pixel in the Y direction, clipped to the display
+ * @param[in] x_end   End pixel in the X direction, inclusive
+ * @param[in] y_end   End pixel in the Y direction, inclusive
+ *
+ * @return WM_ERR_SUCCESS on success, WM_ERR_INVALID_PARAM if the area is empty or off the display.
+ */
+int wm_drv_tft_lcd_refresh_mark_dirty(wm_lcd_refresh_t *refresh, uint16_t x_start, uint16_t y_start, uint16_t x_end,
+                                      uint16_t y_end);
+
+/**
+ * @brief Send the dirty areas to the display, top to bottom, and wait until they are out.
+ *
+ * @param[in] refresh The partial refresh handle
+ * @param[in] force   true: ignore min_interval_ms of the configuration
+ *
+ * @return WM_ERR_SUCCESS on success or when nothing is due, others error code on failure,
+ *         the areas then stay dirty for the next flush.
+ *
+ * @note The frame buffer must not be written while the flush runs.
+ */
+int wm_drv_tft_lcd_refresh_flush(wm_lcd_refresh_t *refresh, bool force);
+
+/**
+ * @brief Get the traffic counters of a partial refresh.
+ *
+ * @param[in]  refresh The partial refresh handle
+ * @param[out] stats   The counters, type of @ref wm_lcd_refresh_stats_t
+ *
+ * @return WM_ERR_SUCCESS on success, others error code on failure.
+ */
+int wm_drv_tft_lcd_refresh_get_stats(wm_lcd_refresh_t *refresh, wm_lcd_refresh_stats_t *stats);
+
 /**
  * @}
  */
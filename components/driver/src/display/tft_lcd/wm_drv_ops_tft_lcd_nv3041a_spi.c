@@ -177,7 +177,7 @@ static int wm_drv_ops_nv3041a_spi_draw_bitmap(wm_device_t *dev, wm_lcd_data_desc
     ret = wm_nv3041a_set_windows(dev, data_desc.x_start, data_desc.y_start, data_desc.x_end, data_desc.y_end);
     WM_DRV_LCD_TFT_CHECK_GOTO(ret, exit);
 
-    ret = lcd_send_data(dev, data_desc.buf, data_desc.buf_size);
+    ret = lcd_send_bitmap(dev, data_desc.buf, data_desc.buf_size);
     WM_DRV_LCD_TFT_CHECK_GOTO(ret, exit);
 
 exit:
@@ -201,6 +201,9 @@ static int wm_drv_ops_nv3041a_spi_deinit(wm_device_t *dev)
     /*TODO: replace by lookup table*/
     //set GPIO as default state
 
+    /* the last bitmap may still be in flight */
+    lcd_release_tx(dev);
+
     WM_DRV_TFT_LCD_UNLOCK(drv->mutex);
     wm_os_internal_mutex_delete(drv->mutex);
 
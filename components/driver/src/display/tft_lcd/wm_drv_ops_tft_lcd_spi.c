@@ -34,15 +34,46 @@
  *and DMA only transmit the part that is 4-byte aligned x*/
 #define TFT_LCD_DMA_TRIGGER_THRESHOLD (128)
 
-/*wait the previous data dma transfer done.
- *not optimize this function, otherwise system may aways loop here*/
-__attribute__((optimize("O0"))) static void _waiting_data_tx_done(wm_device_t *dev)
+/*wait the previous data dma transfer done, the caller sleeps until the DMA ISR releases the semaphore.
+ *every started DMA is collected here exactly once, so the semaphore never keeps a stale count*/
+static int _waiting_data_tx_done(wm_device_t *dev)
 {
     wm_drv_tft_lcd_spi_t *drv = (wm_drv_tft_lcd_spi_t *)dev->drv;
 
-    //loop to avoid conflict if async and sync operation both existing
-    while (drv->dma_sending == true) {
+    if (!drv->dma_sending) {
+        return WM_ERR_SUCCESS;
     }
+
+    drv->dma_sending = false;
+    if (wm_os_internal_sem_acquire_ms(drv->dma_done_sem, LCD_XFER_BYTES_TIMEOUT_MS) != WM_OS_STATUS_SUCCESS) {
+        WM_DRV_TFT_LCD_LOG_E("dma done timeout");
+        return WM_ERR_TIMEOUT;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+/*start the DMA transfer of a 4 byte aligned segment, completion is collected by _waiting_data_tx_done*/
+static int _start_data_tx(wm_device_t *dev, spim_transceive_t *desc)
+{
+    int ret                   = WM_ERR_SUCCESS;
+    wm_drv_tft_lcd_spi_t *drv = (wm_drv_tft_lcd_spi_t *)dev->drv;
+
+    if (drv->dma_done_sem == NULL) {
+        if (wm_os_internal_sem_create(&drv->dma_done_sem, 0) != WM_OS_STATUS_SUCCESS) {
+            return WM_ERR_NO_MEM;
+        }
+    } else {
+        //drop a completion which came in after a timeout
+        wm_os_internal_sem_reset(drv->dma_done_sem);
+    }
+
+    ret = wm_drv_sdh_spi_transceive_async(drv->spi_dev, drv->spi_cfg, desc, lcd_spim_callback, drv);
+    if (ret == WM_ERR_SUCCESS) {
+        drv->dma_sending = true;
+    }
+
+    return ret;
 }
 
 int lcd_io_backlight_on(wm_dt_hw_tft_lcd_spi_t *hw)
@@ -124,14 +155,29 @@ void lcd_spim_callback(int result, void *lcd_drv)
     drv = (wm_drv_tft_lcd_spi_t *)lcd_drv;
     if (!drv) {
         WM_DRV_TFT_LCD_LOG_E("lcd cb param invalid");
+        return;
     }
 
-    drv->dma_sending = false;
-    if (drv->tx_done_cb) {
+    wm_os_internal_sem_release(drv->dma_done_sem);
+
+    //command data sent by DMA is not reported, the user only waits for bitmaps
+    if (drv->dma_notify && drv->tx_done_cb) {
         drv->tx_done_cb(result, drv->usr_data);
     }
 }
 
+void lcd_release_tx(wm_device_t *dev)
+{
+    wm_drv_tft_lcd_spi_t *drv = (wm_drv_tft_lcd_spi_t *)dev->drv;
+
+    _waiting_data_tx_done(dev);
+
+    if (drv->dma_done_sem) {
+        wm_os_internal_sem_delete(drv->dma_done_sem);
+        drv->dma_done_sem = NULL;
+    }
+}
+
 int lcd_send_bytes_with_sdhspi(wm_device_t *dev, uint8_t *buf, int length)
 {
     int ret                   = WM_ERR_SUCCESS;
@@ -165,18 +211,19 @@ int lcd_send_bytes_with_sdhspi(wm_device_t *dev, uint8_t *buf, int length)
             desc.tx_len = table[index].size;
 
             /*wait the previous data dma transfer done*/
-            _waiting_data_tx_done(dev);
+            ret = _waiting_data_tx_done(dev);
+            WM_DRV_LCD_TFT_CHECK_RETURN(ret);
             WM_DRV_TFT_LCD_LOG_D("id=%d, buf=%p, size=%d, flag=%d, buf[0]=0x%x, buf[1]=0x%x", index, table[index].addr,
                                  table[index].size, table[index].flag, *(table[index].addr), *(table[index].addr + 1));
             if (table[index].flag == WM_DATA_ALIGN_TYPE_DMA) {
-                drv->dma_sending = true;
-
-                ret = wm_drv_sdh_spi_transceive_async(drv->spi_dev, drv->spi_cfg, &desc, lcd_spim_callback, drv);
+                //the DMA ends the bitmap unless a CPU tail follows, the tail is reported by lcd_send_bitmap
+                drv->dma_notify = drv->tx_bitmap && (index == 2 || table[index + 1].size == 0);
+                ret             = _start_data_tx(dev, &desc);
                 if (ret != WM_ERR_SUCCESS) {
                     /* release the resource to avoid dead lock or system halt */
                     WM_DRV_TFT_LCD_LOG_E("async failed,ret=%d", ret);
-                    drv->dma_sending = false;
-                    if (drv->tx_done_cb) {
+                    drv->dma_notify = false;
+                    if (drv->tx_bitmap && drv->tx_done_cb) {
                         drv->tx_done_cb(ret, drv->usr_data);
                     }
                 }
@@ -196,7 +243,8 @@ int lcd_send_data(wm_device_t *dev, uint8_t *buf, int length)
     wm_dt_hw_tft_lcd_spi_t *hw = (wm_dt_hw_tft_lcd_spi_t *)dev->hw;
 
     /*need the previous data dma transfer done*/
-    _waiting_data_tx_done(dev);
+    ret = _waiting_data_tx_done(dev);
+    WM_DRV_LCD_TFT_CHECK_RETURN(ret);
 
     ret = lcd_io_dcx_data_start(hw);
     WM_DRV_LCD_TFT_CHECK_RETURN(ret);
@@ -207,6 +255,29 @@ int lcd_send_data(wm_device_t *dev, uint8_t *buf, int length)
     return ret;
 }
 
+int lcd_send_bitmap(wm_device_t *dev, uint8_t *buf, int length)
+{
+    int ret                   = WM_ERR_FAILED;
+    wm_drv_tft_lcd_spi_t *drv = (wm_drv_tft_lcd_spi_t *)dev->drv;
+
+    /*the previous bitmap may still be reported by the DMA ISR*/
+    ret = _waiting_data_tx_done(dev);
+    WM_DRV_LCD_TFT_CHECK_RETURN(ret);
+
+    drv->dma_notify = false;
+    drv->tx_bitmap  = true;
+    ret             = lcd_send_data(dev, buf, length);
+    drv->tx_bitmap  = false;
+    WM_DRV_LCD_TFT_CHECK_RETURN(ret);
+
+    //a bitmap not ending with a DMA is done here, report it so that every bitmap completes through the callback
+    if (!drv->dma_notify && drv->tx_done_cb) {
+        drv->tx_done_cb(WM_ERR_SUCCESS, drv->usr_data);
+    }
+
+    return ret;
+}
+
 int lcd_send_command(wm_device_t *dev, uint16_t cmd, wm_lcd_cmd_type_t cmd_type)
 {
     int ret                    = WM_ERR_FAILED;
@@ -217,7 +288,8 @@ int lcd_send_command(wm_device_t *dev, uint16_t cmd, wm_lcd_cmd_type_t cmd_type)
     }
 
     /*wait the previous data dma transfer done*/
-    _waiting_data_tx_done(dev);
+    ret = _waiting_data_tx_done(dev);
+    WM_DRV_LCD_TFT_CHECK_RETURN(ret);
 
     WM_DRV_TFT_LCD_LOG_D("lcd_send_command, 0x%x, type(%d)", cmd, cmd_type);
     ret = lcd_io_dcx_cmd_start(hw);
@@ -0,0 +1,105 @@
+/**
+ * @file wm_drv_tft_lcd_rect.c
+ *
+ * @brief Dirty rectangle merging of the TFT LCD partial refresh
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "wm_drv_tft_lcd_rect.h"
+
+#define WM_LCD_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define WM_LCD_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+uint32_t wm_lcd_rect_area(const wm_lcd_rect_t *r)
+{
+    return (uint32_t)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+/* clean pixels the bounding box u of a and b covers besides a and b */
+static uint32_t wm_lcd_rect_merge_cost(const wm_lcd_rect_t *a, const wm_lcd_rect_t *b, wm_lcd_rect_t *u)
+{
+    wm_lcd_rect_t i;
+    uint32_t covered;
+
+    u->x1 = WM_LCD_MIN(a->x1, b->x1);
+    u->y1 = WM_LCD_MIN(a->y1, b->y1);
+    u->x2 = WM_LCD_MAX(a->x2, b->x2);
+    u->y2 = WM_LCD_MAX(a->y2, b->y2);
+
+    covered = wm_lcd_rect_area(a) + wm_lcd_rect_area(b);
+
+    i.x1 = WM_LCD_MAX(a->x1, b->x1);
+    i.y1 = WM_LCD_MAX(a->y1, b->y1);
+    i.x2 = WM_LCD_MIN(a->x2, b->x2);
+    i.y2 = WM_LCD_MIN(a->y2, b->y2);
+    if (i.x1 <= i.x2 && i.y1 <= i.y2) {
+        covered -= wm_lcd_rect_area(&i);
+    }
+
+    return wm_lcd_rect_area(u) - covered;
+}
+
+int wm_lcd_rect_add(wm_lcd_rect_t *rects, int num, int max_rects, int merge_percent, wm_lcd_rect_t r)
+{
+    wm_lcd_rect_t u;
+    wm_lcd_rect_t best_u = { 0 };
+    uint32_t cost;
+    uint32_t best_cost;
+    int best;
+    int i;
+
+    while (1) {
+        best      = -1;
+        best_cost = UINT32_MAX;
+
+        for (i = 0; i < num; i++) {
+            cost = wm_lcd_rect_merge_cost(&rects[i], &r, &u);
+            if (cost < best_cost) {
+                best      = i;
+                best_cost = cost;
+                best_u    = u;
+            }
+        }
+
+        /* keep the rectangle apart if merging wastes too much and there is room for it */
+        if (best < 0 || (best_cost * 100 > wm_lcd_rect_area(&best_u) * merge_percent && num < max_rects)) {
+            rects[num++] = r;
+            return num;
+        }
+
+        /* take the neighbour out and retry with the grown rectangle, it may now reach others */
+        r           = best_u;
+        rects[best] = rects[--num];
+    }
+}
+
+void wm_lcd_rect_sort(wm_lcd_rect_t *rects, int num)
+{
+    wm_lcd_rect_t r;
+    int i;
+    int j;
+
+    for (i = 1; i < num; i++) {
+        r = rects[i];
+        for (j = i; j > 0 && rects[j - 1].y1 > r.y1; j--) {
+            rects[j] = rects[j - 1];
+        }
+        rects[j] = r;
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file wm_drv_tft_lcd_rect.h
+ *
+ * @brief Dirty rectangle merging of the TFT LCD partial refresh
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef __WM_DRV_TFT_LCD_RECT_H__
+#define __WM_DRV_TFT_LCD_RECT_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Rectangle of pixels, both corners included.
+ */
+typedef struct {
+    uint16_t x1;
+    uint16_t y1;
+    uint16_t x2;
+    uint16_t y2;
+} wm_lcd_rect_t;
+
+/**
+ * @brief Number of pixels of a rectangle.
+ *
+ * @param[in] r rectangle
+ *
+ * @return pixel count
+ */
+uint32_t wm_lcd_rect_area(const wm_lcd_rect_t *r);
+
+/**
+ * @brief Add a dirty rectangle to a list, merging it with its neighbours.
+ *
+ * A rectangle is merged with the neighbour whose bounding box adds the fewest clean pixels,
+ * if those are at most merge_percent of the bounding box or the list holds max_rects already.
+ * The grown rectangle is then merged again, as it may now reach other neighbours.
+ *
+ * @param[in,out] rects list, with room for max_rects rectangles
+ * @param[in] num rectangles in the list
+ * @param[in] max_rects largest number of rectangles kept apart, at least 1
+ * @param[in] merge_percent clean pixels a merge may add, in percent of the merged rectangle
+ * @param[in] r rectangle to add
+ *
+ * @return rectangles in the list afterwards
+ */
+int wm_lcd_rect_add(wm_lcd_rect_t *rects, int num, int max_rects, int merge_percent, wm_lcd_rect_t r);
+
+/**
+ * @brief Sort a list top to bottom, so that it is sent in the scan order of the panel.
+ *
+ * @param[in,out] rects list
+ * @param[in] num rectangles in the list
+ */
+void wm_lcd_rect_sort(wm_lcd_rect_t *rects, int num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_DRV_TFT_LCD_RECT_H__ */
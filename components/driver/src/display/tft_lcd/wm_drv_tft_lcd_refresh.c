@@ -0,0 +1,327 @@
+/**
+ * @file wm_drv_tft_lcd_refresh.c
+ *
+ * @brief Driver LCD(TFT) Partial Refresh Module
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "wm_types.h"
+#include "wm_error.h"
+#include "wm_osal.h"
+#include "wm_drv_tft_lcd.h"
+#include "wm_drv_tft_lcd_rect.h"
+
+#define LOG_TAG "DRV TFT_LCD"
+#include "wm_log.h"
+
+#ifdef WM_CFG_TFT_LCD_PIXEL_WIDTH
+#define WM_LCD_REFRESH_PIXEL_SIZE (WM_CFG_TFT_LCD_PIXEL_WIDTH) /**< bytes per pixel of the panel color mode */
+#else
+#define WM_LCD_REFRESH_PIXEL_SIZE (2) /**< no panel selected, RGB565 as the panel drivers support */
+#endif
+
+#define WM_LCD_REFRESH_BAND_ROWS     (10)    /**< default rows per transmission buffer */
+#define WM_LCD_REFRESH_DEF_RECTS     (8)     /**< default max_rects */
+#define WM_LCD_REFRESH_MAX_TX_SIZE   (65532) /**< largest DMA transfer of the SPI controller, 4 byte aligned */
+#define WM_LCD_REFRESH_TX_TIMEOUT_MS (1000)
+
+#define WM_LCD_MIN(a, b)             ((a) < (b) ? (a) : (b))
+#define WM_LCD_MAX(a, b)             ((a) > (b) ? (a) : (b))
+
+struct wm_lcd_refresh {
+    wm_device_t *dev;
+    wm_os_mutex_t *mutex;
+    wm_os_sem_t *tx_sem; /**< released once per bitmap by the tx callback */
+    volatile int tx_result;
+    uint8_t *fb;
+    uint8_t *band[2];
+    uint32_t band_size;
+    uint16_t x_res;
+    uint16_t y_res;
+    uint8_t max_rects;
+    uint8_t merge_percent;
+    uint16_t min_interval_ms;
+    uint32_t last_flush_ms;
+    int rect_num;
+    wm_lcd_rect_t rects[WM_LCD_REFRESH_RECTS_MAX];
+    wm_lcd_refresh_stats_t stats;
+};
+
+static void wm_lcd_refresh_tx_done(int result, void *data)
+{
+    wm_lcd_refresh_t *refresh = (wm_lcd_refresh_t *)data;
+
+    if (result != WM_ERR_SUCCESS) {
+        refresh->tx_result = result;
+    }
+    wm_os_internal_sem_release(refresh->tx_sem);
+}
+
+static int wm_lcd_refresh_send(wm_lcd_refresh_t *refresh, const wm_lcd_rect_t *r, uint8_t *buf, uint16_t rows)
+{
+    wm_lcd_data_desc_t desc = { 0 };
+    int ret;
+
+    desc.x_start  = r->x1;
+    desc.y_start  = r->y1;
+    desc.x_end    = r->x2;
+    desc.y_end    = r->y1 + rows - 1;
+    desc.buf      = buf;
+    desc.buf_size = (uint32_t)(r->x2 - r->x1 + 1) * rows * WM_LCD_REFRESH_PIXEL_SIZE;
+
+    ret = wm_drv_tft_lcd_draw_bitmap(refresh->dev, desc);
+    if (ret == WM_ERR_SUCCESS) {
+        refresh->stats.tx_bytes += desc.buf_size;
+    }
+
+    return ret;
+}
+
+/* wait until at most max_pending bitmaps are still being sent */
+static int wm_lcd_refresh_wait(wm_lcd_refresh_t *refresh, int *pending, int max_pending)
+{
+    while (*pending > max_pending) {
+        if (wm_os_internal_sem_acquire_ms(refresh->tx_sem, WM_LCD_REFRESH_TX_TIMEOUT_MS) != WM_OS_STATUS_SUCCESS) {
+            wm_log_error("refresh tx timeout");
+            return WM_ERR_TIMEOUT;
+        }
+        (*pending)--;
+    }
+
+    return refresh->tx_result;
+}
+
+static int wm_lcd_refresh_send_rect(wm_lcd_refresh_t *refresh, const wm_lcd_rect_t *r, int *pending, int *band_id)
+{
+    uint32_t line_size = (uint32_t)(r->x2 - r->x1 + 1) * WM_LCD_REFRESH_PIXEL_SIZE;
+    uint32_t fb_stride = (uint32_t)refresh->x_res * WM_LCD_REFRESH_PIXEL_SIZE;
+    uint16_t rows_max  = WM_LCD_MAX(refresh->band_size / line_size, 1);
+    wm_lcd_rect_t band = *r;
+    uint8_t *src;
+    uint8_t *dst;
+    uint16_t rows;
+    uint16_t i;
+    int ret = WM_ERR_SUCCESS;
+
+    while (band.y1 <= r->y2 && ret == WM_ERR_SUCCESS) {
+        rows = WM_LCD_MIN(rows_max, r->y2 - band.y1 + 1);
+        src  = refresh->fb + band.y1 * fb_stride + band.x1 * WM_LCD_REFRESH_PIXEL_SIZE;
+
+        if (line_size == fb_stride) {
+            /* full rows are contiguous in the frame buffer, send them in place */
+            rows = WM_LCD_MIN(rows, WM_LCD_REFRESH_MAX_TX_SIZE / line_size);
+            ret  = wm_lcd_refresh_send(refresh, &band, src, rows);
+        } else {
+            /* the other buffer may still be in flight, fill this one meanwhile */
+            ret = wm_lcd_refresh_wait(refresh, pending, 1);
+            if (ret != WM_ERR_SUCCESS) {
+                break;
+            }
+            dst = refresh->band[*band_id];
+            for (i = 0; i < rows; i++) {
+                memcpy(dst + i * line_size, src + i * fb_stride, line_size);
+            }
+            ret      = wm_lcd_refresh_send(refresh, &band, dst, rows);
+            *band_id = !*band_id;
+        }
+
+        if (ret == WM_ERR_SUCCESS) {
+            (*pending)++;
+        }
+        band.y1 += rows;
+    }
+
+    return ret;
+}
+
+int wm_drv_tft_lcd_refresh_create(wm_device_t *dev, const wm_lcd_refresh_cfg_t *cfg, wm_lcd_refresh_t **refresh)
+{
+    wm_lcd_capabilitys_t cap = { 0 };
+    wm_lcd_refresh_t *r      = NULL;
+    int ret;
+
+    if (dev == NULL || cfg == NULL || cfg->fb == NULL || refresh == NULL || cfg->max_rects > WM_LCD_REFRESH_RECTS_MAX ||
+        cfg->merge_percent > 100 || cfg->band_size > WM_LCD_REFRESH_MAX_TX_SIZE) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    ret = wm_drv_tft_lcd_get_capability(dev, &cap);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    r = wm_os_internal_malloc(sizeof(wm_lcd_refresh_t));
+    if (r == NULL) {
+        return WM_ERR_NO_MEM;
+    }
+    memset(r, 0, sizeof(wm_lcd_refresh_t));
+
+    r->dev             = dev;
+    r->fb              = cfg->fb;
+    r->x_res           = cap.x_resolution;
+    r->y_res           = cap.y_resolution;
+    r->band_size       = cfg->band_size ? cfg->band_size :
+                                          (uint32_t)cap.x_resolution * WM_LCD_REFRESH_PIXEL_SIZE * WM_LCD_REFRESH_BAND_ROWS;
+    r->max_rects       = cfg->max_rects ? cfg->max_rects : WM_LCD_REFRESH_DEF_RECTS;
+    r->merge_percent   = cfg->merge_percent;
+    r->min_interval_ms = cfg->min_interval_ms;
+    r->last_flush_ms   = wm_os_internal_get_time_ms() - cfg->min_interval_ms;
+
+    /* a band holds at least one full row */
+    r->band_size = WM_LCD_MAX(r->band_size, (uint32_t)cap.x_resolution * WM_LCD_REFRESH_PIXEL_SIZE);
+
+    r->band[0] = wm_os_internal_malloc(r->band_size);
+    r->band[1] = wm_os_internal_malloc(r->band_size);
+    if (r->band[0] == NULL || r->band[1] == NULL) {
+        ret = WM_ERR_NO_MEM;
+        goto fail;
+    }
+
+    if (wm_os_internal_mutex_create(&r->mutex) != WM_OS_STATUS_SUCCESS ||
+        wm_os_internal_sem_create(&r->tx_sem, 0) != WM_OS_STATUS_SUCCESS) {
+        ret = WM_ERR_NO_MEM;
+        goto fail;
+    }
+
+    ret = wm_drv_tft_lcd_register_tx_callback(dev, wm_lcd_refresh_tx_done, r);
+    if (ret != WM_ERR_SUCCESS) {
+        goto fail;
+    }
+
+    *refresh = r;
+
+    return WM_ERR_SUCCESS;
+
+fail:
+    if (r->tx_sem) {
+        wm_os_internal_sem_delete(r->tx_sem);
+    }
+    if (r->mutex) {
+        wm_os_internal_mutex_delete(r->mutex);
+    }
+    wm_os_internal_free(r->band[0]);
+    wm_os_internal_free(r->band[1]);
+    wm_os_internal_free(r);
+
+    return ret;
+}
+
+int wm_drv_tft_lcd_refresh_delete(wm_lcd_refresh_t *refresh)
+{
+    if (refresh == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    wm_drv_tft_lcd_unregister_tx_callback(refresh->dev);
+
+    wm_os_internal_sem_delete(refresh->tx_sem);
+    wm_os_internal_mutex_delete(refresh->mutex);
+    wm_os_internal_free(refresh->band[0]);
+    wm_os_internal_free(refresh->band[1]);
+    wm_os_internal_free(refresh);
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_drv_tft_lcd_refresh_mark_dirty(wm_lcd_refresh_t *refresh, uint16_t x_start, uint16_t y_start, uint16_t x_end,
+                                      uint16_t y_end)
+{
+    wm_lcd_rect_t r;
+
+    if (refresh == NULL || x_start > x_end || y_start > y_end || x_start >= refresh->x_res ||
+        y_start >= refresh->y_res) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    r.x1 = x_start;
+    r.y1 = y_start;
+    r.x2 = WM_LCD_MIN(x_end, refresh->x_res - 1);
+    r.y2 = WM_LCD_MIN(y_end, refresh->y_res - 1);
+
+    wm_os_internal_mutex_acquire(refresh->mutex, WM_OS_WAIT_TIME_MAX);
+    refresh->rect_num = wm_lcd_rect_add(refresh->rects, refresh->rect_num, refresh->max_rects, refresh->merge_percent, r);
+    wm_os_internal_mutex_release(refresh->mutex);
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_drv_tft_lcd_refresh_flush(wm_lcd_refresh_t *refresh, bool force)
+{
+    uint32_t now;
+    int pending = 0;
+    int band_id = 0;
+    int ret     = WM_ERR_SUCCESS;
+    int err;
+    int i;
+
+    if (refresh == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    wm_os_internal_mutex_acquire(refresh->mutex, WM_OS_WAIT_TIME_MAX);
+
+    now = wm_os_internal_get_time_ms();
+    if (refresh->rect_num == 0 || (!force && now - refresh->last_flush_ms < refresh->min_interval_ms)) {
+        wm_os_internal_mutex_release(refresh->mutex);
+        return WM_ERR_SUCCESS;
+    }
+
+    /* top to bottom, so the regions follow the panel scan and tear less */
+    wm_lcd_rect_sort(refresh->rects, refresh->rect_num);
+
+    /* a bitmap which failed after its DMA was started may have completed late */
+    wm_os_internal_sem_reset(refresh->tx_sem);
+    refresh->tx_result = WM_ERR_SUCCESS;
+    for (i = 0; i < refresh->rect_num && ret == WM_ERR_SUCCESS; i++) {
+        ret = wm_lcd_refresh_send_rect(refresh, &refresh->rects[i], &pending, &band_id);
+    }
+
+    err = wm_lcd_refresh_wait(refresh, &pending, 0);
+    if (ret == WM_ERR_SUCCESS) {
+        ret = err;
+    }
+
+    /* on failure the regions stay dirty and are sent again by the next flush */
+    if (ret == WM_ERR_SUCCESS) {
+        refresh->stats.flushes++;
+        refresh->stats.rects += refresh->rect_num;
+        refresh->rect_num      = 0;
+        refresh->last_flush_ms = now;
+    } else {
+        wm_log_error("refresh flush ret(%d)", ret);
+    }
+
+    wm_os_internal_mutex_release(refresh->mutex);
+
+    return ret;
+}
+
+int wm_drv_tft_lcd_refresh_get_stats(wm_lcd_refresh_t *refresh, wm_lcd_refresh_stats_t *stats)
+{
+    if (refresh == NULL || stats == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    wm_os_internal_mutex_acquire(refresh->mutex, WM_OS_WAIT_TIME_MAX);
+    *stats = refresh->stats;
+    wm_os_internal_mutex_release(refresh->mutex);
+
+    return WM_ERR_SUCCESS;
+}
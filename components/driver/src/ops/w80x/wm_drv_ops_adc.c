@@ -53,11 +53,16 @@ static int wm_w800_drv_adc_stop_it(wm_device_t *dev, wm_adc_channel_t adc_channe
 static int wm_w800_drv_adc_read_temp(wm_device_t *dev, int *temperature_val);
 static int wm_w800_drv_adc_read_voltage(wm_device_t *dev, int *voltage);
 static int wm_w800_drv_adc_cal_voltage(wm_device_t *dev, int vol);
+static int wm_w800_drv_adc_cal_voltage_bulk(wm_device_t *dev, int *buf, uint32_t count);
+static int wm_w800_drv_adc_start_continuous(wm_device_t *dev, const wm_drv_adc_continuous_cfg_t *cfg);
+static int wm_w800_drv_adc_stop_continuous(wm_device_t *dev);
 
 #define WM_ADC_CHANNEL_IS_VAILD(channel)                                                          \
     (channel == WM_ADC_CHANNEL_0 || channel == WM_ADC_CHANNEL_1 || channel == WM_ADC_CHANNEL_2 || \
      channel == WM_ADC_CHANNEL_3 || channel == WM_ADC_CHANNEL_0_1_DIFF_INPUT || channel == WM_ADC_CHANNEL_2_3_DIFF_INPUT)
 
+#define WM_DRV_ADC_HALF_NUM 2
+
 #define WM_DRV_ADC_LOCK(lock)                                                            \
     do {                                                                                 \
         if (!lock) {                                                                     \
@@ -91,12 +96,23 @@ typedef enum {
     WM_ADC_STATE_RUNNING,
 } wm_adc_state_t;
 
+typedef struct {
+    wm_device_t *dev;
+    wm_drv_adc_continuous_cfg_t cfg;
+    wm_adc_channel_t scan[WM_ADC_MAX_CHANNEL_COUNT];
+    wm_drv_dma_chain_t *chain[WM_ADC_MAX_CHANNEL_COUNT][WM_DRV_ADC_HALF_NUM];
+    uint8_t dma_ch;
+    uint8_t scan_idx; /* scan channel being sampled */
+    uint8_t half;     /* half of the ring buffer being filled */
+} wm_drv_adc_continuous_t;
+
 typedef struct {
     wm_os_mutex_t *mutex;
     wm_adc_state_t state;
     wm_device_t *clock_dev;
     wm_device_t *dma_dev;
     wm_drv_adc_cfg_t *cfg;
+    wm_drv_adc_continuous_t *cont;
 } wm_drv_adc_ctx_t;
 
 typedef struct {
@@ -104,6 +120,8 @@ typedef struct {
     wm_drv_adc_ctx_t adc_drv;
 } wm_drv_adc_data_t;
 
+static void wm_w800_drv_adc_continuous_halt(wm_drv_adc_data_t *adc_data);
+
 typedef struct {
     int (*init)(wm_device_t *dev);
     int (*deinit)(wm_device_t *dev);
@@ -117,6 +135,9 @@ typedef struct {
     int (*read_temp)(wm_device_t *dev, int *temperature_val);
     int (*read_voltage)(wm_device_t *dev, int *voltage);
     int (*cal_voltage)(wm_device_t *dev, int vol);
+    int (*cal_voltage_bulk)(wm_device_t *dev, int *buf, uint32_t count);
+    int (*start_continuous)(wm_device_t *dev, const wm_drv_adc_continuous_cfg_t *cfg);
+    int (*stop_continuous)(wm_device_t *dev);
 } wm_drv_adc_ops_t;
 
 static void adc_gauss_solve(int n, double A[], double x[], double b[])
@@ -355,6 +376,11 @@ static int wm_w800_drv_adc_deinit(wm_device_t *dev)
 
     if (adc_data) {
         WM_DRV_ADC_LOCK(adc_data->adc_drv.mutex);
+        // the dma chains keep running and calling back into adc_data, stop them before it is freed
+        if (adc_data->adc_drv.cont) {
+            wm_w800_drv_adc_continuous_halt(adc_data);
+        }
+
         if (WM_ERR_SUCCESS != (err = wm_hal_adc_deinit(&adc_data->adc_hal))) {
             WM_DRV_ADC_UNLOCK(adc_data->adc_drv.mutex);
             wm_log_error("adc deinit err %d ", err);
@@ -649,7 +675,7 @@ static int wm_w800_drv_adc_stop_it(wm_device_t *dev, wm_adc_channel_t adc_channe
     adc_data = (wm_drv_adc_data_t *)dev->drv;
 
     if (adc_data) {
-        if (WM_ADC_STATE_RUNNING != adc_data->adc_drv.state) {
+        if (WM_ADC_STATE_RUNNING != adc_data->adc_drv.state || adc_data->adc_drv.cont) {
             wm_log_error("adc dev not running, no need stop");
             return WM_ERR_NOT_ALLOWED;
         }
@@ -746,17 +772,337 @@ static int wm_w800_drv_adc_cal_voltage(wm_device_t *dev, int vol)
     return err;
 }
 
+static int wm_w800_drv_adc_cal_voltage_bulk(wm_device_t *dev, int *buf, uint32_t count)
+{
+    if (!dev || !buf) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    int vol                     = 0;
+    uint32_t i                  = 0;
+    wm_drv_adc_data_t *adc_data = NULL;
+
+    adc_data = (wm_drv_adc_data_t *)dev->drv;
+    if (!adc_data) {
+        return WM_ERR_FAILED;
+    }
+
+    for (i = 0; i < count; i++) {
+        vol = buf[i];
+        WM_ADC_GET_RESULT(vol);
+        WM_ADC_SIGNED_TO_UNSIGNED(vol);
+        buf[i] = wm_hal_adc_cal_voltage(&adc_data->adc_hal, vol);
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static uint8_t wm_w800_drv_adc_dma_req(wm_adc_channel_t adc_channel)
+{
+    switch (adc_channel) {
+        case WM_ADC_CHANNEL_1:
+        {
+            return WM_DRV_DMA_ADC_CH1_REQ;
+        }
+        case WM_ADC_CHANNEL_2:
+        case WM_ADC_CHANNEL_2_3_DIFF_INPUT:
+        {
+            return WM_DRV_DMA_ADC_CH2_REQ;
+        }
+        case WM_ADC_CHANNEL_3:
+        {
+            return WM_DRV_DMA_ADC_CH3_REQ;
+        }
+        default:
+        {
+            return WM_DRV_DMA_ADC_CH0_REQ;
+        }
+    }
+}
+
+/*
+ * average oversample raw results into one sample, in place, return the sample count. Integer only, it runs in the
+ * dma interrupt, the calibration is left to wm_drv_adc_cal_voltage_bulk() in task context.
+ */
+static uint32_t wm_w800_drv_adc_continuous_process(wm_drv_adc_continuous_t *cont, int *buf, uint32_t len)
+{
+    uint8_t oversample = cont->cfg.oversample;
+    uint32_t i         = 0;
+    uint32_t j         = 0;
+    uint32_t count     = 0;
+    int sum            = 0;
+    int vol            = 0;
+
+    if (oversample == 1) {
+        return len;
+    }
+
+    for (i = 0; i < len; i += oversample) {
+        for (j = 0, sum = 0; j < oversample; j++) {
+            vol = buf[i + j];
+            WM_ADC_GET_RESULT(vol);
+            WM_ADC_SIGNED_TO_UNSIGNED(vol);
+            sum += vol;
+        }
+        vol = sum / oversample;
+
+        /* back to the result register format */
+        WM_ADC_SIGNED_TO_UNSIGNED(vol);
+        buf[count++] = vol;
+    }
+
+    return count;
+}
+
+static void wm_w800_drv_adc_continuous_done(wm_drv_dma_chain_t *chain, uint32_t seg, void *user_data)
+{
+    wm_drv_adc_continuous_t *cont = (wm_drv_adc_continuous_t *)user_data;
+    wm_drv_adc_data_t *adc_data   = (wm_drv_adc_data_t *)cont->dev->drv;
+    wm_adc_channel_t channel      = cont->scan[cont->scan_idx];
+    uint32_t half_len             = cont->cfg.len / WM_DRV_ADC_HALF_NUM;
+    uint8_t half                  = 0;
+    uint32_t len                  = 0;
+    int *buf                      = NULL;
+
+    if (cont->cfg.scan_count > 1) {
+        /* start the next channel on the other half first, the callback below runs while it is sampled */
+        half           = cont->half;
+        cont->scan_idx = (cont->scan_idx + 1) % cont->cfg.scan_count;
+        cont->half     = !cont->half;
+        wm_drv_dma_chain_start(cont->chain[cont->scan_idx][cont->half]);
+        wm_hal_adc_switch_channel(&adc_data->adc_hal, cont->scan[cont->scan_idx]);
+    } else {
+        /* segments of the circular chain are the two halves */
+        half = (uint8_t)seg;
+    }
+
+    buf = cont->cfg.buf + half * half_len;
+    len = wm_w800_drv_adc_continuous_process(cont, buf, half_len);
+    cont->cfg.callback(channel, buf, len, half != 0, cont->cfg.user_data);
+}
+
+static int wm_w800_drv_adc_continuous_create(wm_drv_adc_data_t *adc_data, wm_drv_adc_continuous_t *cont)
+{
+    wm_drv_dma_chain_cfg_t chain_cfg = { 0 };
+    uint32_t src                     = (uint32_t)(&adc_data->adc_hal.reg_base->result.val);
+    uint32_t size                    = cont->cfg.len / WM_DRV_ADC_HALF_NUM * sizeof(int);
+    uint32_t dest                    = (uint32_t)cont->cfg.buf;
+    uint8_t i                        = 0;
+    uint8_t half                     = 0;
+
+    chain_cfg.ch       = cont->dma_ch;
+    chain_cfg.circular = (cont->cfg.scan_count == 1);
+    chain_cfg.cb       = wm_w800_drv_adc_continuous_done;
+    chain_cfg.cb_priv  = cont;
+
+    if (chain_cfg.circular) {
+        /* both halves in one circular chain, the dma never stops */
+        chain_cfg.req_src = wm_w800_drv_adc_dma_req(cont->scan[0]);
+        if (wm_drv_dma_chain_create(adc_data->adc_drv.dma_dev, &chain_cfg, &cont->chain[0][0]) != WM_DRV_DMA_STATUS_SUCCESS ||
+            wm_drv_dma_chain_add(cont->chain[0][0], src, dest, size, WM_DRV_DMA_ADDR_FIXED, WM_DRV_DMA_ADDR_INC) !=
+                WM_DRV_DMA_STATUS_SUCCESS ||
+            wm_drv_dma_chain_add(cont->chain[0][0], src, dest + size, size, WM_DRV_DMA_ADDR_FIXED, WM_DRV_DMA_ADDR_INC) !=
+                WM_DRV_DMA_STATUS_SUCCESS) {
+            return WM_ERR_FAILED;
+        }
+
+        return WM_ERR_SUCCESS;
+    }
+
+    /* the dma request follows the channel, so each channel and half has its own chain, started from the previous one */
+    for (i = 0; i < cont->cfg.scan_count; i++) {
+        chain_cfg.req_src = wm_w800_drv_adc_dma_req(cont->scan[i]);
+        for (half = 0; half < WM_DRV_ADC_HALF_NUM; half++) {
+            if (wm_drv_dma_chain_create(adc_data->adc_drv.dma_dev, &chain_cfg, &cont->chain[i][half]) !=
+                    WM_DRV_DMA_STATUS_SUCCESS ||
+                wm_drv_dma_chain_add(cont->chain[i][half], src, dest + half * size, size, WM_DRV_DMA_ADDR_FIXED,
+                                     WM_DRV_DMA_ADDR_INC) != WM_DRV_DMA_STATUS_SUCCESS) {
+                return WM_ERR_FAILED;
+            }
+        }
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static void wm_w800_drv_adc_continuous_free(wm_drv_adc_data_t *adc_data, wm_drv_adc_continuous_t *cont)
+{
+    uint8_t i    = 0;
+    uint8_t half = 0;
+
+    for (i = 0; i < WM_ADC_MAX_CHANNEL_COUNT; i++) {
+        for (half = 0; half < WM_DRV_ADC_HALF_NUM; half++) {
+            if (cont->chain[i][half]) {
+                wm_drv_dma_chain_delete(cont->chain[i][half]);
+            }
+        }
+    }
+
+    wm_drv_dma_release_ch(adc_data->adc_drv.dma_dev, cont->dma_ch, 0);
+    wm_os_internal_free(cont);
+}
+
+static int wm_w800_drv_adc_start_continuous(wm_device_t *dev, const wm_drv_adc_continuous_cfg_t *cfg)
+{
+    if (!dev || !cfg || !cfg->scan || !cfg->scan_count || cfg->scan_count > WM_ADC_MAX_CHANNEL_COUNT || !cfg->buf ||
+        !cfg->callback || !cfg->oversample || cfg->oversample > WM_DRV_ADC_OVERSAMPLE_MAX || !cfg->len ||
+        cfg->len % (WM_DRV_ADC_HALF_NUM * cfg->oversample)) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    int err                       = WM_ERR_FAILED;
+    int i                         = 0;
+    int j                         = 0;
+    wm_drv_adc_data_t *adc_data   = NULL;
+    wm_drv_adc_continuous_t *cont = NULL;
+    wm_hal_adc_config_t hal_cfg   = { 0 };
+
+    for (i = 0; i < cfg->scan_count; i++) {
+        if (!WM_ADC_CHANNEL_IS_VAILD(cfg->scan[i])) {
+            return WM_ERR_INVALID_PARAM;
+        }
+    }
+
+    adc_data = (wm_drv_adc_data_t *)dev->drv;
+
+    if (adc_data) {
+        if (WM_ADC_STATE_IDLE != adc_data->adc_drv.state) {
+            wm_log_error("adc dev not idle");
+            return WM_ERR_NOT_ALLOWED;
+        }
+
+        if (!adc_data->adc_drv.dma_dev) {
+            wm_log_error("adc dt don't have dma");
+            return WM_ERR_NOT_ALLOWED;
+        }
+
+        WM_DRV_ADC_LOCK(adc_data->adc_drv.mutex);
+        if (adc_data->adc_drv.cfg) {
+            // every scan channel must be configured
+            for (i = 0; i < cfg->scan_count; i++) {
+                for (j = 0; j < adc_data->adc_drv.cfg->adc_channel_count; j++) {
+                    if (adc_data->adc_drv.cfg->cfg[j].adc_channel == cfg->scan[i]) {
+                        break;
+                    }
+                }
+
+                if (j == adc_data->adc_drv.cfg->adc_channel_count) {
+                    wm_log_error("adc channel %d not cfg", cfg->scan[i]);
+                    WM_DRV_ADC_UNLOCK(adc_data->adc_drv.mutex);
+                    return WM_ERR_INVALID_PARAM;
+                }
+            }
+
+            cont = (wm_drv_adc_continuous_t *)wm_os_internal_calloc(1, sizeof(wm_drv_adc_continuous_t));
+            if (!cont) {
+                WM_DRV_ADC_UNLOCK(adc_data->adc_drv.mutex);
+                return WM_ERR_NO_MEM;
+            }
+            cont->dev = dev;
+            cont->cfg = *cfg;
+            memcpy(cont->scan, cfg->scan, cfg->scan_count * sizeof(wm_adc_channel_t));
+            cont->cfg.scan = cont->scan;
+
+            if (WM_ERR_SUCCESS != (err = wm_drv_dma_request_ch(adc_data->adc_drv.dma_dev, &cont->dma_ch, 0))) {
+                wm_log_error("adc dma channel req err %d", err);
+                wm_os_internal_free(cont);
+                WM_DRV_ADC_UNLOCK(adc_data->adc_drv.mutex);
+                return err;
+            }
+
+            // the continuous mode has no compare function
+            hal_cfg.adc_channel = cont->scan[0];
+            hal_cfg.pga_gain1   = WM_ADC_GAIN1_LEVEL_0;
+            hal_cfg.pga_gain2   = WM_ADC_GAIN2_LEVEL_0;
+
+            if (WM_ERR_SUCCESS != (err = wm_w800_drv_adc_continuous_create(adc_data, cont))) {
+                wm_log_error("adc dma chain err");
+            } else if (WM_ERR_SUCCESS != (err = wm_hal_adc_init(&adc_data->adc_hal, &hal_cfg))) {
+                wm_log_error("adc init err %d", err);
+            } else if (WM_DRV_DMA_STATUS_SUCCESS != wm_drv_dma_chain_start(cont->chain[0][0])) {
+                wm_log_error("adc dma start err");
+                err = WM_ERR_FAILED;
+            } else {
+                err                     = wm_hal_adc_start_continuous(&adc_data->adc_hal);
+                adc_data->adc_drv.cont  = cont;
+                adc_data->adc_drv.state = WM_ADC_STATE_RUNNING;
+            }
+
+            if (WM_ERR_SUCCESS != err) {
+                wm_w800_drv_adc_continuous_free(adc_data, cont);
+            }
+        }
+        WM_DRV_ADC_UNLOCK(adc_data->adc_drv.mutex);
+    }
+
+    return err;
+}
+
+/* called with the mutex held and continuous sampling running */
+static void wm_w800_drv_adc_continuous_halt(wm_drv_adc_data_t *adc_data)
+{
+    uint8_t i                     = 0;
+    uint8_t half                  = 0;
+    wm_drv_adc_continuous_t *cont = adc_data->adc_drv.cont;
+
+    // the done callback starts the next chain, stop them all at once
+    wm_os_internal_set_critical();
+    for (i = 0; i < cont->cfg.scan_count; i++) {
+        for (half = 0; half < WM_DRV_ADC_HALF_NUM; half++) {
+            if (cont->chain[i][half]) {
+                wm_drv_dma_chain_stop(cont->chain[i][half]);
+            }
+        }
+    }
+    wm_hal_adc_stop_continuous(&adc_data->adc_hal);
+    wm_os_internal_release_critical();
+
+    wm_w800_drv_adc_continuous_free(adc_data, cont);
+    adc_data->adc_drv.cont  = NULL;
+    adc_data->adc_drv.state = WM_ADC_STATE_IDLE;
+}
+
+static int wm_w800_drv_adc_stop_continuous(wm_device_t *dev)
+{
+    if (!dev) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    wm_drv_adc_data_t *adc_data = NULL;
+
+    adc_data = (wm_drv_adc_data_t *)dev->drv;
+
+    if (adc_data) {
+        WM_DRV_ADC_LOCK(adc_data->adc_drv.mutex);
+        if (!adc_data->adc_drv.cont) {
+            wm_log_error("adc continuous not running, no need stop");
+            WM_DRV_ADC_UNLOCK(adc_data->adc_drv.mutex);
+            return WM_ERR_NOT_ALLOWED;
+        }
+
+        wm_w800_drv_adc_continuous_halt(adc_data);
+        WM_DRV_ADC_UNLOCK(adc_data->adc_drv.mutex);
+
+        return WM_ERR_SUCCESS;
+    }
+
+    return WM_ERR_FAILED;
+}
+
 const wm_drv_adc_ops_t wm_drv_adc_ops = {
-    .init            = wm_w800_drv_adc_init,
-    .deinit          = wm_w800_drv_adc_deinit,
-    .set_cfg         = wm_w800_drv_adc_set_cfg,
-    .register_handle = wm_w800_drv_adc_register_handle,
-    .oneshot         = wm_w800_drv_adc_oneshot,
-    .polling         = wm_w800_drv_adc_polling,
-    .start_dma       = wm_w800_drv_adc_start_dma,
-    .start_intr      = wm_w800_drv_adc_start_it,
-    .stop_intr       = wm_w800_drv_adc_stop_it,
-    .read_temp       = wm_w800_drv_adc_read_temp,
-    .read_voltage    = wm_w800_drv_adc_read_voltage,
-    .cal_voltage     = wm_w800_drv_adc_cal_voltage,
+    .init             = wm_w800_drv_adc_init,
+    .deinit           = wm_w800_drv_adc_deinit,
+    .set_cfg          = wm_w800_drv_adc_set_cfg,
+    .register_handle  = wm_w800_drv_adc_register_handle,
+    .oneshot          = wm_w800_drv_adc_oneshot,
+    .polling          = wm_w800_drv_adc_polling,
+    .start_dma        = wm_w800_drv_adc_start_dma,
+    .start_intr       = wm_w800_drv_adc_start_it,
+    .stop_intr        = wm_w800_drv_adc_stop_it,
+    .read_temp        = wm_w800_drv_adc_read_temp,
+    .read_voltage     = wm_w800_drv_adc_read_voltage,
+    .cal_voltage      = wm_w800_drv_adc_cal_voltage,
+    .cal_voltage_bulk = wm_w800_drv_adc_cal_voltage_bulk,
+    .start_continuous = wm_w800_drv_adc_start_continuous,
+    .stop_continuous  = wm_w800_drv_adc_stop_continuous,
 };
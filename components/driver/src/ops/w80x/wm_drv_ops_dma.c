@@ -76,6 +76,14 @@ WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_start(wm_dma_data_t *dm
 WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_stop(wm_dma_data_t *dma_data, wm_dma_ch_t ch);
 WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_get_status(wm_dma_data_t *dma_data, wm_dma_ch_t ch,
                                                                     wm_dma_sts_info_t *dma_sts);
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_create(wm_device_t *dev, wm_drv_dma_chain_cfg_t *cfg,
+                                                                      wm_drv_dma_chain_t **chain);
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_add(wm_drv_dma_chain_t *chain, uint32_t src, uint32_t dest,
+                                                                   uint32_t len, wm_drv_dma_addr_mode_t src_mode,
+                                                                   wm_drv_dma_addr_mode_t dest_mode);
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_start(wm_drv_dma_chain_t *chain);
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_stop(wm_drv_dma_chain_t *chain);
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_delete(wm_drv_dma_chain_t *chain);
 
 WM_HAL_DMA_STATIC wm_hal_dma_desc_t dma_desc_convert[WM_DRV_DMA_CH_MAX]        = { 0 };
 WM_HAL_DMA_STATIC wm_dma_req_sel_t drv_dma_req_src_drv2hal[WM_DRV_DMA_REQ_MAX] = {
@@ -105,9 +113,39 @@ typedef struct {
     wm_drv_dma_status_t (*start_dma)(wm_dma_data_t *dma_data, wm_dma_ch_t ch);
     wm_drv_dma_status_t (*stop_dma)(wm_dma_data_t *dma_data, wm_dma_ch_t ch);
     wm_drv_dma_status_t (*get_status)(wm_dma_data_t *dma_data, wm_dma_ch_t ch, wm_dma_sts_info_t *dma_sts);
+    wm_drv_dma_status_t (*chain_create)(wm_device_t *dev, wm_drv_dma_chain_cfg_t *cfg, wm_drv_dma_chain_t **chain);
+    wm_drv_dma_status_t (*chain_add)(wm_drv_dma_chain_t *chain, uint32_t src, uint32_t dest, uint32_t len,
+                                     wm_drv_dma_addr_mode_t src_mode, wm_drv_dma_addr_mode_t dest_mode);
+    wm_drv_dma_status_t (*chain_start)(wm_drv_dma_chain_t *chain);
+    wm_drv_dma_status_t (*chain_stop)(wm_drv_dma_chain_t *chain);
+    wm_drv_dma_status_t (*chain_delete)(wm_drv_dma_chain_t *chain);
     //TODO
 } wm_drv_dma_ops_t;
 
+/**
+ * @struct wm_drv_dma_chain_desc_t
+ * @brief dma chain desc, hw desc first so the list links hw descs directly
+ */
+typedef struct wm_drv_dma_chain_desc_s {
+    wm_hal_dma_desc_t hw;
+    uint16_t seg;     /* index of the segment this desc belongs to */
+    uint8_t seg_last; /* last desc of the segment */
+} wm_drv_dma_chain_desc_t;
+
+/**
+ * @struct wm_drv_dma_chain_s
+ * @brief dma chain
+ */
+struct wm_drv_dma_chain_s {
+    wm_device_t *dev;
+    wm_drv_dma_chain_cfg_t cfg;
+    wm_drv_dma_chain_desc_t *head;
+    wm_drv_dma_chain_desc_t *tail;
+    wm_drv_dma_chain_desc_t *cur; /* next desc expected to be done */
+    uint16_t seg_num;
+    volatile bool running;
+};
+
 WM_HAL_DMA_STATIC wm_hal_dma_desc_t *wm_drv_dma_get_hal_desc(uint8_t ch)
 {
     if (ch >= WM_DRV_DMA_CH_MAX) {
@@ -118,6 +156,39 @@ WM_HAL_DMA_STATIC wm_hal_dma_desc_t *wm_drv_dma_get_hal_desc(uint8_t ch)
     return &dma_desc_convert[ch];
 }
 
+/*
+ * walk the descs done since the last irq, HW clears vld of each desc it finishes, the same as the i2s and uart
+ * rx/tx lists of the hal rely on. Stop at once if the callback stopped the chain.
+ */
+WM_DRV_DMA_STATIC void wm_drv_dma_chain_isr(wm_drv_dma_chain_t *chain)
+{
+    wm_drv_dma_chain_desc_t *desc = chain->cur;
+
+    while (desc != NULL && chain->running && !(desc->hw.vld & WM_BIT(WM_DMA_LIST_VLD))) {
+        if (chain->cfg.circular) {
+            /* give the desc back to HW, user has one loop of the chain to consume the segment */
+            desc->hw.vld = WM_BIT(WM_DMA_LIST_VLD);
+            if (desc->seg_last && chain->cfg.cb) {
+                chain->cfg.cb(chain, desc->seg, chain->cfg.cb_priv);
+            }
+        } else if (desc == chain->tail) {
+            /* give the ch back to single transfers */
+            ((wm_dma_data_t *)chain->dev->drv)->drv_ctx.chain[chain->cfg.ch] = NULL;
+            chain->running                                                    = false;
+            chain->cur                                                        = NULL;
+            /* the callback may start the chain again, leave it alone afterwards */
+            if (chain->cfg.cb) {
+                chain->cfg.cb(chain, desc->seg, chain->cfg.cb_priv);
+            }
+            return;
+        }
+
+        desc = (wm_drv_dma_chain_desc_t *)desc->hw.next;
+    }
+
+    chain->cur = desc;
+}
+
 WM_DRV_DMA_STATIC void wm_drv_dma_isr_entry(wm_dma_ch_t ch, uint32_t sts, void *priv)
 {
     wm_device_t *dev             = (wm_device_t *)priv;
@@ -128,6 +199,12 @@ WM_DRV_DMA_STATIC void wm_drv_dma_isr_entry(wm_dma_ch_t ch, uint32_t sts, void *
     if (dev != NULL) {
         WM_DRV_DMA_LOG_I("dma drv irq enter for dma dev:0x%x, ch:%d", (uint32_t)dev, ch);
 
+        /* desc chain owns the ch, descs are kept for restart */
+        if (dma_data->drv_ctx.chain[ch] != NULL) {
+            wm_drv_dma_chain_isr(dma_data->drv_ctx.chain[ch]);
+            return;
+        }
+
         /* dma done, free desc in list mode */
         desc = (wm_hal_dma_desc_t *)dma_data->drv_ctx.desc[ch];
         if (desc->extend_ctrl.chain_mode == WM_DMA_CHAIN_MODE_LIST &&
@@ -483,6 +560,183 @@ WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_get_status(wm_dma_data_
     return ret;
 }
 
+WM_DRV_DMA_STATIC void wm_w800_driver_dma_chain_free(wm_drv_dma_chain_desc_t *desc, wm_drv_dma_chain_desc_t *last)
+{
+    wm_drv_dma_chain_desc_t *tmp_desc = NULL;
+
+    while (desc != NULL) {
+        tmp_desc = desc;
+        desc     = (desc == last) ? NULL : (wm_drv_dma_chain_desc_t *)desc->hw.next;
+        WM_DRV_DMA_FREE(tmp_desc);
+    }
+}
+
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_create(wm_device_t *dev, wm_drv_dma_chain_cfg_t *cfg,
+                                                                      wm_drv_dma_chain_t **chain)
+{
+    wm_drv_dma_chain_t *new_chain = NULL;
+
+    if (cfg->ch >= WM_DRV_DMA_CH_MAX || cfg->req_src >= WM_DRV_DMA_REQ_MAX) {
+        wm_log_error("dma chain cfg err");
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+
+    new_chain = (wm_drv_dma_chain_t *)WM_DRV_DMA_MALLOC(WM_DRV_DMA_LEN_IN_BYTES(wm_drv_dma_chain_t));
+    if (new_chain == NULL) {
+        return WM_DRV_DMA_STATUS_NO_MEM;
+    }
+    WM_DRV_DMA_MEM_ZERO(new_chain, WM_DRV_DMA_LEN_IN_BYTES(wm_drv_dma_chain_t));
+    new_chain->dev = dev;
+    new_chain->cfg = *cfg;
+
+    *chain = new_chain;
+
+    return WM_DRV_DMA_STATUS_SUCCESS;
+}
+
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_add(wm_drv_dma_chain_t *chain, uint32_t src, uint32_t dest,
+                                                                   uint32_t len, wm_drv_dma_addr_mode_t src_mode,
+                                                                   wm_drv_dma_addr_mode_t dest_mode)
+{
+    wm_drv_dma_chain_desc_t *first = NULL;
+    wm_drv_dma_chain_desc_t *last  = NULL;
+    wm_drv_dma_chain_desc_t *desc  = NULL;
+    wm_drv_dma_desc_t drv_desc     = { 0 };
+    uint32_t xfer_len              = 0;
+    wm_drv_dma_status_t ret        = WM_DRV_DMA_STATUS_SUCCESS;
+
+    if (chain->running) {
+        return WM_DRV_DMA_STATUS_BUSY;
+    }
+
+    if (!len || src_mode > WM_DRV_DMA_ADDR_INC || dest_mode > WM_DRV_DMA_ADDR_INC) {
+        wm_log_error("dma chain seg err");
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+
+    drv_desc.ctrl.ch            = chain->cfg.ch;
+    drv_desc.ctrl.src_inc_mode  = src_mode;
+    drv_desc.ctrl.dest_inc_mode = dest_mode;
+    drv_desc.ctrl.int_en        = WM_DRV_DMA_CH_INT_ENABLE;
+    drv_desc.ctrl.dma_mode      = WM_DRV_DMA_LIST_MODE;
+    drv_desc.ctrl.req_src       = chain->cfg.req_src;
+
+    /* split the segment by the 16 bits len of one desc */
+    while (len) {
+        xfer_len = len > WM_DRV_DMA_CHAIN_DESC_LEN_MAX ? WM_DRV_DMA_CHAIN_DESC_LEN_MAX : len;
+
+        desc = (wm_drv_dma_chain_desc_t *)WM_DRV_DMA_MALLOC(WM_DRV_DMA_LEN_IN_BYTES(wm_drv_dma_chain_desc_t));
+        if (desc == NULL) {
+            ret = WM_DRV_DMA_STATUS_NO_MEM;
+            goto exit;
+        }
+        WM_DRV_DMA_MEM_ZERO(desc, WM_DRV_DMA_LEN_IN_BYTES(wm_drv_dma_chain_desc_t));
+
+        drv_desc.src      = src;
+        drv_desc.dest     = dest;
+        drv_desc.ctrl.len = xfer_len;
+        if ((ret = wm_w800_driver_dma_desc_convert(&drv_desc, &desc->hw)) != WM_DRV_DMA_STATUS_SUCCESS) {
+            WM_DRV_DMA_FREE(desc);
+            goto exit;
+        }
+        desc->hw.extend_ctrl.chain_mode    = WM_DMA_CHAIN_MODE_LIST;
+        desc->hw.extend_ctrl.chain_mode_en = WM_DMA_CHAIN_MODE_ENABLE;
+        desc->seg                          = chain->seg_num;
+
+        if (last != NULL) {
+            last->hw.next = &desc->hw;
+        } else {
+            first = desc;
+        }
+        last = desc;
+
+        src += (src_mode == WM_DRV_DMA_ADDR_INC) ? xfer_len : 0;
+        dest += (dest_mode == WM_DRV_DMA_ADDR_INC) ? xfer_len : 0;
+        len -= xfer_len;
+    }
+    last->seg_last = 1;
+
+    if (chain->tail != NULL) {
+        chain->tail->hw.next = &first->hw;
+    } else {
+        chain->head = first;
+    }
+    chain->tail = last;
+    chain->seg_num++;
+
+    return ret;
+exit:
+    wm_w800_driver_dma_chain_free(first, last);
+    return ret;
+}
+
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_start(wm_drv_dma_chain_t *chain)
+{
+    wm_dma_data_t *dma_data       = (wm_dma_data_t *)chain->dev->drv;
+    wm_drv_dma_chain_desc_t *desc = chain->head;
+    uint8_t ch                    = chain->cfg.ch;
+
+    if (chain->head == NULL) {
+        wm_log_error("dma chain empty");
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+
+    if (chain->running) {
+        return WM_DRV_DMA_STATUS_BUSY;
+    }
+
+    wm_hal_dma_stop(&dma_data->hal_dev, ch);
+
+    /* HW cleared vld of the descs done in the last run */
+    chain->tail->hw.next = NULL;
+    while (desc != NULL) {
+        desc->hw.vld = WM_BIT(WM_DMA_LIST_VLD);
+        desc         = (wm_drv_dma_chain_desc_t *)desc->hw.next;
+    }
+    if (chain->cfg.circular) {
+        chain->tail->hw.next = &chain->head->hw;
+    }
+
+    chain->cur                  = chain->head;
+    chain->running              = true;
+    dma_data->drv_ctx.chain[ch] = chain;
+
+    if (wm_hal_dma_config(&dma_data->hal_dev, &chain->head->hw) != WM_HAL_DMA_STATUS_SUCCESS ||
+        wm_hal_dma_start(&dma_data->hal_dev, ch) != WM_HAL_DMA_STATUS_SUCCESS) {
+        WM_DRV_DMA_LOG_E("dma chain start fail");
+        chain->running              = false;
+        dma_data->drv_ctx.chain[ch] = NULL;
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+
+    return WM_DRV_DMA_STATUS_SUCCESS;
+}
+
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_stop(wm_drv_dma_chain_t *chain)
+{
+    wm_dma_data_t *dma_data = (wm_dma_data_t *)chain->dev->drv;
+    uint8_t ch              = chain->cfg.ch;
+
+    if (dma_data->drv_ctx.chain[ch] != chain) {
+        return WM_DRV_DMA_STATUS_SUCCESS;
+    }
+
+    wm_hal_dma_stop(&dma_data->hal_dev, ch);
+    dma_data->drv_ctx.chain[ch] = NULL;
+    chain->running              = false;
+
+    return WM_DRV_DMA_STATUS_SUCCESS;
+}
+
+WM_DRV_DMA_STATIC wm_drv_dma_status_t wm_w800_driver_dma_chain_delete(wm_drv_dma_chain_t *chain)
+{
+    wm_w800_driver_dma_chain_stop(chain);
+    wm_w800_driver_dma_chain_free(chain->head, chain->tail);
+    WM_DRV_DMA_FREE(chain);
+
+    return WM_DRV_DMA_STATUS_SUCCESS;
+}
+
 const wm_drv_dma_ops_t wm_drv_dma_ops = {
     .init               = wm_w800_driver_dma_init,
     .deinit             = wm_w800_driver_dma_deinit,
@@ -493,4 +747,9 @@ const wm_drv_dma_ops_t wm_drv_dma_ops = {
     .start_dma          = wm_w800_driver_dma_start,
     .stop_dma           = wm_w800_driver_dma_stop,
     .get_status         = wm_w800_driver_dma_get_status,
+    .chain_create       = wm_w800_driver_dma_chain_create,
+    .chain_add          = wm_w800_driver_dma_chain_add,
+    .chain_start        = wm_w800_driver_dma_chain_start,
+    .chain_stop         = wm_w800_driver_dma_chain_stop,
+    .chain_delete       = wm_w800_driver_dma_chain_delete,
 };
\ No newline at end of file
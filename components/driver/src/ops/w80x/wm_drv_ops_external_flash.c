@@ -52,108 +52,187 @@ static const wm_eflash_t *wm_flash_get_current_chip(char *name)
     return p_result;
 }
 
-static int wm_drv_external_flash_write_with_erase(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
+static uint8_t *wm_drv_eflash_get_scratch(wm_drv_eflash_ctx_t *drv_ctx)
 {
-    uint8_t *tmp_buf    = NULL;
-    uint32_t sector_idx = 0, sector_offset = 0, remain_size = 0;
-    uint32_t flash_addr = offset, write_len = in_buf_len;
-    uint8_t *src_buf             = in_buf;
-    uint32_t i                   = 0;
-    wm_drv_eflash_ctx_t *drv_ctx = NULL;
-    const wm_eflash_t *cur_flash = NULL;
+    if (drv_ctx->scratch == NULL) {
+        drv_ctx->scratch = (uint8_t *)wm_os_internal_malloc(drv_ctx->p_flash->sector_size);
+        if (drv_ctx->scratch == NULL) {
+            wm_log_error("allocate sector cache memory fail!\n");
+        }
+    }
+
+    return drv_ctx->scratch;
+}
+
+//program erased flash at any address, whole pages go straight from the caller's buffer
+static int wm_drv_eflash_program(wm_device_t *dev, uint32_t flash_addr, uint8_t *buf, uint32_t len)
+{
+    wm_drv_eflash_ctx_t *drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+    const wm_eflash_t *cur_flash = drv_ctx->p_flash;
+    uint32_t page_size           = cur_flash->page_size;
+    uint32_t page_offset         = 0;
+    uint32_t n                   = 0;
+    uint8_t *scratch             = NULL;
     int ret                      = WM_ERR_SUCCESS;
 
-    if (dev->state != WM_DEV_ST_INITED) {
-        return WM_ERR_NO_INITED;
-    }
+    drv_ctx->stats.program_bytes += len;
 
-    if (!dev || !in_buf || !dev->drv || !in_buf_len) {
-        return WM_ERR_INVALID_PARAM;
+    while (len && ret == WM_ERR_SUCCESS) {
+        page_offset = flash_addr % page_size;
+        if (!page_offset && len >= page_size) {
+            n   = len / page_size * page_size;
+            ret = wm_spi_flash_program_pages(dev, cur_flash, flash_addr, buf, n / page_size);
+        } else {
+            //bytes programmed with 0xFF keep their value
+            scratch = wm_drv_eflash_get_scratch(drv_ctx);
+            if (scratch == NULL) {
+                return WM_ERR_NO_MEM;
+            }
+            n = page_size - page_offset;
+            if (n > len) {
+                n = len;
+            }
+            memset(scratch, 0xFF, page_size);
+            memcpy(scratch + page_offset, buf, n);
+            ret = wm_spi_flash_program_pages(dev, cur_flash, flash_addr - page_offset, scratch, 1);
+        }
+        flash_addr += n;
+        buf += n;
+        len -= n;
     }
 
-    drv_ctx   = (wm_drv_eflash_ctx_t *)dev->drv;
-    cur_flash = drv_ctx->p_flash;
-    assert(cur_flash != NULL);
+    return ret;
+}
 
-    if ((offset + in_buf_len) > drv_ctx->size) {
-        wm_log_error("write offset:%u, in_len:%u, flash size:%u\n", offset, in_buf_len, drv_ctx->size);
-        return WM_ERR_INVALID_PARAM;
+//read at any address, whole pages go straight to the caller's buffer
+static int wm_drv_eflash_read(wm_device_t *dev, uint32_t flash_addr, uint8_t *buf, uint32_t len)
+{
+    wm_drv_eflash_ctx_t *drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+    const wm_eflash_t *cur_flash = drv_ctx->p_flash;
+    uint32_t page_size           = cur_flash->page_size;
+    uint32_t page_offset         = 0;
+    uint32_t n                   = 0;
+    uint8_t *scratch             = NULL;
+    int ret                      = WM_ERR_SUCCESS;
+
+    while (len && ret == WM_ERR_SUCCESS) {
+        if (len >= page_size) {
+            //a read runs across page boundaries, the address needs no alignment
+            n   = len / page_size * page_size;
+            ret = wm_spi_flash_read_pages(dev, cur_flash, flash_addr, buf, n / page_size);
+        } else {
+            scratch = wm_drv_eflash_get_scratch(drv_ctx);
+            if (scratch == NULL) {
+                return WM_ERR_NO_MEM;
+            }
+            page_offset = flash_addr % page_size;
+            n           = len;
+            ret         = wm_spi_flash_read_pages(dev, cur_flash, flash_addr - page_offset, scratch,
+                                                  (page_offset + n + page_size - 1) / page_size);
+            memcpy(buf, scratch + page_offset, n);
+        }
+        flash_addr += n;
+        buf += n;
+        len -= n;
     }
 
-    tmp_buf = (uint8_t *)wm_os_internal_calloc(1, cur_flash->sector_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate sector cache memory fail!\n");
+    return ret;
+}
+
+//rewrite [from, to) of one sector with buf, or 0xFF when buf is NULL, and keep the rest of the sector
+static int wm_drv_eflash_rewrite_sector(wm_device_t *dev, uint32_t sector_addr, uint32_t from, uint32_t to, uint8_t *buf)
+{
+    wm_drv_eflash_ctx_t *drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+    const wm_eflash_t *cur_flash = drv_ctx->p_flash;
+    uint32_t sector_size         = cur_flash->sector_size;
+    uint32_t page_size           = cur_flash->page_size;
+    uint32_t head                = (from + page_size - 1) / page_size * page_size;
+    uint32_t tail                = to / page_size * page_size;
+    uint8_t *scratch             = wm_drv_eflash_get_scratch(drv_ctx);
+    int ret                      = WM_ERR_SUCCESS;
+
+    if (scratch == NULL) {
         return WM_ERR_NO_MEM;
     }
 
-    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-    sector_idx    = flash_addr / cur_flash->sector_size;    //Section addr
-    sector_offset = flash_addr % cur_flash->sector_size;    //Offset in section
-    remain_size   = cur_flash->sector_size - sector_offset; // remain size in sector
-    if (write_len <= remain_size)
-        remain_size = write_len; //Not bigger with remain size in section
-
-    while (1) {
-        if (remain_size != cur_flash->sector_size) { //will keep some region value
-            ret = wm_spi_flash_read_pages(dev, cur_flash, sector_idx * cur_flash->sector_size, tmp_buf,
-                                          cur_flash->sector_size / cur_flash->page_size);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-        }
+    ret = wm_spi_flash_read_sectors(dev, cur_flash, sector_addr, scratch, 1);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
 
-        //step1: erase current sector
-        ret = wm_spi_flash_erase_sectors(dev, cur_flash, sector_idx * cur_flash->sector_size, 1);
-        if (ret != WM_ERR_SUCCESS) {
-            break;
-        }
+    if (buf) {
+        memcpy(scratch + from, buf, to - from);
+    } else {
+        memset(scratch + from, 0xFF, to - from);
+    }
 
-        //step2: fill write value in current sector
-        for (i = 0; i < remain_size; i++) {
-            tmp_buf[i + sector_offset] = src_buf[i];
-        }
+    ret = wm_spi_flash_erase_sectors(dev, cur_flash, sector_addr, 1);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
 
-        //step3: write current sector
-        ret = wm_spi_flash_program_pages(dev, cur_flash, sector_idx * cur_flash->sector_size, tmp_buf,
-                                         cur_flash->sector_size / cur_flash->page_size);
-        if (ret != WM_ERR_SUCCESS) {
-            break;
+    //an erased range needs no programming, only the pages holding kept data
+    if (buf || tail <= head) {
+        return wm_drv_eflash_program(dev, sector_addr, scratch, sector_size);
+    }
+    if (head) {
+        ret = wm_drv_eflash_program(dev, sector_addr, scratch, head);
+    }
+    if (ret == WM_ERR_SUCCESS && tail < sector_size) {
+        ret = wm_drv_eflash_program(dev, sector_addr + tail, scratch + tail, sector_size - tail);
+    }
+
+    return ret;
+}
+
+//write buf with erase, or only erase when buf is NULL
+static int wm_drv_eflash_update(wm_device_t *dev, uint32_t flash_addr, uint8_t *buf, uint32_t len)
+{
+    wm_drv_eflash_ctx_t *drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+    const wm_eflash_t *cur_flash = drv_ctx->p_flash;
+    uint32_t sector_size         = cur_flash->sector_size;
+    uint32_t sector_offset       = flash_addr % sector_size;
+    uint32_t n                   = 0;
+    int ret                      = WM_ERR_SUCCESS;
+
+    //the first sector, when partly covered
+    if (sector_offset || len < sector_size) {
+        n = sector_size - sector_offset;
+        if (n > len) {
+            n = len;
+        }
+        ret = wm_drv_eflash_rewrite_sector(dev, flash_addr - sector_offset, sector_offset, sector_offset + n, buf);
+        flash_addr += n;
+        len -= n;
+        if (buf) {
+            buf += n;
         }
+    }
 
-        //setp4: check current sector whether enough to fill write data
-        if (write_len == remain_size) {
-            break;        //write done
-        } else {          //will write anthoer sector
-            sector_idx++; // secotr index + 1
-            sector_offset = 0;
-            src_buf += remain_size;   // secremain is current write data length
-            write_len -= remain_size; // the legth will write to sector
-            if (write_len > (cur_flash->sector_size)) {
-                remain_size = cur_flash->sector_size; // next sector still not enough fill the write value
-            } else {
-                if (write_len == 0)
-                    break;
-                remain_size = write_len; //Next section will finish
-            }
+    //the whole sectors, erased together with 64K block erase and programmed without copy
+    n = len / sector_size * sector_size;
+    if (n && ret == WM_ERR_SUCCESS) {
+        ret = wm_spi_flash_erase_sectors(dev, cur_flash, flash_addr, n / sector_size);
+        if (ret == WM_ERR_SUCCESS && buf) {
+            ret = wm_drv_eflash_program(dev, flash_addr, buf, n);
+            buf += n;
         }
+        flash_addr += n;
+        len -= n;
     }
 
-    wm_os_internal_free(tmp_buf);
-    wm_os_internal_mutex_release(drv_ctx->mutex);
+    //the last sector, when partly covered
+    if (len && ret == WM_ERR_SUCCESS) {
+        ret = wm_drv_eflash_rewrite_sector(dev, flash_addr, 0, len, buf);
+    }
 
     return ret;
 }
 
-//write by page
-static int wm_drv_external_flash_write(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
+static int wm_drv_external_flash_write_with_erase(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
 {
-    uint8_t *tmp_buf  = NULL;
-    uint32_t page_idx = 0, page_offset = 0, remain_size = 0;
-    uint32_t flash_addr = offset, write_len = in_buf_len;
-    uint8_t *src_buf             = in_buf;
-    uint32_t i                   = 0;
     wm_drv_eflash_ctx_t *drv_ctx = NULL;
-    const wm_eflash_t *cur_flash = NULL;
+    uint32_t start_ms            = 0;
     int ret                      = WM_ERR_SUCCESS;
 
     if (dev->state != WM_DEV_ST_INITED) {
@@ -164,81 +243,59 @@ static int wm_drv_external_flash_write(wm_device_t *dev, uint32_t offset, uint8_
         return WM_ERR_INVALID_PARAM;
     }
 
-    drv_ctx   = (wm_drv_eflash_ctx_t *)dev->drv;
-    cur_flash = drv_ctx->p_flash;
-    assert(cur_flash != NULL);
-
     drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+    assert(drv_ctx->p_flash != NULL);
 
     if ((offset + in_buf_len) > drv_ctx->size) {
         wm_log_error("write offset:%u, in_len:%u, flash size:%u\n", offset, in_buf_len, drv_ctx->size);
         return WM_ERR_INVALID_PARAM;
     }
 
-    tmp_buf = (uint8_t *)wm_os_internal_malloc(cur_flash->page_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate sector cache memory fail!\n");
-        return WM_ERR_NO_MEM;
-    }
-
     wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-    page_idx    = flash_addr / cur_flash->page_size;  //page addr
-    page_offset = flash_addr % cur_flash->page_size;  //Offset in page
-    remain_size = cur_flash->page_size - page_offset; // remain size in page
-    if (write_len <= remain_size)
-        remain_size = write_len; //Not bigger with remain size in page
-
-    while (1) {
-        if (remain_size != cur_flash->page_size) { //will keep some region value
-            ret = wm_spi_flash_read_pages(dev, cur_flash, page_idx * cur_flash->page_size, tmp_buf, 1);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-        }
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_eflash_update(dev, offset, in_buf, in_buf_len);
+    drv_ctx->stats.program_ms += wm_os_internal_get_time_ms() - start_ms;
+    wm_os_internal_mutex_release(drv_ctx->mutex);
 
-        //step1: fill write value in current page
-        for (i = 0; i < remain_size; i++) {
-            tmp_buf[i + page_offset] = src_buf[i];
-        }
+    return ret;
+}
 
-        //step2: write current page
-        ret = wm_spi_flash_program_pages(dev, cur_flash, page_idx * cur_flash->page_size, tmp_buf, 1);
-        if (ret != WM_ERR_SUCCESS) {
-            break;
-        }
+//write by page
+static int wm_drv_external_flash_write(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
+{
+    wm_drv_eflash_ctx_t *drv_ctx = NULL;
+    uint32_t start_ms            = 0;
+    int ret                      = WM_ERR_SUCCESS;
 
-        //setp3: check current sector whether enough to fill write data
-        if (write_len == remain_size) {
-            break;      //write done
-        } else {        //will write anthoer page
-            page_idx++; // secotr index + 1
-            page_offset = 0;
-            src_buf += remain_size;   // secremain is current write data length
-            write_len -= remain_size; // the legth will write to sector
-            if (write_len > (cur_flash->page_size)) {
-                remain_size = cur_flash->page_size; // next page still not enough fill the write value
-            } else {
-                if (write_len == 0)
-                    break;
-                remain_size = write_len; //Next page will finish
-            }
-        }
+    if (dev->state != WM_DEV_ST_INITED) {
+        return WM_ERR_NO_INITED;
+    }
+
+    if (!dev || !in_buf || !dev->drv || !in_buf_len) {
+        return WM_ERR_INVALID_PARAM;
     }
 
-    wm_os_internal_free(tmp_buf);
+    drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+    assert(drv_ctx->p_flash != NULL);
+
+    if ((offset + in_buf_len) > drv_ctx->size) {
+        wm_log_error("write offset:%u, in_len:%u, flash size:%u\n", offset, in_buf_len, drv_ctx->size);
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_eflash_program(dev, offset, in_buf, in_buf_len);
+    drv_ctx->stats.program_ms += wm_os_internal_get_time_ms() - start_ms;
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
-    return WM_ERR_SUCCESS;
+    return ret;
 }
 
 static int wm_drv_external_flash_read(wm_device_t *dev, uint32_t offset, uint8_t *out_buf, uint32_t out_len)
 {
-    uint8_t *tmp_buf    = NULL;
-    uint8_t *read_buf   = out_buf;
-    uint32_t flash_addr = offset, read_len = out_len;
-    uint32_t page_idx = 0, page_offset = 0, remain_size = 0;
     wm_drv_eflash_ctx_t *drv_ctx = NULL;
-    const wm_eflash_t *cur_flash = NULL;
+    uint32_t start_ms            = 0;
     int ret                      = WM_ERR_SUCCESS;
 
     if (dev->state != WM_DEV_ST_INITED) {
@@ -249,58 +306,19 @@ static int wm_drv_external_flash_read(wm_device_t *dev, uint32_t offset, uint8_t
         return WM_ERR_INVALID_PARAM;
     }
 
-    drv_ctx   = (wm_drv_eflash_ctx_t *)dev->drv;
-    cur_flash = drv_ctx->p_flash;
-    assert(cur_flash != NULL);
+    drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+    assert(drv_ctx->p_flash != NULL);
 
     if ((offset + out_len) > drv_ctx->size) {
         wm_log_error("read offset:%u, out_len:%u, flash size:%u\n", offset, out_len, drv_ctx->size);
         return WM_ERR_INVALID_PARAM;
     }
 
-    tmp_buf = (uint8_t *)wm_os_internal_malloc(cur_flash->page_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate page memory fail!\n");
-        return WM_ERR_NO_MEM;
-    }
-
     wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-
-    page_idx    = flash_addr / cur_flash->page_size;  //Section addr
-    page_offset = flash_addr % cur_flash->page_size;  //Offset in section
-    remain_size = cur_flash->page_size - page_offset; // remain size in sector
-
-    if (read_len <= remain_size) {
-        remain_size = read_len;
-    }
-
-    while (1) {
-        ret = wm_spi_flash_read_pages(dev, cur_flash, page_idx * cur_flash->page_size, tmp_buf, 1);
-        if (ret != WM_ERR_SUCCESS) {
-            break;
-        }
-        memcpy(read_buf, tmp_buf + page_offset, remain_size);
-
-        if (read_len == remain_size) {
-            break;      //read done
-        } else {        //will write anthoer sector
-            page_idx++; // secotr index + 1
-            page_offset = 0;
-            read_buf += remain_size; // secremain is current write data length
-            read_len -= remain_size; // the legth will write to sector
-
-            if (read_len > (cur_flash->page_size)) {
-                remain_size = cur_flash->page_size;
-            } else {
-                if (read_len == 0) {
-                    break;
-                }
-                remain_size = read_len; //Next section will finish
-            }
-        }
-    }
-
-    wm_os_internal_free(tmp_buf);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_eflash_read(dev, offset, out_buf, out_len);
+    drv_ctx->stats.read_bytes += out_len;
+    drv_ctx->stats.read_ms += wm_os_internal_get_time_ms() - start_ms;
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
     return ret;
@@ -334,11 +352,8 @@ static int wm_drv_external_flash_get_device_info(wm_device_t *dev, wm_drv_flash_
 
 static int wm_drv_external_flash_erase_region(wm_device_t *dev, uint32_t offset, uint32_t erase_len)
 {
-    uint8_t *tmp_buf       = NULL;
-    uint32_t secotr_offset = 0, left_erase_len = erase_len, secotr_start_idx = 0, erase_len_offset = 0;
-    uint32_t flash_addr          = offset;
     wm_drv_eflash_ctx_t *drv_ctx = NULL;
-    const wm_eflash_t *cur_flash = NULL;
+    uint32_t start_ms            = 0;
     int ret                      = WM_ERR_SUCCESS;
 
     if (dev->state != WM_DEV_ST_INITED) {
@@ -349,179 +364,18 @@ static int wm_drv_external_flash_erase_region(wm_device_t *dev, uint32_t offset,
         return WM_ERR_INVALID_PARAM;
     }
 
-    drv_ctx   = (wm_drv_eflash_ctx_t *)dev->drv;
-    cur_flash = drv_ctx->p_flash;
-    assert(cur_flash != NULL);
+    drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+    assert(drv_ctx->p_flash != NULL);
 
     if ((offset + erase_len) > drv_ctx->size) {
         wm_log_error("erase offset:%u, out_len:%u, flash size:%u\n", offset, erase_len, drv_ctx->size);
         return WM_ERR_INVALID_PARAM;
     }
 
-    tmp_buf = (uint8_t *)wm_os_internal_malloc(cur_flash->sector_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate sector tmp_buf memory fail!\n");
-        return WM_ERR_NO_MEM;
-    }
-
     wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-
-    /********************************************************
-    **
-    ** x: is erase region
-    **
-    ** case1:  |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|___________________________________|______________________
-    **      sector1       secotr_offset              sector2                            sector3
-    **
-    ** case2:  |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxx___________________________|______________________
-    **      sector1       secotr_offset              sector2  erase_len_offset           sector3
-    **
-    ** case3:  |__________xxxxxxxxxxxxxxxxxxxx_______|___________________________________|______________________
-    **      sector1       secotr_offset              sector2                            sector3
-    **
-    ** case4:  |__________xxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxxxxxxx_____________________|______________________
-    **      sector1       secotr_offset              sector2      erase_len_offset       sector3
-    **
-    ** case5:  |__________xxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxxxxxxx__________
-    **      sector1       secotr_offset              sector2                            sector3       erase_len_offset
-    **
-    **
-    ***********************************************************/
-    secotr_start_idx = flash_addr / cur_flash->sector_size;
-    secotr_offset    = flash_addr % cur_flash->sector_size;
-    //erase_len_offset = erase_len % cur_flash->sector_size;
-    erase_len_offset = (erase_len + secotr_offset) % cur_flash->sector_size;
-
-    do {
-        /** case1:  |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|___________________________________|______________________
-        **      secotr_start_idx                    sector2                              sector3
-        **/
-        if (!secotr_offset && !erase_len_offset) {
-            ret = wm_spi_flash_erase_sectors(dev, cur_flash, secotr_start_idx * cur_flash->sector_size,
-                                             erase_len / cur_flash->sector_size);
-            break;
-        }
-
-        /** case2:  |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxx________________________________|______________________
-        **      secotr_start_idx                     sector2    erase_len_offset                          sector3
-        **/
-        if (!secotr_offset && erase_len_offset) {
-            uint32_t ers_sector_num      = erase_len / cur_flash->sector_size + 1;
-            uint32_t recovery_start_addr = 0;
-            //step1: save last sector data
-            ret = wm_spi_flash_read_sectors(dev, cur_flash, (secotr_start_idx + (ers_sector_num - 1)) * cur_flash->sector_size,
-                                            tmp_buf, 1);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            //step2 erase sector
-            ret = wm_spi_flash_erase_sectors(dev, cur_flash, secotr_start_idx * cur_flash->sector_size, ers_sector_num);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            //handle the last sector
-            recovery_start_addr = (secotr_start_idx + ers_sector_num - 1) * cur_flash->sector_size;
-            for (int i = 0; i < erase_len_offset; i++) {
-                tmp_buf[i] = 0xFF;
-            }
-            ret = wm_spi_flash_program_pages(dev, cur_flash, recovery_start_addr, tmp_buf,
-                                             cur_flash->sector_size / cur_flash->page_size);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            break;
-        }
-
-        /** case3:  |__________xxxxxxxxxxxxxxxxxxxx_______|___________________________________|______________________
-        **      sector1       secotr_offset              sector2                            sector3
-        **/
-        if (secotr_offset && ((secotr_offset + erase_len) <= cur_flash->sector_size)) {
-            ret = wm_spi_flash_read_sectors(dev, cur_flash, secotr_start_idx * cur_flash->sector_size, tmp_buf, 1);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            for (int i = secotr_offset; i < (secotr_offset + erase_len); i++) {
-                tmp_buf[i] = 0xFF;
-            }
-            ret = wm_spi_flash_erase_sectors(dev, cur_flash, secotr_start_idx * cur_flash->sector_size, 1);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            ret = wm_spi_flash_program_pages(dev, cur_flash, secotr_start_idx * cur_flash->sector_size, tmp_buf,
-                                             cur_flash->sector_size / cur_flash->page_size);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            break;
-        }
-
-        /** case4:  |__________xxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxxxxxxx_____________________|______________________
-        **      sector1       secotr_offset              sector2     erase_len_offset         sector3
-        **/
-        if (secotr_offset && ((secotr_offset + erase_len) > cur_flash->sector_size)) {
-            uint32_t fist_page_addr = 0, last_page_addr = 0;
-            //step1: read the first erase sector
-            fist_page_addr = secotr_start_idx * cur_flash->sector_size;
-            ret            = wm_spi_flash_read_sectors(dev, cur_flash, fist_page_addr, tmp_buf, 1);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            ret = wm_spi_flash_erase_sectors(dev, cur_flash, fist_page_addr, 1);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            for (int i = secotr_offset; i < cur_flash->sector_size; i++) {
-                tmp_buf[i] = 0xFF;
-            }
-            ret = wm_spi_flash_program_pages(dev, cur_flash, fist_page_addr, tmp_buf,
-                                             cur_flash->sector_size / cur_flash->page_size);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            left_erase_len = left_erase_len - (cur_flash->sector_size - secotr_offset);
-            if (left_erase_len / cur_flash->sector_size) {
-                ret = wm_spi_flash_erase_sectors(dev, cur_flash, (secotr_start_idx + 1) * cur_flash->sector_size,
-                                                 left_erase_len / cur_flash->sector_size);
-                if (ret != WM_ERR_SUCCESS) {
-                    break;
-                }
-            }
-            //step4 erase last sector and recover the region shoule not be erase
-            last_page_addr = (secotr_start_idx + left_erase_len / cur_flash->sector_size + 1) * cur_flash->sector_size;
-            ret            = wm_spi_flash_read_sectors(dev, cur_flash, last_page_addr, tmp_buf, 1);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            ret = wm_spi_flash_erase_sectors(dev, cur_flash, last_page_addr, 1);
-            if (ret != WM_ERR_SUCCESS) {
-                break;
-            }
-
-            for (int i = 0; i < erase_len_offset; i++) {
-                tmp_buf[i] = 0xFF;
-            }
-            ret = wm_spi_flash_program_pages(dev, cur_flash, last_page_addr, tmp_buf,
-                                             cur_flash->sector_size / cur_flash->page_size);
-            break;
-        }
-
-        wm_log_error("err case, offset: %u, len_off: %u, ers_len: %u\n", secotr_offset, erase_len_offset, erase_len);
-        ret = WM_ERR_FAILED;
-        break;
-
-    } while (1);
-
-    wm_os_internal_free(tmp_buf);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_eflash_update(dev, offset, NULL, erase_len);
+    drv_ctx->stats.erase_ms += wm_os_internal_get_time_ms() - start_ms;
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
     return ret;
@@ -532,6 +386,7 @@ static int wm_drv_external_flash_erase_sector(wm_device_t *dev, uint32_t sector_
     int ret                      = WM_ERR_SUCCESS;
     wm_drv_eflash_ctx_t *drv_ctx = NULL;
     const wm_eflash_t *cur_flash = NULL;
+    uint32_t start_ms            = 0;
 
     if (dev->state != WM_DEV_ST_INITED) {
         return WM_ERR_NO_INITED;
@@ -551,7 +406,9 @@ static int wm_drv_external_flash_erase_sector(wm_device_t *dev, uint32_t sector_
     }
 
     wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-    ret = wm_spi_flash_erase_sectors(dev, cur_flash, sector_idx * cur_flash->sector_size, sector_count);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_spi_flash_erase_sectors(dev, cur_flash, sector_idx * cur_flash->sector_size, sector_count);
+    drv_ctx->stats.erase_ms += wm_os_internal_get_time_ms() - start_ms;
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
     return ret;
@@ -582,6 +439,48 @@ static int wm_drv_external_flash_erase_chip(wm_device_t *dev)
     return ret;
 }
 
+static int wm_drv_external_flash_get_stats(wm_device_t *dev, wm_drv_flash_stats_t *stats)
+{
+    wm_drv_eflash_ctx_t *drv_ctx = NULL;
+
+    if (dev->state != WM_DEV_ST_INITED) {
+        return WM_ERR_NO_INITED;
+    }
+
+    if (!dev->drv || !stats) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+
+    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
+    *stats = drv_ctx->stats;
+    wm_os_internal_mutex_release(drv_ctx->mutex);
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_drv_external_flash_reset_stats(wm_device_t *dev)
+{
+    wm_drv_eflash_ctx_t *drv_ctx = NULL;
+
+    if (dev->state != WM_DEV_ST_INITED) {
+        return WM_ERR_NO_INITED;
+    }
+
+    if (!dev->drv) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    drv_ctx = (wm_drv_eflash_ctx_t *)dev->drv;
+
+    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
+    memset(&drv_ctx->stats, 0, sizeof(drv_ctx->stats));
+    wm_os_internal_mutex_release(drv_ctx->mutex);
+
+    return WM_ERR_SUCCESS;
+}
+
 static int wm_drv_external_flash_init(wm_device_t *dev)
 {
     wm_drv_eflash_ctx_t *drv_ctx = NULL;
@@ -672,6 +571,9 @@ static int wm_drv_external_flash_deinit(wm_device_t *dev)
             dev->drv = NULL;
             wm_os_internal_mutex_delete(drv_ctx->mutex);
             drv_ctx->mutex = NULL;
+            if (drv_ctx->scratch) {
+                wm_os_internal_free(drv_ctx->scratch);
+            }
             wm_os_internal_free(drv_ctx);
             dev->state = WM_DEV_ST_UNINIT;
         } else {
@@ -692,4 +594,6 @@ const wm_drv_flash_ops_t wm_drv_external_flash_ops = {
     .erase_region     = wm_drv_external_flash_erase_region,
     .erase_sector     = wm_drv_external_flash_erase_sector,
     .erase_chip       = wm_drv_external_flash_erase_chip,
+    .get_stats        = wm_drv_external_flash_get_stats,
+    .reset_stats      = wm_drv_external_flash_reset_stats,
 };
@@ -386,6 +386,8 @@ int wm_spi_flash_erase_block64k(wm_device_t *dev, const wm_eflash_t *fls, uint32
             break;
         }
 
+        drv_ctx->stats.erase_blocks++;
+        drv_ctx->stats.erase_bytes += WM_FLS_BLOCK_SIZE;
         block_num--;
         flash_addr += WM_FLS_BLOCK_SIZE;
         tmp_addr = flash_addr;
@@ -433,6 +435,8 @@ static int wm_spi_flash_erase_by_sector(wm_device_t *dev, const wm_eflash_t *fls
             break;
         }
 
+        drv_ctx->stats.erase_sectors++;
+        drv_ctx->stats.erase_bytes += fls->sector_size;
         sector_num--;
         flash_addr += fls->sector_size;
         tmp_addr = flash_addr;
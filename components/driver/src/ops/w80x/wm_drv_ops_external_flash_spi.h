@@ -78,6 +78,8 @@ typedef struct {
     wm_device_t *spi_device;
     wm_device_t *rcc_device;
     const wm_eflash_t *p_flash;
+    uint8_t *scratch; //sector size, for unaligned pages and read-modify-write, allocated on first use
+    wm_drv_flash_stats_t stats;
 } wm_drv_eflash_ctx_t;
 
 /**
@@ -34,104 +34,231 @@
 
 #define WM_FT_REGION 0x2000 //ref: wm_partition_table_print
 
+#define WM_IFLS_BLOCK32_SIZE (32 * 1024)
+#define WM_IFLS_BLOCK64_SIZE (64 * 1024)
+
 typedef struct {
     wm_os_mutex_t *mutex;
     wm_hal_flash_dev_t hal_dev;
+    uint8_t *scratch; //sector size, for unaligned pages and read-modify-write, allocated on first use
+    wm_drv_flash_stats_t stats;
 } wm_drv_iflash_ctx_t;
 
-static int wm_drv_internal_flash_write_with_erase(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
+static uint8_t *wm_drv_iflash_get_scratch(wm_drv_iflash_ctx_t *drv_ctx)
 {
-    uint8_t *tmp_buf    = NULL;
-    uint32_t secotr_idx = 0, sector_offset = 0, remain_size = 0;
-    uint32_t flash_addr = offset, write_len = in_buf_len;
-    uint8_t *src_buf             = in_buf;
-    uint32_t i                   = 0;
-    wm_hal_flash_dev_t *hal_dev  = NULL;
-    wm_drv_iflash_ctx_t *drv_ctx = NULL;
+    if (drv_ctx->scratch == NULL) {
+        drv_ctx->scratch = (uint8_t *)wm_os_internal_malloc(drv_ctx->hal_dev.device_info.sector_size);
+        if (drv_ctx->scratch == NULL) {
+            wm_log_error("allocate sector cache memory fail!\n");
+        }
+    }
 
-    if (!dev || !in_buf || !dev->drv || !in_buf_len) {
-        return WM_ERR_INVALID_PARAM;
+    return drv_ctx->scratch;
+}
+
+//erase whole sectors, aligned spans go with one 64K or 32K block erase instead of 16 or 8 sector erases
+static int wm_drv_iflash_erase(wm_drv_iflash_ctx_t *drv_ctx, uint32_t flash_addr, uint32_t sector_num)
+{
+    wm_hal_flash_dev_t *hal_dev = &drv_ctx->hal_dev;
+    uint32_t sector_size        = hal_dev->device_info.sector_size;
+    uint32_t erase_len          = sector_num * sector_size;
+    uint32_t step               = 0;
+    int ret                     = WM_ERR_SUCCESS;
+
+    while (erase_len && ret == WM_ERR_SUCCESS) {
+        if (!(flash_addr % WM_IFLS_BLOCK64_SIZE) && erase_len >= WM_IFLS_BLOCK64_SIZE &&
+            wm_hal_flash_erase_block(hal_dev, flash_addr, WM_IFLS_BLOCK64_SIZE) == WM_ERR_SUCCESS) {
+            step = WM_IFLS_BLOCK64_SIZE;
+        } else if (!(flash_addr % WM_IFLS_BLOCK32_SIZE) && erase_len >= WM_IFLS_BLOCK32_SIZE &&
+                   wm_hal_flash_erase_block(hal_dev, flash_addr, WM_IFLS_BLOCK32_SIZE) == WM_ERR_SUCCESS) {
+            step = WM_IFLS_BLOCK32_SIZE;
+        } else {
+            ret  = wm_hal_flash_erase_sectors(hal_dev, flash_addr, 1);
+            step = sector_size;
+        }
+
+        if (step == sector_size) {
+            drv_ctx->stats.erase_sectors++;
+        } else {
+            drv_ctx->stats.erase_blocks++;
+        }
+        drv_ctx->stats.erase_bytes += step;
+        flash_addr += step;
+        erase_len -= step;
     }
 
-    drv_ctx = (wm_drv_iflash_ctx_t *)dev->drv;
-    hal_dev = &drv_ctx->hal_dev;
+    return ret;
+}
 
-    if ((offset + in_buf_len) > hal_dev->device_info.size) {
-        wm_log_error("write offset:%u, in_len:%u, flash size:%u\n", offset, in_buf_len, hal_dev->device_info.size);
-        return WM_ERR_INVALID_PARAM;
+//program erased flash at any address, whole pages go straight from the caller's buffer
+static int wm_drv_iflash_program(wm_drv_iflash_ctx_t *drv_ctx, uint32_t flash_addr, uint8_t *buf, uint32_t len)
+{
+    wm_hal_flash_dev_t *hal_dev = &drv_ctx->hal_dev;
+    uint32_t page_size          = hal_dev->device_info.page_size;
+    uint32_t page_offset        = 0;
+    uint32_t n                  = 0;
+    uint8_t *scratch            = NULL;
+    int ret                     = WM_ERR_SUCCESS;
+
+    drv_ctx->stats.program_bytes += len;
+
+    while (len && ret == WM_ERR_SUCCESS) {
+        page_offset = flash_addr % page_size;
+        if (!page_offset && len >= page_size) {
+            n   = len / page_size * page_size;
+            ret = wm_hal_flash_write_pages(hal_dev, flash_addr, buf, n / page_size);
+        } else {
+            //bytes programmed with 0xFF keep their value
+            scratch = wm_drv_iflash_get_scratch(drv_ctx);
+            if (scratch == NULL) {
+                return WM_ERR_NO_MEM;
+            }
+            n = page_size - page_offset;
+            if (n > len) {
+                n = len;
+            }
+            memset(scratch, 0xFF, page_size);
+            memcpy(scratch + page_offset, buf, n);
+            ret = wm_hal_flash_write_pages(hal_dev, flash_addr - page_offset, scratch, 1);
+        }
+        flash_addr += n;
+        buf += n;
+        len -= n;
     }
 
-    if (offset <= WM_FT_REGION) {
-        wm_log_error("cannot write or erase FT region: 0 ~ 0x%x\n", WM_FT_REGION);
-        return WM_ERR_INVALID_PARAM;
+    return ret;
+}
+
+//read at any address, whole pages go straight to a word aligned caller's buffer
+static int wm_drv_iflash_read(wm_drv_iflash_ctx_t *drv_ctx, uint32_t flash_addr, uint8_t *buf, uint32_t len)
+{
+    wm_hal_flash_dev_t *hal_dev = &drv_ctx->hal_dev;
+    uint32_t page_size          = hal_dev->device_info.page_size;
+    uint32_t page_offset        = 0;
+    uint32_t n                  = 0;
+    uint8_t *scratch            = NULL;
+    int ret                     = WM_ERR_SUCCESS;
+
+    while (len && ret == WM_ERR_SUCCESS) {
+        page_offset = flash_addr % page_size;
+        if (!page_offset && len >= page_size && !((uint32_t)buf % 4)) {
+            n   = len / page_size * page_size;
+            ret = wm_hal_flash_read_pages(hal_dev, flash_addr, buf, n / page_size);
+        } else {
+            scratch = wm_drv_iflash_get_scratch(drv_ctx);
+            if (scratch == NULL) {
+                return WM_ERR_NO_MEM;
+            }
+            n = hal_dev->device_info.sector_size - page_offset;
+            if (n > len) {
+                n = len;
+            }
+            ret = wm_hal_flash_read_pages(hal_dev, flash_addr - page_offset, scratch,
+                                          (page_offset + n + page_size - 1) / page_size);
+            memcpy(buf, scratch + page_offset, n);
+        }
+        flash_addr += n;
+        buf += n;
+        len -= n;
     }
 
-    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-    tmp_buf = (uint8_t *)wm_os_internal_malloc(hal_dev->device_info.sector_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate sector cache memory fail!\n");
-        wm_os_internal_mutex_release(drv_ctx->mutex);
+    return ret;
+}
+
+//rewrite [from, to) of one sector with buf, or 0xFF when buf is NULL, and keep the rest of the sector
+static int wm_drv_iflash_rewrite_sector(wm_drv_iflash_ctx_t *drv_ctx, uint32_t sector_addr, uint32_t from, uint32_t to,
+                                        uint8_t *buf)
+{
+    wm_hal_flash_dev_t *hal_dev = &drv_ctx->hal_dev;
+    uint32_t sector_size        = hal_dev->device_info.sector_size;
+    uint32_t page_size          = hal_dev->device_info.page_size;
+    uint32_t head               = (from + page_size - 1) / page_size * page_size;
+    uint32_t tail               = to / page_size * page_size;
+    uint8_t *scratch            = wm_drv_iflash_get_scratch(drv_ctx);
+    int ret                     = WM_ERR_SUCCESS;
+
+    if (scratch == NULL) {
         return WM_ERR_NO_MEM;
     }
 
-    secotr_idx    = flash_addr / hal_dev->device_info.sector_size;    //Section addr
-    sector_offset = flash_addr % hal_dev->device_info.sector_size;    //Offset in section
-    remain_size   = hal_dev->device_info.sector_size - sector_offset; // remain size in sector
-    if (write_len <= remain_size)
-        remain_size = write_len; //Not bigger with remain size in section
+    ret = wm_hal_flash_read_sectors(hal_dev, sector_addr, scratch, 1);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
 
-    while (1) {
-        if (remain_size != hal_dev->device_info.sector_size) { //will keep some region value
-            wm_hal_flash_read_pages(hal_dev, secotr_idx * hal_dev->device_info.sector_size, tmp_buf,
-                                    hal_dev->device_info.sector_size / hal_dev->device_info.page_size);
-        }
+    if (buf) {
+        memcpy(scratch + from, buf, to - from);
+    } else {
+        memset(scratch + from, 0xFF, to - from);
+    }
+
+    ret = wm_drv_iflash_erase(drv_ctx, sector_addr, 1);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    //an erased range needs no programming, only the pages holding kept data
+    if (buf || tail <= head) {
+        return wm_drv_iflash_program(drv_ctx, sector_addr, scratch, sector_size);
+    }
+    if (head) {
+        ret = wm_drv_iflash_program(drv_ctx, sector_addr, scratch, head);
+    }
+    if (ret == WM_ERR_SUCCESS && tail < sector_size) {
+        ret = wm_drv_iflash_program(drv_ctx, sector_addr + tail, scratch + tail, sector_size - tail);
+    }
 
-        //step1: erase current sector
-        wm_hal_flash_erase_sectors(hal_dev, secotr_idx * hal_dev->device_info.sector_size, 1);
+    return ret;
+}
 
-        //step2: fill write value in current sector
-        for (i = 0; i < remain_size; i++) {
-            tmp_buf[i + sector_offset] = src_buf[i];
+//write buf with erase, or only erase when buf is NULL
+static int wm_drv_iflash_update(wm_drv_iflash_ctx_t *drv_ctx, uint32_t flash_addr, uint8_t *buf, uint32_t len)
+{
+    uint32_t sector_size   = drv_ctx->hal_dev.device_info.sector_size;
+    uint32_t sector_offset = flash_addr % sector_size;
+    uint32_t n             = 0;
+    int ret                = WM_ERR_SUCCESS;
+
+    //the first sector, when partly covered
+    if (sector_offset || len < sector_size) {
+        n = sector_size - sector_offset;
+        if (n > len) {
+            n = len;
+        }
+        ret = wm_drv_iflash_rewrite_sector(drv_ctx, flash_addr - sector_offset, sector_offset, sector_offset + n, buf);
+        flash_addr += n;
+        len -= n;
+        if (buf) {
+            buf += n;
         }
+    }
 
-        //step3: write current sector
-        wm_hal_flash_write_pages(hal_dev, secotr_idx * hal_dev->device_info.sector_size, tmp_buf,
-                                 hal_dev->device_info.sector_size / hal_dev->device_info.page_size);
-
-        //setp4: check current sector whether enough to fill write data
-        if (write_len == remain_size) {
-            break;        //write done
-        } else {          //will write anthoer sector
-            secotr_idx++; // secotr index + 1
-            sector_offset = 0;
-            src_buf += remain_size;   // secremain is current write data length
-            write_len -= remain_size; // the legth will write to sector
-            if (write_len > (hal_dev->device_info.sector_size)) {
-                remain_size = hal_dev->device_info.sector_size; // next sector still not enough fill the write value
-            } else {
-                if (write_len == 0)
-                    break;
-                remain_size = write_len; //Next section will finish
-            }
+    //the whole sectors, erased together and programmed without copy
+    n = len / sector_size * sector_size;
+    if (n && ret == WM_ERR_SUCCESS) {
+        ret = wm_drv_iflash_erase(drv_ctx, flash_addr, n / sector_size);
+        if (ret == WM_ERR_SUCCESS && buf) {
+            ret = wm_drv_iflash_program(drv_ctx, flash_addr, buf, n);
+            buf += n;
         }
+        flash_addr += n;
+        len -= n;
     }
 
-    wm_os_internal_free(tmp_buf);
-    wm_os_internal_mutex_release(drv_ctx->mutex);
+    //the last sector, when partly covered
+    if (len && ret == WM_ERR_SUCCESS) {
+        ret = wm_drv_iflash_rewrite_sector(drv_ctx, flash_addr, 0, len, buf);
+    }
 
-    return WM_ERR_SUCCESS;
+    return ret;
 }
 
-//internal use, for FT
-int wm_drv_iflash_wr_with_erase_private(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
+static int wm_drv_internal_flash_write_with_erase(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
 {
-    uint8_t *tmp_buf    = NULL;
-    uint32_t secotr_idx = 0, sector_offset = 0, remain_size = 0;
-    uint32_t flash_addr = offset, write_len = in_buf_len;
-    uint8_t *src_buf             = in_buf;
-    uint32_t i                   = 0;
     wm_hal_flash_dev_t *hal_dev  = NULL;
     wm_drv_iflash_ctx_t *drv_ctx = NULL;
+    uint32_t start_ms            = 0;
+    int ret                      = WM_ERR_SUCCESS;
 
     if (!dev || !in_buf || !dev->drv || !in_buf_len) {
         return WM_ERR_INVALID_PARAM;
@@ -145,72 +272,53 @@ int wm_drv_iflash_wr_with_erase_private(wm_device_t *dev, uint32_t offset, uint8
         return WM_ERR_INVALID_PARAM;
     }
 
-    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-    tmp_buf = (uint8_t *)wm_os_internal_malloc(hal_dev->device_info.sector_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate sector cache memory fail!\n");
-        wm_os_internal_mutex_release(drv_ctx->mutex);
-        return WM_ERR_NO_MEM;
+    if (offset <= WM_FT_REGION) {
+        wm_log_error("cannot write or erase FT region: 0 ~ 0x%x\n", WM_FT_REGION);
+        return WM_ERR_INVALID_PARAM;
     }
 
-    secotr_idx    = flash_addr / hal_dev->device_info.sector_size;    //Section addr
-    sector_offset = flash_addr % hal_dev->device_info.sector_size;    //Offset in section
-    remain_size   = hal_dev->device_info.sector_size - sector_offset; // remain size in sector
-    if (write_len <= remain_size)
-        remain_size = write_len; //Not bigger with remain size in section
+    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_iflash_update(drv_ctx, offset, in_buf, in_buf_len);
+    drv_ctx->stats.program_ms += wm_os_internal_get_time_ms() - start_ms;
+    wm_os_internal_mutex_release(drv_ctx->mutex);
 
-    while (1) {
-        if (remain_size != hal_dev->device_info.sector_size) { //will keep some region value
-            wm_hal_flash_read_pages(hal_dev, secotr_idx * hal_dev->device_info.sector_size, tmp_buf,
-                                    hal_dev->device_info.sector_size / hal_dev->device_info.page_size);
-        }
+    return ret;
+}
 
-        //step1: erase current sector
-        wm_hal_flash_erase_sectors(hal_dev, secotr_idx * hal_dev->device_info.sector_size, 1);
+//internal use, for FT
+int wm_drv_iflash_wr_with_erase_private(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
+{
+    wm_hal_flash_dev_t *hal_dev  = NULL;
+    wm_drv_iflash_ctx_t *drv_ctx = NULL;
+    int ret                      = WM_ERR_SUCCESS;
 
-        //step2: fill write value in current sector
-        for (i = 0; i < remain_size; i++) {
-            tmp_buf[i + sector_offset] = src_buf[i];
-        }
+    if (!dev || !in_buf || !dev->drv || !in_buf_len) {
+        return WM_ERR_INVALID_PARAM;
+    }
 
-        //step3: write current sector
-        wm_hal_flash_write_pages(hal_dev, secotr_idx * hal_dev->device_info.sector_size, tmp_buf,
-                                 hal_dev->device_info.sector_size / hal_dev->device_info.page_size);
-
-        //setp4: check current sector whether enough to fill write data
-        if (write_len == remain_size) {
-            break;        //write done
-        } else {          //will write anthoer sector
-            secotr_idx++; // secotr index + 1
-            sector_offset = 0;
-            src_buf += remain_size;   // secremain is current write data length
-            write_len -= remain_size; // the legth will write to sector
-            if (write_len > (hal_dev->device_info.sector_size)) {
-                remain_size = hal_dev->device_info.sector_size; // next sector still not enough fill the write value
-            } else {
-                if (write_len == 0)
-                    break;
-                remain_size = write_len; //Next section will finish
-            }
-        }
+    drv_ctx = (wm_drv_iflash_ctx_t *)dev->drv;
+    hal_dev = &drv_ctx->hal_dev;
+
+    if ((offset + in_buf_len) > hal_dev->device_info.size) {
+        wm_log_error("write offset:%u, in_len:%u, flash size:%u\n", offset, in_buf_len, hal_dev->device_info.size);
+        return WM_ERR_INVALID_PARAM;
     }
 
-    wm_os_internal_free(tmp_buf);
+    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
+    ret = wm_drv_iflash_update(drv_ctx, offset, in_buf, in_buf_len);
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
-    return WM_ERR_SUCCESS;
+    return ret;
 }
 
 //write by page
 static int wm_drv_internal_flash_write(wm_device_t *dev, uint32_t offset, uint8_t *in_buf, uint32_t in_buf_len)
 {
-    uint8_t *tmp_buf  = NULL;
-    uint32_t page_idx = 0, page_offset = 0, remain_size = 0;
-    uint32_t flash_addr = offset, write_len = in_buf_len;
-    uint8_t *src_buf             = in_buf;
-    uint32_t i                   = 0;
     wm_hal_flash_dev_t *hal_dev  = NULL;
     wm_drv_iflash_ctx_t *drv_ctx = NULL;
+    uint32_t start_ms            = 0;
+    int ret                      = WM_ERR_SUCCESS;
 
     if (!dev || !in_buf || !dev->drv || !in_buf_len) {
         return WM_ERR_INVALID_PARAM;
@@ -230,65 +338,20 @@ static int wm_drv_internal_flash_write(wm_device_t *dev, uint32_t offset, uint8_
     }
 
     wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-
-    tmp_buf = (uint8_t *)wm_os_internal_malloc(hal_dev->device_info.page_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate sector cache memory fail!\n");
-        wm_os_internal_mutex_release(drv_ctx->mutex);
-        return WM_ERR_NO_MEM;
-    }
-    page_idx    = flash_addr / hal_dev->device_info.page_size;  //page addr
-    page_offset = flash_addr % hal_dev->device_info.page_size;  //Offset in page
-    remain_size = hal_dev->device_info.page_size - page_offset; // remain size in page
-    if (write_len <= remain_size)
-        remain_size = write_len; //Not bigger with remain size in page
-
-    while (1) {
-        if (remain_size !=
-            hal_dev->device_info.page_size) { //offset != 0, and  not write whole page, will keep some region value
-            wm_hal_flash_read_pages(hal_dev, page_idx * hal_dev->device_info.page_size, tmp_buf, 1);
-        }
-
-        //step1: fill write value in current page
-        for (i = 0; i < remain_size; i++) {
-            tmp_buf[i + page_offset] = src_buf[i];
-        }
-
-        //step2: write current page
-        wm_hal_flash_write_pages(hal_dev, page_idx * hal_dev->device_info.page_size, tmp_buf, 1);
-
-        //setp3: check current page whether enough to fill write data
-        if (write_len == remain_size) {
-            break;      //write done
-        } else {        //will write anthoer sector
-            page_idx++; // secotr index + 1
-            page_offset = 0;
-            src_buf += remain_size;   // secremain is current write data length
-            write_len -= remain_size; // the legth will write to page
-            if (write_len > (hal_dev->device_info.page_size)) {
-                remain_size = hal_dev->device_info.page_size; // next page still not enough fill the write value
-            } else {
-                if (write_len == 0)
-                    break;
-                remain_size = write_len; //Next section will finish
-            }
-        }
-    }
-
-    wm_os_internal_free(tmp_buf);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_iflash_program(drv_ctx, offset, in_buf, in_buf_len);
+    drv_ctx->stats.program_ms += wm_os_internal_get_time_ms() - start_ms;
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
-    return WM_ERR_SUCCESS;
+    return ret;
 }
 
 static int wm_drv_internal_flash_read(wm_device_t *dev, uint32_t offset, uint8_t *out_buf, uint32_t out_len)
 {
-    uint8_t *tmp_buf    = NULL;
-    uint8_t *read_buf   = out_buf;
-    uint32_t flash_addr = offset, read_len = out_len;
-    uint32_t page_idx = 0, page_offset = 0, remain_size = 0;
     wm_hal_flash_dev_t *hal_dev  = NULL;
     wm_drv_iflash_ctx_t *drv_ctx = NULL;
+    uint32_t start_ms            = 0;
+    int ret                      = WM_ERR_SUCCESS;
 
     if (!dev || !out_buf || !dev->drv || !out_len) {
         return WM_ERR_INVALID_PARAM;
@@ -303,49 +366,13 @@ static int wm_drv_internal_flash_read(wm_device_t *dev, uint32_t offset, uint8_t
     }
 
     wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-
-    tmp_buf = (uint8_t *)wm_os_internal_malloc(hal_dev->device_info.page_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate page memory fail!\n");
-        wm_os_internal_mutex_release(drv_ctx->mutex);
-        return WM_ERR_NO_MEM;
-    }
-
-    page_idx    = flash_addr / hal_dev->device_info.page_size;  //Section addr
-    page_offset = flash_addr % hal_dev->device_info.page_size;  //Offset in section
-    remain_size = hal_dev->device_info.page_size - page_offset; // remain size in sector
-
-    if (read_len <= remain_size) {
-        remain_size = read_len;
-    }
-
-    while (1) {
-        wm_hal_flash_read_pages(hal_dev, page_idx * hal_dev->device_info.page_size, tmp_buf, 1);
-        memcpy(read_buf, tmp_buf + page_offset, remain_size);
-
-        if (read_len == remain_size) {
-            break;      //read done
-        } else {        //will write anthoer sector
-            page_idx++; // secotr index + 1
-            page_offset = 0;
-            read_buf += remain_size; // secremain is current write data length
-            read_len -= remain_size; // the legth will write to sector
-
-            if (read_len > (hal_dev->device_info.page_size)) {
-                remain_size = hal_dev->device_info.page_size;
-            } else {
-                if (read_len == 0) {
-                    break;
-                }
-                remain_size = read_len; //Next section will finish
-            }
-        }
-    }
-
-    wm_os_internal_free(tmp_buf);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_iflash_read(drv_ctx, offset, out_buf, out_len);
+    drv_ctx->stats.read_bytes += out_len;
+    drv_ctx->stats.read_ms += wm_os_internal_get_time_ms() - start_ms;
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
-    return WM_ERR_SUCCESS;
+    return ret;
 }
 
 static int wm_drv_internal_flash_get_device_info(wm_device_t *dev, wm_drv_flash_info_t *flash_info)
@@ -375,11 +402,9 @@ static int wm_drv_internal_flash_get_device_info(wm_device_t *dev, wm_drv_flash_
 
 static int wm_drv_internal_flash_erase_region(wm_device_t *dev, uint32_t offset, uint32_t erase_len)
 {
-    uint8_t *tmp_buf       = NULL;
-    uint32_t secotr_offset = 0, left_erase_len = erase_len, secotr_start_idx = 0, erase_len_offset = 0;
-    uint32_t flash_addr          = offset;
     wm_hal_flash_dev_t *hal_dev  = NULL;
     wm_drv_iflash_ctx_t *drv_ctx = NULL;
+    uint32_t start_ms            = 0;
     int ret                      = WM_ERR_SUCCESS;
 
     if (!dev || !dev->drv || !erase_len) {
@@ -400,131 +425,9 @@ static int wm_drv_internal_flash_erase_region(wm_device_t *dev, uint32_t offset,
     }
 
     wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-
-    tmp_buf = (uint8_t *)wm_os_internal_malloc(hal_dev->device_info.sector_size);
-    if (tmp_buf == NULL) {
-        wm_log_error("allocate sector tmp_buf memory fail!\n");
-        wm_os_internal_mutex_release(drv_ctx->mutex);
-        return WM_ERR_NO_MEM;
-    }
-
-    /********************************************************
-    **
-    ** x: is erase region
-    **
-    ** case1:  |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|___________________________________|______________________
-    **      sector1       secotr_offset              sector2                            sector3
-    **
-    ** case2:  |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxx___________________________|______________________
-    **      sector1       secotr_offset              sector2  erase_len_offset           sector3
-    **
-    ** case3:  |__________xxxxxxxxxxxxxxxxxxxx_______|___________________________________|______________________
-    **      sector1       secotr_offset              sector2                            sector3
-    **
-    ** case4:  |__________xxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxxxxxxx_____________________|______________________
-    **      sector1       secotr_offset              sector2      erase_len_offset       sector3
-    **
-    ** case5:  |__________xxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxxxxxxx__________
-    **      sector1       secotr_offset              sector2                            sector3       erase_len_offset
-    **
-    **
-    ***********************************************************/
-    secotr_start_idx = flash_addr / hal_dev->device_info.sector_size;
-    secotr_offset    = flash_addr % hal_dev->device_info.sector_size;
-    //erase_len_offset = erase_len % hal_dev->device_info.sector_size;
-    erase_len_offset = (erase_len + secotr_offset) % hal_dev->device_info.sector_size;
-
-    do {
-        /** case1:  |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|___________________________________|______________________
-        **      secotr_start_idx                    sector2                              sector3
-        **/
-        if (!secotr_offset && !erase_len_offset) {
-            wm_hal_flash_erase_sectors(hal_dev, secotr_start_idx * hal_dev->device_info.sector_size,
-                                       erase_len / hal_dev->device_info.sector_size);
-            break;
-        }
-
-        /** case2:  |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxx________________________________|______________________
-        **      secotr_start_idx                     sector2    erase_len_offset                          sector3
-        **/
-        if (!secotr_offset && erase_len_offset) {
-            uint32_t ers_sector_num      = erase_len / hal_dev->device_info.sector_size + 1;
-            uint32_t recovery_start_addr = 0;
-            //step1: save last sector data
-            wm_hal_flash_read_sectors(hal_dev, (secotr_start_idx + (ers_sector_num - 1)) * hal_dev->device_info.sector_size,
-                                      tmp_buf, 1);
-
-            //step2 erase sector
-            wm_hal_flash_erase_sectors(hal_dev, secotr_start_idx * hal_dev->device_info.sector_size, ers_sector_num);
-
-            //handle the last sector
-            recovery_start_addr = (secotr_start_idx + ers_sector_num - 1) * hal_dev->device_info.sector_size;
-            for (int i = 0; i < erase_len_offset; i++) {
-                tmp_buf[i] = 0xFF;
-            }
-            wm_hal_flash_write_pages(hal_dev, recovery_start_addr, tmp_buf,
-                                     hal_dev->device_info.sector_size / hal_dev->device_info.page_size);
-
-            break;
-        }
-
-        /** case3:  |__________xxxxxxxxxxxxxxxxxxxx_______|___________________________________|______________________
-        **      sector1       secotr_offset              sector2                            sector3
-        **/
-        if (secotr_offset && ((secotr_offset + erase_len) <= hal_dev->device_info.sector_size)) {
-            wm_hal_flash_read_sectors(hal_dev, secotr_start_idx * hal_dev->device_info.sector_size, tmp_buf, 1);
-            for (int i = secotr_offset; i < (secotr_offset + erase_len); i++) {
-                tmp_buf[i] = 0xFF;
-            }
-            wm_hal_flash_erase_sectors(hal_dev, secotr_start_idx * hal_dev->device_info.sector_size, 1);
-            wm_hal_flash_write_pages(hal_dev, secotr_start_idx * hal_dev->device_info.sector_size, tmp_buf,
-                                     hal_dev->device_info.sector_size / hal_dev->device_info.page_size);
-
-            break;
-        }
-
-        /** case4:  |__________xxxxxxxxxxxxxxxxxxxxxxxxxxx|xxxxxxxxxxxxx_____________________|______________________
-        **      sector1       secotr_offset              sector2     erase_len_offset         sector3
-        **/
-        if (secotr_offset && ((secotr_offset + erase_len) > hal_dev->device_info.sector_size)) {
-            uint32_t fist_page_addr = 0, last_page_addr = 0;
-            //step1: read the first erase sector
-            fist_page_addr = secotr_start_idx * hal_dev->device_info.sector_size;
-            wm_hal_flash_read_sectors(hal_dev, fist_page_addr, tmp_buf, 1);
-            wm_hal_flash_erase_sectors(hal_dev, fist_page_addr, 1);
-            for (int i = secotr_offset; i < hal_dev->device_info.sector_size; i++) {
-                tmp_buf[i] = 0xFF;
-            }
-            wm_hal_flash_write_pages(hal_dev, fist_page_addr, tmp_buf,
-                                     hal_dev->device_info.sector_size / hal_dev->device_info.page_size);
-
-            left_erase_len = left_erase_len - (hal_dev->device_info.sector_size - secotr_offset);
-            if (left_erase_len / hal_dev->device_info.sector_size) {
-                wm_hal_flash_erase_sectors(hal_dev, (secotr_start_idx + 1) * hal_dev->device_info.sector_size,
-                                           left_erase_len / hal_dev->device_info.sector_size);
-            }
-            //step4 erase last sector and recover the region shoule not be erase
-            last_page_addr =
-                (secotr_start_idx + left_erase_len / hal_dev->device_info.sector_size + 1) * hal_dev->device_info.sector_size;
-            wm_hal_flash_read_sectors(hal_dev, last_page_addr, tmp_buf, 1);
-            wm_hal_flash_erase_sectors(hal_dev, last_page_addr, 1);
-
-            for (int i = 0; i < erase_len_offset; i++) {
-                tmp_buf[i] = 0xFF;
-            }
-            wm_hal_flash_write_pages(hal_dev, last_page_addr, tmp_buf,
-                                     hal_dev->device_info.sector_size / hal_dev->device_info.page_size);
-
-            break;
-        }
-
-        wm_log_error("err case, offset: %u, len_off: %u, ers_len: %u\n", secotr_offset, erase_len_offset, erase_len);
-        ret = WM_ERR_FAILED;
-        break;
-
-    } while (1);
-
-    wm_os_internal_free(tmp_buf);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_iflash_update(drv_ctx, offset, NULL, erase_len);
+    drv_ctx->stats.erase_ms += wm_os_internal_get_time_ms() - start_ms;
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
     return ret;
@@ -535,6 +438,7 @@ static int wm_drv_internal_flash_erase_sector(wm_device_t *dev, uint32_t sector_
     wm_hal_flash_dev_t *hal_dev  = NULL;
     int ret                      = WM_ERR_SUCCESS;
     wm_drv_iflash_ctx_t *drv_ctx = NULL;
+    uint32_t start_ms            = 0;
 
     if (!dev || !dev->drv || !sector_count) {
         return WM_ERR_INVALID_PARAM;
@@ -554,7 +458,9 @@ static int wm_drv_internal_flash_erase_sector(wm_device_t *dev, uint32_t sector_
     }
 
     wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
-    wm_hal_flash_erase_sectors(hal_dev, sector_idx * hal_dev->device_info.sector_size, sector_count);
+    start_ms = wm_os_internal_get_time_ms();
+    ret      = wm_drv_iflash_erase(drv_ctx, sector_idx * hal_dev->device_info.sector_size, sector_count);
+    drv_ctx->stats.erase_ms += wm_os_internal_get_time_ms() - start_ms;
     wm_os_internal_mutex_release(drv_ctx->mutex);
 
     return ret;
@@ -580,6 +486,40 @@ static int wm_drv_internal_flash_erase_chip(wm_device_t *dev)
     return ret;
 }
 
+static int wm_drv_internal_flash_get_stats(wm_device_t *dev, wm_drv_flash_stats_t *stats)
+{
+    wm_drv_iflash_ctx_t *drv_ctx = NULL;
+
+    if (!dev || !dev->drv || !stats) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    drv_ctx = (wm_drv_iflash_ctx_t *)dev->drv;
+
+    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
+    *stats = drv_ctx->stats;
+    wm_os_internal_mutex_release(drv_ctx->mutex);
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_drv_internal_flash_reset_stats(wm_device_t *dev)
+{
+    wm_drv_iflash_ctx_t *drv_ctx = NULL;
+
+    if (!dev || !dev->drv) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    drv_ctx = (wm_drv_iflash_ctx_t *)dev->drv;
+
+    wm_os_internal_mutex_acquire(drv_ctx->mutex, WM_OS_WAIT_TIME_MAX);
+    memset(&drv_ctx->stats, 0, sizeof(drv_ctx->stats));
+    wm_os_internal_mutex_release(drv_ctx->mutex);
+
+    return WM_ERR_SUCCESS;
+}
+
 //TODO: the init function will enhancement in feature
 static int wm_drv_internal_flash_init(wm_device_t *dev)
 {
@@ -633,6 +573,9 @@ static int wm_drv_internal_flash_deinit(wm_device_t *dev)
             wm_hal_flash_deinit(&drv_ctx->hal_dev);
             wm_os_internal_mutex_delete(drv_ctx->mutex);
             drv_ctx->mutex = NULL;
+            if (drv_ctx->scratch) {
+                wm_os_internal_free(drv_ctx->scratch);
+            }
             wm_os_internal_free(drv_ctx);
             dev->state = WM_DEV_ST_UNINIT;
         } else {
@@ -689,4 +632,6 @@ const wm_drv_flash_ops_t wm_drv_internal_flash_ops = {
     .erase_region     = wm_drv_internal_flash_erase_region,
     .erase_sector     = wm_drv_internal_flash_erase_sector,
     .erase_chip       = wm_drv_internal_flash_erase_chip,
+    .get_stats        = wm_drv_internal_flash_get_stats,
+    .reset_stats      = wm_drv_internal_flash_reset_stats,
 };
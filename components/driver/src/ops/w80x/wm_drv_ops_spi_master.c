@@ -52,33 +52,42 @@ static int wm_drv_spim_pin_config(wm_dt_hw_pin_cfg_t *pin_cfg, int count)
     return WM_ERR_SUCCESS;
 }
 
-static void wm_drv_spim_update_config(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t *config)
+//task context only, reading the rcc clock takes the rcc mutex
+static uint32_t wm_drv_spim_get_divider(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t *config)
 {
-    uint32_t divider                = 0;
-    uint32_t freq                   = 0;
-    uint32_t apb_clk                = 0;
-    wm_drv_spim_ctx_t *spim_drv     = NULL;
-    wm_hal_spim_dev_t *spim_hal_dev = NULL;
-
-    spim_drv     = (wm_drv_spim_ctx_t *)dev->drv;
-    spim_hal_dev = &(spim_drv->hal_dev);
+    uint32_t freq               = 0;
+    uint32_t apb_clk            = 0;
+    wm_drv_spim_ctx_t *spim_drv = (wm_drv_spim_ctx_t *)dev->drv;
 
     assert(config != NULL);
     assert(spim_drv->rcc_dev != NULL);
 
+    //if user not set clock, use default clock
+    freq = config->freq;
+    if (!config->freq) {
+        freq = WM_SPIM_DEFAULT_CLOCK;
+    }
+    apb_clk = wm_drv_rcc_get_config_clock(spim_drv->rcc_dev, WM_RCC_TYPE_WLAN) / 4;
+
+    return (apb_clk * 1000000) / (freq * 2) - 1;
+}
+
+//only write registers, also called from the transfer done interrupt by batches
+static void wm_drv_spim_set_clock(wm_device_t *dev, uint32_t divider, uint32_t mode)
+{
+    wm_hal_spim_dev_t *spim_hal_dev = &(((wm_drv_spim_ctx_t *)dev->drv)->hal_dev);
+
     if (strcmp(dev->name, "spim") == 0) {
-        //set SPI clock, if user not set clock, use default clock
-        freq = config->freq;
-        if (!config->freq) {
-            freq = WM_SPIM_DEFAULT_CLOCK;
-        }
-        apb_clk = wm_drv_rcc_get_config_clock(spim_drv->rcc_dev, WM_RCC_TYPE_WLAN) / 4;
-        divider = (apb_clk * 1000000) / (freq * 2) - 1;
         wm_hal_spim_set_cmds(spim_hal_dev, SPIM_CMD_FREQ, divider);
     }
 
     //set SPI mode
-    wm_hal_spim_set_cmds(spim_hal_dev, SPIM_CMD_MODE, config->mode);
+    wm_hal_spim_set_cmds(spim_hal_dev, SPIM_CMD_MODE, mode);
+}
+
+static void wm_drv_spim_update_config(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t *config)
+{
+    wm_drv_spim_set_clock(dev, wm_drv_spim_get_divider(dev, config), config->mode);
 }
 
 //w800 spi master driver implement
@@ -278,6 +287,46 @@ static int spim_transceive_check_arg(wm_device_t *dev, const wm_dt_hw_spim_dev_c
     return WM_ERR_SUCCESS;
 }
 
+static bool spim_transceive_use_dma(wm_drv_spim_ctx_t *spim_drv, spim_transceive_t *desc)
+{
+    if ((desc->tx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->rx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
+        (desc->tx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->tx_len != 0 && desc->rx_len > WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
+        (desc->rx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->rx_len != 0 && desc->tx_len > WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
+        ((uint32_t)(desc->tx_buf) % 4) || ((uint32_t)(desc->rx_buf) % 4) || (desc->tx_len % 4) || (desc->rx_len % 4) ||
+        !spim_drv->dma_dev) {
+        return false;
+    }
+
+    return true;
+}
+
+static void spim_transceive_set_param(wm_hal_spim_dev_t *spim_hal, spim_transceive_t *desc)
+{
+    if (desc->flags & SPI_TRANS_DUMMY_BITS) {
+        spim_hal->dummy_bits = ((spim_transceive_ex_t *)desc)->dummy_bits;
+    } else {
+        spim_hal->dummy_bits = 0;
+    }
+
+    if (desc->flags & SPI_TRANS_VARIABLE_CMD) {
+        spim_hal->cmd     = ((spim_transceive_ex_t *)desc)->cmd;
+        spim_hal->cmd_len = ((spim_transceive_ex_t *)desc)->cmd_len;
+    }
+
+    if (desc->flags & SPI_TRANS_VARIABLE_ADDR) {
+        spim_hal->addr     = ((spim_transceive_ex_t *)desc)->addr;
+        spim_hal->addr_len = ((spim_transceive_ex_t *)desc)->addr_len;
+    }
+
+    if (desc->flags & SPI_TRANS_BIG_ENDIAN) {
+        spim_hal->big_endian = true;
+        wm_hal_spim_set_cmds(spim_hal, SPIM_CMD_BIG_ENDIAN, 1);
+    } else {
+        spim_hal->big_endian = false;
+        wm_hal_spim_set_cmds(spim_hal, SPIM_CMD_BIG_ENDIAN, 0);
+    }
+}
+
 int w800_spim_transceive_sync(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t *config, spim_transceive_t *desc,
                               uint32_t ms_to_wait)
 {
@@ -331,36 +380,10 @@ int w800_spim_transceive_sync(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t *c
     }
 
     //step2 check whether use DMA
-    if ((desc->tx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->rx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
-        (desc->tx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->tx_len != 0 && desc->rx_len > WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
-        (desc->rx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->rx_len != 0 && desc->tx_len > WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
-        ((uint32_t)(desc->tx_buf) % 4) || ((uint32_t)(desc->rx_buf) % 4) || (desc->tx_len % 4) || (desc->rx_len % 4) ||
-        !spim_drv->dma_dev) {
+    if (!spim_transceive_use_dma(spim_drv, desc)) {
         use_dma = false;
     }
-    if (desc->flags & SPI_TRANS_DUMMY_BITS) {
-        spim_hal->dummy_bits = ((spim_transceive_ex_t *)desc)->dummy_bits;
-    } else {
-        spim_hal->dummy_bits = 0;
-    }
-
-    if (desc->flags & SPI_TRANS_VARIABLE_CMD) {
-        spim_hal->cmd     = ((spim_transceive_ex_t *)desc)->cmd;
-        spim_hal->cmd_len = ((spim_transceive_ex_t *)desc)->cmd_len;
-    }
-
-    if (desc->flags & SPI_TRANS_VARIABLE_ADDR) {
-        spim_hal->addr     = ((spim_transceive_ex_t *)desc)->addr;
-        spim_hal->addr_len = ((spim_transceive_ex_t *)desc)->addr_len;
-    }
-
-    if (desc->flags & SPI_TRANS_BIG_ENDIAN) {
-        spim_hal->big_endian = true;
-        wm_hal_spim_set_cmds(spim_hal, SPIM_CMD_BIG_ENDIAN, 1);
-    } else {
-        spim_hal->big_endian = false;
-        wm_hal_spim_set_cmds(spim_hal, SPIM_CMD_BIG_ENDIAN, 0);
-    }
+    spim_transceive_set_param(spim_hal, desc);
 
     if (use_dma) {
         if (desc->tx_buf) {
@@ -526,37 +549,11 @@ int w800_spim_transceive_async(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t *
         wm_drv_gpio_data_reset(config->pin_cs.pin_num);
     }
     //step2 check whether use DMA
-    if ((desc->tx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->rx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
-        (desc->tx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->tx_len != 0 && desc->rx_len > WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
-        (desc->rx_len < WM_SPIM_TRX_WITH_DMA_THRESHOLD && desc->rx_len != 0 && desc->tx_len > WM_SPIM_TRX_WITH_DMA_THRESHOLD) ||
-        ((uint32_t)(desc->tx_buf) % 4) || ((uint32_t)(desc->rx_buf) % 4) || (desc->tx_len % 4) || (desc->rx_len % 4) ||
-        !spim_drv->dma_dev) {
+    if (!spim_transceive_use_dma(spim_drv, desc)) {
         use_dma = false;
     }
 
-    if (desc->flags & SPI_TRANS_DUMMY_BITS) {
-        spim_hal->dummy_bits = ((spim_transceive_ex_t *)desc)->dummy_bits;
-    } else {
-        spim_hal->dummy_bits = 0;
-    }
-
-    if (desc->flags & SPI_TRANS_VARIABLE_CMD) {
-        spim_hal->cmd     = ((spim_transceive_ex_t *)desc)->cmd;
-        spim_hal->cmd_len = ((spim_transceive_ex_t *)desc)->cmd_len;
-    }
-
-    if (desc->flags & SPI_TRANS_VARIABLE_ADDR) {
-        spim_hal->addr     = ((spim_transceive_ex_t *)desc)->addr;
-        spim_hal->addr_len = ((spim_transceive_ex_t *)desc)->addr_len;
-    }
-
-    if (desc->flags & SPI_TRANS_BIG_ENDIAN) {
-        spim_hal->big_endian = true;
-        wm_hal_spim_set_cmds(spim_hal, SPIM_CMD_BIG_ENDIAN, 1);
-    } else {
-        spim_hal->big_endian = false;
-        wm_hal_spim_set_cmds(spim_hal, SPIM_CMD_BIG_ENDIAN, 0);
-    }
+    spim_transceive_set_param(spim_hal, desc);
 
     if (use_dma) {
         spim_hal->tx_dma_channel = WM_DMA_CH_MAX;
@@ -671,11 +668,236 @@ exit:
     return ret;
 }
 
+static void w800_spim_batch_finish(wm_device_t *dev, int result)
+{
+    wm_drv_spim_ctx_t *spim_drv = (wm_drv_spim_ctx_t *)dev->drv;
+    spim_drv_priv_t *drv_priv   = (spim_drv_priv_t *)spim_drv->priv;
+    wm_hal_spim_dev_t *spim_hal = &(spim_drv->hal_dev);
+
+    if (spim_hal->tx_dma_channel != WM_DMA_CH_MAX) {
+        wm_drv_dma_release_ch(spim_drv->dma_dev, spim_hal->tx_dma_channel, WM_DRV_SPI_MUTEX_TIMEOUT);
+        spim_hal->tx_dma_channel = WM_DMA_CH_MAX;
+    }
+    if (spim_hal->rx_dma_channel != WM_DMA_CH_MAX) {
+        wm_drv_dma_release_ch(spim_drv->dma_dev, spim_hal->rx_dma_channel, WM_DRV_SPI_MUTEX_TIMEOUT);
+        spim_hal->rx_dma_channel = WM_DMA_CH_MAX;
+    }
+
+    drv_priv->batch = NULL;
+
+    if (drv_priv->callback) {
+        drv_priv->callback(result, drv_priv->usr_callback_data);
+    }
+
+    wm_os_internal_sem_release(spim_drv->sync_async_sem);
+}
+
+//cmd, addr and dummy bytes of a batch transaction, laid out as the HAL sends them in polling mode
+static uint32_t w800_spim_batch_build_hdr(spim_drv_priv_t *drv_priv, spim_transceive_ex_t *desc)
+{
+    uint8_t *hdr     = (uint8_t *)drv_priv->batch_hdr;
+    uint8_t cmd_len  = (desc->basic.flags & SPI_TRANS_VARIABLE_CMD) ? desc->cmd_len : 0;
+    uint8_t addr_len = (desc->basic.flags & SPI_TRANS_VARIABLE_ADDR) ? desc->addr_len : 0;
+    uint8_t dummy    = (desc->basic.flags & SPI_TRANS_DUMMY_BITS) ? desc->dummy_bits : 0;
+    uint32_t len     = cmd_len + addr_len + dummy / 8 + (dummy % 8 ? 1 : 0);
+
+    memset(hdr, 0xFF, len);
+    memcpy(hdr, &desc->cmd, cmd_len);
+    memcpy(hdr + cmd_len, &desc->addr, addr_len);
+
+    return len;
+}
+
+static int w800_spim_batch_start_data(wm_device_t *dev)
+{
+    wm_drv_spim_ctx_t *spim_drv = (wm_drv_spim_ctx_t *)dev->drv;
+    spim_drv_priv_t *drv_priv   = (spim_drv_priv_t *)spim_drv->priv;
+    wm_hal_spim_dev_t *spim_hal = &(spim_drv->hal_dev);
+    spim_transceive_t *desc     = &drv_priv->batch[drv_priv->batch_idx].desc.basic;
+
+    if (spim_transceive_use_dma(spim_drv, desc) && (!desc->tx_buf || spim_hal->tx_dma_channel != WM_DMA_CH_MAX) &&
+        (!desc->rx_buf || spim_hal->rx_dma_channel != WM_DMA_CH_MAX)) {
+        return wm_hal_spim_tx_rx_dma(spim_hal, desc->tx_buf, desc->tx_len, desc->rx_buf, desc->rx_len);
+    }
+
+    return wm_hal_spim_tx_rx_it(spim_hal, desc->tx_buf, desc->tx_len, desc->rx_buf, desc->rx_len);
+}
+
+//only write registers and start the transfer, it runs in the transfer done interrupt of the previous transaction
+static int w800_spim_batch_start_one(wm_device_t *dev)
+{
+    int ret                       = WM_ERR_SUCCESS;
+    wm_drv_spim_ctx_t *spim_drv   = (wm_drv_spim_ctx_t *)dev->drv;
+    spim_drv_priv_t *drv_priv     = (spim_drv_priv_t *)spim_drv->priv;
+    wm_hal_spim_dev_t *spim_hal   = &(spim_drv->hal_dev);
+    spim_batch_transceive_t *trx  = &drv_priv->batch[drv_priv->batch_idx];
+    spim_batch_transceive_t *prev = drv_priv->batch_idx ? trx - 1 : NULL;
+    uint32_t hdr_len              = 0;
+
+    //reprogram clock and mode only when the device changes, the divider was computed on submit
+    if (!prev || prev->clk_div != trx->clk_div || prev->config->mode != trx->config->mode) {
+        wm_drv_spim_set_clock(dev, trx->clk_div, trx->config->mode);
+    }
+
+    //select cs as valid, PULL down
+    if (WM_GPIO_PIN_VALID(trx->config->pin_cs.pin_num)) {
+        wm_drv_gpio_data_reset(trx->config->pin_cs.pin_num);
+    }
+
+    //the HAL would send cmd/addr by polling, send them as an IT phase of their own instead
+    spim_hal->cmd_len    = 0;
+    spim_hal->addr_len   = 0;
+    spim_hal->dummy_bits = 0;
+    spim_hal->big_endian = (trx->desc.basic.flags & SPI_TRANS_BIG_ENDIAN) ? true : false;
+    wm_hal_spim_set_cmds(spim_hal, SPIM_CMD_BIG_ENDIAN, spim_hal->big_endian);
+
+    hdr_len                  = w800_spim_batch_build_hdr(drv_priv, &trx->desc);
+    drv_priv->batch_hdr_busy = hdr_len ? true : false;
+    if (hdr_len) {
+        ret = wm_hal_spim_tx_rx_it(spim_hal, (uint8_t *)drv_priv->batch_hdr, hdr_len, NULL, 0);
+    } else {
+        ret = w800_spim_batch_start_data(dev);
+    }
+
+    if (ret != WM_ERR_SUCCESS && WM_GPIO_PIN_VALID(trx->config->pin_cs.pin_num)) {
+        wm_drv_gpio_data_set(trx->config->pin_cs.pin_num);
+    }
+
+    return ret;
+}
+
+//run in interrupt, start the next transaction of the batch without returning to the caller
+static void w800_spim_batch_done_callback(void *user_data, int succ)
+{
+    wm_device_t *dev             = (wm_device_t *)user_data;
+    wm_drv_spim_ctx_t *spim_drv  = (wm_drv_spim_ctx_t *)dev->drv;
+    spim_drv_priv_t *drv_priv    = (spim_drv_priv_t *)spim_drv->priv;
+    spim_batch_transceive_t *trx = &drv_priv->batch[drv_priv->batch_idx];
+
+    //cmd/addr phase done, go on with the data of the same transaction while CS stays valid
+    if (succ == WM_ERR_SUCCESS && drv_priv->batch_hdr_busy) {
+        drv_priv->batch_hdr_busy = false;
+        if (trx->desc.basic.tx_len || trx->desc.basic.rx_len) {
+            succ = w800_spim_batch_start_data(dev);
+            if (succ == WM_ERR_SUCCESS) {
+                return;
+            }
+        }
+    }
+
+    //if user not ask keep alive or the batch stops here, set CS as invalid: PULL up
+    if ((succ != WM_ERR_SUCCESS || !(trx->desc.basic.flags & SPI_TRANS_CS_KEEP_ACTIVE)) &&
+        WM_GPIO_PIN_VALID(trx->config->pin_cs.pin_num)) {
+        wm_drv_gpio_data_set(trx->config->pin_cs.pin_num);
+    }
+
+    if (succ == WM_ERR_SUCCESS && ++drv_priv->batch_idx < drv_priv->batch_num) {
+        succ = w800_spim_batch_start_one(dev);
+        if (succ == WM_ERR_SUCCESS) {
+            return;
+        }
+    }
+
+    w800_spim_batch_finish(dev, succ);
+}
+
+int w800_spim_transceive_batch_async(wm_device_t *dev, spim_batch_transceive_t *batch, uint32_t count,
+                                     wm_spim_callback_t callback, void *usr_data)
+{
+    int ret                     = WM_ERR_SUCCESS;
+    bool use_dma                = false;
+    wm_drv_spim_ctx_t *spim_drv = NULL;
+    wm_hal_spim_dev_t *spim_hal = NULL;
+    spim_drv_priv_t *drv_priv   = NULL;
+
+    if (!batch || !count) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if ((ret = spim_transceive_check_arg(dev, batch[i].config, &batch[i].desc.basic)) != WM_ERR_SUCCESS) {
+            return ret;
+        }
+
+        if (batch[i].desc.basic.tx_len > WM_SPI_MAX_DMA_TXRX_LEN || batch[i].desc.basic.rx_len > WM_SPI_MAX_DMA_TXRX_LEN) {
+            wm_log_error("batch transceive %u too long\n", i);
+            return WM_ERR_INVALID_PARAM;
+        }
+    }
+
+    spim_drv = (wm_drv_spim_ctx_t *)dev->drv;
+    spim_hal = &(spim_drv->hal_dev);
+    drv_priv = (spim_drv_priv_t *)spim_drv->priv;
+    if (!spim_drv->is_init) {
+        wm_log_error("spim not init\n");
+        return WM_ERR_NO_INITED;
+    }
+
+    //step1 get lock
+    if (wm_os_internal_mutex_acquire(spim_drv->lock, WM_DRV_SPI_MUTEX_TIMEOUT) != WM_OS_STATUS_SUCCESS) {
+        wm_log_error("get lock timeout\n");
+        return WM_ERR_TIMEOUT;
+    }
+
+    //if last async transceive not commplte, wait it's done
+    ret = wm_os_internal_sem_acquire(spim_drv->sync_async_sem, HZ * WM_SPIM_MAX_WAIT_TIME);
+    if (ret != WM_OS_STATUS_SUCCESS) {
+        wm_log_error("wait sync_async_sem timeout\n");
+        ret = WM_ERR_TIMEOUT;
+        goto exit;
+    }
+
+    drv_priv->callback          = callback;
+    drv_priv->usr_callback_data = usr_data;
+    drv_priv->batch             = batch;
+    drv_priv->batch_num         = count;
+    drv_priv->batch_idx         = 0;
+    drv_priv->batch_hdr_busy    = false;
+    drv_priv->trx_with_dma      = false;
+
+    //the rcc clock is read under a mutex, get every divider here rather than in the done interrupt
+    for (uint32_t i = 0; i < count; i++) {
+        batch[i].clk_div = wm_drv_spim_get_divider(dev, batch[i].config);
+    }
+
+    //step2 request dma channels once for the whole batch, transactions not fit for DMA use IT
+    spim_hal->tx_dma_channel = WM_DMA_CH_MAX;
+    spim_hal->rx_dma_channel = WM_DMA_CH_MAX;
+    for (uint32_t i = 0; i < count && !use_dma; i++) {
+        use_dma = spim_transceive_use_dma(spim_drv, &batch[i].desc.basic);
+    }
+
+    if (use_dma) {
+        if (wm_drv_dma_request_ch(spim_drv->dma_dev, &spim_hal->tx_dma_channel, WM_DRV_SPI_MUTEX_TIMEOUT) !=
+            WM_DRV_DMA_STATUS_SUCCESS) {
+            spim_hal->tx_dma_channel = WM_DMA_CH_MAX;
+        } else if (wm_drv_dma_request_ch(spim_drv->dma_dev, &spim_hal->rx_dma_channel, WM_DRV_SPI_MUTEX_TIMEOUT) !=
+                   WM_DRV_DMA_STATUS_SUCCESS) {
+            wm_drv_dma_release_ch(spim_drv->dma_dev, spim_hal->tx_dma_channel, WM_DRV_SPI_MUTEX_TIMEOUT);
+            spim_hal->tx_dma_channel = WM_DMA_CH_MAX;
+            spim_hal->rx_dma_channel = WM_DMA_CH_MAX;
+        }
+    }
+
+    //step3 start the first transaction, the others are started from done callback
+    wm_hal_spim_register_xfer_done_callback(spim_hal, w800_spim_batch_done_callback, dev);
+    ret = w800_spim_batch_start_one(dev);
+    if (ret != WM_ERR_SUCCESS) {
+        w800_spim_batch_finish(dev, ret);
+    }
+
+exit:
+    wm_os_internal_mutex_release(spim_drv->lock);
+
+    return ret;
+}
+
 const wm_drv_spim_ops_t wm_drv_spim_ops = {
-    .init             = w800_spim_init,
-    .deinit           = w800_spim_deinit,
-    .transceive_sync  = w800_spim_transceive_sync,
-    .transceive_async = w800_spim_transceive_async,
+    .init                   = w800_spim_init,
+    .deinit                 = w800_spim_deinit,
+    .transceive_sync        = w800_spim_transceive_sync,
+    .transceive_async       = w800_spim_transceive_async,
+    .transceive_batch_async = w800_spim_transceive_batch_async,
 };
 
 const wm_drv_spis_ops_t wm_drv_spis_ops = {
@@ -49,6 +49,11 @@ typedef struct {
     bool xfer_continue;
     wm_os_sem_t *xfer_sem; //use to transceive tx/rx length over hw capibilty in one time
     uint8_t transceive_flag;
+    spim_batch_transceive_t *batch; //batch in progress, NULL if none
+    uint32_t batch_num;
+    uint32_t batch_idx;
+    bool batch_hdr_busy;                          //cmd/addr phase of the current transaction in progress
+    uint32_t batch_hdr[WM_SPIM_CMD_ADDR_LEN / 4]; //cmd/addr/dummy bytes of the current transaction
 } spim_drv_priv_t;
 
 typedef struct {
@@ -58,6 +63,8 @@ typedef struct {
                            uint32_t ms_to_wait);
     int (*transceive_async)(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t *config, spim_transceive_t *desc,
                             wm_spim_callback_t callback, void *usr_data);
+    int (*transceive_batch_async)(wm_device_t *dev, spim_batch_transceive_t *batch, uint32_t count,
+                                  wm_spim_callback_t callback, void *usr_data);
 } wm_drv_spim_ops_t;
 typedef wm_drv_spim_ops_t wm_drv_spis_ops_t;
 
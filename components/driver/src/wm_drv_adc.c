@@ -227,3 +227,54 @@ int wm_drv_adc_cal_voltage(wm_device_t *dev, int vol)
 
     return err;
 }
+
+int wm_drv_adc_cal_voltage_bulk(wm_device_t *dev, int *buf, uint32_t count)
+{
+    if (!dev || !buf) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    wm_drv_adc_ops_t *ops = NULL;
+    int err               = WM_ERR_INVALID_PARAM;
+
+    ops = dev->ops;
+    if (ops && ops->cal_voltage_bulk) {
+        err = ops->cal_voltage_bulk(dev, buf, count);
+    }
+
+    return err;
+}
+
+int wm_drv_adc_start_continuous(wm_device_t *dev, const wm_drv_adc_continuous_cfg_t *cfg)
+{
+    if (!dev || !cfg) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    wm_drv_adc_ops_t *ops = NULL;
+    int err               = WM_ERR_INVALID_PARAM;
+
+    ops = dev->ops;
+    if (ops && ops->start_continuous) {
+        err = ops->start_continuous(dev, cfg);
+    }
+
+    return err;
+}
+
+int wm_drv_adc_stop_continuous(wm_device_t *dev)
+{
+    if (!dev) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    wm_drv_adc_ops_t *ops = NULL;
+    int err               = WM_ERR_INVALID_PARAM;
+
+    ops = dev->ops;
+    if (ops && ops->stop_continuous) {
+        err = ops->stop_continuous(dev);
+    }
+
+    return err;
+}
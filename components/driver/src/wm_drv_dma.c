@@ -372,3 +372,88 @@ wm_drv_dma_status_t wm_drv_dma_transfer(wm_device_t *dma_dev, wm_dma_ch_t ch, wm
         return WM_DRV_DMA_STATUS_FAILED;
     }
 }
+
+wm_drv_dma_status_t wm_drv_dma_chain_create(wm_device_t *dma_dev, wm_drv_dma_chain_cfg_t *cfg, wm_drv_dma_chain_t **chain)
+{
+    if (dma_dev) {
+        wm_dma_data_t *dma_data = (wm_dma_data_t *)dma_dev->drv;
+        wm_drv_dma_ops_t *ops   = (wm_drv_dma_ops_t *)dma_dev->ops;
+        wm_drv_dma_status_t ret = WM_DRV_DMA_STATUS_SUCCESS;
+
+        if (!ops || !ops->chain_create || !dma_data || !cfg || !chain) {
+            WM_DRV_DMA_LOG_W("dma param error");
+            ret = WM_DRV_DMA_STATUS_FAILED;
+        } else {
+            ret = ops->chain_create(dma_dev, cfg, chain);
+            WM_DRV_DMA_LOG_I("create dma chain on ch:%d with err code:%d", cfg->ch, ret);
+        }
+
+        return ret;
+    } else {
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+}
+
+wm_drv_dma_status_t wm_drv_dma_chain_add(wm_drv_dma_chain_t *chain, uint32_t src, uint32_t dest, uint32_t len,
+                                         wm_drv_dma_addr_mode_t src_mode, wm_drv_dma_addr_mode_t dest_mode)
+{
+    if (chain) {
+        wm_drv_dma_ops_t *ops = (wm_drv_dma_ops_t *)chain->dev->ops;
+
+        if (!ops || !ops->chain_add) {
+            return WM_DRV_DMA_STATUS_FAILED;
+        }
+
+        return ops->chain_add(chain, src, dest, len, src_mode, dest_mode);
+    } else {
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+}
+
+wm_drv_dma_status_t wm_drv_dma_chain_start(wm_drv_dma_chain_t *chain)
+{
+    if (chain) {
+        wm_drv_dma_ops_t *ops = (wm_drv_dma_ops_t *)chain->dev->ops;
+
+        if (!ops || !ops->chain_start || !chain->dev->drv) {
+            WM_DRV_DMA_LOG_W("dma already deinited");
+            return WM_DRV_DMA_STATUS_FAILED;
+        }
+
+        return ops->chain_start(chain);
+    } else {
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+}
+
+wm_drv_dma_status_t wm_drv_dma_chain_stop(wm_drv_dma_chain_t *chain)
+{
+    if (chain) {
+        wm_drv_dma_ops_t *ops = (wm_drv_dma_ops_t *)chain->dev->ops;
+
+        if (!ops || !ops->chain_stop || !chain->dev->drv) {
+            WM_DRV_DMA_LOG_W("dma already deinited");
+            return WM_DRV_DMA_STATUS_FAILED;
+        }
+
+        return ops->chain_stop(chain);
+    } else {
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+}
+
+wm_drv_dma_status_t wm_drv_dma_chain_delete(wm_drv_dma_chain_t *chain)
+{
+    if (chain) {
+        wm_drv_dma_ops_t *ops = (wm_drv_dma_ops_t *)chain->dev->ops;
+
+        if (!ops || !ops->chain_delete || !chain->dev->drv) {
+            WM_DRV_DMA_LOG_W("dma already deinited");
+            return WM_DRV_DMA_STATUS_FAILED;
+        }
+
+        return ops->chain_delete(chain);
+    } else {
+        return WM_DRV_DMA_STATUS_FAILED;
+    }
+}
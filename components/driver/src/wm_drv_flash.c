@@ -151,6 +151,40 @@ int wm_drv_flash_erase_chip(wm_device_t *dev)
     return ret;
 }
 
+int wm_drv_flash_get_stats(wm_device_t *dev, wm_drv_flash_stats_t *stats)
+{
+    wm_drv_flash_ops_t *ops = NULL;
+    int ret                 = WM_ERR_INVALID_PARAM;
+
+    if (dev == NULL || stats == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    ops = dev->ops;
+    if (ops && ops->get_stats) {
+        ret = ops->get_stats(dev, stats);
+    }
+
+    return ret;
+}
+
+int wm_drv_flash_reset_stats(wm_device_t *dev)
+{
+    wm_drv_flash_ops_t *ops = NULL;
+    int ret                 = WM_ERR_INVALID_PARAM;
+
+    if (dev == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    ops = dev->ops;
+    if (ops && ops->reset_stats) {
+        ret = ops->reset_stats(dev);
+    }
+
+    return ret;
+}
+
 int wm_drv_flash_deinit(wm_device_t *dev)
 {
     wm_drv_flash_ops_t *ops = NULL;
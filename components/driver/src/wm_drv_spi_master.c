@@ -61,6 +61,24 @@ int wm_drv_spim_transceive_async(wm_device_t *dev, const wm_dt_hw_spim_dev_cfg_t
     return ret;
 }
 
+int wm_drv_spim_transceive_batch_async(wm_device_t *dev, spim_batch_transceive_t *batch, uint32_t count,
+                                       wm_spim_callback_t callback, void *usr_data)
+{
+    wm_drv_spim_ops_t *ops = NULL;
+    int ret                = WM_ERR_INVALID_PARAM;
+
+    if (dev == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    ops = dev->ops;
+    if (ops && ops->transceive_batch_async) {
+        ret = ops->transceive_batch_async(dev, batch, count, callback, usr_data);
+    }
+
+    return ret;
+}
+
 wm_device_t *wm_drv_spim_init(const char *dev_name)
 {
     wm_device_t *spim_dev  = NULL;
@@ -124,6 +124,19 @@ DRESULT wm_diskio_ioctl(BYTE pdrv, BYTE cmd, void *buff)
     return s_diskio_ops[pdrv]->ioctl(pdrv, cmd, buff);
 }
 
+DRESULT wm_diskio_deinit(BYTE pdrv)
+{
+    if (pdrv >= FF_VOLUMES || s_diskio_ops[pdrv] == NULL) {
+        return RES_PARERR;
+    }
+
+    if (s_diskio_ops[pdrv]->deinit == NULL) {
+        return RES_OK;
+    }
+
+    return s_diskio_ops[pdrv]->deinit(pdrv);
+}
+
 DWORD get_fattime(void)
 {
     struct tm tm                = { 0 };
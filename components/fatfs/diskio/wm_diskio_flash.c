@@ -21,16 +21,259 @@
  *  limitations under the License.
  */
 
+#include <string.h>
 #include "wm_diskio_flash.h"
 #include "wm_drv_flash.h"
 #include "wm_partition_table.h"
+#include "wm_osal.h"
 #include "wm_error.h"
+#if CONFIG_FATFS_FLASH_FTL
+#include "wm_diskio_flash_ftl.h"
+#endif
 
 #define LOG_TAG "diskio_flash"
 #include "wm_log.h"
 
 #define FATFS_FLASH_SECTOR_SIZE (512)
 
+#if CONFIG_FATFS_FLASH_CACHE_BLOCKS
+#define FATFS_FLASH_BLOCK_SIZE (4096) /**< Flash erase block size */
+
+/*
+ * Write-back cache of flash erase blocks. FatFS writes 512 byte sectors, and each of them used to
+ * cost a read, erase and program of the whole erase block. Writes now go to the cached block, which
+ * is erased and programmed once when it is evicted or on CTRL_SYNC (f_sync, f_close).
+ */
+typedef struct {
+    uint32_t addr; /**< Flash address of the cached block */
+    uint32_t used; /**< Time of the last use, the least recently used block is evicted */
+    bool valid;    /**< data holds the block at addr */
+    bool dirty;    /**< data has not been written to flash yet */
+    uint8_t *data; /**< FATFS_FLASH_BLOCK_SIZE bytes, allocated on first use */
+} wm_diskio_flash_block_t;
+
+static wm_diskio_flash_block_t g_flash_cache[WM_DISKIO_DRIVER_NUM_MAX][CONFIG_FATFS_FLASH_CACHE_BLOCKS];
+static uint32_t g_flash_cache_time        = 0;
+static wm_os_mutex_t *g_flash_cache_mutex = NULL; /**< Guards g_flash_cache and g_flash_cache_time of all flash disks */
+
+static bool wm_diskio_flash_cache_lock(void)
+{
+    if (wm_os_internal_mutex_acquire(g_flash_cache_mutex, WM_OS_WAIT_TIME_MAX) != WM_OS_STATUS_SUCCESS) {
+        wm_log_error("Flash cache lock failed");
+        return false;
+    }
+
+    return true;
+}
+
+static void wm_diskio_flash_cache_unlock(void)
+{
+    wm_os_internal_mutex_release(g_flash_cache_mutex);
+}
+
+static int wm_diskio_flash_cache_flush_block(wm_device_t *dev, wm_diskio_flash_block_t *block)
+{
+    int ret = WM_ERR_SUCCESS;
+
+    if (block->valid && block->dirty) {
+        ret = wm_drv_flash_write_with_erase(dev, block->addr, block->data, FATFS_FLASH_BLOCK_SIZE);
+        if (ret == WM_ERR_SUCCESS) {
+            block->dirty = false;
+        } else {
+            wm_log_error("Flash cache flush failed: %d", ret);
+        }
+    }
+
+    return ret;
+}
+
+/* called with g_flash_cache_mutex held */
+static DRESULT wm_diskio_flash_cache_sync(BYTE pdrv, wm_device_t *dev)
+{
+    DRESULT result = RES_OK;
+    int i;
+
+    for (i = 0; i < CONFIG_FATFS_FLASH_CACHE_BLOCKS; i++) {
+        if (wm_diskio_flash_cache_flush_block(dev, &g_flash_cache[pdrv][i]) != WM_ERR_SUCCESS) {
+            result = RES_ERROR;
+        }
+    }
+
+    return result;
+}
+
+/* Get the cached block at addr, load tells whether its flash content is needed, called with g_flash_cache_mutex held */
+static wm_diskio_flash_block_t *wm_diskio_flash_cache_get(BYTE pdrv, wm_device_t *dev, uint32_t addr, bool load)
+{
+    wm_diskio_flash_block_t *block  = NULL;
+    wm_diskio_flash_block_t *victim = NULL;
+    int i;
+
+    for (i = 0; i < CONFIG_FATFS_FLASH_CACHE_BLOCKS; i++) {
+        block = &g_flash_cache[pdrv][i];
+        if (block->valid && block->addr == addr) {
+            block->used = ++g_flash_cache_time;
+            return block;
+        }
+        if (victim == NULL || !block->valid || (victim->valid && block->used < victim->used)) {
+            victim = block;
+        }
+    }
+
+    if (wm_diskio_flash_cache_flush_block(dev, victim) != WM_ERR_SUCCESS) {
+        return NULL;
+    }
+    victim->valid = false;
+
+    if (victim->data == NULL) {
+        victim->data = wm_os_internal_malloc(FATFS_FLASH_BLOCK_SIZE);
+        if (victim->data == NULL) {
+            return NULL;
+        }
+    }
+
+    if (load && wm_drv_flash_read(dev, addr, victim->data, FATFS_FLASH_BLOCK_SIZE) != WM_ERR_SUCCESS) {
+        return NULL;
+    }
+
+    victim->addr  = addr;
+    victim->used  = ++g_flash_cache_time;
+    victim->valid = true;
+    victim->dirty = false;
+
+    return victim;
+}
+
+/* called with g_flash_cache_mutex held */
+static int wm_diskio_flash_cache_write(BYTE pdrv, wm_device_t *dev, uint32_t addr, const uint8_t *buff, uint32_t size)
+{
+    int ret                        = WM_ERR_SUCCESS;
+    uint32_t offset                = 0;
+    uint32_t len                   = 0;
+    wm_diskio_flash_block_t *block = NULL;
+
+    while (size) {
+        offset = addr % FATFS_FLASH_BLOCK_SIZE;
+        len    = FATFS_FLASH_BLOCK_SIZE - offset;
+        if (len > size) {
+            len = size;
+        }
+
+        block = wm_diskio_flash_cache_get(pdrv, dev, addr - offset, len != FATFS_FLASH_BLOCK_SIZE);
+        if (block != NULL) {
+            memcpy(block->data + offset, buff, len);
+            block->dirty = true;
+        } else {
+            // No cache memory, write through.
+            ret = wm_drv_flash_write_with_erase(dev, addr, (uint8_t *)buff, len);
+            if (ret != WM_ERR_SUCCESS) {
+                return ret;
+            }
+        }
+
+        addr += len;
+        buff += len;
+        size -= len;
+    }
+
+    return ret;
+}
+
+/* Replace data read from flash with the blocks that are not written back yet, called with g_flash_cache_mutex held */
+static void wm_diskio_flash_cache_read(BYTE pdrv, uint32_t addr, uint8_t *buff, uint32_t size)
+{
+    wm_diskio_flash_block_t *block = NULL;
+    uint32_t start                 = 0;
+    uint32_t end                   = 0;
+    int i;
+
+    for (i = 0; i < CONFIG_FATFS_FLASH_CACHE_BLOCKS; i++) {
+        block = &g_flash_cache[pdrv][i];
+        if (!block->valid || !block->dirty || block->addr >= addr + size || block->addr + FATFS_FLASH_BLOCK_SIZE <= addr) {
+            continue;
+        }
+
+        start = block->addr > addr ? block->addr : addr;
+        end   = block->addr + FATFS_FLASH_BLOCK_SIZE < addr + size ? block->addr + FATFS_FLASH_BLOCK_SIZE : addr + size;
+        memcpy(buff + (start - addr), block->data + (start - block->addr), end - start);
+    }
+}
+
+/* Write back the cached blocks of the disk and free them */
+static DRESULT wm_diskio_flash_cache_free(BYTE pdrv, wm_device_t *dev)
+{
+    DRESULT result = RES_OK;
+    int i;
+
+    if (!wm_diskio_flash_cache_lock()) {
+        return RES_ERROR;
+    }
+
+    if (dev != NULL) {
+        result = wm_diskio_flash_cache_sync(pdrv, dev);
+    }
+
+    // Keep the blocks that could not be written back, a later deinit may retry.
+    if (result == RES_OK) {
+        for (i = 0; i < CONFIG_FATFS_FLASH_CACHE_BLOCKS; i++) {
+            wm_os_internal_free(g_flash_cache[pdrv][i].data);
+            memset(&g_flash_cache[pdrv][i], 0, sizeof(wm_diskio_flash_block_t));
+        }
+    }
+
+    wm_diskio_flash_cache_unlock();
+
+    return result;
+}
+#endif /* CONFIG_FATFS_FLASH_CACHE_BLOCKS */
+
+#if CONFIG_FATFS_FLASH_FTL
+static wm_diskio_ftl_t *g_flash_ftl[WM_DISKIO_DRIVER_NUM_MAX] = { NULL };
+
+/* Mount the translation layer on the whole flash region of the disk */
+static DSTATUS wm_diskio_flash_ftl_mount(BYTE pdrv, wm_device_t *dev)
+{
+    int ret       = WM_ERR_FAILED;
+    uint32_t addr = 0;
+    uint32_t size = 0;
+
+#if CONFIG_FATFS_INTERNAL_FLASH_DISK_ENABLE
+    if (pdrv == WM_DISKIO_DRIVER_NUM_INTERNAL_FLASH) {
+        wm_partition_item_t partition;
+        ret = wm_partition_table_find(CONFIG_FATFS_INTERNAL_FLASH_PARTITION_NAME, &partition);
+        if (ret != WM_ERR_SUCCESS) {
+            wm_log_error("Partition not found: %s", CONFIG_FATFS_INTERNAL_FLASH_PARTITION_NAME);
+            return STA_NOINIT;
+        }
+        addr = partition.offset;
+        size = partition.size;
+    }
+#endif
+#if CONFIG_FATFS_EXTERNAL_FLASH_DISK_ENABLE
+    if (pdrv == WM_DISKIO_DRIVER_NUM_EXTERNAL_FLASH) {
+        wm_drv_flash_info_t flash_info;
+        ret = wm_drv_flash_get_device_info(dev, &flash_info);
+        if (ret != WM_ERR_SUCCESS) {
+            wm_log_error("Failed to get flash info");
+            return STA_NOINIT;
+        }
+        addr = CONFIG_FATFS_EXTERNAL_FLASH_START_ADDRESS;
+        size = (flash_info.flash_size - CONFIG_FATFS_EXTERNAL_FLASH_START_ADDRESS) < CONFIG_FATFS_EXTERNAL_FLASH_SIZE ?
+                   (flash_info.flash_size - CONFIG_FATFS_EXTERNAL_FLASH_START_ADDRESS) :
+                   CONFIG_FATFS_EXTERNAL_FLASH_SIZE;
+    }
+#endif
+
+    ret = wm_diskio_ftl_mount(&g_flash_ftl[pdrv], dev, addr, size);
+    if (ret != WM_ERR_SUCCESS) {
+        wm_log_error("Flash FTL mount failed: %d", ret);
+        return STA_NOINIT;
+    }
+
+    return 0;
+}
+#endif /* CONFIG_FATFS_FLASH_FTL */
+
 #if CONFIG_FATFS_INTERNAL_FLASH_DISK_ENABLE
 static DRESULT wm_diskio_internal_flash_check_partition(const char *partition_name, uint32_t sector, uint32_t count,
                                                         uint32_t *addr, uint32_t *size)
@@ -108,6 +351,12 @@ static DSTATUS wm_diskio_flash_init(BYTE pdrv)
 #endif
     }
 
+#if CONFIG_FATFS_FLASH_FTL
+    if (status == 0 && g_flash_ftl[pdrv] == NULL) {
+        status = wm_diskio_flash_ftl_mount(pdrv, diskio_dev[pdrv]);
+    }
+#endif
+
     return status;
 }
 
@@ -129,13 +378,22 @@ static DRESULT wm_diskio_flash_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT co
     DRESULT result   = RES_OK;
     int ret          = WM_ERR_SUCCESS;
     wm_device_t *dev = diskio_dev[pdrv];
+#if !CONFIG_FATFS_FLASH_FTL
     uint32_t read_addr, read_size;
+#endif
 
     if (dev == NULL || dev->state != WM_DEV_ST_INITED) {
         wm_log_error("Flash device not ready for read");
         return RES_NOTRDY;
     }
 
+#if CONFIG_FATFS_FLASH_FTL
+    ret = wm_diskio_ftl_read(g_flash_ftl[pdrv], sector, buff, count);
+    if (ret != WM_ERR_SUCCESS) {
+        wm_log_error("Flash FTL read failed: %d", ret);
+        return ret == WM_ERR_INVALID_PARAM ? RES_PARERR : RES_ERROR;
+    }
+#else
 #if CONFIG_FATFS_INTERNAL_FLASH_DISK_ENABLE
     if (pdrv == WM_DISKIO_DRIVER_NUM_INTERNAL_FLASH) {
         result = wm_diskio_internal_flash_check_partition(CONFIG_FATFS_INTERNAL_FLASH_PARTITION_NAME, sector, count, &read_addr,
@@ -153,11 +411,24 @@ static DRESULT wm_diskio_flash_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT co
         }
     }
 #endif
+#if CONFIG_FATFS_FLASH_CACHE_BLOCKS
+    // A block evicted between the flash read and the merge would be missed, do both under the lock.
+    if (!wm_diskio_flash_cache_lock()) {
+        return RES_ERROR;
+    }
+    ret = wm_drv_flash_read(dev, read_addr, buff, read_size);
+    if (ret == WM_ERR_SUCCESS) {
+        wm_diskio_flash_cache_read(pdrv, read_addr, buff, read_size);
+    }
+    wm_diskio_flash_cache_unlock();
+#else
     ret = wm_drv_flash_read(dev, read_addr, buff, read_size);
+#endif
     if (ret != WM_ERR_SUCCESS) {
         wm_log_error("Flash read failed: %d", ret);
         return RES_ERROR;
     }
+#endif /* CONFIG_FATFS_FLASH_FTL */
 
     return result;
 }
@@ -167,13 +438,22 @@ static DRESULT wm_diskio_flash_write(BYTE pdrv, const BYTE *buff, DWORD sector,
     DRESULT result   = RES_OK;
     int ret          = WM_ERR_SUCCESS;
     wm_device_t *dev = diskio_dev[pdrv];
+#if !CONFIG_FATFS_FLASH_FTL
     uint32_t write_addr, write_size;
+#endif
 
     if (dev == NULL || dev->state != WM_DEV_ST_INITED) {
         wm_log_error("Flash device not ready for write");
         return RES_NOTRDY;
     }
 
+#if CONFIG_FATFS_FLASH_FTL
+    ret = wm_diskio_ftl_write(g_flash_ftl[pdrv], sector, buff, count);
+    if (ret != WM_ERR_SUCCESS) {
+        wm_log_error("Flash FTL write failed: %d", ret);
+        return ret == WM_ERR_INVALID_PARAM ? RES_PARERR : RES_ERROR;
+    }
+#else
 #if CONFIG_FATFS_INTERNAL_FLASH_DISK_ENABLE
     if (pdrv == WM_DISKIO_DRIVER_NUM_INTERNAL_FLASH) {
         result = wm_diskio_internal_flash_check_partition(CONFIG_FATFS_INTERNAL_FLASH_PARTITION_NAME, sector, count,
@@ -192,11 +472,20 @@ static DRESULT wm_diskio_flash_write(BYTE pdrv, const BYTE *buff, DWORD sector,
     }
 #endif
 
+#if CONFIG_FATFS_FLASH_CACHE_BLOCKS
+    if (!wm_diskio_flash_cache_lock()) {
+        return RES_ERROR;
+    }
+    ret = wm_diskio_flash_cache_write(pdrv, dev, write_addr, buff, write_size);
+    wm_diskio_flash_cache_unlock();
+#else
     ret = wm_drv_flash_write_with_erase(dev, write_addr, (uint8_t *)buff, write_size);
+#endif
     if (ret != WM_ERR_SUCCESS) {
         wm_log_error("Flash write failed: %d", ret);
         return RES_ERROR;
     }
+#endif /* CONFIG_FATFS_FLASH_FTL */
 
     return result;
 }
@@ -205,6 +494,9 @@ static DRESULT wm_diskio_flash_ioctl(BYTE pdrv, BYTE cmd, void *buff)
 {
     int ret          = WM_ERR_SUCCESS;
     wm_device_t *dev = diskio_dev[pdrv];
+#if CONFIG_FATFS_FLASH_CACHE_BLOCKS
+    DRESULT result = RES_OK;
+#endif
 
     if (dev == NULL || dev->state != WM_DEV_ST_INITED) {
         wm_log_error("Flash device not ready for IOCTL");
@@ -213,8 +505,21 @@ static DRESULT wm_diskio_flash_ioctl(BYTE pdrv, BYTE cmd, void *buff)
 
     switch (cmd) {
         case CTRL_SYNC:
+#if CONFIG_FATFS_FLASH_CACHE_BLOCKS
+            if (!wm_diskio_flash_cache_lock()) {
+                return RES_ERROR;
+            }
+            result = wm_diskio_flash_cache_sync(pdrv, dev);
+            wm_diskio_flash_cache_unlock();
+            return result;
+#else
             return RES_OK;
+#endif
         case GET_SECTOR_COUNT:
+#if CONFIG_FATFS_FLASH_FTL
+            *((DWORD *)buff) = wm_diskio_ftl_get_sector_count(g_flash_ftl[pdrv]);
+            return RES_OK;
+#endif
 #if CONFIG_FATFS_INTERNAL_FLASH_DISK_ENABLE
             if (pdrv == WM_DISKIO_DRIVER_NUM_INTERNAL_FLASH) {
                 wm_partition_item_t partition;
@@ -261,6 +566,23 @@ static DRESULT wm_diskio_flash_ioctl(BYTE pdrv, BYTE cmd, void *buff)
     return RES_ERROR;
 }
 
+static DRESULT wm_diskio_flash_deinit(BYTE pdrv)
+{
+#if CONFIG_FATFS_FLASH_FTL
+    // The next init rebuilds the map from flash, which may have been formatted or written in between.
+    wm_diskio_ftl_unmount(g_flash_ftl[pdrv]);
+    g_flash_ftl[pdrv] = NULL;
+
+    return RES_OK;
+#elif CONFIG_FATFS_FLASH_CACHE_BLOCKS
+    wm_device_t *dev = diskio_dev[pdrv];
+
+    return wm_diskio_flash_cache_free(pdrv, (dev != NULL && dev->state == WM_DEV_ST_INITED) ? dev : NULL);
+#else
+    return RES_OK;
+#endif
+}
+
 DRESULT wm_diskio_flash_register(BYTE pdrv)
 {
     DRESULT result      = RES_OK;
@@ -268,7 +590,15 @@ DRESULT wm_diskio_flash_register(BYTE pdrv)
                             .status = &wm_diskio_flash_status,
                             .read   = &wm_diskio_flash_read,
                             .write  = &wm_diskio_flash_write,
-                            .ioctl  = &wm_diskio_flash_ioctl };
+                            .ioctl  = &wm_diskio_flash_ioctl,
+                            .deinit = &wm_diskio_flash_deinit };
+
+#if CONFIG_FATFS_FLASH_CACHE_BLOCKS
+    if (g_flash_cache_mutex == NULL && wm_os_internal_mutex_create(&g_flash_cache_mutex) != WM_OS_STATUS_SUCCESS) {
+        wm_log_error("Flash cache mutex create failed");
+        return RES_ERROR;
+    }
+#endif
 
     result = wm_diskio_register(pdrv, &ops);
 
@@ -0,0 +1,483 @@
+/**
+ * @file wm_diskio_flash_ftl.c
+ *
+ * @brief DISKIO Flash Translation Layer
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "wm_diskio_flash_ftl.h"
+#include "wm_drv_flash.h"
+#include "wm_osal.h"
+#include "wm_error.h"
+
+#define LOG_TAG "diskio_ftl"
+#include "wm_log.h"
+
+/*
+ * Log-structured sector remapping for FatFS on NOR flash.
+ *
+ * The region is split in 4KB erase blocks. The first 512 bytes of a block hold its header, the
+ * other 7 slots hold sectors. Sectors are only ever programmed into erased slots of the open
+ * block, so a FatFS write costs a page program instead of a read/erase/program of a whole block,
+ * and the writes of the FAT and directory sectors are spread over the whole region.
+ *
+ * A slot is committed by programming its tag in the block header after the data, the tag holds
+ * the logical sector and its complement so that a torn tag is ignored. There is no mapping table
+ * in flash: the map is rebuilt at mount from the block headers, the copy in the block with the
+ * highest sequence number, and the highest slot in that block, being the current one. Blocks are
+ * erased lazily when they are opened, only after the sectors they held have been committed
+ * elsewhere, so a power failure at any point leaves every sector with its old or its new data.
+ *
+ * At mount the newest block is opened again from its first blank slot: if the power failed while
+ * the garbage collector was moving a block, the rest of that block still fits in it.
+ *
+ * When fewer than FTL_FREE_MIN free blocks are left, the garbage collector moves the valid slots
+ * of the block with the fewest of them to the open block. Free blocks are opened in the order of
+ * their erase count, and a block with cold data whose erase count falls FTL_WEAR_LIMIT behind the
+ * most worn block is collected first, so static data does not pin down lightly used blocks.
+ */
+
+#define FTL_BLOCK_SIZE  (4096)
+#define FTL_SLOT_NUM    (FTL_BLOCK_SIZE / WM_DISKIO_FTL_SECTOR_SIZE - 1)
+#define FTL_MAGIC       (0x4C544657) /**< "WFTL" in memory */
+#define FTL_NONE        (0xFFFF)
+#define FTL_FREE_MIN    (2)  /**< free blocks kept for the garbage collector */
+#define FTL_SPARE_NUM   (3)  /**< blocks not counted in the capacity */
+#define FTL_SPARE_SHIFT (4)  /**< plus 1/16 of the blocks, so the collector finds blocks with few valid slots */
+#define FTL_WEAR_LIMIT  (64) /**< erase count spread that triggers static wear leveling */
+#define FTL_MAX_SLOTS   (FTL_NONE - 1)
+#define FTL_TAG_ADDR(b) (sizeof(wm_diskio_ftl_header_t) + (b) * sizeof(wm_diskio_ftl_tag_t))
+
+typedef struct {
+    uint32_t sector;     /**< Logical sector held by the slot */
+    uint32_t sector_inv; /**< ~sector, the tag is valid if both match */
+} wm_diskio_ftl_tag_t;
+
+typedef struct {
+    uint32_t magic;     /**< FTL_MAGIC */
+    uint32_t seq;       /**< Order in which the blocks were opened */
+    uint32_t erase_cnt; /**< Number of times the block has been erased */
+    uint32_t check;     /**< ~(magic ^ seq ^ erase_cnt) */
+} wm_diskio_ftl_header_t;
+
+typedef struct {
+    uint32_t seq;       /**< Sequence number, 0 if the block has no valid header */
+    uint32_t erase_cnt; /**< Number of times the block has been erased */
+    uint8_t valid;      /**< Slots holding the current copy of a sector */
+    uint8_t used;       /**< Slots programmed since the block was opened */
+} wm_diskio_ftl_block_t;
+
+struct wm_diskio_ftl {
+    wm_device_t *dev;                       /**< Flash device */
+    uint32_t addr;                          /**< Flash address of the region */
+    uint32_t block_num;                     /**< Number of erase blocks in the region */
+    uint32_t sector_num;                    /**< Number of logical sectors */
+    uint32_t seq;                           /**< Sequence number of the next opened block */
+    uint32_t open;                          /**< Block taking the writes, FTL_NONE if none */
+    uint16_t *map;                          /**< Logical sector to slot, FTL_NONE if never written */
+    wm_diskio_ftl_block_t *blocks;          /**< Block state */
+    uint8_t buf[WM_DISKIO_FTL_SECTOR_SIZE]; /**< Sector moved by the garbage collector */
+};
+
+static inline uint32_t wm_diskio_ftl_slot_addr(wm_diskio_ftl_t *ftl, uint32_t slot)
+{
+    return ftl->addr + (slot / FTL_SLOT_NUM) * FTL_BLOCK_SIZE + (slot % FTL_SLOT_NUM + 1) * WM_DISKIO_FTL_SECTOR_SIZE;
+}
+
+static inline bool wm_diskio_ftl_is_free(wm_diskio_ftl_t *ftl, uint32_t block)
+{
+    return block != ftl->open && ftl->blocks[block].valid == 0;
+}
+
+static uint32_t wm_diskio_ftl_free_count(wm_diskio_ftl_t *ftl)
+{
+    uint32_t count = 0;
+    uint32_t i;
+
+    for (i = 0; i < ftl->block_num; i++) {
+        if (wm_diskio_ftl_is_free(ftl, i)) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+static int wm_diskio_ftl_read_tags(wm_diskio_ftl_t *ftl, uint32_t block, wm_diskio_ftl_tag_t *tags)
+{
+    return wm_drv_flash_read(ftl->dev, ftl->addr + block * FTL_BLOCK_SIZE + FTL_TAG_ADDR(0), (uint8_t *)tags,
+                             FTL_SLOT_NUM * sizeof(wm_diskio_ftl_tag_t));
+}
+
+static bool wm_diskio_ftl_is_blank(const uint8_t *data, uint32_t len)
+{
+    while (len--) {
+        if (*data++ != 0xFF) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Open the newest block again from the first slot after which data and tags are all blank */
+static int wm_diskio_ftl_reopen(wm_diskio_ftl_t *ftl, uint32_t block, const wm_diskio_ftl_tag_t *tags)
+{
+    int ret       = WM_ERR_SUCCESS;
+    uint32_t used = FTL_SLOT_NUM;
+
+    while (used > 0 && wm_diskio_ftl_is_blank((const uint8_t *)&tags[used - 1], sizeof(wm_diskio_ftl_tag_t))) {
+        ret = wm_drv_flash_read(ftl->dev, wm_diskio_ftl_slot_addr(ftl, block * FTL_SLOT_NUM + used - 1), ftl->buf,
+                                WM_DISKIO_FTL_SECTOR_SIZE);
+        if (ret != WM_ERR_SUCCESS) {
+            return ret;
+        }
+        if (!wm_diskio_ftl_is_blank(ftl->buf, WM_DISKIO_FTL_SECTOR_SIZE)) {
+            break;
+        }
+        used--;
+    }
+
+    if (used < FTL_SLOT_NUM) {
+        ftl->blocks[block].used = used;
+        ftl->open               = block;
+    }
+
+    return ret;
+}
+
+/* Erase the least worn free block and make it the open block */
+static int wm_diskio_ftl_open_block(wm_diskio_ftl_t *ftl)
+{
+    int ret                       = WM_ERR_SUCCESS;
+    uint32_t block                = FTL_NONE;
+    wm_diskio_ftl_header_t header = { 0 };
+    uint32_t i;
+
+    for (i = 0; i < ftl->block_num; i++) {
+        if (wm_diskio_ftl_is_free(ftl, i) && (block == FTL_NONE || ftl->blocks[i].erase_cnt < ftl->blocks[block].erase_cnt)) {
+            block = i;
+        }
+    }
+    if (block == FTL_NONE) {
+        wm_log_error("no free block");
+        return WM_ERR_NO_MEM;
+    }
+
+    ret = wm_drv_flash_erase_region(ftl->dev, ftl->addr + block * FTL_BLOCK_SIZE, FTL_BLOCK_SIZE);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    header.magic     = FTL_MAGIC;
+    header.seq       = ftl->seq++;
+    header.erase_cnt = ftl->blocks[block].erase_cnt + 1;
+    header.check     = ~(header.magic ^ header.seq ^ header.erase_cnt);
+
+    ftl->blocks[block].seq       = header.seq;
+    ftl->blocks[block].erase_cnt = header.erase_cnt;
+    ftl->blocks[block].used      = 0;
+    ftl->open                    = block;
+
+    return wm_drv_flash_write(ftl->dev, ftl->addr + block * FTL_BLOCK_SIZE, (uint8_t *)&header, sizeof(header));
+}
+
+/* Program a sector into the next slot of the open block, and commit it */
+static int wm_diskio_ftl_put(wm_diskio_ftl_t *ftl, uint32_t sector, const uint8_t *data)
+{
+    int ret                 = WM_ERR_SUCCESS;
+    uint32_t slot           = 0;
+    uint16_t old            = 0;
+    wm_diskio_ftl_tag_t tag = { 0 };
+
+    if (ftl->open == FTL_NONE || ftl->blocks[ftl->open].used == FTL_SLOT_NUM) {
+        ftl->open = FTL_NONE;
+        ret       = wm_diskio_ftl_open_block(ftl);
+        if (ret != WM_ERR_SUCCESS) {
+            return ret;
+        }
+    }
+
+    slot = ftl->open * FTL_SLOT_NUM + ftl->blocks[ftl->open].used;
+    ftl->blocks[ftl->open].used++;
+
+    ret = wm_drv_flash_write(ftl->dev, wm_diskio_ftl_slot_addr(ftl, slot), (uint8_t *)data, WM_DISKIO_FTL_SECTOR_SIZE);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    tag.sector     = sector;
+    tag.sector_inv = ~sector;
+    ret            = wm_drv_flash_write(ftl->dev, ftl->addr + ftl->open * FTL_BLOCK_SIZE + FTL_TAG_ADDR(slot % FTL_SLOT_NUM),
+                                        (uint8_t *)&tag, sizeof(tag));
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    old = ftl->map[sector];
+    if (old != FTL_NONE) {
+        ftl->blocks[old / FTL_SLOT_NUM].valid--;
+    }
+    ftl->map[sector] = (uint16_t)slot;
+    ftl->blocks[ftl->open].valid++;
+
+    return ret;
+}
+
+/* Move the valid slots of one block to the open block, which frees it */
+static int wm_diskio_ftl_collect(wm_diskio_ftl_t *ftl)
+{
+    int ret                                = WM_ERR_SUCCESS;
+    uint32_t victim                        = FTL_NONE;
+    uint32_t coldest                       = FTL_NONE;
+    uint32_t max_erase                     = 0;
+    wm_diskio_ftl_tag_t tags[FTL_SLOT_NUM] = { 0 };
+    wm_diskio_ftl_block_t *blocks          = ftl->blocks;
+    uint32_t i;
+
+    for (i = 0; i < ftl->block_num; i++) {
+        if (blocks[i].erase_cnt > max_erase) {
+            max_erase = blocks[i].erase_cnt;
+        }
+        if (i == ftl->open || blocks[i].valid == 0) {
+            continue;
+        }
+        if (victim == FTL_NONE || blocks[i].valid < blocks[victim].valid) {
+            victim = i;
+        }
+        if (coldest == FTL_NONE || blocks[i].erase_cnt < blocks[coldest].erase_cnt) {
+            coldest = i;
+        }
+    }
+
+    if (victim == FTL_NONE) {
+        return WM_ERR_NO_MEM;
+    }
+    // The coldest block may be full, only move it when there is a free block to take it.
+    if (max_erase - blocks[coldest].erase_cnt > FTL_WEAR_LIMIT && wm_diskio_ftl_free_count(ftl) > 0) {
+        victim = coldest;
+    }
+
+    ret = wm_diskio_ftl_read_tags(ftl, victim, tags);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    for (i = 0; i < FTL_SLOT_NUM && blocks[victim].valid; i++) {
+        if (tags[i].sector >= ftl->sector_num || ftl->map[tags[i].sector] != victim * FTL_SLOT_NUM + i) {
+            continue;
+        }
+
+        ret = wm_drv_flash_read(ftl->dev, wm_diskio_ftl_slot_addr(ftl, victim * FTL_SLOT_NUM + i), ftl->buf,
+                                WM_DISKIO_FTL_SECTOR_SIZE);
+        if (ret == WM_ERR_SUCCESS) {
+            ret = wm_diskio_ftl_put(ftl, tags[i].sector, ftl->buf);
+        }
+        if (ret != WM_ERR_SUCCESS) {
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+int wm_diskio_ftl_mount(wm_diskio_ftl_t **ftl, wm_device_t *dev, uint32_t addr, uint32_t size)
+{
+    int ret                                = WM_ERR_SUCCESS;
+    wm_diskio_ftl_t *ctx                   = NULL;
+    wm_diskio_ftl_header_t header          = { 0 };
+    wm_diskio_ftl_tag_t tags[FTL_SLOT_NUM] = { 0 };
+    uint32_t block_num                     = size / FTL_BLOCK_SIZE;
+    uint32_t max_erase                     = 0;
+    uint32_t newest                        = FTL_NONE;
+    uint32_t slot                          = 0;
+    uint16_t old                           = 0;
+    uint32_t i, j;
+
+    if (ftl == NULL || dev == NULL || addr % FTL_BLOCK_SIZE || block_num <= FTL_SPARE_NUM) {
+        return WM_ERR_INVALID_PARAM;
+    }
+    if (block_num * FTL_SLOT_NUM > FTL_MAX_SLOTS) {
+        block_num = FTL_MAX_SLOTS / FTL_SLOT_NUM;
+    }
+
+    ctx = wm_os_internal_malloc(sizeof(wm_diskio_ftl_t));
+    if (ctx == NULL) {
+        return WM_ERR_NO_MEM;
+    }
+    memset(ctx, 0, sizeof(wm_diskio_ftl_t));
+
+    ctx->dev        = dev;
+    ctx->addr       = addr;
+    ctx->block_num  = block_num;
+    ctx->sector_num = (block_num - FTL_SPARE_NUM - (block_num >> FTL_SPARE_SHIFT)) * FTL_SLOT_NUM;
+    ctx->seq        = 1;
+    ctx->open       = FTL_NONE;
+    ctx->map        = wm_os_internal_malloc(ctx->sector_num * sizeof(uint16_t));
+    ctx->blocks     = wm_os_internal_malloc(block_num * sizeof(wm_diskio_ftl_block_t));
+    if (ctx->map == NULL || ctx->blocks == NULL) {
+        ret = WM_ERR_NO_MEM;
+        goto exit;
+    }
+    memset(ctx->map, 0xFF, ctx->sector_num * sizeof(uint16_t));
+    memset(ctx->blocks, 0, block_num * sizeof(wm_diskio_ftl_block_t));
+
+    for (i = 0; i < block_num; i++) {
+        ret = wm_drv_flash_read(dev, addr + i * FTL_BLOCK_SIZE, (uint8_t *)&header, sizeof(header));
+        if (ret != WM_ERR_SUCCESS) {
+            goto exit;
+        }
+        if (header.magic != FTL_MAGIC || header.check != ~(header.magic ^ header.seq ^ header.erase_cnt)) {
+            continue;
+        }
+
+        ctx->blocks[i].seq       = header.seq;
+        ctx->blocks[i].erase_cnt = header.erase_cnt;
+        ctx->blocks[i].used      = FTL_SLOT_NUM; /* never written again before it is erased */
+        if (header.erase_cnt > max_erase) {
+            max_erase = header.erase_cnt;
+        }
+        if (header.seq >= ctx->seq) {
+            ctx->seq = header.seq + 1;
+            newest   = i;
+        }
+
+        ret = wm_diskio_ftl_read_tags(ctx, i, tags);
+        if (ret != WM_ERR_SUCCESS) {
+            goto exit;
+        }
+
+        for (j = 0; j < FTL_SLOT_NUM; j++) {
+            if (tags[j].sector != ~tags[j].sector_inv || tags[j].sector >= ctx->sector_num) {
+                continue;
+            }
+
+            // The newest copy wins: higher block sequence, or later slot of the same block.
+            slot = i * FTL_SLOT_NUM + j;
+            old  = ctx->map[tags[j].sector];
+            if (old != FTL_NONE) {
+                if (ctx->blocks[old / FTL_SLOT_NUM].seq > header.seq ||
+                    (old / FTL_SLOT_NUM == i && old % FTL_SLOT_NUM > j)) {
+                    continue;
+                }
+                ctx->blocks[old / FTL_SLOT_NUM].valid--;
+            }
+            ctx->map[tags[j].sector] = (uint16_t)slot;
+            ctx->blocks[i].valid++;
+        }
+    }
+
+    // The erase count of a block without a valid header is unknown, assume the worst.
+    for (i = 0; i < block_num; i++) {
+        if (ctx->blocks[i].seq == 0) {
+            ctx->blocks[i].erase_cnt = max_erase;
+        }
+    }
+
+    if (newest != FTL_NONE) {
+        ret = wm_diskio_ftl_read_tags(ctx, newest, tags);
+        if (ret == WM_ERR_SUCCESS) {
+            ret = wm_diskio_ftl_reopen(ctx, newest, tags);
+        }
+        if (ret != WM_ERR_SUCCESS) {
+            goto exit;
+        }
+    }
+
+    wm_log_debug("mounted %u blocks, %u sectors, %u free blocks", (unsigned int)block_num, (unsigned int)ctx->sector_num,
+                 (unsigned int)wm_diskio_ftl_free_count(ctx));
+
+    *ftl = ctx;
+
+    return WM_ERR_SUCCESS;
+
+exit:
+    wm_os_internal_free(ctx->map);
+    wm_os_internal_free(ctx->blocks);
+    wm_os_internal_free(ctx);
+
+    return ret;
+}
+
+void wm_diskio_ftl_unmount(wm_diskio_ftl_t *ftl)
+{
+    if (ftl == NULL) {
+        return;
+    }
+
+    wm_os_internal_free(ftl->map);
+    wm_os_internal_free(ftl->blocks);
+    wm_os_internal_free(ftl);
+}
+
+uint32_t wm_diskio_ftl_get_sector_count(wm_diskio_ftl_t *ftl)
+{
+    return ftl ? ftl->sector_num : 0;
+}
+
+int wm_diskio_ftl_read(wm_diskio_ftl_t *ftl, uint32_t sector, uint8_t *buf, uint32_t count)
+{
+    int ret = WM_ERR_SUCCESS;
+
+    if (ftl == NULL || buf == NULL || sector >= ftl->sector_num || count > ftl->sector_num - sector) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    for (; count > 0; count--, sector++, buf += WM_DISKIO_FTL_SECTOR_SIZE) {
+        if (ftl->map[sector] == FTL_NONE) {
+            memset(buf, 0xFF, WM_DISKIO_FTL_SECTOR_SIZE);
+            continue;
+        }
+
+        ret = wm_drv_flash_read(ftl->dev, wm_diskio_ftl_slot_addr(ftl, ftl->map[sector]), buf, WM_DISKIO_FTL_SECTOR_SIZE);
+        if (ret != WM_ERR_SUCCESS) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
+int wm_diskio_ftl_write(wm_diskio_ftl_t *ftl, uint32_t sector, const uint8_t *buf, uint32_t count)
+{
+    int ret = WM_ERR_SUCCESS;
+    uint32_t i;
+
+    if (ftl == NULL || buf == NULL || sector >= ftl->sector_num || count > ftl->sector_num - sector) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    for (; count > 0; count--, sector++, buf += WM_DISKIO_FTL_SECTOR_SIZE) {
+        // Keep free blocks in reserve, so the collector always has room to move slots to.
+        for (i = 0; i < ftl->block_num && wm_diskio_ftl_free_count(ftl) < FTL_FREE_MIN; i++) {
+            ret = wm_diskio_ftl_collect(ftl);
+            if (ret != WM_ERR_SUCCESS) {
+                return ret;
+            }
+        }
+
+        ret = wm_diskio_ftl_put(ftl, sector, buf);
+        if (ret != WM_ERR_SUCCESS) {
+            break;
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file wm_diskio_flash_ftl.h
+ *
+ * @brief DISKIO Flash Translation Layer
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_DISKIO_FLASH_FTL_H__
+#define __WM_DISKIO_FLASH_FTL_H__
+
+#include <stdint.h>
+#include "wm_dt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WM_DISKIO_FTL_SECTOR_SIZE (512) /**< Logical sector size */
+
+typedef struct wm_diskio_ftl wm_diskio_ftl_t;
+
+/**
+ * @brief Mount the FTL on a flash region, rebuilding the sector map from the block headers.
+ *
+ * A region that holds no FTL blocks yet mounts empty, every sector reads as 0xFF.
+ *
+ * @param[out] ftl FTL handle
+ * @param[in] dev flash device
+ * @param[in] addr region start, erase block aligned
+ * @param[in] size region size, at least 4 erase blocks
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_NO_MEM: no memory for the sector map
+ *    - others: flash read failed
+ */
+int wm_diskio_ftl_mount(wm_diskio_ftl_t **ftl, wm_device_t *dev, uint32_t addr, uint32_t size);
+
+/**
+ * @brief Unmount the FTL and free its sector map, every write has already been committed.
+ *
+ * @param[in] ftl FTL handle, NULL is ignored
+ */
+void wm_diskio_ftl_unmount(wm_diskio_ftl_t *ftl);
+
+/**
+ * @brief Get the number of logical sectors.
+ *
+ * @param[in] ftl FTL handle
+ *
+ * @return number of WM_DISKIO_FTL_SECTOR_SIZE sectors
+ */
+uint32_t wm_diskio_ftl_get_sector_count(wm_diskio_ftl_t *ftl);
+
+/**
+ * @brief Read logical sectors.
+ *
+ * @param[in] ftl FTL handle
+ * @param[in] sector first sector
+ * @param[out] buf data, count * WM_DISKIO_FTL_SECTOR_SIZE bytes
+ * @param[in] count number of sectors
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: sectors out of range
+ *    - others: flash read failed
+ */
+int wm_diskio_ftl_read(wm_diskio_ftl_t *ftl, uint32_t sector, uint8_t *buf, uint32_t count);
+
+/**
+ * @brief Write logical sectors.
+ *
+ * Each sector is committed on its own, after a power failure a sector holds either
+ * its old or its new data.
+ *
+ * @param[in] ftl FTL handle
+ * @param[in] sector first sector
+ * @param[in] buf data, count * WM_DISKIO_FTL_SECTOR_SIZE bytes
+ * @param[in] count number of sectors
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: sectors out of range
+ *    - WM_ERR_NO_MEM: no free block left
+ *    - others: flash erase or program failed
+ */
+int wm_diskio_ftl_write(wm_diskio_ftl_t *ftl, uint32_t sector, const uint8_t *buf, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_DISKIO_FLASH_FTL_H__ */
@@ -0,0 +1,386 @@
+/**
+ * @file wm_diskio_flash_ftl_test.c
+ *
+ * @brief DISKIO Flash Translation Layer Power Loss Host Test
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wm_error.h"
+#include "wm_drv_flash.h"
+#include "wm_osal.h"
+#include "wm_diskio_flash_ftl.h"
+
+#define TEST_BLOCK_SIZE 4096
+#define TEST_BLOCKS     12
+#define TEST_FLASH_SIZE (TEST_BLOCKS * TEST_BLOCK_SIZE)
+#define TEST_SECTOR     WM_DISKIO_FTL_SECTOR_SIZE
+#define TEST_SECTORS    256 /* more than the FTL offers on TEST_BLOCKS */
+#define TEST_WRITES     300 /* sector writes of the workload cut at every flash operation */
+#define TEST_AFTER      24  /* sector writes after each recovery */
+#define TEST_CYCLES     3000
+#define TEST_HOT        4 /* sectors taking half of the writes, like the FAT and a directory */
+
+/* NOR flash in RAM, programs only clear bits, the power fails at flash operation g_cut_at */
+static uint8_t g_flash[TEST_FLASH_SIZE];
+static uint32_t g_erase_cnt[TEST_BLOCKS];
+static uint32_t g_ops;
+static uint32_t g_cut_at;
+static int g_power_off;
+static int g_bad_program;
+static int g_allocs;
+
+/* version of the data each sector holds, 0 if it was never written */
+static uint32_t g_version[TEST_SECTORS];
+static uint32_t g_sector_num;
+static wm_device_t g_dev = { "flash" };
+static int g_fail;
+
+static void test_report(const char *name, int ok, const char *detail)
+{
+    printf("%-24s %s %s\n", name, ok ? "PASS" : "FAIL", detail);
+    g_fail += !ok;
+}
+
+void *wm_os_internal_malloc(size_t size)
+{
+    g_allocs++;
+
+    return malloc(size);
+}
+
+void wm_os_internal_free(void *ptr)
+{
+    if (ptr != NULL) {
+        g_allocs--;
+        free(ptr);
+    }
+}
+
+/* Count the operation, the one the power fails in is done partly and every later one fails */
+static int test_flash_op(void)
+{
+    if (g_power_off) {
+        return -1;
+    }
+
+    g_ops++;
+
+    return g_cut_at && g_ops == g_cut_at;
+}
+
+int wm_drv_flash_read(wm_device_t *dev, uint32_t addr, uint8_t *rd_buf, uint32_t rd_len)
+{
+    (void)dev;
+
+    if (g_power_off || addr + rd_len > TEST_FLASH_SIZE) {
+        return WM_ERR_FAILED;
+    }
+
+    memcpy(rd_buf, g_flash + addr, rd_len);
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_drv_flash_write(wm_device_t *dev, uint32_t addr, uint8_t *wr_buf, uint32_t wr_len)
+{
+    int cut = test_flash_op();
+    uint32_t i, n;
+
+    (void)dev;
+
+    if (cut < 0 || addr + wr_len > TEST_FLASH_SIZE) {
+        return WM_ERR_FAILED;
+    }
+
+    /* a torn program stops at a random byte, whose bits are only partly cleared */
+    n = cut ? (uint32_t)rand() % wr_len : wr_len;
+    for (i = 0; i < n; i++) {
+        g_bad_program += (g_flash[addr + i] & wr_buf[i]) != wr_buf[i];
+        g_flash[addr + i] &= wr_buf[i];
+    }
+    if (cut) {
+        g_flash[addr + n] &= wr_buf[n] | (uint8_t)rand();
+        g_power_off = 1;
+        return WM_ERR_FAILED;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_drv_flash_erase_region(wm_device_t *dev, uint32_t addr, uint32_t erase_len)
+{
+    int cut = test_flash_op();
+    uint32_t i;
+
+    (void)dev;
+
+    if (cut < 0 || addr % TEST_BLOCK_SIZE || erase_len % TEST_BLOCK_SIZE || addr + erase_len > TEST_FLASH_SIZE) {
+        return WM_ERR_FAILED;
+    }
+
+    if (!cut) {
+        memset(g_flash + addr, 0xFF, erase_len);
+        for (i = 0; i < erase_len / TEST_BLOCK_SIZE; i++) {
+            g_erase_cnt[addr / TEST_BLOCK_SIZE + i]++;
+        }
+        return WM_ERR_SUCCESS;
+    }
+
+    /* a torn erase leaves the block partly erased, from the start or as random bits */
+    if (rand() % 2) {
+        memset(g_flash + addr, 0xFF, (uint32_t)rand() % erase_len);
+    } else {
+        for (i = 0; i < erase_len; i++) {
+            g_flash[addr + i] |= (uint8_t)rand() & (uint8_t)rand();
+        }
+    }
+    g_power_off = 1;
+
+    return WM_ERR_FAILED;
+}
+
+/* Data of a sector version, tells the sector and the version apart; version 0 reads as blank */
+static void test_fill(uint8_t *buf, uint32_t sector, uint32_t version)
+{
+    uint32_t x = sector * 2654435761u + version * 40503u + 1;
+    int i;
+
+    if (version == 0) {
+        memset(buf, 0xFF, TEST_SECTOR);
+        return;
+    }
+
+    for (i = 0; i < TEST_SECTOR; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buf[i] = (uint8_t)x;
+    }
+}
+
+static int test_holds(wm_diskio_ftl_t *ftl, uint32_t sector, uint32_t version)
+{
+    uint8_t buf[TEST_SECTOR];
+    uint8_t ref[TEST_SECTOR];
+
+    test_fill(ref, sector, version);
+
+    return wm_diskio_ftl_read(ftl, sector, buf, 1) == WM_ERR_SUCCESS && !memcmp(buf, ref, TEST_SECTOR);
+}
+
+static uint32_t test_pick_sector(void)
+{
+    return rand() % 2 ? (uint32_t)rand() % TEST_HOT : (uint32_t)rand() % g_sector_num;
+}
+
+/*
+ * Write count sectors. When the power fails, *pending is the sector being written and the
+ * function returns 1; a failure with the power on returns -1.
+ */
+static int test_write(wm_diskio_ftl_t *ftl, int count, uint32_t *pending)
+{
+    uint8_t buf[TEST_SECTOR];
+    uint32_t sector;
+
+    while (count--) {
+        sector = test_pick_sector();
+        test_fill(buf, sector, g_version[sector] + 1);
+        if (wm_diskio_ftl_write(ftl, sector, buf, 1) != WM_ERR_SUCCESS) {
+            *pending = sector;
+            return g_power_off ? 1 : -1;
+        }
+        g_version[sector]++;
+    }
+
+    return 0;
+}
+
+/*
+ * Power up again and mount: the sector being written holds its old or its new data, every
+ * other sector what was last written to it.
+ */
+static wm_diskio_ftl_t *test_recover(wm_diskio_ftl_t *ftl, uint32_t pending, int *ok)
+{
+    uint32_t i;
+
+    g_power_off = 0;
+    g_cut_at    = 0;
+    wm_diskio_ftl_unmount(ftl);
+    *ok = g_allocs == 0;
+
+    if (wm_diskio_ftl_mount(&ftl, &g_dev, 0, TEST_FLASH_SIZE) != WM_ERR_SUCCESS ||
+        wm_diskio_ftl_get_sector_count(ftl) != g_sector_num) {
+        *ok = 0;
+        return NULL;
+    }
+
+    for (i = 0; i < g_sector_num; i++) {
+        if (i == pending && test_holds(ftl, i, g_version[i] + 1)) {
+            g_version[i]++;
+        } else if (!test_holds(ftl, i, g_version[i])) {
+            *ok = 0;
+        }
+    }
+
+    return ftl;
+}
+
+static wm_diskio_ftl_t *test_format(void)
+{
+    wm_diskio_ftl_t *ftl = NULL;
+
+    memset(g_flash, 0xFF, sizeof(g_flash));
+    memset(g_erase_cnt, 0, sizeof(g_erase_cnt));
+    memset(g_version, 0, sizeof(g_version));
+    g_ops       = 0;
+    g_cut_at    = 0;
+    g_power_off = 0;
+
+    if (wm_diskio_ftl_mount(&ftl, &g_dev, 0, TEST_FLASH_SIZE) != WM_ERR_SUCCESS) {
+        return NULL;
+    }
+    g_sector_num = wm_diskio_ftl_get_sector_count(ftl);
+
+    return ftl;
+}
+
+static void test_basic(void)
+{
+    wm_diskio_ftl_t *ftl = NULL;
+    uint8_t buf[TEST_SECTOR];
+    uint32_t pending = 0;
+    int ok, remount, i;
+
+    ok = wm_diskio_ftl_mount(&ftl, &g_dev, 0, 3 * TEST_BLOCK_SIZE) == WM_ERR_INVALID_PARAM &&
+         wm_diskio_ftl_mount(&ftl, &g_dev, 512, TEST_FLASH_SIZE) == WM_ERR_INVALID_PARAM;
+    test_report("mount params", ok, "too small or unaligned regions refused");
+
+    ftl = test_format();
+    ok  = ftl != NULL && g_sector_num > 0 && g_sector_num <= TEST_SECTORS;
+    for (i = 0; ok && i < (int)g_sector_num; i++) {
+        ok = test_holds(ftl, i, 0);
+    }
+    test_report("blank mount", ok, "every sector reads as 0xFF");
+
+    ok = wm_diskio_ftl_read(ftl, g_sector_num, buf, 1) == WM_ERR_INVALID_PARAM &&
+         wm_diskio_ftl_write(ftl, g_sector_num - 1, buf, 2) == WM_ERR_INVALID_PARAM;
+    test_report("range", ok, "sectors past the end refused");
+
+    /* several times the capacity, so the collector and the wear leveling run */
+    ok  = test_write(ftl, 20 * g_sector_num, &pending) == 0 && !g_bad_program;
+    ftl = test_recover(ftl, TEST_SECTORS, &remount);
+    test_report("remount", ok && remount, "map rebuilt from the block headers and tags");
+
+    wm_diskio_ftl_unmount(ftl);
+    wm_diskio_ftl_unmount(NULL);
+    test_report("unmount", g_allocs == 0, "sector map and block state freed");
+}
+
+/* Cut the power at every flash operation of the same workload, from a blank region */
+static void test_cut_every_op(void)
+{
+    wm_diskio_ftl_t *ftl = NULL;
+    uint32_t pending     = 0;
+    uint32_t total       = 0;
+    uint32_t cut;
+    char detail[96];
+    int ok  = 1;
+    int ret = 0;
+
+    srand(2);
+    ftl   = test_format();
+    ret   = test_write(ftl, TEST_WRITES, &pending);
+    total = g_ops;
+    wm_diskio_ftl_unmount(ftl);
+
+    for (cut = 1; cut <= total && ok && ret == 0; cut++) {
+        srand(2);
+        ftl      = test_format();
+        g_cut_at = cut;
+        ret      = test_write(ftl, TEST_WRITES, &pending);
+        if (ret != 1) {
+            break;
+        }
+
+        /* the recovered disk takes writes, and survives a clean remount */
+        ftl = test_recover(ftl, pending, &ok);
+        ret = ok ? test_write(ftl, TEST_AFTER, &pending) : -1;
+        if (ret == 0) {
+            ftl = test_recover(ftl, TEST_SECTORS, &ok);
+        }
+        wm_diskio_ftl_unmount(ftl);
+    }
+
+    ok &= ret == 0 && cut > total && !g_bad_program && g_allocs == 0;
+    snprintf(detail, sizeof(detail), "%u of %u flash operations cut, %d sector writes", (unsigned)(cut - 1),
+             (unsigned)total, TEST_WRITES);
+    test_report("cut every op", ok, detail);
+}
+
+/* Keep one disk going through many random power failures, then look at the erase spread */
+static void test_cut_random(void)
+{
+    wm_diskio_ftl_t *ftl = NULL;
+    uint32_t pending     = 0;
+    uint32_t min_erase   = UINT32_MAX;
+    uint32_t max_erase   = 0;
+    char detail[128];
+    int ok = 1;
+    int cycle, ret, i;
+
+    srand(3);
+    ftl = test_format();
+
+    for (cycle = 0; cycle < TEST_CYCLES && ok; cycle++) {
+        g_cut_at = g_ops + 1 + rand() % 400;
+        ret      = test_write(ftl, 1000, &pending);
+        if (ret < 0) {
+            ok = 0;
+            break;
+        }
+        ftl = test_recover(ftl, ret ? pending : TEST_SECTORS, &ok);
+    }
+    wm_diskio_ftl_unmount(ftl);
+
+    for (i = 0; i < TEST_BLOCKS; i++) {
+        min_erase = g_erase_cnt[i] < min_erase ? g_erase_cnt[i] : min_erase;
+        max_erase = g_erase_cnt[i] > max_erase ? g_erase_cnt[i] : max_erase;
+    }
+
+    /* the erases are spread, no block wears out at twice the rate of another */
+    ok &= !g_bad_program && g_allocs == 0 && min_erase * 2 >= max_erase;
+    snprintf(detail, sizeof(detail), "%d power failures, %u flash operations, erases per block %u..%u", cycle,
+             (unsigned)g_ops, (unsigned)min_erase, (unsigned)max_erase);
+    test_report("cut random", ok, detail);
+}
+
+int main(void)
+{
+    test_basic();
+    test_cut_every_op();
+    test_cut_random();
+
+    printf("%s\n", g_fail ? "FAILED" : "ALL PASSED");
+
+    return g_fail ? 1 : 0;
+}
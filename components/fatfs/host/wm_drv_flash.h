@@ -0,0 +1,17 @@
+/**
+ * @file wm_drv_flash.h
+ *
+ * @brief Host build stand-in for the flash driver, implemented over RAM by the test
+ *
+ */
+
+#ifndef __WM_DRV_FLASH_H__
+#define __WM_DRV_FLASH_H__
+
+#include "wm_dt.h"
+
+int wm_drv_flash_write(wm_device_t *dev, uint32_t addr, uint8_t *wr_buf, uint32_t wr_len);
+int wm_drv_flash_read(wm_device_t *dev, uint32_t addr, uint8_t *rd_buf, uint32_t rd_len);
+int wm_drv_flash_erase_region(wm_device_t *dev, uint32_t addr, uint32_t erase_len);
+
+#endif /* __WM_DRV_FLASH_H__ */
@@ -0,0 +1,18 @@
+/**
+ * @file wm_dt.h
+ *
+ * @brief Host build stand-in for the device table, a device is only a handle
+ *
+ */
+
+#ifndef __WM_DT_H__
+#define __WM_DT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    const char *name;
+} wm_device_t;
+
+#endif /* __WM_DT_H__ */
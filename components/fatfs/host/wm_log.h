@@ -0,0 +1,14 @@
+/**
+ * @file wm_log.h
+ *
+ * @brief Host build stand-in for the log, messages are dropped
+ *
+ */
+
+#ifndef __WM_LOG_H__
+#define __WM_LOG_H__
+
+#define wm_log_error(...) ((void)0)
+#define wm_log_debug(...) ((void)0)
+
+#endif /* __WM_LOG_H__ */
@@ -0,0 +1,16 @@
+/**
+ * @file wm_osal.h
+ *
+ * @brief Host build stand-in for the OSAL heap, counted by the test to find leaks
+ *
+ */
+
+#ifndef __WM_OSAL_H__
+#define __WM_OSAL_H__
+
+#include <stddef.h>
+
+void *wm_os_internal_malloc(size_t size);
+void wm_os_internal_free(void *ptr);
+
+#endif /* __WM_OSAL_H__ */
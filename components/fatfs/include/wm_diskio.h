@@ -93,6 +93,7 @@ typedef struct {
     DRESULT (*read)(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count);            /**< Reads data from the disk.*/
     DRESULT (*write)(BYTE pdrv, const BYTE *data_buf, LBA_t sector, UINT count); /**< Writes data to the disk.*/
     DRESULT (*ioctl)(BYTE pdrv, BYTE cmd, void *buff);                           /**< Executes disk control commands.*/
+    DRESULT (*deinit)(BYTE pdrv);                                                /**< Releases the disk, optional.*/
 } wm_diskio_ops_t;
 
 /**
@@ -131,6 +132,21 @@ extern wm_diskio_driver_num_t at_disk_num;
  */
 DRESULT wm_diskio_register(BYTE pdrv, const wm_diskio_ops_t *ops);
 
+/**
+ * @brief Releases the resources of a disk.
+ *
+ * This function writes back the data the driver still holds for the drive and frees its buffers.
+ * Call it after the volume is unmounted with f_unmount; the next f_mount initializes the disk again.
+ *
+ * @param[in] pdrv Drive number (0-FF_VOLUMES)
+ *
+ * @return
+ *    - RES_OK Success
+ *    - RES_PARERR Parameter error
+ *    - others: failed, the data that could not be written back is kept
+ */
+DRESULT wm_diskio_deinit(BYTE pdrv);
+
 /**
  * @}
  */
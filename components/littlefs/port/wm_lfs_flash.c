@@ -31,6 +31,19 @@
 #endif
 #include "wm_log.h"
 
+#if CONFIG_LITTLEFS_CACHE_SIZE % CONFIG_LITTLEFS_READ_SIZE || CONFIG_LITTLEFS_CACHE_SIZE % CONFIG_LITTLEFS_PROG_SIZE || \
+    CONFIG_LITTLEFS_ERASE_SIZE % CONFIG_LITTLEFS_CACHE_SIZE
+#error "LITTLEFS_CACHE_SIZE must be a multiple of the read and program sizes and a factor of the erase size"
+#endif
+
+#if CONFIG_LITTLEFS_LOOKAHEAD_SIZE % 8
+#error "LITTLEFS_LOOKAHEAD_SIZE must be a multiple of 8"
+#endif
+
+#if CONFIG_LITTLEFS_BLOCK_CYCLES == 0
+#error "LITTLEFS_BLOCK_CYCLES must not be 0, use -1 to disable wear leveling"
+#endif
+
 /**
  * @brief Configuration structure for flash block device
  */
@@ -338,9 +351,9 @@ struct lfs_config *lfs_flash_init(wm_lfs_flash_type_t flash_type)
     cfg->prog_size        = fcfg->prog_size;
     cfg->block_size       = fcfg->erase_size;
     cfg->block_count      = fcfg->block_count;
-    cfg->block_cycles     = 500;
-    cfg->cache_size       = fcfg->prog_size;
-    cfg->lookahead_size   = 16;
+    cfg->block_cycles     = CONFIG_LITTLEFS_BLOCK_CYCLES;
+    cfg->cache_size       = CONFIG_LITTLEFS_CACHE_SIZE;
+    cfg->lookahead_size   = CONFIG_LITTLEFS_LOOKAHEAD_SIZE;
     cfg->read_buffer      = NULL;
     cfg->prog_buffer      = NULL;
     cfg->lookahead_buffer = NULL;
@@ -29,6 +29,12 @@
 #define LFS_YES_TRACE  1
 #endif
 
+#if CONFIG_LITTLEFS_BUFFER_IN_PSRAM
+#include "wm_heap.h"
+#define LFS_MALLOC(sz) wm_heap_caps_alloc(sz, WM_HEAP_CAP_SPIRAM)
+#define LFS_FREE(p)    wm_heap_caps_free(p)
+#endif
+
 #define LFS_STRINGIZE(x) LFS_STRINGIZE2(x)
 #define LFS_STRINGIZE2(x) #x
 
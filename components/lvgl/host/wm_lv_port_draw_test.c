@@ -0,0 +1,283 @@
+/**
+ * @file wm_lv_port_draw_test.c
+ *
+ * @brief LVGL Port Draw Kernels Host Test
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wm_lv_port_draw.h"
+
+#define TEST_CASES    200000
+#define TEST_BUF_W    80
+#define TEST_BUF_H    24
+#define TEST_AREA_MAX ((TEST_BUF_W + 16) * (TEST_BUF_H + 16))
+
+enum {
+    TEST_KIND_FILL,
+    TEST_KIND_FILL_MASK,
+    TEST_KIND_MAP,
+    TEST_KIND_MAP_MASK,
+    TEST_KIND_FALLBACK,
+    TEST_KIND_MAX
+};
+
+static const char *g_kind_name[TEST_KIND_MAX] = { "fill", "fill mask", "map", "map mask", "fallback" };
+
+static uint16_t g_dest[TEST_BUF_W * TEST_BUF_H + 2];
+static uint16_t g_ref[TEST_BUF_W * TEST_BUF_H + 2];
+static uint16_t g_src[TEST_AREA_MAX + 2];
+static lv_opa_t g_mask[TEST_AREA_MAX + 4];
+static lv_opa_t g_mask_ref[TEST_AREA_MAX + 4];
+static lv_disp_t *g_disp;
+static int g_fail;
+
+static void test_report(const char *name, int ok, const char *detail)
+{
+    printf("%-24s %s %s\n", name, ok ? "PASS" : "FAIL", detail);
+    g_fail += !ok;
+}
+
+static void test_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    (void)area;
+    (void)color_p;
+    lv_disp_flush_ready(drv);
+}
+
+static void test_disp_init(void)
+{
+    static lv_disp_draw_buf_t draw_buf;
+    static lv_color_t buf[TEST_BUF_W * TEST_BUF_H];
+    static lv_disp_drv_t drv;
+
+    lv_init();
+    lv_disp_draw_buf_init(&draw_buf, buf, NULL, TEST_BUF_W * TEST_BUF_H);
+    lv_disp_drv_init(&drv);
+    drv.hor_res  = TEST_BUF_W;
+    drv.ver_res  = TEST_BUF_H;
+    drv.flush_cb = test_flush;
+    drv.draw_buf = &draw_buf;
+    g_disp       = lv_disp_drv_register(&drv);
+
+    /* both blend functions look up the display being refreshed */
+    _lv_refr_set_disp_refreshing(g_disp);
+}
+
+/* Random pixels, often repeated as in rendered content */
+static void test_fill_px(uint16_t *buf, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        buf[i] = (i > 0 && rand() % 2) ? buf[i - 1] : (uint16_t)rand();
+    }
+}
+
+/* Runs of transparent, opaque and partial mask values, so the four pixel steps see all cases */
+static void test_fill_mask(lv_opa_t *mask, int n)
+{
+    int i = 0;
+    int run;
+    int kind;
+
+    while (i < n) {
+        run  = 1 + rand() % 9;
+        kind = rand() % 3;
+        for (; run > 0 && i < n; run--, i++) {
+            mask[i] = kind == 0 ? LV_OPA_TRANSP : kind == 1 ? LV_OPA_COVER : (lv_opa_t)rand();
+        }
+    }
+}
+
+static lv_opa_t test_opa(void)
+{
+    static const lv_opa_t edges[] = { LV_OPA_MIN + 1, 127, 128, LV_OPA_MAX - 1, LV_OPA_MAX, 254, LV_OPA_COVER };
+
+    if (rand() % 2) {
+        return edges[rand() % (sizeof(edges) / sizeof(edges[0]))];
+    }
+
+    /* lv_draw_sw_blend() drops anything at or below LV_OPA_MIN before the blend callback */
+    return (lv_opa_t)(LV_OPA_MIN + 1 + rand() % (LV_OPA_COVER - LV_OPA_MIN));
+}
+
+static void test_blend(int *cases, int *errors)
+{
+    lv_draw_ctx_t ctx;
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_area_t buf_area;
+    lv_area_t clip_area;
+    lv_area_t blend_area;
+    uint16_t *dest;
+    uint16_t *ref;
+    lv_opa_t *mask;
+    lv_opa_t *mask_ref;
+    int buf_w, buf_h, size, kind, shift;
+
+    buf_w = 1 + rand() % TEST_BUF_W;
+    buf_h = 1 + rand() % TEST_BUF_H;
+    size  = buf_w * buf_h;
+
+    buf_area.x1 = rand() % 16;
+    buf_area.y1 = rand() % 16;
+    buf_area.x2 = buf_area.x1 + buf_w - 1;
+    buf_area.y2 = buf_area.y1 + buf_h - 1;
+
+    clip_area.x1 = buf_area.x1 + rand() % buf_w;
+    clip_area.y1 = buf_area.y1 + rand() % buf_h;
+    clip_area.x2 = clip_area.x1 + rand() % (buf_area.x2 - clip_area.x1 + 1);
+    clip_area.y2 = clip_area.y1 + rand() % (buf_area.y2 - clip_area.y1 + 1);
+
+    /* the blended area may reach out of the clip area on every side */
+    blend_area.x1 = buf_area.x1 - 8 + rand() % (buf_w + 8);
+    blend_area.y1 = buf_area.y1 - 8 + rand() % (buf_h + 8);
+    blend_area.x2 = blend_area.x1 + rand() % (buf_w + 8);
+    blend_area.y2 = blend_area.y1 + rand() % (buf_h + 8);
+
+    /* odd halfword and byte addresses reach the unaligned heads and tails of the kernels */
+    shift    = rand() % 2;
+    dest     = g_dest + shift;
+    ref      = g_ref + shift;
+    shift    = rand() % 4;
+    mask     = g_mask + shift;
+    mask_ref = g_mask_ref + shift;
+
+    test_fill_px(dest, size);
+    memcpy(ref, dest, size * sizeof(uint16_t));
+
+    memset(&dsc, 0, sizeof(dsc));
+    dsc.blend_area = &blend_area;
+    dsc.color.full = (uint16_t)rand();
+    dsc.opa        = test_opa();
+    dsc.blend_mode = rand() % 20 ? LV_BLEND_MODE_NORMAL : LV_BLEND_MODE_ADDITIVE;
+    dsc.mask_res   = LV_DRAW_MASK_RES_FULL_COVER;
+
+    if (rand() % 2) {
+        dsc.src_buf = (const lv_color_t *)(g_src + rand() % 2);
+        test_fill_px((uint16_t *)dsc.src_buf, lv_area_get_size(&blend_area));
+    }
+
+    if (rand() % 2) {
+        test_fill_mask(mask, lv_area_get_size(&blend_area));
+        dsc.mask_buf  = mask;
+        dsc.mask_area = &blend_area;
+        shift         = rand() % 10;
+        dsc.mask_res  = shift == 0 ? LV_DRAW_MASK_RES_TRANSP :
+                        shift == 1 ? LV_DRAW_MASK_RES_FULL_COVER :
+                                     LV_DRAW_MASK_RES_CHANGED;
+    }
+
+    g_disp->driver->antialiasing = rand() % 20 ? 1 : 0;
+
+    if (dsc.blend_mode != LV_BLEND_MODE_NORMAL || (!g_disp->driver->antialiasing && dsc.mask_buf)) {
+        kind = TEST_KIND_FALLBACK;
+    } else if (dsc.src_buf) {
+        kind = dsc.mask_buf && dsc.mask_res == LV_DRAW_MASK_RES_CHANGED ? TEST_KIND_MAP_MASK : TEST_KIND_MAP;
+    } else {
+        kind = dsc.mask_buf && dsc.mask_res == LV_DRAW_MASK_RES_CHANGED ? TEST_KIND_FILL_MASK : TEST_KIND_FILL;
+    }
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.buf_area  = &buf_area;
+    ctx.clip_area = &clip_area;
+
+    /* the reference may round the mask in place, each side gets its own copy */
+    if (dsc.mask_buf) {
+        memcpy(mask_ref, mask, lv_area_get_size(&blend_area));
+    }
+
+    ctx.buf = dest;
+    wm_lv_port_draw_blend(&ctx, &dsc);
+
+    ctx.buf = ref;
+    if (dsc.mask_buf) {
+        dsc.mask_buf = mask_ref;
+    }
+    lv_draw_sw_blend_basic(&ctx, &dsc);
+
+    cases[kind]++;
+    if (memcmp(dest, ref, size * sizeof(uint16_t))) {
+        errors[kind]++;
+    }
+}
+
+static void test_blend_all(void)
+{
+    int cases[TEST_KIND_MAX]  = { 0 };
+    int errors[TEST_KIND_MAX] = { 0 };
+    char name[32];
+    char detail[96];
+    int i;
+
+    for (i = 0; i < TEST_CASES; i++) {
+        test_blend(cases, errors);
+    }
+
+    for (i = 0; i < TEST_KIND_MAX; i++) {
+        snprintf(name, sizeof(name), "blend %s", g_kind_name[i]);
+        snprintf(detail, sizeof(detail), "%d cases, %d differ from lv_draw_sw_blend_basic", cases[i], errors[i]);
+        test_report(name, cases[i] > 0 && errors[i] == 0, detail);
+    }
+}
+
+static void test_swap(void)
+{
+    uint16_t buf[68];
+    uint16_t ref[68];
+    int ok = 1;
+    int i, n, shift, k;
+
+    for (i = 0; i < 10000; i++) {
+        shift = rand() % 2;
+        n     = rand() % 64;
+        test_fill_px(buf, sizeof(buf) / sizeof(buf[0]));
+        memcpy(ref, buf, sizeof(buf));
+        for (k = shift; k < shift + n; k++) {
+            ref[k] = (uint16_t)((ref[k] << 8) | (ref[k] >> 8));
+        }
+
+        wm_lv_port_swap_rgb565((lv_color_t *)(buf + shift), n);
+        ok &= !memcmp(buf, ref, sizeof(buf));
+    }
+
+    test_report("swap rgb565", ok, "10000 runs, all lengths and alignments");
+}
+
+int main(void)
+{
+    char detail[64];
+
+    srand(1);
+    test_disp_init();
+
+    snprintf(detail, sizeof(detail), "LV_COLOR_16_SWAP %d, LV_COLOR_MIX_ROUND_OFS %d", LV_COLOR_16_SWAP,
+             LV_COLOR_MIX_ROUND_OFS);
+    test_report("config", LV_COLOR_DEPTH == 16, detail);
+
+    test_blend_all();
+    test_swap();
+
+    printf("%s\n", g_fail ? "FAILED" : "ALL PASSED");
+
+    return g_fail ? 1 : 0;
+}
@@ -0,0 +1,11 @@
+/**
+ * @file wmsdk_config.h
+ *
+ * @brief Host build stand-in for the Kconfig output, no option is set
+ *
+ */
+
+#ifndef __WMSDK_CONFIG_H__
+#define __WMSDK_CONFIG_H__
+
+#endif /* __WMSDK_CONFIG_H__ */
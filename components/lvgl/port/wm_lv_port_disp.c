@@ -25,12 +25,12 @@
  *      INCLUDES
  *********************/
 #include "wm_lv_port_disp.h"
+#include "wm_lv_port_draw.h"
 #include <stdbool.h>
 
 #include "wm_error.h"
 #include "wm_drv_tft_lcd.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
+#include "wm_osal.h"
 
 #define LOG_TAG "lvgl_port"
 #include "wm_log.h"
@@ -38,13 +38,14 @@
 /*********************
  *      DEFINES
  *********************/
+#define LVGL_PORT_FLUSH_TIMEOUT_MS (2000) /*longest time to wait for a bitmap transmission*/
 
 /**********************
  *      TYPEDEFS
  **********************/
 typedef struct {
     wm_device_t *dev;
-    SemaphoreHandle_t lvgl_sem; /*semaphore to control the timing of next buffer filling*/
+    wm_os_sem_t *lvgl_sem; /*semaphore given by the tx callback, wakes up LVGL waiting for a free buffer*/
 } wm_lvgl_ctx_t;
 
 /**********************
@@ -54,11 +55,15 @@ static void disp_init(void);
 
 static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
 
+static void disp_wait(lv_disp_drv_t *disp_drv);
+
 /**********************
  *  STATIC VARIABLES
  **********************/
 static wm_lvgl_ctx_t wm_lvgl_ctx = { 0 };
 
+static lv_disp_drv_t disp_drv; /*Descriptor of a display driver*/
+
 #define LVGL_PORT_BUFF_SIZE (MY_DISP_HOR_RES * MY_DISP_VER_RES / 8) // 1/8 screen resolution
 static lv_color_t lvgl_draw_buff1[LVGL_PORT_BUFF_SIZE];
 static lv_color_t lvgl_draw_buff2[LVGL_PORT_BUFF_SIZE];
@@ -66,14 +71,13 @@ static lv_color_t lvgl_draw_buff2[LVGL_PORT_BUFF_SIZE];
 /**********************
  *   GLOBAL FUNCTIONS
  **********************/
+/*Called once per bitmap, mostly from the DMA ISR. The buffer is free again, LVGL may render into it*/
 void wm_lvgl_tx_cb(int result, void *data)
 {
-    if (result != WM_ERR_SUCCESS) {
-        wm_log_info("lcd_demo_tx_cb fail");
-    }
+    lv_disp_flush_ready(&disp_drv);
+
     if (wm_lvgl_ctx.lvgl_sem != NULL) {
-        //wm_log_info("give lvgl_sem");
-        xSemaphoreGive(wm_lvgl_ctx.lvgl_sem);
+        wm_os_internal_sem_release(wm_lvgl_ctx.lvgl_sem);
     }
 }
 
@@ -138,8 +142,7 @@ void lv_port_disp_init(void)
      * Register the display in LVGL
      *----------------------------------*/
 
-    static lv_disp_drv_t disp_drv; /*Descriptor of a display driver*/
-    lv_disp_drv_init(&disp_drv);   /*Basic initialization*/
+    lv_disp_drv_init(&disp_drv); /*Basic initialization*/
 
     /*Set up the functions to access to your display*/
 
@@ -150,6 +153,14 @@ void lv_port_disp_init(void)
     /*Used to copy the buffer's content to the display*/
     disp_drv.flush_cb = disp_flush;
 
+    /*Sleep instead of polling while both buffers are in use*/
+    disp_drv.wait_cb = disp_wait;
+
+#if CONFIG_LV_PORT_DRAW_OPTIMIZE
+    /*Blend with the optimized kernels, the rest of the software renderer is kept*/
+    disp_drv.draw_ctx_init = wm_lv_port_draw_ctx_init;
+#endif
+
     /*Set a display buffer*/
     disp_drv.draw_buf = &draw_buf_dsc;
 
@@ -180,7 +191,9 @@ static void disp_init(void)
         wm_log_error("lvgl disp init fail");
     }
 
-    wm_lvgl_ctx.lvgl_sem = xSemaphoreCreateCounting(1, 0);
+    if (wm_os_internal_sem_create(&wm_lvgl_ctx.lvgl_sem, 0) != WM_OS_STATUS_SUCCESS) {
+        wm_log_error("lvgl sem create fail");
+    }
 }
 
 volatile bool disp_flush_enabled = true;
@@ -200,8 +213,8 @@ void disp_disable_update(void)
 }
 
 /*Flush the content of the internal buffer the specific area on the display
- *You can use DMA or any hardware acceleration to do this operation in the background but
- *'lv_disp_flush_ready()' has to be called when finished.*/
+ *The bitmap is sent by DMA in the background, 'lv_disp_flush_ready()' is called from the tx callback
+ *once it is done, so LVGL renders the next area into the other buffer meanwhile.*/
 static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
 {
     int ret                      = WM_ERR_SUCCESS;
@@ -216,15 +229,33 @@ static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_
         data_desc.buf      = (uint8_t *)color_p;
         data_desc.buf_size = (area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1) * (sizeof(lv_color_t));
 
+#if CONFIG_LV_PORT_FLUSH_SWAP
+        /*The panel takes the high byte first, the area is rendered again before the buffer is reused*/
+        wm_lv_port_swap_rgb565(color_p, data_desc.buf_size / sizeof(lv_color_t));
+#endif
+
+        /*LVGL waits for the previous bitmap before flushing again, a count left from it is stale*/
+        wm_os_internal_sem_reset(wm_lvgl_ctx.lvgl_sem);
+
         ret = wm_drv_tft_lcd_draw_bitmap(dev, data_desc);
-        if (ret != WM_ERR_SUCCESS) {
-            wm_log_info("draw bitmap ret(%d)", ret);
+        if (ret == WM_ERR_SUCCESS) {
+            return;
         }
+        wm_log_info("draw bitmap ret(%d)", ret);
     }
 
-    xSemaphoreTake(wm_lvgl_ctx.lvgl_sem, pdMS_TO_TICKS(2000));
-
     /*IMPORTANT!!!
-     *Inform the graphics library that you are ready with the flushing*/
+     *Nothing is in flight, inform the graphics library that you are ready with the flushing*/
     lv_disp_flush_ready(disp_drv);
+}
+
+/*Called by LVGL in a loop as long as the flushed buffer is not released*/
+static void disp_wait(lv_disp_drv_t *disp_drv)
+{
+    if (wm_os_internal_sem_acquire_ms(wm_lvgl_ctx.lvgl_sem, LVGL_PORT_FLUSH_TIMEOUT_MS) != WM_OS_STATUS_SUCCESS &&
+        disp_drv->draw_buf->flushing) {
+        /*the transmission is lost, release the buffer to keep LVGL running*/
+        wm_log_error("flush timeout");
+        lv_disp_flush_ready(disp_drv);
+    }
 }
\ No newline at end of file
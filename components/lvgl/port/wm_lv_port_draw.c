@@ -0,0 +1,450 @@
+/**
+ * @file wm_lv_port_draw.c
+ *
+ * @brief LVGL Porting Layer of Draw Kernels
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "wm_lv_port_draw.h"
+#include <stdint.h>
+#include <string.h>
+
+#include "wmsdk_config.h"
+
+#if CONFIG_CHIP_W80X
+#include "core_804.h"
+#include "csi_gcc.h"
+#include "csi_dsp/csi_math.h"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+/*rows shorter than this are filled or copied inline, the DSP routines only pay off on longer runs*/
+#define WM_LV_DRAW_DSP_MIN_PX (16)
+
+/*swap the two bytes of each halfword*/
+#if CONFIG_CHIP_W80X
+#define WM_LV_REV16(x) __REV16(x)
+#else
+#define WM_LV_REV16(x) ((((x)&0x00FF00FFU) << 8) | (((x) >> 8) & 0x00FF00FFU))
+#endif
+
+/*convert between lv_color_t and native RGB565, the kernels mix native pixels*/
+#if LV_COLOR_16_SWAP
+#define WM_LV_PX_TO_565(c) ((uint32_t)(uint16_t)WM_LV_REV16((uint32_t)(c)))
+#else
+#define WM_LV_PX_TO_565(c) ((uint32_t)(c))
+#endif
+#define WM_LV_565_TO_PX(c) ((uint16_t)WM_LV_PX_TO_565(c))
+
+/*the two lanes of a premultiplied red/blue pair*/
+#define WM_LV_RB(c)   ((((c) >> 11) << 16) | ((c)&0x1F))
+#define WM_LV_G(c)    (((c) >> 5) & 0x3F)
+#define WM_LV_OFS_RB  (((uint32_t)LV_COLOR_MIX_ROUND_OFS << 16) | LV_COLOR_MIX_ROUND_OFS)
+#define WM_LV_MASK_RB (0x00FF00FFU)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+#if LV_COLOR_DEPTH == 16
+static void fill_opa(uint16_t *dest, lv_coord_t w, lv_coord_t h, lv_coord_t dest_stride, uint16_t color, lv_opa_t opa);
+static void fill_mask(uint16_t *dest, lv_coord_t w, lv_coord_t h, lv_coord_t dest_stride, uint16_t color, lv_opa_t opa,
+                      const lv_opa_t *mask, lv_coord_t mask_stride);
+static void map_opa(uint16_t *dest, lv_coord_t w, lv_coord_t h, lv_coord_t dest_stride, const uint16_t *src,
+                    lv_coord_t src_stride, lv_opa_t opa);
+static void map_mask(uint16_t *dest, lv_coord_t w, lv_coord_t h, lv_coord_t dest_stride, const uint16_t *src,
+                     lv_coord_t src_stride, lv_opa_t opa, const lv_opa_t *mask, lv_coord_t mask_stride);
+#endif
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void wm_lv_port_draw_ctx_init(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_sw_init_ctx(drv, draw_ctx);
+
+    ((lv_draw_sw_ctx_t *)draw_ctx)->blend = wm_lv_port_draw_blend;
+}
+
+void wm_lv_port_swap_rgb565(lv_color_t *buf, uint32_t px_num)
+{
+    uint16_t *p = (uint16_t *)buf;
+    uint32_t *p32;
+
+    if (((uintptr_t)p & 0x3) && px_num) {
+        *p = (uint16_t)WM_LV_REV16((uint32_t)*p);
+        p++;
+        px_num--;
+    }
+
+    /*two pixels per word*/
+    p32 = (uint32_t *)p;
+    while (px_num >= 2) {
+        *p32 = WM_LV_REV16(*p32);
+        p32++;
+        px_num -= 2;
+    }
+
+    if (px_num) {
+        p  = (uint16_t *)p32;
+        *p = (uint16_t)WM_LV_REV16((uint32_t)*p);
+    }
+}
+
+#if LV_COLOR_DEPTH == 16
+
+void wm_lv_port_draw_blend(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc)
+{
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    const lv_opa_t *mask;
+    const uint16_t *src = NULL;
+    uint16_t *dest;
+    lv_coord_t dest_stride;
+    lv_coord_t src_stride  = 0;
+    lv_coord_t mask_stride = 0;
+    lv_coord_t w;
+    lv_coord_t h;
+    lv_area_t blend_area;
+    lv_coord_t y;
+
+    /*the same mask handling as lv_draw_sw_blend_basic()*/
+    if (dsc->mask_buf && dsc->mask_res == LV_DRAW_MASK_RES_TRANSP) {
+        return;
+    } else if (dsc->mask_res == LV_DRAW_MASK_RES_FULL_COVER) {
+        mask = NULL;
+    } else {
+        mask = dsc->mask_buf;
+    }
+
+    /*no kernel for these, let LVGL do them*/
+    if (disp->driver->set_px_cb || disp->driver->screen_transp || dsc->blend_mode != LV_BLEND_MODE_NORMAL ||
+        (mask && !disp->driver->antialiasing)) {
+        lv_draw_sw_blend_basic(draw_ctx, dsc);
+        return;
+    }
+
+    if (!_lv_area_intersect(&blend_area, dsc->blend_area, draw_ctx->clip_area)) {
+        return;
+    }
+
+    w           = lv_area_get_width(&blend_area);
+    h           = lv_area_get_height(&blend_area);
+    dest_stride = lv_area_get_width(draw_ctx->buf_area);
+    dest        = (uint16_t *)draw_ctx->buf + dest_stride * (blend_area.y1 - draw_ctx->buf_area->y1) +
+           (blend_area.x1 - draw_ctx->buf_area->x1);
+
+    if (dsc->src_buf) {
+        src_stride = lv_area_get_width(dsc->blend_area);
+        src        = (const uint16_t *)dsc->src_buf + src_stride * (blend_area.y1 - dsc->blend_area->y1) +
+              (blend_area.x1 - dsc->blend_area->x1);
+    }
+
+    if (mask) {
+        mask_stride = lv_area_get_width(dsc->mask_area);
+        mask += mask_stride * (blend_area.y1 - dsc->mask_area->y1) + (blend_area.x1 - dsc->mask_area->x1);
+    }
+
+    if (src == NULL) {
+        if (mask) {
+            fill_mask(dest, w, h, dest_stride, dsc->color.full, dsc->opa, mask, mask_stride);
+        } else if (dsc->opa >= LV_OPA_MAX) {
+            for (y = 0; y < h; y++) {
+#if CONFIG_CHIP_W80X
+                if (w >= WM_LV_DRAW_DSP_MIN_PX) {
+                    csi_fill_q15((q15_t)dsc->color.full, (q15_t *)dest, w);
+                } else
+#endif
+                {
+                    lv_color_fill((lv_color_t *)dest, dsc->color, w);
+                }
+                dest += dest_stride;
+            }
+        } else {
+            fill_opa(dest, w, h, dest_stride, dsc->color.full, dsc->opa);
+        }
+    } else {
+        if (mask) {
+            map_mask(dest, w, h, dest_stride, src, src_stride, dsc->opa, mask, mask_stride);
+        } else if (dsc->opa >= LV_OPA_MAX) {
+            for (y = 0; y < h; y++) {
+#if CONFIG_CHIP_W80X
+                if (w >= WM_LV_DRAW_DSP_MIN_PX) {
+                    csi_copy_q15((const q15_t *)src, (q15_t *)dest, w);
+                } else
+#endif
+                {
+                    lv_memcpy(dest, src, w * sizeof(uint16_t));
+                }
+                dest += dest_stride;
+                src += src_stride;
+            }
+        } else {
+            map_opa(dest, w, h, dest_stride, src, src_stride, dsc->opa);
+        }
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*Mix fg_rb/fg_g, red/blue and green already multiplied by the ratio with the rounding offset added,
+ *into the native pixel bg weighted by mix_inv. The same result as LV_UDIV255() on each channel,
+ *red and blue are divided together in two 16 bit lanes.*/
+static inline uint32_t mix_premult(uint32_t fg_rb, uint32_t fg_g, uint32_t bg, uint32_t mix_inv)
+{
+    uint32_t rb = fg_rb + WM_LV_RB(bg) * mix_inv;
+    uint32_t g  = fg_g + WM_LV_G(bg) * mix_inv;
+
+    rb = ((rb + 0x00010001U + ((rb >> 8) & WM_LV_MASK_RB)) >> 8) & WM_LV_MASK_RB;
+    g  = (g + 1 + (g >> 8)) >> 8;
+
+    return ((rb >> 16) << 11) | (g << 5) | (rb & 0x1F);
+}
+
+/*lv_color_mix() on native pixels*/
+static inline uint32_t mix(uint32_t fg, uint32_t bg, uint32_t ratio)
+{
+#if LV_COLOR_MIX_ROUND_OFS == 0
+    uint32_t res;
+
+    ratio = (ratio + 4) >> 3;
+    fg    = (fg | (fg << 16)) & 0x7E0F81F;
+    bg    = (bg | (bg << 16)) & 0x7E0F81F;
+    res   = ((((fg - bg) * ratio) >> 5) + bg) & 0x7E0F81F;
+
+    return (res >> 16 | res) & 0xFFFF;
+#else
+    return mix_premult(WM_LV_RB(fg) * ratio + WM_LV_OFS_RB, WM_LV_G(fg) * ratio + LV_COLOR_MIX_ROUND_OFS, bg,
+                       255 - ratio);
+#endif
+}
+
+/*Fill with opacity, the color is premultiplied once, as fill_normal() of LVGL does*/
+static void fill_opa(uint16_t *dest, lv_coord_t w, lv_coord_t h, lv_coord_t dest_stride, uint16_t color, lv_opa_t opa)
+{
+    uint32_t fg = WM_LV_PX_TO_565(color);
+    uint32_t fg_rb;
+    uint32_t fg_g;
+    uint32_t opa_inv;
+    uint16_t last_dest;
+    uint16_t last_res;
+    lv_coord_t x;
+    lv_coord_t y;
+
+    /*start from the black LVGL caches, so black pixels get exactly its result*/
+    last_dest = 0;
+    last_res  = WM_LV_565_TO_PX(mix(fg, 0, opa));
+
+#if LV_COLOR_MIX_ROUND_OFS == 0
+    /*lv_color_premult() is fed the opacity rounded as lv_color_mix() does*/
+    opa = ((opa + 4) >> 3) << 3;
+#endif
+    fg_rb   = WM_LV_RB(fg) * opa + WM_LV_OFS_RB;
+    fg_g    = WM_LV_G(fg) * opa + LV_COLOR_MIX_ROUND_OFS;
+    opa_inv = 255 - opa;
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; x++) {
+            if (dest[x] != last_dest) {
+                last_dest = dest[x];
+                last_res  = WM_LV_565_TO_PX(mix_premult(fg_rb, fg_g, WM_LV_PX_TO_565(last_dest), opa_inv));
+            }
+            dest[x] = last_res;
+        }
+        dest += dest_stride;
+    }
+}
+
+static void fill_mask(uint16_t *dest, lv_coord_t w, lv_coord_t h, lv_coord_t dest_stride, uint16_t color, lv_opa_t opa,
+                      const lv_opa_t *mask, lv_coord_t mask_stride)
+{
+    uint32_t fg = WM_LV_PX_TO_565(color);
+    uint32_t c32 = color | ((uint32_t)color << 16);
+    lv_opa_t last_mask = LV_OPA_TRANSP;
+    lv_opa_t ratio     = LV_OPA_TRANSP;
+    const lv_opa_t *m;
+    uint32_t m32;
+    lv_coord_t i;
+    lv_coord_t x;
+    lv_coord_t y;
+
+    for (y = 0; y < h; y++) {
+        m = mask;
+        x = 0;
+
+        if (opa >= LV_OPA_MAX) {
+            /*only the mask matters, skip or fill four pixels at a time where the mask is flat*/
+            for (; x < w && ((uintptr_t)(m + x) & 0x3); x++) {
+                if (m[x] == LV_OPA_COVER) {
+                    dest[x] = color;
+                } else if (m[x]) {
+                    dest[x] = WM_LV_565_TO_PX(mix(fg, WM_LV_PX_TO_565(dest[x]), m[x]));
+                }
+            }
+            for (; x + 4 <= w; x += 4) {
+                m32 = *(const uint32_t *)(m + x);
+                if (m32 == 0) {
+                    continue;
+                } else if (m32 == 0xFFFFFFFF) {
+                    if ((uintptr_t)(dest + x) & 0x3) {
+                        dest[x]                     = color;
+                        *(uint32_t *)(dest + x + 1) = c32;
+                        dest[x + 3]                 = color;
+                    } else {
+                        *(uint32_t *)(dest + x)     = c32;
+                        *(uint32_t *)(dest + x + 2) = c32;
+                    }
+                } else {
+                    for (i = x; i < x + 4; i++) {
+                        if (m[i] == LV_OPA_COVER) {
+                            dest[i] = color;
+                        } else if (m[i]) {
+                            dest[i] = WM_LV_565_TO_PX(mix(fg, WM_LV_PX_TO_565(dest[i]), m[i]));
+                        }
+                    }
+                }
+            }
+            for (; x < w; x++) {
+                if (m[x] == LV_OPA_COVER) {
+                    dest[x] = color;
+                } else if (m[x]) {
+                    dest[x] = WM_LV_565_TO_PX(mix(fg, WM_LV_PX_TO_565(dest[x]), m[x]));
+                }
+            }
+        } else {
+            for (; x < w; x++) {
+                if (m[x]) {
+                    if (m[x] != last_mask) {
+                        last_mask = m[x];
+                        ratio     = m[x] == LV_OPA_COVER ? opa : (uint32_t)((uint32_t)m[x] * opa) >> 8;
+                    }
+                    dest[x] = WM_LV_565_TO_PX(mix(fg, WM_LV_PX_TO_565(dest[x]), ratio));
+                }
+            }
+        }
+
+        dest += dest_stride;
+        mask += mask_stride;
+    }
+}
+
+static void map_opa(uint16_t *dest, lv_coord_t w, lv_coord_t h, lv_coord_t dest_stride, const uint16_t *src,
+                    lv_coord_t src_stride, lv_opa_t opa)
+{
+    lv_coord_t x;
+    lv_coord_t y;
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; x++) {
+            dest[x] = WM_LV_565_TO_PX(mix(WM_LV_PX_TO_565(src[x]), WM_LV_PX_TO_565(dest[x]), opa));
+        }
+        dest += dest_stride;
+        src += src_stride;
+    }
+}
+
+static void map_mask(uint16_t *dest, lv_coord_t w, lv_coord_t h, lv_coord_t dest_stride, const uint16_t *src,
+                     lv_coord_t src_stride, lv_opa_t opa, const lv_opa_t *mask, lv_coord_t mask_stride)
+{
+    uint32_t m32;
+    lv_coord_t i;
+    lv_coord_t x;
+    lv_coord_t y;
+    lv_opa_t ratio;
+
+    for (y = 0; y < h; y++) {
+        x = 0;
+
+        if (opa > LV_OPA_MAX) {
+            /*only the mask matters, skip or copy four pixels at a time where the mask is flat*/
+            for (; x < w && ((uintptr_t)(mask + x) & 0x3); x++) {
+                if (mask[x] == LV_OPA_COVER) {
+                    dest[x] = src[x];
+                } else if (mask[x]) {
+                    dest[x] = WM_LV_565_TO_PX(mix(WM_LV_PX_TO_565(src[x]), WM_LV_PX_TO_565(dest[x]), mask[x]));
+                }
+            }
+            for (; x + 4 <= w; x += 4) {
+                m32 = *(const uint32_t *)(mask + x);
+                if (m32 == 0) {
+                    continue;
+                } else if (m32 == 0xFFFFFFFF) {
+                    dest[x]     = src[x];
+                    dest[x + 1] = src[x + 1];
+                    dest[x + 2] = src[x + 2];
+                    dest[x + 3] = src[x + 3];
+                } else {
+                    for (i = x; i < x + 4; i++) {
+                        if (mask[i] == LV_OPA_COVER) {
+                            dest[i] = src[i];
+                        } else if (mask[i]) {
+                            dest[i] =
+                                WM_LV_565_TO_PX(mix(WM_LV_PX_TO_565(src[i]), WM_LV_PX_TO_565(dest[i]), mask[i]));
+                        }
+                    }
+                }
+            }
+            for (; x < w; x++) {
+                if (mask[x] == LV_OPA_COVER) {
+                    dest[x] = src[x];
+                } else if (mask[x]) {
+                    dest[x] = WM_LV_565_TO_PX(mix(WM_LV_PX_TO_565(src[x]), WM_LV_PX_TO_565(dest[x]), mask[x]));
+                }
+            }
+        } else {
+            for (; x < w; x++) {
+                if (mask[x]) {
+                    ratio   = mask[x] >= LV_OPA_MAX ? opa : (uint32_t)((uint32_t)opa * mask[x]) >> 8;
+                    dest[x] = WM_LV_565_TO_PX(mix(WM_LV_PX_TO_565(src[x]), WM_LV_PX_TO_565(dest[x]), ratio));
+                }
+            }
+        }
+
+        dest += dest_stride;
+        src += src_stride;
+        mask += mask_stride;
+    }
+}
+
+#else /*LV_COLOR_DEPTH == 16*/
+
+void wm_lv_port_draw_blend(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc)
+{
+    /*the kernels work on RGB565 only*/
+    lv_draw_sw_blend_basic(draw_ctx, dsc);
+}
+
+#endif /*LV_COLOR_DEPTH == 16*/
@@ -0,0 +1,72 @@
+/**
+ * @file wm_lv_port_draw.h
+ *
+ * @brief LVGL Porting Layer of Draw Kernels
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_LV_PORT_DRAW_H__
+#define __WM_LV_PORT_DRAW_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#if defined(LV_LVGL_H_INCLUDE_SIMPLE)
+#include "lvgl.h"
+#else
+#include "../lvgl.h"
+#endif
+#include "draw/sw/lv_draw_sw.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+/* Initialize a software draw context whose blend uses the optimized kernels,
+ * set it as draw_ctx_init of the display driver */
+void wm_lv_port_draw_ctx_init(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx);
+
+/* Blend a fill or an image into the draw buffer, same result as lv_draw_sw_blend_basic().
+ * Cases without a fast kernel are passed to lv_draw_sw_blend_basic() */
+void wm_lv_port_draw_blend(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc);
+
+/* Swap the two bytes of px_num RGB565 pixels in place, for SPI panels fed by a buffer rendered without
+ * LV_COLOR_16_SWAP */
+void wm_lv_port_swap_rgb565(lv_color_t *buf, uint32_t px_num);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*__WM_LV_PORT_DRAW_H__*/
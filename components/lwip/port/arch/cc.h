@@ -2,6 +2,7 @@
 #define CC_H_INCLUDED
 
 #include <stdio.h>
+#include <stdint.h>
 #include <assert.h>
 
 /* Define platform endianness */
@@ -77,6 +78,17 @@ void wm_lwip_print(const char *format, ...);
     } while (0)
 #endif
 
+#if CONFIG_LWIP_CHKSUM_OPTIMIZE
+/* Word-at-a-time checksum routines for XT804, see wm_lwip_chksum.c */
+uint16_t wm_lwip_chksum(const void *dataptr, int len);
+uint16_t wm_lwip_chksum_copy(void *dst, const void *src, uint16_t len);
+
+#define LWIP_CHKSUM wm_lwip_chksum
+#if CONFIG_LWIP_CHKSUM_ON_COPY
+#define LWIP_CHKSUM_COPY(dst, src, len) wm_lwip_chksum_copy(dst, src, len)
+#endif
+#endif
+
 /* define LWIP_COMPAT_MUTEX
     to let sys.h use binary semaphores instead of mutexes - as before in 1.3.2
     Refer CHANGELOG
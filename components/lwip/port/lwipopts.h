@@ -28,7 +28,14 @@
 #define NO_SYS                 0
 #define SYS_LIGHTWEIGHT_PROT   1
 
+#if CONFIG_LWIP_STATS
+#define LWIP_STATS             1
+#define MIB2_STATS             1
+#define MEM_STATS              1
+#define MEMP_STATS             1
+#else
 #define LWIP_STATS             0
+#endif
 
 #define LWIP_SOCKET            1
 #define LWIP_NETCONN           1
@@ -68,6 +75,11 @@
 #define LWIP_HAVE_LOOPIF 0
 #endif /* LWIP_UNITTESTS_LIB */
 
+#if CONFIG_LWIP_TCP_ADAPTIVE_WND
+/* The send buffer may shrink to LWIP_TCP_SND_BUF_MIN, keep sockets writable below that */
+#define TCP_SNDLOWAT ((CONFIG_LWIP_TCP_SND_BUF_MIN * CONFIG_LWIP_TCP_MSS) / 2)
+#endif
+
 #ifdef CONFIG_LWIP_NETBUF_RECVINFO
 #define LWIP_NETBUF_RECVINFO 1
 #endif
@@ -140,6 +152,9 @@
 #define ARP_QUEUEING                   1
 
 #define MEM_ALIGNMENT                  4
+#if CONFIG_LWIP_CHKSUM_ON_COPY
+#define LWIP_CHECKSUM_ON_COPY 1
+#endif
 #define LWIP_TCPIP_TIMEOUT             1
 #define LWIP_NETIF_HOSTNAME            1
 #define LWIP_TCP_KEEPALIVE             1
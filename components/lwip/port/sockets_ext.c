@@ -11,6 +11,9 @@
 #include "lwip/tcp.h"
 #include "lwip/raw.h"
 #include "lwip/udp.h"
+#include "wm_error.h"
+#include "wm_osal.h"
+#include "wm_partition_table.h"
 
 #define LWIP_SOCKOPT_CHECK_OPTLEN_CONN_PCB(sock, optlen, opttype) do { \
   if (((optlen) < sizeof(opttype)) || ((sock)->conn == NULL) || ((sock)->conn->pcb.tcp == NULL)) { *err=EINVAL; goto exit; } }while(0)
@@ -106,3 +109,89 @@ exit:
     return true;
 #endif /* LWIP_IPV6 */
 }
+
+/* Chunk read from sources that are not memory mapped */
+#define WM_SOCKET_SENDFILE_CHUNK_SIZE (2 * TCP_MSS)
+
+int wm_socket_sendfile_src_partition(wm_socket_sendfile_src_t *src, const char *name)
+{
+    wm_partition_item_t partition;
+    int ret;
+
+    if (!src || !name) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    ret = wm_partition_table_find(name, &partition);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    memset(src, 0, sizeof(*src));
+    /* Internal flash is memory mapped, partition offsets are relative to its base */
+    src->addr = (const uint8_t *)(CONFIG_FLASH_BASE_ADDR + partition.offset);
+    src->size = partition.size;
+
+    return WM_ERR_SUCCESS;
+}
+
+static ssize_t wm_socket_sendfile_read(int s, const wm_socket_sendfile_src_t *src, uint32_t offset, size_t count)
+{
+    uint8_t *buf;
+    size_t total = 0;
+    ssize_t sent = 0;
+    int len;
+
+    buf = wm_os_internal_malloc(WM_SOCKET_SENDFILE_CHUNK_SIZE);
+    if (!buf) {
+        set_errno(ENOMEM);
+        return -1;
+    }
+
+    while (total < count) {
+        len = src->read(src->priv, offset + total, buf, LWIP_MIN(count - total, WM_SOCKET_SENDFILE_CHUNK_SIZE));
+        if (len <= 0) {
+            if (len < 0 && total == 0) {
+                set_errno(EIO);
+                sent = -1;
+            }
+            break;
+        }
+
+        sent = lwip_send(s, buf, len, (total + len < count) ? MSG_MORE : 0);
+        if (sent <= 0) {
+            break;
+        }
+
+        total += sent;
+        if (sent < len) {
+            /* Non-blocking socket is full, the caller resumes from offset + total */
+            break;
+        }
+    }
+
+    wm_os_internal_free(buf);
+
+    return (total > 0) ? (ssize_t)total : sent;
+}
+
+ssize_t wm_socket_sendfile(int s, const wm_socket_sendfile_src_t *src, uint32_t offset, size_t count)
+{
+    if (!src || (!src->addr && !src->read)) {
+        set_errno(EINVAL);
+        return -1;
+    }
+
+    if (offset >= src->size) {
+        return 0;
+    }
+
+    count = LWIP_MIN(count, src->size - offset);
+
+    if (src->addr) {
+        /* tcp_write() references the mapped data with PBUF_ROM, nothing is copied */
+        return lwip_send(s, src->addr + offset, count, MSG_NOCOPY);
+    }
+
+    return wm_socket_sendfile_read(s, src, offset, count);
+}
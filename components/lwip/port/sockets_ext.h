@@ -6,6 +6,8 @@
 #pragma once
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,6 +21,64 @@ struct lwip_sock;
 
 bool lwip_setsockopt_impl_ext(struct lwip_sock* sock, int level, int optname, const void *optval, uint32_t optlen, int *err);
 bool lwip_getsockopt_impl_ext(struct lwip_sock* sock, int level, int optname, void *optval, uint32_t *optlen, int *err);
+
+/**
+ * @brief Read function of a sendfile source that is not memory mapped
+ *
+ * @param[in] priv User data of the source
+ * @param[in] offset Offset in the source
+ * @param[out] buf Buffer receiving the data
+ * @param[in] len Number of bytes to read
+ *
+ * @return Number of bytes read, 0 at the end of the source, negative on error
+ */
+typedef int (*wm_socket_sendfile_read_t)(void *priv, uint32_t offset, void *buf, uint32_t len);
+
+/**
+ * @brief Source of wm_socket_sendfile()
+ *
+ * When addr is set the data is sent without copying, lwIP references it until
+ * it is acknowledged, so it must be read-only memory that stays mapped, such as
+ * XIP flash or const data. Otherwise the data is read in chunks with read.
+ */
+typedef struct {
+    const uint8_t *addr;            /**< Memory mapped start of the source, or NULL */
+    wm_socket_sendfile_read_t read; /**< Read function, used when addr is NULL */
+    void *priv;                     /**< User data passed to read */
+    uint32_t size;                  /**< Size of the source in bytes */
+} wm_socket_sendfile_src_t;
+
+/**
+ * @brief Describe a partition of the internal flash as a memory mapped sendfile source
+ *
+ * @param[out] src Source to fill
+ * @param[in] name Partition name
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_NOT_FOUND: no such partition
+ *
+ * @note The partition must not be written while data of it may still be queued on a connection.
+ */
+int wm_socket_sendfile_src_partition(wm_socket_sendfile_src_t *src, const char *name);
+
+/**
+ * @brief Send count bytes of a source from offset on a TCP socket
+ *
+ * Memory mapped sources go to lwIP as referenced pbufs without any copy, the
+ * others are read in chunks of a few MSS and copied once into lwIP.
+ *
+ * @param[in] s Socket
+ * @param[in] src Source
+ * @param[in] offset Offset in the source
+ * @param[in] count Number of bytes to send, clipped to the end of the source
+ *
+ * @return Number of bytes sent, may be less than count on a non-blocking socket
+ *         or a short read, -1 with errno set if nothing was sent
+ */
+ssize_t wm_socket_sendfile(int s, const wm_socket_sendfile_src_t *src, uint32_t offset, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,211 @@
+/**
+ * @file wm_lwip_chksum.c
+ *
+ * @brief Optimized internet checksum routines for lwIP on XT804
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "wmsdk_config.h"
+
+#include <stdint.h>
+#include <string.h>
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/inet_chksum.h"
+
+#if CONFIG_LWIP_CHKSUM_OPTIMIZE
+
+/*
+ * The checksum is accumulated 32 bits at a time into a 64 bit accumulator, the
+ * carries are collected in the upper word (add/addc on XT804) and folded once at
+ * the end. The result follows the lwIP LWIP_CHKSUM contract: host order,
+ * non-inverted internet sum relative to the start of the buffer.
+ */
+
+static inline uint16_t wm_lwip_chksum_fold(uint64_t sum, int odd)
+{
+    uint32_t s;
+
+    sum = (sum >> 32) + (sum & 0xFFFFFFFFUL);
+    sum = (sum >> 32) + (sum & 0xFFFFFFFFUL);
+    s   = (uint32_t)sum;
+    s   = FOLD_U32T(s);
+    s   = FOLD_U32T(s);
+
+    /* Swap if alignment was odd */
+    if (odd) {
+        s = SWAP_BYTES_IN_WORD(s);
+    }
+
+    return (uint16_t)s;
+}
+
+u16_t wm_lwip_chksum(const void *dataptr, int len)
+{
+    const uint8_t *pb = (const uint8_t *)dataptr;
+    const uint32_t *pl;
+    uint64_t sum = 0;
+    uint16_t t   = 0;
+    int odd      = ((mem_ptr_t)pb & 1);
+
+    if (len <= 0) {
+        return 0;
+    }
+
+    /* Get aligned to uint16_t, the first byte goes to the upper half and is swapped back at the end */
+    if (odd) {
+        ((uint8_t *)&t)[1] = *pb++;
+        len--;
+    }
+
+    /* Get aligned to uint32_t */
+    if (((mem_ptr_t)pb & 2) && len >= 2) {
+        sum += *(const uint16_t *)(const void *)pb;
+        pb += 2;
+        len -= 2;
+    }
+
+    /* Add the bulk of the data, 32 bytes per iteration */
+    pl = (const uint32_t *)(const void *)pb;
+    while (len >= 32) {
+        sum += pl[0];
+        sum += pl[1];
+        sum += pl[2];
+        sum += pl[3];
+        sum += pl[4];
+        sum += pl[5];
+        sum += pl[6];
+        sum += pl[7];
+        pl += 8;
+        len -= 32;
+    }
+
+    while (len >= 4) {
+        sum += *pl++;
+        len -= 4;
+    }
+
+    /* Consume left-over half word and byte, if any */
+    pb = (const uint8_t *)pl;
+    if (len >= 2) {
+        sum += *(const uint16_t *)(const void *)pb;
+        pb += 2;
+        len -= 2;
+    }
+
+    if (len > 0) {
+        ((uint8_t *)&t)[0] = *pb;
+    }
+
+    sum += t;
+
+    return wm_lwip_chksum_fold(sum, odd);
+}
+
+#if LWIP_CHECKSUM_ON_COPY
+u16_t wm_lwip_chksum_copy(void *dst, const void *src, u16_t len)
+{
+    const uint8_t *sb = (const uint8_t *)src;
+    uint8_t *db       = (uint8_t *)dst;
+    const uint32_t *sl;
+    uint32_t *dl;
+    uint32_t w0, w1, w2, w3;
+    uint64_t sum = 0;
+    uint16_t t   = 0;
+    uint16_t h;
+    int n   = len;
+    int odd = ((mem_ptr_t)sb & 1);
+
+    if (n == 0) {
+        return 0;
+    }
+
+    /* Word copies are only possible when both buffers share the same alignment */
+    if ((((mem_ptr_t)sb ^ (mem_ptr_t)db) & 3) != 0) {
+        MEMCPY(dst, src, len);
+        return wm_lwip_chksum(dst, len);
+    }
+
+    if (odd) {
+        *db                = *sb;
+        ((uint8_t *)&t)[1] = *sb;
+        db++;
+        sb++;
+        n--;
+    }
+
+    if (((mem_ptr_t)sb & 2) && n >= 2) {
+        h                       = *(const uint16_t *)(const void *)sb;
+        *(uint16_t *)(void *)db = h;
+        sum += h;
+        sb += 2;
+        db += 2;
+        n -= 2;
+    }
+
+    sl = (const uint32_t *)(const void *)sb;
+    dl = (uint32_t *)(void *)db;
+    while (n >= 16) {
+        w0    = sl[0];
+        w1    = sl[1];
+        w2    = sl[2];
+        w3    = sl[3];
+        dl[0] = w0;
+        dl[1] = w1;
+        dl[2] = w2;
+        dl[3] = w3;
+        sum += w0;
+        sum += w1;
+        sum += w2;
+        sum += w3;
+        sl += 4;
+        dl += 4;
+        n -= 16;
+    }
+
+    while (n >= 4) {
+        w0    = *sl++;
+        *dl++ = w0;
+        sum += w0;
+        n -= 4;
+    }
+
+    sb = (const uint8_t *)sl;
+    db = (uint8_t *)dl;
+    if (n >= 2) {
+        h                       = *(const uint16_t *)(const void *)sb;
+        *(uint16_t *)(void *)db = h;
+        sum += h;
+        sb += 2;
+        db += 2;
+        n -= 2;
+    }
+
+    if (n > 0) {
+        *db                = *sb;
+        ((uint8_t *)&t)[0] = *sb;
+    }
+
+    sum += t;
+
+    return wm_lwip_chksum_fold(sum, odd);
+}
+#endif /* LWIP_CHECKSUM_ON_COPY */
+
+#endif /* CONFIG_LWIP_CHKSUM_OPTIMIZE */
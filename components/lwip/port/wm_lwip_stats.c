@@ -0,0 +1,350 @@
+/**
+ * @file wm_lwip_stats.c
+ *
+ * @brief LWIP Statistics Module
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "wmsdk_config.h"
+
+#include <string.h>
+#include "lwip/opt.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "lwip/timeouts.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "wm_error.h"
+#include "wm_osal.h"
+#include "wm_lwip_stats.h"
+
+#if LWIP_STATS
+
+typedef struct {
+    struct tcpip_api_call_data call; /**< Must be the first member */
+    wm_lwip_stats_t *stats;
+    wm_lwip_stats_pcb_t *pcbs;
+    uint16_t pcb_num;
+} wm_lwip_stats_call_t;
+
+typedef struct {
+    wm_lwip_stats_report_cb_t cb;
+    void *priv;
+    uint32_t period_ms;
+    uint32_t sequence;
+    uint8_t *buf;
+} wm_lwip_stats_report_t;
+
+static const char *const g_memp_names[] = {
+#define LWIP_MEMPOOL(name, num, size, desc) desc,
+#include "lwip/priv/memp_std.h"
+};
+
+/* the snapshot has a fixed layout, a pool list grown by the lwIP options must grow it as well */
+_Static_assert(MEMP_MAX <= WM_LWIP_STATS_MEMP_MAX, "WM_LWIP_STATS_MEMP_MAX is less than MEMP_MAX");
+
+static wm_lwip_stats_report_t g_stats_report = { 0 };
+
+static void wm_lwip_stats_copy_proto(wm_lwip_stats_proto_t *dst, const struct stats_proto *src)
+{
+    dst->xmit   = src->xmit;
+    dst->recv   = src->recv;
+    dst->drop   = src->drop;
+    dst->chkerr = src->chkerr;
+    dst->memerr = src->memerr;
+    dst->err    = src->lenerr + src->rterr + src->proterr + src->opterr + src->err;
+}
+
+static uint16_t wm_lwip_stats_seg_count(const struct tcp_seg *seg)
+{
+    uint16_t cnt = 0;
+
+    for (; seg != NULL; seg = seg->next) {
+        cnt++;
+    }
+
+    return cnt;
+}
+
+static void wm_lwip_stats_copy_pcb(wm_lwip_stats_pcb_t *dst, const struct tcp_pcb *pcb)
+{
+    memset(dst, 0, sizeof(*dst));
+
+#if LWIP_IPV4
+    if (IP_IS_V4_VAL(pcb->local_ip)) {
+        dst->local_ip  = ip4_addr_get_u32(ip_2_ip4(&pcb->local_ip));
+        dst->remote_ip = ip4_addr_get_u32(ip_2_ip4(&pcb->remote_ip));
+    }
+#endif
+    dst->local_port   = pcb->local_port;
+    dst->remote_port  = pcb->remote_port;
+    dst->state        = (uint8_t)pcb->state;
+    dst->nrtx         = pcb->nrtx;
+    dst->persist      = pcb->persist_backoff;
+    dst->snd_lbb      = pcb->snd_lbb;
+    dst->lastack      = pcb->lastack;
+    dst->rcv_nxt      = pcb->rcv_nxt;
+    dst->snd_wnd      = pcb->snd_wnd;
+    dst->rcv_wnd      = pcb->rcv_wnd;
+    dst->cwnd         = pcb->cwnd;
+    dst->snd_buf      = pcb->snd_buf;
+    dst->snd_queuelen = pcb->snd_queuelen;
+    dst->unsent       = wm_lwip_stats_seg_count(pcb->unsent);
+    dst->unacked      = wm_lwip_stats_seg_count(pcb->unacked);
+#if TCP_QUEUE_OOSEQ
+    dst->ooseq = wm_lwip_stats_seg_count(pcb->ooseq);
+#endif
+#if CONFIG_WM_LWIP
+    dst->rexmit     = pcb->wm_rexmit;
+    dst->wnd_stalls = pcb->wm_wnd_stalls;
+#endif
+}
+
+/* Must run in the TCPIP task */
+static uint16_t wm_lwip_stats_collect(wm_lwip_stats_t *stats, wm_lwip_stats_pcb_t *pcbs, uint16_t max_pcb)
+{
+    struct tcp_pcb *pcb;
+    uint16_t num = 0;
+    int i;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->timestamp_ms = wm_os_internal_get_time_ms();
+
+#if LINK_STATS
+    wm_lwip_stats_copy_proto(&stats->proto[WM_LWIP_STATS_PROTO_LINK], &lwip_stats.link);
+#endif
+#if ETHARP_STATS
+    wm_lwip_stats_copy_proto(&stats->proto[WM_LWIP_STATS_PROTO_ETHARP], &lwip_stats.etharp);
+#endif
+#if IP_STATS
+    wm_lwip_stats_copy_proto(&stats->proto[WM_LWIP_STATS_PROTO_IP], &lwip_stats.ip);
+#endif
+#if ICMP_STATS
+    wm_lwip_stats_copy_proto(&stats->proto[WM_LWIP_STATS_PROTO_ICMP], &lwip_stats.icmp);
+#endif
+#if UDP_STATS
+    wm_lwip_stats_copy_proto(&stats->proto[WM_LWIP_STATS_PROTO_UDP], &lwip_stats.udp);
+#endif
+#if TCP_STATS
+    wm_lwip_stats_copy_proto(&stats->proto[WM_LWIP_STATS_PROTO_TCP], &lwip_stats.tcp);
+#endif
+
+#if MIB2_STATS
+    stats->mib2_tcp.active_opens  = lwip_stats.mib2.tcpactiveopens;
+    stats->mib2_tcp.passive_opens = lwip_stats.mib2.tcppassiveopens;
+    stats->mib2_tcp.attempt_fails = lwip_stats.mib2.tcpattemptfails;
+    stats->mib2_tcp.estab_resets  = lwip_stats.mib2.tcpestabresets;
+    stats->mib2_tcp.in_segs       = lwip_stats.mib2.tcpinsegs;
+    stats->mib2_tcp.out_segs      = lwip_stats.mib2.tcpoutsegs;
+    stats->mib2_tcp.retrans_segs  = lwip_stats.mib2.tcpretranssegs;
+    stats->mib2_tcp.in_errs       = lwip_stats.mib2.tcpinerrs;
+    stats->mib2_tcp.out_rsts      = lwip_stats.mib2.tcpoutrsts;
+#endif
+
+#if MEM_STATS
+    stats->mem_used = lwip_stats.mem.used;
+    stats->mem_max  = lwip_stats.mem.max;
+    stats->mem_err  = lwip_stats.mem.err;
+#endif
+
+#if MEMP_STATS
+    for (i = 0; i < MEMP_MAX; i++) {
+        stats->memp[i].used = lwip_stats.memp[i]->used;
+        stats->memp[i].max  = lwip_stats.memp[i]->max;
+        stats->memp[i].err  = lwip_stats.memp[i]->err;
+    }
+    stats->memp_num = i;
+#else
+    (void)i;
+#endif
+
+#if LWIP_TCP
+    for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+        if (pcbs != NULL && num < max_pcb) {
+            wm_lwip_stats_copy_pcb(&pcbs[num++], pcb);
+        }
+        stats->pcb_num++;
+    }
+#else
+    (void)pcb;
+#endif
+
+    return num;
+}
+
+static err_t wm_lwip_stats_get_fn(struct tcpip_api_call_data *call)
+{
+    wm_lwip_stats_call_t *msg = (wm_lwip_stats_call_t *)call;
+
+    msg->pcb_num = wm_lwip_stats_collect(msg->stats, msg->pcbs, msg->pcb_num);
+
+    return ERR_OK;
+}
+
+int wm_lwip_stats_get(wm_lwip_stats_t *stats, wm_lwip_stats_pcb_t *pcbs, uint16_t *pcb_num)
+{
+    wm_lwip_stats_call_t msg = { 0 };
+
+    if (stats == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    msg.stats   = stats;
+    msg.pcbs    = pcbs;
+    msg.pcb_num = (pcbs != NULL && pcb_num != NULL) ? *pcb_num : 0;
+
+    if (tcpip_api_call(wm_lwip_stats_get_fn, &msg.call) != ERR_OK) {
+        return WM_ERR_FAILED;
+    }
+
+    if (pcb_num != NULL) {
+        *pcb_num = msg.pcb_num;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+const char *wm_lwip_stats_memp_name(int index)
+{
+    if (index < 0 || index >= (int)LWIP_ARRAYSIZE(g_memp_names)) {
+        return "?";
+    }
+
+    return g_memp_names[index];
+}
+
+static err_t wm_lwip_stats_reset_fn(struct tcpip_api_call_data *call)
+{
+    int i;
+
+    (void)call;
+
+#if MEM_STATS
+    lwip_stats.mem.max = lwip_stats.mem.used;
+    lwip_stats.mem.err = 0;
+#endif
+
+#if MEMP_STATS
+    for (i = 0; i < MEMP_MAX; i++) {
+        lwip_stats.memp[i]->max = lwip_stats.memp[i]->used;
+        lwip_stats.memp[i]->err = 0;
+    }
+#else
+    (void)i;
+#endif
+
+    return ERR_OK;
+}
+
+int wm_lwip_stats_reset(void)
+{
+    struct tcpip_api_call_data call = { 0 };
+
+    if (tcpip_api_call(wm_lwip_stats_reset_fn, &call) != ERR_OK) {
+        return WM_ERR_FAILED;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static void wm_lwip_stats_report_timeout(void *arg)
+{
+    wm_lwip_stats_report_t *report  = (wm_lwip_stats_report_t *)arg;
+    wm_lwip_stats_report_hdr_t *hdr = (wm_lwip_stats_report_hdr_t *)report->buf;
+    wm_lwip_stats_t *stats          = (wm_lwip_stats_t *)(hdr + 1);
+    wm_lwip_stats_pcb_t *pcbs       = (wm_lwip_stats_pcb_t *)(stats + 1);
+    uint16_t num;
+
+    num = wm_lwip_stats_collect(stats, pcbs, CONFIG_LWIP_STATS_MAX_PCB);
+
+    hdr->magic    = WM_LWIP_STATS_REPORT_MAGIC;
+    hdr->version  = WM_LWIP_STATS_REPORT_VERSION;
+    hdr->pcb_num  = num;
+    hdr->length   = sizeof(*hdr) + sizeof(*stats) + num * sizeof(*pcbs);
+    hdr->sequence = report->sequence++;
+
+    report->cb(report->buf, hdr->length, report->priv);
+
+    sys_timeout(report->period_ms, wm_lwip_stats_report_timeout, report);
+}
+
+static void wm_lwip_stats_report_start_fn(void *arg)
+{
+    sys_timeout(((wm_lwip_stats_report_t *)arg)->period_ms, wm_lwip_stats_report_timeout, arg);
+}
+
+static err_t wm_lwip_stats_report_stop_fn(struct tcpip_api_call_data *call)
+{
+    (void)call;
+
+    sys_untimeout(wm_lwip_stats_report_timeout, &g_stats_report);
+
+    return ERR_OK;
+}
+
+int wm_lwip_stats_report_start(uint32_t period_ms, wm_lwip_stats_report_cb_t cb, void *priv)
+{
+    if (period_ms == 0 || cb == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (g_stats_report.buf != NULL) {
+        return WM_ERR_ALREADY_INITED;
+    }
+
+    g_stats_report.buf = wm_os_internal_malloc(sizeof(wm_lwip_stats_report_hdr_t) + sizeof(wm_lwip_stats_t) +
+                                               CONFIG_LWIP_STATS_MAX_PCB * sizeof(wm_lwip_stats_pcb_t));
+    if (g_stats_report.buf == NULL) {
+        return WM_ERR_NO_MEM;
+    }
+
+    g_stats_report.cb        = cb;
+    g_stats_report.priv      = priv;
+    g_stats_report.period_ms = period_ms;
+    g_stats_report.sequence  = 0;
+
+    if (tcpip_callback(wm_lwip_stats_report_start_fn, &g_stats_report) != ERR_OK) {
+        wm_os_internal_free(g_stats_report.buf);
+        g_stats_report.buf = NULL;
+        return WM_ERR_FAILED;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_lwip_stats_report_stop(void)
+{
+    struct tcpip_api_call_data call = { 0 };
+
+    if (g_stats_report.buf == NULL) {
+        return WM_ERR_SUCCESS;
+    }
+
+    /* The timeout is removed in the TCPIP task, so no report is running when the buffer is freed */
+    tcpip_api_call(wm_lwip_stats_report_stop_fn, &call);
+
+    wm_os_internal_free(g_stats_report.buf);
+    memset(&g_stats_report, 0, sizeof(g_stats_report));
+
+    return WM_ERR_SUCCESS;
+}
+
+#endif /* LWIP_STATS */
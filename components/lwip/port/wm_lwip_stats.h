@@ -0,0 +1,290 @@
+/**
+ * @file wm_lwip_stats.h
+ *
+ * @brief LWIP Statistics Module
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_LWIP_STATS_H__
+#define __WM_LWIP_STATS_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup WM_LWIP_STATS_Macros WM LWIP_STATS Macros
+ * @brief WinnerMicro LWIP_STATS Macros
+ */
+
+/**
+ * @addtogroup WM_LWIP_STATS_Macros
+ * @{
+ */
+
+#define WM_LWIP_STATS_REPORT_MAGIC   (0x5453574C) /**< Report magic number, "LWST" in memory */
+#define WM_LWIP_STATS_REPORT_VERSION (1)          /**< Report format version */
+#define WM_LWIP_STATS_MEMP_MAX       (24)         /**< Maximum number of memory pools in a snapshot, at least MEMP_MAX */
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_LWIP_STATS_Enumerations WM LWIP_STATS Enumerations
+ * @brief WinnerMicro LWIP_STATS Enumerations
+ */
+
+/**
+ * @addtogroup WM_LWIP_STATS_Enumerations
+ * @{
+ */
+
+/**
+ * @brief Protocol layers of the protocol counters.
+ */
+typedef enum {
+    WM_LWIP_STATS_PROTO_LINK = 0, /**< Link layer */
+    WM_LWIP_STATS_PROTO_ETHARP,   /**< ARP */
+    WM_LWIP_STATS_PROTO_IP,       /**< IPv4 */
+    WM_LWIP_STATS_PROTO_ICMP,     /**< ICMP */
+    WM_LWIP_STATS_PROTO_UDP,      /**< UDP */
+    WM_LWIP_STATS_PROTO_TCP,      /**< TCP */
+    WM_LWIP_STATS_PROTO_MAX
+} wm_lwip_stats_proto_type_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_LWIP_STATS_Structures WM LWIP_STATS Structures
+ * @brief WinnerMicro LWIP_STATS Structures
+ */
+
+/**
+ * @addtogroup WM_LWIP_STATS_Structures
+ * @{
+ */
+
+/**
+ * @brief Counters of one protocol layer.
+ */
+typedef struct {
+    uint32_t xmit;   /**< Transmitted packets */
+    uint32_t recv;   /**< Received packets */
+    uint32_t drop;   /**< Dropped packets */
+    uint32_t chkerr; /**< Checksum errors */
+    uint32_t memerr; /**< Out of memory errors */
+    uint32_t err;    /**< Other errors */
+} wm_lwip_stats_proto_t;
+
+/**
+ * @brief MIB-II TCP counters.
+ */
+typedef struct {
+    uint32_t active_opens;  /**< Connections opened actively */
+    uint32_t passive_opens; /**< Connections accepted */
+    uint32_t attempt_fails; /**< Failed connection attempts */
+    uint32_t estab_resets;  /**< Established connections reset */
+    uint32_t in_segs;       /**< Segments received */
+    uint32_t out_segs;      /**< Segments sent */
+    uint32_t retrans_segs;  /**< Segments retransmitted */
+    uint32_t in_errs;       /**< Segments received in error */
+    uint32_t out_rsts;      /**< Segments sent with RST flag */
+} wm_lwip_stats_mib2_tcp_t;
+
+/**
+ * @brief Usage of one memory pool.
+ */
+typedef struct {
+    uint16_t used; /**< Elements currently allocated */
+    uint16_t max;  /**< High-water mark of allocated elements */
+    uint32_t err;  /**< Allocation failures */
+} wm_lwip_stats_memp_t;
+
+/**
+ * @brief Global counters snapshot.
+ */
+typedef struct {
+    uint32_t timestamp_ms;                               /**< System time of the snapshot in ms */
+    wm_lwip_stats_proto_t proto[WM_LWIP_STATS_PROTO_MAX]; /**< Protocol counters, @ref wm_lwip_stats_proto_type_t */
+    wm_lwip_stats_mib2_tcp_t mib2_tcp;                   /**< MIB-II TCP counters */
+    uint32_t mem_used;                                   /**< lwIP heap bytes in use */
+    uint32_t mem_max;                                    /**< lwIP heap high-water mark in bytes */
+    uint32_t mem_err;                                    /**< lwIP heap allocation failures */
+    uint16_t memp_num;                                   /**< Number of valid entries in memp */
+    uint16_t pcb_num;                                    /**< Number of active TCP connections */
+    wm_lwip_stats_memp_t memp[WM_LWIP_STATS_MEMP_MAX];   /**< Memory pool usage, see wm_lwip_stats_memp_name() */
+} wm_lwip_stats_t;
+
+/**
+ * @brief State of one TCP connection.
+ *
+ * The sequence numbers are raw, the throughput of a connection is the difference
+ * between two snapshots divided by the time between them.
+ */
+typedef struct {
+    uint32_t local_ip;      /**< Local IPv4 address in network order, 0 for IPv6 */
+    uint32_t remote_ip;     /**< Remote IPv4 address in network order, 0 for IPv6 */
+    uint16_t local_port;    /**< Local port */
+    uint16_t remote_port;   /**< Remote port */
+    uint8_t state;          /**< TCP state, enum tcp_state */
+    uint8_t nrtx;           /**< Retransmissions of the current segment */
+    uint8_t persist;        /**< Persist timer back-off, non zero while the peer window is closed */
+    uint8_t reserved;       /**< Reserved */
+    uint32_t snd_lbb;       /**< Next byte to be buffered for sending */
+    uint32_t lastack;       /**< Highest acknowledged sequence number */
+    uint32_t rcv_nxt;       /**< Next expected receive sequence number */
+    uint32_t snd_wnd;       /**< Peer receive window */
+    uint32_t rcv_wnd;       /**< Local receive window */
+    uint32_t cwnd;          /**< Congestion window */
+    uint32_t snd_buf;       /**< Free send buffer in bytes */
+    uint16_t snd_queuelen;  /**< pbufs queued for sending */
+    uint16_t unsent;        /**< Segments not sent yet */
+    uint16_t unacked;       /**< Segments sent and not acknowledged */
+    uint16_t ooseq;         /**< Out of sequence segments held */
+    uint32_t rexmit;        /**< Retransmission events since the connection opened */
+    uint32_t wnd_stalls;    /**< Times sending stopped on the peer window */
+} wm_lwip_stats_pcb_t;
+
+/**
+ * @brief Header of a periodic binary report.
+ *
+ * A report is this header followed by a @ref wm_lwip_stats_t and pcb_num
+ * @ref wm_lwip_stats_pcb_t records, all in CPU byte order (little endian).
+ */
+typedef struct {
+    uint32_t magic;    /**< WM_LWIP_STATS_REPORT_MAGIC */
+    uint16_t version;  /**< WM_LWIP_STATS_REPORT_VERSION */
+    uint16_t pcb_num;  /**< Number of connection records that follow */
+    uint32_t length;   /**< Total report length in bytes, including this header */
+    uint32_t sequence; /**< Report sequence number */
+} wm_lwip_stats_report_hdr_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_LWIP_STATS_Type_Definitions WM LWIP_STATS Type Definitions
+ * @brief WinnerMicro LWIP_STATS Type Definitions
+ */
+
+/**
+ * @addtogroup WM_LWIP_STATS_Type_Definitions
+ * @{
+ */
+
+/**
+ * @brief Periodic report callback.
+ *
+ * Called in the TCPIP task, it must not block. Copy the data or hand it to
+ * another task, it is only valid during the call.
+ *
+ * @param[in] data Report, begins with @ref wm_lwip_stats_report_hdr_t
+ * @param[in] len Report length in bytes
+ * @param[in] priv User data passed to wm_lwip_stats_report_start()
+ *
+ * @return None
+ */
+typedef void (*wm_lwip_stats_report_cb_t)(const uint8_t *data, uint32_t len, void *priv);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_LWIP_STATS_Functions WM LWIP_STATS Functions
+ * @brief WinnerMicro LWIP_STATS Functions
+ */
+
+/**
+ * @addtogroup WM_LWIP_STATS_Functions
+ * @{
+ */
+
+/**
+ * @brief Take a snapshot of the lwIP counters and TCP connections.
+ *
+ * @param[out] stats Global counters
+ * @param[out] pcbs Array receiving the TCP connections, may be NULL
+ * @param[in,out] pcb_num Size of pcbs on input, number of records written on output, may be NULL
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_FAILED: the TCPIP task did not run the request
+ *
+ * @note stats->pcb_num is the number of active connections, it may be larger than *pcb_num.
+ */
+int wm_lwip_stats_get(wm_lwip_stats_t *stats, wm_lwip_stats_pcb_t *pcbs, uint16_t *pcb_num);
+
+/**
+ * @brief Get the name of a memory pool in @ref wm_lwip_stats_t.
+ *
+ * @param[in] index Index in wm_lwip_stats_t::memp
+ *
+ * @return Pool name, "?" if index is out of range
+ */
+const char *wm_lwip_stats_memp_name(int index);
+
+/**
+ * @brief Reset the high-water marks and error counters.
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_FAILED: the TCPIP task did not run the request
+ */
+int wm_lwip_stats_reset(void);
+
+/**
+ * @brief Start the periodic binary report.
+ *
+ * @param[in] period_ms Report period in ms
+ * @param[in] cb Callback receiving each report
+ * @param[in] priv User data passed to cb
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_ALREADY_INITED: report already started
+ *    - WM_ERR_NO_MEM: no memory for the report buffer
+ */
+int wm_lwip_stats_report_start(uint32_t period_ms, wm_lwip_stats_report_cb_t cb, void *priv);
+
+/**
+ * @brief Stop the periodic binary report.
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ */
+int wm_lwip_stats_report_stop(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_LWIP_STATS_H__ */
@@ -0,0 +1,169 @@
+/**
+ * @file wm_lwip_tcp_wnd.c
+ *
+ * @brief Adaptive TCP receive window and send buffer sizing
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "wmsdk_config.h"
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "wm_heap.h"
+
+#if CONFIG_LWIP_TCP_ADAPTIVE_WND && LWIP_TCP
+
+/*
+ * TCP_WND and TCP_SND_BUF are the upper limits. Every second the heap that is
+ * free, plus the heap the connections already hold in their buffers, less a
+ * reserve, is shared between the active connections. Each connection gets its
+ * share split in the ratio TCP_WND : TCP_SND_BUF, rounded down to whole MSS and
+ * never below the configured minimum.
+ *
+ * The limits keep the lwIP accounting intact: rcv_wnd and snd_buf are what is
+ * left of their limit, so a limit only moves by as much as rcv_wnd or snd_buf
+ * can follow. rcv_wnd never shrinks below the right edge already announced to
+ * the peer (rcv_ann_right_edge), the rest of a shrinking limit is applied on
+ * later ticks as the peer's data arrives and the announced edge is reached.
+ */
+
+#if CONFIG_LWIP_TCP_WND_MIN > CONFIG_LWIP_TCP_WND_DEFAULT
+#error "LWIP_TCP_WND_MIN must not be larger than LWIP_TCP_WND_DEFAULT"
+#endif
+
+#if CONFIG_LWIP_TCP_SND_BUF_MIN > CONFIG_LWIP_TCP_SND_BUF_DEFAULT
+#error "LWIP_TCP_SND_BUF_MIN must not be larger than LWIP_TCP_SND_BUF_DEFAULT"
+#endif
+
+#define WM_LWIP_TCP_WND_MIN      (CONFIG_LWIP_TCP_WND_MIN * TCP_MSS)
+#define WM_LWIP_TCP_SND_BUF_MIN  (CONFIG_LWIP_TCP_SND_BUF_MIN * TCP_MSS)
+#define WM_LWIP_TCP_HEAP_RESERVE (CONFIG_LWIP_TCP_ADAPTIVE_HEAP_RESERVE * 1024)
+#define WM_LWIP_TCP_ADAPT_TICKS  (1000 / TCP_SLOW_INTERVAL)
+
+static u8_t g_tcp_adapt_ticks = 0;
+
+static tcpwnd_size_t wm_lwip_tcp_wnd_scale(u32_t share, u32_t max, u32_t min)
+{
+    u32_t size = (u32_t)(((u64_t)share * max) / (TCP_WND + TCP_SND_BUF));
+
+    if (size > max) {
+        size = max;
+    }
+    size -= size % TCP_MSS;
+
+    return (tcpwnd_size_t)LWIP_MAX(size, min);
+}
+
+/* Heap each connection may use for its buffers, extra is the number of connections about to be added */
+static u32_t wm_lwip_tcp_wnd_share(u32_t extra)
+{
+    struct tcp_pcb *pcb;
+    u32_t avail = (u32_t)wm_heap_get_free_size();
+    u32_t num   = extra;
+
+    for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+        /* Data the application has not read yet and data not acknowledged yet */
+        avail += (u32_t)(pcb->wm_rcv_wnd_max - pcb->rcv_wnd) + (u32_t)(pcb->wm_snd_buf_max - pcb->snd_buf);
+        num++;
+    }
+
+    if (num == 0 || avail <= WM_LWIP_TCP_HEAP_RESERVE) {
+        return 0;
+    }
+
+    return (avail - WM_LWIP_TCP_HEAP_RESERVE) / num;
+}
+
+static void wm_lwip_tcp_wnd_apply(struct tcp_pcb *pcb, u32_t share)
+{
+    tcpwnd_size_t wnd = wm_lwip_tcp_wnd_scale(share, TCP_WND, WM_LWIP_TCP_WND_MIN);
+    tcpwnd_size_t snd = wm_lwip_tcp_wnd_scale(share, TCP_SND_BUF, WM_LWIP_TCP_SND_BUF_MIN);
+    tcpwnd_size_t delta;
+    u32_t ann;
+
+    if (wnd > pcb->wm_rcv_wnd_max) {
+        delta = wnd - pcb->wm_rcv_wnd_max;
+        pcb->wm_rcv_wnd_max += delta;
+        pcb->rcv_wnd += delta;
+
+        /* Let the peer know about a significantly larger window, as tcp_recved() does */
+        if (tcp_update_rcv_ann_wnd(pcb) >= TCP_WND_UPDATE_THRESHOLD) {
+            tcp_ack_now(pcb);
+            tcp_output(pcb);
+        }
+    } else if (wnd < pcb->wm_rcv_wnd_max) {
+        /* Only the part of rcv_wnd beyond the announced right edge may be taken away */
+        ann = TCP_SEQ_GT(pcb->rcv_ann_right_edge, pcb->rcv_nxt) ? pcb->rcv_ann_right_edge - pcb->rcv_nxt : 0;
+        if (pcb->rcv_wnd > ann) {
+            delta = LWIP_MIN(pcb->wm_rcv_wnd_max - wnd, pcb->rcv_wnd - ann);
+            pcb->wm_rcv_wnd_max -= delta;
+            pcb->rcv_wnd -= delta;
+        }
+    }
+
+    if (snd > pcb->wm_snd_buf_max) {
+        delta = snd - pcb->wm_snd_buf_max;
+        pcb->wm_snd_buf_max += delta;
+        pcb->snd_buf += delta;
+    } else if (snd < pcb->wm_snd_buf_max) {
+        delta = LWIP_MIN(pcb->wm_snd_buf_max - snd, pcb->snd_buf);
+        pcb->wm_snd_buf_max -= delta;
+        pcb->snd_buf -= delta;
+    }
+}
+
+void wm_lwip_tcp_wnd_init(struct tcp_pcb *pcb)
+{
+    u32_t share = wm_lwip_tcp_wnd_share(1);
+
+    pcb->wm_rcv_wnd_max = wm_lwip_tcp_wnd_scale(share, TCP_WND, WM_LWIP_TCP_WND_MIN);
+    pcb->wm_snd_buf_max = wm_lwip_tcp_wnd_scale(share, TCP_SND_BUF, WM_LWIP_TCP_SND_BUF_MIN);
+
+    /* Start with a window that does not need scaling, as tcp_alloc() does */
+    pcb->rcv_wnd = pcb->rcv_ann_wnd = TCPWND_MIN16(pcb->wm_rcv_wnd_max);
+    pcb->snd_buf                    = pcb->wm_snd_buf_max;
+}
+
+void wm_lwip_tcp_wnd_adapt(void)
+{
+    struct tcp_pcb *pcb;
+    u32_t share;
+
+    if (++g_tcp_adapt_ticks < WM_LWIP_TCP_ADAPT_TICKS) {
+        return;
+    }
+    g_tcp_adapt_ticks = 0;
+
+    if (tcp_active_pcbs == NULL) {
+        return;
+    }
+
+    share = wm_lwip_tcp_wnd_share(0);
+
+    for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+        /* Connections still opening keep their initial size, closing ones are left alone */
+        if (pcb->state == ESTABLISHED || pcb->state == CLOSE_WAIT) {
+            wm_lwip_tcp_wnd_apply(pcb, share);
+        }
+    }
+}
+
+#endif /* CONFIG_LWIP_TCP_ADAPTIVE_WND && LWIP_TCP */
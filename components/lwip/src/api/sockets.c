@@ -1404,7 +1404,11 @@ lwip_send(int s, const void *data, size_t size, int flags)
 #endif /* (LWIP_UDP || LWIP_RAW) */
   }
 
+#if CONFIG_WM_LWIP
+  write_flags = (u8_t)(((flags & MSG_NOCOPY)   ? 0                 : NETCONN_COPY) |
+#else /* CONFIG_WM_LWIP */
   write_flags = (u8_t)(NETCONN_COPY |
+#endif /* CONFIG_WM_LWIP */
                        ((flags & MSG_MORE)     ? NETCONN_MORE      : 0) |
                        ((flags & MSG_DONTWAIT) ? NETCONN_DONTBLOCK : 0));
   written = 0;
@@ -738,8 +738,13 @@ void dhcp_cleanup(struct netif *netif)
  * - ERR_OK - No error
  * - ERR_MEM - Out of memory
  */
+#if CONFIG_WM_LWIP
+static err_t
+dhcp_start_addr(struct netif *netif, const ip4_addr_t *reboot_addr)
+#else
 err_t
 dhcp_start(struct netif *netif)
+#endif
 {
   struct dhcp *dhcp;
   err_t result;
@@ -789,6 +794,25 @@ dhcp_start(struct netif *netif)
   }
   dhcp->pcb_allocated = 1;
 
+#if CONFIG_WM_LWIP
+  if (reboot_addr != NULL && !ip4_addr_isany(reboot_addr)) {
+    /* verify the previous lease with INIT-REBOOT, dhcp_timeout() falls back to discover */
+    ip4_addr_copy(dhcp->offered_ip_addr, *reboot_addr);
+    if (!netif_is_link_up(netif)) {
+      /* set state REBOOTING and wait for dhcp_network_changed() to call dhcp_reboot() */
+      dhcp_set_state(dhcp, DHCP_STATE_REBOOTING);
+      return ERR_OK;
+    }
+    result = dhcp_reboot(netif);
+    if (result != ERR_OK) {
+      /* free resources allocated above */
+      dhcp_release_and_stop(netif);
+      return ERR_MEM;
+    }
+    return result;
+  }
+#endif
+
   if (!netif_is_link_up(netif)) {
     /* set state INIT and wait for dhcp_network_changed() to call dhcp_discover() */
     dhcp_set_state(dhcp, DHCP_STATE_INIT);
@@ -805,6 +829,33 @@ dhcp_start(struct netif *netif)
   return result;
 }
 
+#if CONFIG_WM_LWIP
+err_t
+dhcp_start(struct netif *netif)
+{
+  return dhcp_start_addr(netif, NULL);
+}
+
+/**
+ * @ingroup dhcp4
+ * Start DHCP negotiation by requesting a previously leased address
+ * (INIT-REBOOT, RFC 2131 section 3.2). The server confirms the address with
+ * a single ACK. Without an answer the client falls back to a full discover,
+ * a NAK restarts the negotiation from INIT.
+ *
+ * @param netif The lwIP network interface
+ * @param addr The previously leased address
+ * @return lwIP error code
+ * - ERR_OK - No error
+ * - ERR_MEM - Out of memory
+ */
+err_t
+dhcp_start_reboot(struct netif *netif, const ip4_addr_t *addr)
+{
+  return dhcp_start_addr(netif, addr);
+}
+#endif /* CONFIG_WM_LWIP */
+
 /**
  * @ingroup dhcp4
  * Inform a DHCP server of our manual configuration.
@@ -1150,7 +1150,12 @@ tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port,
   pcb->snd_lbb = iss - 1;
   /* Start with a window that does not need scaling. When window scaling is
      enabled and used, the window is enlarged when both sides agree on scaling. */
+#if CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND
+  /* Size the buffers for the heap available now rather than when the pcb was allocated */
+  wm_lwip_tcp_wnd_init(pcb);
+#else
   pcb->rcv_wnd = pcb->rcv_ann_wnd = TCPWND_MIN16(TCP_WND);
+#endif /* CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND */
   pcb->rcv_ann_right_edge = pcb->rcv_nxt;
   pcb->snd_wnd = TCP_WND;
   /* As initial send MSS, we use TCP_MSS but limit it to 536.
@@ -1203,6 +1208,10 @@ tcp_slowtmr(void)
   ++tcp_ticks;
   ++tcp_timer_ctr;
 
+#if CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND
+  wm_lwip_tcp_wnd_adapt();
+#endif /* CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND */
+
 tcp_slowtmr_start:
   /* Steps through all of the active PCBs. */
   prev = NULL;
@@ -1894,6 +1903,9 @@ tcp_alloc(u8_t prio)
     /* Start with a window that does not need scaling. When window scaling is
        enabled and used, the window is enlarged when both sides agree on scaling. */
     pcb->rcv_wnd = pcb->rcv_ann_wnd = TCPWND_MIN16(TCP_WND);
+#if CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND
+    wm_lwip_tcp_wnd_init(pcb);
+#endif /* CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND */
     pcb->ttl = TCP_TTL;
     /* As initial send MSS, we use TCP_MSS but limit it to 536.
        The send MSS is updated when an MSS option is received. */
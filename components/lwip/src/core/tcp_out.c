@@ -1314,6 +1314,9 @@ tcp_output(struct tcp_pcb *pcb)
       pcb->persist_cnt = 0;
       pcb->persist_backoff = 1;
       pcb->persist_probe = 0;
+#if CONFIG_WM_LWIP && LWIP_STATS
+      pcb->wm_wnd_stalls++;
+#endif /* CONFIG_WM_LWIP && LWIP_STATS */
     }
     /* We need an ACK, but can't send data now, so send an empty ACK */
     if (pcb->flags & TF_ACK_NOW) {
@@ -1692,6 +1695,9 @@ tcp_rexmit_rto_commit(struct tcp_pcb *pcb)
   if (pcb->nrtx < 0xFF) {
     ++pcb->nrtx;
   }
+#if CONFIG_WM_LWIP && LWIP_STATS
+  pcb->wm_rexmit++;
+#endif /* CONFIG_WM_LWIP && LWIP_STATS */
   /* Do the actual retransmission */
   tcp_output(pcb);
 }
@@ -1766,6 +1772,9 @@ tcp_rexmit(struct tcp_pcb *pcb)
 
   /* Don't take any rtt measurements after retransmitting. */
   pcb->rttest = 0;
+#if CONFIG_WM_LWIP && LWIP_STATS
+  pcb->wm_rexmit++;
+#endif /* CONFIG_WM_LWIP && LWIP_STATS */
 
   /* Do the actual retransmission. */
   MIB2_STATS_INC(mib2.tcpretranssegs);
@@ -86,6 +86,10 @@ void             tcp_rexmit_rto_commit(struct tcp_pcb *pcb);
 void             tcp_rexmit_rto  (struct tcp_pcb *pcb);
 void             tcp_rexmit_fast (struct tcp_pcb *pcb);
 u32_t            tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb);
+#if CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND
+void             wm_lwip_tcp_wnd_init(struct tcp_pcb *pcb);
+void             wm_lwip_tcp_wnd_adapt(void);
+#endif /* CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND */
 err_t            tcp_process_refused_data(struct tcp_pcb *pcb);
 
 /**
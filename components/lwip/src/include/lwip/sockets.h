@@ -265,6 +265,9 @@ struct linger {
 #define MSG_DONTWAIT   0x08    /* Nonblocking i/o for this operation only */
 #define MSG_MORE       0x10    /* Sender will send more */
 #define MSG_NOSIGNAL   0x20    /* Uninmplemented: Requests not to send the SIGPIPE signal if an attempt to send is made on a stream-oriented socket that is no longer connected. */
+#if CONFIG_WM_LWIP
+#define MSG_NOCOPY     0x40    /* TCP only: reference the data instead of copying it, it must stay valid and unchanged until the connection is closed */
+#endif /* CONFIG_WM_LWIP */
 
 
 /*
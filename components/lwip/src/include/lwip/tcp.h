@@ -133,16 +133,22 @@ typedef void  (*tcp_err_fn)(void *arg, err_t err);
  */
 typedef err_t (*tcp_connected_fn)(void *arg, struct tcp_pcb *tpcb, err_t err);
 
+#if CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND
+/* The receive window limit is chosen per connection by wm_lwip_tcp_wnd */
+#define TCP_WND_LIMIT(pcb)      ((pcb)->wm_rcv_wnd_max)
+#else
+#define TCP_WND_LIMIT(pcb)      TCP_WND
+#endif /* CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND */
 #if LWIP_WND_SCALE
 #define RCV_WND_SCALE(pcb, wnd) (((wnd) >> (pcb)->rcv_scale))
 #define SND_WND_SCALE(pcb, wnd) (((wnd) << (pcb)->snd_scale))
 #define TCPWND16(x)             ((u16_t)LWIP_MIN((x), 0xFFFF))
-#define TCP_WND_MAX(pcb)        ((tcpwnd_size_t)(((pcb)->flags & TF_WND_SCALE) ? TCP_WND : TCPWND16(TCP_WND)))
+#define TCP_WND_MAX(pcb)        ((tcpwnd_size_t)(((pcb)->flags & TF_WND_SCALE) ? TCP_WND_LIMIT(pcb) : TCPWND16(TCP_WND_LIMIT(pcb))))
 #else
 #define RCV_WND_SCALE(pcb, wnd) (wnd)
 #define SND_WND_SCALE(pcb, wnd) (wnd)
 #define TCPWND16(x)             (x)
-#define TCP_WND_MAX(pcb)        TCP_WND
+#define TCP_WND_MAX(pcb)        TCP_WND_LIMIT(pcb)
 #endif
 /* Increments a tcpwnd_size_t and holds at max value rather than rollover */
 #define TCP_WND_INC(wnd, inc)   do { \
@@ -386,6 +392,18 @@ struct tcp_pcb {
   u8_t snd_scale;
   u8_t rcv_scale;
 #endif
+
+#if CONFIG_WM_LWIP && LWIP_STATS
+  /* Per connection counters, sampled by wm_lwip_stats */
+  u32_t wm_rexmit;     /* Number of retransmission events */
+  u32_t wm_wnd_stalls; /* Number of times sending stopped on the peer window */
+#endif /* CONFIG_WM_LWIP && LWIP_STATS */
+
+#if CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND
+  /* Limits chosen by wm_lwip_tcp_wnd from the free heap */
+  tcpwnd_size_t wm_rcv_wnd_max; /* Receive window limit, rcv_wnd never grows beyond it */
+  tcpwnd_size_t wm_snd_buf_max; /* Send buffer limit, snd_buf is what is left of it */
+#endif /* CONFIG_WM_LWIP && CONFIG_LWIP_TCP_ADAPTIVE_WND */
 };
 
 #if LWIP_EVENT_API
@@ -0,0 +1,166 @@
+#include "wmsdk_config.h"
+
+#include "test_chksum.h"
+
+#include "lwip/def.h"
+#include "lwip/inet_chksum.h"
+
+#include <string.h>
+
+#define CHKSUM_MAX_LEN      1600
+#define CHKSUM_FOLD_LEN     8192
+#define CHKSUM_GUARD_SIZE   4
+#define MAGIC_UNTOUCHED_BYTE 0x7a
+
+static u8_t chksum_src[CHKSUM_FOLD_LEN + 8];
+static u8_t chksum_dst[CHKSUM_MAX_LEN + 8 + 2 * CHKSUM_GUARD_SIZE];
+
+/* Setups/teardown functions */
+
+static void
+chksum_setup(void)
+{
+  size_t i;
+
+  srand(1);
+  for (i = 0; i < sizeof(chksum_src); i++) {
+    chksum_src[i] = (u8_t)rand();
+  }
+}
+
+static void
+chksum_teardown(void)
+{
+}
+
+/* RFC 1071: sum of big endian 16-bit words, an odd last byte is padded with zero,
+   returned like LWIP_CHKSUM as the sum of the words read in host order */
+static u16_t
+chksum_reference(const u8_t *data, int len)
+{
+  u32_t sum = 0;
+  int i;
+
+  for (i = 0; i + 1 < len; i += 2) {
+    sum += (u32_t)(data[i] << 8 | data[i + 1]);
+  }
+  if (len & 1) {
+    sum += (u32_t)data[len - 1] << 8;
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return lwip_htons((u16_t)sum);
+}
+
+#if CONFIG_LWIP_CHKSUM_OPTIMIZE
+
+/* every length up to a full frame at every alignment, odd starts and odd lengths included */
+START_TEST(test_chksum_lengths)
+{
+  int offset, len;
+  LWIP_UNUSED_ARG(_i);
+
+  for (offset = 0; offset < 4; offset++) {
+    for (len = 0; len <= CHKSUM_MAX_LEN; len++) {
+      u16_t expected = chksum_reference(chksum_src + offset, len);
+      u16_t sum = wm_lwip_chksum(chksum_src + offset, len);
+      fail_unless(sum == expected, "offset %d len %d: 0x%04x, expected 0x%04x", offset, len, sum, expected);
+    }
+  }
+  fail_unless(wm_lwip_chksum(chksum_src, -1) == 0);
+}
+END_TEST
+
+/* all ones words carry out of every add, the carries must fold back in */
+START_TEST(test_chksum_fold)
+{
+  int offset, len;
+  LWIP_UNUSED_ARG(_i);
+
+  memset(chksum_src, 0xff, sizeof(chksum_src));
+  for (offset = 0; offset < 4; offset++) {
+    for (len = CHKSUM_FOLD_LEN - 3; len <= CHKSUM_FOLD_LEN; len++) {
+      fail_unless(wm_lwip_chksum(chksum_src + offset, len) == chksum_reference(chksum_src + offset, len));
+    }
+  }
+
+  /* 0xff00 words add up to carries only in the upper byte */
+  for (len = 0; len < CHKSUM_FOLD_LEN; len++) {
+    chksum_src[len] = (len & 1) ? 0x00 : 0xff;
+  }
+  for (offset = 0; offset < 4; offset++) {
+    len = CHKSUM_FOLD_LEN - offset;
+    fail_unless(wm_lwip_chksum(chksum_src + offset, len) == chksum_reference(chksum_src + offset, len));
+  }
+}
+END_TEST
+
+#if LWIP_CHECKSUM_ON_COPY
+/* same and different alignments of the source and the destination, the bytes around are untouched */
+START_TEST(test_chksum_copy)
+{
+  int src_off, dst_off, len;
+  size_t i;
+  LWIP_UNUSED_ARG(_i);
+
+  for (src_off = 0; src_off < 4; src_off++) {
+    for (dst_off = 0; dst_off < 4; dst_off++) {
+      for (len = 0; len <= 300; len++) {
+        u8_t *dst = chksum_dst + CHKSUM_GUARD_SIZE + dst_off;
+        u16_t sum;
+
+        memset(chksum_dst, MAGIC_UNTOUCHED_BYTE, sizeof(chksum_dst));
+        sum = wm_lwip_chksum_copy(dst, chksum_src + src_off, (u16_t)len);
+        fail_unless(sum == chksum_reference(chksum_src + src_off, len),
+                    "src %d dst %d len %d", src_off, dst_off, len);
+        fail_unless(!memcmp(dst, chksum_src + src_off, len));
+        for (i = 0; i < (size_t)(CHKSUM_GUARD_SIZE + dst_off); i++) {
+          fail_unless(chksum_dst[i] == MAGIC_UNTOUCHED_BYTE);
+        }
+        for (i = CHKSUM_GUARD_SIZE + dst_off + len; i < sizeof(chksum_dst); i++) {
+          fail_unless(chksum_dst[i] == MAGIC_UNTOUCHED_BYTE);
+        }
+      }
+    }
+  }
+
+  /* a full frame, through the unrolled loop */
+  fail_unless(wm_lwip_chksum_copy(chksum_dst, chksum_src, CHKSUM_MAX_LEN) == chksum_reference(chksum_src, CHKSUM_MAX_LEN));
+  fail_unless(!memcmp(chksum_dst, chksum_src, CHKSUM_MAX_LEN));
+}
+END_TEST
+#endif /* LWIP_CHECKSUM_ON_COPY */
+
+#endif /* CONFIG_LWIP_CHKSUM_OPTIMIZE */
+
+/* the stack checksum gives the same result whichever routine is configured */
+START_TEST(test_chksum_inet)
+{
+  int offset, len;
+  LWIP_UNUSED_ARG(_i);
+
+  for (offset = 0; offset < 2; offset++) {
+    for (len = 0; len <= 64; len++) {
+      fail_unless(inet_chksum(chksum_src + offset, (u16_t)len) == (u16_t)~chksum_reference(chksum_src + offset, len));
+    }
+  }
+}
+END_TEST
+
+/** Create the suite including all tests for this module */
+Suite *
+chksum_suite(void)
+{
+  testfunc tests[] = {
+#if CONFIG_LWIP_CHKSUM_OPTIMIZE
+    TESTFUNC(test_chksum_lengths),
+    TESTFUNC(test_chksum_fold),
+#if LWIP_CHECKSUM_ON_COPY
+    TESTFUNC(test_chksum_copy),
+#endif
+#endif
+    TESTFUNC(test_chksum_inet)
+  };
+  return create_suite("CHKSUM", tests, sizeof(tests)/sizeof(testfunc), chksum_setup, chksum_teardown);
+}
@@ -8,6 +8,7 @@
 #include "tcp/test_tcp.h"
 #include "tcp/test_tcp_oos.h"
 #include "core/test_def.h"
+#include "core/test_chksum.h"
 #include "core/test_mem.h"
 #include "core/test_netif.h"
 #include "core/test_pbuf.h"
@@ -89,6 +90,9 @@ int main(void)
 #endif
 #if CONFIG_UNIT_TEST_LWIP_DEF
     def_suite,
+#endif
+#if CONFIG_UNIT_TEST_LWIP_CHKSUM
+    chksum_suite,
 #endif
     //mem_suite,
 #if CONFIG_UNIT_TEST_LWIP_NETIF
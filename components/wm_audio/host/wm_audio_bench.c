@@ -0,0 +1,161 @@
+/**
+ * @file wm_audio_bench.c
+ *
+ * @brief Audio Pipeline Host Benchmark
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "wm_error.h"
+#include "wm_audio_pipeline.h"
+#include "wm_audio_stage.h"
+
+#define BENCH_MUSIC_FILE "music.wav"
+#define BENCH_VOICE_FILE "voice.wav"
+#define BENCH_OUT_FILE   "mix.pcm"
+
+#define BENCH_BUF_SIZE   1920 /* 10 ms of 48 kHz 16 bits stereo */
+
+static int bench_write_wav(const char *path, uint32_t rate, uint8_t channels, double freq, uint32_t seconds)
+{
+    uint32_t frames = rate * seconds;
+    uint32_t bytes  = frames * channels * 2;
+    uint8_t head[44];
+    int16_t sample;
+    uint32_t i, ch;
+    FILE *fp;
+
+    if (!(fp = fopen(path, "wb"))) {
+        return WM_ERR_FAILED;
+    }
+
+#define PUT16(p, v) ((p)[0] = (uint8_t)(v), (p)[1] = (uint8_t)((v) >> 8))
+#define PUT32(p, v) (PUT16(p, (v) & 0xFFFF), PUT16((p) + 2, (v) >> 16))
+    memcpy(head, "RIFF", 4);
+    PUT32(head + 4, 36 + bytes);
+    memcpy(head + 8, "WAVEfmt ", 8);
+    PUT32(head + 16, 16);
+    PUT16(head + 20, 1);
+    PUT16(head + 22, channels);
+    PUT32(head + 24, rate);
+    PUT32(head + 28, rate * channels * 2);
+    PUT16(head + 32, channels * 2);
+    PUT16(head + 34, 16);
+    memcpy(head + 36, "data", 4);
+    PUT32(head + 40, bytes);
+    fwrite(head, 1, sizeof(head), fp);
+
+    for (i = 0; i < frames; i++) {
+        sample = (int16_t)(20000 * sin(2 * M_PI * freq * i / rate));
+        for (ch = 0; ch < channels; ch++) {
+            fwrite(&sample, 2, 1, fp);
+        }
+    }
+
+    fclose(fp);
+
+    return WM_ERR_SUCCESS;
+}
+
+static void bench_print_stats(wm_audio_stage_t *stage, double audio_s)
+{
+    wm_audio_stage_stats_t stats;
+
+    wm_audio_stage_get_stats(stage, &stats);
+
+    printf("%-10s %6u %10llu %10llu %8.2f%% %10llu", stage->name, (unsigned)stats.buf_num,
+           (unsigned long long)stats.bytes, (unsigned long long)stats.process_us, stats.process_us / (audio_s * 1e4),
+           (unsigned long long)stats.wait_us);
+    if (!stage->has_out && stats.buf_num) {
+        printf(" %10llu %10u", (unsigned long long)(stats.latency_us_sum / stats.buf_num), (unsigned)stats.latency_us_max);
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t seconds                  = argc > 1 ? (uint32_t)atoi(argv[1]) : 10;
+    wm_audio_format_t out_fmt         = { .sample_rate = 48000, .channels = 2, .bits = 16 };
+    wm_audio_pipeline_cfg_t cfg       = { .buf_size   = BENCH_BUF_SIZE,
+                                          .buf_num    = 16,
+                                          .link_depth = 2,
+                                          .task_stack = 4096,
+                                          .task_prio  = 10 };
+    wm_audio_stage_t *stages[6]       = { NULL };
+    wm_audio_pipeline_t *pipeline     = NULL;
+    uint32_t expect                   = 48000 * 2 * 2 * seconds;
+    long size                         = 0;
+    int err                           = WM_ERR_SUCCESS;
+    FILE *fp                          = NULL;
+    int i;
+
+    if (!seconds || bench_write_wav(BENCH_MUSIC_FILE, 48000, 2, 1000, seconds) ||
+        bench_write_wav(BENCH_VOICE_FILE, 16000, 1, 440, seconds)) {
+        fprintf(stderr, "create test files err\n");
+        return 1;
+    }
+
+    /* music 48 kHz stereo -> volume -> mixer, voice 16 kHz mono -> resample -> mixer, mixer -> file */
+    pipeline  = wm_audio_pipeline_create(&cfg);
+    stages[0] = wm_audio_file_source_create(BENCH_MUSIC_FILE, NULL);
+    stages[1] = wm_audio_volume_create(WM_AUDIO_GAIN_UNITY / 2);
+    stages[2] = wm_audio_file_source_create(BENCH_VOICE_FILE, NULL);
+    stages[3] = wm_audio_resample_create(&out_fmt);
+    stages[4] = wm_audio_mixer_create(NULL);
+    stages[5] = wm_audio_file_sink_create(BENCH_OUT_FILE);
+
+    if (!pipeline || wm_audio_pipeline_link(pipeline, stages[0], stages[1]) ||
+        wm_audio_pipeline_link(pipeline, stages[1], stages[4]) || wm_audio_pipeline_link(pipeline, stages[2], stages[3]) ||
+        wm_audio_pipeline_link(pipeline, stages[3], stages[4]) || wm_audio_pipeline_link(pipeline, stages[4], stages[5])) {
+        fprintf(stderr, "create pipeline err\n");
+        return 1;
+    }
+
+    if ((err = wm_audio_pipeline_start(pipeline)) == WM_ERR_SUCCESS) {
+        err = wm_audio_pipeline_wait(pipeline, WM_AUDIO_WAIT_FOREVER);
+    }
+    wm_audio_pipeline_stop(pipeline);
+
+    printf("%u s of audio, %u bytes buffers, %u buffers, link depth %u\n", (unsigned)seconds, BENCH_BUF_SIZE,
+           (unsigned)cfg.buf_num, (unsigned)cfg.link_depth);
+    printf("%-10s %6s %10s %10s %9s %10s %10s %10s\n", "stage", "bufs", "bytes", "cpu_us", "cpu", "wait_us", "lat_avg_us",
+           "lat_max_us");
+    for (i = 0; i < 6; i++) {
+        bench_print_stats(stages[i], seconds);
+    }
+    printf("free buffers %u of %u\n", (unsigned)wm_audio_pool_get_free_num(wm_audio_pipeline_get_pool(pipeline)),
+           (unsigned)cfg.buf_num);
+
+    wm_audio_pipeline_destroy(pipeline);
+
+    if ((fp = fopen(BENCH_OUT_FILE, "rb"))) {
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fclose(fp);
+    }
+
+    printf("output %ld bytes, expect %u: %s\n", size, (unsigned)expect,
+           err == WM_ERR_SUCCESS && size == (long)expect ? "PASS" : "FAIL");
+
+    return err == WM_ERR_SUCCESS && size == (long)expect ? 0 : 1;
+}
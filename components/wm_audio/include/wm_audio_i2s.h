@@ -0,0 +1,75 @@
+/**
+ * @file wm_audio_i2s.h
+ *
+ * @brief Audio Pipeline I2S Stages
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_AUDIO_I2S_H__
+#define __WM_AUDIO_I2S_H__
+
+#include "wm_dt.h"
+#include "wm_audio_pipeline.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup WM_AUDIO_APIs
+ * @{
+ */
+
+/**
+ * @brief Create a source receiving from I2S, pool buffers are appended to the DMA receive list and
+ *        forwarded without a copy.
+ *
+ * @param[in] i2s_dev I2S device, initialized with wm_drv_i2s_init and set to the format fmt
+ * @param[in] fmt format of the received data
+ * @param[in] pkt_num buffers kept in the DMA receive list, the rx_pkt_num of the I2S device
+ * @return
+ *    - stage: succeed
+ *    - NULL: failed
+ * @note The rx_pkt_size of the I2S device must be the buffer size of the pipeline.
+ *       The received data can not wait, it is lost when the pool runs out of buffers, or when pkt_num
+ *       received buffers already wait for the pipeline, and counted in overrun.
+ */
+wm_audio_stage_t *wm_audio_i2s_source_create(wm_device_t *i2s_dev, const wm_audio_format_t *fmt, uint8_t pkt_num);
+
+/**
+ * @brief Create a sink sending to I2S, buffers are appended to the DMA send list and given back to the pool
+ *        from the send done callback.
+ *
+ * @param[in] i2s_dev I2S device, initialized with wm_drv_i2s_init and set to the input format
+ * @return
+ *    - stage: succeed
+ *    - NULL: failed
+ * @note At the end of the stream the sink waits until the last buffer is sent.
+ */
+wm_audio_stage_t *wm_audio_i2s_sink_create(wm_device_t *i2s_dev);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_AUDIO_I2S_H__ */
@@ -0,0 +1,363 @@
+/**
+ * @file wm_audio_pipeline.h
+ *
+ * @brief Audio Pipeline Module
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_AUDIO_PIPELINE_H__
+#define __WM_AUDIO_PIPELINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup WM_AUDIO_MACROs WM AUDIO MACROs
+ * @brief WinnerMicro AUDIO MACROs
+ */
+
+/**
+ * @addtogroup WM_AUDIO_MACROs
+ * @{
+ */
+
+#define WM_AUDIO_STAGE_IN_MAX 4           /**< max inputs of one stage, e.g. mixer inputs  */
+#define WM_AUDIO_GAIN_UNITY   4096        /**< gain of 1.0, gains are Q12 fixed point       */
+#define WM_AUDIO_WAIT_FOREVER 0xFFFFFFFFU /**< timeout value to wait without limit          */
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_AUDIO_TYPEs WM AUDIO TYPEs
+ * @brief WinnerMicro AUDIO TYPEs
+ */
+
+/**
+ * @addtogroup WM_AUDIO_TYPEs
+ * @{
+ */
+
+typedef struct wm_audio_pool_s wm_audio_pool_t;
+typedef struct wm_audio_stage_s wm_audio_stage_t;
+typedef struct wm_audio_pipeline_s wm_audio_pipeline_t;
+struct wm_audio_link_s;
+
+/**
+ * @brief PCM format, samples are interleaved, the built in processors work on 16 bits samples
+ */
+typedef struct {
+    uint32_t sample_rate; /**< sample rate in Hz     */
+    uint8_t channels;     /**< 1: mono, 2: stereo    */
+    uint8_t bits;         /**< bits of one sample    */
+} wm_audio_format_t;
+
+/**
+ * @brief buffer of the pool, passed between stages by reference
+ */
+typedef struct wm_audio_buf_s {
+    struct wm_audio_buf_s *next; /**< internal, free list link                                   */
+    wm_audio_pool_t *pool;       /**< pool the buffer belongs to                                  */
+    uint8_t *data;               /**< 4 bytes aligned, size is the pool buffer size, DMA capable */
+    uint32_t len;                /**< valid bytes in data                                         */
+    uint32_t ts;                 /**< time the data entered the pipeline, in us                   */
+    bool eos;                    /**< last buffer of the stream                                   */
+} wm_audio_buf_t;
+
+/**
+ * @brief stage statistics
+ */
+typedef struct {
+    uint32_t buf_num;        /**< buffers produced, or consumed for a sink                     */
+    uint64_t bytes;          /**< bytes produced, or consumed for a sink                       */
+    uint64_t process_us;     /**< time spent processing, without waiting for free buffers      */
+    uint64_t wait_us;        /**< time spent waiting for free buffers of the pool              */
+    uint64_t latency_us_sum; /**< sink only, sum of the time from the source to the sink       */
+    uint32_t latency_us_max; /**< sink only, max time from the source to the sink              */
+    uint32_t overrun;        /**< real time sources, buffers of data lost                      */
+} wm_audio_stage_stats_t;
+
+/**
+ * @brief stage operations, all called in the task of the stage except open and close
+ */
+typedef struct {
+    /**
+     * called by wm_audio_pipeline_start, in_fmt is set from the linked stages, the stage sets out_fmt
+     */
+    int (*open)(wm_audio_stage_t *stage);
+
+    /**
+     * called once every input which has not ended holds a buffer, in[] is NULL for a source.
+     * The stage sets in[i] to NULL once it is done with the buffer, after freeing or forwarding it,
+     * a buffer left in in[i] is passed again on the next call.
+     * out is set to the produced buffer, or left NULL, for a sink it is NULL.
+     * Return WM_ERR_EOS from a source once the stream is over.
+     */
+    int (*process)(wm_audio_stage_t *stage, wm_audio_buf_t *in[], wm_audio_buf_t **out);
+
+    /**
+     * called by wm_audio_pipeline_stop once the task of the stage has exited
+     */
+    void (*close)(wm_audio_stage_t *stage);
+} wm_audio_stage_ops_t;
+
+/**
+ * @brief stage, the first fields are for the stage implementation, the others are internal
+ */
+struct wm_audio_stage_s {
+    const char *name;                                /**< name for logs and statistics       */
+    const wm_audio_stage_ops_t *ops;                 /**< stage operations                   */
+    void *priv;                                      /**< stage private data                 */
+    uint8_t in_max;                                  /**< inputs accepted, 0 for a source    */
+    bool has_out;                                    /**< false for a sink                   */
+    wm_audio_format_t in_fmt[WM_AUDIO_STAGE_IN_MAX]; /**< input formats, set before open     */
+    wm_audio_format_t out_fmt;                       /**< output format, set by open         */
+    wm_audio_pool_t *pool;                           /**< buffer pool, set before open       */
+    wm_audio_stage_stats_t stats;                    /**< statistics                         */
+
+    wm_audio_pipeline_t *pipeline;
+    wm_audio_stage_t *pipeline_next;
+    wm_audio_stage_t *in_stage[WM_AUDIO_STAGE_IN_MAX];
+    struct wm_audio_link_s *in_link[WM_AUDIO_STAGE_IN_MAX];
+    wm_audio_buf_t *in_buf[WM_AUDIO_STAGE_IN_MAX];
+    bool in_done[WM_AUDIO_STAGE_IN_MAX];
+    uint8_t in_num;
+    wm_audio_stage_t *out_stage;
+    uint8_t out_port;
+    bool out_eos;
+    bool opened;
+};
+
+/**
+ * @brief pipeline configuration
+ */
+typedef struct {
+    uint32_t buf_size;   /**< bytes of one pool buffer, 4 bytes aligned, e.g. 10 ms of audio     */
+    uint16_t buf_num;    /**< buffers in the pool, shared by all the stages                     */
+    uint8_t link_depth;  /**< buffers queued between two stages before the upstream one waits */
+    uint32_t task_stack; /**< stack size of the stage tasks                                     */
+    uint8_t task_prio;   /**< priority of the stage tasks                                       */
+} wm_audio_pipeline_cfg_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_AUDIO_APIs WM AUDIO APIs
+ * @brief WinnerMicro AUDIO APIs
+ */
+
+/**
+ * @addtogroup WM_AUDIO_APIs
+ * @{
+ */
+
+/**
+ * @brief Create a pool of fixed size buffers.
+ *
+ * @param[in] buf_size bytes of one buffer, rounded up to 4 bytes
+ * @param[in] buf_num buffer count
+ * @return
+ *    - pool: succeed
+ *    - NULL: failed
+ */
+wm_audio_pool_t *wm_audio_pool_create(uint32_t buf_size, uint16_t buf_num);
+
+/**
+ * @brief Delete a pool, all its buffers must be free.
+ *
+ * @param[in] pool pool to delete
+ */
+void wm_audio_pool_delete(wm_audio_pool_t *pool);
+
+/**
+ * @brief Get the buffer size of a pool.
+ *
+ * @param[in] pool pool
+ * @return
+ *    - bytes of one buffer
+ */
+uint32_t wm_audio_pool_get_buf_size(wm_audio_pool_t *pool);
+
+/**
+ * @brief Get the count of free buffers of a pool.
+ *
+ * @param[in] pool pool
+ * @return
+ *    - free buffer count
+ */
+uint16_t wm_audio_pool_get_free_num(wm_audio_pool_t *pool);
+
+/**
+ * @brief Allocate a buffer, len is 0 and eos is false.
+ *
+ * @param[in] pool pool
+ * @param[in] timeout_ms time to wait for a free buffer, 0 to return at once, WM_AUDIO_WAIT_FOREVER
+ * @return
+ *    - buffer: succeed
+ *    - NULL: no free buffer in time
+ */
+wm_audio_buf_t *wm_audio_buf_alloc(wm_audio_pool_t *pool, uint32_t timeout_ms);
+
+/**
+ * @brief Give a buffer back to its pool, can be called in interrupt context.
+ *
+ * @param[in] buf buffer
+ */
+void wm_audio_buf_free(wm_audio_buf_t *buf);
+
+/**
+ * @brief Find the buffer holding a data pointer, e.g. a pointer given back by a DMA done callback.
+ *
+ * @param[in] pool pool
+ * @param[in] data data pointer of a buffer
+ * @return
+ *    - buffer: succeed
+ *    - NULL: data is not in the pool
+ */
+wm_audio_buf_t *wm_audio_pool_find(wm_audio_pool_t *pool, const void *data);
+
+/**
+ * @brief Create a stage, for the built in stages and user stages.
+ *
+ * @param[in] name stage name, must stay valid
+ * @param[in] ops stage operations, must stay valid
+ * @param[in] in_max inputs accepted, 0 for a source, up to WM_AUDIO_STAGE_IN_MAX
+ * @param[in] has_out false for a sink
+ * @param[in] priv_size bytes of zeroed private data allocated with the stage, set to priv
+ * @return
+ *    - stage: succeed
+ *    - NULL: failed
+ */
+wm_audio_stage_t *wm_audio_stage_create(const char *name, const wm_audio_stage_ops_t *ops, uint8_t in_max, bool has_out,
+                                        uint32_t priv_size);
+
+/**
+ * @brief Delete a stage which is not linked into a pipeline, linked stages are deleted by wm_audio_pipeline_destroy.
+ *
+ * @param[in] stage stage
+ */
+void wm_audio_stage_delete(wm_audio_stage_t *stage);
+
+/**
+ * @brief Allocate an output buffer in process, wait until one is free, this is the back-pressure of the pool.
+ *
+ * @param[in] stage stage
+ * @return
+ *    - buffer: succeed
+ *    - NULL: the pipeline is stopping, return from process
+ */
+wm_audio_buf_t *wm_audio_stage_buf_alloc(wm_audio_stage_t *stage);
+
+/**
+ * @brief Get the statistics of a stage.
+ *
+ * @param[in] stage stage
+ * @param[out] stats statistics
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ */
+int wm_audio_stage_get_stats(wm_audio_stage_t *stage, wm_audio_stage_stats_t *stats);
+
+/**
+ * @brief Create a pipeline and its buffer pool.
+ *
+ * @param[in] cfg pipeline configuration
+ * @return
+ *    - pipeline: succeed
+ *    - NULL: failed
+ */
+wm_audio_pipeline_t *wm_audio_pipeline_create(const wm_audio_pipeline_cfg_t *cfg);
+
+/**
+ * @brief Link the output of a stage to the next input of another one, both stages join the pipeline.
+ *
+ * @param[in] pipeline pipeline
+ * @param[in] from upstream stage
+ * @param[in] to downstream stage
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ */
+int wm_audio_pipeline_link(wm_audio_pipeline_t *pipeline, wm_audio_stage_t *from, wm_audio_stage_t *to);
+
+/**
+ * @brief Open the stages from the sources down, then start a task for each stage.
+ *
+ * @param[in] pipeline pipeline
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ */
+int wm_audio_pipeline_start(wm_audio_pipeline_t *pipeline);
+
+/**
+ * @brief Wait until every sink got the end of stream.
+ *
+ * @param[in] pipeline pipeline
+ * @param[in] timeout_ms time to wait, WM_AUDIO_WAIT_FOREVER
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_TIMEOUT: the stream is not over
+ *    - others: failed
+ */
+int wm_audio_pipeline_wait(wm_audio_pipeline_t *pipeline, uint32_t timeout_ms);
+
+/**
+ * @brief Stop the stage tasks, free the queued buffers and close the stages.
+ *
+ * @param[in] pipeline pipeline
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ */
+int wm_audio_pipeline_stop(wm_audio_pipeline_t *pipeline);
+
+/**
+ * @brief Stop the pipeline if needed, delete its stages and free it.
+ *
+ * @param[in] pipeline pipeline
+ */
+void wm_audio_pipeline_destroy(wm_audio_pipeline_t *pipeline);
+
+/**
+ * @brief Get the buffer pool of a pipeline.
+ *
+ * @param[in] pipeline pipeline
+ * @return
+ *    - pool
+ */
+wm_audio_pool_t *wm_audio_pipeline_get_pool(wm_audio_pipeline_t *pipeline);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_AUDIO_PIPELINE_H__ */
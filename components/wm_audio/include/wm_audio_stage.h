@@ -0,0 +1,122 @@
+/**
+ * @file wm_audio_stage.h
+ *
+ * @brief Audio Pipeline Built In Stages
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_AUDIO_STAGE_H__
+#define __WM_AUDIO_STAGE_H__
+
+#include "wm_audio_pipeline.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup WM_AUDIO_APIs
+ * @{
+ */
+
+/**
+ * @brief Create a source reading a WAV file, or a raw PCM file of the given format.
+ *
+ * @param[in] path file path
+ * @param[in] fmt format of a raw PCM file, NULL for a WAV file
+ * @return
+ *    - stage: succeed
+ *    - NULL: failed
+ */
+wm_audio_stage_t *wm_audio_file_source_create(const char *path, const wm_audio_format_t *fmt);
+
+/**
+ * @brief Create a sink writing raw PCM to a file.
+ *
+ * @param[in] path file path
+ * @return
+ *    - stage: succeed
+ *    - NULL: failed
+ */
+wm_audio_stage_t *wm_audio_file_sink_create(const char *path);
+
+/**
+ * @brief Create a sample rate and channel count converter of 16 bits PCM, by linear interpolation.
+ *        Input already in the output format is forwarded without a copy.
+ *
+ * @param[in] fmt output format, a 0 sample_rate or channels keeps the one of the input
+ * @return
+ *    - stage: succeed
+ *    - NULL: failed
+ */
+wm_audio_stage_t *wm_audio_resample_create(const wm_audio_format_t *fmt);
+
+/**
+ * @brief Create a mixer of up to WM_AUDIO_STAGE_IN_MAX inputs of the same 16 bits PCM format, with saturation.
+ *        An input which ended is left out of the mix, the mixer ends with the last input.
+ *
+ * @param[in] gains Q12 gain of each input, NULL for WM_AUDIO_GAIN_UNITY
+ * @return
+ *    - stage: succeed
+ *    - NULL: failed
+ */
+wm_audio_stage_t *wm_audio_mixer_create(const uint16_t gains[WM_AUDIO_STAGE_IN_MAX]);
+
+/**
+ * @brief Set the gain of a mixer input, takes effect from the next buffer.
+ *
+ * @param[in] stage mixer
+ * @param[in] port input index, in link order
+ * @param[in] gain Q12 gain
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ */
+int wm_audio_mixer_set_gain(wm_audio_stage_t *stage, uint8_t port, uint16_t gain);
+
+/**
+ * @brief Create a volume control of 16 bits PCM, buffers are scaled in place.
+ *
+ * @param[in] gain Q12 gain
+ * @return
+ *    - stage: succeed
+ *    - NULL: failed
+ */
+wm_audio_stage_t *wm_audio_volume_create(uint16_t gain);
+
+/**
+ * @brief Set the gain of a volume control, takes effect from the next buffer.
+ *
+ * @param[in] stage volume control
+ * @param[in] gain Q12 gain
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - others: failed
+ */
+int wm_audio_volume_set(wm_audio_stage_t *stage, uint16_t gain);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_AUDIO_STAGE_H__ */
@@ -0,0 +1,600 @@
+/**
+ * @file wm_audio_pipeline.c
+ *
+ * @brief Audio Pipeline Module
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define LOG_TAG "audio"
+#include "wm_audio_port.h"
+#include "wm_audio_pipeline.h"
+
+#define WM_AUDIO_STAGE_PRIV_ALIGN 8
+
+/* bounded queue of buffers between two stages, a full link makes the upstream stage wait */
+typedef struct wm_audio_link_s {
+    wm_audio_buf_t **ring;
+    wm_audio_port_sem_t *items;
+    wm_audio_port_sem_t *slots;
+    uint8_t depth;
+    uint8_t head;
+    uint8_t tail;
+} wm_audio_link_t;
+
+struct wm_audio_pipeline_s {
+    wm_audio_pipeline_cfg_t cfg;
+    wm_audio_pool_t *pool;
+    wm_audio_stage_t *stages;
+    wm_audio_port_sem_t *done_sem; /**< given by each sink at the end of stream, or on error */
+    wm_audio_port_sem_t *exit_sem; /**< given by each stage task on exit                    */
+    uint8_t task_num;
+    uint8_t sink_num;
+    uint8_t sink_done;
+    volatile bool running;
+    bool started;
+    volatile int err;
+};
+
+static wm_audio_link_t *wm_audio_link_create(uint8_t depth)
+{
+    wm_audio_link_t *link = WM_AUDIO_CALLOC(1, sizeof(wm_audio_link_t));
+
+    if (!link) {
+        return NULL;
+    }
+
+    link->depth = depth;
+    link->ring  = WM_AUDIO_CALLOC(depth, sizeof(wm_audio_buf_t *));
+    if (!link->ring) {
+        WM_AUDIO_FREE(link);
+        return NULL;
+    }
+
+    if (wm_audio_port_sem_create(&link->items, 0) != WM_ERR_SUCCESS) {
+        WM_AUDIO_FREE(link->ring);
+        WM_AUDIO_FREE(link);
+        return NULL;
+    }
+
+    if (wm_audio_port_sem_create(&link->slots, depth) != WM_ERR_SUCCESS) {
+        wm_audio_port_sem_delete(link->items);
+        WM_AUDIO_FREE(link->ring);
+        WM_AUDIO_FREE(link);
+        return NULL;
+    }
+
+    return link;
+}
+
+static int wm_audio_link_push(wm_audio_link_t *link, wm_audio_buf_t *buf, uint32_t timeout_ms)
+{
+    if (wm_audio_port_sem_take(link->slots, timeout_ms) != WM_ERR_SUCCESS) {
+        return WM_ERR_TIMEOUT;
+    }
+
+    wm_audio_port_enter_critical();
+    link->ring[link->tail] = buf;
+    link->tail             = (link->tail + 1) % link->depth;
+    wm_audio_port_exit_critical();
+
+    wm_audio_port_sem_give(link->items);
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_link_pop(wm_audio_link_t *link, wm_audio_buf_t **buf, uint32_t timeout_ms)
+{
+    if (wm_audio_port_sem_take(link->items, timeout_ms) != WM_ERR_SUCCESS) {
+        return WM_ERR_TIMEOUT;
+    }
+
+    wm_audio_port_enter_critical();
+    *buf       = link->ring[link->head];
+    link->head = (link->head + 1) % link->depth;
+    wm_audio_port_exit_critical();
+
+    wm_audio_port_sem_give(link->slots);
+
+    return WM_ERR_SUCCESS;
+}
+
+static void wm_audio_link_flush(wm_audio_link_t *link)
+{
+    wm_audio_buf_t *buf = NULL;
+
+    while (wm_audio_link_pop(link, &buf, 0) == WM_ERR_SUCCESS) {
+        wm_audio_buf_free(buf);
+    }
+}
+
+static void wm_audio_link_delete(wm_audio_link_t *link)
+{
+    wm_audio_link_flush(link);
+    wm_audio_port_sem_delete(link->items);
+    wm_audio_port_sem_delete(link->slots);
+    WM_AUDIO_FREE(link->ring);
+    WM_AUDIO_FREE(link);
+}
+
+wm_audio_stage_t *wm_audio_stage_create(const char *name, const wm_audio_stage_ops_t *ops, uint8_t in_max, bool has_out,
+                                        uint32_t priv_size)
+{
+    uint32_t head_size      = (sizeof(wm_audio_stage_t) + WM_AUDIO_STAGE_PRIV_ALIGN - 1) & ~(WM_AUDIO_STAGE_PRIV_ALIGN - 1);
+    wm_audio_stage_t *stage = NULL;
+
+    if (!ops || !ops->process || in_max > WM_AUDIO_STAGE_IN_MAX || (!in_max && !has_out)) {
+        return NULL;
+    }
+
+    stage = WM_AUDIO_CALLOC(1, head_size + priv_size);
+    if (!stage) {
+        return NULL;
+    }
+
+    stage->name    = name;
+    stage->ops     = ops;
+    stage->priv    = priv_size ? (uint8_t *)stage + head_size : NULL;
+    stage->in_max  = in_max;
+    stage->has_out = has_out;
+
+    return stage;
+}
+
+void wm_audio_stage_delete(wm_audio_stage_t *stage)
+{
+    if (stage && !stage->pipeline) {
+        WM_AUDIO_FREE(stage);
+    }
+}
+
+wm_audio_buf_t *wm_audio_stage_buf_alloc(wm_audio_stage_t *stage)
+{
+    uint32_t start      = wm_audio_port_time_us();
+    wm_audio_buf_t *buf = NULL;
+
+    while (!(buf = wm_audio_buf_alloc(stage->pool, WM_AUDIO_POLL_MS)) && stage->pipeline->running) {
+    }
+    stage->stats.wait_us += (uint32_t)(wm_audio_port_time_us() - start);
+
+    return buf;
+}
+
+int wm_audio_stage_get_stats(wm_audio_stage_t *stage, wm_audio_stage_stats_t *stats)
+{
+    if (!stage || !stats) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    *stats = stage->stats;
+
+    return WM_ERR_SUCCESS;
+}
+
+/* get a buffer on every input which has not ended, return false if one is still missing */
+static bool wm_audio_stage_fetch(wm_audio_stage_t *stage)
+{
+    bool ready = true;
+    uint32_t latency;
+    uint8_t i;
+
+    for (i = 0; i < stage->in_num; i++) {
+        if (stage->in_buf[i] || stage->in_done[i]) {
+            continue;
+        }
+
+        if (wm_audio_link_pop(stage->in_link[i], &stage->in_buf[i], WM_AUDIO_POLL_MS) != WM_ERR_SUCCESS) {
+            ready = false;
+            continue;
+        }
+
+        if (!stage->has_out && stage->in_buf[i]->len) {
+            latency = wm_audio_port_time_us() - stage->in_buf[i]->ts;
+            stage->stats.buf_num++;
+            stage->stats.bytes += stage->in_buf[i]->len;
+            stage->stats.latency_us_sum += latency;
+            if (latency > stage->stats.latency_us_max) {
+                stage->stats.latency_us_max = latency;
+            }
+        }
+    }
+
+    return ready;
+}
+
+/* return false if the pipeline stopped before the downstream stage took the buffer */
+static bool wm_audio_stage_push(wm_audio_stage_t *stage, wm_audio_buf_t *buf)
+{
+    wm_audio_link_t *link = stage->out_stage->in_link[stage->out_port];
+
+    while (wm_audio_link_push(link, buf, WM_AUDIO_POLL_MS) != WM_ERR_SUCCESS) {
+        if (!stage->pipeline->running) {
+            wm_audio_buf_free(buf);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool wm_audio_stage_in_ended(wm_audio_stage_t *stage)
+{
+    uint8_t i;
+
+    for (i = 0; i < stage->in_num; i++) {
+        if (!stage->in_done[i]) {
+            return false;
+        }
+    }
+
+    return stage->in_num > 0;
+}
+
+static void wm_audio_stage_task(void *arg)
+{
+    wm_audio_stage_t *stage       = (wm_audio_stage_t *)arg;
+    wm_audio_pipeline_t *pipeline = stage->pipeline;
+    wm_audio_buf_t *out           = NULL;
+    bool eos[WM_AUDIO_STAGE_IN_MAX];
+    bool ended       = false;
+    int err          = WM_ERR_SUCCESS;
+    uint64_t wait_us = 0;
+    uint32_t start   = 0;
+    uint8_t i;
+
+    while (pipeline->running && !ended) {
+        if (!wm_audio_stage_fetch(stage)) {
+            continue;
+        }
+
+        for (i = 0; i < stage->in_num; i++) {
+            eos[i] = stage->in_buf[i] && stage->in_buf[i]->eos;
+        }
+
+        out     = NULL;
+        wait_us = stage->stats.wait_us;
+        start   = wm_audio_port_time_us();
+        err     = stage->ops->process(stage, stage->in_num ? stage->in_buf : NULL, &out);
+        stage->stats.process_us += (uint32_t)(wm_audio_port_time_us() - start) - (stage->stats.wait_us - wait_us);
+
+        for (i = 0; i < stage->in_num; i++) {
+            if (eos[i] && !stage->in_buf[i]) {
+                stage->in_done[i] = true;
+            }
+        }
+
+        if (out) {
+            stage->stats.buf_num++;
+            stage->stats.bytes += out->len;
+            stage->out_eos = out->eos;
+            if (!wm_audio_stage_push(stage, out)) {
+                break;
+            }
+        }
+
+        if (err == WM_ERR_EOS) {
+            ended = true;
+        } else if (err != WM_ERR_SUCCESS) {
+            WM_AUDIO_LOGE("stage %s err %d", stage->name, err);
+            pipeline->err = err;
+            for (i = 0; i < pipeline->sink_num; i++) {
+                wm_audio_port_sem_give(pipeline->done_sem);
+            }
+            break;
+        } else {
+            ended = stage->out_eos || wm_audio_stage_in_ended(stage);
+        }
+    }
+
+    if (ended) {
+        if (!stage->has_out) {
+            wm_audio_port_sem_give(pipeline->done_sem);
+        } else if (!stage->out_eos && (out = wm_audio_stage_buf_alloc(stage))) {
+            /* the stage ended without marking its last buffer */
+            out->eos = true;
+            wm_audio_stage_push(stage, out);
+        }
+    }
+
+    wm_audio_port_sem_give(pipeline->exit_sem);
+    wm_audio_port_task_exit();
+}
+
+static void wm_audio_pipeline_add(wm_audio_pipeline_t *pipeline, wm_audio_stage_t *stage)
+{
+    if (!stage->pipeline) {
+        stage->pipeline      = pipeline;
+        stage->pipeline_next = pipeline->stages;
+        pipeline->stages     = stage;
+    }
+}
+
+wm_audio_pipeline_t *wm_audio_pipeline_create(const wm_audio_pipeline_cfg_t *cfg)
+{
+    wm_audio_pipeline_t *pipeline = NULL;
+
+    if (!cfg || !cfg->buf_size || !cfg->buf_num || !cfg->link_depth) {
+        return NULL;
+    }
+
+    pipeline = WM_AUDIO_CALLOC(1, sizeof(wm_audio_pipeline_t));
+    if (!pipeline) {
+        return NULL;
+    }
+    pipeline->cfg = *cfg;
+
+    pipeline->pool = wm_audio_pool_create(cfg->buf_size, cfg->buf_num);
+    if (!pipeline->pool) {
+        WM_AUDIO_FREE(pipeline);
+        return NULL;
+    }
+
+    if (wm_audio_port_sem_create(&pipeline->done_sem, 0) != WM_ERR_SUCCESS) {
+        wm_audio_pool_delete(pipeline->pool);
+        WM_AUDIO_FREE(pipeline);
+        return NULL;
+    }
+
+    if (wm_audio_port_sem_create(&pipeline->exit_sem, 0) != WM_ERR_SUCCESS) {
+        wm_audio_port_sem_delete(pipeline->done_sem);
+        wm_audio_pool_delete(pipeline->pool);
+        WM_AUDIO_FREE(pipeline);
+        return NULL;
+    }
+
+    return pipeline;
+}
+
+int wm_audio_pipeline_link(wm_audio_pipeline_t *pipeline, wm_audio_stage_t *from, wm_audio_stage_t *to)
+{
+    wm_audio_link_t *link = NULL;
+
+    if (!pipeline || !from || !to || from == to || pipeline->started) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (!from->has_out || from->out_stage || to->in_num >= to->in_max || (from->pipeline && from->pipeline != pipeline) ||
+        (to->pipeline && to->pipeline != pipeline)) {
+        WM_AUDIO_LOGE("link %s to %s err", from->name, to->name);
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    link = wm_audio_link_create(pipeline->cfg.link_depth);
+    if (!link) {
+        return WM_ERR_NO_MEM;
+    }
+
+    to->in_link[to->in_num]  = link;
+    to->in_stage[to->in_num] = from;
+    from->out_stage          = to;
+    from->out_port           = to->in_num;
+    to->in_num++;
+
+    wm_audio_pipeline_add(pipeline, from);
+    wm_audio_pipeline_add(pipeline, to);
+
+    return WM_ERR_SUCCESS;
+}
+
+/* open a stage once every upstream stage is open, so the input formats are known */
+static int wm_audio_pipeline_open(wm_audio_pipeline_t *pipeline)
+{
+    wm_audio_stage_t *stage = NULL;
+    bool progress           = true;
+    int err                 = WM_ERR_SUCCESS;
+    uint8_t i;
+
+    while (progress) {
+        progress = false;
+
+        for (stage = pipeline->stages; stage; stage = stage->pipeline_next) {
+            if (stage->opened) {
+                continue;
+            }
+
+            for (i = 0; i < stage->in_num && stage->in_stage[i]->opened; i++) {
+            }
+            if (i < stage->in_num) {
+                continue;
+            }
+
+            for (i = 0; i < stage->in_num; i++) {
+                stage->in_fmt[i] = stage->in_stage[i]->out_fmt;
+            }
+            if (stage->in_num) {
+                stage->out_fmt = stage->in_fmt[0];
+            }
+            stage->pool = pipeline->pool;
+
+            if (stage->ops->open && (err = stage->ops->open(stage)) != WM_ERR_SUCCESS) {
+                WM_AUDIO_LOGE("stage %s open err %d", stage->name, err);
+                return err;
+            }
+            stage->opened = true;
+            progress      = true;
+        }
+    }
+
+    for (stage = pipeline->stages; stage; stage = stage->pipeline_next) {
+        if (!stage->opened) {
+            WM_AUDIO_LOGE("stage %s in a loop", stage->name);
+            return WM_ERR_INVALID_PARAM;
+        }
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static void wm_audio_pipeline_close(wm_audio_pipeline_t *pipeline)
+{
+    wm_audio_stage_t *stage = NULL;
+    uint8_t i;
+
+    for (stage = pipeline->stages; stage; stage = stage->pipeline_next) {
+        for (i = 0; i < stage->in_num; i++) {
+            if (stage->in_buf[i]) {
+                wm_audio_buf_free(stage->in_buf[i]);
+                stage->in_buf[i] = NULL;
+            }
+            wm_audio_link_flush(stage->in_link[i]);
+        }
+    }
+
+    for (stage = pipeline->stages; stage; stage = stage->pipeline_next) {
+        if (stage->opened && stage->ops->close) {
+            stage->ops->close(stage);
+        }
+        stage->opened = false;
+    }
+}
+
+int wm_audio_pipeline_start(wm_audio_pipeline_t *pipeline)
+{
+    wm_audio_stage_t *stage = NULL;
+    int err                 = WM_ERR_SUCCESS;
+
+    if (!pipeline || !pipeline->stages) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (pipeline->started) {
+        return WM_ERR_BUSY;
+    }
+
+    pipeline->sink_num  = 0;
+    pipeline->sink_done = 0;
+    pipeline->task_num  = 0;
+    pipeline->err       = WM_ERR_SUCCESS;
+    while (wm_audio_port_sem_take(pipeline->done_sem, 0) == WM_ERR_SUCCESS) {
+    }
+
+    for (stage = pipeline->stages; stage; stage = stage->pipeline_next) {
+        if ((stage->in_max && !stage->in_num) || (stage->has_out && !stage->out_stage)) {
+            WM_AUDIO_LOGE("stage %s not linked", stage->name);
+            return WM_ERR_INVALID_PARAM;
+        }
+
+        memset(&stage->stats, 0, sizeof(stage->stats));
+        memset(stage->in_done, 0, sizeof(stage->in_done));
+        stage->out_eos = false;
+        if (!stage->has_out) {
+            pipeline->sink_num++;
+        }
+    }
+
+    pipeline->started = true;
+
+    if ((err = wm_audio_pipeline_open(pipeline)) != WM_ERR_SUCCESS) {
+        wm_audio_pipeline_close(pipeline);
+        pipeline->started = false;
+        return err;
+    }
+
+    pipeline->running = true;
+    for (stage = pipeline->stages; stage; stage = stage->pipeline_next) {
+        if ((err = wm_audio_port_task_create(stage->name, wm_audio_stage_task, stage, pipeline->cfg.task_stack,
+                                             pipeline->cfg.task_prio)) != WM_ERR_SUCCESS) {
+            WM_AUDIO_LOGE("stage %s task err", stage->name);
+            wm_audio_pipeline_stop(pipeline);
+            return err;
+        }
+        pipeline->task_num++;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_audio_pipeline_wait(wm_audio_pipeline_t *pipeline, uint32_t timeout_ms)
+{
+    uint32_t start   = wm_audio_port_time_us();
+    uint32_t elapsed = 0;
+
+    if (!pipeline || !pipeline->started) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    while (pipeline->sink_done < pipeline->sink_num && pipeline->err == WM_ERR_SUCCESS) {
+        if (timeout_ms != WM_AUDIO_WAIT_FOREVER) {
+            elapsed = (wm_audio_port_time_us() - start) / 1000;
+            if (elapsed > timeout_ms) {
+                return WM_ERR_TIMEOUT;
+            }
+        }
+
+        if (wm_audio_port_sem_take(pipeline->done_sem,
+                                   timeout_ms == WM_AUDIO_WAIT_FOREVER ? WM_AUDIO_WAIT_FOREVER : timeout_ms - elapsed) !=
+            WM_ERR_SUCCESS) {
+            return WM_ERR_TIMEOUT;
+        }
+        pipeline->sink_done++;
+    }
+
+    return pipeline->err;
+}
+
+int wm_audio_pipeline_stop(wm_audio_pipeline_t *pipeline)
+{
+    if (!pipeline) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (!pipeline->started) {
+        return WM_ERR_SUCCESS;
+    }
+
+    pipeline->running = false;
+    while (pipeline->task_num) {
+        wm_audio_port_sem_take(pipeline->exit_sem, WM_AUDIO_WAIT_FOREVER);
+        pipeline->task_num--;
+    }
+
+    wm_audio_pipeline_close(pipeline);
+    pipeline->started = false;
+
+    return WM_ERR_SUCCESS;
+}
+
+void wm_audio_pipeline_destroy(wm_audio_pipeline_t *pipeline)
+{
+    wm_audio_stage_t *stage = NULL;
+    uint8_t i;
+
+    if (!pipeline) {
+        return;
+    }
+
+    wm_audio_pipeline_stop(pipeline);
+
+    while ((stage = pipeline->stages)) {
+        pipeline->stages = stage->pipeline_next;
+        for (i = 0; i < stage->in_num; i++) {
+            wm_audio_link_delete(stage->in_link[i]);
+        }
+        WM_AUDIO_FREE(stage);
+    }
+
+    wm_audio_port_sem_delete(pipeline->exit_sem);
+    wm_audio_port_sem_delete(pipeline->done_sem);
+    wm_audio_pool_delete(pipeline->pool);
+    WM_AUDIO_FREE(pipeline);
+}
+
+wm_audio_pool_t *wm_audio_pipeline_get_pool(wm_audio_pipeline_t *pipeline)
+{
+    return pipeline->pool;
+}
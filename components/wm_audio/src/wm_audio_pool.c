@@ -0,0 +1,147 @@
+/**
+ * @file wm_audio_pool.c
+ *
+ * @brief Audio Pipeline Buffer Pool
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define LOG_TAG "audio"
+#include "wm_audio_port.h"
+#include "wm_audio_pipeline.h"
+
+struct wm_audio_pool_s {
+    uint8_t *mem;                  /**< data of all the buffers          */
+    wm_audio_buf_t *bufs;          /**< buffer headers                   */
+    wm_audio_buf_t *free_list;     /**< free buffers                     */
+    wm_audio_port_sem_t *free_sem; /**< count of free buffers, to wait   */
+    uint32_t buf_size;             /**< bytes of one buffer              */
+    uint16_t buf_num;              /**< buffer count                     */
+    volatile uint16_t free_num;    /**< free buffer count                */
+};
+
+wm_audio_pool_t *wm_audio_pool_create(uint32_t buf_size, uint16_t buf_num)
+{
+    wm_audio_pool_t *pool = NULL;
+    uint16_t i;
+
+    if (!buf_size || !buf_num) {
+        return NULL;
+    }
+
+    pool = WM_AUDIO_CALLOC(1, sizeof(wm_audio_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+
+    /* I2S DMA needs 4 bytes aligned buffers of 4 bytes aligned size */
+    pool->buf_size = (buf_size + 3) & ~3U;
+    pool->buf_num  = buf_num;
+    pool->mem      = WM_AUDIO_MALLOC(pool->buf_size * buf_num);
+    pool->bufs     = WM_AUDIO_CALLOC(buf_num, sizeof(wm_audio_buf_t));
+
+    if (!pool->mem || !pool->bufs || wm_audio_port_sem_create(&pool->free_sem, buf_num) != WM_ERR_SUCCESS) {
+        WM_AUDIO_LOGE("pool alloc err");
+        WM_AUDIO_FREE(pool->mem);
+        WM_AUDIO_FREE(pool->bufs);
+        WM_AUDIO_FREE(pool);
+        return NULL;
+    }
+
+    for (i = 0; i < buf_num; i++) {
+        pool->bufs[i].pool = pool;
+        pool->bufs[i].data = pool->mem + i * pool->buf_size;
+        pool->bufs[i].next = pool->free_list;
+        pool->free_list    = &pool->bufs[i];
+    }
+    pool->free_num = buf_num;
+
+    return pool;
+}
+
+void wm_audio_pool_delete(wm_audio_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    if (pool->free_num != pool->buf_num) {
+        WM_AUDIO_LOGE("pool delete with %d buffers in use", pool->buf_num - pool->free_num);
+    }
+
+    wm_audio_port_sem_delete(pool->free_sem);
+    WM_AUDIO_FREE(pool->mem);
+    WM_AUDIO_FREE(pool->bufs);
+    WM_AUDIO_FREE(pool);
+}
+
+uint32_t wm_audio_pool_get_buf_size(wm_audio_pool_t *pool)
+{
+    return pool->buf_size;
+}
+
+uint16_t wm_audio_pool_get_free_num(wm_audio_pool_t *pool)
+{
+    return pool->free_num;
+}
+
+wm_audio_buf_t *wm_audio_buf_alloc(wm_audio_pool_t *pool, uint32_t timeout_ms)
+{
+    wm_audio_buf_t *buf = NULL;
+
+    if (wm_audio_port_sem_take(pool->free_sem, timeout_ms) != WM_ERR_SUCCESS) {
+        return NULL;
+    }
+
+    wm_audio_port_enter_critical();
+    buf             = pool->free_list;
+    pool->free_list = buf->next;
+    pool->free_num--;
+    wm_audio_port_exit_critical();
+
+    buf->next = NULL;
+    buf->len  = 0;
+    buf->ts   = 0;
+    buf->eos  = false;
+
+    return buf;
+}
+
+void wm_audio_buf_free(wm_audio_buf_t *buf)
+{
+    wm_audio_pool_t *pool = buf->pool;
+
+    wm_audio_port_enter_critical();
+    buf->next       = pool->free_list;
+    pool->free_list = buf;
+    pool->free_num++;
+    wm_audio_port_exit_critical();
+
+    wm_audio_port_sem_give(pool->free_sem);
+}
+
+wm_audio_buf_t *wm_audio_pool_find(wm_audio_pool_t *pool, const void *data)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    if (p < pool->mem || p >= pool->mem + pool->buf_size * pool->buf_num) {
+        return NULL;
+    }
+
+    return &pool->bufs[(p - pool->mem) / pool->buf_size];
+}
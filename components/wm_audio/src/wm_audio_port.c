@@ -0,0 +1,232 @@
+/**
+ * @file wm_audio_port.c
+ *
+ * @brief Audio Pipeline Porting Layer
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define LOG_TAG "audio"
+#include "wm_audio_port.h"
+
+#ifdef WM_AUDIO_HOST
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+struct wm_audio_port_sem_s {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t cnt;
+};
+
+typedef struct {
+    void (*entry)(void *arg);
+    void *arg;
+} wm_audio_port_task_t;
+
+static pthread_mutex_t g_wm_audio_port_critical = PTHREAD_MUTEX_INITIALIZER;
+
+int wm_audio_port_sem_create(wm_audio_port_sem_t **sem, uint32_t cnt)
+{
+    wm_audio_port_sem_t *s = WM_AUDIO_CALLOC(1, sizeof(wm_audio_port_sem_t));
+
+    if (!s) {
+        return WM_ERR_NO_MEM;
+    }
+
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->cnt = cnt;
+    *sem   = s;
+
+    return WM_ERR_SUCCESS;
+}
+
+void wm_audio_port_sem_delete(wm_audio_port_sem_t *sem)
+{
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mutex);
+    WM_AUDIO_FREE(sem);
+}
+
+int wm_audio_port_sem_take(wm_audio_port_sem_t *sem, uint32_t timeout_ms)
+{
+    struct timespec ts;
+    int err = WM_ERR_TIMEOUT;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&sem->mutex);
+    while (!sem->cnt && timeout_ms) {
+        if (timeout_ms == 0xFFFFFFFFU) {
+            pthread_cond_wait(&sem->cond, &sem->mutex);
+        } else if (pthread_cond_timedwait(&sem->cond, &sem->mutex, &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (sem->cnt) {
+        sem->cnt--;
+        err = WM_ERR_SUCCESS;
+    }
+    pthread_mutex_unlock(&sem->mutex);
+
+    return err;
+}
+
+void wm_audio_port_sem_give(wm_audio_port_sem_t *sem)
+{
+    pthread_mutex_lock(&sem->mutex);
+    sem->cnt++;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+void wm_audio_port_enter_critical(void)
+{
+    pthread_mutex_lock(&g_wm_audio_port_critical);
+}
+
+void wm_audio_port_exit_critical(void)
+{
+    pthread_mutex_unlock(&g_wm_audio_port_critical);
+}
+
+static void *wm_audio_port_task_entry(void *arg)
+{
+    wm_audio_port_task_t task = *(wm_audio_port_task_t *)arg;
+
+    WM_AUDIO_FREE(arg);
+    task.entry(task.arg);
+
+    return NULL;
+}
+
+int wm_audio_port_task_create(const char *name, void (*entry)(void *arg), void *arg, uint32_t stack_size, uint8_t prio)
+{
+    wm_audio_port_task_t *task = WM_AUDIO_MALLOC(sizeof(wm_audio_port_task_t));
+    pthread_t thread;
+
+    (void)name;
+    (void)stack_size;
+    (void)prio;
+
+    if (!task) {
+        return WM_ERR_NO_MEM;
+    }
+    task->entry = entry;
+    task->arg   = arg;
+
+    if (pthread_create(&thread, NULL, wm_audio_port_task_entry, task)) {
+        WM_AUDIO_FREE(task);
+        return WM_ERR_FAILED;
+    }
+    pthread_detach(thread);
+
+    return WM_ERR_SUCCESS;
+}
+
+void wm_audio_port_task_exit(void)
+{
+    pthread_exit(NULL);
+}
+
+void wm_audio_port_delay_ms(uint32_t ms)
+{
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000 };
+
+    nanosleep(&ts, NULL);
+}
+
+uint32_t wm_audio_port_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+#else
+
+int wm_audio_port_sem_create(wm_audio_port_sem_t **sem, uint32_t cnt)
+{
+    return wm_os_internal_sem_create((wm_os_sem_t **)sem, cnt) == WM_OS_STATUS_SUCCESS ? WM_ERR_SUCCESS : WM_ERR_NO_MEM;
+}
+
+void wm_audio_port_sem_delete(wm_audio_port_sem_t *sem)
+{
+    wm_os_internal_sem_delete((wm_os_sem_t *)sem);
+}
+
+int wm_audio_port_sem_take(wm_audio_port_sem_t *sem, uint32_t timeout_ms)
+{
+    wm_os_status_t status;
+
+    if (timeout_ms == WM_OS_WAIT_TIME_MAX) {
+        status = wm_os_internal_sem_acquire((wm_os_sem_t *)sem, WM_OS_WAIT_TIME_MAX);
+    } else {
+        status = wm_os_internal_sem_acquire_ms((wm_os_sem_t *)sem, timeout_ms);
+    }
+
+    return status == WM_OS_STATUS_SUCCESS ? WM_ERR_SUCCESS : WM_ERR_TIMEOUT;
+}
+
+void wm_audio_port_sem_give(wm_audio_port_sem_t *sem)
+{
+    wm_os_internal_sem_release((wm_os_sem_t *)sem);
+}
+
+void wm_audio_port_enter_critical(void)
+{
+    wm_os_internal_set_critical();
+}
+
+void wm_audio_port_exit_critical(void)
+{
+    wm_os_internal_release_critical();
+}
+
+int wm_audio_port_task_create(const char *name, void (*entry)(void *arg), void *arg, uint32_t stack_size, uint8_t prio)
+{
+    return wm_os_internal_task_create(NULL, name, entry, arg, stack_size, prio, 0) == WM_OS_STATUS_SUCCESS ? WM_ERR_SUCCESS :
+                                                                                                          WM_ERR_FAILED;
+}
+
+void wm_audio_port_task_exit(void)
+{
+    wm_os_internal_task_del(NULL);
+}
+
+void wm_audio_port_delay_ms(uint32_t ms)
+{
+    wm_os_internal_time_delay_ms(ms);
+}
+
+uint32_t wm_audio_port_time_us(void)
+{
+    return wm_os_internal_get_time_us();
+}
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @file wm_audio_port.h
+ *
+ * @brief Audio Pipeline Porting Layer
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_AUDIO_PORT_H__
+#define __WM_AUDIO_PORT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wm_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* WM_AUDIO_HOST builds the pipeline on a PC with pthreads, to measure it with the file stages */
+#ifdef WM_AUDIO_HOST
+#include <stdio.h>
+
+#define WM_AUDIO_LOGE(fmt, ...)      fprintf(stderr, "[audio] " fmt "\n", ##__VA_ARGS__)
+#define WM_AUDIO_LOGI(fmt, ...)      fprintf(stdout, "[audio] " fmt "\n", ##__VA_ARGS__)
+
+#define WM_AUDIO_MALLOC(size)        malloc(size)
+#define WM_AUDIO_CALLOC(nelem, size) calloc(nelem, size)
+#define WM_AUDIO_FREE(ptr)           free(ptr)
+#else
+#include "wm_osal.h"
+#include "wm_log.h"
+
+#define WM_AUDIO_LOGE(...)           wm_log_error(__VA_ARGS__)
+#define WM_AUDIO_LOGI(...)           wm_log_info(__VA_ARGS__)
+
+#define WM_AUDIO_MALLOC(size)        wm_os_internal_malloc(size)
+#define WM_AUDIO_CALLOC(nelem, size) wm_os_internal_calloc(nelem, size)
+#define WM_AUDIO_FREE(ptr)           wm_os_internal_free(ptr)
+#endif
+
+/* stage tasks wake up at least this often to check for a stop */
+#define WM_AUDIO_POLL_MS 20
+
+typedef struct wm_audio_port_sem_s wm_audio_port_sem_t;
+
+int wm_audio_port_sem_create(wm_audio_port_sem_t **sem, uint32_t cnt);
+void wm_audio_port_sem_delete(wm_audio_port_sem_t *sem);
+/* return WM_ERR_TIMEOUT if not taken in timeout_ms */
+int wm_audio_port_sem_take(wm_audio_port_sem_t *sem, uint32_t timeout_ms);
+/* can be called in interrupt context */
+void wm_audio_port_sem_give(wm_audio_port_sem_t *sem);
+
+/* protect short sections shared with interrupt context */
+void wm_audio_port_enter_critical(void);
+void wm_audio_port_exit_critical(void);
+
+int wm_audio_port_task_create(const char *name, void (*entry)(void *arg), void *arg, uint32_t stack_size, uint8_t prio);
+void wm_audio_port_task_exit(void);
+void wm_audio_port_delay_ms(uint32_t ms);
+
+/* free running us counter, wraps around */
+uint32_t wm_audio_port_time_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_AUDIO_PORT_H__ */
@@ -0,0 +1,231 @@
+/**
+ * @file wm_audio_stage_file.c
+ *
+ * @brief Audio Pipeline File Stages
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+
+#define LOG_TAG "audio"
+#include "wm_audio_port.h"
+#include "wm_audio_stage.h"
+
+typedef struct {
+    const char *path;
+    FILE *fp;
+    wm_audio_format_t fmt; /**< format of a raw PCM file, bits is 0 for a WAV file */
+    uint32_t data_left;    /**< bytes of PCM data left in the file                 */
+} wm_audio_file_t;
+
+static inline uint16_t wm_audio_file_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t wm_audio_file_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* walk the RIFF chunks up to the data chunk, the file is left at the first PCM byte */
+static int wm_audio_file_parse_wav(wm_audio_file_t *file, wm_audio_format_t *fmt)
+{
+    uint8_t head[16];
+    uint32_t size;
+
+    if (fread(head, 1, 12, file->fp) != 12 || memcmp(head, "RIFF", 4) || memcmp(head + 8, "WAVE", 4)) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    while (fread(head, 1, 8, file->fp) == 8) {
+        size = wm_audio_file_le32(head + 4);
+
+        if (!memcmp(head, "data", 4)) {
+            file->data_left = size;
+            return fmt->bits ? WM_ERR_SUCCESS : WM_ERR_INVALID_PARAM;
+        }
+
+        if (!memcmp(head, "fmt ", 4) && size >= 16) {
+            if (fread(head, 1, 16, file->fp) != 16 || wm_audio_file_le16(head) != 1) {
+                return WM_ERR_INVALID_PARAM;
+            }
+            fmt->channels    = (uint8_t)wm_audio_file_le16(head + 2);
+            fmt->sample_rate = wm_audio_file_le32(head + 4);
+            fmt->bits        = (uint8_t)wm_audio_file_le16(head + 14);
+            size -= 16;
+        }
+
+        if (fseek(file->fp, (size + 1) & ~1U, SEEK_CUR)) {
+            break;
+        }
+    }
+
+    return WM_ERR_INVALID_PARAM;
+}
+
+static int wm_audio_file_source_open(wm_audio_stage_t *stage)
+{
+    wm_audio_file_t *file = (wm_audio_file_t *)stage->priv;
+    int err               = WM_ERR_SUCCESS;
+
+    file->fp = fopen(file->path, "rb");
+    if (!file->fp) {
+        WM_AUDIO_LOGE("open %s err", file->path);
+        return WM_ERR_FAILED;
+    }
+
+    memset(&stage->out_fmt, 0, sizeof(stage->out_fmt));
+    if (file->fmt.bits) {
+        stage->out_fmt  = file->fmt;
+        file->data_left = UINT32_MAX;
+    } else if ((err = wm_audio_file_parse_wav(file, &stage->out_fmt)) != WM_ERR_SUCCESS) {
+        WM_AUDIO_LOGE("%s is not a PCM WAV file", file->path);
+    }
+
+    if (err == WM_ERR_SUCCESS && (!stage->out_fmt.channels || stage->out_fmt.bits % 8)) {
+        err = WM_ERR_INVALID_PARAM;
+    }
+
+    if (err != WM_ERR_SUCCESS) {
+        fclose(file->fp);
+        file->fp = NULL;
+    }
+
+    return err;
+}
+
+static int wm_audio_file_source_process(wm_audio_stage_t *stage, wm_audio_buf_t *in[], wm_audio_buf_t **out)
+{
+    wm_audio_file_t *file = (wm_audio_file_t *)stage->priv;
+    uint32_t frame        = stage->out_fmt.channels * stage->out_fmt.bits / 8;
+    uint32_t want         = wm_audio_pool_get_buf_size(stage->pool) / frame * frame;
+    wm_audio_buf_t *buf   = NULL;
+    uint32_t len;
+
+    (void)in;
+
+    if (!(buf = wm_audio_stage_buf_alloc(stage))) {
+        return WM_ERR_SUCCESS;
+    }
+
+    if (want > file->data_left) {
+        want = file->data_left;
+    }
+
+    len = (uint32_t)fread(buf->data, 1, want, file->fp);
+    file->data_left -= len;
+
+    buf->ts  = wm_audio_port_time_us();
+    buf->len = len - len % frame;
+    buf->eos = len < want || !file->data_left;
+    *out     = buf;
+
+    return WM_ERR_SUCCESS;
+}
+
+static void wm_audio_file_close(wm_audio_stage_t *stage)
+{
+    wm_audio_file_t *file = (wm_audio_file_t *)stage->priv;
+
+    if (file->fp) {
+        fclose(file->fp);
+        file->fp = NULL;
+    }
+}
+
+static int wm_audio_file_sink_open(wm_audio_stage_t *stage)
+{
+    wm_audio_file_t *file = (wm_audio_file_t *)stage->priv;
+
+    file->fp = fopen(file->path, "wb");
+    if (!file->fp) {
+        WM_AUDIO_LOGE("open %s err", file->path);
+        return WM_ERR_FAILED;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_file_sink_process(wm_audio_stage_t *stage, wm_audio_buf_t *in[], wm_audio_buf_t **out)
+{
+    wm_audio_file_t *file = (wm_audio_file_t *)stage->priv;
+    int err               = WM_ERR_SUCCESS;
+
+    (void)out;
+
+    if (in[0]->len && fwrite(in[0]->data, 1, in[0]->len, file->fp) != in[0]->len) {
+        WM_AUDIO_LOGE("write %s err", file->path);
+        err = WM_ERR_FAILED;
+    }
+
+    wm_audio_buf_free(in[0]);
+    in[0] = NULL;
+
+    return err;
+}
+
+static const wm_audio_stage_ops_t wm_audio_file_source_ops = {
+    .open    = wm_audio_file_source_open,
+    .process = wm_audio_file_source_process,
+    .close   = wm_audio_file_close,
+};
+
+static const wm_audio_stage_ops_t wm_audio_file_sink_ops = {
+    .open    = wm_audio_file_sink_open,
+    .process = wm_audio_file_sink_process,
+    .close   = wm_audio_file_close,
+};
+
+wm_audio_stage_t *wm_audio_file_source_create(const char *path, const wm_audio_format_t *fmt)
+{
+    wm_audio_stage_t *stage = NULL;
+    wm_audio_file_t *file   = NULL;
+
+    if (!path || (fmt && (!fmt->bits || fmt->bits % 8 || !fmt->channels))) {
+        return NULL;
+    }
+
+    stage = wm_audio_stage_create("file_src", &wm_audio_file_source_ops, 0, true, sizeof(wm_audio_file_t));
+    if (stage) {
+        file       = (wm_audio_file_t *)stage->priv;
+        file->path = path;
+        if (fmt) {
+            file->fmt = *fmt;
+        }
+    }
+
+    return stage;
+}
+
+wm_audio_stage_t *wm_audio_file_sink_create(const char *path)
+{
+    wm_audio_stage_t *stage = NULL;
+
+    if (!path) {
+        return NULL;
+    }
+
+    stage = wm_audio_stage_create("file_sink", &wm_audio_file_sink_ops, 1, false, sizeof(wm_audio_file_t));
+    if (stage) {
+        ((wm_audio_file_t *)stage->priv)->path = path;
+    }
+
+    return stage;
+}
@@ -0,0 +1,308 @@
+/**
+ * @file wm_audio_stage_i2s.c
+ *
+ * @brief Audio Pipeline I2S Stages
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define LOG_TAG "audio"
+#include "wm_audio_port.h"
+#include "wm_audio_i2s.h"
+#include "wm_drv_i2s.h"
+
+#define WM_AUDIO_I2S_PKT_MAX 16 /**< max rx_pkt_num of the I2S driver */
+
+typedef struct {
+    wm_device_t *dev;
+    wm_audio_format_t fmt;
+    wm_audio_port_sem_t *rx_sem;                   /**< count of buffers in rx_ring                  */
+    wm_audio_buf_t *rx_ring[WM_AUDIO_I2S_PKT_MAX]; /**< received buffers, filled in ISR, pkt_num max */
+    uint8_t rx_head;
+    volatile uint8_t rx_tail;
+    volatile uint8_t queued; /**< buffers in the DMA receive list */
+    uint8_t pkt_num;
+} wm_audio_i2s_source_t;
+
+typedef struct {
+    wm_device_t *dev;
+    volatile uint8_t pending; /**< buffers in the DMA send list */
+} wm_audio_i2s_sink_t;
+
+/* the I2S callbacks carry no user data, one source and one sink can be opened at a time */
+static wm_audio_stage_t *g_wm_audio_i2s_source = NULL;
+static wm_audio_stage_t *g_wm_audio_i2s_sink   = NULL;
+
+static int wm_audio_i2s_rx_callback(wm_device_t *dev, wm_drv_i2s_event_t *event)
+{
+    wm_audio_stage_t *stage    = g_wm_audio_i2s_source;
+    wm_audio_i2s_source_t *src = NULL;
+    wm_audio_buf_t *buf        = NULL;
+
+    (void)dev;
+
+    if (!stage || event->type != WM_DRV_I2S_EVENT_RX_READY || !(buf = wm_audio_pool_find(stage->pool, event->buf))) {
+        return WM_ERR_SUCCESS;
+    }
+
+    src = (wm_audio_i2s_source_t *)stage->priv;
+    src->queued--;
+
+    if (event->len > 0 && (uint8_t)(src->rx_tail - src->rx_head) < src->pkt_num) {
+        buf->len                                          = event->len;
+        src->rx_ring[src->rx_tail % WM_AUDIO_I2S_PKT_MAX] = buf;
+        src->rx_tail++;
+        wm_audio_port_sem_give(src->rx_sem);
+    } else {
+        /* removed from the DMA list by wm_drv_i2s_read_stop, or the task is behind by a whole ring */
+        if (event->len > 0) {
+            stage->stats.overrun++;
+        }
+        wm_audio_buf_free(buf);
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+/* keep the DMA receive list full, the data of a missing buffer is lost */
+static int wm_audio_i2s_source_refill(wm_audio_stage_t *stage)
+{
+    wm_audio_i2s_source_t *src = (wm_audio_i2s_source_t *)stage->priv;
+    wm_audio_buf_t *buf        = NULL;
+    int err                    = WM_ERR_SUCCESS;
+
+    while (src->queued < src->pkt_num) {
+        if (!(buf = wm_audio_buf_alloc(stage->pool, 0))) {
+            stage->stats.overrun++;
+            return WM_ERR_NO_MEM;
+        }
+
+        wm_audio_port_enter_critical();
+        src->queued++;
+        wm_audio_port_exit_critical();
+
+        err = wm_drv_i2s_read_async(src->dev, buf->data, (int)wm_audio_pool_get_buf_size(stage->pool));
+        if (err != WM_ERR_SUCCESS) {
+            wm_audio_port_enter_critical();
+            src->queued--;
+            wm_audio_port_exit_critical();
+            wm_audio_buf_free(buf);
+            return err;
+        }
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_i2s_source_open(wm_audio_stage_t *stage)
+{
+    wm_audio_i2s_source_t *src = (wm_audio_i2s_source_t *)stage->priv;
+    int err                    = WM_ERR_SUCCESS;
+
+    if (g_wm_audio_i2s_source) {
+        return WM_ERR_BUSY;
+    }
+
+    if (wm_audio_port_sem_create(&src->rx_sem, 0) != WM_ERR_SUCCESS) {
+        return WM_ERR_NO_MEM;
+    }
+
+    stage->out_fmt        = src->fmt;
+    src->rx_head          = 0;
+    src->rx_tail          = 0;
+    src->queued           = 0;
+    g_wm_audio_i2s_source = stage;
+
+    wm_drv_i2s_register_read_cb(src->dev, wm_audio_i2s_rx_callback);
+    if ((err = wm_audio_i2s_source_refill(stage)) != WM_ERR_SUCCESS) {
+        WM_AUDIO_LOGE("i2s read err %d", err);
+        wm_drv_i2s_read_stop(src->dev);
+        wm_drv_i2s_register_read_cb(src->dev, NULL);
+        g_wm_audio_i2s_source = NULL;
+        wm_audio_port_sem_delete(src->rx_sem);
+        return err;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_i2s_source_process(wm_audio_stage_t *stage, wm_audio_buf_t *in[], wm_audio_buf_t **out)
+{
+    wm_audio_i2s_source_t *src = (wm_audio_i2s_source_t *)stage->priv;
+    wm_audio_buf_t *buf        = NULL;
+
+    (void)in;
+
+    if (wm_audio_port_sem_take(src->rx_sem, WM_AUDIO_POLL_MS) == WM_ERR_SUCCESS) {
+        buf     = src->rx_ring[src->rx_head % WM_AUDIO_I2S_PKT_MAX];
+        buf->ts = wm_audio_port_time_us();
+        src->rx_head++;
+        *out = buf;
+    }
+
+    wm_audio_i2s_source_refill(stage);
+
+    return WM_ERR_SUCCESS;
+}
+
+static void wm_audio_i2s_source_close(wm_audio_stage_t *stage)
+{
+    wm_audio_i2s_source_t *src = (wm_audio_i2s_source_t *)stage->priv;
+
+    /* the buffers left in the DMA list come back through the callback */
+    wm_drv_i2s_read_stop(src->dev);
+    wm_drv_i2s_register_read_cb(src->dev, NULL);
+    g_wm_audio_i2s_source = NULL;
+
+    while (src->rx_head != src->rx_tail) {
+        wm_audio_buf_free(src->rx_ring[src->rx_head % WM_AUDIO_I2S_PKT_MAX]);
+        src->rx_head++;
+    }
+
+    wm_audio_port_sem_delete(src->rx_sem);
+    src->rx_sem = NULL;
+}
+
+static int wm_audio_i2s_tx_callback(wm_device_t *dev, wm_drv_i2s_event_t *event)
+{
+    wm_audio_stage_t *stage = g_wm_audio_i2s_sink;
+    wm_audio_buf_t *buf     = NULL;
+
+    (void)dev;
+
+    if (stage && event->type == WM_DRV_I2S_EVENT_TX_DONE && (buf = wm_audio_pool_find(stage->pool, event->buf))) {
+        wm_audio_buf_free(buf);
+        ((wm_audio_i2s_sink_t *)stage->priv)->pending--;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_i2s_sink_open(wm_audio_stage_t *stage)
+{
+    wm_audio_i2s_sink_t *sink = (wm_audio_i2s_sink_t *)stage->priv;
+
+    if (g_wm_audio_i2s_sink) {
+        return WM_ERR_BUSY;
+    }
+
+    sink->pending       = 0;
+    g_wm_audio_i2s_sink = stage;
+    wm_drv_i2s_register_write_cb(sink->dev, wm_audio_i2s_tx_callback);
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_i2s_sink_process(wm_audio_stage_t *stage, wm_audio_buf_t *in[], wm_audio_buf_t **out)
+{
+    wm_audio_i2s_sink_t *sink = (wm_audio_i2s_sink_t *)stage->priv;
+    wm_audio_buf_t *buf       = in[0];
+    bool eos                  = buf->eos;
+    int len                   = (int)(buf->len & ~3U);
+    int err                   = WM_ERR_SUCCESS;
+
+    (void)out;
+
+    in[0] = NULL;
+    if (!len) {
+        wm_audio_buf_free(buf);
+    } else {
+        wm_audio_port_enter_critical();
+        sink->pending++;
+        wm_audio_port_exit_critical();
+
+        /* a full DMA list is the back pressure of the sink, wait for a send done */
+        while ((err = wm_drv_i2s_write_async(sink->dev, buf->data, len)) == WM_ERR_NO_MEM) {
+            wm_audio_port_delay_ms(1);
+        }
+
+        if (err != WM_ERR_SUCCESS) {
+            wm_audio_port_enter_critical();
+            sink->pending--;
+            wm_audio_port_exit_critical();
+            wm_audio_buf_free(buf);
+            return err;
+        }
+    }
+
+    if (eos) {
+        while (sink->pending) {
+            wm_audio_port_delay_ms(1);
+        }
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static void wm_audio_i2s_sink_close(wm_audio_stage_t *stage)
+{
+    wm_audio_i2s_sink_t *sink = (wm_audio_i2s_sink_t *)stage->priv;
+
+    /* the buffers left in the DMA list come back through the callback */
+    wm_drv_i2s_write_stop(sink->dev);
+    wm_drv_i2s_register_write_cb(sink->dev, NULL);
+    g_wm_audio_i2s_sink = NULL;
+}
+
+static const wm_audio_stage_ops_t wm_audio_i2s_source_ops = {
+    .open    = wm_audio_i2s_source_open,
+    .process = wm_audio_i2s_source_process,
+    .close   = wm_audio_i2s_source_close,
+};
+
+static const wm_audio_stage_ops_t wm_audio_i2s_sink_ops = {
+    .open    = wm_audio_i2s_sink_open,
+    .process = wm_audio_i2s_sink_process,
+    .close   = wm_audio_i2s_sink_close,
+};
+
+wm_audio_stage_t *wm_audio_i2s_source_create(wm_device_t *i2s_dev, const wm_audio_format_t *fmt, uint8_t pkt_num)
+{
+    wm_audio_stage_t *stage    = NULL;
+    wm_audio_i2s_source_t *src = NULL;
+
+    if (!i2s_dev || !fmt || pkt_num < 2 || pkt_num > WM_AUDIO_I2S_PKT_MAX) {
+        return NULL;
+    }
+
+    stage = wm_audio_stage_create("i2s_src", &wm_audio_i2s_source_ops, 0, true, sizeof(wm_audio_i2s_source_t));
+    if (stage) {
+        src          = (wm_audio_i2s_source_t *)stage->priv;
+        src->dev     = i2s_dev;
+        src->fmt     = *fmt;
+        src->pkt_num = pkt_num;
+    }
+
+    return stage;
+}
+
+wm_audio_stage_t *wm_audio_i2s_sink_create(wm_device_t *i2s_dev)
+{
+    wm_audio_stage_t *stage = NULL;
+
+    if (!i2s_dev) {
+        return NULL;
+    }
+
+    stage = wm_audio_stage_create("i2s_sink", &wm_audio_i2s_sink_ops, 1, false, sizeof(wm_audio_i2s_sink_t));
+    if (stage) {
+        ((wm_audio_i2s_sink_t *)stage->priv)->dev = i2s_dev;
+    }
+
+    return stage;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file wm_audio_stage_mix.c
+ *
+ * @brief Audio Pipeline Mixer And Volume Control
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define LOG_TAG "audio"
+#include "wm_audio_port.h"
+#include "wm_audio_stage.h"
+
+typedef struct {
+    volatile uint16_t gain[WM_AUDIO_STAGE_IN_MAX]; /**< Q12 gain of each input            */
+    uint32_t off[WM_AUDIO_STAGE_IN_MAX];           /**< bytes of each input already mixed */
+} wm_audio_mixer_t;
+
+typedef struct {
+    volatile uint16_t gain; /**< Q12 gain */
+} wm_audio_volume_t;
+
+static inline int16_t wm_audio_sat16(int32_t v)
+{
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+static int wm_audio_mixer_open(wm_audio_stage_t *stage)
+{
+    wm_audio_mixer_t *mixer = (wm_audio_mixer_t *)stage->priv;
+    uint8_t i;
+
+    for (i = 0; i < stage->in_num; i++) {
+        if (stage->in_fmt[i].bits != 16 || stage->in_fmt[i].sample_rate != stage->in_fmt[0].sample_rate ||
+            stage->in_fmt[i].channels != stage->in_fmt[0].channels) {
+            WM_AUDIO_LOGE("mixer input %d fmt err", i);
+            return WM_ERR_INVALID_PARAM;
+        }
+        mixer->off[i] = 0;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_mixer_process(wm_audio_stage_t *stage, wm_audio_buf_t *in[], wm_audio_buf_t **out)
+{
+    wm_audio_mixer_t *mixer = (wm_audio_mixer_t *)stage->priv;
+    uint32_t len            = wm_audio_pool_get_buf_size(stage->pool);
+    bool drained            = false;
+    wm_audio_buf_t *buf     = NULL;
+    int16_t *dst            = NULL;
+    const int16_t *src      = NULL;
+    int32_t acc             = 0;
+    uint32_t ts             = 0;
+    uint32_t i, j, n;
+
+    /* give back the empty buffers first, the next ones of these inputs are needed to mix */
+    for (i = 0; i < stage->in_num; i++) {
+        if (in[i] && in[i]->len <= mixer->off[i]) {
+            wm_audio_buf_free(in[i]);
+            in[i]         = NULL;
+            mixer->off[i] = 0;
+            drained       = true;
+        }
+    }
+    if (drained) {
+        return WM_ERR_SUCCESS;
+    }
+
+    for (i = 0; i < stage->in_num; i++) {
+        if (in[i]) {
+            if (in[i]->len - mixer->off[i] < len) {
+                len = in[i]->len - mixer->off[i];
+            }
+            if (!buf || (int32_t)(in[i]->ts - ts) < 0) {
+                ts = in[i]->ts;
+            }
+            buf = in[i];
+        }
+    }
+    if (!buf) {
+        return WM_ERR_SUCCESS;
+    }
+
+    if (!(buf = wm_audio_stage_buf_alloc(stage))) {
+        return WM_ERR_SUCCESS;
+    }
+    buf->len = len;
+    buf->ts  = ts;
+    dst      = (int16_t *)buf->data;
+    n        = len / sizeof(int16_t);
+
+    for (j = 0; j < n; j++) {
+        acc = 0;
+        for (i = 0; i < stage->in_num; i++) {
+            if (in[i]) {
+                src = (const int16_t *)(in[i]->data + mixer->off[i]);
+                acc += (src[j] * (int32_t)mixer->gain[i]) >> 12;
+            }
+        }
+        dst[j] = wm_audio_sat16(acc);
+    }
+
+    for (i = 0; i < stage->in_num; i++) {
+        if (in[i]) {
+            mixer->off[i] += len;
+            if (mixer->off[i] >= in[i]->len) {
+                wm_audio_buf_free(in[i]);
+                in[i]         = NULL;
+                mixer->off[i] = 0;
+            }
+        }
+    }
+    *out = buf;
+
+    return WM_ERR_SUCCESS;
+}
+
+static const wm_audio_stage_ops_t wm_audio_mixer_ops = {
+    .open    = wm_audio_mixer_open,
+    .process = wm_audio_mixer_process,
+};
+
+wm_audio_stage_t *wm_audio_mixer_create(const uint16_t gains[WM_AUDIO_STAGE_IN_MAX])
+{
+    wm_audio_stage_t *stage = wm_audio_stage_create("mixer", &wm_audio_mixer_ops, WM_AUDIO_STAGE_IN_MAX, true,
+                                                    sizeof(wm_audio_mixer_t));
+    wm_audio_mixer_t *mixer = NULL;
+    uint8_t i;
+
+    if (stage) {
+        mixer = (wm_audio_mixer_t *)stage->priv;
+        for (i = 0; i < WM_AUDIO_STAGE_IN_MAX; i++) {
+            mixer->gain[i] = gains ? gains[i] : WM_AUDIO_GAIN_UNITY;
+        }
+    }
+
+    return stage;
+}
+
+int wm_audio_mixer_set_gain(wm_audio_stage_t *stage, uint8_t port, uint16_t gain)
+{
+    if (!stage || stage->ops != &wm_audio_mixer_ops || port >= WM_AUDIO_STAGE_IN_MAX) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    ((wm_audio_mixer_t *)stage->priv)->gain[port] = gain;
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_volume_open(wm_audio_stage_t *stage)
+{
+    if (stage->in_fmt[0].bits != 16) {
+        WM_AUDIO_LOGE("volume fmt err");
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_audio_volume_process(wm_audio_stage_t *stage, wm_audio_buf_t *in[], wm_audio_buf_t **out)
+{
+    int32_t gain    = ((wm_audio_volume_t *)stage->priv)->gain;
+    int16_t *sample = (int16_t *)in[0]->data;
+    uint32_t n      = in[0]->len / sizeof(int16_t);
+    uint32_t i;
+
+    /* scaled in place, the buffer is forwarded without a copy */
+    if (gain != WM_AUDIO_GAIN_UNITY) {
+        for (i = 0; i < n; i++) {
+            sample[i] = wm_audio_sat16((sample[i] * gain) >> 12);
+        }
+    }
+
+    *out  = in[0];
+    in[0] = NULL;
+
+    return WM_ERR_SUCCESS;
+}
+
+static const wm_audio_stage_ops_t wm_audio_volume_ops = {
+    .open    = wm_audio_volume_open,
+    .process = wm_audio_volume_process,
+};
+
+wm_audio_stage_t *wm_audio_volume_create(uint16_t gain)
+{
+    wm_audio_stage_t *stage = wm_audio_stage_create("volume", &wm_audio_volume_ops, 1, true, sizeof(wm_audio_volume_t));
+
+    if (stage) {
+        ((wm_audio_volume_t *)stage->priv)->gain = gain;
+    }
+
+    return stage;
+}
+
+int wm_audio_volume_set(wm_audio_stage_t *stage, uint16_t gain)
+{
+    if (!stage || stage->ops != &wm_audio_volume_ops) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    ((wm_audio_volume_t *)stage->priv)->gain = gain;
+
+    return WM_ERR_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file wm_audio_stage_resample.c
+ *
+ * @brief Audio Pipeline Sample Rate Converter
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define LOG_TAG "audio"
+#include "wm_audio_port.h"
+#include "wm_audio_stage.h"
+
+typedef struct {
+    wm_audio_format_t fmt; /**< requested output format                                     */
+    wm_audio_buf_t *out;   /**< output buffer being filled                                  */
+    uint32_t step;         /**< input frames per output frame, integer part                 */
+    uint32_t step_num;     /**< input frames per output frame, fraction in 1/out_rate units */
+    uint32_t inv;          /**< 2^31 / out_rate, to turn the fraction into Q15              */
+    int32_t pos;           /**< next output position in input frames, integer part          */
+    uint32_t pos_num;      /**< next output position, fraction in 1/out_rate units          */
+    int32_t prev[2];       /**< last frame of the previous input buffer, frame -1           */
+    bool bypass;           /**< input already in the output format                          */
+} wm_audio_resample_t;
+
+static int wm_audio_resample_open(wm_audio_stage_t *stage)
+{
+    wm_audio_resample_t *rs     = (wm_audio_resample_t *)stage->priv;
+    const wm_audio_format_t *in = &stage->in_fmt[0];
+
+    stage->out_fmt = *in;
+    if (rs->fmt.sample_rate) {
+        stage->out_fmt.sample_rate = rs->fmt.sample_rate;
+    }
+    if (rs->fmt.channels) {
+        stage->out_fmt.channels = rs->fmt.channels;
+    }
+
+    if (in->bits != 16 || !in->sample_rate || !in->channels || in->channels > 2 || stage->out_fmt.channels > 2) {
+        WM_AUDIO_LOGE("resample fmt err");
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    rs->bypass  = in->sample_rate == stage->out_fmt.sample_rate && in->channels == stage->out_fmt.channels;
+    rs->step     = in->sample_rate / stage->out_fmt.sample_rate;
+    rs->step_num = in->sample_rate % stage->out_fmt.sample_rate;
+    rs->inv      = (uint32_t)((1ULL << 31) / stage->out_fmt.sample_rate);
+    rs->pos      = 0;
+    rs->pos_num  = 0;
+    rs->prev[0]  = 0;
+    rs->prev[1]  = 0;
+    rs->out      = NULL;
+
+    return WM_ERR_SUCCESS;
+}
+
+static inline void wm_audio_resample_frame(const int16_t *src, int32_t idx, uint8_t channels, const int32_t prev[2],
+                                           int32_t frame[2])
+{
+    if (idx < 0) {
+        frame[0] = prev[0];
+        frame[1] = prev[1];
+    } else if (channels == 1) {
+        frame[0] = src[idx];
+        frame[1] = src[idx];
+    } else {
+        frame[0] = src[idx * 2];
+        frame[1] = src[idx * 2 + 1];
+    }
+}
+
+static int wm_audio_resample_process(wm_audio_stage_t *stage, wm_audio_buf_t *in[], wm_audio_buf_t **out)
+{
+    wm_audio_resample_t *rs = (wm_audio_resample_t *)stage->priv;
+    uint8_t in_ch           = stage->in_fmt[0].channels;
+    uint8_t out_ch          = stage->out_fmt.channels;
+    uint32_t buf_size       = wm_audio_pool_get_buf_size(stage->pool);
+    const int16_t *src      = (const int16_t *)in[0]->data;
+    int32_t frames          = in[0]->len / (in_ch * sizeof(int16_t));
+    int32_t a[2], b[2];
+    int16_t *dst = NULL;
+    int32_t frac;
+
+    if (rs->bypass) {
+        *out  = in[0];
+        in[0] = NULL;
+        return WM_ERR_SUCCESS;
+    }
+
+    if (!rs->out) {
+        if (!(rs->out = wm_audio_stage_buf_alloc(stage))) {
+            return WM_ERR_SUCCESS;
+        }
+        rs->out->ts = in[0]->ts;
+    }
+    dst = (int16_t *)(rs->out->data + rs->out->len);
+
+    /*
+     * output frame at pos is interpolated between input frames pos - 1 and pos, frame -1 is prev,
+     * the position is kept as an exact fraction so the output length does not drift
+     */
+    while (rs->out->len + out_ch * sizeof(int16_t) <= buf_size && rs->pos < frames) {
+        frac = (int32_t)((rs->pos_num * rs->inv) >> 16);
+        wm_audio_resample_frame(src, rs->pos - 1, in_ch, rs->prev, a);
+        wm_audio_resample_frame(src, rs->pos, in_ch, rs->prev, b);
+        a[0] += ((b[0] - a[0]) * frac) >> 15;
+        a[1] += ((b[1] - a[1]) * frac) >> 15;
+
+        if (out_ch == 1) {
+            *dst++ = (int16_t)((a[0] + a[1]) >> 1);
+        } else {
+            *dst++ = (int16_t)a[0];
+            *dst++ = (int16_t)a[1];
+        }
+        rs->out->len += out_ch * sizeof(int16_t);
+        rs->pos += rs->step;
+        rs->pos_num += rs->step_num;
+        if (rs->pos_num >= stage->out_fmt.sample_rate) {
+            rs->pos_num -= stage->out_fmt.sample_rate;
+            rs->pos++;
+        }
+    }
+
+    if (rs->pos >= frames) {
+        if (frames) {
+            wm_audio_resample_frame(src, frames - 1, in_ch, rs->prev, rs->prev);
+            rs->pos -= frames;
+        }
+        rs->out->eos = in[0]->eos;
+        wm_audio_buf_free(in[0]);
+        in[0] = NULL;
+    }
+
+    if (rs->out->eos || rs->out->len + out_ch * sizeof(int16_t) > buf_size) {
+        *out    = rs->out;
+        rs->out = NULL;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static void wm_audio_resample_close(wm_audio_stage_t *stage)
+{
+    wm_audio_resample_t *rs = (wm_audio_resample_t *)stage->priv;
+
+    if (rs->out) {
+        wm_audio_buf_free(rs->out);
+        rs->out = NULL;
+    }
+}
+
+static const wm_audio_stage_ops_t wm_audio_resample_ops = {
+    .open    = wm_audio_resample_open,
+    .process = wm_audio_resample_process,
+    .close   = wm_audio_resample_close,
+};
+
+wm_audio_stage_t *wm_audio_resample_create(const wm_audio_format_t *fmt)
+{
+    wm_audio_stage_t *stage = NULL;
+
+    if (!fmt || fmt->channels > 2) {
+        return NULL;
+    }
+
+    stage = wm_audio_stage_create("resample", &wm_audio_resample_ops, 1, true, sizeof(wm_audio_resample_t));
+    if (stage) {
+        ((wm_audio_resample_t *)stage->priv)->fmt = *fmt;
+    }
+
+    return stage;
+}
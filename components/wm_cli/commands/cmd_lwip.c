@@ -5,6 +5,12 @@
 #include "lwip/netif.h"
 #include "lwip/netifapi.h"
 #include "lwip/ip_addr.h"
+#if CONFIG_LWIP_STATS
+#include <stdlib.h>
+#include "lwip/tcp.h"
+#include "wm_osal.h"
+#include "wm_lwip_stats.h"
+#endif
 
 static void show_netif_info(struct netif *netif)
 {
@@ -88,4 +94,155 @@ static void cmd_ifconfig(int argc, char *argv[])
     }
 }
 WM_CLI_CMD_DEFINE(ifconfig, cmd_ifconfig, ifconfig cmd,
-                  ifconfig[if ip mask gw]-- show / set netif info); //cppcheck # [syntaxError]
\ No newline at end of file
+                  ifconfig[if ip mask gw]-- show / set netif info); //cppcheck # [syntaxError]
+
+#if CONFIG_LWIP_STATS
+static const char *const g_netstat_proto_names[WM_LWIP_STATS_PROTO_MAX] = { "LINK", "ETHARP", "IP", "ICMP", "UDP", "TCP" };
+
+static void netstat_show_counters(const wm_lwip_stats_t *stats)
+{
+    int i;
+
+    wm_cli_printf("%-8s %10s %10s %8s %8s %8s %8s\r\n", "proto", "xmit", "recv", "drop", "chkerr", "memerr", "err");
+    for (i = 0; i < WM_LWIP_STATS_PROTO_MAX; i++) {
+        wm_cli_printf("%-8s %10u %10u %8u %8u %8u %8u\r\n", g_netstat_proto_names[i], stats->proto[i].xmit,
+                      stats->proto[i].recv, stats->proto[i].drop, stats->proto[i].chkerr, stats->proto[i].memerr,
+                      stats->proto[i].err);
+    }
+
+    wm_cli_printf("\r\ntcp: active_opens %u passive_opens %u attempt_fails %u estab_resets %u\r\n",
+                  stats->mib2_tcp.active_opens, stats->mib2_tcp.passive_opens, stats->mib2_tcp.attempt_fails,
+                  stats->mib2_tcp.estab_resets);
+    wm_cli_printf("     in_segs %u out_segs %u retrans_segs %u in_errs %u out_rsts %u\r\n", stats->mib2_tcp.in_segs,
+                  stats->mib2_tcp.out_segs, stats->mib2_tcp.retrans_segs, stats->mib2_tcp.in_errs, stats->mib2_tcp.out_rsts);
+
+    wm_cli_printf("\r\nmem: used %u max %u err %u\r\n", stats->mem_used, stats->mem_max, stats->mem_err);
+    wm_cli_printf("%-16s %6s %6s %6s\r\n", "memp", "used", "max", "err");
+    for (i = 0; i < stats->memp_num; i++) {
+        wm_cli_printf("%-16s %6u %6u %6u\r\n", wm_lwip_stats_memp_name(i), stats->memp[i].used, stats->memp[i].max,
+                      stats->memp[i].err);
+    }
+}
+
+static void netstat_show_pcbs(const wm_lwip_stats_pcb_t *pcbs, int num)
+{
+    char local[24];
+    char remote[24];
+    ip4_addr_t addr;
+    int i;
+
+    wm_cli_printf("%-21s %-21s %-11s %6s %6s %6s %5s %5s %6s %6s\r\n", "local", "remote", "state", "snd_wnd", "cwnd",
+                  "rcv_wnd", "unsnt", "unack", "rexmit", "stalls");
+    for (i = 0; i < num; i++) {
+        ip4_addr_set_u32(&addr, pcbs[i].local_ip);
+        snprintf(local, sizeof(local), "%s:%u", ip4addr_ntoa(&addr), pcbs[i].local_port);
+        ip4_addr_set_u32(&addr, pcbs[i].remote_ip);
+        snprintf(remote, sizeof(remote), "%s:%u", ip4addr_ntoa(&addr), pcbs[i].remote_port);
+        wm_cli_printf("%-21s %-21s %-11s %6u %6u %6u %5u %5u %6u %6u\r\n", local, remote,
+                      tcp_debug_state_str((enum tcp_state)pcbs[i].state), pcbs[i].snd_wnd, pcbs[i].cwnd, pcbs[i].rcv_wnd,
+                      pcbs[i].unsent, pcbs[i].unacked, pcbs[i].rexmit, pcbs[i].wnd_stalls);
+    }
+}
+
+static void netstat_show_rate(const wm_lwip_stats_pcb_t *old, int old_num, const wm_lwip_stats_pcb_t *cur, int num,
+                              uint32_t ms)
+{
+    ip4_addr_t addr;
+    uint32_t tx;
+    uint32_t rx;
+    int i, j;
+
+    if (ms == 0) {
+        return;
+    }
+
+    wm_cli_printf("%-21s %10s %10s %6s\r\n", "remote", "tx(kbps)", "rx(kbps)", "rexmit");
+    for (i = 0; i < num; i++) {
+        for (j = 0; j < old_num; j++) {
+            if (old[j].local_port == cur[i].local_port && old[j].remote_port == cur[i].remote_port &&
+                old[j].remote_ip == cur[i].remote_ip) {
+                break;
+            }
+        }
+        if (j == old_num) {
+            continue;
+        }
+
+        /* Acknowledged bytes sent and in order bytes received during the interval */
+        tx = cur[i].lastack - old[j].lastack;
+        rx = cur[i].rcv_nxt - old[j].rcv_nxt;
+        ip4_addr_set_u32(&addr, cur[i].remote_ip);
+        wm_cli_printf("%-15s:%-5u %10u %10u %6u\r\n", ip4addr_ntoa(&addr), cur[i].remote_port,
+                      (uint32_t)((uint64_t)tx * 8 / ms), (uint32_t)((uint64_t)rx * 8 / ms), cur[i].rexmit - old[j].rexmit);
+    }
+}
+
+static void cmd_netstat(int argc, char *argv[])
+{
+    wm_lwip_stats_t *stats    = NULL;
+    wm_lwip_stats_pcb_t *pcbs = NULL;
+    wm_lwip_stats_pcb_t *prev = NULL;
+    uint16_t num              = CONFIG_LWIP_STATS_MAX_PCB;
+    uint16_t prev_num         = CONFIG_LWIP_STATS_MAX_PCB;
+    uint32_t interval_ms      = 1000;
+    uint32_t start;
+
+    if (argc >= 2 && !strcmp(argv[1], "-r")) {
+        wm_cli_printf("%s\r\n", wm_lwip_stats_reset() ? "failed" : "success");
+        return;
+    }
+
+    stats = wm_os_internal_malloc(sizeof(*stats));
+    pcbs  = wm_os_internal_malloc(CONFIG_LWIP_STATS_MAX_PCB * sizeof(*pcbs));
+    if (!stats || !pcbs) {
+        wm_cli_printf("no memory\r\n");
+        goto out;
+    }
+
+    if (argc >= 2 && !strcmp(argv[1], "-s")) {
+        if (argc >= 3) {
+            interval_ms = atoi(argv[2]);
+        }
+
+        prev = wm_os_internal_malloc(CONFIG_LWIP_STATS_MAX_PCB * sizeof(*prev));
+        if (!prev || interval_ms == 0) {
+            wm_cli_printf("%s\r\n", prev ? "invalid interval" : "no memory");
+            goto out;
+        }
+
+        if (wm_lwip_stats_get(stats, prev, &prev_num)) {
+            goto fail;
+        }
+        start = stats->timestamp_ms;
+        wm_os_internal_time_delay_ms(interval_ms);
+        if (wm_lwip_stats_get(stats, pcbs, &num)) {
+            goto fail;
+        }
+        netstat_show_rate(prev, prev_num, pcbs, num, stats->timestamp_ms - start);
+    } else if (argc >= 2 && !strcmp(argv[1], "-t")) {
+        if (wm_lwip_stats_get(stats, pcbs, &num)) {
+            goto fail;
+        }
+        netstat_show_pcbs(pcbs, num);
+        if (stats->pcb_num > num) {
+            wm_cli_printf("%u more connections not shown\r\n", stats->pcb_num - num);
+        }
+    } else {
+        if (wm_lwip_stats_get(stats, NULL, NULL)) {
+            goto fail;
+        }
+        netstat_show_counters(stats);
+    }
+
+    goto out;
+
+fail:
+    wm_cli_printf("failed\r\n");
+out:
+    wm_os_internal_free(stats);
+    wm_os_internal_free(pcbs);
+    wm_os_internal_free(prev);
+}
+WM_CLI_CMD_DEFINE(netstat, cmd_netstat, netstat cmd,
+                  netstat[-t | -s [interval_ms] | -r]-- show counters / connections / throughput or reset peaks);
+#endif
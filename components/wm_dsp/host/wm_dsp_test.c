@@ -0,0 +1,268 @@
+/**
+ * @file wm_dsp_test.c
+ *
+ * @brief DSP Host Test
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "wm_error.h"
+#include "wm_dsp.h"
+
+#define TEST_LEN   1024
+#define TEST_BLOCK 240
+#define TEST_PI    3.14159265358979323846
+
+static int16_t g_in[TEST_LEN];
+static int16_t g_out[TEST_LEN * 4];
+static int16_t g_state[TEST_LEN * 2];
+static int g_fail;
+
+static int16_t test_sat16(double v)
+{
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+static void test_report(const char *name, int ok, const char *detail)
+{
+    printf("%-12s %s %s\n", name, ok ? "PASS" : "FAIL", detail);
+    g_fail += !ok;
+}
+
+static void test_random(int16_t *buf, uint32_t len, int amp)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (int16_t)(rand() % (2 * amp + 1) - amp);
+    }
+}
+
+/* y[n] = sum(h[k] * x[n - k]) truncated like a Q15 accumulator, with h = coeffs reversed */
+static int16_t test_fir_model(const int16_t *x, int32_t n, const int16_t *coeffs, uint32_t tap_num)
+{
+    int64_t acc = 0;
+    uint32_t k;
+
+    for (k = 0; k < tap_num && (int32_t)k <= n; k++) {
+        acc += (int64_t)coeffs[tap_num - 1 - k] * x[n - k];
+    }
+
+    return test_sat16((double)(acc >> 15));
+}
+
+static void test_fir(void)
+{
+    int16_t coeffs[32];
+    wm_dsp_fir_q15_t fir;
+    uint32_t done, len;
+    int bad = 0;
+    int32_t n;
+
+    test_random(coeffs, 32, 4000);
+    test_random(g_in, TEST_LEN, 32767);
+    wm_dsp_fir_q15_init(&fir, coeffs, 32, g_state, TEST_BLOCK);
+
+    /* blocks of several sizes, the state must carry the history */
+    for (done = 0; done < TEST_LEN; done += len) {
+        len = (uint32_t)(rand() % TEST_BLOCK) + 1;
+        len = len > TEST_LEN - done ? TEST_LEN - done : len;
+        wm_dsp_fir_q15(&fir, g_in + done, g_out + done, (uint16_t)len);
+    }
+
+    for (n = 0; n < TEST_LEN; n++) {
+        bad += g_out[n] != test_fir_model(g_in, n, coeffs, 32);
+    }
+
+    test_report("fir", !bad, "");
+}
+
+static void test_biquad(void)
+{
+    /* 2nd order Butterworth low pass at fs / 8, Q14 coefficients with post_shift 1 */
+    double b[3]       = { 0.09763107, 0.19526215, 0.09763107 };
+    double a[2]       = { 0.94280904, -0.33333333 };
+    int16_t coeffs[6] = { 0 };
+    double x1 = 0, x2 = 0, y1 = 0, y2 = 0, y;
+    wm_dsp_biquad_q15_t biquad;
+    char detail[32];
+    int err = 0;
+    int n;
+
+    coeffs[0] = (int16_t)lrint(b[0] * 16384);
+    coeffs[2] = (int16_t)lrint(b[1] * 16384);
+    coeffs[3] = (int16_t)lrint(b[2] * 16384);
+    coeffs[4] = (int16_t)lrint(a[0] * 16384);
+    coeffs[5] = (int16_t)lrint(a[1] * 16384);
+
+    for (n = 0; n < TEST_LEN; n++) {
+        g_in[n] = (int16_t)lrint(12000 * sin(2 * TEST_PI * n / 64) + 6000 * sin(2 * TEST_PI * n / 5));
+    }
+
+    wm_dsp_biquad_q15_init(&biquad, coeffs, 1, g_state, 1);
+    wm_dsp_biquad_q15(&biquad, g_in, g_out, TEST_LEN);
+
+    for (n = 0; n < TEST_LEN; n++) {
+        y  = b[0] * g_in[n] + b[1] * x1 + b[2] * x2 + a[0] * y1 + a[1] * y2;
+        x2 = x1;
+        x1 = g_in[n];
+        y2 = y1;
+        y1 = y;
+        if (abs(g_out[n] - (int)lrint(y)) > err) {
+            err = abs(g_out[n] - (int)lrint(y));
+        }
+    }
+
+    snprintf(detail, sizeof(detail), "max err %d", err);
+    test_report("biquad", err <= 8, detail);
+}
+
+static void test_decimate(void)
+{
+    int16_t coeffs[30];
+    wm_dsp_decimate_q15_t dec;
+    int bad = 0;
+    int32_t n;
+
+    test_random(coeffs, 30, 3000);
+    test_random(g_in, TEST_LEN, 32767);
+    wm_dsp_decimate_q15_init(&dec, 3, coeffs, 30, g_state, TEST_BLOCK);
+
+    for (n = 0; n + TEST_BLOCK <= TEST_LEN; n += TEST_BLOCK) {
+        wm_dsp_decimate_q15(&dec, g_in + n, g_out + n / 3, TEST_BLOCK);
+    }
+
+    for (n = 0; n < TEST_LEN / TEST_BLOCK * TEST_BLOCK / 3; n++) {
+        bad += g_out[n] != test_fir_model(g_in, n * 3, coeffs, 30);
+    }
+
+    test_report("decimate", !bad, "");
+}
+
+static void test_interpolate(void)
+{
+    int16_t coeffs[24];
+    int16_t up[TEST_LEN];
+    wm_dsp_interpolate_q15_t itp;
+    int bad = 0;
+    int32_t n;
+
+    test_random(coeffs, 24, 8000);
+    test_random(g_in, TEST_LEN / 4, 32767);
+    wm_dsp_interpolate_q15_init(&itp, 4, coeffs, 24, g_state, 64);
+
+    for (n = 0; n < TEST_LEN / 4; n += 64) {
+        wm_dsp_interpolate_q15(&itp, g_in + n, g_out + n * 4, 64);
+    }
+
+    /* same as a FIR on the input with 3 zeros inserted after each sample */
+    memset(up, 0, sizeof(up));
+    for (n = 0; n < TEST_LEN / 4; n++) {
+        up[n * 4] = g_in[n];
+    }
+    for (n = 0; n < TEST_LEN; n++) {
+        bad += g_out[n] != test_fir_model(up, n, coeffs, 24);
+    }
+
+    test_report("interpolate", !bad, "");
+}
+
+static void test_rfft(void)
+{
+    int16_t in[4096];
+    int16_t out[4096 + 2];
+    char detail[48];
+    double re, im;
+    uint32_t len, k, n;
+    double err = 0;
+
+    for (len = WM_DSP_FFT_LEN_MIN; len <= WM_DSP_FFT_LEN_MAX; len <<= 1) {
+        test_random(g_in, len > TEST_LEN ? TEST_LEN : len, 16000);
+        for (n = 0; n < len; n++) {
+            in[n] = g_in[n % TEST_LEN];
+        }
+
+        wm_dsp_rfft_q15(len, in, out);
+
+        for (k = 0; k <= len / 2; k += len / 32) {
+            re = im = 0;
+            for (n = 0; n < len; n++) {
+                re += g_in[n % TEST_LEN] * cos(2 * TEST_PI * k * n / len);
+                im -= g_in[n % TEST_LEN] * sin(2 * TEST_PI * k * n / len);
+            }
+            err = fmax(err, fabs(out[2 * k] - re / len));
+            err = fmax(err, fabs(out[2 * k + 1] - im / len));
+        }
+    }
+
+    snprintf(detail, sizeof(detail), "max err %.1f LSB, 32 to 4096 points", err);
+    test_report("rfft", err <= 8 && wm_dsp_rfft_q15(100, in, out) == WM_ERR_INVALID_PARAM, detail);
+}
+
+static void test_stats(void)
+{
+    double sum = 0, sum_sq = 0, var;
+    int16_t max = -32768, min = 32767;
+    uint16_t max_at = 0, min_at = 0, at;
+    int ok = 1;
+    int n;
+
+    test_random(g_in, TEST_LEN, 20000);
+    for (n = 0; n < TEST_LEN; n++) {
+        sum += g_in[n];
+        sum_sq += (double)g_in[n] * g_in[n];
+        if (g_in[n] > max) {
+            max    = g_in[n];
+            max_at = (uint16_t)n;
+        }
+        if (g_in[n] < min) {
+            min    = g_in[n];
+            min_at = (uint16_t)n;
+        }
+    }
+    var = (sum_sq - sum * sum / TEST_LEN) / (TEST_LEN - 1) / 32768;
+
+    ok &= wm_dsp_mean_q15(g_in, TEST_LEN) == (int16_t)(sum / TEST_LEN);
+    ok &= fabs(wm_dsp_var_q15(g_in, TEST_LEN) - var) <= 1;
+    ok &= wm_dsp_max_q15(g_in, TEST_LEN, &at) == max && at == max_at;
+    ok &= wm_dsp_min_q15(g_in, TEST_LEN, &at) == min && at == min_at;
+
+    test_report("statistics", ok, "");
+}
+
+int main(void)
+{
+    srand(1);
+
+    test_fir();
+    test_biquad();
+    test_decimate();
+    test_interpolate();
+    test_rfft();
+    test_stats();
+
+    printf("%s\n", g_fail ? "FAIL" : "PASS");
+
+    return g_fail ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+/**
+ * @file wm_dsp.h
+ *
+ * @brief DSP Module
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_DSP_H__
+#define __WM_DSP_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup WM_DSP_Macros WM DSP Macros
+ * @brief WinnerMicro DSP Macros
+ */
+
+/**
+ * @addtogroup WM_DSP_Macros
+ * @{
+ */
+
+#define WM_DSP_FFT_LEN_MIN 32   /**< min length of the real FFT */
+#define WM_DSP_FFT_LEN_MAX 4096 /**< max length of the real FFT */
+
+/**
+ * @brief Length of the state of a FIR filter or decimator, in samples
+ */
+#define WM_DSP_FIR_STATE_LEN(tap_num, block_size)                 ((tap_num) + (block_size) - 1)
+
+/**
+ * @brief Length of the state of an interpolator, in samples
+ */
+#define WM_DSP_INTERPOLATE_STATE_LEN(tap_num, factor, block_size) ((tap_num) / (factor) + (block_size) - 1)
+
+/**
+ * @brief Length of the state of a biquad cascade, in samples
+ */
+#define WM_DSP_BIQUAD_STATE_LEN(stage_num)                        ((stage_num) * 4)
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_DSP_Structures WM DSP Structures
+ * @brief WinnerMicro DSP Structures
+ */
+
+/**
+ * @addtogroup WM_DSP_Structures
+ * @{
+ */
+
+/**
+ * @brief Q15 FIR filter
+ */
+typedef struct {
+    const int16_t *coeffs; /**< tap_num coefficients in time reversed order, h[tap_num - 1] first */
+    int16_t *state;        /**< WM_DSP_FIR_STATE_LEN samples                                      */
+    uint16_t tap_num;      /**< number of taps, even and at least 4                              */
+    uint16_t block_size;   /**< max samples of one call                                          */
+} wm_dsp_fir_q15_t;
+
+/**
+ * @brief Q15 cascade of direct form I biquads, the IIR filter
+ */
+typedef struct {
+    const int16_t *coeffs; /**< 6 coefficients per stage {b0, 0, b1, b2, a1, a2}, with
+                                y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] + a1 * y[n-1] + a2 * y[n-2],
+                                so a1 and a2 are the negated denominator coefficients             */
+    int16_t *state;        /**< WM_DSP_BIQUAD_STATE_LEN samples                                   */
+    uint8_t stage_num;     /**< number of biquads                                                 */
+    int8_t post_shift;     /**< left shift of the output, to use coefficients over 1.0 [0, 15]   */
+} wm_dsp_biquad_q15_t;
+
+/**
+ * @brief Q15 FIR decimator, filters and keeps one sample of factor
+ */
+typedef struct {
+    const int16_t *coeffs; /**< tap_num coefficients in time reversed order                       */
+    int16_t *state;        /**< WM_DSP_FIR_STATE_LEN samples                                      */
+    uint16_t tap_num;      /**< number of taps                                                    */
+    uint16_t block_size;   /**< max input samples of one call, a multiple of factor               */
+    uint8_t factor;        /**< decimation factor                                                 */
+} wm_dsp_decimate_q15_t;
+
+/**
+ * @brief Q15 FIR interpolator, inserts factor - 1 samples between two input samples and filters
+ */
+typedef struct {
+    const int16_t *coeffs; /**< tap_num coefficients in time reversed order                       */
+    int16_t *state;        /**< WM_DSP_INTERPOLATE_STATE_LEN samples                              */
+    uint16_t tap_num;      /**< number of taps, a multiple of factor                              */
+    uint16_t block_size;   /**< max input samples of one call                                     */
+    uint8_t factor;        /**< interpolation factor                                              */
+} wm_dsp_interpolate_q15_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_DSP_APIs WM DSP APIs
+ * @brief WinnerMicro DSP APIs
+ */
+
+/**
+ * @addtogroup WM_DSP_APIs
+ * @{
+ */
+
+/**
+ * @brief Initialize a Q15 FIR filter, the state is cleared
+ *
+ * @param[out] fir filter
+ * @param[in] coeffs coefficients in time reversed order, referenced by the filter
+ * @param[in] tap_num number of taps, even and at least 4, pad an odd filter with a 0 coefficient
+ * @param[in] state buffer of WM_DSP_FIR_STATE_LEN(tap_num, block_size) samples
+ * @param[in] block_size max samples of one wm_dsp_fir_q15 call
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ */
+int wm_dsp_fir_q15_init(wm_dsp_fir_q15_t *fir, const int16_t *coeffs, uint16_t tap_num, int16_t *state,
+                        uint16_t block_size);
+
+/**
+ * @brief Filter a block with a Q15 FIR filter, y[n] = sum(h[k] * x[n - k]), with a 64 bits accumulator
+ *        and the result saturated to Q15
+ *
+ * @param[in] fir filter
+ * @param[in] in input samples
+ * @param[out] out output samples, can not be in
+ * @param[in] len number of samples, at most block_size
+ */
+void wm_dsp_fir_q15(wm_dsp_fir_q15_t *fir, const int16_t *in, int16_t *out, uint16_t len);
+
+/**
+ * @brief Initialize a Q15 biquad cascade, the state is cleared
+ *
+ * @param[out] biquad filter
+ * @param[in] coeffs 6 coefficients per stage, referenced by the filter
+ * @param[in] stage_num number of biquads
+ * @param[in] state buffer of WM_DSP_BIQUAD_STATE_LEN(stage_num) samples
+ * @param[in] post_shift left shift of the output [0, 15], coefficients are scaled down by 2^post_shift
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ */
+int wm_dsp_biquad_q15_init(wm_dsp_biquad_q15_t *biquad, const int16_t *coeffs, uint8_t stage_num, int16_t *state,
+                           int8_t post_shift);
+
+/**
+ * @brief Filter a block with a Q15 biquad cascade
+ *
+ * @param[in] biquad filter
+ * @param[in] in input samples
+ * @param[out] out output samples, can be in
+ * @param[in] len number of samples
+ */
+void wm_dsp_biquad_q15(wm_dsp_biquad_q15_t *biquad, const int16_t *in, int16_t *out, uint32_t len);
+
+/**
+ * @brief Initialize a Q15 FIR decimator, the state is cleared
+ *
+ * @param[out] dec decimator
+ * @param[in] factor decimation factor
+ * @param[in] coeffs coefficients in time reversed order, referenced by the decimator
+ * @param[in] tap_num number of taps
+ * @param[in] state buffer of WM_DSP_FIR_STATE_LEN(tap_num, block_size) samples
+ * @param[in] block_size max input samples of one call, a multiple of factor
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ */
+int wm_dsp_decimate_q15_init(wm_dsp_decimate_q15_t *dec, uint8_t factor, const int16_t *coeffs, uint16_t tap_num,
+                             int16_t *state, uint16_t block_size);
+
+/**
+ * @brief Decimate a block
+ *
+ * @param[in] dec decimator
+ * @param[in] in input samples
+ * @param[out] out len / factor output samples
+ * @param[in] len number of input samples, a multiple of factor and at most block_size
+ */
+void wm_dsp_decimate_q15(wm_dsp_decimate_q15_t *dec, const int16_t *in, int16_t *out, uint16_t len);
+
+/**
+ * @brief Initialize a Q15 FIR interpolator, the state is cleared
+ *
+ * @param[out] itp interpolator
+ * @param[in] factor interpolation factor
+ * @param[in] coeffs coefficients in time reversed order, referenced by the interpolator,
+ *            the gain must be factor to keep the level
+ * @param[in] tap_num number of taps, a multiple of factor
+ * @param[in] state buffer of WM_DSP_INTERPOLATE_STATE_LEN(tap_num, factor, block_size) samples
+ * @param[in] block_size max input samples of one call
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ */
+int wm_dsp_interpolate_q15_init(wm_dsp_interpolate_q15_t *itp, uint8_t factor, const int16_t *coeffs, uint16_t tap_num,
+                                int16_t *state, uint16_t block_size);
+
+/**
+ * @brief Interpolate a block
+ *
+ * @param[in] itp interpolator
+ * @param[in] in input samples
+ * @param[out] out len * factor output samples
+ * @param[in] len number of input samples, at most block_size
+ */
+void wm_dsp_interpolate_q15(wm_dsp_interpolate_q15_t *itp, const int16_t *in, int16_t *out, uint16_t len);
+
+/**
+ * @brief Real forward FFT of Q15 samples
+ *
+ * @param[in] fft_len number of samples, a power of 2 in [WM_DSP_FFT_LEN_MIN, WM_DSP_FFT_LEN_MAX]
+ * @param[in] in fft_len samples, used as work area and overwritten
+ * @param[out] out fft_len / 2 + 1 complex bins {re, im} from DC to Nyquist, that is fft_len + 2 values,
+ *             scaled down by fft_len
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid length
+ */
+int wm_dsp_rfft_q15(uint32_t fft_len, int16_t *in, int16_t *out);
+
+/**
+ * @brief Mean of Q15 samples, rounded toward 0
+ *
+ * @param[in] in samples
+ * @param[in] len number of samples, at most 65536
+ * @return mean
+ */
+int16_t wm_dsp_mean_q15(const int16_t *in, uint32_t len);
+
+/**
+ * @brief Variance of Q15 samples, sum((x - mean)^2) / (len - 1)
+ *
+ * @param[in] in samples
+ * @param[in] len number of samples, at least 2
+ * @return variance
+ */
+int16_t wm_dsp_var_q15(const int16_t *in, uint32_t len);
+
+/**
+ * @brief Max of Q15 samples
+ *
+ * @param[in] in samples
+ * @param[in] len number of samples, at least 1 and at most 65535
+ * @param[out] index index of the first max, can be NULL
+ * @return max
+ */
+int16_t wm_dsp_max_q15(const int16_t *in, uint16_t len, uint16_t *index);
+
+/**
+ * @brief Min of Q15 samples
+ *
+ * @param[in] in samples
+ * @param[in] len number of samples, at least 1 and at most 65535
+ * @param[out] index index of the first min, can be NULL
+ * @return min
+ */
+int16_t wm_dsp_min_q15(const int16_t *in, uint16_t len, uint16_t *index);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_DSP_H__ */
@@ -0,0 +1,70 @@
+/**
+ * @file wm_dsp_ref.h
+ *
+ * @brief DSP Reference Kernels
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_DSP_REF_H__
+#define __WM_DSP_REF_H__
+
+#include "wm_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup WM_DSP_APIs
+ * @{
+ */
+
+/*
+ * Portable C versions of the wm_dsp kernels, with the same arguments. The DSP benchmark checks that the results
+ * are identical, except wm_dsp_ref_rfft_q15 which rounds differently and is allowed DSP_FFT_ERR_MAX (8) LSB.
+ * They are the kernels of the host build, and the reference of the DSP benchmark.
+ */
+
+void wm_dsp_ref_fir_q15(wm_dsp_fir_q15_t *fir, const int16_t *in, int16_t *out, uint16_t len);
+
+void wm_dsp_ref_biquad_q15(wm_dsp_biquad_q15_t *biquad, const int16_t *in, int16_t *out, uint32_t len);
+
+void wm_dsp_ref_decimate_q15(wm_dsp_decimate_q15_t *dec, const int16_t *in, int16_t *out, uint16_t len);
+
+void wm_dsp_ref_interpolate_q15(wm_dsp_interpolate_q15_t *itp, const int16_t *in, int16_t *out, uint16_t len);
+
+void wm_dsp_ref_rfft_q15(uint32_t fft_len, int16_t *in, int16_t *out);
+
+int16_t wm_dsp_ref_mean_q15(const int16_t *in, uint32_t len);
+
+int16_t wm_dsp_ref_var_q15(const int16_t *in, uint32_t len);
+
+int16_t wm_dsp_ref_max_q15(const int16_t *in, uint16_t len, uint16_t *index);
+
+int16_t wm_dsp_ref_min_q15(const int16_t *in, uint16_t len, uint16_t *index);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_DSP_REF_H__ */
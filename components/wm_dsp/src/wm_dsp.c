@@ -0,0 +1,249 @@
+/**
+ * @file wm_dsp.c
+ *
+ * @brief DSP Module
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+
+#include "wm_error.h"
+#include "wm_dsp.h"
+
+/* WM_DSP_HOST builds the reference kernels in place of csi_dsp, to check the results on a PC */
+#ifdef WM_DSP_HOST
+#include "wm_dsp_ref.h"
+#else
+#include "core_804.h"
+#include "csi_gcc.h"
+#include "csi_dsp/csi_math.h"
+#include "csi_dsp/csi_const_structs.h"
+
+static const csi_rfft_instance_q15 *const g_wm_dsp_rfft_q15[] = {
+    &csi_rfft_sR_q15_len32,  &csi_rfft_sR_q15_len64,   &csi_rfft_sR_q15_len128,  &csi_rfft_sR_q15_len256,
+    &csi_rfft_sR_q15_len512, &csi_rfft_sR_q15_len1024, &csi_rfft_sR_q15_len2048, &csi_rfft_sR_q15_len4096,
+};
+#endif
+
+int wm_dsp_fir_q15_init(wm_dsp_fir_q15_t *fir, const int16_t *coeffs, uint16_t tap_num, int16_t *state,
+                        uint16_t block_size)
+{
+    if (!fir || !coeffs || !state || tap_num < 4 || (tap_num & 1) || !block_size) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    fir->coeffs     = coeffs;
+    fir->state      = state;
+    fir->tap_num    = tap_num;
+    fir->block_size = block_size;
+    memset(state, 0, WM_DSP_FIR_STATE_LEN(tap_num, block_size) * sizeof(int16_t));
+
+    return WM_ERR_SUCCESS;
+}
+
+void wm_dsp_fir_q15(wm_dsp_fir_q15_t *fir, const int16_t *in, int16_t *out, uint16_t len)
+{
+#ifdef WM_DSP_HOST
+    wm_dsp_ref_fir_q15(fir, in, out, len);
+#else
+    csi_fir_instance_q15 inst = { .numTaps = fir->tap_num, .pState = fir->state, .pCoeffs = fir->coeffs };
+
+    csi_fir_q15(&inst, in, out, len);
+#endif
+}
+
+int wm_dsp_biquad_q15_init(wm_dsp_biquad_q15_t *biquad, const int16_t *coeffs, uint8_t stage_num, int16_t *state,
+                           int8_t post_shift)
+{
+    if (!biquad || !coeffs || !state || !stage_num || stage_num > INT8_MAX || post_shift < 0 || post_shift > 15) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    biquad->coeffs     = coeffs;
+    biquad->state      = state;
+    biquad->stage_num  = stage_num;
+    biquad->post_shift = post_shift;
+    memset(state, 0, WM_DSP_BIQUAD_STATE_LEN(stage_num) * sizeof(int16_t));
+
+    return WM_ERR_SUCCESS;
+}
+
+void wm_dsp_biquad_q15(wm_dsp_biquad_q15_t *biquad, const int16_t *in, int16_t *out, uint32_t len)
+{
+#ifdef WM_DSP_HOST
+    wm_dsp_ref_biquad_q15(biquad, in, out, len);
+#else
+    csi_biquad_casd_df1_inst_q15 inst = {
+        .numStages = (int8_t)biquad->stage_num,
+        .pState    = biquad->state,
+        .pCoeffs   = biquad->coeffs,
+        .postShift = biquad->post_shift,
+    };
+
+    csi_biquad_cascade_df1_q15(&inst, in, out, len);
+#endif
+}
+
+int wm_dsp_decimate_q15_init(wm_dsp_decimate_q15_t *dec, uint8_t factor, const int16_t *coeffs, uint16_t tap_num,
+                             int16_t *state, uint16_t block_size)
+{
+    if (!dec || !coeffs || !state || !factor || !tap_num || !block_size || block_size % factor) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    dec->coeffs     = coeffs;
+    dec->state      = state;
+    dec->tap_num    = tap_num;
+    dec->block_size = block_size;
+    dec->factor     = factor;
+    memset(state, 0, WM_DSP_FIR_STATE_LEN(tap_num, block_size) * sizeof(int16_t));
+
+    return WM_ERR_SUCCESS;
+}
+
+void wm_dsp_decimate_q15(wm_dsp_decimate_q15_t *dec, const int16_t *in, int16_t *out, uint16_t len)
+{
+#ifdef WM_DSP_HOST
+    wm_dsp_ref_decimate_q15(dec, in, out, len);
+#else
+    csi_fir_decimate_instance_q15 inst = {
+        .M       = dec->factor,
+        .numTaps = dec->tap_num,
+        .pCoeffs = dec->coeffs,
+        .pState  = dec->state,
+    };
+
+    csi_fir_decimate_q15(&inst, in, out, len);
+#endif
+}
+
+int wm_dsp_interpolate_q15_init(wm_dsp_interpolate_q15_t *itp, uint8_t factor, const int16_t *coeffs, uint16_t tap_num,
+                                int16_t *state, uint16_t block_size)
+{
+    if (!itp || !coeffs || !state || !factor || !tap_num || tap_num % factor || !block_size) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    itp->coeffs     = coeffs;
+    itp->state      = state;
+    itp->tap_num    = tap_num;
+    itp->block_size = block_size;
+    itp->factor     = factor;
+    memset(state, 0, WM_DSP_INTERPOLATE_STATE_LEN(tap_num, factor, block_size) * sizeof(int16_t));
+
+    return WM_ERR_SUCCESS;
+}
+
+void wm_dsp_interpolate_q15(wm_dsp_interpolate_q15_t *itp, const int16_t *in, int16_t *out, uint16_t len)
+{
+#ifdef WM_DSP_HOST
+    wm_dsp_ref_interpolate_q15(itp, in, out, len);
+#else
+    csi_fir_interpolate_instance_q15 inst = {
+        .L           = itp->factor,
+        .phaseLength = itp->tap_num / itp->factor,
+        .pCoeffs     = itp->coeffs,
+        .pState      = itp->state,
+    };
+
+    csi_fir_interpolate_q15(&inst, in, out, len);
+#endif
+}
+
+int wm_dsp_rfft_q15(uint32_t fft_len, int16_t *in, int16_t *out)
+{
+    uint32_t order = 0;
+
+    if (!in || !out || fft_len < WM_DSP_FFT_LEN_MIN || fft_len > WM_DSP_FFT_LEN_MAX || (fft_len & (fft_len - 1))) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    while (((uint32_t)WM_DSP_FFT_LEN_MIN << order) < fft_len) {
+        order++;
+    }
+
+#ifdef WM_DSP_HOST
+    (void)order;
+    wm_dsp_ref_rfft_q15(fft_len, in, out);
+#else
+    csi_rfft_q15(g_wm_dsp_rfft_q15[order], in, out);
+#endif
+
+    return WM_ERR_SUCCESS;
+}
+
+int16_t wm_dsp_mean_q15(const int16_t *in, uint32_t len)
+{
+#ifdef WM_DSP_HOST
+    return wm_dsp_ref_mean_q15(in, len);
+#else
+    q15_t result;
+
+    csi_mean_q15(in, len, &result);
+
+    return result;
+#endif
+}
+
+int16_t wm_dsp_var_q15(const int16_t *in, uint32_t len)
+{
+#ifdef WM_DSP_HOST
+    return wm_dsp_ref_var_q15(in, len);
+#else
+    q15_t result;
+
+    csi_var_q15(in, len, &result);
+
+    return result;
+#endif
+}
+
+int16_t wm_dsp_max_q15(const int16_t *in, uint16_t len, uint16_t *index)
+{
+#ifdef WM_DSP_HOST
+    return wm_dsp_ref_max_q15(in, len, index);
+#else
+    uint16_t at = 0;
+    q15_t result;
+
+    csi_max_q15(in, len, &result, &at);
+    if (index) {
+        *index = at;
+    }
+
+    return result;
+#endif
+}
+
+int16_t wm_dsp_min_q15(const int16_t *in, uint16_t len, uint16_t *index)
+{
+#ifdef WM_DSP_HOST
+    return wm_dsp_ref_min_q15(in, len, index);
+#else
+    uint16_t at = 0;
+    q15_t result;
+
+    csi_min_q15(in, len, &result, &at);
+    if (index) {
+        *index = at;
+    }
+
+    return result;
+#endif
+}
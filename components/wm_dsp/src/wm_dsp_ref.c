@@ -0,0 +1,275 @@
+/**
+ * @file wm_dsp_ref.c
+ *
+ * @brief DSP Reference Kernels
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "wm_dsp_ref.h"
+
+#define WM_DSP_REF_PI 3.14159265358979323846
+
+static inline int16_t wm_dsp_ref_sat16(int64_t v)
+{
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+void wm_dsp_ref_fir_q15(wm_dsp_fir_q15_t *fir, const int16_t *in, int16_t *out, uint16_t len)
+{
+    int16_t *state = fir->state;
+    uint32_t n, k;
+    int64_t acc;
+
+    /* the window of output n is state[n, n + tap_num), its last sample is in[n] */
+    memcpy(state + fir->tap_num - 1, in, len * sizeof(int16_t));
+
+    for (n = 0; n < len; n++) {
+        acc = 0;
+        for (k = 0; k < fir->tap_num; k++) {
+            acc += (int32_t)state[n + k] * fir->coeffs[k];
+        }
+        out[n] = wm_dsp_ref_sat16(acc >> 15);
+    }
+
+    memmove(state, state + len, (fir->tap_num - 1) * sizeof(int16_t));
+}
+
+void wm_dsp_ref_biquad_q15(wm_dsp_biquad_q15_t *biquad, const int16_t *in, int16_t *out, uint32_t len)
+{
+    const int16_t *c   = biquad->coeffs;
+    int16_t *st        = biquad->state;
+    const int16_t *src = in;
+    int32_t x0, x1, x2, y1, y2;
+    uint32_t n;
+    uint8_t s;
+    int64_t acc;
+
+    for (s = 0; s < biquad->stage_num; s++, c += 6, st += 4) {
+        x1 = st[0];
+        x2 = st[1];
+        y1 = st[2];
+        y2 = st[3];
+
+        for (n = 0; n < len; n++) {
+            x0  = src[n];
+            acc = (int64_t)c[0] * x0 + (int64_t)c[2] * x1 + (int64_t)c[3] * x2 + (int64_t)c[4] * y1 +
+                  (int64_t)c[5] * y2;
+            x2     = x1;
+            x1     = x0;
+            y2     = y1;
+            y1     = wm_dsp_ref_sat16(acc >> (15 - biquad->post_shift));
+            out[n] = (int16_t)y1;
+        }
+
+        st[0] = (int16_t)x1;
+        st[1] = (int16_t)x2;
+        st[2] = (int16_t)y1;
+        st[3] = (int16_t)y2;
+        src   = out;
+    }
+}
+
+void wm_dsp_ref_decimate_q15(wm_dsp_decimate_q15_t *dec, const int16_t *in, int16_t *out, uint16_t len)
+{
+    int16_t *state = dec->state;
+    uint32_t n, k;
+    int64_t acc;
+
+    /* the window of output n ends at in[n * factor] */
+    memcpy(state + dec->tap_num - 1, in, len * sizeof(int16_t));
+
+    for (n = 0; n < (uint32_t)len / dec->factor; n++) {
+        acc = 0;
+        for (k = 0; k < dec->tap_num; k++) {
+            acc += (int32_t)state[n * dec->factor + k] * dec->coeffs[k];
+        }
+        out[n] = wm_dsp_ref_sat16(acc >> 15);
+    }
+
+    memmove(state, state + len, (dec->tap_num - 1) * sizeof(int16_t));
+}
+
+void wm_dsp_ref_interpolate_q15(wm_dsp_interpolate_q15_t *itp, const int16_t *in, int16_t *out, uint16_t len)
+{
+    uint32_t phase_len = itp->tap_num / itp->factor;
+    int16_t *state     = itp->state;
+    uint32_t n, j, k;
+    int64_t acc;
+
+    /* output phase j of input n uses the coefficients factor - 1 - j, 2 * factor - 1 - j, ... */
+    memcpy(state + phase_len - 1, in, len * sizeof(int16_t));
+
+    for (n = 0; n < len; n++) {
+        for (j = 0; j < itp->factor; j++) {
+            acc = 0;
+            for (k = 0; k < phase_len; k++) {
+                acc += (int32_t)state[n + k] * itp->coeffs[itp->factor - 1 - j + k * itp->factor];
+            }
+            *out++ = wm_dsp_ref_sat16(acc >> 15);
+        }
+    }
+
+    memmove(state, state + len, (phase_len - 1) * sizeof(int16_t));
+}
+
+/* in place radix 2 complex FFT of Q15 {re, im} pairs, scaled down by 2 at each stage */
+static void wm_dsp_ref_cfft_q15(int16_t *buf, uint32_t len)
+{
+    uint32_t i, j, k, half, step;
+    int32_t wr, wi, tr, ti, ar, ai;
+    int16_t t;
+
+    for (i = 1, j = 0; i < len; i++) {
+        for (k = len >> 1; j & k; k >>= 1) {
+            j ^= k;
+        }
+        j |= k;
+        if (i < j) {
+            t              = buf[2 * i];
+            buf[2 * i]     = buf[2 * j];
+            buf[2 * j]     = t;
+            t              = buf[2 * i + 1];
+            buf[2 * i + 1] = buf[2 * j + 1];
+            buf[2 * j + 1] = t;
+        }
+    }
+
+    for (half = 1; half < len; half <<= 1) {
+        step = len / (half * 2);
+        for (k = 0; k < half; k++) {
+            wr = (int32_t)lrint(cos(2 * WM_DSP_REF_PI * k * step / len) * 32767);
+            wi = (int32_t)lrint(-sin(2 * WM_DSP_REF_PI * k * step / len) * 32767);
+
+            for (i = k; i < len; i += half * 2) {
+                j  = i + half;
+                tr = (int32_t)(((int64_t)buf[2 * j] * wr - (int64_t)buf[2 * j + 1] * wi) >> 15);
+                ti = (int32_t)(((int64_t)buf[2 * j] * wi + (int64_t)buf[2 * j + 1] * wr) >> 15);
+                ar = buf[2 * i];
+                ai = buf[2 * i + 1];
+
+                buf[2 * i]     = (int16_t)((ar + tr) >> 1);
+                buf[2 * i + 1] = (int16_t)((ai + ti) >> 1);
+                buf[2 * j]     = (int16_t)((ar - tr) >> 1);
+                buf[2 * j + 1] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+void wm_dsp_ref_rfft_q15(uint32_t fft_len, int16_t *in, int16_t *out)
+{
+    uint32_t half = fft_len / 2;
+    int32_t er, ei, dr, di, wr, wi;
+    uint32_t k, m;
+
+    /* the even and odd samples as one complex sequence of half the length */
+    wm_dsp_ref_cfft_q15(in, half);
+
+    /* split it into the spectrum of the real sequence, with one more halving */
+    for (k = 0; k <= half; k++) {
+        m  = (half - k) % half;
+        er = in[2 * (k % half)] + in[2 * m];
+        ei = in[2 * (k % half) + 1] - in[2 * m + 1];
+        dr = in[2 * (k % half)] - in[2 * m];
+        di = in[2 * (k % half) + 1] + in[2 * m + 1];
+        wr = (int32_t)lrint(cos(2 * WM_DSP_REF_PI * k / fft_len) * 32767);
+        wi = (int32_t)lrint(-sin(2 * WM_DSP_REF_PI * k / fft_len) * 32767);
+
+        /* X[k] = (E - j * W^k * D) / 2, D is (Z[k] - conj(Z[half - k])) */
+        out[2 * k]     = (int16_t)((er + (int32_t)(((int64_t)wr * di + (int64_t)wi * dr) >> 15)) >> 2);
+        out[2 * k + 1] = (int16_t)((ei - (int32_t)(((int64_t)wr * dr - (int64_t)wi * di) >> 15)) >> 2);
+    }
+}
+
+int16_t wm_dsp_ref_mean_q15(const int16_t *in, uint32_t len)
+{
+    int32_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        sum += in[i];
+    }
+
+    return (int16_t)(sum / (int32_t)len);
+}
+
+int16_t wm_dsp_ref_var_q15(const int16_t *in, uint32_t len)
+{
+    int64_t sum_sq = 0;
+    int32_t sum    = 0;
+    int32_t mean_sq, sq_mean;
+    uint32_t i;
+
+    if (len <= 1) {
+        return 0;
+    }
+
+    for (i = 0; i < len; i++) {
+        sum += in[i];
+        sum_sq += (int32_t)in[i] * in[i];
+    }
+
+    mean_sq = (int32_t)(sum_sq / (int64_t)(len - 1));
+    sq_mean = (int32_t)((int64_t)sum * sum / (int64_t)(len * (len - 1)));
+
+    return (int16_t)((mean_sq - sq_mean) >> 15);
+}
+
+int16_t wm_dsp_ref_max_q15(const int16_t *in, uint16_t len, uint16_t *index)
+{
+    int16_t max = in[0];
+    uint16_t at = 0;
+    uint16_t i;
+
+    for (i = 1; i < len; i++) {
+        if (in[i] > max) {
+            max = in[i];
+            at  = i;
+        }
+    }
+
+    if (index) {
+        *index = at;
+    }
+
+    return max;
+}
+
+int16_t wm_dsp_ref_min_q15(const int16_t *in, uint16_t len, uint16_t *index)
+{
+    int16_t min = in[0];
+    uint16_t at = 0;
+    uint16_t i;
+
+    for (i = 1; i < len; i++) {
+        if (in[i] < min) {
+            min = in[i];
+            at  = i;
+        }
+    }
+
+    if (index) {
+        *index = at;
+    }
+
+    return min;
+}
@@ -132,6 +132,9 @@ int wm_dt_set_device_table_name(const char *default_name);
  * @return
  *    - WM_ERR_SUCCESS : succeed
  *    - others         : failed
+ *
+ * @note      The device leaves the device list but its memory is kept,
+ *            it is reused when a device of the same name is got again.
  */
 int wm_dt_free_device_by_name(const char *device_name);
 
@@ -143,6 +146,9 @@ int wm_dt_free_device_by_name(const char *device_name);
  * @return
  *    - WM_ERR_SUCCESS : succeed
  *    - others         : failed
+ *
+ * @note      The device leaves the device list but its memory is kept,
+ *            it is reused when a device of the same name is got again.
  */
 int wm_dt_free_device(wm_device_t *device);
 
@@ -152,6 +158,9 @@ int wm_dt_free_device(wm_device_t *device);
  * @return
  *    - WM_ERR_SUCCESS : succeed
  *    - others         : failed
+ *
+ * @note      The devices leave the device list but their memory is kept,
+ *            each one is reused when a device of the same name is got again.
  */
 int wm_dt_free_all_device(void);
 
@@ -103,6 +103,20 @@ static DEFINE_DL_LIST(g_dt_dev_list);
 
 static wm_os_mutex_t *g_dt_dev_mutex = NULL;
 
+/*
+ * Direct-mapped cache of the devices in g_dt_dev_list, indexed by the hash of the name.
+ * It is read without the mutex: a slot is a single aligned pointer, stored under the mutex
+ * once the device is complete. A reader may still be comparing the name of a device being
+ * freed, so devices are never given back to the heap: wm_dt_free_device* park them in
+ * g_dt_dev_retired and dt_add_device reuses them for the same name, which bounds the
+ * memory kept by the number of devices in the dt table.
+ */
+#define WM_DT_CACHE_SIZE 32 /* power of 2 */
+
+static wm_device_t *volatile g_dt_dev_cache[WM_DT_CACHE_SIZE];
+
+static DEFINE_DL_LIST(g_dt_dev_retired);
+
 static char *g_dt_table_name                     = NULL;
 static uint32_t g_dt_entry_count                 = 0;
 static struct wm_dt_table_entry *g_dt_table_addr = NULL;
@@ -172,6 +186,69 @@ static inline int dt_init_device(wm_device_t *dev)
     return ret;
 }
 
+static inline uint32_t dt_cache_index(const char *device_name)
+{
+    uint32_t hash = 5381;
+
+    while (*device_name) {
+        hash = hash * 33 + (uint8_t)*device_name++;
+    }
+
+    return hash & (WM_DT_CACHE_SIZE - 1);
+}
+
+/* called without g_dt_dev_mutex, the device may be retired meanwhile but stays in memory */
+static inline wm_device_t *dt_cache_get(const char *device_name)
+{
+    wm_device_t *dev = g_dt_dev_cache[dt_cache_index(device_name)];
+
+    if (dev && (dev->name == device_name || !strcmp(dev->name, device_name))) {
+        return dev;
+    }
+
+    return NULL;
+}
+
+/* called with g_dt_dev_mutex held */
+static inline void dt_cache_put(wm_device_t *dev)
+{
+    g_dt_dev_cache[dt_cache_index(dev->name)] = dev;
+}
+
+/* called with g_dt_dev_mutex held */
+static inline void dt_cache_del(wm_device_t *dev)
+{
+    uint32_t index = dt_cache_index(dev->name);
+
+    if (g_dt_dev_cache[index] == dev) {
+        g_dt_dev_cache[index] = NULL;
+    }
+}
+
+/* called with g_dt_dev_mutex held, move a device of g_dt_dev_list to g_dt_dev_retired */
+static inline void dt_retire_device(struct wm_dt_device_t *dev)
+{
+    dl_list_del(&dev->node);
+    dt_cache_del(dev->dev);
+    dl_list_add(&g_dt_dev_retired, &dev->node);
+}
+
+/* called with g_dt_dev_mutex held, take back a retired device of the same name */
+static inline struct wm_dt_device_t *dt_reuse_device(const char *device_name)
+{
+    struct wm_dt_device_t *dev = NULL;
+
+    dl_list_for_each(dev, &g_dt_dev_retired, struct wm_dt_device_t, node)
+    {
+        if (!strcmp((char *)dev->dev->name, device_name)) {
+            dl_list_del(&dev->node);
+            return dev;
+        }
+    }
+
+    return NULL;
+}
+
 static inline struct wm_dt_device_t *dt_get_device(const char *device_name)
 {
     struct wm_dt_device_t *dev = NULL;
@@ -193,23 +270,35 @@ static inline struct wm_dt_device_t *dt_add_device(struct wm_dt_table_entry *tab
 {
     struct wm_dt_device_t *dev = NULL;
 
-    dev = wm_os_internal_malloc(sizeof(struct wm_dt_device_t));
-    if (!dev) {
-        wm_log_error("mem not enough");
-        return NULL;
-    }
+    WM_DT_LIST_LOCK(g_dt_dev_mutex, NULL);
+    dev = dt_reuse_device(table_entry->dev_name);
+    WM_DT_LIST_UNLOCK(g_dt_dev_mutex, NULL);
 
-    memset(dev, 0, sizeof(struct wm_dt_device_t));
-    dl_list_init(&dev->node);
+    if (dev) {
+        /* a lookup may still be comparing its name, keep it and reset the rest */
+        dev->dev->drv   = NULL;
+        dev->dev->state = WM_DEV_ST_UNINIT;
+        dev->dev->priv  = NULL;
+    } else {
+        dev = wm_os_internal_malloc(sizeof(struct wm_dt_device_t));
+        if (!dev) {
+            wm_log_error("mem not enough");
+            return NULL;
+        }
 
-    dev->dev = wm_os_internal_malloc(sizeof(wm_device_t));
-    if (!dev->dev) {
-        wm_log_error("mem not enough");
-        wm_os_internal_free(dev);
-        return NULL;
+        memset(dev, 0, sizeof(struct wm_dt_device_t));
+
+        dev->dev = wm_os_internal_malloc(sizeof(wm_device_t));
+        if (!dev->dev) {
+            wm_log_error("mem not enough");
+            wm_os_internal_free(dev);
+            return NULL;
+        }
+
+        memset(dev->dev, 0, sizeof(wm_device_t));
     }
 
-    memset(dev->dev, 0, sizeof(wm_device_t));
+    dl_list_init(&dev->node);
 
     dev->dev->name = table_entry->dev_name;
     dev->dev->hw   = table_entry->hw_addr;
@@ -219,6 +308,7 @@ static inline struct wm_dt_device_t *dt_add_device(struct wm_dt_table_entry *tab
     if (add2list) {
         WM_DT_LIST_LOCK(g_dt_dev_mutex, NULL);
         dl_list_add(&g_dt_dev_list, &dev->node);
+        dt_cache_put(dev->dev);
         WM_DT_LIST_UNLOCK(g_dt_dev_mutex, NULL);
     }
 
@@ -246,26 +336,34 @@ wm_device_t *wm_dt_get_device_by_name(const char *device_name)
     uint32_t i;
     struct wm_dt_table_entry *table_entry = NULL;
     struct wm_dt_table_index *table_index = (struct wm_dt_table_index *)(&wm_dt_table_start);
+    wm_device_t *device                   = NULL;
 
     if (!device_name) {
         return NULL;
     }
 
-    /* 1. get from ram list */
+    /* 1. get from the cache, without lock */
+    device = dt_cache_get(device_name);
+    if (device) {
+        return device;
+    }
+
+    /* 2. get from ram list */
     WM_DT_LIST_LOCK(g_dt_dev_mutex, NULL);
     dl_list_for_each(dev, &g_dt_dev_list, struct wm_dt_device_t, node)
     {
         if (!strcmp((char *)dev->dev->name, device_name)) {
+            dt_cache_put(dev->dev);
             WM_DT_LIST_UNLOCK(g_dt_dev_mutex, NULL);
             return dev->dev;
         }
     }
     WM_DT_LIST_UNLOCK(g_dt_dev_mutex, NULL);
 
-    /* 2. find valid dt table */
+    /* 3. find valid dt table */
     DT_CHECK_DEFAULT_TABLE_ENTRY(NULL);
 
-    /* 3. find dev info in the dt table */
+    /* 4. find dev info in the dt table */
     table_entry = NULL;
     for (i = 0; i < g_dt_entry_count; i++) {
         if (!strcmp(g_dt_table_addr[i].dev_name, device_name)) {
@@ -279,7 +377,7 @@ wm_device_t *wm_dt_get_device_by_name(const char *device_name)
         return NULL;
     }
 
-    /* 4. alloc device struct and fill hw and ops addr */
+    /* 5. alloc device struct, or reuse a retired one, and fill hw and ops addr */
     dev = dt_add_device(table_entry, true);
 
     return dev ? dev->dev : NULL;
@@ -341,19 +439,13 @@ int wm_dt_free_device_by_name(const char *device_name)
     dl_list_for_each_safe(dev, next, &g_dt_dev_list, struct wm_dt_device_t, node)
     {
         if (!strcmp((char *)dev->dev->name, device_name)) {
-            dl_list_del(&dev->node);
-            WM_DT_LIST_UNLOCK(g_dt_dev_mutex, WM_ERR_FAILED);
+            dt_retire_device(dev);
             found = true;
             break;
         }
     }
 
-    if (found) {
-        wm_os_internal_free(dev->dev);
-        wm_os_internal_free(dev);
-    } else {
-        WM_DT_LIST_UNLOCK(g_dt_dev_mutex, WM_ERR_FAILED);
-    }
+    WM_DT_LIST_UNLOCK(g_dt_dev_mutex, WM_ERR_FAILED);
 
     return found ? WM_ERR_SUCCESS : WM_ERR_NOT_FOUND;
 }
@@ -372,19 +464,13 @@ int wm_dt_free_device(wm_device_t *device)
     dl_list_for_each_safe(dev, next, &g_dt_dev_list, struct wm_dt_device_t, node)
     {
         if (device == dev->dev) {
-            dl_list_del(&dev->node);
-            WM_DT_LIST_UNLOCK(g_dt_dev_mutex, WM_ERR_FAILED);
+            dt_retire_device(dev);
             found = true;
             break;
         }
     }
 
-    if (found) {
-        wm_os_internal_free(dev->dev);
-        wm_os_internal_free(dev);
-    } else {
-        WM_DT_LIST_UNLOCK(g_dt_dev_mutex, WM_ERR_FAILED);
-    }
+    WM_DT_LIST_UNLOCK(g_dt_dev_mutex, WM_ERR_FAILED);
 
     return found ? WM_ERR_SUCCESS : WM_ERR_NOT_FOUND;
 }
@@ -398,10 +484,7 @@ int wm_dt_free_all_device(void)
 
     dl_list_for_each_safe(dev, next, &g_dt_dev_list, struct wm_dt_device_t, node)
     {
-        dl_list_del(&dev->node);
-
-        wm_os_internal_free(dev->dev);
-        wm_os_internal_free(dev);
+        dt_retire_device(dev);
     }
 
     WM_DT_LIST_UNLOCK(g_dt_dev_mutex, WM_ERR_FAILED);
@@ -459,6 +542,7 @@ int wm_dt_auto_init_device(void)
             } else {
                 WM_DT_LIST_LOCK_GOTO(g_dt_dev_mutex, WM_ERR_NO_MEM);
                 dl_list_del(&dev->node);
+                dt_cache_del(dev->dev);
                 WM_DT_LIST_UNLOCK_GOTO(g_dt_dev_mutex, WM_ERR_NO_MEM);
             }
 
@@ -492,6 +576,7 @@ int wm_dt_auto_init_device(void)
 
         WM_DT_LIST_LOCK_GOTO(g_dt_dev_mutex, WM_ERR_NO_MEM);
         dl_list_add(&g_dt_dev_list, &dev->node);
+        dt_cache_put(dev->dev);
         WM_DT_LIST_UNLOCK_GOTO(g_dt_dev_mutex, WM_ERR_NO_MEM);
     }
 
@@ -500,11 +585,13 @@ int wm_dt_auto_init_device(void)
     return WM_ERR_SUCCESS;
 
 err:
+    /* some may have been cached before, retire them rather than free them */
+    WM_DT_LIST_LOCK(g_dt_dev_mutex, ret);
     dl_list_for_each_safe(dev, next, &dev_list, struct wm_dt_device_t, node)
     {
-        dl_list_del(&dev->node);
-        wm_os_internal_free(dev);
+        dt_retire_device(dev);
     }
+    WM_DT_LIST_UNLOCK(g_dt_dev_mutex, ret);
 
     return ret;
 }
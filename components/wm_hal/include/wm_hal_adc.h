@@ -155,6 +155,37 @@ int wm_hal_adc_start_dma(wm_hal_adc_dev_t *adc_dev, int *buf, uint32_t len, uint
   */
 int wm_hal_adc_stop_dma(wm_hal_adc_dev_t *adc_dev, uint8_t dma_ch);
 
+/**
+  * @brief Start adc converting continuously with dma requests enabled, the dma is configured by the caller.
+  *
+  * @param[in] dev use @arg wm_hal_adc_dev_t, initialized by wm_hal_adc_init
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - others: failed
+  */
+int wm_hal_adc_start_continuous(wm_hal_adc_dev_t *dev);
+
+/**
+  * @brief Switch the converted channel of continuous conversion, the filter restarts on the new channel.
+  *
+  * @param[in] dev use @arg wm_hal_adc_dev_t
+  * @param[in] channel use @arg wm_adc_channel_t
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - others: failed
+  */
+int wm_hal_adc_switch_channel(wm_hal_adc_dev_t *dev, wm_adc_channel_t channel);
+
+/**
+  * @brief Stop adc continuous conversion.
+  *
+  * @param[in] dev use @arg wm_hal_adc_dev_t
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - others: failed
+  */
+int wm_hal_adc_stop_continuous(wm_hal_adc_dev_t *dev);
+
 /**
   * @brief Adc get polling data.
   *
@@ -133,6 +133,20 @@ int wm_hal_flash_read_sectors(wm_hal_flash_dev_t *dev, uint32_t flash_addr, uint
   */
 int wm_hal_flash_erase_sectors(wm_hal_flash_dev_t *dev, uint32_t flash_addr, uint32_t sector_num);
 
+/**
+  * @brief  erase one 32K or 64K block
+  *
+  * @param dev  flash device object pointer
+  * @param flash_addr the flash address will be erased, aligned with block_size
+  * @param block_size 32 * 1024 or 64 * 1024
+  *
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - WM_ERR_INVALID_PARAM: invalid argument
+  *    - WM_ERR_NO_SUPPORT: the flash chip has no erase command for this block size
+  */
+int wm_hal_flash_erase_block(wm_hal_flash_dev_t *dev, uint32_t flash_addr, uint32_t block_size);
+
 /**
   * @brief erase whole chip
   *
@@ -53,6 +53,8 @@ typedef struct {
     flash_cmd_t prscur;    //program secturity register
     flash_cmd_t pe;        //page erase
     flash_cmd_t se;        //sectore erase
+    flash_cmd_t be;        //32K block erase
+    flash_cmd_t hbe;       //64K block erase
     flash_cmd_t ce;        //chip erase
     flash_cmd_t read;      //read data
     flash_cmd_t fread;     //fast read
@@ -88,6 +90,8 @@ static const wm_flash_t wm_iflash_chip_p25q = {
         .prscur = {0x42, 0},
         .pe = {0x81, 0},
         .se = {0x20, 0},
+        .be = {0x52, 0},
+        .hbe = {0xD8, 0},
         .ce = {0x60, 0},
         .read = {0x3, 0},
         .fread = {0xB, 1},
@@ -113,6 +117,8 @@ static const wm_flash_t wm_iflash_chip_th25q = {
         .prscur = {0x42, 0},
         .pe = {0x81, 0},
         .se = {0x20, 0},
+        .be = {0x52, 0},
+        .hbe = {0xD8, 0},
         .ce = {0x60, 0},
         .read = {0x3, 0},
         .fread = {0xB, 1},
@@ -138,6 +144,8 @@ static const wm_flash_t wm_iflash_chip_by25q = {
         .prscur = {0x42, 0},
         .pe = {WM_IFLASH_UNSPPORT_CMD, 0},
         .se = {0x20, 0},
+        .be = {0x52, 0},
+        .hbe = {0xD8, 0},
         .ce = {0x60, 0},
         .read = {0x3, 0},
         .fread = {0xB, 1},
@@ -163,6 +171,8 @@ static const wm_flash_t wm_iflash_chip_xt25f = {
         .prscur = {WM_IFLASH_UNSPPORT_CMD, 0},
         .pe = {WM_IFLASH_UNSPPORT_CMD, 0},
         .se = {0x20, 0},
+        .be = {0x52, 0},
+        .hbe = {0xD8, 0},
         .ce = {0x60, 0},
         .read = {0x3, 0},
         .fread = {0xB, 1},
@@ -189,6 +199,8 @@ static const wm_flash_t wm_iflash_chip_unknown = {
         .prscur = {0x42, 0},
         .pe = {WM_IFLASH_UNSPPORT_CMD, 0},
         .se = {0x20, 0},
+        .be = {WM_IFLASH_UNSPPORT_CMD, 0},
+        .hbe = {WM_IFLASH_UNSPPORT_CMD, 0},
         .ce = {0x60, 0},
         .read = {0x3, 0},
         .fread = {0xB, 1},
@@ -31,6 +31,7 @@ extern "C" {
 #define WM_SPIM_DEFAULT_CLOCK (2 * 1000000)  /** default clock rate is 2MHz.*/
 #define WM_SPIM_MAX_CLOCK     (20 * 1000000) /** W800 max clock is 20MHz */
 #define WM_SPIM_MIN_CLOCK     (10000)        /** if less this value, maybe lost data in transceive */
+#define WM_SPIM_CMD_ADDR_LEN  (40)           /** max cmd/addr/dummy bytes, cmd 2 + addr 4 + dummy 255 bits, word aligned */
 
 typedef enum {
     SPIM_FORMAT_MOTO = 0, //motorola
@@ -294,6 +295,7 @@ int wm_hal_spim_tx_rx_dma_sync(wm_hal_spim_dev_t *dev, uint8_t *tx_buf, uint32_t
   *    - WM_ERR_SUCCESS: succeed
   *    - others: failed
   *
+  * @note the callback is called last, once the transfer state is cleaned up, so it may start the next transfer
   */
 int wm_hal_spim_register_xfer_done_callback(wm_hal_spim_dev_t *dev, wm_hal_spim_xfer_callback_t spim_callback, void *user_data);
 
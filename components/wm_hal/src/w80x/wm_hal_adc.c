@@ -568,3 +568,34 @@ int wm_hal_adc_stop_dma(wm_hal_adc_dev_t *dev, uint8_t dma_ch)
 
     return WM_ERR_SUCCESS;
 }
+
+int wm_hal_adc_start_continuous(wm_hal_adc_dev_t *dev)
+{
+    // Start adc, every result raises a dma request
+    wm_ll_adc_en_dma(dev->reg_base, 1);
+    wm_ll_adc_en_pd_sdadc(dev->reg_base, 0);
+    wm_ll_adc_reset_sdadc(dev->reg_base, 1);
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_hal_adc_switch_channel(wm_hal_adc_dev_t *dev, wm_adc_channel_t channel)
+{
+    // Hold adc in reset while the input changes, so no result mixes two channels
+    wm_ll_adc_en_pd_sdadc(dev->reg_base, 1);
+    wm_ll_adc_reset_sdadc(dev->reg_base, 0);
+
+    wm_hal_adc_set_channel(dev, channel);
+
+    wm_ll_adc_en_pd_sdadc(dev->reg_base, 0);
+    wm_ll_adc_reset_sdadc(dev->reg_base, 1);
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_hal_adc_stop_continuous(wm_hal_adc_dev_t *dev)
+{
+    wm_hal_adc_stop(dev);
+
+    return WM_ERR_SUCCESS;
+}
@@ -375,6 +375,43 @@ int wm_hal_flash_erase_sectors(wm_hal_flash_dev_t *dev, uint32_t flash_addr, uin
     return WM_ERR_SUCCESS;
 }
 
+int wm_hal_flash_erase_block(wm_hal_flash_dev_t *dev, uint32_t flash_addr, uint32_t block_size)
+{
+    wm_flash_reg_t *hw_reg      = (wm_flash_reg_t *)dev->reg_base;
+    wm_flash_priv_t *priv       = NULL;
+    const wm_flash_t *curr_chip = NULL;
+    uint8_t cmd                 = WM_IFLASH_UNSPPORT_CMD;
+
+    priv      = dev->priv_data;
+    curr_chip = priv->current_flash;
+
+    if (block_size == 32 * 1024) {
+        cmd = curr_chip->cmd_set.be.commd_id;
+    } else if (block_size == 64 * 1024) {
+        cmd = curr_chip->cmd_set.hbe.commd_id;
+    } else {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (flash_addr % block_size) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (cmd == WM_IFLASH_UNSPPORT_CMD) {
+        return WM_ERR_NO_SUPPORT;
+    }
+
+    flash_write_enable(dev, hw_reg);
+    wm_ll_flash_reset_cmd_info(hw_reg, 0);
+    wm_ll_flash_set_cmd_info_cmd(hw_reg, cmd);
+    wm_ll_flash_set_cmd_info_is_se(hw_reg, 1);
+    wm_ll_flash_set_cmd_info_has_address(hw_reg, 1);
+    wm_ll_flash_set_addr_address(hw_reg, flash_addr & WM_FLS_ADDR_MAX_BIT);
+    flash_exec_cmd(hw_reg);
+
+    return WM_ERR_SUCCESS;
+}
+
 //erase whole chip
 void wm_hal_flash_erase_chip(wm_hal_flash_dev_t *dev)
 {
@@ -518,14 +518,16 @@ static void wm_hal_spim_tx_dma_done_callback(wm_dma_ch_t ch, uint32_t sts, void
                 ret = WM_ERR_TIMEOUT;
             }
         }
-        if (priv->xfer_done_callback) {
-            priv->xfer_done_callback(priv->xfer_callback_arg, ret);
-        }
 
+        //clean up before the callback, it may start the next transfer
         wm_ll_spi_set_ch_cfg_rx_invalid_bit(spi_reg, 0);
         priv->tx_buf        = NULL;
         priv->tx_len        = 0;
         priv->remain_tx_len = 0;
+
+        if (priv->xfer_done_callback) {
+            priv->xfer_done_callback(priv->xfer_callback_arg, ret);
+        }
     }
 }
 
@@ -586,11 +588,12 @@ static void wm_hal_spim_rx_dma_done_callback(wm_dma_ch_t ch, uint32_t sts, void
         priv->remain_rx_len = 0;
         priv->rx_len        = 0;
 
+        //clear the fifo before the callback, it may start the next transfer
+        wm_ll_spi_set_ch_cfg_clr_fifo(spi_reg, 1);
+
         if (priv->xfer_done_callback) {
             priv->xfer_done_callback(priv->xfer_callback_arg, ret);
         }
-
-        wm_ll_spi_set_ch_cfg_clr_fifo(spi_reg, 1);
     }
 }
 
@@ -1105,10 +1108,10 @@ int wm_hal_spim_rx_dma(wm_hal_spim_dev_t *dev, uint8_t *rx_buf, uint32_t rx_len)
 
 static void wm_hal_spim_tx_handler_cmd_addr(wm_hal_spim_dev_t *dev)
 {
-    uint8_t *data_buf = NULL;
-    uint8_t data_len  = 0;
-    uint8_t fill_len  = 0;
-    uint8_t idx       = 0;
+    uint32_t data_buf[WM_SPIM_CMD_ADDR_LEN / 4];
+    uint8_t data_len = 0;
+    uint8_t fill_len = 0;
+    uint8_t idx      = 0;
 
     data_len = (dev->dummy_bits % 8 ? 1 : 0);
     data_len += dev->cmd_len + dev->addr_len + dev->dummy_bits / 8;
@@ -1117,10 +1120,8 @@ static void wm_hal_spim_tx_handler_cmd_addr(wm_hal_spim_dev_t *dev)
         fill_len += (4 - data_len % 4); //fill with word
     }
 
+    //no heap here, batches start transfers from the transfer done interrupt, their cmd/addr are sent by IT instead
     if (data_len) {
-        if ((data_buf = wm_os_internal_malloc(fill_len)) == NULL) {
-            return;
-        }
         memset(data_buf, 0xFF, fill_len);
     }
 
@@ -1130,16 +1131,15 @@ static void wm_hal_spim_tx_handler_cmd_addr(wm_hal_spim_dev_t *dev)
     }
 
     if (dev->addr_len) {
-        memcpy(data_buf + idx, &(dev->addr), dev->addr_len);
+        memcpy((uint8_t *)data_buf + idx, &(dev->addr), dev->addr_len);
     }
 
     dev->addr_len   = 0;
     dev->cmd_len    = 0;
     dev->dummy_bits = 0;
 
-    if (data_buf) {
-        wm_hal_spim_tx_polling(dev, data_buf, data_len, 1000);
-        wm_os_internal_free(data_buf);
+    if (data_len) {
+        wm_hal_spim_tx_polling(dev, (uint8_t *)data_buf, data_len, 1000);
     }
 }
 
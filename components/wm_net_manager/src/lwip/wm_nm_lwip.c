@@ -3,6 +3,10 @@
 #include "lwip/netif.h"
 #include "lwip/err.h"
 #include "lwip/netifapi.h"
+#include "lwip/dhcp.h"
+#include "lwip/etharp.h"
+#include "lwip/timeouts.h"
+#include "lwip/priv/tcpip_priv.h"
 #include "lwip/apps/dhcp_server.h"
 #include "lwip/dns.h"
 #include "lwip/ip_addr.h"
@@ -16,6 +20,27 @@
 #define LOG_TAG "wm_nm_netstack"
 #include "wm_log.h"
 
+#define WM_NM_GW_SEED_TIME 3000 /**< ms a seeded gateway entry is used before the gateway is resolved again */
+
+typedef struct {
+    struct tcpip_api_call_data call; /**< Must be the first member */
+    struct netif *netif;
+    wm_nm_dhcpc_lease_t *lease;
+} wm_nm_lwip_lease_call_t;
+
+#if LWIP_IPV4 && ETHARP_SUPPORT_STATIC_ENTRIES
+/* Gateway MAC of the cached lease, only accessed in the tcpip thread */
+typedef struct {
+    u8_t netif_idx;      /**< netif the lease is requested on */
+    ip4_addr_t gw;       /**< gateway of the cached lease */
+    struct eth_addr mac; /**< gateway MAC of the cached lease */
+    bool pending;        /**< waiting for the address to be bound */
+    bool installed;      /**< static ARP entry added, removed again by wm_nm_gw_seed_expire */
+} wm_nm_gw_seed_t;
+
+static wm_nm_gw_seed_t s_nm_gw_seed;
+#endif
+
 #if LWIP_IPV4 && LWIP_IPV6
 static void wm_2_lwip_ip(const wm_ip_addr_t *src, ip_addr_t *dst)
 {
@@ -417,6 +442,183 @@ int wm_net_stack_dhcpc_start(void *netif)
     return WM_ERR_SUCCESS;
 }
 
+#if LWIP_IPV4
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+/* Replace the seeded entry by what the gateway answers now */
+static void wm_nm_gw_seed_expire(void *arg)
+{
+    struct netif *lwip_netif;
+
+    (void)arg;
+
+    if (!s_nm_gw_seed.installed) {
+        return;
+    }
+    s_nm_gw_seed.installed = false;
+
+    etharp_remove_static_entry(&s_nm_gw_seed.gw);
+
+    lwip_netif = netif_get_by_index(s_nm_gw_seed.netif_idx);
+    if (lwip_netif != NULL && netif_is_up(lwip_netif) && ip4_addr_cmp(netif_ip4_gw(lwip_netif), &s_nm_gw_seed.gw)) {
+        etharp_request(lwip_netif, &s_nm_gw_seed.gw);
+    }
+}
+
+static void wm_nm_gw_seed_clear(void)
+{
+    sys_untimeout(wm_nm_gw_seed_expire, NULL);
+    if (s_nm_gw_seed.installed) {
+        etharp_remove_static_entry(&s_nm_gw_seed.gw);
+    }
+    memset(&s_nm_gw_seed, 0, sizeof(s_nm_gw_seed));
+}
+
+/* Called once the address is bound: make the gateway reachable without waiting for ARP */
+static void wm_nm_gw_seed_install(struct netif *lwip_netif)
+{
+    const ip4_addr_t *arp_ip;
+    struct eth_addr *arp_mac;
+
+    if (!s_nm_gw_seed.pending || netif_get_index(lwip_netif) != s_nm_gw_seed.netif_idx) {
+        return;
+    }
+    s_nm_gw_seed.pending = false;
+
+    if (!ip4_addr_cmp(netif_ip4_gw(lwip_netif), &s_nm_gw_seed.gw) ||
+        etharp_find_addr(lwip_netif, &s_nm_gw_seed.gw, &arp_mac, &arp_ip) >= 0) {
+        return;
+    }
+
+    /*
+     * A static entry is not overwritten by ARP replies, so it is only kept for
+     * WM_NM_GW_SEED_TIME and then resolved again, a stale MAC is corrected then.
+     */
+    if (etharp_add_static_entry(&s_nm_gw_seed.gw, &s_nm_gw_seed.mac) == ERR_OK) {
+        s_nm_gw_seed.installed = true;
+        sys_timeout(WM_NM_GW_SEED_TIME, wm_nm_gw_seed_expire, NULL);
+    }
+}
+#endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
+
+static err_t wm_net_stack_dhcpc_reboot_fn(struct tcpip_api_call_data *call)
+{
+    wm_nm_lwip_lease_call_t *msg = (wm_nm_lwip_lease_call_t *)call;
+    wm_nm_dhcpc_lease_t *lease   = msg->lease;
+    ip4_addr_t lwip_addr;
+    ip_addr_t lwip_dns;
+
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+    /* The gateway entry can only be routed once the address is confirmed, see wm_nm_gw_seed_install */
+    wm_nm_gw_seed_clear();
+    if (lease->gw_mac_valid) {
+        s_nm_gw_seed.netif_idx = netif_get_index(msg->netif);
+        wm_2_lwip_ip4(&lease->gw, &s_nm_gw_seed.gw);
+        memcpy(s_nm_gw_seed.mac.addr, lease->gw_mac, sizeof(s_nm_gw_seed.mac.addr));
+        s_nm_gw_seed.pending = true;
+    }
+#endif
+
+    /* The DHCP ACK replaces them, servers set by the user are kept */
+    for (u8_t i = 0; i < LWIP_ARRAYSIZE(lease->dns); i++) {
+        if (lease->dns[i].addr != 0 && ip_addr_isany(dns_getserver(i))) {
+            ip_addr_set_ip4_u32(&lwip_dns, lease->dns[i].addr);
+            dns_setserver(i, &lwip_dns);
+        }
+    }
+
+    wm_2_lwip_ip4(&lease->ip, &lwip_addr);
+    return dhcp_start_reboot(msg->netif, &lwip_addr);
+}
+
+static err_t wm_net_stack_dhcpc_lease_fn(struct tcpip_api_call_data *call)
+{
+    wm_nm_lwip_lease_call_t *msg = (wm_nm_lwip_lease_call_t *)call;
+    wm_nm_dhcpc_lease_t *lease   = msg->lease;
+    struct netif *lwip_netif     = msg->netif;
+    struct dhcp *dhcp            = netif_dhcp_data(lwip_netif);
+    const ip4_addr_t *arp_ip;
+    struct eth_addr *arp_mac;
+    const ip_addr_t *lwip_dns;
+
+    if (dhcp == NULL || !dhcp_supplied_address(lwip_netif)) {
+        return ERR_IF;
+    }
+
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+    wm_nm_gw_seed_install(lwip_netif);
+#endif
+
+    lwip_2_wm_ip4(netif_ip4_addr(lwip_netif), &lease->ip);
+    lwip_2_wm_ip4(netif_ip4_netmask(lwip_netif), &lease->mask);
+    lwip_2_wm_ip4(netif_ip4_gw(lwip_netif), &lease->gw);
+    lease->lease_time = dhcp->offered_t0_lease;
+
+    for (u8_t i = 0; i < LWIP_ARRAYSIZE(lease->dns); i++) {
+        lwip_dns           = dns_getserver(i);
+        lease->dns[i].addr = IP_IS_V4(lwip_dns) ? ip_2_ip4(lwip_dns)->addr : 0;
+    }
+
+    lease->gw_mac_valid = false;
+    if (!ip4_addr_isany(netif_ip4_gw(lwip_netif))) {
+        if (etharp_find_addr(lwip_netif, netif_ip4_gw(lwip_netif), &arp_mac, &arp_ip) >= 0) {
+            memcpy(lease->gw_mac, arp_mac->addr, sizeof(lease->gw_mac));
+            lease->gw_mac_valid = true;
+        } else {
+            /* Resolve it now, so it is known when the lease is saved again */
+            etharp_request(lwip_netif, netif_ip4_gw(lwip_netif));
+        }
+    }
+
+    return ERR_OK;
+}
+#endif
+
+int wm_net_stack_dhcpc_start_reboot(void *netif, const wm_nm_dhcpc_lease_t *lease)
+{
+    int ret                  = WM_ERR_SUCCESS;
+    struct netif *lwip_netif = (struct netif *)netif;
+    assert(lwip_netif != NULL);
+    if (lease == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+#if LWIP_IPV4
+    wm_nm_lwip_lease_call_t msg = { 0 };
+    msg.netif                   = lwip_netif;
+    msg.lease                   = (wm_nm_dhcpc_lease_t *)lease;
+    ret                         = tcpip_api_call(wm_net_stack_dhcpc_reboot_fn, &msg.call);
+    if (ret) {
+        return WM_ERR_FAILED;
+    }
+#endif
+#if LWIP_IPV6 && CONFIG_LWIP_IPV6_DHCP6
+    ret = netifapi_dhcp6_start(lwip_netif);
+    if (ret) {
+        return WM_ERR_FAILED;
+    }
+#endif
+    return WM_ERR_SUCCESS;
+}
+
+int wm_net_stack_dhcpc_get_lease(void *netif, wm_nm_dhcpc_lease_t *lease)
+{
+#if LWIP_IPV4
+    struct netif *lwip_netif = (struct netif *)netif;
+    assert(lwip_netif != NULL);
+    if (lease == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+    wm_nm_lwip_lease_call_t msg = { 0 };
+    msg.netif                   = lwip_netif;
+    msg.lease                   = lease;
+    if (tcpip_api_call(wm_net_stack_dhcpc_lease_fn, &msg.call) != ERR_OK) {
+        return WM_ERR_NO_INITED;
+    }
+    return WM_ERR_SUCCESS;
+#else
+    return WM_ERR_NO_SUPPORT;
+#endif
+}
+
 int wm_net_stack_dhcpc_stop(void *netif)
 {
     int ret                  = WM_ERR_SUCCESS;
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <assert.h>
 #include <arpa/inet.h>
 
@@ -17,6 +18,11 @@
 #if CONFIG_COMPONENT_PM_ENABLED
 #include "wm_pm.h"
 #endif
+#if CONFIG_NM_WIFI_STA_FAST_RECONNECT
+#include "wm_nvs.h"
+#include "wm_key_config.h"
+#include "wm_debug.h"
+#endif
 
 #include "wm_nm_api.h"
 #include "wm_nm_wifi.h"
@@ -32,8 +38,180 @@ WM_EVENT_DEFINE_GROUP(WM_NM_EV); /**< Define net manager event group */
 static wm_nm_param_t s_nm_param = { 0 };
 static void wm_nm_event_post(wm_nm_state_e event, void *data, size_t size);
 
+#if CONFIG_NM_WIFI_STA_FAST_RECONNECT
+#define WM_NM_LEASE_VERSION  2
+#define WM_NM_LEASE_INFINITE 0xFFFFFFFF
+
+/* DHCP lease of the last station connection, stored in NVS */
+typedef struct {
+    uint8_t version;                /**< WM_NM_LEASE_VERSION */
+    uint8_t ssid_len;               /**< SSID length */
+    uint8_t ssid[32];               /**< SSID of the AP the lease was got from */
+    uint8_t bssid[WM_MAC_ADDR_LEN]; /**< BSSID of the AP the lease was got from */
+    uint32_t obtained;              /**< time() the lease was last confirmed by the server */
+    wm_nm_dhcpc_lease_t lease;      /**< lease */
+} wm_nm_lease_record_t;
+
+static wm_nm_lease_record_t s_nm_lease; /**< current AP, and lease as stored in NVS */
+static bool s_nm_lease_stored;          /**< s_nm_lease.lease is stored in NVS */
+
+static int wm_nm_lease_load(wm_nm_lease_record_t *record)
+{
+    wm_nvs_handle_t handle = NULL;
+    size_t len             = sizeof(*record);
+    int ret;
+
+    if (wm_nvs_open(WM_NVS_DEF_PARTITION, WM_GROUP_NETWORK, WM_NVS_OP_READ_WRITE, &handle) != WM_ERR_SUCCESS) {
+        return WM_ERR_FAILED;
+    }
+
+    ret = wm_nvs_get_blob(handle, WM_KEY_NM_STA_LEASE, record, &len);
+    wm_nvs_close(handle);
+
+    if (ret != WM_ERR_SUCCESS || len != sizeof(*record) || record->version != WM_NM_LEASE_VERSION) {
+        return WM_ERR_NOT_FOUND;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+/*
+ * time() counts from the RTC, or from boot without the RTC driver. A lease stored before the clock restarted can not
+ * be aged, it is dropped once on the first use after such a boot.
+ */
+static void wm_nm_lease_drop_stale(void)
+{
+    static bool checked    = false;
+    wm_nvs_handle_t handle = NULL;
+
+    if (checked) {
+        return;
+    }
+    checked = true;
+
+#if CONFIG_COMPONENT_DRIVER_RTC_ENABLED
+    if (wm_get_reboot_reason() != WM_REBOOT_REASON_POWER_ON) {
+        return;
+    }
+#endif
+
+    if (wm_nvs_open(WM_NVS_DEF_PARTITION, WM_GROUP_NETWORK, WM_NVS_OP_READ_WRITE, &handle) == WM_ERR_SUCCESS) {
+        wm_nvs_del_key(handle, WM_KEY_NM_STA_LEASE);
+        wm_nvs_close(handle);
+    }
+}
+
+/* Seconds of the lease that have passed, false when the clock went back and the age is unknown */
+static bool wm_nm_lease_elapsed(const wm_nm_lease_record_t *record, uint32_t *elapsed)
+{
+    uint32_t now = (uint32_t)time(NULL);
+
+    if (now < record->obtained) {
+        return false;
+    }
+
+    *elapsed = now - record->obtained;
+
+    return true;
+}
+
+/* Store the lease of the current connection, NVS is only written when it changed or half of it has passed */
+static void wm_nm_lease_save(wm_nm_netif_t netif)
+{
+    wm_nm_internal_netif_t *int_netif = wm_nm_query_internal_netif(netif);
+    wm_nvs_handle_t handle            = NULL;
+    uint32_t elapsed                  = 0;
+    wm_nm_dhcpc_lease_t lease;
+
+    if (int_netif == NULL) {
+        return;
+    }
+
+    memset(&lease, 0, sizeof(lease));
+    if (wm_net_stack_dhcpc_get_lease(int_netif->netif, &lease) != WM_ERR_SUCCESS) {
+        return;
+    }
+
+    /* Keep a known gateway MAC while the gateway has not answered the ARP request yet */
+    if (!lease.gw_mac_valid && s_nm_lease_stored && s_nm_lease.lease.gw_mac_valid &&
+        lease.gw.addr == s_nm_lease.lease.gw.addr) {
+        memcpy(lease.gw_mac, s_nm_lease.lease.gw_mac, sizeof(lease.gw_mac));
+        lease.gw_mac_valid = true;
+    }
+
+    /* The server confirmed the lease again, the stored start time is refreshed before the lease runs out */
+    if (s_nm_lease_stored && !memcmp(&lease, &s_nm_lease.lease, sizeof(lease)) &&
+        (lease.lease_time == WM_NM_LEASE_INFINITE ||
+         (wm_nm_lease_elapsed(&s_nm_lease, &elapsed) && elapsed < lease.lease_time / 2))) {
+        return;
+    }
+
+    s_nm_lease.version  = WM_NM_LEASE_VERSION;
+    s_nm_lease.obtained = (uint32_t)time(NULL);
+    s_nm_lease.lease    = lease;
+    s_nm_lease_stored   = false;
+
+    if (wm_nvs_open(WM_NVS_DEF_PARTITION, WM_GROUP_NETWORK, WM_NVS_OP_READ_WRITE, &handle) != WM_ERR_SUCCESS) {
+        return;
+    }
+
+    if (wm_nvs_set_blob(handle, WM_KEY_NM_STA_LEASE, &s_nm_lease, sizeof(s_nm_lease)) == WM_ERR_SUCCESS) {
+        s_nm_lease_stored = true;
+    } else {
+        wm_log_warn("save lease fail");
+    }
+    wm_nvs_close(handle);
+}
+
+/* Request the previous lease again when reconnecting to the same AP, otherwise do a full DHCP */
+static int wm_nm_lease_start_dhcpc(wm_nm_netif_t netif, wm_wifi_event_data_t *wifi_data)
+{
+    wm_nm_internal_netif_t *int_netif = wm_nm_query_internal_netif(netif);
+    uint32_t elapsed                  = 0;
+    wm_nm_lease_record_t record;
+
+    memset(&s_nm_lease, 0, sizeof(s_nm_lease));
+    s_nm_lease_stored = false;
+    wm_nm_lease_drop_stale();
+
+    s_nm_lease.ssid_len = wifi_data->sta_connected_info.ssid_len;
+    if (s_nm_lease.ssid_len > sizeof(s_nm_lease.ssid)) {
+        s_nm_lease.ssid_len = sizeof(s_nm_lease.ssid);
+    }
+    memcpy(s_nm_lease.ssid, wifi_data->sta_connected_info.ssid, s_nm_lease.ssid_len);
+    memcpy(s_nm_lease.bssid, wifi_data->sta_connected_info.bssid, sizeof(s_nm_lease.bssid));
+
+    memset(&record, 0, sizeof(record));
+    if (int_netif == NULL || wm_nm_lease_load(&record) != WM_ERR_SUCCESS || record.ssid_len != s_nm_lease.ssid_len ||
+        memcmp(record.ssid, s_nm_lease.ssid, sizeof(record.ssid)) ||
+        memcmp(record.bssid, s_nm_lease.bssid, sizeof(record.bssid))) {
+        return wm_nm_start_netif_dhcpc(netif);
+    }
+
+    if (!wm_nm_lease_elapsed(&record, &elapsed)) {
+        wm_log_debug("clock went back, cached lease age unknown");
+        return wm_nm_start_netif_dhcpc(netif);
+    }
+
+    /* An expired lease must not be requested again (RFC 2131 section 3.2) */
+    if (record.lease.lease_time != WM_NM_LEASE_INFINITE && elapsed >= record.lease.lease_time) {
+        wm_log_debug("cached lease expired");
+        return wm_nm_start_netif_dhcpc(netif);
+    }
+
+    s_nm_lease.version  = WM_NM_LEASE_VERSION;
+    s_nm_lease.obtained = record.obtained;
+    s_nm_lease.lease    = record.lease;
+    s_nm_lease_stored   = true;
+
+    wm_log_debug("reboot with cached lease");
+
+    return wm_net_stack_dhcpc_start_reboot(int_netif->netif, &record.lease);
+}
+#endif /* CONFIG_NM_WIFI_STA_FAST_RECONNECT */
+
 #if CONFIG_COMPONENT_WIFI_ENABLED
-static void wm_nm_wifi_station_connect_handle(void)
+static void wm_nm_wifi_station_connect_handle(wm_wifi_event_data_t *wifi_data)
 {
     wm_nm_netif_t netif;
 
@@ -49,7 +227,11 @@ static void wm_nm_wifi_station_connect_handle(void)
     if (s_nm_param.info[WM_NETIF_TYPE_WIFI_STA].is_static_ip) {
         wm_nm_set_netif_ip_info(netif, &s_nm_param.info[WM_NETIF_TYPE_WIFI_STA].ip_info);
     } else {
+#if CONFIG_NM_WIFI_STA_FAST_RECONNECT
+        wm_nm_lease_start_dhcpc(netif, wifi_data);
+#else
         wm_nm_start_netif_dhcpc(netif);
+#endif
     }
 
 #if CONFIG_NM_WIFI_STA_AUTO_CONNECT
@@ -60,6 +242,12 @@ static void wm_nm_wifi_station_connect_handle(void)
 static void wm_nm_wifi_station_disconnect_handle(void)
 {
     wm_nm_event_post(WM_NM_WIFI_STA_LOST_IP, NULL, 0);
+#if CONFIG_NM_WIFI_STA_FAST_RECONNECT
+    if (!s_nm_param.info[WM_NETIF_TYPE_WIFI_STA].is_static_ip) {
+        /* The gateway MAC may have been resolved since the address was got */
+        wm_nm_lease_save(wm_nm_get_netif_by_name(WIFI_STATION_NETIF_NAME));
+    }
+#endif
     wm_nm_stop_netif_dhcpc(wm_nm_get_netif_by_name(WIFI_STATION_NETIF_NAME));
     wm_netif_delif(WM_NETIF_TYPE_WIFI_STA);
 #if CONFIG_NM_WIFI_STA_AUTO_CONNECT
@@ -132,7 +320,7 @@ static void wm_wifi_event_callback(wm_event_group_t group, int event, void *data
         case WM_EVENT_WIFI_STA_CONNECTED:
         {
             wm_log_info("%.*s is connected", wifi_data->sta_connected_info.ssid_len, wifi_data->sta_connected_info.ssid);
-            wm_nm_wifi_station_connect_handle();
+            wm_nm_wifi_station_connect_handle(wifi_data);
 #if CONFIG_COMPONENT_NM_WIFI_STA_ENABLED
             wm_nm_set_wifi_station_state_internal(WM_NM_WIFI_STA_CONNECTED);
 #endif
@@ -191,6 +379,11 @@ static void wm_lwip_event_callback(wm_event_group_t group, int event, void *data
             char ip[16];
             ipaddr_ntoa_r((ip_addr_t *)&event_data->sta_got_ip_info.ip, ip, sizeof(ip));
             wm_log_info("sta got ip: %s", ip);
+#if CONFIG_NM_WIFI_STA_FAST_RECONNECT
+            if (!s_nm_param.info[WM_NETIF_TYPE_WIFI_STA].is_static_ip) {
+                wm_nm_lease_save(wm_nm_get_netif_by_name(WIFI_STATION_NETIF_NAME));
+            }
+#endif
 #if CONFIG_COMPONENT_NM_WIFI_STA_ENABLED
             wm_nm_set_wifi_station_state_internal(WM_NM_WIFI_STA_GOT_IP);
 #endif
@@ -24,6 +24,7 @@
 #ifndef __WM_NM_NETSTACK_H__
 #define __WM_NM_NETSTACK_H__
 #include "wm_nm_def.h"
+#include "wm_utils.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +33,19 @@ extern "C" {
 typedef void (*add_netif)(wm_nm_netif_t netif); /**< add netif callback. */
 typedef void (*del_netif)(wm_nm_netif_t netif); /**< delet netif callback. */
 
+/**
+  * @brief  DHCP client lease, kept to reconnect to the same network quickly
+  */
+typedef struct {
+    wm_ip4_addr_t ip;                /**< leased IP address */
+    wm_ip4_addr_t mask;              /**< network mask */
+    wm_ip4_addr_t gw;                /**< gateway IP address */
+    wm_ip4_addr_t dns[2];            /**< main and backup DNS server */
+    uint32_t lease_time;             /**< lease time (second) */
+    uint8_t gw_mac[WM_MAC_ADDR_LEN]; /**< gateway MAC address */
+    bool gw_mac_valid;               /**< gateway MAC address is known */
+} wm_nm_dhcpc_lease_t;
+
 /**
   * @brief  init network stack
   *
@@ -233,6 +247,40 @@ int wm_net_stack_dhcps_stop(void *netif);
   */
 int wm_net_stack_dhcpc_start(void *netif);
 
+/**
+  * @brief  set DHCP client start with a previous lease
+  *
+  * The gateway ARP entry is seeded from the lease and the leased address is
+  * requested directly (DHCP INIT-REBOOT). Without an answer from the server
+  * the client falls back to a full DHCP negotiation.
+  *
+  * @param[in] netif: Netif handle
+  * @param[in] lease: previous lease
+  *
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - WM_ERR_INVALID_PARAM: invalid argument
+  *    - others: failed
+  */
+int wm_net_stack_dhcpc_start_reboot(void *netif, const wm_nm_dhcpc_lease_t *lease);
+
+/**
+  * @brief  get DHCP client lease
+  *
+  * When the gateway is not in the ARP cache yet, an ARP request is sent for it
+  * and gw_mac_valid is false.
+  *
+  * @param[in] netif: Netif handle
+  * @param[out] lease: lease write back address
+  *
+  * @return
+  *    - WM_ERR_SUCCESS: succeed
+  *    - WM_ERR_INVALID_PARAM: invalid argument
+  *    - WM_ERR_NO_INITED: no address leased
+  *    - others: failed
+  */
+int wm_net_stack_dhcpc_get_lease(void *netif, wm_nm_dhcpc_lease_t *lease);
+
 /**
   * @brief  set DHCP client stop
   *
@@ -0,0 +1,624 @@
+/**
+ * @file wm_nn_test.c
+ *
+ * @brief NN Host Test
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wm_error.h"
+#include "wm_nn.h"
+#include "wm_nn_internal.h"
+
+#define TEST_MAX_TENSOR 32
+#define TEST_MAX_LAYER  32
+#define TEST_MAX_WEIGHT (64 * 1024)
+
+/* a model is built in these tables then packed to the model format */
+typedef struct {
+    wm_nn_model_header_t header;
+    wm_nn_tensor_desc_t tensors[TEST_MAX_TENSOR];
+    wm_nn_layer_desc_t layers[TEST_MAX_LAYER];
+    int8_t weights[TEST_MAX_WEIGHT];
+} test_builder_t;
+
+static const char *g_type_name[WM_NN_LAYER_MAX] = { "conv", "dw_conv", "fc",   "max_pool", "avg_pool",
+                                                     "relu", "sigmoid", "tanh", "softmax" };
+
+static test_builder_t g_builder;
+static int g_fail;
+
+static void test_report(const char *name, int ok, const char *detail)
+{
+    printf("%-12s %s %s\n", name, ok ? "PASS" : "FAIL", detail);
+    g_fail += !ok;
+}
+
+static void test_random(int8_t *buf, uint32_t len, int min, int max)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (int8_t)(rand() % (max - min + 1) + min);
+    }
+}
+
+static uint32_t test_size(const wm_nn_tensor_desc_t *t)
+{
+    return (uint32_t)t->dim_x * t->dim_y * t->ch;
+}
+
+static void test_begin(test_builder_t *b)
+{
+    memset(&b->header, 0, sizeof(b->header));
+    b->header.magic   = WM_NN_MODEL_MAGIC;
+    b->header.version = WM_NN_MODEL_VERSION;
+}
+
+static uint16_t test_tensor(test_builder_t *b, uint16_t dim_x, uint16_t dim_y, uint16_t ch)
+{
+    wm_nn_tensor_desc_t *t = &b->tensors[b->header.tensor_num];
+
+    memset(t, 0, sizeof(*t));
+    t->dim_x = dim_x;
+    t->dim_y = dim_y;
+    t->ch    = ch;
+
+    return b->header.tensor_num++;
+}
+
+/* add a layer with random weights, the shifts keep the outputs in range */
+static wm_nn_layer_desc_t *test_layer(test_builder_t *b, wm_nn_layer_type_t type, uint16_t in, uint16_t out,
+                                      uint8_t kernel_x, uint8_t kernel_y, uint8_t stride, uint8_t pad_x, uint8_t pad_y)
+{
+    wm_nn_layer_desc_t *l = &b->layers[b->header.layer_num++];
+    uint32_t weight = 0, bias = 0, fan_in = 0;
+    uint8_t shift = 0;
+
+    memset(l, 0, sizeof(*l));
+    l->type     = (uint8_t)type;
+    l->in       = in;
+    l->out      = out;
+    l->kernel_x = kernel_x;
+    l->kernel_y = kernel_y;
+    l->stride_x = stride;
+    l->stride_y = stride;
+    l->pad_x    = pad_x;
+    l->pad_y    = pad_y;
+
+    if (type == WM_NN_LAYER_CONV) {
+        fan_in = (uint32_t)kernel_x * kernel_y * b->tensors[in].ch;
+        weight = fan_in * b->tensors[out].ch;
+        bias   = b->tensors[out].ch;
+    } else if (type == WM_NN_LAYER_DW_CONV) {
+        fan_in = (uint32_t)kernel_x * kernel_y;
+        weight = fan_in * b->tensors[out].ch;
+        bias   = b->tensors[out].ch;
+    } else if (type == WM_NN_LAYER_FC) {
+        fan_in = test_size(&b->tensors[in]);
+        weight = fan_in * test_size(&b->tensors[out]);
+        bias   = test_size(&b->tensors[out]);
+    } else if (type == WM_NN_LAYER_SIGMOID || type == WM_NN_LAYER_TANH) {
+        l->out_shift = 2;
+    }
+
+    if (weight) {
+        while (fan_in >>= 2) {
+            shift++;
+        }
+        l->out_shift  = 5 + shift;
+        l->bias_shift = 4;
+        l->weight     = b->header.weight_size;
+        l->bias       = b->header.weight_size + weight;
+        test_random(b->weights + l->weight, weight, -32, 31);
+        test_random(b->weights + l->bias, bias, -16, 15);
+        b->header.weight_size += (weight + bias + 3) & ~3;
+    }
+
+    return l;
+}
+
+/* pack the tables to a model, 4 bytes aligned */
+static uint32_t *test_pack(const test_builder_t *b, uint32_t *size)
+{
+    uint32_t tensor_size = b->header.tensor_num * sizeof(wm_nn_tensor_desc_t);
+    uint32_t layer_size  = b->header.layer_num * sizeof(wm_nn_layer_desc_t);
+    uint8_t *p           = NULL;
+    uint32_t *model;
+
+    *size = sizeof(wm_nn_model_header_t) + tensor_size + layer_size + b->header.weight_size;
+    model = malloc(*size + 4);
+    p     = (uint8_t *)model;
+
+    memcpy(p, &b->header, sizeof(wm_nn_model_header_t));
+    p += sizeof(wm_nn_model_header_t);
+    memcpy(p, b->tensors, tensor_size);
+    p += tensor_size;
+    memcpy(p, b->layers, layer_size);
+    p += layer_size;
+    memcpy(p, b->weights, b->header.weight_size);
+
+    return model;
+}
+
+/* 32x32x3 image classifier like examples/dsp/cifar10, with in place activations */
+static void test_build_cifar10(test_builder_t *b)
+{
+    uint16_t in, t;
+
+    test_begin(b);
+    in = test_tensor(b, 32, 32, 3);
+    t  = test_tensor(b, 32, 32, 32);
+    test_layer(b, WM_NN_LAYER_CONV, in, t, 5, 5, 1, 2, 2);
+    test_layer(b, WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = test_tensor(b, 16, 16, 32);
+    test_layer(b, WM_NN_LAYER_MAX_POOL, in, t, 3, 3, 2, 0, 0);
+    in = t;
+    t  = test_tensor(b, 16, 16, 16);
+    test_layer(b, WM_NN_LAYER_CONV, in, t, 5, 5, 1, 2, 2);
+    test_layer(b, WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = test_tensor(b, 8, 8, 16);
+    test_layer(b, WM_NN_LAYER_AVG_POOL, in, t, 3, 3, 2, 0, 0);
+    in = t;
+    t  = test_tensor(b, 8, 8, 32);
+    test_layer(b, WM_NN_LAYER_CONV, in, t, 5, 5, 1, 2, 2);
+    test_layer(b, WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = test_tensor(b, 4, 4, 32);
+    test_layer(b, WM_NN_LAYER_AVG_POOL, in, t, 3, 3, 2, 0, 0);
+    in = t;
+    t  = test_tensor(b, 1, 1, 10);
+    test_layer(b, WM_NN_LAYER_FC, in, t, 0, 0, 0, 0, 0);
+    test_layer(b, WM_NN_LAYER_SOFTMAX, t, t, 0, 0, 0, 0, 0);
+
+    b->header.input  = 0;
+    b->header.output = t;
+}
+
+/* keyword spotting DS-CNN, 49 frames of 10 MFCC, 12 classes */
+static void test_build_kws(test_builder_t *b)
+{
+    uint16_t in, t;
+    int i;
+
+    test_begin(b);
+    in = test_tensor(b, 10, 49, 1);
+    t  = test_tensor(b, 5, 25, 64);
+    test_layer(b, WM_NN_LAYER_CONV, in, t, 4, 10, 2, 1, 4);
+    test_layer(b, WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+
+    for (i = 0; i < 4; i++) {
+        in = t;
+        t  = test_tensor(b, 5, 25, 64);
+        test_layer(b, WM_NN_LAYER_DW_CONV, in, t, 3, 3, 1, 1, 1);
+        test_layer(b, WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+        in = t;
+        t  = test_tensor(b, 5, 25, 64);
+        test_layer(b, WM_NN_LAYER_CONV, in, t, 1, 1, 1, 0, 0);
+        test_layer(b, WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+    }
+
+    in = t;
+    t  = test_tensor(b, 1, 1, 64);
+    test_layer(b, WM_NN_LAYER_AVG_POOL, in, t, 5, 25, 1, 0, 0);
+    in = t;
+    t  = test_tensor(b, 1, 1, 12);
+    test_layer(b, WM_NN_LAYER_FC, in, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = test_tensor(b, 1, 1, 12);
+    test_layer(b, WM_NN_LAYER_SOFTMAX, in, t, 0, 0, 0, 0, 0);
+
+    b->header.input  = 0;
+    b->header.output = t;
+}
+
+/* anomaly detection autoencoder, 128 features */
+static void test_build_autoencoder(test_builder_t *b)
+{
+    static const uint16_t dims[] = { 128, 64, 16, 64, 128 };
+    uint16_t in, t;
+    uint32_t i;
+
+    test_begin(b);
+    t = test_tensor(b, 1, 1, dims[0]);
+    for (i = 1; i < sizeof(dims) / sizeof(dims[0]); i++) {
+        in = t;
+        t  = test_tensor(b, 1, 1, dims[i]);
+        test_layer(b, WM_NN_LAYER_FC, in, t, 0, 0, 0, 0, 0);
+        if (i + 1 < sizeof(dims) / sizeof(dims[0])) {
+            test_layer(b, WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+        }
+    }
+
+    b->header.input  = 0;
+    b->header.output = t;
+}
+
+/* odd shapes for the C kernels, out of place activations */
+static void test_build_misc(test_builder_t *b)
+{
+    uint16_t in, t;
+
+    test_begin(b);
+    in = test_tensor(b, 7, 5, 3);
+    t  = test_tensor(b, 4, 3, 6);
+    test_layer(b, WM_NN_LAYER_CONV, in, t, 3, 2, 2, 1, 0);
+    in = t;
+    t  = test_tensor(b, 4, 3, 6);
+    test_layer(b, WM_NN_LAYER_TANH, in, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = test_tensor(b, 2, 2, 6);
+    test_layer(b, WM_NN_LAYER_MAX_POOL, in, t, 2, 2, 2, 0, 0);
+    in = t;
+    t  = test_tensor(b, 1, 1, 8);
+    test_layer(b, WM_NN_LAYER_FC, in, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = test_tensor(b, 1, 1, 8);
+    test_layer(b, WM_NN_LAYER_SIGMOID, in, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = test_tensor(b, 1, 1, 8);
+    test_layer(b, WM_NN_LAYER_SOFTMAX, in, t, 0, 0, 0, 0, 0);
+
+    b->header.input  = 0;
+    b->header.output = t;
+}
+
+/* the buffers live at the same time must not overlap, returns the peak of the live bytes */
+static int test_check_plan(wm_nn_model_t *m, uint32_t *peak)
+{
+    const wm_nn_model_header_t *h = m->header;
+    uint32_t num                  = h->tensor_num + h->layer_num;
+    uint32_t *offset              = calloc(num, sizeof(uint32_t));
+    uint32_t *size                = calloc(num, sizeof(uint32_t));
+    int *first                    = calloc(num, sizeof(int));
+    int *last                     = calloc(num, sizeof(int));
+    uint32_t live;
+    int ok = 1;
+    uint32_t i, j;
+
+    for (i = 0; i < h->tensor_num; i++) {
+        first[i]  = -1;
+        offset[i] = m->tensor_offset[i];
+        size[i]   = test_size(&m->tensors[i]);
+    }
+    first[h->input] = 0;
+
+    for (i = 0; i < h->layer_num; i++) {
+        if (first[m->layers[i].out] < 0) {
+            first[m->layers[i].out] = (int)i;
+        }
+        last[m->layers[i].out] = (int)i;
+        last[m->layers[i].in]  = (int)i;
+
+        offset[h->tensor_num + i] = m->scratch_offset[i];
+        size[h->tensor_num + i]   = m->scratch_size[i];
+        first[h->tensor_num + i]  = (int)i;
+        last[h->tensor_num + i]   = (int)i;
+    }
+    last[h->output] = h->layer_num - 1;
+
+    for (i = 0; i < num; i++) {
+        if (first[i] < 0 || !size[i]) {
+            continue;
+        }
+        ok &= offset[i] % WM_NN_ARENA_ALIGN == 0 && offset[i] + size[i] <= m->arena_size;
+        for (j = i + 1; j < num; j++) {
+            if (first[j] >= 0 && size[j] && first[i] <= last[j] && first[j] <= last[i] &&
+                offset[i] < offset[j] + size[j] && offset[j] < offset[i] + size[i]) {
+                printf("  buffers %u and %u overlap\n", (unsigned)i, (unsigned)j);
+                ok = 0;
+            }
+        }
+    }
+
+    *peak = 0;
+    for (i = 0; i < h->layer_num; i++) {
+        live = 0;
+        for (j = 0; j < num; j++) {
+            if (first[j] >= 0 && first[j] <= (int)i && (int)i <= last[j]) {
+                live += WM_NN_ALIGN(size[j]);
+            }
+        }
+        *peak = live > *peak ? live : *peak;
+    }
+
+    free(offset);
+    free(size);
+    free(first);
+    free(last);
+
+    return ok && *peak <= m->arena_size && m->arena_size <= m->total_size;
+}
+
+/* run the layers one by one with a buffer per tensor, no planning */
+static int8_t *test_direct(wm_nn_model_t *m, const int8_t *input)
+{
+    const wm_nn_model_header_t *h = m->header;
+    int8_t **buf                  = calloc(h->tensor_num, sizeof(int8_t *));
+    int8_t *output                = NULL;
+    wm_nn_layer_ctx_t ctx;
+    uint32_t i;
+
+    for (i = 0; i < h->tensor_num; i++) {
+        buf[i] = malloc(test_size(&m->tensors[i]));
+    }
+    memcpy(buf[h->input], input, test_size(&m->tensors[h->input]));
+
+    for (i = 0; i < h->layer_num; i++) {
+        ctx.layer    = &m->layers[i];
+        ctx.in_desc  = &m->tensors[ctx.layer->in];
+        ctx.out_desc = &m->tensors[ctx.layer->out];
+        ctx.in       = buf[ctx.layer->in];
+        ctx.out      = buf[ctx.layer->out];
+        ctx.weight   = m->weights + ctx.layer->weight;
+        ctx.bias     = m->weights + ctx.layer->bias;
+        ctx.scratch  = NULL;
+        wm_nn_layer_run(&ctx, true);
+    }
+
+    output = buf[h->output];
+    for (i = 0; i < h->tensor_num; i++) {
+        if (i != h->output) {
+            free(buf[i]);
+        }
+    }
+    free(buf);
+
+    return output;
+}
+
+static void test_model(const char *name, void (*build)(test_builder_t *b))
+{
+    wm_nn_model_t *model = NULL;
+    wm_nn_model_info_t info;
+    wm_nn_layer_info_t layer;
+    wm_nn_tensor_t input, output;
+    uint32_t *data   = NULL;
+    int8_t *expected = NULL;
+    int8_t *in_copy  = NULL;
+    void *arena      = NULL;
+    uint32_t size, peak = 0;
+    char detail[96];
+    int ok = 1;
+    int run;
+    uint16_t i;
+
+    build(&g_builder);
+    data = test_pack(&g_builder, &size);
+
+    if (wm_nn_model_load(data, size, &model) != WM_ERR_SUCCESS) {
+        test_report(name, 0, "load");
+        free(data);
+        return;
+    }
+
+    wm_nn_model_get_info(model, &info);
+    ok &= test_check_plan(model, &peak);
+
+    arena = malloc(info.arena_size);
+    ok &= wm_nn_model_set_arena(model, arena, info.arena_size - 4) == WM_ERR_INVALID_PARAM;
+    ok &= wm_nn_model_set_arena(model, arena, info.arena_size) == WM_ERR_SUCCESS;
+    wm_nn_model_get_input(model, &input);
+    wm_nn_model_get_output(model, &output);
+    in_copy = malloc(input.size);
+
+    /* different inputs, the arena is reused from run to run */
+    for (run = 0; run < 3; run++) {
+        test_random(in_copy, input.size, -128, 127);
+        memcpy(input.data, in_copy, input.size);
+        expected = test_direct(model, in_copy);
+        ok &= wm_nn_model_run(model) == WM_ERR_SUCCESS && !memcmp(output.data, expected, output.size);
+        free(expected);
+    }
+
+    snprintf(detail, sizeof(detail), "arena %u peak %u total %u weights %u", (unsigned)info.arena_size, (unsigned)peak,
+             (unsigned)info.total_size, (unsigned)info.weight_size);
+    test_report(name, ok, detail);
+
+    for (i = 0; i < info.layer_num; i++) {
+        wm_nn_model_get_layer_info(model, i, &layer);
+        printf("  %2u %-8s %2u -> %2u macs %8u scratch %5u %6u us\n", i, g_type_name[layer.type], layer.in, layer.out,
+               (unsigned)layer.macs, (unsigned)layer.scratch_size, (unsigned)layer.time_us);
+    }
+
+    wm_nn_model_unload(model);
+    free(arena);
+    free(in_copy);
+    free(data);
+}
+
+/* run one layer on its own */
+static void test_layer_run(wm_nn_layer_desc_t *l, const wm_nn_tensor_desc_t *in_desc,
+                           const wm_nn_tensor_desc_t *out_desc, int8_t *in, int8_t *out, const int8_t *weight,
+                           const int8_t *bias)
+{
+    wm_nn_layer_ctx_t ctx = { l, in_desc, out_desc, in, out, weight, bias, NULL };
+
+    wm_nn_layer_run(&ctx, true);
+}
+
+static void test_kernels(void)
+{
+    static const int8_t counts[16] = { 4, 6, 6, 4, 6, 9, 9, 6, 6, 9, 9, 6, 4, 6, 6, 4 };
+    wm_nn_tensor_desc_t t4x4   = { 4, 4, 1, 0 };
+    wm_nn_tensor_desc_t o4x4   = { 4, 4, 1, 0 };
+    wm_nn_tensor_desc_t t2x2   = { 2, 2, 1, 0 };
+    wm_nn_tensor_desc_t t1x4   = { 1, 1, 4, 0 };
+    wm_nn_layer_desc_t l;
+    int8_t ones[16], out[16], data[16];
+    int8_t zero = 0;
+    int ok      = 1;
+    int i;
+
+    /* 3x3 convolution of ones with zero padding counts the neighbors */
+    memset(&l, 0, sizeof(l));
+    memset(ones, 1, sizeof(ones));
+    l.type     = WM_NN_LAYER_CONV;
+    l.kernel_x = l.kernel_y = 3;
+    l.stride_x = l.stride_y = 1;
+    l.pad_x = l.pad_y = 1;
+    ok &= wm_nn_layer_check(&l, &t4x4, &o4x4) == WM_ERR_SUCCESS;
+    test_layer_run(&l, &t4x4, &o4x4, ones, out, ones, &zero);
+    ok &= !memcmp(out, counts, sizeof(counts));
+
+    /* the same with the rounding of out_shift 1 and a bias of 1 << 1 */
+    l.out_shift  = 1;
+    l.bias_shift = 1;
+    data[0]      = 1;
+    test_layer_run(&l, &t4x4, &o4x4, ones, out, ones, data);
+    for (i = 0; i < 16; i++) {
+        ok &= out[i] == (counts[i] + 2 + 1) >> 1;
+    }
+
+    /* 2x2 pooling */
+    for (i = 0; i < 16; i++) {
+        data[i] = (int8_t)(i * 8 - 64);
+    }
+    memset(&l, 0, sizeof(l));
+    l.type     = WM_NN_LAYER_MAX_POOL;
+    l.kernel_x = l.kernel_y = 2;
+    l.stride_x = l.stride_y = 2;
+    ok &= wm_nn_layer_check(&l, &t4x4, &t2x2) == WM_ERR_SUCCESS;
+    test_layer_run(&l, &t4x4, &t2x2, data, out, NULL, NULL);
+    ok &= out[0] == data[5] && out[1] == data[7] && out[2] == data[13] && out[3] == data[15];
+    l.type = WM_NN_LAYER_AVG_POOL;
+    test_layer_run(&l, &t4x4, &t2x2, data, out, NULL, NULL);
+    ok &= out[0] == (data[0] + data[5]) / 2 && out[3] == (data[10] + data[15]) / 2;
+
+    /* activations at 0 and saturated, inputs with 3 integer bits */
+    memset(&l, 0, sizeof(l));
+    l.type      = WM_NN_LAYER_SIGMOID;
+    l.out_shift = 3;
+    data[0]   = 0;
+    data[1]   = 127;
+    data[2]   = -128;
+    data[3]   = 0;
+    test_layer_run(&l, &t1x4, &t1x4, data, out, NULL, NULL);
+    ok &= out[0] == 64 && out[1] == 127 && out[2] == 0;
+    l.type = WM_NN_LAYER_TANH;
+    test_layer_run(&l, &t1x4, &t1x4, data, out, NULL, NULL);
+    ok &= out[0] == 0 && out[1] == 127 && out[2] == -128;
+
+    /* softmax of equal inputs splits 128, an input 8 below the max is dropped */
+    l.type  = WM_NN_LAYER_SOFTMAX;
+    data[0] = data[1] = data[2] = data[3] = 10;
+    test_layer_run(&l, &t1x4, &t1x4, data, out, NULL, NULL);
+    ok &= out[0] == 32 && out[1] == 32 && out[2] == 32 && out[3] == 32;
+    data[3] = 2;
+    test_layer_run(&l, &t1x4, &t1x4, data, out, NULL, NULL);
+    ok &= out[0] == 42 && out[3] == 0;
+
+    l.type  = WM_NN_LAYER_RELU;
+    data[0] = -5;
+    data[1] = 5;
+    test_layer_run(&l, &t1x4, &t1x4, data, data, NULL, NULL);
+    ok &= data[0] == 0 && data[1] == 5;
+
+    test_report("kernels", ok, "");
+}
+
+static int test_load_fails(void)
+{
+    wm_nn_model_t *model = NULL;
+    uint32_t *data       = NULL;
+    uint32_t size;
+    int err;
+
+    data = test_pack(&g_builder, &size);
+    err  = wm_nn_model_load(data, size, &model);
+    if (err == WM_ERR_SUCCESS) {
+        wm_nn_model_unload(model);
+    }
+    free(data);
+
+    return err == WM_ERR_INVALID_PARAM;
+}
+
+static void test_malformed(void)
+{
+    wm_nn_model_t *model = NULL;
+    uint32_t *data       = NULL;
+    uint32_t size;
+    int ok = 1;
+
+    test_build_misc(&g_builder);
+    data = test_pack(&g_builder, &size);
+    ok &= wm_nn_model_load(data, size - 1, &model) == WM_ERR_INVALID_PARAM;
+    ok &= wm_nn_model_load((uint8_t *)data + 2, size - 2, &model) == WM_ERR_INVALID_PARAM;
+    free(data);
+
+    test_build_misc(&g_builder);
+    g_builder.header.magic = 0;
+    ok &= test_load_fails();
+
+    /* a layer reading a tensor not written yet */
+    test_build_misc(&g_builder);
+    g_builder.layers[1].in = 3;
+    ok &= test_load_fails();
+
+    /* a convolution with a wrong output size */
+    test_build_misc(&g_builder);
+    g_builder.tensors[1].dim_x = 5;
+    ok &= test_load_fails();
+
+    /* weights out of the model */
+    test_build_misc(&g_builder);
+    g_builder.layers[0].weight = g_builder.header.weight_size - 8;
+    ok &= test_load_fails();
+
+    /* a convolution in place */
+    test_build_misc(&g_builder);
+    g_builder.layers[0].out = 0;
+    ok &= test_load_fails();
+
+    /* the input of a pooling layer read after the run */
+    test_build_misc(&g_builder);
+    g_builder.header.output = 2;
+    ok &= test_load_fails();
+
+    /* the output never written */
+    test_build_misc(&g_builder);
+    g_builder.header.output = test_tensor(&g_builder, 1, 1, 8);
+    ok &= test_load_fails();
+    g_builder.header.output = g_builder.header.tensor_num;
+    ok &= test_load_fails();
+
+    test_report("malformed", ok, "");
+}
+
+int main(void)
+{
+    srand(1);
+
+    test_kernels();
+    test_model("cifar10", test_build_cifar10);
+    test_model("kws", test_build_kws);
+    test_model("autoencoder", test_build_autoencoder);
+    test_model("misc", test_build_misc);
+    test_malformed();
+
+    printf("%s\n", g_fail ? "FAIL" : "PASS");
+
+    return g_fail ? 1 : 0;
+}
@@ -0,0 +1,357 @@
+/**
+ * @file wm_nn.h
+ *
+ * @brief Neural Network Inference Module
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_NN_H__
+#define __WM_NN_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup WM_NN_Macros WM NN Macros
+ * @brief WinnerMicro NN Macros
+ */
+
+/**
+ * @addtogroup WM_NN_Macros
+ * @{
+ */
+
+#define WM_NN_MODEL_MAGIC   0x4E4E4D57 /**< "WMNN" in little endian           */
+#define WM_NN_MODEL_VERSION 1          /**< version of the model format       */
+#define WM_NN_ARENA_ALIGN   4          /**< alignment of the arena and tensors */
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_NN_Enumerations WM NN Enumerations
+ * @brief WinnerMicro NN Enumerations
+ */
+
+/**
+ * @addtogroup WM_NN_Enumerations
+ * @{
+ */
+
+/**
+ * @brief Layer types
+ */
+typedef enum {
+    WM_NN_LAYER_CONV = 0, /**< convolution, weights [ch_out][kernel_y][kernel_x][ch_in]      */
+    WM_NN_LAYER_DW_CONV,  /**< depthwise convolution, ch_out == ch_in, weights [kernel_y][kernel_x][ch] */
+    WM_NN_LAYER_FC,       /**< fully connected, weights [out_num][in_num]                    */
+    WM_NN_LAYER_MAX_POOL, /**< max pooling                                                   */
+    WM_NN_LAYER_AVG_POOL, /**< average pooling                                               */
+    WM_NN_LAYER_RELU,     /**< max(x, 0)                                                     */
+    WM_NN_LAYER_SIGMOID,  /**< sigmoid by table look up, out_shift is the integer bits [0, 3] */
+    WM_NN_LAYER_TANH,     /**< tanh by table look up, out_shift is the integer bits [0, 3]    */
+    WM_NN_LAYER_SOFTMAX,  /**< base 2 softmax, the output is Q7                              */
+    WM_NN_LAYER_MAX
+} wm_nn_layer_type_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_NN_Structures WM NN Structures
+ * @brief WinnerMicro NN Structures
+ */
+
+/**
+ * @addtogroup WM_NN_Structures
+ * @{
+ */
+
+/**
+ * @brief Header of a model
+ *
+ * A model is, in little endian and without padding:
+ *     wm_nn_model_header_t
+ *     wm_nn_tensor_desc_t  tensors[tensor_num]
+ *     wm_nn_layer_desc_t   layers[layer_num]
+ *     int8_t               weights[weight_size]
+ *
+ * Tensors are int8 in HWC order. Values are fixed point with power of 2 scales, a layer adds the
+ * bias shifted left by bias_shift to the products and shifts the sum right by out_shift with
+ * rounding, as the CSI NN kernels do.
+ */
+typedef struct {
+    uint32_t magic;       /**< WM_NN_MODEL_MAGIC                        */
+    uint16_t version;     /**< WM_NN_MODEL_VERSION                      */
+    uint16_t layer_num;   /**< number of layers, run in order           */
+    uint16_t tensor_num;  /**< number of tensors                        */
+    uint16_t input;       /**< index of the input tensor                */
+    uint16_t output;      /**< index of the output tensor               */
+    uint16_t reserved;    /**< 0                                        */
+    uint32_t weight_size; /**< bytes of the weights after the layers    */
+} wm_nn_model_header_t;
+
+/**
+ * @brief Shape of a tensor
+ */
+typedef struct {
+    uint16_t dim_x;    /**< width                   */
+    uint16_t dim_y;    /**< height                  */
+    uint16_t ch;       /**< channels                */
+    uint16_t reserved; /**< 0                       */
+} wm_nn_tensor_desc_t;
+
+/**
+ * @brief Layer of a model
+ *
+ * The output size of the convolutions and the pooling is (in + 2 * pad - kernel) / stride + 1, rounded
+ * down or up, so an asymmetric "same" padding is set with pad the smaller side.
+ * An activation or softmax layer may use the same tensor as input and output, it then runs in place.
+ */
+typedef struct {
+    uint8_t type;       /**< wm_nn_layer_type_t                                             */
+    uint8_t bias_shift; /**< left shift of the bias                                         */
+    uint8_t out_shift;  /**< right shift of the sum, integer bits of sigmoid and tanh       */
+    uint8_t reserved;   /**< 0                                                              */
+    uint16_t in;        /**< index of the input tensor                                      */
+    uint16_t out;       /**< index of the output tensor                                     */
+    uint8_t kernel_x;   /**< kernel width of the convolutions and the pooling               */
+    uint8_t kernel_y;   /**< kernel height                                                  */
+    uint8_t stride_x;   /**< horizontal stride                                              */
+    uint8_t stride_y;   /**< vertical stride                                                */
+    uint8_t pad_x;      /**< zero padding on the left and on the right                      */
+    uint8_t pad_y;      /**< zero padding on the top and on the bottom                      */
+    uint16_t reserved1; /**< 0                                                              */
+    uint32_t weight;    /**< offset of the weights in the weight data                       */
+    uint32_t bias;      /**< offset of the bias in the weight data, one per output channel */
+} wm_nn_layer_desc_t;
+
+/**
+ * @brief Tensor of a model with the arena set
+ */
+typedef struct {
+    int8_t *data;   /**< data in the arena, HWC order       */
+    uint32_t size;  /**< bytes, dim_x * dim_y * ch          */
+    uint16_t dim_x; /**< width                              */
+    uint16_t dim_y; /**< height                             */
+    uint16_t ch;    /**< channels                           */
+} wm_nn_tensor_t;
+
+/**
+ * @brief Memory and size of a model
+ */
+typedef struct {
+    uint16_t layer_num;   /**< number of layers                                                  */
+    uint16_t tensor_num;  /**< number of tensors                                                 */
+    uint32_t weight_size; /**< bytes of weights                                                  */
+    uint32_t arena_size;  /**< bytes of arena needed, tensors and scratch buffers share memory   */
+    uint32_t total_size;  /**< bytes of all tensors and scratch buffers, the arena without plan */
+} wm_nn_model_info_t;
+
+/**
+ * @brief Layer information and profile
+ */
+typedef struct {
+    wm_nn_layer_type_t type; /**< layer type                                                */
+    uint16_t in;             /**< input tensor                                              */
+    uint16_t out;            /**< output tensor                                             */
+    bool dsp;                /**< run by the DSP kernels, false for shapes they do not take */
+    uint32_t macs;           /**< multiply accumulates of the convolutions and FC           */
+    uint32_t scratch_size;   /**< bytes of the scratch buffer in the arena                  */
+    uint32_t time_us;        /**< time of the last run                                      */
+} wm_nn_layer_info_t;
+
+typedef struct wm_nn_model_s wm_nn_model_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup WM_NN_APIs WM NN APIs
+ * @brief WinnerMicro NN APIs
+ */
+
+/**
+ * @addtogroup WM_NN_APIs
+ * @{
+ */
+
+/**
+ * @brief Load a model from memory, the tensors and scratch buffers are planned in the arena
+ *
+ * @param[in] data model, 4 bytes aligned, referenced by the model until unloaded
+ * @param[in] size bytes of data
+ * @param[out] model model handle
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument or model
+ *    - WM_ERR_NO_MEM: no memory
+ */
+int wm_nn_model_load(const void *data, uint32_t size, wm_nn_model_t **model);
+
+/**
+ * @brief Load a model from a flash partition
+ *
+ * The model is at the start of the partition. The layer table is read to RAM, the weights
+ * are read through the flash cache unless CONFIG_WM_NN_WEIGHTS_IN_RAM copies them to RAM.
+ *
+ * @param[in] partition_name partition name
+ * @param[out] model model handle
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument or model
+ *    - WM_ERR_NOT_FOUND: no such partition
+ *    - WM_ERR_NO_MEM: no memory
+ *    - others: failed to read the flash
+ */
+int wm_nn_model_load_from_partition(const char *partition_name, wm_nn_model_t **model);
+
+/**
+ * @brief Unload a model, the arena belongs to the caller
+ *
+ * @param[in] model model handle
+ */
+void wm_nn_model_unload(wm_nn_model_t *model);
+
+/**
+ * @brief Get the memory and size of a model
+ *
+ * @param[in] model model handle
+ * @param[out] info information
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ */
+int wm_nn_model_get_info(wm_nn_model_t *model, wm_nn_model_info_t *info);
+
+/**
+ * @brief Set the arena of a model, all the tensors and scratch buffers live in it
+ *
+ * @param[in] model model handle
+ * @param[in] arena WM_NN_ARENA_ALIGN aligned memory, a static buffer or from the heap
+ * @param[in] size bytes of arena, at least wm_nn_model_info_t::arena_size
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument or arena too small
+ */
+int wm_nn_model_set_arena(wm_nn_model_t *model, void *arena, uint32_t size);
+
+/**
+ * @brief Get a tensor of a model
+ *
+ * @param[in] model model handle
+ * @param[in] index tensor index
+ * @param[out] tensor tensor, data is NULL before the arena is set
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *
+ * @note Tensors share the arena, a tensor is valid from the layer writing it to the last layer reading it.
+ */
+int wm_nn_model_get_tensor(wm_nn_model_t *model, uint16_t index, wm_nn_tensor_t *tensor);
+
+/**
+ * @brief Get the input tensor of a model, write the input to it before each run
+ *
+ * @param[in] model model handle
+ * @param[out] tensor input tensor
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *
+ * @note Pooling layers may use their input as work area, so the input does not survive a run.
+ */
+int wm_nn_model_get_input(wm_nn_model_t *model, wm_nn_tensor_t *tensor);
+
+/**
+ * @brief Get the output tensor of a model, valid after a run
+ *
+ * @param[in] model model handle
+ * @param[out] tensor output tensor
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ */
+int wm_nn_model_get_output(wm_nn_model_t *model, wm_nn_tensor_t *tensor);
+
+/**
+ * @brief Run all the layers of a model
+ *
+ * @param[in] model model handle
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_NO_INITED: the arena is not set
+ */
+int wm_nn_model_run(wm_nn_model_t *model);
+
+/**
+ * @brief Run one layer of a model, to step through it, the layers before must have run
+ *
+ * @param[in] model model handle
+ * @param[in] index layer index
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_NO_INITED: the arena is not set
+ */
+int wm_nn_model_run_layer(wm_nn_model_t *model, uint16_t index);
+
+/**
+ * @brief Get the information and the time of the last run of a layer
+ *
+ * @param[in] model model handle
+ * @param[in] index layer index
+ * @param[out] info layer information
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ */
+int wm_nn_model_get_layer_info(wm_nn_model_t *model, uint16_t index, wm_nn_layer_info_t *info);
+
+/**
+ * @brief Run the layers with the portable C kernels in place of the DSP kernels
+ *
+ * @param[in] model model handle
+ * @param[in] enable true to use the C kernels
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *
+ * @note The C kernels round like the DSP kernels, the results of average pooling, sigmoid, tanh
+ *       and softmax may differ by 1.
+ */
+int wm_nn_model_use_reference(wm_nn_model_t *model, bool enable);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_NN_H__ */
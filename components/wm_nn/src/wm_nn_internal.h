@@ -0,0 +1,136 @@
+/**
+ * @file wm_nn_internal.h
+ *
+ * @brief Neural Network Inference Internal Interface
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __WM_NN_INTERNAL_H__
+#define __WM_NN_INTERNAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wm_error.h"
+#include "wm_nn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* WM_NN_HOST builds the runtime on a PC with the C kernels only, to check the loader and the planner */
+#ifdef WM_NN_HOST
+#include <stdio.h>
+
+#define WM_NN_LOGE(fmt, ...)      fprintf(stderr, "[nn] " fmt "\n", ##__VA_ARGS__)
+
+#define WM_NN_MALLOC(size)        malloc(size)
+#define WM_NN_CALLOC(nelem, size) calloc(nelem, size)
+#define WM_NN_FREE(ptr)           free(ptr)
+#else
+#include "wmsdk_config.h"
+#include "wm_osal.h"
+#include "wm_log.h"
+
+#define WM_NN_LOGE(...)           wm_log_error(__VA_ARGS__)
+
+#define WM_NN_MALLOC(size)        wm_os_internal_malloc(size)
+#define WM_NN_CALLOC(nelem, size) wm_os_internal_calloc(nelem, size)
+#define WM_NN_FREE(ptr)           wm_os_internal_free(ptr)
+#endif
+
+#define WM_NN_ALIGN(size)         (((size) + WM_NN_ARENA_ALIGN - 1) & ~(uint32_t)(WM_NN_ARENA_ALIGN - 1))
+
+struct wm_nn_model_s {
+    const wm_nn_model_header_t *header;
+    const wm_nn_tensor_desc_t *tensors;
+    const wm_nn_layer_desc_t *layers;
+    const int8_t *weights;
+
+    void *desc_buf;   /**< header and tables read from flash, NULL for a model in memory */
+    void *weight_buf; /**< weights copied from flash to RAM                             */
+
+    uint32_t *tensor_offset;  /**< offset of each tensor in the arena                    */
+    uint32_t *scratch_offset; /**< offset of the scratch buffer of each layer            */
+    uint32_t *scratch_size;   /**< bytes of the scratch buffer of each layer, 0 for none */
+    uint32_t *layer_us;       /**< time of the last run of each layer                    */
+    uint32_t arena_size;
+    uint32_t total_size;
+
+    int8_t *arena;
+    bool reference;
+};
+
+/* everything a kernel needs to run one layer */
+typedef struct {
+    const wm_nn_layer_desc_t *layer;
+    const wm_nn_tensor_desc_t *in_desc;
+    const wm_nn_tensor_desc_t *out_desc;
+    int8_t *in;
+    int8_t *out;
+    const int8_t *weight;
+    const int8_t *bias;
+    void *scratch;
+} wm_nn_layer_ctx_t;
+
+static inline uint32_t wm_nn_tensor_size(const wm_nn_tensor_desc_t *desc)
+{
+    return (uint32_t)desc->dim_x * desc->dim_y * desc->ch;
+}
+
+/* lay the tensors and the scratch buffers out in the arena, fills the offsets and the sizes */
+int wm_nn_plan(wm_nn_model_t *model);
+
+/* check the shapes and the parameters of a layer, the weights are checked by the loader */
+int wm_nn_layer_check(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in, const wm_nn_tensor_desc_t *out);
+/* bytes of weights and of bias of a layer */
+void wm_nn_layer_weight_size(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in,
+                             const wm_nn_tensor_desc_t *out, uint32_t *weight, uint32_t *bias);
+/* whether the DSP kernels take the layer, and the bytes of scratch buffer they need */
+bool wm_nn_layer_use_dsp(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in, const wm_nn_tensor_desc_t *out,
+                         uint32_t *scratch_size);
+uint32_t wm_nn_layer_macs(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in, const wm_nn_tensor_desc_t *out);
+void wm_nn_layer_run(const wm_nn_layer_ctx_t *ctx, bool reference);
+
+/* portable C kernels, any shape, the results match the DSP kernels */
+void wm_nn_ref_conv(const wm_nn_layer_ctx_t *ctx);
+void wm_nn_ref_dw_conv(const wm_nn_layer_ctx_t *ctx);
+void wm_nn_ref_fc(const wm_nn_layer_ctx_t *ctx);
+void wm_nn_ref_max_pool(const wm_nn_layer_ctx_t *ctx);
+void wm_nn_ref_avg_pool(const wm_nn_layer_ctx_t *ctx);
+void wm_nn_ref_relu(int8_t *data, uint32_t size);
+void wm_nn_ref_sigmoid(int8_t *data, uint32_t size, uint8_t int_width);
+void wm_nn_ref_tanh(int8_t *data, uint32_t size, uint8_t int_width);
+void wm_nn_ref_softmax(const int8_t *in, uint32_t size, int8_t *out);
+
+/* free running us counter, wraps around */
+uint32_t wm_nn_port_time_us(void);
+/* find a partition, offset and size in bytes */
+int wm_nn_port_partition_find(const char *name, uint32_t *offset, uint32_t *size);
+int wm_nn_port_flash_read(uint32_t offset, void *buf, uint32_t len);
+/* address of flash data in the flash cache */
+const void *wm_nn_port_flash_map(uint32_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_NN_INTERNAL_H__ */
@@ -0,0 +1,411 @@
+/**
+ * @file wm_nn_layer.c
+ *
+ * @brief Neural Network Layers
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "wm_nn_internal.h"
+
+#ifndef WM_NN_HOST
+#include "core_804.h"
+#include "csi_gcc.h"
+#include "csi_dsp/csky_math.h"
+#include "csi_dsp/csky_dsp2_nnfunctions.h"
+#endif
+
+/* kernels of a layer, the DSP library only has square convolutions and pooling */
+typedef enum {
+    WM_NN_KERNEL_C = 0,
+    WM_NN_KERNEL_DSP,
+    WM_NN_KERNEL_DSP_1X1, /**< 1x1 convolution, any shape, ch_in % 4 == 0 and ch_out % 2 == 0 */
+    WM_NN_KERNEL_DSP_RGB, /**< square convolution of 3 channels                              */
+} wm_nn_kernel_t;
+
+/*
+ * The output size is (in + 2 * pad - kernel) / stride + 1, rounded down or up. Rounded up covers
+ * the asymmetric "same" padding with pad the smaller side, the kernels skip the windows out of the input.
+ */
+static bool wm_nn_layer_check_window(uint16_t in, uint8_t kernel, uint8_t stride, uint8_t pad, uint16_t out)
+{
+    int span = in + 2 * pad - kernel;
+
+    return kernel && stride && span >= 0 && out >= span / stride + 1 && out <= (span + stride - 1) / stride + 1;
+}
+
+static bool wm_nn_layer_is_square(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in,
+                                  const wm_nn_tensor_desc_t *out)
+{
+    return in->dim_x == in->dim_y && out->dim_x == out->dim_y && layer->kernel_x == layer->kernel_y &&
+           layer->stride_x == layer->stride_y && layer->pad_x == layer->pad_y;
+}
+
+static wm_nn_kernel_t wm_nn_layer_select(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in,
+                                         const wm_nn_tensor_desc_t *out, uint32_t *scratch_size)
+{
+    uint32_t kernel_size = (uint32_t)layer->kernel_x * layer->kernel_y;
+    wm_nn_kernel_t kernel = WM_NN_KERNEL_DSP;
+    uint32_t scratch     = 0;
+
+    /* the scratch sizes are the im2col buffers of the CSI NN kernels, in q15_t */
+    switch (layer->type) {
+        case WM_NN_LAYER_CONV:
+        {
+            if (kernel_size == 1 && layer->stride_x == 1 && layer->stride_y == 1 && !layer->pad_x && !layer->pad_y &&
+                !(in->ch % 4) && !(out->ch % 2)) {
+                kernel  = WM_NN_KERNEL_DSP_1X1;
+                scratch = 2 * in->ch * sizeof(int16_t);
+            } else if (!wm_nn_layer_is_square(layer, in, out)) {
+                kernel = WM_NN_KERNEL_C;
+            } else {
+                kernel  = in->ch == 3 ? WM_NN_KERNEL_DSP_RGB : WM_NN_KERNEL_DSP;
+                scratch = 2 * in->ch * kernel_size * sizeof(int16_t);
+            }
+            break;
+        }
+        case WM_NN_LAYER_DW_CONV:
+        {
+            if (!wm_nn_layer_is_square(layer, in, out) || in->ch % 2) {
+                kernel = WM_NN_KERNEL_C;
+            } else {
+                scratch = 2 * in->ch * kernel_size * sizeof(int16_t);
+            }
+            break;
+        }
+        case WM_NN_LAYER_MAX_POOL:
+        {
+            kernel = wm_nn_layer_is_square(layer, in, out) ? WM_NN_KERNEL_DSP : WM_NN_KERNEL_C;
+            break;
+        }
+        case WM_NN_LAYER_AVG_POOL:
+        {
+            if (!wm_nn_layer_is_square(layer, in, out)) {
+                kernel = WM_NN_KERNEL_C;
+            } else {
+                scratch = 2 * out->dim_x * in->ch * sizeof(int16_t);
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    if (scratch_size) {
+        *scratch_size = kernel == WM_NN_KERNEL_C ? 0 : scratch;
+    }
+
+    return kernel;
+}
+
+int wm_nn_layer_check(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in, const wm_nn_tensor_desc_t *out)
+{
+    bool window = false;
+    bool ok     = false;
+
+    if (in == out && layer->type != WM_NN_LAYER_RELU && layer->type != WM_NN_LAYER_SIGMOID &&
+        layer->type != WM_NN_LAYER_TANH && layer->type != WM_NN_LAYER_SOFTMAX) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    switch (layer->type) {
+        case WM_NN_LAYER_CONV:
+        {
+            window = true;
+            ok     = true;
+            break;
+        }
+        case WM_NN_LAYER_DW_CONV:
+        case WM_NN_LAYER_MAX_POOL:
+        case WM_NN_LAYER_AVG_POOL:
+        {
+            window = true;
+            ok     = in->ch == out->ch;
+            break;
+        }
+        case WM_NN_LAYER_FC:
+        {
+            ok = wm_nn_tensor_size(in) <= UINT16_MAX && wm_nn_tensor_size(out) <= UINT16_MAX;
+            break;
+        }
+        case WM_NN_LAYER_SIGMOID:
+        case WM_NN_LAYER_TANH:
+        {
+            ok = layer->out_shift <= 3 && wm_nn_tensor_size(in) == wm_nn_tensor_size(out);
+            break;
+        }
+        case WM_NN_LAYER_RELU:
+        {
+            ok = wm_nn_tensor_size(in) == wm_nn_tensor_size(out);
+            break;
+        }
+        case WM_NN_LAYER_SOFTMAX:
+        {
+            ok = wm_nn_tensor_size(in) <= UINT16_MAX && wm_nn_tensor_size(in) == wm_nn_tensor_size(out);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    if (window) {
+        ok = ok && wm_nn_layer_check_window(in->dim_x, layer->kernel_x, layer->stride_x, layer->pad_x, out->dim_x) &&
+             wm_nn_layer_check_window(in->dim_y, layer->kernel_y, layer->stride_y, layer->pad_y, out->dim_y);
+    }
+
+    /* the sums are 32 bits */
+    if (layer->bias_shift > 24 || layer->out_shift > 31) {
+        ok = false;
+    }
+
+    return ok && wm_nn_tensor_size(in) && wm_nn_tensor_size(out) ? WM_ERR_SUCCESS : WM_ERR_INVALID_PARAM;
+}
+
+void wm_nn_layer_weight_size(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in,
+                             const wm_nn_tensor_desc_t *out, uint32_t *weight, uint32_t *bias)
+{
+    uint32_t kernel_size = (uint32_t)layer->kernel_x * layer->kernel_y;
+
+    *weight = 0;
+    *bias   = 0;
+
+    switch (layer->type) {
+        case WM_NN_LAYER_CONV:
+        {
+            *weight = out->ch * kernel_size * in->ch;
+            *bias   = out->ch;
+            break;
+        }
+        case WM_NN_LAYER_DW_CONV:
+        {
+            *weight = kernel_size * out->ch;
+            *bias   = out->ch;
+            break;
+        }
+        case WM_NN_LAYER_FC:
+        {
+            *weight = wm_nn_tensor_size(out) * wm_nn_tensor_size(in);
+            *bias   = wm_nn_tensor_size(out);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+bool wm_nn_layer_use_dsp(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in, const wm_nn_tensor_desc_t *out,
+                         uint32_t *scratch_size)
+{
+    return wm_nn_layer_select(layer, in, out, scratch_size) != WM_NN_KERNEL_C;
+}
+
+uint32_t wm_nn_layer_macs(const wm_nn_layer_desc_t *layer, const wm_nn_tensor_desc_t *in, const wm_nn_tensor_desc_t *out)
+{
+    uint32_t weight, bias;
+
+    wm_nn_layer_weight_size(layer, in, out, &weight, &bias);
+
+    switch (layer->type) {
+        case WM_NN_LAYER_CONV:
+        case WM_NN_LAYER_DW_CONV:
+        {
+            return (uint32_t)out->dim_x * out->dim_y * weight;
+        }
+        case WM_NN_LAYER_FC:
+        {
+            return weight;
+        }
+        default:
+        {
+            return 0;
+        }
+    }
+}
+
+#ifndef WM_NN_HOST
+static bool wm_nn_layer_run_dsp(const wm_nn_layer_ctx_t *ctx)
+{
+    const wm_nn_layer_desc_t *l   = ctx->layer;
+    const wm_nn_tensor_desc_t *in = ctx->in_desc;
+    const wm_nn_tensor_desc_t *o  = ctx->out_desc;
+    uint32_t size                 = wm_nn_tensor_size(o);
+    uint32_t n;
+    int8_t *p;
+
+    switch (wm_nn_layer_select(l, in, o, NULL)) {
+        case WM_NN_KERNEL_C:
+        {
+            return false;
+        }
+        case WM_NN_KERNEL_DSP_1X1:
+        {
+            csky_dsp2_convolve_1x1_HWC_q7_fast(ctx->in, in->dim_x, in->dim_y, in->ch, ctx->weight, o->ch, ctx->bias,
+                                               l->bias_shift, l->out_shift, ctx->out, o->dim_x, o->dim_y, ctx->scratch);
+            return true;
+        }
+        case WM_NN_KERNEL_DSP_RGB:
+        {
+            csky_dsp2_convolve_HWC_q7_RGB(ctx->in, in->dim_x, ctx->weight, o->ch, l->kernel_x, l->pad_x, l->stride_x,
+                                          ctx->bias, l->bias_shift, l->out_shift, ctx->out, o->dim_x, ctx->scratch);
+            return true;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    switch (l->type) {
+        case WM_NN_LAYER_CONV:
+        {
+            csky_dsp2_convolve_HWC_q7_basic(ctx->in, in->dim_x, in->ch, ctx->weight, o->ch, l->kernel_x, l->pad_x,
+                                            l->stride_x, ctx->bias, l->bias_shift, l->out_shift, ctx->out, o->dim_x,
+                                            ctx->scratch);
+            break;
+        }
+        case WM_NN_LAYER_DW_CONV:
+        {
+            csky_dsp2_depthwise_separable_conv_HWC_q7(ctx->in, in->dim_x, in->ch, ctx->weight, o->ch, l->kernel_x,
+                                                      l->pad_x, l->stride_x, ctx->bias, l->bias_shift, l->out_shift,
+                                                      ctx->out, o->dim_x, ctx->scratch);
+            break;
+        }
+        case WM_NN_LAYER_FC:
+        {
+            csky_dsp2_fully_connected_q7(ctx->in, ctx->weight, (uint16_t)wm_nn_tensor_size(in), (uint16_t)size,
+                                         l->bias_shift, l->out_shift, ctx->bias, ctx->out);
+            break;
+        }
+        case WM_NN_LAYER_MAX_POOL:
+        {
+            csky_dsp2_maxpool_q7_HWC(ctx->in, in->dim_x, in->ch, l->kernel_x, l->pad_x, l->stride_x, o->dim_x, NULL,
+                                     ctx->out);
+            break;
+        }
+        case WM_NN_LAYER_AVG_POOL:
+        {
+            csky_dsp2_avepool_q7_HWC(ctx->in, in->dim_x, in->ch, l->kernel_x, l->pad_x, l->stride_x, o->dim_x,
+                                     ctx->scratch, ctx->out);
+            break;
+        }
+        case WM_NN_LAYER_RELU:
+        case WM_NN_LAYER_SIGMOID:
+        case WM_NN_LAYER_TANH:
+        {
+            if (ctx->out != ctx->in) {
+                memcpy(ctx->out, ctx->in, size);
+            }
+            /* the kernels take up to 65535 values */
+            for (p = ctx->out; size; size -= n, p += n) {
+                n = size > UINT16_MAX ? UINT16_MAX : size;
+                if (l->type == WM_NN_LAYER_RELU) {
+                    csky_dsp2_relu_q7(p, (uint16_t)n);
+                } else {
+                    csky_dsp2_nn_activations_direct_q7(p, (uint16_t)n, l->out_shift,
+                                                       l->type == WM_NN_LAYER_SIGMOID ? CSKY_SIGMOID : CSKY_TANH);
+                }
+            }
+            break;
+        }
+        case WM_NN_LAYER_SOFTMAX:
+        {
+            csky_dsp2_softmax_q7(ctx->in, (uint16_t)size, ctx->out);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+#endif
+
+void wm_nn_layer_run(const wm_nn_layer_ctx_t *ctx, bool reference)
+{
+    const wm_nn_layer_desc_t *l = ctx->layer;
+    uint32_t size               = wm_nn_tensor_size(ctx->out_desc);
+
+#ifndef WM_NN_HOST
+    if (!reference && wm_nn_layer_run_dsp(ctx)) {
+        return;
+    }
+#else
+    (void)reference;
+#endif
+
+    switch (l->type) {
+        case WM_NN_LAYER_CONV:
+        {
+            wm_nn_ref_conv(ctx);
+            break;
+        }
+        case WM_NN_LAYER_DW_CONV:
+        {
+            wm_nn_ref_dw_conv(ctx);
+            break;
+        }
+        case WM_NN_LAYER_FC:
+        {
+            wm_nn_ref_fc(ctx);
+            break;
+        }
+        case WM_NN_LAYER_MAX_POOL:
+        {
+            wm_nn_ref_max_pool(ctx);
+            break;
+        }
+        case WM_NN_LAYER_AVG_POOL:
+        {
+            wm_nn_ref_avg_pool(ctx);
+            break;
+        }
+        case WM_NN_LAYER_RELU:
+        case WM_NN_LAYER_SIGMOID:
+        case WM_NN_LAYER_TANH:
+        {
+            if (ctx->out != ctx->in) {
+                memcpy(ctx->out, ctx->in, size);
+            }
+            if (l->type == WM_NN_LAYER_RELU) {
+                wm_nn_ref_relu(ctx->out, size);
+            } else if (l->type == WM_NN_LAYER_SIGMOID) {
+                wm_nn_ref_sigmoid(ctx->out, size, l->out_shift);
+            } else {
+                wm_nn_ref_tanh(ctx->out, size, l->out_shift);
+            }
+            break;
+        }
+        case WM_NN_LAYER_SOFTMAX:
+        {
+            wm_nn_ref_softmax(ctx->in, size, ctx->out);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,378 @@
+/**
+ * @file wm_nn_model.c
+ *
+ * @brief Neural Network Model
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define LOG_TAG "nn"
+#include "wm_nn_internal.h"
+
+static inline uint32_t wm_nn_model_desc_size(const wm_nn_model_header_t *h)
+{
+    return sizeof(wm_nn_model_header_t) + h->tensor_num * sizeof(wm_nn_tensor_desc_t) +
+           h->layer_num * sizeof(wm_nn_layer_desc_t);
+}
+
+static int wm_nn_model_check_header(const wm_nn_model_header_t *h, uint32_t size)
+{
+    if (h->magic != WM_NN_MODEL_MAGIC || h->version != WM_NN_MODEL_VERSION) {
+        WM_NN_LOGE("not a model, magic 0x%x version %u", (unsigned)h->magic, (unsigned)h->version);
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (!h->layer_num || !h->tensor_num || h->input >= h->tensor_num || h->output >= h->tensor_num ||
+        h->input == h->output || wm_nn_model_desc_size(h) > size || h->weight_size > size - wm_nn_model_desc_size(h)) {
+        WM_NN_LOGE("bad model header");
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+/* each tensor is written by one layer before it is read, and the weights are in the model */
+static int wm_nn_model_check_layers(wm_nn_model_t *model)
+{
+    const wm_nn_model_header_t *h = model->header;
+    const wm_nn_layer_desc_t *l   = NULL;
+    uint8_t *written              = NULL;
+    uint32_t weight, bias;
+    int err = WM_ERR_SUCCESS;
+    uint32_t i, j;
+
+    if (!(written = WM_NN_CALLOC(h->tensor_num, 1))) {
+        return WM_ERR_NO_MEM;
+    }
+    written[h->input] = 1;
+
+    for (i = 0; i < h->layer_num && err == WM_ERR_SUCCESS; i++) {
+        l   = &model->layers[i];
+        err = WM_ERR_INVALID_PARAM;
+
+        if (l->in >= h->tensor_num || l->out >= h->tensor_num || !written[l->in] || (l->out != l->in && written[l->out]) ||
+            wm_nn_layer_check(l, &model->tensors[l->in], &model->tensors[l->out]) != WM_ERR_SUCCESS) {
+            WM_NN_LOGE("bad layer %u", (unsigned)i);
+            break;
+        }
+
+        wm_nn_layer_weight_size(l, &model->tensors[l->in], &model->tensors[l->out], &weight, &bias);
+        if (weight && (l->weight > h->weight_size || weight > h->weight_size - l->weight || l->bias > h->weight_size ||
+                       bias > h->weight_size - l->bias)) {
+            WM_NN_LOGE("weights of layer %u out of the model", (unsigned)i);
+            break;
+        }
+
+        /* the DSP pooling kernels work in their input, nothing may read it later */
+        if (l->type == WM_NN_LAYER_MAX_POOL || l->type == WM_NN_LAYER_AVG_POOL) {
+            for (j = i + 1; j < h->layer_num && model->layers[j].in != l->in; j++) {
+            }
+            if (j < h->layer_num || l->in == h->output) {
+                WM_NN_LOGE("input of pooling layer %u is read later", (unsigned)i);
+                break;
+            }
+        }
+
+        written[l->out] = 1;
+        err             = WM_ERR_SUCCESS;
+    }
+
+    if (err == WM_ERR_SUCCESS && !written[h->output]) {
+        WM_NN_LOGE("output not written");
+        err = WM_ERR_INVALID_PARAM;
+    }
+
+    WM_NN_FREE(written);
+
+    return err;
+}
+
+/* the header, tables and weights are set, check them and plan the arena */
+static int wm_nn_model_init(wm_nn_model_t *model)
+{
+    const wm_nn_model_header_t *h = model->header;
+    const wm_nn_layer_desc_t *l   = NULL;
+    uint32_t *buf                 = NULL;
+    int err;
+    uint32_t i;
+
+    if ((err = wm_nn_model_check_layers(model)) != WM_ERR_SUCCESS) {
+        return err;
+    }
+
+    buf = WM_NN_CALLOC(h->tensor_num + 3 * h->layer_num, sizeof(uint32_t));
+    if (!buf) {
+        return WM_ERR_NO_MEM;
+    }
+    model->tensor_offset  = buf;
+    model->scratch_offset = buf + h->tensor_num;
+    model->scratch_size   = model->scratch_offset + h->layer_num;
+    model->layer_us       = model->scratch_size + h->layer_num;
+
+    /* plan for the DSP kernels, the C kernels need no scratch buffer */
+    for (i = 0; i < h->layer_num; i++) {
+        l = &model->layers[i];
+        wm_nn_layer_use_dsp(l, &model->tensors[l->in], &model->tensors[l->out], &model->scratch_size[i]);
+    }
+
+    return wm_nn_plan(model);
+}
+
+int wm_nn_model_load(const void *data, uint32_t size, wm_nn_model_t **model)
+{
+    const wm_nn_model_header_t *h = (const wm_nn_model_header_t *)data;
+    wm_nn_model_t *m              = NULL;
+    int err;
+
+    if (!data || !model || ((uintptr_t)data & (WM_NN_ARENA_ALIGN - 1)) || size < sizeof(wm_nn_model_header_t)) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if ((err = wm_nn_model_check_header(h, size)) != WM_ERR_SUCCESS) {
+        return err;
+    }
+
+    if (!(m = WM_NN_CALLOC(1, sizeof(wm_nn_model_t)))) {
+        return WM_ERR_NO_MEM;
+    }
+
+    m->header  = h;
+    m->tensors = (const wm_nn_tensor_desc_t *)(h + 1);
+    m->layers  = (const wm_nn_layer_desc_t *)(m->tensors + h->tensor_num);
+    m->weights = (const int8_t *)data + wm_nn_model_desc_size(h);
+
+    if ((err = wm_nn_model_init(m)) != WM_ERR_SUCCESS) {
+        wm_nn_model_unload(m);
+        return err;
+    }
+
+    *model = m;
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_nn_model_load_from_partition(const char *partition_name, wm_nn_model_t **model)
+{
+    wm_nn_model_header_t header;
+    wm_nn_model_t *m = NULL;
+    uint32_t desc_size;
+    uint32_t offset;
+    uint32_t size;
+    int err;
+
+    if (!partition_name || !model) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if ((err = wm_nn_port_partition_find(partition_name, &offset, &size)) != WM_ERR_SUCCESS) {
+        return err;
+    }
+
+    if (size < sizeof(header) || (err = wm_nn_port_flash_read(offset, &header, sizeof(header))) != WM_ERR_SUCCESS ||
+        (err = wm_nn_model_check_header(&header, size)) != WM_ERR_SUCCESS) {
+        return err != WM_ERR_SUCCESS ? err : WM_ERR_INVALID_PARAM;
+    }
+
+    if (!(m = WM_NN_CALLOC(1, sizeof(wm_nn_model_t)))) {
+        return WM_ERR_NO_MEM;
+    }
+
+    /* the tables are read often, keep them in RAM */
+    desc_size = wm_nn_model_desc_size(&header);
+    if (!(m->desc_buf = WM_NN_MALLOC(desc_size))) {
+        err = WM_ERR_NO_MEM;
+    } else {
+        err = wm_nn_port_flash_read(offset, m->desc_buf, desc_size);
+    }
+
+    if (err == WM_ERR_SUCCESS) {
+        m->header  = (const wm_nn_model_header_t *)m->desc_buf;
+        m->tensors = (const wm_nn_tensor_desc_t *)(m->header + 1);
+        m->layers  = (const wm_nn_layer_desc_t *)(m->tensors + header.tensor_num);
+
+#if CONFIG_WM_NN_WEIGHTS_IN_RAM
+        if (!(m->weight_buf = WM_NN_MALLOC(header.weight_size ? header.weight_size : 1))) {
+            err = WM_ERR_NO_MEM;
+        } else {
+            err = wm_nn_port_flash_read(offset + desc_size, m->weight_buf, header.weight_size);
+        }
+        m->weights = m->weight_buf;
+#else
+        m->weights = wm_nn_port_flash_map(offset + desc_size);
+#endif
+    }
+
+    if (err == WM_ERR_SUCCESS) {
+        err = wm_nn_model_init(m);
+    }
+
+    if (err != WM_ERR_SUCCESS) {
+        wm_nn_model_unload(m);
+        return err;
+    }
+
+    *model = m;
+
+    return WM_ERR_SUCCESS;
+}
+
+void wm_nn_model_unload(wm_nn_model_t *model)
+{
+    if (model) {
+        WM_NN_FREE(model->tensor_offset);
+        WM_NN_FREE(model->desc_buf);
+        WM_NN_FREE(model->weight_buf);
+        WM_NN_FREE(model);
+    }
+}
+
+int wm_nn_model_get_info(wm_nn_model_t *model, wm_nn_model_info_t *info)
+{
+    if (!model || !info) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    info->layer_num   = model->header->layer_num;
+    info->tensor_num  = model->header->tensor_num;
+    info->weight_size = model->header->weight_size;
+    info->arena_size  = model->arena_size;
+    info->total_size  = model->total_size;
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_nn_model_set_arena(wm_nn_model_t *model, void *arena, uint32_t size)
+{
+    if (!model || !arena || ((uintptr_t)arena & (WM_NN_ARENA_ALIGN - 1)) || size < model->arena_size) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    model->arena = arena;
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_nn_model_get_tensor(wm_nn_model_t *model, uint16_t index, wm_nn_tensor_t *tensor)
+{
+    const wm_nn_tensor_desc_t *desc = NULL;
+
+    if (!model || !tensor || index >= model->header->tensor_num) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    desc          = &model->tensors[index];
+    tensor->data  = model->arena ? model->arena + model->tensor_offset[index] : NULL;
+    tensor->size  = wm_nn_tensor_size(desc);
+    tensor->dim_x = desc->dim_x;
+    tensor->dim_y = desc->dim_y;
+    tensor->ch    = desc->ch;
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_nn_model_get_input(wm_nn_model_t *model, wm_nn_tensor_t *tensor)
+{
+    return model ? wm_nn_model_get_tensor(model, model->header->input, tensor) : WM_ERR_INVALID_PARAM;
+}
+
+int wm_nn_model_get_output(wm_nn_model_t *model, wm_nn_tensor_t *tensor)
+{
+    return model ? wm_nn_model_get_tensor(model, model->header->output, tensor) : WM_ERR_INVALID_PARAM;
+}
+
+int wm_nn_model_run_layer(wm_nn_model_t *model, uint16_t index)
+{
+    const wm_nn_layer_desc_t *l = NULL;
+    wm_nn_layer_ctx_t ctx;
+    uint32_t start;
+
+    if (!model || index >= model->header->layer_num) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (!model->arena) {
+        return WM_ERR_NO_INITED;
+    }
+
+    l            = &model->layers[index];
+    ctx.layer    = l;
+    ctx.in_desc  = &model->tensors[l->in];
+    ctx.out_desc = &model->tensors[l->out];
+    ctx.in       = model->arena + model->tensor_offset[l->in];
+    ctx.out      = model->arena + model->tensor_offset[l->out];
+    ctx.weight   = model->weights + l->weight;
+    ctx.bias     = model->weights + l->bias;
+    ctx.scratch  = model->scratch_size[index] ? model->arena + model->scratch_offset[index] : NULL;
+
+    start = wm_nn_port_time_us();
+    wm_nn_layer_run(&ctx, model->reference);
+    model->layer_us[index] = wm_nn_port_time_us() - start;
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_nn_model_run(wm_nn_model_t *model)
+{
+    int err = WM_ERR_SUCCESS;
+    uint16_t i;
+
+    if (!model) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    for (i = 0; i < model->header->layer_num && err == WM_ERR_SUCCESS; i++) {
+        err = wm_nn_model_run_layer(model, i);
+    }
+
+    return err;
+}
+
+int wm_nn_model_get_layer_info(wm_nn_model_t *model, uint16_t index, wm_nn_layer_info_t *info)
+{
+    const wm_nn_layer_desc_t *l = NULL;
+
+    if (!model || !info || index >= model->header->layer_num) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    l                  = &model->layers[index];
+    info->type         = (wm_nn_layer_type_t)l->type;
+    info->in           = l->in;
+    info->out          = l->out;
+    info->dsp          = !model->reference && wm_nn_layer_use_dsp(l, &model->tensors[l->in], &model->tensors[l->out], NULL);
+    info->macs         = wm_nn_layer_macs(l, &model->tensors[l->in], &model->tensors[l->out]);
+    info->scratch_size = model->scratch_size[index];
+    info->time_us      = model->layer_us[index];
+
+#ifdef WM_NN_HOST
+    info->dsp = false;
+#endif
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_nn_model_use_reference(wm_nn_model_t *model, bool enable)
+{
+    if (!model) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    model->reference = enable;
+
+    return WM_ERR_SUCCESS;
+}
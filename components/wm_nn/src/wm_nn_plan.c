@@ -0,0 +1,136 @@
+/**
+ * @file wm_nn_plan.c
+ *
+ * @brief Neural Network Arena Planner
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "wm_nn_internal.h"
+
+/* a tensor or a scratch buffer, live from layer first to layer last */
+typedef struct {
+    uint32_t size;
+    uint32_t offset;
+    uint16_t first;
+    uint16_t last;
+} wm_nn_plan_item_t;
+
+static inline bool wm_nn_plan_conflict(const wm_nn_plan_item_t *a, const wm_nn_plan_item_t *b, uint32_t offset)
+{
+    return a->first <= b->last && b->first <= a->last && offset < b->offset + b->size && b->offset < offset + a->size;
+}
+
+/*
+ * Greedy plan: the buffers are placed from the largest, each at the lowest offset where it does
+ * not overlap a placed buffer that is live at the same time. A buffer overlapping a placed one
+ * can not start before the end of it, so the search jumps there and starts over.
+ */
+int wm_nn_plan(wm_nn_model_t *model)
+{
+    const wm_nn_model_header_t *h = model->header;
+    uint32_t num                  = h->tensor_num + h->layer_num;
+    wm_nn_plan_item_t *items      = NULL;
+    wm_nn_plan_item_t *item       = NULL;
+    wm_nn_plan_item_t *placed     = NULL;
+    uint16_t *order               = NULL;
+    uint16_t tmp;
+    uint32_t offset;
+    uint32_t i, j;
+
+    items = WM_NN_CALLOC(num, sizeof(wm_nn_plan_item_t));
+    order = WM_NN_MALLOC(num * sizeof(uint16_t));
+    if (!items || !order) {
+        WM_NN_FREE(items);
+        WM_NN_FREE(order);
+        return WM_ERR_NO_MEM;
+    }
+
+    for (i = 0; i < h->tensor_num; i++) {
+        items[i].first = UINT16_MAX;
+    }
+    items[h->input].first = 0;
+
+    for (i = 0; i < h->layer_num; i++) {
+        item = &items[model->layers[i].out];
+        if (item->first == UINT16_MAX) {
+            item->first = (uint16_t)i;
+        }
+        item->last = (uint16_t)i;
+
+        items[model->layers[i].in].last = (uint16_t)i;
+
+        item        = &items[h->tensor_num + i];
+        item->size  = WM_NN_ALIGN(model->scratch_size[i]);
+        item->first = (uint16_t)i;
+        item->last  = (uint16_t)i;
+    }
+
+    /* the output is read after the run */
+    items[h->output].last = (uint16_t)(h->layer_num - 1);
+
+    model->total_size = 0;
+    for (i = 0; i < num; i++) {
+        if (i < h->tensor_num && items[i].first != UINT16_MAX) {
+            items[i].size = WM_NN_ALIGN(wm_nn_tensor_size(&model->tensors[i]));
+        }
+        model->total_size += items[i].size;
+        order[i] = (uint16_t)i;
+    }
+
+    /* largest first, insertion sort as models have tens of buffers */
+    for (i = 1; i < num; i++) {
+        tmp = order[i];
+        for (j = i; j > 0 && items[order[j - 1]].size < items[tmp].size; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = tmp;
+    }
+
+    model->arena_size = 0;
+    for (i = 0; i < num && items[order[i]].size; i++) {
+        item   = &items[order[i]];
+        offset = 0;
+
+        for (j = 0; j < i; j++) {
+            placed = &items[order[j]];
+            if (wm_nn_plan_conflict(item, placed, offset)) {
+                /* start over from the end of the placed buffer */
+                offset = placed->offset + placed->size;
+                j      = (uint32_t)-1;
+            }
+        }
+
+        item->offset = offset;
+        if (offset + item->size > model->arena_size) {
+            model->arena_size = offset + item->size;
+        }
+    }
+
+    for (i = 0; i < h->tensor_num; i++) {
+        model->tensor_offset[i] = items[i].offset;
+    }
+    for (i = 0; i < h->layer_num; i++) {
+        model->scratch_offset[i] = items[h->tensor_num + i].offset;
+    }
+
+    WM_NN_FREE(items);
+    WM_NN_FREE(order);
+
+    return WM_ERR_SUCCESS;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file wm_nn_port.c
+ *
+ * @brief Neural Network OS And Flash Port
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#define LOG_TAG "nn"
+#include "wm_nn_internal.h"
+
+#ifdef WM_NN_HOST
+#include <time.h>
+
+uint32_t wm_nn_port_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+/* no flash on a PC, load the models from memory */
+int wm_nn_port_partition_find(const char *name, uint32_t *offset, uint32_t *size)
+{
+    (void)name;
+    (void)offset;
+    (void)size;
+
+    return WM_ERR_NO_SUPPORT;
+}
+
+int wm_nn_port_flash_read(uint32_t offset, void *buf, uint32_t len)
+{
+    (void)offset;
+    (void)buf;
+    (void)len;
+
+    return WM_ERR_NO_SUPPORT;
+}
+
+const void *wm_nn_port_flash_map(uint32_t offset)
+{
+    (void)offset;
+
+    return NULL;
+}
+
+#else
+#include "wm_dt.h"
+#include "wm_drv_flash.h"
+#include "wm_partition_table.h"
+
+uint32_t wm_nn_port_time_us(void)
+{
+    return wm_os_internal_get_time_us();
+}
+
+int wm_nn_port_partition_find(const char *name, uint32_t *offset, uint32_t *size)
+{
+    wm_partition_item_t partition;
+    int err;
+
+    if ((err = wm_partition_table_find(name, &partition)) != WM_ERR_SUCCESS) {
+        return err;
+    }
+
+    *offset = partition.offset;
+    *size   = partition.size;
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_nn_port_flash_read(uint32_t offset, void *buf, uint32_t len)
+{
+    wm_device_t *dev = wm_dt_get_device_by_name("iflash");
+
+    if (!dev) {
+        return WM_ERR_NO_INITED;
+    }
+
+    return wm_drv_flash_read(dev, offset, buf, len);
+}
+
+const void *wm_nn_port_flash_map(uint32_t offset)
+{
+    return (const void *)(CONFIG_FLASH_BASE_ADDR + offset);
+}
+
+#endif
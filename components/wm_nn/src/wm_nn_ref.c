@@ -0,0 +1,293 @@
+/**
+ * @file wm_nn_ref.c
+ *
+ * @brief Neural Network C Kernels
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <math.h>
+
+#include "wm_nn_internal.h"
+
+static int8_t g_wm_nn_sigmoid_table[256];
+static int8_t g_wm_nn_tanh_table[256];
+static bool g_wm_nn_table_ready = false;
+
+static inline int8_t wm_nn_sat8(int32_t x)
+{
+    return (int8_t)(x > 127 ? 127 : (x < -128 ? -128 : x));
+}
+
+/* the bias and the rounding the sum starts from, as NN_ROUND of the CSI NN kernels */
+static inline int32_t wm_nn_acc_init(int8_t bias, uint8_t bias_shift, uint8_t out_shift)
+{
+    return (int32_t)bias * ((int32_t)1 << bias_shift) + (out_shift ? (int32_t)1 << (out_shift - 1) : 0);
+}
+
+void wm_nn_ref_conv(const wm_nn_layer_ctx_t *ctx)
+{
+    const wm_nn_layer_desc_t *l = ctx->layer;
+    uint16_t in_x               = ctx->in_desc->dim_x;
+    uint16_t in_y               = ctx->in_desc->dim_y;
+    uint16_t ch_in              = ctx->in_desc->ch;
+    uint16_t ch_out             = ctx->out_desc->ch;
+    const int8_t *in            = NULL;
+    const int8_t *wt            = NULL;
+    int8_t *out                 = ctx->out;
+    int32_t sum;
+    int ox, oy, oc, kx, ky, ix, iy, c;
+
+    for (oy = 0; oy < ctx->out_desc->dim_y; oy++) {
+        for (ox = 0; ox < ctx->out_desc->dim_x; ox++) {
+            for (oc = 0; oc < ch_out; oc++) {
+                sum = wm_nn_acc_init(ctx->bias[oc], l->bias_shift, l->out_shift);
+
+                for (ky = 0; ky < l->kernel_y; ky++) {
+                    iy = oy * l->stride_y + ky - l->pad_y;
+                    if (iy < 0 || iy >= in_y) {
+                        continue;
+                    }
+                    for (kx = 0; kx < l->kernel_x; kx++) {
+                        ix = ox * l->stride_x + kx - l->pad_x;
+                        if (ix < 0 || ix >= in_x) {
+                            continue;
+                        }
+                        in = ctx->in + (iy * in_x + ix) * ch_in;
+                        wt = ctx->weight + ((oc * l->kernel_y + ky) * l->kernel_x + kx) * ch_in;
+                        for (c = 0; c < ch_in; c++) {
+                            sum += in[c] * wt[c];
+                        }
+                    }
+                }
+
+                *out++ = wm_nn_sat8(sum >> l->out_shift);
+            }
+        }
+    }
+}
+
+void wm_nn_ref_dw_conv(const wm_nn_layer_ctx_t *ctx)
+{
+    const wm_nn_layer_desc_t *l = ctx->layer;
+    uint16_t in_x               = ctx->in_desc->dim_x;
+    uint16_t in_y               = ctx->in_desc->dim_y;
+    uint16_t ch                 = ctx->in_desc->ch;
+    int8_t *out                 = ctx->out;
+    int32_t sum;
+    int ox, oy, c, kx, ky, ix, iy;
+
+    for (oy = 0; oy < ctx->out_desc->dim_y; oy++) {
+        for (ox = 0; ox < ctx->out_desc->dim_x; ox++) {
+            for (c = 0; c < ch; c++) {
+                sum = wm_nn_acc_init(ctx->bias[c], l->bias_shift, l->out_shift);
+
+                for (ky = 0; ky < l->kernel_y; ky++) {
+                    iy = oy * l->stride_y + ky - l->pad_y;
+                    if (iy < 0 || iy >= in_y) {
+                        continue;
+                    }
+                    for (kx = 0; kx < l->kernel_x; kx++) {
+                        ix = ox * l->stride_x + kx - l->pad_x;
+                        if (ix >= 0 && ix < in_x) {
+                            sum += ctx->in[(iy * in_x + ix) * ch + c] * ctx->weight[(ky * l->kernel_x + kx) * ch + c];
+                        }
+                    }
+                }
+
+                *out++ = wm_nn_sat8(sum >> l->out_shift);
+            }
+        }
+    }
+}
+
+void wm_nn_ref_fc(const wm_nn_layer_ctx_t *ctx)
+{
+    const wm_nn_layer_desc_t *l = ctx->layer;
+    uint32_t in_num             = wm_nn_tensor_size(ctx->in_desc);
+    uint32_t out_num            = wm_nn_tensor_size(ctx->out_desc);
+    const int8_t *wt            = ctx->weight;
+    int32_t sum;
+    uint32_t i, j;
+
+    for (j = 0; j < out_num; j++) {
+        sum = wm_nn_acc_init(ctx->bias[j], l->bias_shift, l->out_shift);
+        for (i = 0; i < in_num; i++) {
+            sum += ctx->in[i] * *wt++;
+        }
+        ctx->out[j] = wm_nn_sat8(sum >> l->out_shift);
+    }
+}
+
+/* first and last + 1 input index of a pooling window, clipped to the input */
+static inline void wm_nn_ref_window(int o, uint8_t stride, uint8_t pad, uint8_t kernel, uint16_t in, int *start, int *stop)
+{
+    *start = o * stride - pad;
+    *stop  = *start + kernel;
+    *start = *start < 0 ? 0 : *start;
+    *stop  = *stop > in ? in : *stop;
+}
+
+void wm_nn_ref_max_pool(const wm_nn_layer_ctx_t *ctx)
+{
+    const wm_nn_layer_desc_t *l = ctx->layer;
+    uint16_t in_x               = ctx->in_desc->dim_x;
+    uint16_t ch                 = ctx->in_desc->ch;
+    int8_t *out                 = ctx->out;
+    int x0, x1, y0, y1;
+    int ox, oy, c, x, y;
+    int8_t max;
+
+    for (oy = 0; oy < ctx->out_desc->dim_y; oy++) {
+        wm_nn_ref_window(oy, l->stride_y, l->pad_y, l->kernel_y, ctx->in_desc->dim_y, &y0, &y1);
+        for (ox = 0; ox < ctx->out_desc->dim_x; ox++) {
+            wm_nn_ref_window(ox, l->stride_x, l->pad_x, l->kernel_x, in_x, &x0, &x1);
+            for (c = 0; c < ch; c++) {
+                max = -128;
+                for (y = y0; y < y1; y++) {
+                    for (x = x0; x < x1; x++) {
+                        if (ctx->in[(y * in_x + x) * ch + c] > max) {
+                            max = ctx->in[(y * in_x + x) * ch + c];
+                        }
+                    }
+                }
+                *out++ = max;
+            }
+        }
+    }
+}
+
+/*
+ * The DSP kernel averages along x, truncates to 8 bits, then averages the rows, do the same
+ * so that the results match.
+ */
+void wm_nn_ref_avg_pool(const wm_nn_layer_ctx_t *ctx)
+{
+    const wm_nn_layer_desc_t *l = ctx->layer;
+    uint16_t in_x               = ctx->in_desc->dim_x;
+    uint16_t ch                 = ctx->in_desc->ch;
+    int8_t *out                 = ctx->out;
+    int32_t sum, row;
+    int x0, x1, y0, y1;
+    int ox, oy, c, x, y;
+
+    for (oy = 0; oy < ctx->out_desc->dim_y; oy++) {
+        wm_nn_ref_window(oy, l->stride_y, l->pad_y, l->kernel_y, ctx->in_desc->dim_y, &y0, &y1);
+        for (ox = 0; ox < ctx->out_desc->dim_x; ox++) {
+            wm_nn_ref_window(ox, l->stride_x, l->pad_x, l->kernel_x, in_x, &x0, &x1);
+            for (c = 0; c < ch; c++) {
+                sum = 0;
+                for (y = y0; y < y1; y++) {
+                    row = 0;
+                    for (x = x0; x < x1; x++) {
+                        row += ctx->in[(y * in_x + x) * ch + c];
+                    }
+                    sum += x1 > x0 ? (int8_t)(row / (x1 - x0)) : 0;
+                }
+                *out++ = y1 > y0 ? (int8_t)(sum / (y1 - y0)) : 0;
+            }
+        }
+    }
+}
+
+void wm_nn_ref_relu(int8_t *data, uint32_t size)
+{
+    while (size--) {
+        if (*data < 0) {
+            *data = 0;
+        }
+        data++;
+    }
+}
+
+/* the CSI tables hold f(i / 16) in Q7 for the input byte i, i.e. Q3.4 */
+static void wm_nn_ref_table_init(void)
+{
+    double x;
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        x = (int8_t)i / 16.0;
+
+        g_wm_nn_sigmoid_table[i] = wm_nn_sat8((int32_t)lrint(128 / (1 + exp(-x))));
+        g_wm_nn_tanh_table[i]    = wm_nn_sat8((int32_t)lrint(128 * tanh(x)));
+    }
+
+    g_wm_nn_table_ready = true;
+}
+
+static void wm_nn_ref_lookup(int8_t *data, uint32_t size, uint8_t int_width, const int8_t *table)
+{
+    uint8_t shift = 3 - int_width;
+
+    while (size--) {
+        *data = table[(uint8_t)(*data >> shift)];
+        data++;
+    }
+}
+
+void wm_nn_ref_sigmoid(int8_t *data, uint32_t size, uint8_t int_width)
+{
+    if (!g_wm_nn_table_ready) {
+        wm_nn_ref_table_init();
+    }
+    wm_nn_ref_lookup(data, size, int_width, g_wm_nn_sigmoid_table);
+}
+
+void wm_nn_ref_tanh(int8_t *data, uint32_t size, uint8_t int_width)
+{
+    if (!g_wm_nn_table_ready) {
+        wm_nn_ref_table_init();
+    }
+    wm_nn_ref_lookup(data, size, int_width, g_wm_nn_tanh_table);
+}
+
+/*
+ * Base 2 softmax of the CSI kernel: the inputs more than 8 below the max are dropped, each
+ * other input counts 2^(x - max + 8), the output is 128 * 2^(x - max + 8) / sum.
+ */
+void wm_nn_ref_softmax(const int8_t *in, uint32_t size, int8_t *out)
+{
+    int32_t base = -257;
+    int32_t sum  = 0;
+    int32_t output_base;
+    uint32_t i;
+
+    for (i = 0; i < size; i++) {
+        if (in[i] > base) {
+            base = in[i];
+        }
+    }
+    base -= 8;
+
+    for (i = 0; i < size; i++) {
+        if (in[i] > base) {
+            sum += 1 << (in[i] - base);
+        }
+    }
+
+    output_base = 0x100000 / sum;
+
+    for (i = 0; i < size; i++) {
+        if (in[i] > base) {
+            out[i] = wm_nn_sat8(output_base >> (13 + base - in[i]));
+        } else {
+            out[i] = 0;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#!/usr/bin/python
+# Builds the inputs of wm_ota_lzss_test and compresses them with bin2lzss.py
+#
+#   wm_ota_lzss_data.py <bin2lzss.py> <output directory>
+
+import os
+import sys
+import random
+import subprocess
+
+def text_like(rnd, size):
+    words = [b'wm_ota', b'flash', b'partition', b'image', b'header', b'0x08010000', b'\x00\x00\x00\x00', b'\xff' * 7]
+    out = bytearray()
+    while len(out) < size:
+        out += rnd.choice(words) + bytes([rnd.randrange(256)]) if rnd.random() < 0.1 else rnd.choice(words)
+    return bytes(out[:size])
+
+def delta_like(rnd, size):
+    out = bytearray(size)
+    for i in range(0, size, 61):
+        out[i] = rnd.randrange(256)
+    return bytes(out)
+
+def main(argv):
+    tool = argv[1]
+    out_dir = argv[2]
+    rnd = random.Random(2024)
+
+    # name, data, window bits, lookahead bits
+    cases = [
+        ('text_w8', text_like(rnd, 40000), 8, 4),
+        ('text_w12', text_like(rnd, 40000), 12, 5),
+        ('zeros_w10', bytes(20000), 10, 9),
+        ('random_w12', bytes(rnd.randrange(256) for _ in range(5000)), 12, 5),
+        ('delta_w12', delta_like(rnd, 30000), 12, 10),
+        ('exact_w12', text_like(rnd, 4096 * 3), 12, 5),
+        ('one_byte', b'\x5a', 8, 4),
+    ]
+
+    if not os.path.isdir(out_dir):
+        os.makedirs(out_dir)
+
+    with open(os.path.join(out_dir, 'list.txt'), 'w') as f_list:
+        for name, data, window_bits, lookahead_bits in cases:
+            bin_name = os.path.join(out_dir, name + '.bin')
+            with open(bin_name, 'wb') as f:
+                f.write(data)
+            subprocess.check_call([sys.executable, tool, '-i', bin_name, '-o', os.path.join(out_dir, name + '.lzss'),
+                                   '-w', str(window_bits), '-l', str(lookahead_bits)])
+            f_list.write('%s %d\n' % (name, window_bits))
+
+if __name__ == '__main__':
+    main(sys.argv)
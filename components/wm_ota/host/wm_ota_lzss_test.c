@@ -0,0 +1,252 @@
+/**
+ * @file wm_ota_lzss_test.c
+ *
+ * @brief OTA LZSS Decoder Host Test
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wm_error.h"
+#include "wm_ota_lzss.h"
+
+#define TEST_MAGIC_NO    0x5A4D4D57 /* "WMMZ" */
+#define TEST_HEADER_SIZE 32
+#define TEST_WINDOW_MAX  (1U << 15)
+
+typedef struct {
+    uint8_t *buf;       /* decompressed data */
+    uint32_t len;       /* bytes in buf */
+    uint32_t win_size;  /* window size of the stream */
+    uint32_t calls;     /* output calls */
+    uint32_t fail_call; /* output call that fails, 0 for none */
+    int bad_flush;      /* output call not ending at a window boundary */
+} test_sink_t;
+
+static uint8_t g_window[TEST_WINDOW_MAX];
+static int g_fail;
+
+static void test_report(const char *name, int ok, const char *detail)
+{
+    printf("%-24s %s %s\n", name, ok ? "PASS" : "FAIL", detail);
+    g_fail += !ok;
+}
+
+static uint8_t *test_load(const char *dir, const char *name, const char *ext, uint32_t *len)
+{
+    char path[256];
+    uint8_t *buf;
+    FILE *f;
+    long size;
+
+    snprintf(path, sizeof(path), "%s/%s%s", dir, name, ext);
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(size > 0 ? size : 1);
+    if (buf != NULL && fread(buf, 1, size, f) != (size_t)size) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *len = (uint32_t)size;
+
+    return buf;
+}
+
+static uint32_t test_get32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* CRC-32 as wm_drv_crc32_reverse computes it: reflected, initial value 0xFFFFFFFF, no final XOR */
+static uint32_t test_crc32(const uint8_t *buf, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t i, k;
+
+    for (i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0U - (crc & 1)));
+        }
+    }
+
+    return crc;
+}
+
+static int test_out(void *arg, const uint8_t *data, uint32_t size)
+{
+    test_sink_t *sink = (test_sink_t *)arg;
+
+    sink->calls++;
+    if (sink->fail_call && sink->calls == sink->fail_call) {
+        return WM_ERR_NO_MEM;
+    }
+
+    memcpy(sink->buf + sink->len, data, size);
+    sink->len += size;
+
+    /* The window is passed on when it wraps, a partial window only at the end */
+    if (size > sink->win_size || (sink->len % sink->win_size) != 0) {
+        sink->bad_flush++;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+/* Feed the compressed data in pieces of 1 to max_chunk bytes */
+static int test_decode(wm_ota_lzss_t *lzss, const uint8_t *data, uint32_t size, uint32_t max_chunk)
+{
+    uint32_t n;
+    int ret = WM_ERR_SUCCESS;
+
+    while (size > 0 && ret == WM_ERR_SUCCESS) {
+        n = max_chunk > 1 ? 1 + (uint32_t)rand() % max_chunk : 1;
+        n = n < size ? n : size;
+        ret = wm_ota_lzss_decode(lzss, data, n);
+        data += n;
+        size -= n;
+    }
+
+    return ret;
+}
+
+static void test_stream(const char *dir, const char *name)
+{
+    static const uint32_t chunks[] = { 1, 7, 512, 0xFFFFFFFF };
+    uint8_t *orig, *comp;
+    uint32_t orig_len, comp_len, window_bits, lookahead_bits, orig_size, i, cut;
+    wm_ota_lzss_t lzss;
+    test_sink_t sink;
+    char detail[128];
+    int ret, ok;
+
+    orig = test_load(dir, name, ".bin", &orig_len);
+    comp = test_load(dir, name, ".lzss", &comp_len);
+    if (orig == NULL || comp == NULL || comp_len < TEST_HEADER_SIZE) {
+        test_report(name, 0, "missing data, run make check");
+        goto out;
+    }
+
+    /* The header as written by bin2lzss.py and checked by wm_ota_ops */
+    window_bits    = comp[6];
+    lookahead_bits = comp[7];
+    orig_size      = test_get32(comp + 12);
+    ok = test_get32(comp) == TEST_MAGIC_NO && comp[4] == 1 && comp[5] == 1 && test_get32(comp + 8) == comp_len &&
+         orig_size == orig_len && test_get32(comp + 28) == test_crc32(comp, TEST_HEADER_SIZE - 4) &&
+         (1U << window_bits) <= TEST_WINDOW_MAX && lookahead_bits < window_bits;
+    snprintf(detail, sizeof(detail), "header, %u -> %u bytes, window %u", orig_len, comp_len, 1U << window_bits);
+    test_report(name, ok, detail);
+    if (!ok) {
+        goto out;
+    }
+
+    memset(&sink, 0, sizeof(sink));
+    sink.buf      = malloc(orig_len);
+    sink.win_size = 1U << window_bits;
+
+    /* Whole stream with different input splits */
+    ok = 1;
+    for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        sink.len       = 0;
+        sink.bad_flush = 0;
+        wm_ota_lzss_init(&lzss, g_window, window_bits, lookahead_bits, orig_size, test_out, &sink);
+        ret = test_decode(&lzss, comp + TEST_HEADER_SIZE, comp_len - TEST_HEADER_SIZE, chunks[i]);
+        /* The last output ends wherever the data ends */
+        if (sink.len % sink.win_size) {
+            sink.bad_flush--;
+        }
+        ok &= ret == WM_ERR_SUCCESS && lzss.produced == orig_size && sink.len == orig_len &&
+              !memcmp(sink.buf, orig, orig_len) && sink.bad_flush == 0;
+    }
+    snprintf(detail, sizeof(detail), "round trip, %u window wraps", orig_len / sink.win_size);
+    test_report(name, ok, detail);
+
+    /* A truncated stream decodes a prefix and stays incomplete */
+    ok = 1;
+    for (cut = 1; cut < comp_len - TEST_HEADER_SIZE; cut = cut * 3 + 1) {
+        sink.len = 0;
+        wm_ota_lzss_init(&lzss, g_window, window_bits, lookahead_bits, orig_size, test_out, &sink);
+        ret = test_decode(&lzss, comp + TEST_HEADER_SIZE, comp_len - TEST_HEADER_SIZE - cut, 64);
+        ok &= ret == WM_ERR_SUCCESS && lzss.produced < orig_size && sink.len <= lzss.produced &&
+              !memcmp(sink.buf, orig, sink.len);
+    }
+    test_report(name, ok, "truncated input");
+
+    /* Data beyond orig_size is an error, unless it only pads the last byte */
+    if (orig_size > 1) {
+        sink.len = 0;
+        wm_ota_lzss_init(&lzss, g_window, window_bits, lookahead_bits, orig_size - 1, test_out, &sink);
+        ret = test_decode(&lzss, comp + TEST_HEADER_SIZE, comp_len - TEST_HEADER_SIZE, 64);
+        ok  = (ret == WM_ERR_OTA_DECOMPRESS || ret == WM_ERR_SUCCESS) && lzss.produced == orig_size - 1 &&
+             !memcmp(sink.buf, orig, sink.len);
+        test_report(name, ok, "shorter orig_size");
+    }
+
+    /* An error of the output function stops the decoder */
+    if (orig_len > sink.win_size) {
+        sink.len       = 0;
+        sink.calls     = 0;
+        sink.fail_call = 2;
+        wm_ota_lzss_init(&lzss, g_window, window_bits, lookahead_bits, orig_size, test_out, &sink);
+        ret = test_decode(&lzss, comp + TEST_HEADER_SIZE, comp_len - TEST_HEADER_SIZE, 64);
+        test_report(name, ret == WM_ERR_NO_MEM && sink.calls == 2, "output error");
+        sink.fail_call = 0;
+    }
+
+    free(sink.buf);
+
+out:
+    free(orig);
+    free(comp);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *dir = argc > 1 ? argv[1] : "data";
+    char path[256];
+    char name[64];
+    unsigned int window_bits;
+    FILE *f;
+
+    srand(1);
+
+    snprintf(path, sizeof(path), "%s/list.txt", dir);
+    f = fopen(path, "r");
+    if (f == NULL) {
+        printf("%s not found, run make check\n", path);
+        return 1;
+    }
+
+    while (fscanf(f, "%63s %u", name, &window_bits) == 2) {
+        test_stream(dir, name);
+    }
+    fclose(f);
+
+    printf("%s\n", g_fail ? "FAILED" : "ALL PASSED");
+
+    return g_fail ? 1 : 0;
+}
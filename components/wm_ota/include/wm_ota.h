@@ -30,6 +30,8 @@
 extern "C" {
 #endif
 
+#define WM_OTA_TAG_LEN (64) /**< Size of wm_ota_ctx_t.resume_tag, including the terminating zero */
+
 /**
  * @defgroup WM_OTA_Enumerations WM OTA Enumerations
  * @brief WinnerMicro OTA Enumerations
@@ -174,6 +176,10 @@ typedef struct {
     void *handle;                         /**< Socket used for OTA communication */
     int ota_conn_ret;                     /**< Return value of the last connection attempt */
     uint32_t wrote_offset;                /**< Offset of the data written to the OTA partition */
+    uint32_t total_size;                  /**< Size of the OTA data stream, 0 until its header is received */
+    uint32_t resume_id;                   /**< Identifies the download for CONFIG_OTA_RESUME, 0 disables checkpoints */
+    uint32_t checkpoint_offset;           /**< wrote_offset at the last checkpoint */
+    char resume_tag[WM_OTA_TAG_LEN];      /**< Version of the file downloaded, e.g. its ETag, a checkpoint keeps it */
     wm_ota_ops_ctx_t ota_ops_ctx;         /**< OTA operations context */
     wm_ota_session_t ota_session;         /**< OTA session with callback functions */
     wm_ota_state_callback_t ota_state_cb; /**< Callback for state updates */
@@ -67,16 +67,19 @@ typedef enum {
 } wm_ota_ops_compress_type_t;
 
 typedef enum {
-    WM_ERR_OTA_NO_INIT           = WM_ERR_OTA_BASE - 1, /**< Error: OTA not initialized */
-    WM_ERR_OTA_HEADER_INVALID    = WM_ERR_OTA_BASE - 2, /**< Error: Invalid OTA header */
-    WM_ERR_OTA_SAME_VERSION      = WM_ERR_OTA_BASE - 3, /**< Error: Version unchanged */
-    WM_ERR_OTA_CRC_ERROR         = WM_ERR_OTA_BASE - 4, /**< Error: CRC error in OTA data */
-    WM_ERR_OTA_FW_OVERFLOW       = WM_ERR_OTA_BASE - 5, /**< Error: Firmware overflow during OTA */
-    WM_ERR_OTA_TIMEOUT           = WM_ERR_OTA_BASE - 6, /**< Error: Timeout occurred during OTA */
-    WM_ERR_OTA_NO_GOT_IP         = WM_ERR_OTA_BASE - 7, /**< Error: No IP address obtained for OTA */
-    WM_ERR_OTA_CONNECTION_FAILED = WM_ERR_OTA_BASE - 8, /**< Error: Connection failed for OTA */
-    WM_ERR_OTA_ALREADY_RUNNING   = WM_ERR_OTA_BASE - 9, /**< Error: OTA operation already running */
-    WM_ERR_OTA_SHA256_ECDSA      = WM_ERR_OTA_BASE - 10 /**< Error: SHA256-ECDSA verification error */
+    WM_ERR_OTA_NO_INIT           = WM_ERR_OTA_BASE - 1,  /**< Error: OTA not initialized */
+    WM_ERR_OTA_HEADER_INVALID    = WM_ERR_OTA_BASE - 2,  /**< Error: Invalid OTA header */
+    WM_ERR_OTA_SAME_VERSION      = WM_ERR_OTA_BASE - 3,  /**< Error: Version unchanged */
+    WM_ERR_OTA_CRC_ERROR         = WM_ERR_OTA_BASE - 4,  /**< Error: CRC error in OTA data */
+    WM_ERR_OTA_FW_OVERFLOW       = WM_ERR_OTA_BASE - 5,  /**< Error: Firmware overflow during OTA */
+    WM_ERR_OTA_TIMEOUT           = WM_ERR_OTA_BASE - 6,  /**< Error: Timeout occurred during OTA */
+    WM_ERR_OTA_NO_GOT_IP         = WM_ERR_OTA_BASE - 7,  /**< Error: No IP address obtained for OTA */
+    WM_ERR_OTA_CONNECTION_FAILED = WM_ERR_OTA_BASE - 8,  /**< Error: Connection failed for OTA */
+    WM_ERR_OTA_ALREADY_RUNNING   = WM_ERR_OTA_BASE - 9,  /**< Error: OTA operation already running */
+    WM_ERR_OTA_SHA256_ECDSA      = WM_ERR_OTA_BASE - 10, /**< Error: SHA256-ECDSA verification error */
+    WM_ERR_OTA_DELTA_INVALID     = WM_ERR_OTA_BASE - 11, /**< Error: Malformed delta patch */
+    WM_ERR_OTA_DELTA_BASE        = WM_ERR_OTA_BASE - 12, /**< Error: Running firmware is not the base of the delta patch */
+    WM_ERR_OTA_DECOMPRESS        = WM_ERR_OTA_BASE - 13  /**< Error: Malformed or unsupported compressed stream */
 } wm_ota_ops_err_t;
 
 /**
@@ -159,6 +162,52 @@ typedef struct {
     uint32_t hd_checksum;               /**< Checksum of the header for integrity verification */
 } wm_ota_header_t;
 
+/**
+ * @brief Delta patch header structure.
+ *
+ * A delta patch rebuilds an OTA image from the running firmware. It starts with
+ * this header, followed by records until new_size bytes have been produced. A
+ * record is a control block of three little endian 32-bit words, diff_len,
+ * extra_len and seek, followed by diff_len diff bytes and extra_len extra bytes.
+ * Each diff byte is added to the next byte of the running firmware, extra bytes
+ * are copied, then seek is added to the read position in the running firmware.
+ * The running firmware is read as the .img file it was flashed from, the header
+ * followed by the code. Patches are built by tools/wm/bin2diff.py.
+ */
+typedef struct {
+    uint32_t magic_no;     /**< Magic number to identify a delta patch */
+    uint16_t version;      /**< Patch format version */
+    uint16_t _reserved0;   /**< Reserved for future use */
+    uint32_t patch_size;   /**< Size of the patch in bytes, including this header */
+    uint32_t old_size;     /**< Size of the running firmware the patch applies to */
+    uint32_t old_checksum; /**< Checksum of the running firmware the patch applies to */
+    uint32_t new_size;     /**< Size of the OTA image the patch produces */
+    uint32_t _reserved1;   /**< Reserved for future use */
+    uint32_t hd_checksum;  /**< Checksum of the header for integrity verification */
+} wm_ota_delta_header_t;
+
+/**
+ * @brief Compressed stream header structure.
+ *
+ * A compressed stream carries an OTA image or a delta patch compressed for the
+ * download only. It starts with this header, followed by LZSS data in the
+ * heatshrink bit format: bits are read most significant first, a set tag bit is
+ * followed by a literal byte, a clear one by a back reference of window_bits
+ * bits (distance - 1) and lookahead_bits bits (length - 1). Streams are built by
+ * tools/wm/bin2lzss.py.
+ */
+typedef struct {
+    uint32_t magic_no;      /**< Magic number to identify a compressed stream */
+    uint8_t version;        /**< Stream format version */
+    uint8_t method;         /**< Compression method, 1: LZSS */
+    uint8_t window_bits;    /**< Base-2 logarithm of the window size */
+    uint8_t lookahead_bits; /**< Base-2 logarithm of the longest back reference */
+    uint32_t stream_size;   /**< Size of the stream in bytes, including this header */
+    uint32_t orig_size;     /**< Size of the data once decompressed */
+    uint32_t _reserved[3];  /**< Reserved for future use */
+    uint32_t hd_checksum;   /**< Checksum of the header for integrity verification */
+} wm_ota_comp_header_t;
+
 /**
  * @brief OTA Operations Context structure.
  *
@@ -168,16 +217,31 @@ typedef struct {
  * for data integrity verification.
  */
 typedef struct {
-    uint32_t app_addr;          /**< Address of the application partition */
-    uint32_t app_size;          /**< Size of the application partition */
-    uint32_t app_ota_addr;      /**< Address in flash where the OTA image is stored */
-    uint32_t app_ota_size;      /**< Size of the OTA partition */
-    uint32_t need_erase;        /**< Flag indicating if the flash needs to be erased before writing */
-    uint32_t wrote_addr;        /**< Address of the data written to the OTA partition */
-    wm_ota_header_t ota_header; /**< OTA Header containing metadata about the firmware image */
-    wm_drv_crc_cfg_t crc_ctx;   /**< CRC context used for calculating the checksum of the OTA data */
+    uint32_t app_addr;                /**< Address of the application partition */
+    uint32_t app_size;                /**< Size of the application partition */
+    uint32_t app_ota_addr;            /**< Address in flash where the OTA image is stored */
+    uint32_t app_ota_size;            /**< Size of the OTA partition */
+    uint32_t need_erase;              /**< Flag indicating if the flash needs to be erased before writing */
+    uint32_t wrote_addr;              /**< Address of the data written to the OTA partition */
+    uint32_t erased_end;              /**< Flash from wrote_addr up to this address is known to be erased */
+    wm_ota_header_t ota_header;       /**< OTA Header containing metadata about the firmware image */
+    wm_drv_crc_cfg_t crc_ctx;         /**< CRC context used for calculating the checksum of the OTA data */
+    struct wm_ota_ops_delta *delta;   /**< Delta patch state, NULL unless a delta patch is being applied */
+    struct wm_ota_ops_decomp *decomp; /**< Decompression state, NULL unless a compressed stream is being received */
 } wm_ota_ops_ctx_t;
 
+/**
+ * @brief OTA write checkpoint structure.
+ *
+ * Snapshot of the progress of writing a plain OTA image, it lets an interrupted
+ * update continue after a reboot without writing the image from the start.
+ */
+typedef struct {
+    uint32_t wrote_addr;        /**< Address of the data written to the OTA partition */
+    wm_drv_crc_cfg_t crc_ctx;   /**< CRC context of the data written */
+    wm_ota_header_t ota_header; /**< OTA Header of the image being written */
+} wm_ota_ops_checkpoint_t;
+
 /**
  * @}
  */
@@ -242,10 +306,62 @@ int wm_ota_ops_begin(wm_ota_ops_ctx_t *wm_ota_ops_ctx, size_t image_size);
  * @return
  *    - WM_ERR_SUCCESS: succeed
  *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_OTA_DELTA_INVALID: malformed delta patch
+ *    - WM_ERR_OTA_DELTA_BASE: the running firmware is not the base of the delta patch
+ *    - WM_ERR_OTA_DECOMPRESS: malformed or unsupported compressed stream
  *    - Other error codes based on the underlying flash write operation
+ *
+ * @note With CONFIG_OTA_DELTA, a stream that starts with a delta patch header is applied to the running
+ *       firmware, and the OTA image it rebuilds is written and verified as if it had been received.
+ * @note With CONFIG_OTA_DECOMPRESS, a stream that starts with a compressed stream header is decompressed
+ *       first, it may carry an OTA image or a delta patch.
  */
 int wm_ota_ops_write(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint32_t size);
 
+/**
+ * @brief Get the size of the OTA data stream from its first bytes.
+ *
+ * The stream is an OTA image, a delta patch with CONFIG_OTA_DELTA, or a compressed stream with
+ * CONFIG_OTA_DECOMPRESS. The download is complete when this many bytes have been passed to wm_ota_ops_write().
+ *
+ * @param[in] data Pointer to the beginning of the stream.
+ * @param[in] size Size of the data buffer in bytes, at least OTA_FW_HEADER_SIZE_IN_BIN.
+ *
+ * @return Size of the stream in bytes, 0 if it cannot be determined
+ */
+uint32_t wm_ota_ops_get_stream_size(const uint8_t *data, uint32_t size);
+
+/**
+ * @brief Take a checkpoint of the OTA write progress.
+ *
+ * @param[in] wm_ota_ops_ctx Pointer to the OTA context structure.
+ * @param[out] checkpoint Pointer to the checkpoint to fill.
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_NOT_ALLOWED: the image header has not been written yet, or a delta patch or
+ *      compressed stream is being received, their state cannot be saved
+ */
+int wm_ota_ops_get_checkpoint(wm_ota_ops_ctx_t *wm_ota_ops_ctx, wm_ota_ops_checkpoint_t *checkpoint);
+
+/**
+ * @brief Continue an interrupted OTA update from a checkpoint.
+ *
+ * Call it instead of wm_ota_ops_begin(), after wm_ota_ops_get_ota_partition(). The next
+ * wm_ota_ops_write() continues with the image data at the checkpoint.
+ *
+ * @param[in] wm_ota_ops_ctx Pointer to the OTA context structure.
+ * @param[in] checkpoint Pointer to a checkpoint taken by wm_ota_ops_get_checkpoint().
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_INVALID_PARAM: invalid argument
+ *    - WM_ERR_OTA_HEADER_INVALID: the checkpoint does not match the 'app_ota' partition
+ *    - Other error codes of the header verification
+ */
+int wm_ota_ops_resume(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const wm_ota_ops_checkpoint_t *checkpoint);
+
 /**
  * @brief Finalize the OTA update process and verify the integrity of the written data.
  *
@@ -4,6 +4,9 @@
 #include "wm_event.h"
 #include "wm_wifi.h"
 #include "wm_component.h"
+#if CONFIG_OTA_RESUME
+#include "wm_drv_crc.h"
+#endif
 
 #define LOG_TAG "ota_http"
 #include "wm_log.h"
@@ -52,6 +55,48 @@ static void wm_httpc_event_handle(wm_http_client_t session, wm_http_client_event
     return;
 }
 
+#if CONFIG_OTA_RESUME
+/* Value of a response header, NULL when the header is missing or too long */
+static char *wm_ota_http_find_header(wm_http_client_t session, char *name, char *buf, uint32_t size)
+{
+    uint32_t len = size - 1;
+    char *value  = NULL;
+
+    if (wm_http_client_find_first_header(session, name, buf, &len) == WM_ERR_SUCCESS) {
+        value = strchr(buf, ':');
+    }
+    wm_http_client_find_close_header(session);
+
+    if (value != NULL) {
+        value++;
+        while (*value == ' ') {
+            value++;
+        }
+    }
+
+    return value;
+}
+
+/* Keep the version of the file, a strong ETag or else its Last-Modified date, for the If-Range of a resumed download */
+static void wm_ota_http_save_tag(wm_http_client_t session, char *tag, uint32_t tag_size)
+{
+    char header[WM_OTA_TAG_LEN + 16];
+    char *value = NULL;
+
+    tag[0] = '\0';
+
+    // A weak ETag cannot be used with If-Range (RFC 7233 section 3.2).
+    value = wm_ota_http_find_header(session, "ETag", header, sizeof(header));
+    if (value == NULL || !strncmp(value, "W/", 2)) {
+        value = wm_ota_http_find_header(session, "Last-Modified", header, sizeof(header));
+    }
+
+    if (value != NULL && strlen(value) < tag_size) {
+        strcpy(tag, value);
+    }
+}
+#endif
+
 static int wm_ota_http_connect(void **handle, uint32_t offset)
 {
     int ret                          = WM_ERR_SUCCESS;
@@ -61,6 +106,13 @@ static int wm_ota_http_connect(void **handle, uint32_t offset)
         return WM_ERR_INVALID_PARAM;
     }
 
+#if CONFIG_OTA_RESUME
+    // Without the version of the file, a changed file could be continued into a corrupt image.
+    if (offset && g_ota_http_ctx.p_ota_ctx->resume_tag[0] == '\0') {
+        return WM_ERR_NO_SUPPORT;
+    }
+#endif
+
     http_cfg.method        = WM_HTTP_CLIENT_REQUEST_TYPE_GET;
     http_cfg.event_handler = wm_httpc_event_handle;
 
@@ -80,6 +132,17 @@ static int wm_ota_http_connect(void **handle, uint32_t offset)
             break;
         }
 
+#if CONFIG_OTA_RESUME
+        // The server sends the whole file instead of the range when the file has changed.
+        if (offset) {
+            ret = wm_http_client_add_request_headers(g_ota_http_ctx.http_session, "If-Range",
+                                                     g_ota_http_ctx.p_ota_ctx->resume_tag);
+            if (ret != HTTP_CLIENT_SUCCESS) {
+                break;
+            }
+        }
+#endif
+
         ret = wm_http_client_send_request(g_ota_http_ctx.http_session, g_ota_http_ctx.p_http_url, NULL, 0, true, 0, 0);
         if (ret != HTTP_CLIENT_SUCCESS) {
             break;
@@ -90,6 +153,24 @@ static int wm_ota_http_connect(void **handle, uint32_t offset)
         if (ret != HTTP_CLIENT_SUCCESS) {
             break;
         }
+
+#if CONFIG_OTA_RESUME
+        if (!offset) {
+            wm_ota_http_save_tag(g_ota_http_ctx.http_session, g_ota_http_ctx.p_ota_ctx->resume_tag,
+                                 sizeof(g_ota_http_ctx.p_ota_ctx->resume_tag));
+        }
+#endif
+
+        // A server that ignores the Range header, or has a changed file, sends the whole file, it cannot continue at offset.
+        if (offset) {
+            wm_http_client_info_t info = { 0 };
+
+            ret = wm_http_client_get_info(g_ota_http_ctx.http_session, &info);
+            if (ret == HTTP_CLIENT_SUCCESS && info.HTTPStatusCode != 206) {
+                wm_log_warn("range request answered with %u", (unsigned int)info.HTTPStatusCode);
+                ret = WM_ERR_NO_SUPPORT;
+            }
+        }
     } while (0);
 
     if (ret != WM_ERR_SUCCESS) {
@@ -218,6 +299,11 @@ int wm_ota_http_update(wm_ota_http_cfg_t *cfg)
         goto exit;
     }
 
+#if CONFIG_OTA_RESUME
+    // An interrupted download of the same URL continues where it stopped.
+    g_ota_http_ctx.p_ota_ctx->resume_id = wm_drv_crc32_reverse(cfg->fw_url, url_len);
+#endif
+
     ret = wm_ota_init(g_ota_http_ctx.p_ota_ctx);
     if (ret != WM_ERR_SUCCESS) {
         wm_log_error("ota init failed: %d", ret);
@@ -2,10 +2,127 @@
 #include "wm_ota.h"
 #include "wm_ota_ops.h"
 #include "wm_osal.h"
+#include "wm_task_config.h"
+#if CONFIG_OTA_RESUME
+#include "wm_nvs.h"
+#include "wm_key_config.h"
+#endif
 
 #define LOG_TAG "ota"
 #include "wm_log.h"
 
+#if CONFIG_OTA_RESUME
+#define WM_OTA_RESUME_VERSION  (2)
+#define WM_OTA_RESUME_INTERVAL (CONFIG_OTA_RESUME_INTERVAL_SECTORS * 4096)
+
+typedef struct {
+    uint32_t version;                   /**< Record format version */
+    uint32_t resume_id;                 /**< Download the record belongs to */
+    uint32_t wrote_offset;              /**< Stream bytes written at the checkpoint */
+    uint32_t total_size;                /**< Size of the stream */
+    char resume_tag[WM_OTA_TAG_LEN];    /**< Version of the file the checkpoint belongs to */
+    wm_ota_ops_checkpoint_t checkpoint; /**< Write progress at the checkpoint */
+} wm_ota_resume_record_t;
+#endif
+
+#if CONFIG_OTA_RESUME
+static void ota_checkpoint_clear(void)
+{
+    wm_nvs_handle_t handle = NULL;
+
+    if (wm_nvs_open(WM_NVS_DEF_PARTITION, WM_GROUP_OTA, WM_NVS_OP_READ_WRITE, &handle) == WM_ERR_SUCCESS) {
+        wm_nvs_del_key(handle, WM_KEY_OTA_CHECKPOINT);
+        wm_nvs_close(handle);
+    }
+}
+
+/* Save the progress each time another CONFIG_OTA_RESUME_INTERVAL_SECTORS sectors have been written. */
+static void ota_checkpoint_save(wm_ota_ctx_t *ota_ctx)
+{
+    wm_nvs_handle_t handle        = NULL;
+    wm_ota_resume_record_t record = { 0 };
+
+    if (!ota_ctx->resume_id ||
+        ota_ctx->wrote_offset / WM_OTA_RESUME_INTERVAL == ota_ctx->checkpoint_offset / WM_OTA_RESUME_INTERVAL) {
+        return;
+    }
+
+    // Delta patches and compressed streams have no checkpoint, they start over.
+    if (wm_ota_ops_get_checkpoint(&ota_ctx->ota_ops_ctx, &record.checkpoint) != WM_ERR_SUCCESS) {
+        return;
+    }
+
+    record.version      = WM_OTA_RESUME_VERSION;
+    record.resume_id    = ota_ctx->resume_id;
+    record.wrote_offset = ota_ctx->wrote_offset;
+    record.total_size   = ota_ctx->total_size;
+    memcpy(record.resume_tag, ota_ctx->resume_tag, sizeof(record.resume_tag));
+
+    if (wm_nvs_open(WM_NVS_DEF_PARTITION, WM_GROUP_OTA, WM_NVS_OP_READ_WRITE, &handle) != WM_ERR_SUCCESS) {
+        return;
+    }
+    if (wm_nvs_set_blob(handle, WM_KEY_OTA_CHECKPOINT, &record, sizeof(record)) == WM_ERR_SUCCESS) {
+        ota_ctx->checkpoint_offset = ota_ctx->wrote_offset;
+    }
+    wm_nvs_close(handle);
+}
+
+/* Continue the download of the same resume_id from its last checkpoint, any other checkpoint is dropped. */
+static int ota_checkpoint_resume(wm_ota_ctx_t *ota_ctx)
+{
+    int ret                       = WM_ERR_NOT_FOUND;
+    wm_nvs_handle_t handle        = NULL;
+    wm_ota_resume_record_t record = { 0 };
+    size_t len                    = sizeof(record);
+
+    if (wm_nvs_open(WM_NVS_DEF_PARTITION, WM_GROUP_OTA, WM_NVS_OP_READ_WRITE, &handle) != WM_ERR_SUCCESS) {
+        return WM_ERR_FAILED;
+    }
+
+    if (wm_nvs_get_blob(handle, WM_KEY_OTA_CHECKPOINT, &record, &len) == WM_ERR_SUCCESS && len == sizeof(record) &&
+        record.version == WM_OTA_RESUME_VERSION && ota_ctx->resume_id && record.resume_id == ota_ctx->resume_id &&
+        record.wrote_offset == record.checkpoint.wrote_addr - ota_ctx->ota_ops_ctx.app_ota_addr) {
+        ret = wm_ota_ops_resume(&ota_ctx->ota_ops_ctx, &record.checkpoint);
+    }
+
+    if (ret == WM_ERR_SUCCESS) {
+        ota_ctx->wrote_offset      = record.wrote_offset;
+        ota_ctx->total_size        = record.total_size;
+        ota_ctx->checkpoint_offset = record.wrote_offset;
+        memcpy(ota_ctx->resume_tag, record.resume_tag, sizeof(ota_ctx->resume_tag));
+        ota_ctx->resume_tag[sizeof(ota_ctx->resume_tag) - 1] = '\0';
+        wm_log_info("OTA resume at %u of %u", (unsigned int)record.wrote_offset, (unsigned int)record.total_size);
+    } else {
+        wm_nvs_del_key(handle, WM_KEY_OTA_CHECKPOINT);
+    }
+    wm_nvs_close(handle);
+
+    return ret;
+}
+
+/* The server cannot continue at wrote_offset, download the whole stream again. */
+static int ota_restart(wm_ota_ctx_t *ota_ctx)
+{
+    int ret = WM_ERR_SUCCESS;
+
+    wm_log_warn("OTA server does not support resume, restart from 0");
+    ota_checkpoint_clear();
+    wm_ota_ops_abort(&ota_ctx->ota_ops_ctx);
+
+    ret = wm_ota_ops_get_ota_partition(&ota_ctx->ota_ops_ctx);
+    if (ret == WM_ERR_SUCCESS) {
+        ret = wm_ota_ops_begin(&ota_ctx->ota_ops_ctx, OTA_SIZE_UNKNOWN);
+    }
+
+    ota_ctx->wrote_offset      = 0;
+    ota_ctx->total_size        = 0;
+    ota_ctx->checkpoint_offset = 0;
+    ota_ctx->resume_tag[0]     = '\0';
+
+    return ret;
+}
+#endif /* CONFIG_OTA_RESUME */
+
 static void wm_ota_update_state(wm_ota_ctx_t *ota_ctx, wm_ota_status_t status, uint32_t progress)
 {
     // Update the OTA state and progress in the context.
@@ -33,6 +150,13 @@ int wm_ota_init(wm_ota_ctx_t *ota_ctx)
         return ret;
     }
 
+#if CONFIG_OTA_RESUME
+    // Continue an interrupted download instead of erasing what it has written.
+    if (ota_checkpoint_resume(ota_ctx) == WM_ERR_SUCCESS) {
+        return WM_ERR_SUCCESS;
+    }
+#endif
+
     // Begin the OTA process with an unknown image size.
     ret = wm_ota_ops_begin(&ota_ctx->ota_ops_ctx, OTA_SIZE_UNKNOWN);
     if (ret != WM_ERR_SUCCESS) {
@@ -42,37 +166,279 @@ int wm_ota_init(wm_ota_ctx_t *ota_ctx)
     return ret;
 }
 
-static int ota_start(wm_ota_ctx_t *ota_ctx, bool reboot)
+static void wm_ota_update_progress(wm_ota_ctx_t *ota_ctx, uint32_t *progress, uint32_t ota_img_total_size)
 {
-    int ret                     = WM_ERR_SUCCESS;
-    uint8_t *ota_buffer         = NULL;
-    int reconnect_cnt           = 0;
-    uint32_t progress           = 0;
-    uint32_t next_read_size     = CONFIG_OTA_BLOCK_SIZE;
-    uint32_t got                = 0;
-    uint32_t new_progress       = 0;
-    uint32_t ota_img_total_size = 0;
+    uint32_t new_progress = 0;
+
+    if (!ota_img_total_size) {
+        return;
+    }
+
+    new_progress = ota_ctx->wrote_offset * 100 / ota_img_total_size;
+    if (*progress != new_progress) {
+        printf(".");
+        *progress = new_progress;
+        wm_ota_update_state(ota_ctx, WM_OTA_STATUS_DOWNLOAD_START, *progress);
+    }
+}
+
+static int ota_connect(wm_ota_ctx_t *ota_ctx)
+{
+    int reconnect_cnt = 0;
 
     // Notify the start of the connection.
-    wm_ota_update_state(ota_ctx, WM_OTA_STATUS_CONNECTION_START, progress);
+    wm_ota_update_state(ota_ctx, WM_OTA_STATUS_CONNECTION_START, 0);
 
     // Attempt to connect to the server, with a maximum number of retries.
     do {
         ota_ctx->ota_conn_ret = ota_ctx->ota_session.ota_connect_cb(&ota_ctx->handle, ota_ctx->wrote_offset);
+#if CONFIG_OTA_RESUME
+        if (ota_ctx->ota_conn_ret == WM_ERR_NO_SUPPORT && ota_ctx->wrote_offset) {
+            if (ota_restart(ota_ctx) != WM_ERR_SUCCESS) {
+                break;
+            }
+            continue;
+        }
+#endif
         if (ota_ctx->ota_conn_ret != WM_ERR_SUCCESS) {
             wm_os_internal_time_delay_ms(50);
         }
     } while ((ota_ctx->ota_conn_ret != WM_ERR_SUCCESS) && (reconnect_cnt++ < CONFIG_OTA_SOCKET_RECONNECT_TIMES));
 
     if (ota_ctx->ota_conn_ret != WM_ERR_SUCCESS) {
-        wm_ota_update_state(ota_ctx, WM_OTA_STATUS_CONNECTION_FAILED, progress);
+        wm_ota_update_state(ota_ctx, WM_OTA_STATUS_CONNECTION_FAILED, 0);
         wm_log_error("OTA connect failed: %d", ota_ctx->ota_conn_ret);
         return WM_ERR_OTA_CONNECTION_FAILED;
-    } else {
-        wm_ota_update_state(ota_ctx, WM_OTA_STATUS_CONNECTED, progress);
     }
 
-    wm_ota_update_state(ota_ctx, WM_OTA_STATUS_DOWNLOAD_START, progress);
+    wm_ota_update_state(ota_ctx, WM_OTA_STATUS_CONNECTED, 0);
+
+    return WM_ERR_SUCCESS;
+}
+
+static int ota_finish(wm_ota_ctx_t *ota_ctx, bool reboot)
+{
+    int ret           = WM_ERR_SUCCESS;
+    uint32_t progress = 100;
+
+    printf(".\n");
+    ret = wm_ota_ops_end(&ota_ctx->ota_ops_ctx);
+#if CONFIG_OTA_RESUME
+    // A complete image is never resumed, whether it is valid or not.
+    ota_checkpoint_clear();
+#endif
+    if (ret != WM_ERR_SUCCESS) {
+        wm_ota_update_state(ota_ctx, WM_OTA_STATUS_ABORT, progress);
+        wm_log_error("OTA end failed: %d", ret);
+        return ret;
+    }
+
+    wm_ota_update_state(ota_ctx, WM_OTA_STATUS_DOWNLOADED, progress);
+    if (reboot) {
+        wm_ota_update_state(ota_ctx, WM_OTA_STATUS_UPGRADE_START, progress);
+        wm_os_internal_time_delay_ms(10);
+        ret = wm_ota_ops_reboot();
+        if (ret != WM_ERR_SUCCESS) {
+            wm_ota_update_state(ota_ctx, WM_OTA_STATUS_UPGRADE_FAILED, progress);
+        }
+    }
+
+    return ret;
+}
+
+#if CONFIG_OTA_PIPELINE
+typedef struct {
+    uint32_t len;   /**< Number of valid bytes in data */
+    uint8_t data[]; /**< CONFIG_OTA_BLOCK_SIZE bytes, +1 for http */
+} wm_ota_block_t;
+
+typedef struct {
+    wm_ota_ctx_t *ota_ctx;                                 /**< OTA context */
+    wm_os_queue_t *free_queue;                             /**< Blocks that can be filled */
+    wm_os_queue_t *full_queue;                             /**< Blocks to be written, NULL stops the write task */
+    wm_os_sem_t *done_sem;                                 /**< Released when the write task has stopped */
+    volatile int write_ret;                                /**< Result of the first failed write */
+    wm_ota_block_t *blocks[CONFIG_OTA_PIPELINE_BLOCK_NUM]; /**< Block buffers */
+} wm_ota_pipe_t;
+
+static void ota_pipe_write_task(void *arg)
+{
+    int ret               = WM_ERR_SUCCESS;
+    wm_ota_pipe_t *pipe   = (wm_ota_pipe_t *)arg;
+    wm_ota_ctx_t *ota_ctx = pipe->ota_ctx;
+    wm_ota_block_t *block = NULL;
+
+    while (wm_os_internal_queue_receive(pipe->full_queue, (void **)&block, WM_OS_WAIT_TIME_MAX) == WM_OS_STATUS_SUCCESS &&
+           block != NULL) {
+        // Blocks queued after a failed write are dropped.
+        if (pipe->write_ret == WM_ERR_SUCCESS) {
+            ret = wm_ota_ops_write(&ota_ctx->ota_ops_ctx, block->data, block->len);
+            if (ret == WM_ERR_SUCCESS) {
+                ota_ctx->wrote_offset += block->len;
+#if CONFIG_OTA_RESUME
+                ota_checkpoint_save(ota_ctx);
+#endif
+            } else {
+                wm_log_error("OTA write failed: %d", ret);
+                pipe->write_ret = ret;
+            }
+        }
+        wm_os_internal_queue_send(pipe->free_queue, block);
+    }
+
+    wm_os_internal_sem_release(pipe->done_sem);
+    wm_os_internal_task_del(NULL);
+}
+
+static void ota_pipe_destroy(wm_ota_pipe_t *pipe)
+{
+    for (int i = 0; i < CONFIG_OTA_PIPELINE_BLOCK_NUM; i++) {
+        wm_os_internal_free(pipe->blocks[i]);
+    }
+    if (pipe->done_sem) {
+        wm_os_internal_sem_delete(pipe->done_sem);
+    }
+    if (pipe->full_queue) {
+        wm_os_internal_queue_delete(pipe->full_queue);
+    }
+    if (pipe->free_queue) {
+        wm_os_internal_queue_delete(pipe->free_queue);
+    }
+    wm_os_internal_free(pipe);
+}
+
+static wm_ota_pipe_t *ota_pipe_create(wm_ota_ctx_t *ota_ctx)
+{
+    wm_ota_pipe_t *pipe = NULL;
+    wm_os_task_t task   = NULL;
+
+    pipe = (wm_ota_pipe_t *)wm_os_internal_malloc(sizeof(wm_ota_pipe_t));
+    if (pipe == NULL) {
+        return NULL;
+    }
+    memset(pipe, 0, sizeof(wm_ota_pipe_t));
+    pipe->ota_ctx = ota_ctx;
+
+    // The full queue also holds the NULL block that stops the write task.
+    if (wm_os_internal_queue_create(&pipe->free_queue, CONFIG_OTA_PIPELINE_BLOCK_NUM) != WM_OS_STATUS_SUCCESS ||
+        wm_os_internal_queue_create(&pipe->full_queue, CONFIG_OTA_PIPELINE_BLOCK_NUM + 1) != WM_OS_STATUS_SUCCESS ||
+        wm_os_internal_sem_create(&pipe->done_sem, 0) != WM_OS_STATUS_SUCCESS) {
+        ota_pipe_destroy(pipe);
+        return NULL;
+    }
+
+    for (int i = 0; i < CONFIG_OTA_PIPELINE_BLOCK_NUM; i++) {
+        // +1 for http
+        pipe->blocks[i] = (wm_ota_block_t *)wm_os_internal_malloc(sizeof(wm_ota_block_t) + CONFIG_OTA_BLOCK_SIZE + 1);
+        if (pipe->blocks[i] == NULL) {
+            ota_pipe_destroy(pipe);
+            return NULL;
+        }
+        wm_os_internal_queue_send(pipe->free_queue, pipe->blocks[i]);
+    }
+
+    if (wm_os_internal_task_create(&task, "ota_write", ota_pipe_write_task, pipe, WM_TASK_OTA_WRITE_STACK,
+                                   WM_TASK_OTA_WRITE_PRIO, 0) != WM_OS_STATUS_SUCCESS) {
+        ota_pipe_destroy(pipe);
+        return NULL;
+    }
+
+    return pipe;
+}
+
+static int ota_download(wm_ota_ctx_t *ota_ctx, bool reboot)
+{
+    int ret                     = WM_ERR_SUCCESS;
+    wm_ota_pipe_t *pipe         = NULL;
+    wm_ota_block_t *block       = NULL;
+    uint32_t progress           = 0;
+    uint32_t read_size          = 0;
+    uint32_t got                = 0;
+    uint32_t recv_offset        = ota_ctx->wrote_offset;
+    uint32_t ota_img_total_size = ota_ctx->total_size;
+
+    pipe = ota_pipe_create(ota_ctx);
+    if (pipe == NULL) {
+        wm_ota_update_state(ota_ctx, WM_OTA_STATUS_ABORT, progress);
+        return WM_ERR_NO_MEM;
+    }
+    wm_log_debug("OTA block size: %d, blocks: %d", CONFIG_OTA_BLOCK_SIZE, CONFIG_OTA_PIPELINE_BLOCK_NUM);
+
+    // Fill free blocks from the network while the write task programs the filled ones.
+    while (!ota_img_total_size || recv_offset < ota_img_total_size) {
+        wm_os_internal_queue_receive(pipe->free_queue, (void **)&block, WM_OS_WAIT_TIME_MAX);
+        if (pipe->write_ret != WM_ERR_SUCCESS) {
+            wm_os_internal_queue_send(pipe->free_queue, block);
+            break;
+        }
+        wm_ota_update_progress(ota_ctx, &progress, ota_img_total_size);
+
+        // Fill the whole block, so flash is always programmed in CONFIG_OTA_BLOCK_SIZE units.
+        block->len = 0;
+        while (block->len < CONFIG_OTA_BLOCK_SIZE && (!ota_img_total_size || recv_offset + block->len < ota_img_total_size)) {
+            read_size = CONFIG_OTA_BLOCK_SIZE - block->len;
+            if (ota_img_total_size && read_size > ota_img_total_size - recv_offset - block->len) {
+                read_size = ota_img_total_size - recv_offset - block->len;
+            }
+
+            got = 0;
+            ret = ota_ctx->ota_session.ota_get_firmware_cb(ota_ctx->handle, 0, block->data + block->len, read_size, &got);
+            if (ret != WM_ERR_SUCCESS) {
+                break;
+            } else if (got == 0) {
+                wm_os_internal_time_delay_ms(10);
+                continue;
+            }
+            block->len += got;
+
+            // The first block starts with the header, which holds the stream size.
+            if (!ota_img_total_size && !recv_offset && block->len >= OTA_FW_HEADER_SIZE_IN_BIN) {
+                ota_img_total_size  = wm_ota_ops_get_stream_size(block->data, block->len);
+                ota_ctx->total_size = ota_img_total_size;
+            }
+        }
+
+        // Data received before an error is still written, a retry continues after it.
+        if (block->len) {
+            recv_offset += block->len;
+            wm_os_internal_queue_send(pipe->full_queue, block);
+        } else {
+            wm_os_internal_queue_send(pipe->free_queue, block);
+        }
+
+        if (ret != WM_ERR_SUCCESS) {
+            wm_ota_update_state(ota_ctx, WM_OTA_STATUS_DOWNLOAD_FAILED, progress);
+            wm_log_error("OTA get firmware failed: %d", ret);
+            break;
+        }
+    }
+
+    // Wait for the queued blocks to be written, wrote_offset is exact afterwards.
+    wm_os_internal_queue_forever_send(pipe->full_queue, NULL);
+    wm_os_internal_sem_acquire(pipe->done_sem, WM_OS_WAIT_TIME_MAX);
+
+    if (ret == WM_ERR_SUCCESS && pipe->write_ret != WM_ERR_SUCCESS) {
+        ret = pipe->write_ret;
+        wm_ota_update_state(ota_ctx, WM_OTA_STATUS_ABORT, progress);
+    }
+    ota_pipe_destroy(pipe);
+
+    if (ret == WM_ERR_SUCCESS) {
+        ret = ota_finish(ota_ctx, reboot);
+    }
+
+    return ret;
+}
+#else
+static int ota_download(wm_ota_ctx_t *ota_ctx, bool reboot)
+{
+    int ret                     = WM_ERR_SUCCESS;
+    uint8_t *ota_buffer         = NULL;
+    uint32_t progress           = 0;
+    uint32_t next_read_size     = CONFIG_OTA_BLOCK_SIZE;
+    uint32_t got                = 0;
+    uint32_t ota_img_total_size = ota_ctx->total_size;
+
     // Allocate memory for the OTA buffer.
     ota_buffer = (uint8_t *)wm_os_internal_malloc(CONFIG_OTA_BLOCK_SIZE + 1); // +1 for http
     if (ota_buffer == NULL) {
@@ -104,15 +470,14 @@ static int ota_start(wm_ota_ctx_t *ota_ctx, bool reboot)
 
         // Update progress and check if the download is complete.
         if (!ota_img_total_size) {
-            ota_img_total_size = ota_ctx->ota_ops_ctx.ota_header.img_len + OTA_FW_HEADER_SIZE_IN_BIN;
+            ota_img_total_size  = wm_ota_ops_get_stream_size(ota_buffer, got);
+            ota_ctx->total_size = ota_img_total_size;
         }
         ota_ctx->wrote_offset += got;
-        new_progress = ota_ctx->wrote_offset * 100 / ota_img_total_size;
-        if (progress != new_progress) {
-            printf(".");
-            progress = new_progress;
-            wm_ota_update_state(ota_ctx, WM_OTA_STATUS_DOWNLOAD_START, progress);
-        }
+#if CONFIG_OTA_RESUME
+        ota_checkpoint_save(ota_ctx);
+#endif
+        wm_ota_update_progress(ota_ctx, &progress, ota_img_total_size);
         if ((ota_img_total_size - ota_ctx->wrote_offset) >= CONFIG_OTA_BLOCK_SIZE) {
             next_read_size = CONFIG_OTA_BLOCK_SIZE;
         } else {
@@ -120,24 +485,7 @@ static int ota_start(wm_ota_ctx_t *ota_ctx, bool reboot)
         }
         // wm_log_debug("OTA wrote offset: %d(%d), got: %d", ota_ctx->wrote_offset, ota_img_total_size, got);
         if (ota_ctx->wrote_offset >= ota_img_total_size) {
-            printf(".\n");
-            progress = 100;
-            ret      = wm_ota_ops_end(&ota_ctx->ota_ops_ctx);
-            if (ret != WM_ERR_SUCCESS) {
-                wm_ota_update_state(ota_ctx, WM_OTA_STATUS_ABORT, progress);
-                wm_log_error("OTA end failed: %d", ret);
-                break;
-            }
-
-            wm_ota_update_state(ota_ctx, WM_OTA_STATUS_DOWNLOADED, progress);
-            if (reboot) {
-                wm_ota_update_state(ota_ctx, WM_OTA_STATUS_UPGRADE_START, progress);
-                wm_os_internal_time_delay_ms(10);
-                ret = wm_ota_ops_reboot();
-                if (ret != WM_ERR_SUCCESS) {
-                    wm_ota_update_state(ota_ctx, WM_OTA_STATUS_UPGRADE_FAILED, progress);
-                }
-            }
+            ret = ota_finish(ota_ctx, reboot);
             break;
         }
         wm_os_internal_time_delay_ms(1);
@@ -148,6 +496,21 @@ static int ota_start(wm_ota_ctx_t *ota_ctx, bool reboot)
 
     return ret;
 }
+#endif /* CONFIG_OTA_PIPELINE */
+
+static int ota_start(wm_ota_ctx_t *ota_ctx, bool reboot)
+{
+    int ret = WM_ERR_SUCCESS;
+
+    ret = ota_connect(ota_ctx);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    wm_ota_update_state(ota_ctx, WM_OTA_STATUS_DOWNLOAD_START, 0);
+
+    return ota_download(ota_ctx, reboot);
+}
 
 int wm_ota_start(wm_ota_ctx_t *ota_ctx, bool reboot)
 {
@@ -224,6 +587,7 @@ int wm_ota_deinit(wm_ota_ctx_t *ota_ctx)
 
     // Deinitialize the OTA context and clean up.
     wm_ota_stop(ota_ctx);
+    wm_ota_ops_abort(&ota_ctx->ota_ops_ctx);
     memset(ota_ctx, 0, sizeof(wm_ota_ctx_t));
 
     return ret;
@@ -0,0 +1,108 @@
+#include <string.h>
+#include "wm_ota_lzss.h"
+
+void wm_ota_lzss_init(wm_ota_lzss_t *lzss, uint8_t *window, uint32_t window_bits, uint32_t lookahead_bits,
+                      uint32_t orig_size, wm_ota_lzss_out_t out, void *arg)
+{
+    memset(lzss, 0, sizeof(wm_ota_lzss_t));
+    lzss->out            = out;
+    lzss->arg            = arg;
+    lzss->window_bits    = window_bits;
+    lzss->lookahead_bits = lookahead_bits;
+    lzss->orig_size      = orig_size;
+    lzss->win_size       = 1U << window_bits;
+    lzss->window         = window;
+
+    // Back references before the start of the data read zeros, as heatshrink does.
+    memset(window, 0, lzss->win_size);
+}
+
+/* Pass the decompressed bytes not passed on yet to the output function. */
+static int wm_ota_lzss_flush(wm_ota_lzss_t *lzss)
+{
+    int ret = WM_ERR_SUCCESS;
+
+    if (lzss->win_pos > lzss->win_flushed) {
+        ret = lzss->out(lzss->arg, lzss->window + lzss->win_flushed, lzss->win_pos - lzss->win_flushed);
+    }
+    lzss->win_flushed = lzss->win_pos;
+
+    return ret;
+}
+
+static int wm_ota_lzss_put(wm_ota_lzss_t *lzss, uint8_t c)
+{
+    int ret = WM_ERR_SUCCESS;
+
+    if (lzss->produced == lzss->orig_size) {
+        return WM_ERR_OTA_DECOMPRESS;
+    }
+
+    lzss->window[lzss->win_pos++] = c;
+    lzss->produced++;
+
+    // The window is written out whenever it wraps, it keeps serving as history afterwards.
+    if (lzss->win_pos == lzss->win_size || lzss->produced == lzss->orig_size) {
+        ret = wm_ota_lzss_flush(lzss);
+        if (lzss->win_pos == lzss->win_size) {
+            lzss->win_pos     = 0;
+            lzss->win_flushed = 0;
+        }
+    }
+
+    return ret;
+}
+
+/* Decode the complete literals and back references in the bit buffer. */
+static int wm_ota_lzss_decode_bits(wm_ota_lzss_t *lzss)
+{
+    int ret                 = WM_ERR_SUCCESS;
+    uint32_t window_bits    = lzss->window_bits;
+    uint32_t lookahead_bits = lzss->lookahead_bits;
+    uint32_t need           = 0;
+    uint32_t index          = 0;
+    uint32_t count          = 0;
+    uint32_t pos            = 0;
+
+    while (lzss->bit_cnt > 0 && lzss->produced < lzss->orig_size) {
+        // A set tag bit is followed by a literal byte, a clear one by a back reference.
+        need = ((lzss->bits >> (lzss->bit_cnt - 1)) & 1) ? 9 : (1 + window_bits + lookahead_bits);
+        if (lzss->bit_cnt < need) {
+            break;
+        }
+        lzss->bit_cnt -= need;
+
+        if (need == 9) {
+            ret = wm_ota_lzss_put(lzss, (uint8_t)(lzss->bits >> lzss->bit_cnt));
+        } else {
+            index = (uint32_t)(lzss->bits >> (lzss->bit_cnt + lookahead_bits)) & (lzss->win_size - 1);
+            count = ((uint32_t)(lzss->bits >> lzss->bit_cnt) & ((1U << lookahead_bits) - 1)) + 1;
+            pos   = (lzss->win_pos - index - 1) & (lzss->win_size - 1);
+            while (count-- > 0 && ret == WM_ERR_SUCCESS) {
+                ret = wm_ota_lzss_put(lzss, lzss->window[pos]);
+                pos = (pos + 1) & (lzss->win_size - 1);
+            }
+        }
+        lzss->bits &= (1ULL << lzss->bit_cnt) - 1;
+
+        if (ret != WM_ERR_SUCCESS) {
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+int wm_ota_lzss_decode(wm_ota_lzss_t *lzss, const uint8_t *data, uint32_t size)
+{
+    int ret = WM_ERR_SUCCESS;
+
+    while (size > 0 && ret == WM_ERR_SUCCESS) {
+        lzss->bits = (lzss->bits << 8) | *data++;
+        lzss->bit_cnt += 8;
+        size--;
+        ret = wm_ota_lzss_decode_bits(lzss);
+    }
+
+    return ret;
+}
@@ -0,0 +1,80 @@
+#ifndef __WM_OTA_LZSS_H__
+#define __WM_OTA_LZSS_H__
+
+#include "wm_types.h"
+#include "wm_error.h"
+#ifndef WM_OTA_HOST
+#include "wm_ota_ops.h"
+#else
+/* The host test builds the decoder without the device headers */
+#define WM_ERR_OTA_DECOMPRESS (WM_ERR_OTA_BASE - 13)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Receives decompressed data, each time the window wraps and at the end of the data.
+ *
+ * @return WM_ERR_SUCCESS to go on, any other value is returned by wm_ota_lzss_decode
+ */
+typedef int (*wm_ota_lzss_out_t)(void *arg, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief LZSS decoder state, for the heatshrink bit format described at wm_ota_comp_header_t.
+ *
+ * The decoder keeps no other memory than the window, which also serves as the
+ * output buffer.
+ */
+typedef struct {
+    wm_ota_lzss_out_t out;   /**< Output function */
+    void *arg;               /**< Argument of out */
+    uint32_t window_bits;    /**< Base-2 logarithm of the window size */
+    uint32_t lookahead_bits; /**< Base-2 logarithm of the longest back reference */
+    uint32_t orig_size;      /**< Size of the data once decompressed */
+    uint32_t produced;       /**< Decompressed bytes */
+    uint64_t bits;           /**< Input bits not decoded yet, the oldest in the highest bits */
+    uint32_t bit_cnt;        /**< Number of valid bits in bits */
+    uint32_t win_size;       /**< Window size in bytes */
+    uint32_t win_pos;        /**< Position of the next decompressed byte in window */
+    uint32_t win_flushed;    /**< Bytes of window already passed on */
+    uint8_t *window;         /**< Decompressed data, win_size bytes */
+} wm_ota_lzss_t;
+
+/**
+ * @brief Prepare a decoder
+ *
+ * @param[out] lzss: decoder state
+ * @param[in] window: 2^window_bits bytes used as window and output buffer
+ * @param[in] window_bits: base-2 logarithm of the window size
+ * @param[in] lookahead_bits: base-2 logarithm of the longest back reference, less than window_bits
+ * @param[in] orig_size: size of the data once decompressed
+ * @param[in] out: output function
+ * @param[in] arg: argument of out
+ */
+void wm_ota_lzss_init(wm_ota_lzss_t *lzss, uint8_t *window, uint32_t window_bits, uint32_t lookahead_bits,
+                      uint32_t orig_size, wm_ota_lzss_out_t out, void *arg);
+
+/**
+ * @brief Decode a piece of compressed data, the data may be split anywhere
+ *
+ * Bits after the last byte of orig_size are ignored, they are the padding of
+ * the last byte. The data is complete when produced reaches orig_size.
+ *
+ * @param[in] lzss: decoder state
+ * @param[in] data: compressed data
+ * @param[in] size: size of data
+ *
+ * @return
+ *    - WM_ERR_SUCCESS: succeed
+ *    - WM_ERR_OTA_DECOMPRESS: the data decompresses to more than orig_size
+ *    - others: error returned by the output function
+ */
+int wm_ota_lzss_decode(wm_ota_lzss_t *lzss, const uint8_t *data, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WM_OTA_LZSS_H__ */
@@ -6,15 +6,93 @@
 #include "wm_osal.h"
 #include "wm_utils.h"
 #include "wm_debug.h"
+#if CONFIG_OTA_DECOMPRESS
+#include "wm_ota_lzss.h"
+#endif
 
 #define LOG_TAG "ota_ops"
 #include "wm_log.h"
 
 #define OTA_FLASH_BASE_ADDR        (0x8000000)  /**< Base address of the flash memory */
 #define OTA_FLASH_SECTOR_SIZE      (0x1000)     /**< Flash sector size: 4096 bytes */
+#define OTA_FLASH_PAGE_SIZE        (0x100)      /**< Flash page size: 256 bytes */
 #define OTA_MAGIC_NO               (0xA0FFFF9F) /**< OTA firmware header magic number */
 #define OTA_APP_RUN_ADDRESS_OFFSET (0x400)      /**< Run address offset for the application */
 
+#define OTA_MIN(a, b)              ((a) < (b) ? (a) : (b))
+
+#if CONFIG_OTA_DELTA
+#define OTA_DELTA_MAGIC_NO  (0x50444D57) /**< Delta patch magic number, "WMDP" in memory */
+#define OTA_DELTA_VERSION   (1)          /**< Delta patch format version */
+#define OTA_DELTA_CTRL_SIZE (12)         /**< Size of a record control block: diff_len, extra_len, seek */
+
+typedef enum {
+    WM_OTA_DELTA_STAGE_HEADER = 0, /**< Receiving the patch header */
+    WM_OTA_DELTA_STAGE_CTRL,       /**< Receiving a record control block */
+    WM_OTA_DELTA_STAGE_DIFF,       /**< Receiving the diff bytes of a record */
+    WM_OTA_DELTA_STAGE_EXTRA,      /**< Receiving the extra bytes of a record */
+    WM_OTA_DELTA_STAGE_DONE,       /**< The whole OTA image has been rebuilt */
+} wm_ota_delta_stage_t;
+
+struct wm_ota_ops_delta {
+    wm_ota_delta_header_t header;                /**< Patch header */
+    uint8_t hold[sizeof(wm_ota_delta_header_t)]; /**< Header or control block bytes received so far */
+    uint32_t hold_len;                           /**< Number of valid bytes in hold */
+    uint32_t stage;                              /**< Current stage, wm_ota_delta_stage_t */
+    uint32_t consumed;                           /**< Patch bytes received */
+    uint32_t diff_len;                           /**< Diff bytes left in the current record */
+    uint32_t extra_len;                          /**< Extra bytes left in the current record */
+    int32_t seek;                                /**< Read position adjustment at the end of the current record */
+    uint32_t old_pos;                            /**< Read position in the running firmware */
+    uint32_t new_pos;                            /**< Bytes of the OTA image rebuilt */
+    uint32_t out_len;                            /**< Number of valid bytes in out */
+    uint8_t out[OTA_FLASH_SECTOR_SIZE];          /**< Rebuilt bytes not written yet */
+};
+#endif /* CONFIG_OTA_DELTA */
+
+#if CONFIG_OTA_DECOMPRESS
+#define OTA_COMP_MAGIC_NO    (0x5A4D4D57) /**< Compressed stream magic number, "WMMZ" in memory */
+#define OTA_COMP_VERSION     (1)          /**< Compressed stream format version */
+#define OTA_COMP_METHOD_LZSS (1)          /**< LZSS in the heatshrink bit format */
+
+struct wm_ota_ops_decomp {
+    wm_ota_comp_header_t header;                /**< Stream header */
+    uint8_t hold[sizeof(wm_ota_comp_header_t)]; /**< Header bytes received so far */
+    uint32_t hold_len;                          /**< Number of valid bytes in hold */
+    uint32_t consumed;                          /**< Stream bytes received */
+    wm_ota_lzss_t lzss;                         /**< Decoder, set up once the header is checked */
+    uint8_t window[];                           /**< Decoder window, 2^CONFIG_OTA_DECOMPRESS_WINDOW_BITS bytes */
+};
+#endif /* CONFIG_OTA_DECOMPRESS */
+
+static wm_device_t *g_ota_flash_dev = NULL; /**< iflash device, looked up once per update */
+static wm_device_t *g_ota_crc_dev   = NULL; /**< crc device, initialized once per update */
+
+static wm_device_t *wm_ota_ops_flash_dev(void)
+{
+    if (g_ota_flash_dev == NULL) {
+        g_ota_flash_dev = wm_dt_get_device_by_name("iflash");
+    }
+
+    return g_ota_flash_dev;
+}
+
+static wm_device_t *wm_ota_ops_crc_dev(void)
+{
+    if (g_ota_crc_dev == NULL) {
+        g_ota_crc_dev = wm_drv_crc_init("crc");
+    }
+
+    return g_ota_crc_dev;
+}
+
+/* The devices may be freed between updates, look them up again for the next one */
+static void wm_ota_ops_release_dev(void)
+{
+    g_ota_flash_dev = NULL;
+    g_ota_crc_dev   = NULL;
+}
+
 static int wm_ota_ops_check_header(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, size_t size)
 {
     int ret             = WM_ERR_SUCCESS;
@@ -155,8 +233,10 @@ int wm_ota_ops_begin(wm_ota_ops_ctx_t *wm_ota_ops_ctx, size_t image_size)
         return WM_ERR_INVALID_PARAM;
     }
     wm_ota_ops_ctx->wrote_addr = wm_ota_ops_ctx->app_ota_addr;
+    wm_ota_ops_ctx->erased_end = wm_ota_ops_ctx->app_ota_addr;
 
-    flash_dev = wm_dt_get_device_by_name("iflash");
+    wm_ota_ops_release_dev();
+    flash_dev = wm_ota_ops_flash_dev();
 
     // Erase the last 4K flash of the app_ota partition
     ret = wm_drv_flash_erase_region(
@@ -165,22 +245,35 @@ int wm_ota_ops_begin(wm_ota_ops_ctx_t *wm_ota_ops_ctx, size_t image_size)
         return ret;
     }
 
+#if CONFIG_OTA_WRITE_COMPARE
+    // Sectors are compared with the image and only erased when they differ, while the image is written.
+    // The header sector is erased first: an interrupted update must not leave the previous header in front of
+    // a partly rewritten image, and the header is only written again once the new one has been checked.
+    ret = wm_drv_flash_erase_region(flash_dev, wm_ota_ops_ctx->app_ota_addr, OTA_FLASH_SECTOR_SIZE);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+    wm_ota_ops_ctx->erased_end = wm_ota_ops_ctx->app_ota_addr + OTA_FLASH_SECTOR_SIZE;
+    image_size                 = OTA_WITH_SEQUENTIAL_WRITES;
+#endif
+
     // Determine if a full erase is needed based on the image size and erase the flash if necessary.
     if (image_size != OTA_WITH_SEQUENTIAL_WRITES) {
         if ((image_size == 0) || (image_size == OTA_SIZE_UNKNOWN)) {
-            ret = wm_drv_flash_erase_region(flash_dev, wm_ota_ops_ctx->app_ota_addr, wm_ota_ops_ctx->app_ota_size);
+            aligned_erase_size = wm_ota_ops_ctx->app_ota_size;
         } else {
             if (image_size > wm_ota_ops_ctx->app_ota_size) {
                 return WM_ERR_OTA_FW_OVERFLOW;
             }
             aligned_erase_size = (image_size + OTA_FLASH_SECTOR_SIZE - 1) & ~(OTA_FLASH_SECTOR_SIZE - 1);
-            ret                = wm_drv_flash_erase_region(flash_dev, wm_ota_ops_ctx->app_ota_addr, aligned_erase_size);
         }
+        ret = wm_drv_flash_erase_region(flash_dev, wm_ota_ops_ctx->app_ota_addr, aligned_erase_size);
 
         if (ret != WM_ERR_SUCCESS) {
             wm_ota_ops_ctx->need_erase = 1;
         } else {
             wm_ota_ops_ctx->need_erase = 0;
+            wm_ota_ops_ctx->erased_end = wm_ota_ops_ctx->app_ota_addr + aligned_erase_size;
         }
     } else {
         wm_ota_ops_ctx->need_erase = 1;
@@ -189,48 +282,143 @@ int wm_ota_ops_begin(wm_ota_ops_ctx_t *wm_ota_ops_ctx, size_t image_size)
     return ret;
 }
 
-int wm_ota_ops_write(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint32_t size)
+#if CONFIG_OTA_WRITE_COMPARE
+/* Compare flash with data, programmable tells whether the flash can take data without an erase. */
+static bool wm_ota_ops_flash_same(wm_device_t *flash_dev, uint32_t addr, const uint8_t *data, uint32_t size,
+                                  bool *programmable)
 {
-    int ret                = WM_ERR_SUCCESS;
-    uint32_t first_sector  = 0;
-    uint32_t last_sector   = 0;
-    wm_device_t *flash_dev = NULL;
+    uint8_t buf[64];
+    uint32_t len = 0;
+    uint32_t i   = 0;
+    bool same    = true;
+
+    *programmable = true;
+
+    while (size) {
+        len = OTA_MIN(size, sizeof(buf));
+        if (wm_drv_flash_read(flash_dev, addr, buf, len) != WM_ERR_SUCCESS) {
+            *programmable = false;
+            return false;
+        }
+        for (i = 0; i < len; i++) {
+            if (buf[i] != data[i]) {
+                same = false;
+                // Programming only clears bits.
+                if ((buf[i] & data[i]) != data[i]) {
+                    *programmable = false;
+                    return false;
+                }
+            }
+        }
+        addr += len;
+        data += len;
+        size -= len;
+    }
 
-    if (wm_ota_ops_ctx == NULL || data == NULL || size == 0 || !wm_ota_ops_ctx->app_ota_addr) {
-        return WM_ERR_INVALID_PARAM;
+    return same;
+}
+
+/* Erase the sector holding addr, the data before addr in that sector is already part of the image and is kept. */
+static int wm_ota_ops_erase_keep(wm_device_t *flash_dev, uint32_t addr)
+{
+    int ret        = WM_ERR_SUCCESS;
+    uint32_t start = addr & ~(OTA_FLASH_SECTOR_SIZE - 1);
+    uint8_t *keep  = NULL;
+
+    if (addr > start) {
+        keep = wm_os_internal_malloc(addr - start);
+        if (keep == NULL) {
+            return WM_ERR_NO_MEM;
+        }
+        ret = wm_drv_flash_read(flash_dev, start, keep, addr - start);
     }
 
-    if (wm_ota_ops_ctx->wrote_addr < wm_ota_ops_ctx->app_ota_addr ||
-        size > (wm_ota_ops_ctx->app_ota_addr + wm_ota_ops_ctx->app_ota_size - wm_ota_ops_ctx->wrote_addr)) {
-        return WM_ERR_NOT_ALLOWED;
+    if (ret == WM_ERR_SUCCESS) {
+        ret = wm_drv_flash_erase_region(flash_dev, start, OTA_FLASH_SECTOR_SIZE);
+    }
+    if (ret == WM_ERR_SUCCESS && keep != NULL) {
+        ret = wm_drv_flash_write(flash_dev, start, keep, addr - start);
     }
 
-    flash_dev = wm_dt_get_device_by_name("iflash");
+    wm_os_internal_free(keep);
 
-    // If a sector erase is needed, calculate the sector range and perform the erase.
-    if (wm_ota_ops_ctx->need_erase) {
-        first_sector = wm_ota_ops_ctx->wrote_addr / OTA_FLASH_SECTOR_SIZE;
-        last_sector  = (wm_ota_ops_ctx->wrote_addr + size) / OTA_FLASH_SECTOR_SIZE;
+    return ret;
+}
+#endif /* CONFIG_OTA_WRITE_COMPARE */
 
-        if ((wm_ota_ops_ctx->wrote_addr % OTA_FLASH_SECTOR_SIZE) == 0) {
-            if (size % OTA_FLASH_SECTOR_SIZE == 0) {
-                ret = wm_drv_flash_erase_region(flash_dev, wm_ota_ops_ctx->wrote_addr,
-                                                (last_sector - first_sector) * OTA_FLASH_SECTOR_SIZE);
+/*
+ * Flash from wrote_addr up to erased_end is erased and takes a plain page program. Further sectors are erased
+ * ahead of the data, or with CONFIG_OTA_WRITE_COMPARE compared page by page first, so pages that already hold
+ * the data are not touched when the same image is flashed again.
+ */
+static int wm_ota_ops_program(wm_ota_ops_ctx_t *wm_ota_ops_ctx, wm_device_t *flash_dev, const uint8_t *data, uint32_t size)
+{
+    int ret       = WM_ERR_SUCCESS;
+    uint32_t addr = wm_ota_ops_ctx->wrote_addr;
+    uint32_t len  = 0;
+#if CONFIG_OTA_WRITE_COMPARE
+    bool programmable = false;
+#endif
+
+    while (size) {
+        if (addr < wm_ota_ops_ctx->erased_end) {
+            len = OTA_MIN(size, wm_ota_ops_ctx->erased_end - addr);
+            ret = wm_drv_flash_write(flash_dev, addr, (uint8_t *)data, len);
+        } else {
+#if CONFIG_OTA_WRITE_COMPARE
+            len = OTA_MIN(size, OTA_FLASH_PAGE_SIZE - addr % OTA_FLASH_PAGE_SIZE);
+            if (wm_ota_ops_flash_same(flash_dev, addr, data, len, &programmable)) {
+                ret = WM_ERR_SUCCESS;
+            } else if (programmable) {
+                ret = wm_drv_flash_write(flash_dev, addr, (uint8_t *)data, len);
             } else {
-                ret = wm_drv_flash_erase_region(flash_dev, wm_ota_ops_ctx->wrote_addr,
-                                                ((last_sector - first_sector) + 1) * OTA_FLASH_SECTOR_SIZE);
+                ret = wm_ota_ops_erase_keep(flash_dev, addr);
+                if (ret == WM_ERR_SUCCESS) {
+                    wm_ota_ops_ctx->erased_end = (addr + OTA_FLASH_SECTOR_SIZE) & ~(OTA_FLASH_SECTOR_SIZE - 1);
+                }
+                len = 0;
             }
-        } else if (first_sector != last_sector) {
-            ret = wm_drv_flash_erase_region(flash_dev, (first_sector + 1) * OTA_FLASH_SECTOR_SIZE,
-                                            (last_sector - first_sector) * OTA_FLASH_SECTOR_SIZE);
+#else
+            if (addr % OTA_FLASH_SECTOR_SIZE) {
+                // Only after a resume, the rest of the sector may hold data written after the checkpoint.
+                len = OTA_MIN(size, OTA_FLASH_SECTOR_SIZE - addr % OTA_FLASH_SECTOR_SIZE);
+                ret = wm_drv_flash_write_with_erase(flash_dev, addr, (uint8_t *)data, len);
+            } else {
+                len = (size + OTA_FLASH_SECTOR_SIZE - 1) & ~(OTA_FLASH_SECTOR_SIZE - 1);
+                ret = wm_drv_flash_erase_region(flash_dev, addr, len);
+                if (ret == WM_ERR_SUCCESS) {
+                    wm_ota_ops_ctx->erased_end = addr + len;
+                }
+                len = 0;
+            }
+#endif
         }
         if (ret != WM_ERR_SUCCESS) {
             return ret;
         }
+
+        addr += len;
+        data += len;
+        size -= len;
     }
 
+    return ret;
+}
+
+static int wm_ota_ops_write_image(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint32_t size)
+{
+    int ret                = WM_ERR_SUCCESS;
+    wm_device_t *flash_dev = NULL;
+
+    if (wm_ota_ops_ctx->wrote_addr < wm_ota_ops_ctx->app_ota_addr ||
+        size > (wm_ota_ops_ctx->app_ota_addr + wm_ota_ops_ctx->app_ota_size - wm_ota_ops_ctx->wrote_addr)) {
+        return WM_ERR_NOT_ALLOWED;
+    }
+
+    flash_dev = wm_ota_ops_flash_dev();
+
     wm_device_t *crc_dev;
-    crc_dev = wm_drv_crc_init("crc");
+    crc_dev = wm_ota_ops_crc_dev();
     // Verify the header of the OTA image if it's the first write operation.
     if (wm_ota_ops_ctx->app_ota_addr == wm_ota_ops_ctx->wrote_addr) {
         ret = wm_ota_ops_check_header(wm_ota_ops_ctx, data, size);
@@ -250,8 +438,7 @@ int wm_ota_ops_write(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint
     }
 
     // Write the data to the flash memory.
-    //TODO: need to replace to wm_drv_flash_write() in future as it has some abnormal currently
-    ret = wm_drv_flash_write_with_erase(flash_dev, wm_ota_ops_ctx->wrote_addr, (void *)data, size);
+    ret = wm_ota_ops_program(wm_ota_ops_ctx, flash_dev, data, size);
     if (ret == WM_ERR_SUCCESS) {
         wm_ota_ops_ctx->wrote_addr += size; // Update the write address after successful write.
     }
@@ -259,26 +446,491 @@ int wm_ota_ops_write(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint
     return ret;
 }
 
+#if CONFIG_OTA_DELTA
+/* The running firmware is read as the .img it was flashed from: the header at app_addr, the code at the run address. */
+static int wm_ota_delta_read_old(wm_ota_ops_ctx_t *wm_ota_ops_ctx, uint32_t pos, uint8_t *buf, uint32_t len)
+{
+    int ret                = WM_ERR_SUCCESS;
+    uint32_t addr          = 0;
+    uint32_t n             = 0;
+    wm_device_t *flash_dev = wm_ota_ops_flash_dev();
+
+    while (len > 0) {
+        if (pos < OTA_FW_HEADER_SIZE_IN_BIN) {
+            addr = wm_ota_ops_ctx->app_addr + pos;
+            n    = OTA_MIN(len, OTA_FW_HEADER_SIZE_IN_BIN - pos);
+        } else {
+            addr = wm_ota_ops_ctx->app_addr + OTA_APP_RUN_ADDRESS_OFFSET + pos - OTA_FW_HEADER_SIZE_IN_BIN;
+            n    = len;
+        }
+
+        ret = wm_drv_flash_read(flash_dev, addr, buf, n);
+        if (ret != WM_ERR_SUCCESS) {
+            return ret;
+        }
+        pos += n;
+        buf += n;
+        len -= n;
+    }
+
+    return ret;
+}
+
+static int wm_ota_delta_check_header(wm_ota_ops_ctx_t *wm_ota_ops_ctx, struct wm_ota_ops_delta *delta)
+{
+    int ret                       = WM_ERR_SUCCESS;
+    uint32_t crc32                = 0;
+    uint32_t pos                  = 0;
+    uint32_t n                    = 0;
+    wm_device_t *crc_dev          = wm_ota_ops_crc_dev();
+    wm_drv_crc_cfg_t crc          = { 0 };
+    wm_ota_delta_header_t *header = &delta->header;
+
+    memcpy(header, delta->hold, sizeof(wm_ota_delta_header_t));
+
+    if (header->magic_no != OTA_DELTA_MAGIC_NO || header->version != OTA_DELTA_VERSION ||
+        header->patch_size < sizeof(wm_ota_delta_header_t)) {
+        return WM_ERR_OTA_DELTA_INVALID;
+    }
+
+    crc32 = wm_drv_crc32_reverse(header, sizeof(wm_ota_delta_header_t) - 0x04);
+    if (header->hd_checksum != crc32) {
+        wm_log_error("delta crc error,hd_checksum=0x%08X,crc32=0x%08X", (unsigned int)header->hd_checksum,
+                     (unsigned int)crc32);
+        return WM_ERR_OTA_CRC_ERROR;
+    }
+
+    // The base must fit in the application partition, the result in the OTA partition.
+    if (header->old_size <= OTA_FW_HEADER_SIZE_IN_BIN ||
+        header->old_size - OTA_FW_HEADER_SIZE_IN_BIN > wm_ota_ops_ctx->app_size - OTA_APP_RUN_ADDRESS_OFFSET) {
+        return WM_ERR_OTA_DELTA_BASE;
+    }
+    if (header->new_size < OTA_FW_HEADER_SIZE_IN_BIN || header->new_size > wm_ota_ops_ctx->app_ota_size) {
+        return WM_ERR_OTA_FW_OVERFLOW;
+    }
+    if (delta->consumed > header->patch_size) {
+        return WM_ERR_OTA_DELTA_INVALID;
+    }
+
+    // Make sure the patch was built against the running firmware, the out buffer is still free.
+    wm_drv_crc_cfg(crc_dev, &crc, 0xFFFFFFFF, WM_GPSEC_CRC32, WM_GPSEC_CRC_OUT_IN_REVERSE);
+    for (pos = 0; pos < header->old_size; pos += n) {
+        n   = OTA_MIN(header->old_size - pos, sizeof(delta->out));
+        ret = wm_ota_delta_read_old(wm_ota_ops_ctx, pos, delta->out, n);
+        if (ret != WM_ERR_SUCCESS) {
+            return ret;
+        }
+        wm_drv_crc_update(crc_dev, &crc, delta->out, n);
+    }
+    wm_drv_crc_final(crc_dev, &crc, &crc32);
+
+    if (header->old_checksum != crc32) {
+        wm_log_error("delta base mismatch,old_checksum=0x%08X,crc32=0x%08X", (unsigned int)header->old_checksum,
+                     (unsigned int)crc32);
+        return WM_ERR_OTA_DELTA_BASE;
+    }
+
+    wm_log_info("delta patch %u bytes, rebuilding %u bytes", (unsigned int)header->patch_size,
+                (unsigned int)header->new_size);
+
+    return ret;
+}
+
+/* Move on to the part of the record that has bytes left, or to the next record. */
+static int wm_ota_delta_next(struct wm_ota_ops_delta *delta)
+{
+    int64_t old_pos = 0;
+
+    if (delta->diff_len) {
+        delta->stage = WM_OTA_DELTA_STAGE_DIFF;
+    } else if (delta->extra_len) {
+        delta->stage = WM_OTA_DELTA_STAGE_EXTRA;
+    } else {
+        old_pos = (int64_t)delta->old_pos + delta->seek;
+        if (old_pos < 0 || old_pos > delta->header.old_size) {
+            return WM_ERR_OTA_DELTA_INVALID;
+        }
+        delta->old_pos = (uint32_t)old_pos;
+        delta->stage   = (delta->new_pos == delta->header.new_size) ? WM_OTA_DELTA_STAGE_DONE : WM_OTA_DELTA_STAGE_CTRL;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+static int wm_ota_delta_parse_ctrl(struct wm_ota_ops_delta *delta)
+{
+    uint32_t left = delta->header.new_size - delta->new_pos;
+
+    memcpy(&delta->diff_len, delta->hold, sizeof(uint32_t));
+    memcpy(&delta->extra_len, delta->hold + 4, sizeof(uint32_t));
+    memcpy(&delta->seek, delta->hold + 8, sizeof(int32_t));
+
+    if (delta->diff_len > left || delta->extra_len > left - delta->diff_len ||
+        delta->diff_len > delta->header.old_size - delta->old_pos) {
+        return WM_ERR_OTA_DELTA_INVALID;
+    }
+
+    return wm_ota_delta_next(delta);
+}
+
+/* Account for n bytes added to the out buffer, and write it when it is full or the image is complete. */
+static int wm_ota_delta_output(wm_ota_ops_ctx_t *wm_ota_ops_ctx, struct wm_ota_ops_delta *delta, uint32_t n)
+{
+    int ret = WM_ERR_SUCCESS;
+
+    delta->out_len += n;
+    delta->new_pos += n;
+
+    if (delta->out_len == sizeof(delta->out) || delta->new_pos == delta->header.new_size) {
+        ret            = wm_ota_ops_write_image(wm_ota_ops_ctx, delta->out, delta->out_len);
+        delta->out_len = 0;
+    }
+
+    return ret;
+}
+
+static int wm_ota_delta_write(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint32_t size)
+{
+    int ret                        = WM_ERR_SUCCESS;
+    uint32_t need                  = 0;
+    uint32_t n                     = 0;
+    uint32_t i                     = 0;
+    uint8_t *out                   = NULL;
+    struct wm_ota_ops_delta *delta = wm_ota_ops_ctx->delta;
+
+    delta->consumed += size;
+    if (delta->stage != WM_OTA_DELTA_STAGE_HEADER && delta->consumed > delta->header.patch_size) {
+        return WM_ERR_OTA_DELTA_INVALID;
+    }
+
+    while (size > 0 && ret == WM_ERR_SUCCESS) {
+        out = delta->out + delta->out_len;
+
+        switch (delta->stage) {
+            case WM_OTA_DELTA_STAGE_HEADER:
+            case WM_OTA_DELTA_STAGE_CTRL:
+            {
+                need = (delta->stage == WM_OTA_DELTA_STAGE_HEADER) ? sizeof(wm_ota_delta_header_t) : OTA_DELTA_CTRL_SIZE;
+                n    = OTA_MIN(size, need - delta->hold_len);
+                memcpy(delta->hold + delta->hold_len, data, n);
+                delta->hold_len += n;
+                if (delta->hold_len == need) {
+                    delta->hold_len = 0;
+                    if (delta->stage == WM_OTA_DELTA_STAGE_HEADER) {
+                        ret          = wm_ota_delta_check_header(wm_ota_ops_ctx, delta);
+                        delta->stage = WM_OTA_DELTA_STAGE_CTRL;
+                    } else {
+                        ret = wm_ota_delta_parse_ctrl(delta);
+                    }
+                }
+                break;
+            }
+            case WM_OTA_DELTA_STAGE_DIFF:
+            {
+                // Read the base bytes into the out buffer and add the diff bytes on top.
+                n   = OTA_MIN(OTA_MIN(size, delta->diff_len), sizeof(delta->out) - delta->out_len);
+                ret = wm_ota_delta_read_old(wm_ota_ops_ctx, delta->old_pos, out, n);
+                if (ret != WM_ERR_SUCCESS) {
+                    break;
+                }
+                for (i = 0; i < n; i++) {
+                    out[i] += data[i];
+                }
+                delta->old_pos += n;
+                delta->diff_len -= n;
+                ret = wm_ota_delta_output(wm_ota_ops_ctx, delta, n);
+                if (ret == WM_ERR_SUCCESS) {
+                    ret = wm_ota_delta_next(delta);
+                }
+                break;
+            }
+            case WM_OTA_DELTA_STAGE_EXTRA:
+            {
+                n = OTA_MIN(OTA_MIN(size, delta->extra_len), sizeof(delta->out) - delta->out_len);
+                memcpy(out, data, n);
+                delta->extra_len -= n;
+                ret = wm_ota_delta_output(wm_ota_ops_ctx, delta, n);
+                if (ret == WM_ERR_SUCCESS) {
+                    ret = wm_ota_delta_next(delta);
+                }
+                break;
+            }
+            default:
+            {
+                // Data after the last record
+                return WM_ERR_OTA_DELTA_INVALID;
+            }
+        }
+
+        data += n;
+        size -= n;
+    }
+
+    return ret;
+}
+
+static void wm_ota_delta_free(wm_ota_ops_ctx_t *wm_ota_ops_ctx)
+{
+    wm_os_internal_free(wm_ota_ops_ctx->delta);
+    wm_ota_ops_ctx->delta = NULL;
+}
+#endif /* CONFIG_OTA_DELTA */
+
+static int wm_ota_ops_write_stream(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint32_t size)
+{
+#if CONFIG_OTA_DELTA
+    const uint32_t magic_no = OTA_DELTA_MAGIC_NO;
+
+    // A stream starting with the delta magic number is a patch against the running firmware.
+    if (wm_ota_ops_ctx->delta == NULL && wm_ota_ops_ctx->wrote_addr == wm_ota_ops_ctx->app_ota_addr &&
+        size >= sizeof(uint32_t) && !memcmp(data, &magic_no, sizeof(uint32_t))) {
+        wm_ota_ops_ctx->delta = wm_os_internal_malloc(sizeof(struct wm_ota_ops_delta));
+        if (wm_ota_ops_ctx->delta == NULL) {
+            return WM_ERR_NO_MEM;
+        }
+        memset(wm_ota_ops_ctx->delta, 0, sizeof(struct wm_ota_ops_delta));
+    }
+
+    if (wm_ota_ops_ctx->delta != NULL) {
+        return wm_ota_delta_write(wm_ota_ops_ctx, data, size);
+    }
+#endif
+
+    return wm_ota_ops_write_image(wm_ota_ops_ctx, data, size);
+}
+
+#if CONFIG_OTA_DECOMPRESS
+static int wm_ota_decomp_check_header(struct wm_ota_ops_decomp *decomp)
+{
+    uint32_t crc32               = 0;
+    wm_ota_comp_header_t *header = &decomp->header;
+
+    memcpy(header, decomp->hold, sizeof(wm_ota_comp_header_t));
+
+    crc32 = wm_drv_crc32_reverse(header, sizeof(wm_ota_comp_header_t) - 0x04);
+    if (header->hd_checksum != crc32) {
+        wm_log_error("decompress crc error,hd_checksum=0x%08X,crc32=0x%08X", (unsigned int)header->hd_checksum,
+                     (unsigned int)crc32);
+        return WM_ERR_OTA_CRC_ERROR;
+    }
+
+    // The lookahead must leave room for the window index, the back reference fits in the bit buffer then.
+    if (header->version != OTA_COMP_VERSION || header->method != OTA_COMP_METHOD_LZSS ||
+        header->window_bits != CONFIG_OTA_DECOMPRESS_WINDOW_BITS || header->lookahead_bits == 0 ||
+        header->lookahead_bits >= header->window_bits || header->stream_size < sizeof(wm_ota_comp_header_t) ||
+        decomp->consumed > header->stream_size || header->orig_size == 0) {
+        return WM_ERR_OTA_DECOMPRESS;
+    }
+
+    return WM_ERR_SUCCESS;
+}
+
+/* Decompressed data goes on to the delta or image writer. */
+static int wm_ota_decomp_out(void *arg, const uint8_t *data, uint32_t size)
+{
+    return wm_ota_ops_write_stream((wm_ota_ops_ctx_t *)arg, data, size);
+}
+
+static int wm_ota_decomp_write(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint32_t size)
+{
+    int ret                          = WM_ERR_SUCCESS;
+    uint32_t n                       = 0;
+    struct wm_ota_ops_decomp *decomp = wm_ota_ops_ctx->decomp;
+
+    decomp->consumed += size;
+
+    // The header is collected first, it may arrive in pieces.
+    if (decomp->hold_len < sizeof(wm_ota_comp_header_t)) {
+        n = OTA_MIN(size, sizeof(wm_ota_comp_header_t) - decomp->hold_len);
+        memcpy(decomp->hold + decomp->hold_len, data, n);
+        decomp->hold_len += n;
+        data += n;
+        size -= n;
+        if (decomp->hold_len < sizeof(wm_ota_comp_header_t)) {
+            return WM_ERR_SUCCESS;
+        }
+        ret = wm_ota_decomp_check_header(decomp);
+        if (ret != WM_ERR_SUCCESS) {
+            return ret;
+        }
+        wm_ota_lzss_init(&decomp->lzss, decomp->window, decomp->header.window_bits, decomp->header.lookahead_bits,
+                         decomp->header.orig_size, wm_ota_decomp_out, wm_ota_ops_ctx);
+    } else if (decomp->consumed > decomp->header.stream_size) {
+        return WM_ERR_OTA_DECOMPRESS;
+    }
+
+    return wm_ota_lzss_decode(&decomp->lzss, data, size);
+}
+
+static void wm_ota_decomp_free(wm_ota_ops_ctx_t *wm_ota_ops_ctx)
+{
+    wm_os_internal_free(wm_ota_ops_ctx->decomp);
+    wm_ota_ops_ctx->decomp = NULL;
+}
+#endif /* CONFIG_OTA_DECOMPRESS */
+
+int wm_ota_ops_write(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const uint8_t *data, uint32_t size)
+{
+#if CONFIG_OTA_DECOMPRESS
+    const uint32_t magic_no = OTA_COMP_MAGIC_NO;
+#endif
+
+    if (wm_ota_ops_ctx == NULL || data == NULL || size == 0 || !wm_ota_ops_ctx->app_ota_addr) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+#if CONFIG_OTA_DECOMPRESS
+    // A stream starting with the compressed stream magic number is decompressed before anything else.
+    if (wm_ota_ops_ctx->decomp == NULL && wm_ota_ops_ctx->wrote_addr == wm_ota_ops_ctx->app_ota_addr &&
+        size >= sizeof(uint32_t) && !memcmp(data, &magic_no, sizeof(uint32_t))) {
+        wm_ota_ops_ctx->decomp =
+            wm_os_internal_malloc(sizeof(struct wm_ota_ops_decomp) + (1U << CONFIG_OTA_DECOMPRESS_WINDOW_BITS));
+        if (wm_ota_ops_ctx->decomp == NULL) {
+            return WM_ERR_NO_MEM;
+        }
+        memset(wm_ota_ops_ctx->decomp, 0, sizeof(struct wm_ota_ops_decomp));
+    }
+
+    if (wm_ota_ops_ctx->decomp != NULL) {
+        return wm_ota_decomp_write(wm_ota_ops_ctx, data, size);
+    }
+#endif
+
+    return wm_ota_ops_write_stream(wm_ota_ops_ctx, data, size);
+}
+
+uint32_t wm_ota_ops_get_stream_size(const uint8_t *data, uint32_t size)
+{
+    wm_ota_header_t header = { 0 };
+#if CONFIG_OTA_DELTA
+    wm_ota_delta_header_t delta_header = { 0 };
+#endif
+#if CONFIG_OTA_DECOMPRESS
+    wm_ota_comp_header_t comp_header = { 0 };
+#endif
+
+    if (data == NULL || size < OTA_FW_HEADER_SIZE_IN_BIN) {
+        return 0;
+    }
+
+    memcpy(&header, data, sizeof(wm_ota_header_t));
+
+#if CONFIG_OTA_DELTA
+    if (header.magic_no == OTA_DELTA_MAGIC_NO) {
+        memcpy(&delta_header, data, sizeof(wm_ota_delta_header_t));
+        return delta_header.patch_size;
+    }
+#endif
+
+#if CONFIG_OTA_DECOMPRESS
+    if (header.magic_no == OTA_COMP_MAGIC_NO) {
+        memcpy(&comp_header, data, sizeof(wm_ota_comp_header_t));
+        return comp_header.stream_size;
+    }
+#endif
+
+    return header.img_len + OTA_FW_HEADER_SIZE_IN_BIN;
+}
+
+int wm_ota_ops_get_checkpoint(wm_ota_ops_ctx_t *wm_ota_ops_ctx, wm_ota_ops_checkpoint_t *checkpoint)
+{
+    if (wm_ota_ops_ctx == NULL || checkpoint == NULL) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    if (wm_ota_ops_ctx->wrote_addr < wm_ota_ops_ctx->app_ota_addr + OTA_FW_HEADER_SIZE_IN_BIN ||
+        wm_ota_ops_ctx->delta != NULL || wm_ota_ops_ctx->decomp != NULL) {
+        return WM_ERR_NOT_ALLOWED;
+    }
+
+    checkpoint->wrote_addr = wm_ota_ops_ctx->wrote_addr;
+    checkpoint->crc_ctx    = wm_ota_ops_ctx->crc_ctx;
+    checkpoint->ota_header = wm_ota_ops_ctx->ota_header;
+
+    return WM_ERR_SUCCESS;
+}
+
+int wm_ota_ops_resume(wm_ota_ops_ctx_t *wm_ota_ops_ctx, const wm_ota_ops_checkpoint_t *checkpoint)
+{
+    int ret                 = WM_ERR_SUCCESS;
+    wm_ota_header_t written = { 0 };
+
+    if (wm_ota_ops_ctx == NULL || checkpoint == NULL || !wm_ota_ops_ctx->app_ota_addr) {
+        return WM_ERR_INVALID_PARAM;
+    }
+
+    // The header must still be valid for this partition, and still be the one in flash.
+    ret = wm_ota_ops_check_header(wm_ota_ops_ctx, (const uint8_t *)&checkpoint->ota_header, OTA_FW_HEADER_SIZE_IN_BIN);
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    wm_ota_ops_release_dev();
+    ret = wm_drv_flash_read(wm_ota_ops_flash_dev(), wm_ota_ops_ctx->app_ota_addr, (uint8_t *)&written, sizeof(wm_ota_header_t));
+    if (ret != WM_ERR_SUCCESS) {
+        return ret;
+    }
+
+    if (memcmp(&written, &checkpoint->ota_header, sizeof(wm_ota_header_t)) ||
+        checkpoint->wrote_addr < wm_ota_ops_ctx->app_ota_addr + OTA_FW_HEADER_SIZE_IN_BIN ||
+        checkpoint->wrote_addr - wm_ota_ops_ctx->app_ota_addr > checkpoint->ota_header.img_len + OTA_FW_HEADER_SIZE_IN_BIN) {
+        return WM_ERR_OTA_HEADER_INVALID;
+    }
+
+    // Data written after the checkpoint is rewritten, the sectors after the current one are erased on the way.
+    wm_ota_ops_ctx->wrote_addr = checkpoint->wrote_addr;
+    wm_ota_ops_ctx->erased_end = checkpoint->wrote_addr;
+    wm_ota_ops_ctx->crc_ctx    = checkpoint->crc_ctx;
+    wm_ota_ops_ctx->need_erase = 1;
+
+    return ret;
+}
+
 int wm_ota_ops_end(wm_ota_ops_ctx_t *wm_ota_ops_ctx)
 {
     int ret        = WM_ERR_SUCCESS;
     uint32_t crc32 = 0;
-    wm_device_t *crc_dev;
-    crc_dev = wm_drv_crc_init("crc");
 
     if (wm_ota_ops_ctx == NULL || wm_ota_ops_ctx->wrote_addr <= wm_ota_ops_ctx->app_ota_addr) {
         return WM_ERR_INVALID_PARAM;
     }
 
-    // Finalize the CRC calculation and retrieve the result.
-    wm_drv_crc_final(crc_dev, &wm_ota_ops_ctx->crc_ctx, &crc32);
+#if CONFIG_OTA_DECOMPRESS
+    // The stream must have been received completely and decompressed to its original size.
+    if (wm_ota_ops_ctx->decomp != NULL) {
+        if (wm_ota_ops_ctx->decomp->consumed != wm_ota_ops_ctx->decomp->header.stream_size ||
+            wm_ota_ops_ctx->decomp->lzss.produced != wm_ota_ops_ctx->decomp->header.orig_size) {
+            ret = WM_ERR_OTA_DECOMPRESS;
+        }
+        wm_ota_decomp_free(wm_ota_ops_ctx);
+    }
+#endif
+
+#if CONFIG_OTA_DELTA
+    // The patch must have been received completely and rebuilt the whole image.
+    if (wm_ota_ops_ctx->delta != NULL) {
+        if (ret == WM_ERR_SUCCESS && (wm_ota_ops_ctx->delta->stage != WM_OTA_DELTA_STAGE_DONE ||
+                                      wm_ota_ops_ctx->delta->consumed != wm_ota_ops_ctx->delta->header.patch_size)) {
+            ret = WM_ERR_OTA_DELTA_INVALID;
+        }
+        wm_ota_delta_free(wm_ota_ops_ctx);
+    }
+#endif
+
+    if (ret == WM_ERR_SUCCESS) {
+        // Finalize the CRC calculation and retrieve the result.
+        wm_drv_crc_final(wm_ota_ops_crc_dev(), &wm_ota_ops_ctx->crc_ctx, &crc32);
 
-    // Verify the calculated CRC32 against the original checksum in the OTA header.
-    if (wm_ota_ops_ctx->ota_header.org_checksum != crc32) {
-        wm_log_debug("ota crc error,org_checksum=0x%08X,crc32=0x%08X", wm_ota_ops_ctx->ota_header.org_checksum, crc32);
-        return WM_ERR_OTA_CRC_ERROR;
+        // Verify the calculated CRC32 against the original checksum in the OTA header.
+        if (wm_ota_ops_ctx->ota_header.org_checksum != crc32) {
+            wm_log_debug("ota crc error,org_checksum=0x%08X,crc32=0x%08X", wm_ota_ops_ctx->ota_header.org_checksum, crc32);
+            ret = WM_ERR_OTA_CRC_ERROR;
+        }
     }
 
+    // The update is over, the next one looks the devices up again.
+    wm_ota_ops_release_dev();
+
     return ret;
 }
 
@@ -315,6 +967,14 @@ int wm_ota_ops_abort(wm_ota_ops_ctx_t *wm_ota_ops_ctx)
         return WM_ERR_INVALID_PARAM;
     }
 
+#if CONFIG_OTA_DECOMPRESS
+    wm_ota_decomp_free(wm_ota_ops_ctx);
+#endif
+#if CONFIG_OTA_DELTA
+    wm_ota_delta_free(wm_ota_ops_ctx);
+#endif
+    wm_ota_ops_release_dev();
+
     // Clear the OTA context structure to reset the state.
     memset(wm_ota_ops_ctx, 0, sizeof(wm_ota_ops_ctx_t));
 
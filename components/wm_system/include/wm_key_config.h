@@ -9,6 +9,7 @@ extern "C" {
 #define WM_GROUP_BLE           "ble"     /**< nvs store group for ble module      */
 #define WM_GROUP_NETWORK       "network" /**< nvs store group for network modules */
 #define WM_GROUP_USER          "user"    /**< nvs store group for user examples   */
+#define WM_GROUP_OTA           "ota"     /**< nvs store group for ota module      */
 
 #define WM_KEY_STA_MAC_ADDR    "wm_sta_mac"
 #define WM_KEY_SAP_MAC_ADDR    "wm_sap_mac"
@@ -23,6 +24,10 @@ extern "C" {
 
 #define WM_KEY_AT_TCPIP_CONFIG "wm_cfg_at_tcpip"
 
+#define WM_KEY_NM_STA_LEASE    "wm_nm_lease"
+
+#define WM_KEY_OTA_CHECKPOINT  "wm_ota_ckpt"
+
 #ifdef __cplusplus
 }
 #endif
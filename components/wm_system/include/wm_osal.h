@@ -988,6 +988,17 @@ uint32_t wm_os_internal_get_time(void);
  */
 uint32_t wm_os_internal_get_time_ms(void);
 
+/**
+ * @brief          This function is used by your application to obtain the
+                   number of us since the system starts, the tick count
+                   refined by the core timer counting within the tick.
+ *
+ * @retval         current value of OSTime in us, wraps after about 71 minutes
+ *
+ * @note           It can be called in the interrupt service routine.
+ */
+uint32_t wm_os_internal_get_time_us(void);
+
 /**
  * @brief          This function is used to disable interrupts by preserving
                    the state of interrupts
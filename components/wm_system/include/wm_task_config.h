@@ -27,6 +27,7 @@ extern "C" {
 #define WM_TASK_POSIX_PRIO           (WM_TASK_PRIO_MIN + 1)
 #define WM_TASK_MAIN_PRIO            (WM_TASK_PRIO_MIN + 1)
 #define WM_TASK_OTA_HTTP_PRIO        (WM_TASK_ATCMD_PRIO - 1)
+#define WM_TASK_OTA_WRITE_PRIO       (WM_TASK_OTA_HTTP_PRIO)
 #define WM_TASK_EVENT_STACK          (2048)
 #define WM_TASK_BT_CONTROLLER_STACK  (512)
 #define WM_TASK_WIFI_DRV_STACK       (3072)
@@ -41,6 +42,7 @@ extern "C" {
 #define WM_TASK_ATCMD_STACK          (8192)
 #define WM_TASK_MAIN_STACK           (4096)
 #define WM_TASK_OTA_HTTP_STACK       (4096)
+#define WM_TASK_OTA_WRITE_STACK      (WM_TASK_OTA_HTTP_STACK)
 #define WM_TASK_NET_MANAGER_STACK    (2048)
 
 #ifdef __cplusplus
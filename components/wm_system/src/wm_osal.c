@@ -5,6 +5,7 @@
 #include "wm_osal.h"
 #include "wm_irq.h"
 #include "wm_drv_irq.h"
+#include "core_804.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -1680,6 +1681,34 @@ uint32_t wm_os_internal_get_time_ms(void)
     return xTaskGetTickCountFromISR() * portTICK_PERIOD_MS;
 }
 
+/*
+*********************************************************************************************************
+*                                         GET CURRENT SYSTEM TIME IN US UNIT
+*
+* Description: This function is used by your application to obtain the current value of the 32-bit
+*              counter which keeps track of the number of microsecond.
+*
+* Arguments  : none
+*
+* Returns    : The current value of OSTime in microsecond unit
+*********************************************************************************************************
+*/
+uint32_t wm_os_internal_get_time_us(void)
+{
+    uint32_t load    = csi_coret_get_load() + 1;
+    uint32_t tick_us = 1000000 / configTICK_RATE_HZ;
+    uint32_t tick    = 0;
+    uint32_t value   = 0;
+
+    /* the core timer counts down from load once per tick, read both within the same tick */
+    do {
+        tick  = xTaskGetTickCountFromISR();
+        value = csi_coret_get_value();
+    } while (tick != xTaskGetTickCountFromISR());
+
+    return tick * tick_us + (uint32_t)((uint64_t)(load - value) * tick_us / load);
+}
+
 /**********************************************************************************************************
 * Description: Disable interrupts by preserving the state of interrupts.
 *
@@ -0,0 +1,251 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "wm_dsp.h"
+#include "wm_dsp_ref.h"
+#include "wm_osal.h"
+#include "wm_drv_rcc.h"
+#include "wm_dt.h"
+
+#define LOG_TAG "test"
+#include "wm_log.h"
+
+#define DSP_BLOCK       240 /* 10 ms at 24 kHz, a multiple of the decimation factor */
+#define DSP_TAP_NUM     32
+#define DSP_RATE_TAP    48
+#define DSP_RATE_FACTOR 3
+#define DSP_BIQUAD_NUM  2
+#define DSP_FFT_LEN     1024
+#define DSP_FFT_ERR_MAX 8 /* the real FFTs round differently */
+#define DSP_BENCH_MS    500
+
+typedef struct {
+    const char *name;
+    uint32_t samples; /* input samples of one call */
+    void (*run)(bool ref);
+} dsp_case_t;
+
+static int16_t dsp_in[DSP_FFT_LEN];
+static int16_t dsp_work[DSP_FFT_LEN];
+static int16_t dsp_out[2][DSP_FFT_LEN + 2];
+static int16_t dsp_state[2][DSP_RATE_TAP + DSP_BLOCK];
+
+static int16_t dsp_fir_coeffs[DSP_TAP_NUM];
+static int16_t dsp_rate_coeffs[DSP_RATE_TAP];
+static int16_t dsp_biquad_coeffs[DSP_BIQUAD_NUM * 6];
+
+static wm_dsp_fir_q15_t dsp_fir[2];
+static wm_dsp_biquad_q15_t dsp_biquad[2];
+static wm_dsp_decimate_q15_t dsp_dec[2];
+static wm_dsp_interpolate_q15_t dsp_itp[2];
+
+static volatile int16_t dsp_sink;
+
+static void dsp_run_fir(bool ref)
+{
+    if (ref) {
+        wm_dsp_ref_fir_q15(&dsp_fir[1], dsp_in, dsp_out[1], DSP_BLOCK);
+    } else {
+        wm_dsp_fir_q15(&dsp_fir[0], dsp_in, dsp_out[0], DSP_BLOCK);
+    }
+}
+
+static void dsp_run_biquad(bool ref)
+{
+    if (ref) {
+        wm_dsp_ref_biquad_q15(&dsp_biquad[1], dsp_in, dsp_out[1], DSP_BLOCK);
+    } else {
+        wm_dsp_biquad_q15(&dsp_biquad[0], dsp_in, dsp_out[0], DSP_BLOCK);
+    }
+}
+
+static void dsp_run_decimate(bool ref)
+{
+    if (ref) {
+        wm_dsp_ref_decimate_q15(&dsp_dec[1], dsp_in, dsp_out[1], DSP_BLOCK);
+    } else {
+        wm_dsp_decimate_q15(&dsp_dec[0], dsp_in, dsp_out[0], DSP_BLOCK);
+    }
+}
+
+static void dsp_run_interpolate(bool ref)
+{
+    if (ref) {
+        wm_dsp_ref_interpolate_q15(&dsp_itp[1], dsp_in, dsp_out[1], DSP_BLOCK / DSP_RATE_FACTOR);
+    } else {
+        wm_dsp_interpolate_q15(&dsp_itp[0], dsp_in, dsp_out[0], DSP_BLOCK / DSP_RATE_FACTOR);
+    }
+}
+
+static void dsp_run_rfft(bool ref)
+{
+    /* the input is overwritten */
+    memcpy(dsp_work, dsp_in, sizeof(dsp_work));
+
+    if (ref) {
+        wm_dsp_ref_rfft_q15(DSP_FFT_LEN, dsp_work, dsp_out[1]);
+    } else {
+        wm_dsp_rfft_q15(DSP_FFT_LEN, dsp_work, dsp_out[0]);
+    }
+}
+
+static void dsp_run_stats(bool ref)
+{
+    if (ref) {
+        dsp_out[1][0] = wm_dsp_ref_mean_q15(dsp_in, DSP_FFT_LEN);
+        dsp_out[1][1] = wm_dsp_ref_var_q15(dsp_in, DSP_FFT_LEN);
+        dsp_out[1][2] = wm_dsp_ref_max_q15(dsp_in, DSP_FFT_LEN, (uint16_t *)&dsp_out[1][3]);
+        dsp_out[1][4] = wm_dsp_ref_min_q15(dsp_in, DSP_FFT_LEN, (uint16_t *)&dsp_out[1][5]);
+    } else {
+        dsp_out[0][0] = wm_dsp_mean_q15(dsp_in, DSP_FFT_LEN);
+        dsp_out[0][1] = wm_dsp_var_q15(dsp_in, DSP_FFT_LEN);
+        dsp_out[0][2] = wm_dsp_max_q15(dsp_in, DSP_FFT_LEN, (uint16_t *)&dsp_out[0][3]);
+        dsp_out[0][4] = wm_dsp_min_q15(dsp_in, DSP_FFT_LEN, (uint16_t *)&dsp_out[0][5]);
+    }
+    dsp_sink = dsp_out[ref][1];
+}
+
+static const dsp_case_t dsp_cases[] = {
+    { "fir 32 taps",    DSP_BLOCK,                   dsp_run_fir         },
+    { "biquad x2",      DSP_BLOCK,                   dsp_run_biquad      },
+    { "decimate /3",    DSP_BLOCK,                   dsp_run_decimate    },
+    { "interpolate x3", DSP_BLOCK / DSP_RATE_FACTOR, dsp_run_interpolate },
+    { "rfft 1024",      DSP_FFT_LEN,                 dsp_run_rfft        },
+    { "statistics",     DSP_FFT_LEN,                 dsp_run_stats       },
+};
+
+static void dsp_init(void)
+{
+    int i;
+
+    srand(1);
+    for (i = 0; i < DSP_FFT_LEN; i++) {
+        dsp_in[i] = (int16_t)(12000 * sin(2 * M_PI * i / 50) + (rand() % 8001) - 4000);
+    }
+
+    /* windowed sinc low pass at a third of the band, for the rate changes too */
+    for (i = 0; i < DSP_RATE_TAP; i++) {
+        double t = i - (DSP_RATE_TAP - 1) / 2.0;
+        double h = (t == 0 ? 1.0 / 3 : sin(M_PI * t / 3) / (M_PI * t)) *
+                   (0.54 - 0.46 * cos(2 * M_PI * i / (DSP_RATE_TAP - 1)));
+
+        dsp_rate_coeffs[i] = (int16_t)lrint(h * 32767 * DSP_RATE_FACTOR * 0.9);
+        if (i < DSP_TAP_NUM) {
+            dsp_fir_coeffs[i] = (int16_t)(rand() % 4001 - 2000);
+        }
+    }
+
+    /* two 2nd order low pass at fs / 8, Q14 with post_shift 1 */
+    for (i = 0; i < DSP_BIQUAD_NUM; i++) {
+        dsp_biquad_coeffs[i * 6 + 0] = 1600;
+        dsp_biquad_coeffs[i * 6 + 1] = 0;
+        dsp_biquad_coeffs[i * 6 + 2] = 3199;
+        dsp_biquad_coeffs[i * 6 + 3] = 1600;
+        dsp_biquad_coeffs[i * 6 + 4] = 15447;
+        dsp_biquad_coeffs[i * 6 + 5] = -5461;
+    }
+}
+
+/* both sides start from a cleared state, so the outputs can be compared call after call */
+static void dsp_reset(void)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        wm_dsp_fir_q15_init(&dsp_fir[i], dsp_fir_coeffs, DSP_TAP_NUM, dsp_state[i], DSP_BLOCK);
+        wm_dsp_biquad_q15_init(&dsp_biquad[i], dsp_biquad_coeffs, DSP_BIQUAD_NUM, dsp_state[i], 1);
+        wm_dsp_decimate_q15_init(&dsp_dec[i], DSP_RATE_FACTOR, dsp_rate_coeffs, DSP_RATE_TAP, dsp_state[i], DSP_BLOCK);
+        wm_dsp_interpolate_q15_init(&dsp_itp[i], DSP_RATE_FACTOR, dsp_rate_coeffs, DSP_RATE_TAP, dsp_state[i],
+                                    DSP_BLOCK / DSP_RATE_FACTOR);
+    }
+}
+
+static int dsp_verify(void)
+{
+    int err_max;
+    int i, j, k;
+
+    for (i = 0; i < sizeof(dsp_cases) / sizeof(dsp_cases[0]); i++) {
+        dsp_reset();
+        err_max = dsp_cases[i].run == dsp_run_rfft ? DSP_FFT_ERR_MAX : 0;
+
+        /* a few calls, the state must carry over the same way */
+        for (k = 0; k < 3; k++) {
+            memset(dsp_out, 0, sizeof(dsp_out));
+            dsp_cases[i].run(false);
+            dsp_cases[i].run(true);
+
+            for (j = 0; j < DSP_FFT_LEN + 2; j++) {
+                if (abs(dsp_out[0][j] - dsp_out[1][j]) > err_max) {
+                    wm_log_error("%s mismatch at %d: %d, reference %d", dsp_cases[i].name, j, dsp_out[0][j],
+                                 dsp_out[1][j]);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* cycles of one sample, in hundredths */
+static uint32_t dsp_bench_fn(const dsp_case_t *c, bool ref, int cpu_mhz)
+{
+    uint32_t loops = 0;
+    uint32_t start;
+    uint32_t ms;
+
+    dsp_reset();
+    start = wm_os_internal_get_time_ms();
+    do {
+        c->run(ref);
+        loops++;
+    } while ((ms = wm_os_internal_get_time_ms() - start) < DSP_BENCH_MS);
+
+    return (uint32_t)((uint64_t)ms * cpu_mhz * 1000 * 100 / ((uint64_t)c->samples * loops));
+}
+
+static void dsp_bench(void)
+{
+    int cpu_mhz = wm_drv_rcc_get_config_clock(wm_dt_get_device_by_name("rcc"), WM_RCC_TYPE_CPU);
+    uint32_t ref, opt;
+    int i;
+
+    wm_log_info("%-16s %16s %16s", "kernel", "C cycles/sample", "DSP cycles/sample");
+    for (i = 0; i < sizeof(dsp_cases) / sizeof(dsp_cases[0]); i++) {
+        ref = dsp_bench_fn(&dsp_cases[i], true, cpu_mhz);
+        opt = dsp_bench_fn(&dsp_cases[i], false, cpu_mhz);
+        wm_log_info("%-16s %13u.%02u %13u.%02u", dsp_cases[i].name, ref / 100, ref % 100, opt / 100, opt % 100);
+    }
+}
+
+static void benchmark_test_task(void *parameters)
+{
+    dsp_init();
+
+    if (dsp_verify() != 0) {
+        wm_log_error("Example run failed!");
+        vTaskDelete(NULL);
+        return;
+    }
+    wm_log_info("DSP kernels verified against the C reference");
+
+    dsp_bench();
+
+    wm_log_info("Example run successfully!");
+
+    vTaskDelete(NULL);
+}
+
+int main(void)
+{
+    xTaskCreate(benchmark_test_task, "benchmark", 2048, NULL, configMAX_PRIORITIES - 1, NULL);
+
+    return 0;
+}
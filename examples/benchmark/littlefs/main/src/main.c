@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "wmsdk_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "lfs.h"
+#include "wm_osal.h"
+#include "wm_heap.h"
+
+#define LOG_TAG "test"
+#include "wm_log.h"
+
+/* RAM disk geometry, a multi-megabyte partition needs PSRAM */
+#define BENCH_BLOCK_SIZE 4096
+#define BENCH_PAGE_SIZE  256
+#if CONFIG_HEAP_USE_PSRAM
+#define BENCH_BLOCK_COUNT 512
+#define BENCH_FILE_NUM    128
+#else
+#define BENCH_BLOCK_COUNT 32
+#define BENCH_FILE_NUM    8
+#endif
+
+/* Workload */
+#define BENCH_APPEND_SIZE  256
+#define BENCH_APPEND_TIMES 8
+#define BENCH_LIST_TIMES   16
+
+/* Typical SPI NOR timings, used to estimate the time the operations take on flash */
+#define BENCH_READ_NS_PER_BYTE   50
+#define BENCH_PROG_US_PER_PAGE   400
+#define BENCH_ERASE_US_PER_BLOCK 45000
+
+typedef struct {
+    lfs_size_t cache_size;
+    lfs_size_t lookahead_size;
+    int32_t block_cycles;
+} bench_config_t;
+
+typedef struct {
+    uint32_t read_bytes;
+    uint32_t prog_pages;
+    uint32_t erases;
+} bench_stats_t;
+
+static const bench_config_t bench_configs[] = {
+    { 256,  16,  500 },
+    { 512,  16,  500 },
+    { 1024, 16,  500 },
+    { 4096, 16,  500 },
+    { 256,  64,  500 },
+    { 1024, 64,  500 },
+    { 1024, 64,  100 },
+    { 1024, 64,  -1  },
+#if CONFIG_HEAP_USE_PSRAM
+    { 1024, BENCH_BLOCK_COUNT / 8, 500 },
+#endif
+};
+
+static uint8_t *bench_disk;
+static bench_stats_t bench_stats;
+static uint8_t bench_data[BENCH_APPEND_SIZE];
+
+static int bench_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size)
+{
+    memcpy(buffer, bench_disk + block * c->block_size + off, size);
+    bench_stats.read_bytes += size;
+
+    return LFS_ERR_OK;
+}
+
+static int bench_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size)
+{
+    uint8_t *dst       = bench_disk + block * c->block_size + off;
+    const uint8_t *src = buffer;
+    lfs_size_t i;
+
+    /* NOR programming only clears bits */
+    for (i = 0; i < size; i++) {
+        dst[i] &= src[i];
+    }
+    bench_stats.prog_pages += (off % BENCH_PAGE_SIZE + size + BENCH_PAGE_SIZE - 1) / BENCH_PAGE_SIZE;
+
+    return LFS_ERR_OK;
+}
+
+static int bench_erase(const struct lfs_config *c, lfs_block_t block)
+{
+    memset(bench_disk + block * c->block_size, 0xFF, c->block_size);
+    bench_stats.erases++;
+
+    return LFS_ERR_OK;
+}
+
+static int bench_sync(const struct lfs_config *c)
+{
+    return LFS_ERR_OK;
+}
+
+#if CONFIG_LITTLEFS_THREADSAFE_ENABLE
+static int bench_lock(const struct lfs_config *c)
+{
+    return LFS_ERR_OK;
+}
+
+static int bench_unlock(const struct lfs_config *c)
+{
+    return LFS_ERR_OK;
+}
+#endif
+
+static void bench_report(const char *name, uint32_t ms, uint32_t ops)
+{
+    uint32_t flash_ms = (uint32_t)(((uint64_t)bench_stats.read_bytes * BENCH_READ_NS_PER_BYTE / 1000 +
+                                    (uint64_t)bench_stats.prog_pages * BENCH_PROG_US_PER_PAGE +
+                                    (uint64_t)bench_stats.erases * BENCH_ERASE_US_PER_BLOCK) /
+                                   1000);
+
+    wm_log_info("%-7s %5u ms %6u ops/s  read %6u KB  prog %5u pages  erase %4u  flash ~%6u ms", name, ms,
+                ms ? ops * 1000 / ms : 0, bench_stats.read_bytes / 1024, bench_stats.prog_pages, bench_stats.erases,
+                flash_ms);
+
+    memset(&bench_stats, 0, sizeof(bench_stats));
+}
+
+static int bench_run(const bench_config_t *bc)
+{
+    struct lfs_config cfg = { 0 };
+    lfs_t lfs;
+    lfs_file_t file;
+    lfs_dir_t dir;
+    struct lfs_info info;
+    char path[32];
+    uint32_t start;
+    int ret;
+    int i, j;
+
+    cfg.read           = bench_read;
+    cfg.prog           = bench_prog;
+    cfg.erase          = bench_erase;
+    cfg.sync           = bench_sync;
+#if CONFIG_LITTLEFS_THREADSAFE_ENABLE
+    cfg.lock           = bench_lock;
+    cfg.unlock         = bench_unlock;
+#endif
+    cfg.read_size      = BENCH_PAGE_SIZE;
+    cfg.prog_size      = BENCH_PAGE_SIZE;
+    cfg.block_size     = BENCH_BLOCK_SIZE;
+    cfg.block_count    = BENCH_BLOCK_COUNT;
+    cfg.block_cycles   = bc->block_cycles;
+    cfg.cache_size     = bc->cache_size;
+    cfg.lookahead_size = bc->lookahead_size;
+
+    wm_log_info("---- cache %u lookahead %u block_cycles %d ----", (unsigned)bc->cache_size, (unsigned)bc->lookahead_size,
+                (int)bc->block_cycles);
+
+    memset(bench_disk, 0xFF, BENCH_BLOCK_SIZE * BENCH_BLOCK_COUNT);
+    ret = lfs_format(&lfs, &cfg);
+    if (ret == LFS_ERR_OK) {
+        ret = lfs_mount(&lfs, &cfg);
+    }
+    if (ret != LFS_ERR_OK) {
+        wm_log_error("format or mount failed: %d", ret);
+        return ret;
+    }
+    lfs_mkdir(&lfs, "bench");
+    memset(&bench_stats, 0, sizeof(bench_stats));
+
+    /* Create small files, each one a metadata commit */
+    start = wm_os_internal_get_time_ms();
+    for (i = 0; i < BENCH_FILE_NUM && ret == LFS_ERR_OK; i++) {
+        snprintf(path, sizeof(path), "bench/file%03d", i);
+        ret = lfs_file_open(&lfs, &file, path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
+        if (ret == LFS_ERR_OK) {
+            ret = lfs_file_write(&lfs, &file, bench_data, 32) < 0 ? LFS_ERR_IO : lfs_file_close(&lfs, &file);
+        }
+    }
+    bench_report("create", wm_os_internal_get_time_ms() - start, BENCH_FILE_NUM);
+
+    /* Append to the files round robin, as a data logger does */
+    start = wm_os_internal_get_time_ms();
+    for (j = 0; j < BENCH_APPEND_TIMES && ret == LFS_ERR_OK; j++) {
+        for (i = 0; i < BENCH_FILE_NUM && ret == LFS_ERR_OK; i++) {
+            snprintf(path, sizeof(path), "bench/file%03d", i);
+            ret = lfs_file_open(&lfs, &file, path, LFS_O_WRONLY | LFS_O_APPEND);
+            if (ret == LFS_ERR_OK) {
+                ret = lfs_file_write(&lfs, &file, bench_data, BENCH_APPEND_SIZE) < 0 ? LFS_ERR_IO : lfs_file_close(&lfs, &file);
+            }
+        }
+    }
+    bench_report("append", wm_os_internal_get_time_ms() - start, BENCH_FILE_NUM * BENCH_APPEND_TIMES);
+
+    /* Read the files back */
+    start = wm_os_internal_get_time_ms();
+    for (i = 0; i < BENCH_FILE_NUM && ret == LFS_ERR_OK; i++) {
+        snprintf(path, sizeof(path), "bench/file%03d", i);
+        ret = lfs_file_open(&lfs, &file, path, LFS_O_RDONLY);
+        while (ret == LFS_ERR_OK && (j = lfs_file_read(&lfs, &file, bench_data, BENCH_APPEND_SIZE)) > 0) {
+        }
+        if (ret == LFS_ERR_OK) {
+            ret = j < 0 ? j : lfs_file_close(&lfs, &file);
+        }
+    }
+    bench_report("read", wm_os_internal_get_time_ms() - start, BENCH_FILE_NUM);
+
+    /* List the directory */
+    start = wm_os_internal_get_time_ms();
+    for (i = 0; i < BENCH_LIST_TIMES && ret == LFS_ERR_OK; i++) {
+        ret = lfs_dir_open(&lfs, &dir, "bench");
+        while (ret == LFS_ERR_OK && (j = lfs_dir_read(&lfs, &dir, &info)) > 0) {
+        }
+        if (ret == LFS_ERR_OK) {
+            ret = j < 0 ? j : lfs_dir_close(&lfs, &dir);
+        }
+    }
+    bench_report("list", wm_os_internal_get_time_ms() - start, BENCH_LIST_TIMES);
+
+    /* Remount, which traverses the filesystem to find free blocks on the first allocation */
+    start = wm_os_internal_get_time_ms();
+    if (ret == LFS_ERR_OK) {
+        lfs_unmount(&lfs);
+        ret = lfs_mount(&lfs, &cfg);
+    }
+    if (ret == LFS_ERR_OK) {
+        ret = lfs_file_open(&lfs, &file, "bench/last", LFS_O_WRONLY | LFS_O_CREAT);
+        if (ret == LFS_ERR_OK) {
+            ret = lfs_file_write(&lfs, &file, bench_data, BENCH_APPEND_SIZE) < 0 ? LFS_ERR_IO : lfs_file_close(&lfs, &file);
+        }
+    }
+    bench_report("mount", wm_os_internal_get_time_ms() - start, 1);
+
+    if (ret != LFS_ERR_OK) {
+        wm_log_error("benchmark failed: %d", ret);
+    }
+    lfs_unmount(&lfs);
+
+    return ret;
+}
+
+static void benchmark_test_task(void *parameters)
+{
+    int i;
+
+#if CONFIG_HEAP_USE_PSRAM
+    bench_disk = wm_heap_caps_alloc(BENCH_BLOCK_SIZE * BENCH_BLOCK_COUNT, WM_HEAP_CAP_SPIRAM);
+#else
+    bench_disk = wm_os_internal_malloc(BENCH_BLOCK_SIZE * BENCH_BLOCK_COUNT);
+#endif
+    if (bench_disk == NULL) {
+        wm_log_error("no memory for the %u KB RAM disk", BENCH_BLOCK_SIZE * BENCH_BLOCK_COUNT / 1024);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    for (i = 0; i < sizeof(bench_data); i++) {
+        bench_data[i] = (uint8_t)i;
+    }
+
+    wm_log_info("RAM disk %u blocks of %u bytes, %d files", BENCH_BLOCK_COUNT, BENCH_BLOCK_SIZE, BENCH_FILE_NUM);
+
+    for (i = 0; i < sizeof(bench_configs) / sizeof(bench_configs[0]); i++) {
+        if (bench_run(&bench_configs[i]) != LFS_ERR_OK) {
+            wm_log_error("Example run failed!");
+            wm_os_internal_free(bench_disk);
+            vTaskDelete(NULL);
+            return;
+        }
+    }
+
+    wm_os_internal_free(bench_disk);
+    wm_log_info("Example run successfully!");
+
+    vTaskDelete(NULL);
+}
+
+int main(void)
+{
+    xTaskCreate(benchmark_test_task, "benchmark", 2048, NULL, configMAX_PRIORITIES - 1, NULL);
+
+    return 0;
+}
@@ -0,0 +1,257 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "lvgl.h"
+#include "wm_lv_port_draw.h"
+#include "wm_osal.h"
+#include "wm_drv_rcc.h"
+#include "wm_dt.h"
+
+#define LOG_TAG "test"
+#include "wm_log.h"
+
+/* One partial draw buffer of a 240x320 panel */
+#define DRAW_HOR_RES      240
+#define DRAW_VER_RES      32
+#define DRAW_PX_NUM       (DRAW_HOR_RES * DRAW_VER_RES)
+#define DRAW_VERIFY_LOOPS 2000
+#define DRAW_BENCH_LOOPS  200
+
+typedef void (*draw_blend_fn)(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc);
+
+typedef struct {
+    const char *name;
+    bool image;
+    bool masked;
+    lv_opa_t opa;
+} draw_case_t;
+
+static const draw_case_t draw_cases[] = {
+    { "fill",           false, false, LV_OPA_COVER },
+    { "fill opa",       false, false, LV_OPA_50    },
+    { "fill mask",      false, true,  LV_OPA_COVER },
+    { "fill mask opa",  false, true,  LV_OPA_50    },
+    { "image",          true,  false, LV_OPA_COVER },
+    { "image opa",      true,  false, LV_OPA_50    },
+    { "image mask",     true,  true,  LV_OPA_COVER },
+    { "image mask opa", true,  true,  LV_OPA_50    },
+};
+
+static lv_color_t ref_buf[DRAW_PX_NUM];
+static lv_color_t opt_buf[DRAW_PX_NUM];
+static lv_color_t img_buf[DRAW_PX_NUM];
+static lv_opa_t mask_buf[DRAW_PX_NUM];
+static lv_color_t disp_buf[DRAW_HOR_RES * 10];
+
+static lv_disp_draw_buf_t draw_buf_dsc;
+static lv_disp_drv_t disp_drv;
+static lv_draw_sw_ctx_t draw_ctx;
+static lv_area_t buf_area = { 0, 0, DRAW_HOR_RES - 1, DRAW_VER_RES - 1 };
+
+static void draw_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    lv_disp_flush_ready(drv);
+}
+
+static void draw_init(void)
+{
+    lv_disp_t *disp;
+
+    lv_init();
+
+    lv_disp_draw_buf_init(&draw_buf_dsc, disp_buf, NULL, sizeof(disp_buf) / sizeof(disp_buf[0]));
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res  = DRAW_HOR_RES;
+    disp_drv.ver_res  = DRAW_VER_RES;
+    disp_drv.flush_cb = draw_flush;
+    disp_drv.draw_buf = &draw_buf_dsc;
+    disp              = lv_disp_drv_register(&disp_drv);
+
+    /* The blend functions read the display being refreshed */
+    _lv_refr_set_disp_refreshing(disp);
+
+    draw_ctx.base_draw.buf_area = &buf_area;
+}
+
+/* Anti-aliased edges: mostly transparent or covered runs with partial values in between */
+static void draw_fill_mask(void)
+{
+    int i;
+
+    for (i = 0; i < DRAW_PX_NUM; i++) {
+        switch (rand() % 4) {
+            case 0:
+                mask_buf[i] = LV_OPA_TRANSP;
+                break;
+            case 1:
+                mask_buf[i] = LV_OPA_COVER;
+                break;
+            case 2:
+                mask_buf[i] = (lv_opa_t)rand();
+                break;
+            default:
+                mask_buf[i] = mask_buf[i & ~3];
+                break;
+        }
+    }
+}
+
+static void draw_blend(draw_blend_fn fn, lv_color_t *buf, const lv_area_t *blend_area, const lv_area_t *clip_area,
+                       const draw_case_t *dc, lv_color_t color)
+{
+    lv_draw_sw_blend_dsc_t dsc = { 0 };
+
+    dsc.blend_area = blend_area;
+    dsc.src_buf    = dc->image ? img_buf : NULL;
+    dsc.color      = color;
+    dsc.mask_buf   = dc->masked ? mask_buf : NULL;
+    dsc.mask_res   = dc->masked ? LV_DRAW_MASK_RES_CHANGED : LV_DRAW_MASK_RES_FULL_COVER;
+    dsc.mask_area  = blend_area;
+    dsc.opa        = dc->opa;
+    dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+
+    draw_ctx.base_draw.buf       = buf;
+    draw_ctx.base_draw.clip_area = clip_area;
+
+    fn((lv_draw_ctx_t *)&draw_ctx, &dsc);
+}
+
+static int draw_verify(void)
+{
+    lv_area_t blend_area;
+    lv_area_t clip_area;
+    draw_case_t dc;
+    lv_color_t color;
+    int i, j;
+
+    srand(1);
+
+    for (i = 0; i < DRAW_VERIFY_LOOPS; i++) {
+        for (j = 0; j < DRAW_PX_NUM; j++) {
+            ref_buf[j].full = (uint16_t)rand();
+            img_buf[j].full = (uint16_t)rand();
+        }
+        memcpy(opt_buf, ref_buf, sizeof(ref_buf));
+        draw_fill_mask();
+
+        blend_area.x1 = rand() % DRAW_HOR_RES - 8;
+        blend_area.y1 = rand() % DRAW_VER_RES - 8;
+        blend_area.x2 = blend_area.x1 + rand() % DRAW_HOR_RES;
+        blend_area.y2 = blend_area.y1 + rand() % DRAW_VER_RES;
+        clip_area.x1  = rand() % (DRAW_HOR_RES / 2);
+        clip_area.y1  = rand() % (DRAW_VER_RES / 2);
+        clip_area.x2  = clip_area.x1 + rand() % (DRAW_HOR_RES / 2);
+        clip_area.y2  = clip_area.y1 + rand() % (DRAW_VER_RES / 2);
+
+        dc.image   = rand() & 1;
+        dc.masked  = rand() & 1;
+        dc.opa     = (lv_opa_t)(LV_OPA_MIN + 1 + rand() % (LV_OPA_COVER - LV_OPA_MIN));
+        color.full = (uint16_t)rand();
+
+        draw_blend(lv_draw_sw_blend_basic, ref_buf, &blend_area, &clip_area, &dc, color);
+        draw_blend(wm_lv_port_draw_blend, opt_buf, &blend_area, &clip_area, &dc, color);
+
+        if (memcmp(ref_buf, opt_buf, sizeof(ref_buf))) {
+            wm_log_error("blend mismatch, loop=%d image=%d masked=%d opa=%d", i, dc.image, dc.masked, dc.opa);
+            return -1;
+        }
+    }
+
+    for (j = 0; j < DRAW_PX_NUM; j++) {
+        ref_buf[j].full = (uint16_t)rand();
+        opt_buf[j].full = (uint16_t)(ref_buf[j].full << 8 | ref_buf[j].full >> 8);
+    }
+    wm_lv_port_swap_rgb565(ref_buf + 1, DRAW_PX_NUM - 1);
+    if (memcmp(ref_buf + 1, opt_buf + 1, (DRAW_PX_NUM - 1) * sizeof(lv_color_t))) {
+        wm_log_error("swap mismatch");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void draw_report(const char *name, uint32_t ms, int cpu_mhz)
+{
+    uint32_t cpp = (uint32_t)((uint64_t)ms * cpu_mhz * 1000 * 100 / ((uint64_t)DRAW_PX_NUM * DRAW_BENCH_LOOPS));
+
+    wm_log_info("%-12s %6u ms  %u.%02u cycles/pixel", name, ms, cpp / 100, cpp % 100);
+}
+
+static uint32_t draw_bench_fn(draw_blend_fn fn, const draw_case_t *dc)
+{
+    lv_color_t color = lv_color_make(0x20, 0x80, 0xC0);
+    uint32_t start;
+    int i;
+
+    start = wm_os_internal_get_time_ms();
+    for (i = 0; i < DRAW_BENCH_LOOPS; i++) {
+        /* the background changes from pixel to pixel, as below anti-aliased text */
+        draw_blend(fn, ref_buf, &buf_area, &buf_area, dc, color);
+    }
+
+    return wm_os_internal_get_time_ms() - start;
+}
+
+static void draw_bench(void)
+{
+    int cpu_mhz = wm_drv_rcc_get_config_clock(wm_dt_get_device_by_name("rcc"), WM_RCC_TYPE_CPU);
+    uint32_t ms;
+    int i, j;
+
+    draw_fill_mask();
+    for (j = 0; j < DRAW_PX_NUM; j++) {
+        img_buf[j].full = (uint16_t)rand();
+    }
+
+    for (i = 0; i < sizeof(draw_cases) / sizeof(draw_cases[0]); i++) {
+        wm_log_info("---- %s ----", draw_cases[i].name);
+
+        for (j = 0; j < DRAW_PX_NUM; j++) {
+            ref_buf[j].full = (uint16_t)rand();
+        }
+        ms = draw_bench_fn(lv_draw_sw_blend_basic, &draw_cases[i]);
+        draw_report("reference", ms, cpu_mhz);
+
+        for (j = 0; j < DRAW_PX_NUM; j++) {
+            ref_buf[j].full = (uint16_t)rand();
+        }
+        ms = draw_bench_fn(wm_lv_port_draw_blend, &draw_cases[i]);
+        draw_report("optimized", ms, cpu_mhz);
+    }
+
+    wm_log_info("---- swap ----");
+    ms = wm_os_internal_get_time_ms();
+    for (i = 0; i < DRAW_BENCH_LOOPS; i++) {
+        wm_lv_port_swap_rgb565(ref_buf, DRAW_PX_NUM);
+    }
+    draw_report("optimized", wm_os_internal_get_time_ms() - ms, cpu_mhz);
+}
+
+static void benchmark_test_task(void *parameters)
+{
+    draw_init();
+
+    if (draw_verify() != 0) {
+        wm_log_error("Example run failed!");
+        vTaskDelete(NULL);
+        return;
+    }
+    wm_log_info("draw kernels verified against LVGL");
+
+    draw_bench();
+
+    wm_log_info("Example run successfully!");
+
+    vTaskDelete(NULL);
+}
+
+int main(void)
+{
+    xTaskCreate(benchmark_test_task, "benchmark", 2048, NULL, configMAX_PRIORITIES - 1, NULL);
+
+    return 0;
+}
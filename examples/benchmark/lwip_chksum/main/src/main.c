@@ -0,0 +1,160 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "lwip/inet_chksum.h"
+#include "wm_osal.h"
+#include "wm_drv_rcc.h"
+#include "wm_dt.h"
+
+#define LOG_TAG "test"
+#include "wm_log.h"
+
+#define CHKSUM_BUF_SIZE     1600
+#define CHKSUM_VERIFY_LOOPS 20000
+#define CHKSUM_BENCH_BYTES  (16 * 1024 * 1024)
+
+static uint8_t src_buf[CHKSUM_BUF_SIZE + 8] __attribute__((aligned(4)));
+static uint8_t dst_buf[CHKSUM_BUF_SIZE + 8] __attribute__((aligned(4)));
+
+/* Reference algorithm: RFC 1071 byte pair summation, host order, non-inverted */
+static uint16_t chksum_ref(const void *data, int len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t sum     = 0;
+    int i;
+
+    for (i = 0; i + 1 < len; i += 2) {
+        sum += (uint32_t)p[i] | ((uint32_t)p[i + 1] << 8);
+    }
+
+    if (len & 1) {
+        sum += p[len - 1];
+    }
+
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+
+    return (uint16_t)sum;
+}
+
+static int chksum_equal(uint16_t a, uint16_t b)
+{
+    /* 0x0000 and 0xFFFF are both zero in ones complement */
+    return (a == b) || ((a == 0xFFFF || a == 0) && (b == 0xFFFF || b == 0));
+}
+
+static int chksum_verify(void)
+{
+    int i, j, off, doff, len;
+    uint16_t ref, val;
+
+    srand(1);
+
+    for (i = 0; i < CHKSUM_VERIFY_LOOPS; i++) {
+        off  = rand() % 8;
+        doff = rand() % 8;
+        len  = rand() % CHKSUM_BUF_SIZE;
+
+        for (j = 0; j < len + off; j++) {
+            src_buf[j] = (uint8_t)rand();
+        }
+
+        ref = chksum_ref(src_buf + off, len);
+        val = wm_lwip_chksum(src_buf + off, len);
+        if (!chksum_equal(ref, val)) {
+            wm_log_error("chksum mismatch, off=%d len=%d ref=0x%04x val=0x%04x", off, len, ref, val);
+            return -1;
+        }
+
+#if CONFIG_LWIP_CHKSUM_ON_COPY
+        memset(dst_buf, 0, sizeof(dst_buf));
+        val = wm_lwip_chksum_copy(dst_buf + doff, src_buf + off, (uint16_t)len);
+        if (memcmp(dst_buf + doff, src_buf + off, len) || !chksum_equal(ref, val)) {
+            wm_log_error("chksum copy mismatch, off=%d doff=%d len=%d ref=0x%04x val=0x%04x", off, doff, len, ref, val);
+            return -1;
+        }
+#else
+        (void)doff;
+#endif
+    }
+
+    return 0;
+}
+
+static void chksum_report(const char *name, uint32_t ms, int cpu_mhz)
+{
+    uint32_t kbps = ms ? (uint32_t)((uint64_t)CHKSUM_BENCH_BYTES * 1000 / 1024 / ms) : 0;
+    uint32_t cpb  = (uint32_t)((uint64_t)ms * cpu_mhz * 1000 * 100 / CHKSUM_BENCH_BYTES);
+
+    wm_log_info("%-12s %6u ms  %6u KB/s  %u.%02u cycles/byte", name, ms, kbps, cpb / 100, cpb % 100);
+}
+
+static void chksum_bench(int len)
+{
+    int loops   = CHKSUM_BENCH_BYTES / len;
+    int cpu_mhz = wm_drv_rcc_get_config_clock(wm_dt_get_device_by_name("rcc"), WM_RCC_TYPE_CPU);
+    volatile uint16_t sink;
+    uint32_t start;
+    int i;
+
+    wm_log_info("---- %d bytes ----", len);
+
+    start = wm_os_internal_get_time_ms();
+    for (i = 0; i < loops; i++) {
+        sink = chksum_ref(src_buf, len);
+    }
+    chksum_report("reference", wm_os_internal_get_time_ms() - start, cpu_mhz);
+
+    start = wm_os_internal_get_time_ms();
+    for (i = 0; i < loops; i++) {
+        sink = wm_lwip_chksum(src_buf, len);
+    }
+    chksum_report("optimized", wm_os_internal_get_time_ms() - start, cpu_mhz);
+
+    start = wm_os_internal_get_time_ms();
+    for (i = 0; i < loops; i++) {
+        memcpy(dst_buf, src_buf, len);
+        sink = chksum_ref(dst_buf, len);
+    }
+    chksum_report("copy+ref", wm_os_internal_get_time_ms() - start, cpu_mhz);
+
+#if CONFIG_LWIP_CHKSUM_ON_COPY
+    start = wm_os_internal_get_time_ms();
+    for (i = 0; i < loops; i++) {
+        sink = wm_lwip_chksum_copy(dst_buf, src_buf, (uint16_t)len);
+    }
+    chksum_report("copy+chksum", wm_os_internal_get_time_ms() - start, cpu_mhz);
+#endif
+
+    (void)sink;
+}
+
+static void benchmark_test_task(void *parameters)
+{
+    if (chksum_verify() != 0) {
+        wm_log_error("Example run failed!");
+        vTaskDelete(NULL);
+        return;
+    }
+    wm_log_info("checksum verified against reference");
+
+    chksum_bench(64);
+    chksum_bench(536);
+    chksum_bench(1460);
+
+    wm_log_info("Example run successfully!");
+
+    vTaskDelete(NULL);
+}
+
+int main(void)
+{
+    xTaskCreate(benchmark_test_task, "benchmark", 1024, NULL, configMAX_PRIORITIES - 1, NULL);
+
+    return 0;
+}
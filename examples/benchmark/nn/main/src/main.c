@@ -0,0 +1,454 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "wm_nn.h"
+#include "wm_error.h"
+#include "wm_osal.h"
+#include "wm_drv_rcc.h"
+#include "wm_dt.h"
+
+#define LOG_TAG "test"
+#include "wm_log.h"
+
+#define NN_ARENA_SIZE  (40 * 1024)
+#define NN_MAX_TENSOR  32
+#define NN_MAX_LAYER   32
+#define NN_MAX_WEIGHT  (36 * 1024)
+#define NN_DESC_MAX    (sizeof(wm_nn_model_header_t) + NN_MAX_TENSOR * sizeof(wm_nn_tensor_desc_t) + \
+                        NN_MAX_LAYER * sizeof(wm_nn_layer_desc_t))
+#define NN_BENCH_RUNS  10
+#define NN_PARTITION   "nn_model"
+
+typedef struct {
+    const char *name;
+    void (*build)(void);
+} nn_case_t;
+
+static const char *nn_type_name[WM_NN_LAYER_MAX] = { "conv", "dw_conv", "fc",   "max_pool", "avg_pool",
+                                                      "relu", "sigmoid", "tanh", "softmax" };
+
+/* tensors and scratch buffers of all the models, laid out by the planner */
+static uint32_t nn_arena[NN_ARENA_SIZE / sizeof(uint32_t)];
+
+/* the model is built in the tables, the weights are written in place in nn_model */
+static wm_nn_model_header_t nn_header;
+static wm_nn_tensor_desc_t nn_tensors[NN_MAX_TENSOR];
+static wm_nn_layer_desc_t nn_layers[NN_MAX_LAYER];
+static uint32_t nn_model[(NN_DESC_MAX + NN_MAX_WEIGHT) / sizeof(uint32_t)];
+
+static int8_t *nn_snap;
+static int8_t *nn_check;
+
+static void nn_random(int8_t *buf, uint32_t len, int min, int max)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (int8_t)(rand() % (max - min + 1) + min);
+    }
+}
+
+static void nn_begin(void)
+{
+    memset(&nn_header, 0, sizeof(nn_header));
+    nn_header.magic   = WM_NN_MODEL_MAGIC;
+    nn_header.version = WM_NN_MODEL_VERSION;
+}
+
+static uint16_t nn_tensor(uint16_t dim_x, uint16_t dim_y, uint16_t ch)
+{
+    wm_nn_tensor_desc_t *t = &nn_tensors[nn_header.tensor_num];
+
+    memset(t, 0, sizeof(*t));
+    t->dim_x = dim_x;
+    t->dim_y = dim_y;
+    t->ch    = ch;
+
+    return nn_header.tensor_num++;
+}
+
+/* random weights, the shifts keep the outputs in range */
+static void nn_layer(wm_nn_layer_type_t type, uint16_t in, uint16_t out, uint8_t kernel_x, uint8_t kernel_y,
+                     uint8_t stride, uint8_t pad_x, uint8_t pad_y)
+{
+    wm_nn_layer_desc_t *l = &nn_layers[nn_header.layer_num++];
+    int8_t *weights       = (int8_t *)nn_model + NN_DESC_MAX;
+    uint32_t weight = 0, bias = 0, fan_in = 0;
+    uint8_t shift = 0;
+
+    memset(l, 0, sizeof(*l));
+    l->type     = (uint8_t)type;
+    l->in       = in;
+    l->out      = out;
+    l->kernel_x = kernel_x;
+    l->kernel_y = kernel_y;
+    l->stride_x = stride;
+    l->stride_y = stride;
+    l->pad_x    = pad_x;
+    l->pad_y    = pad_y;
+
+    if (type == WM_NN_LAYER_CONV) {
+        fan_in = (uint32_t)kernel_x * kernel_y * nn_tensors[in].ch;
+        weight = fan_in * nn_tensors[out].ch;
+        bias   = nn_tensors[out].ch;
+    } else if (type == WM_NN_LAYER_DW_CONV) {
+        fan_in = (uint32_t)kernel_x * kernel_y;
+        weight = fan_in * nn_tensors[out].ch;
+        bias   = nn_tensors[out].ch;
+    } else if (type == WM_NN_LAYER_FC) {
+        fan_in = (uint32_t)nn_tensors[in].dim_x * nn_tensors[in].dim_y * nn_tensors[in].ch;
+        bias   = (uint32_t)nn_tensors[out].dim_x * nn_tensors[out].dim_y * nn_tensors[out].ch;
+        weight = fan_in * bias;
+    } else if (type == WM_NN_LAYER_SIGMOID || type == WM_NN_LAYER_TANH) {
+        l->out_shift = 2;
+    }
+
+    if (weight) {
+        while (fan_in >>= 2) {
+            shift++;
+        }
+        l->out_shift  = 5 + shift;
+        l->bias_shift = 4;
+        l->weight     = nn_header.weight_size;
+        l->bias       = nn_header.weight_size + weight;
+        nn_random(weights + l->weight, weight, -32, 31);
+        nn_random(weights + l->bias, bias, -16, 15);
+        nn_header.weight_size += (weight + bias + 3) & ~3;
+    }
+}
+
+/* 32x32x3 image classifier like examples/dsp/cifar10 */
+static void nn_build_cifar10(void)
+{
+    uint16_t in, t;
+
+    nn_begin();
+    in = nn_tensor(32, 32, 3);
+    t  = nn_tensor(32, 32, 32);
+    nn_layer(WM_NN_LAYER_CONV, in, t, 5, 5, 1, 2, 2);
+    nn_layer(WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = nn_tensor(16, 16, 32);
+    nn_layer(WM_NN_LAYER_MAX_POOL, in, t, 3, 3, 2, 0, 0);
+    in = t;
+    t  = nn_tensor(16, 16, 16);
+    nn_layer(WM_NN_LAYER_CONV, in, t, 5, 5, 1, 2, 2);
+    nn_layer(WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = nn_tensor(8, 8, 16);
+    nn_layer(WM_NN_LAYER_AVG_POOL, in, t, 3, 3, 2, 0, 0);
+    in = t;
+    t  = nn_tensor(8, 8, 32);
+    nn_layer(WM_NN_LAYER_CONV, in, t, 5, 5, 1, 2, 2);
+    nn_layer(WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = nn_tensor(4, 4, 32);
+    nn_layer(WM_NN_LAYER_AVG_POOL, in, t, 3, 3, 2, 0, 0);
+    in = t;
+    t  = nn_tensor(1, 1, 10);
+    nn_layer(WM_NN_LAYER_FC, in, t, 0, 0, 0, 0, 0);
+    nn_layer(WM_NN_LAYER_SOFTMAX, t, t, 0, 0, 0, 0, 0);
+
+    nn_header.output = t;
+}
+
+/* keyword spotting DS-CNN, 49 frames of 10 MFCC, 12 classes */
+static void nn_build_kws(void)
+{
+    uint16_t in, t;
+    int i;
+
+    nn_begin();
+    in = nn_tensor(10, 49, 1);
+    t  = nn_tensor(5, 25, 64);
+    nn_layer(WM_NN_LAYER_CONV, in, t, 4, 10, 2, 1, 4);
+    nn_layer(WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+
+    for (i = 0; i < 4; i++) {
+        in = t;
+        t  = nn_tensor(5, 25, 64);
+        nn_layer(WM_NN_LAYER_DW_CONV, in, t, 3, 3, 1, 1, 1);
+        nn_layer(WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+        in = t;
+        t  = nn_tensor(5, 25, 64);
+        nn_layer(WM_NN_LAYER_CONV, in, t, 1, 1, 1, 0, 0);
+        nn_layer(WM_NN_LAYER_RELU, t, t, 0, 0, 0, 0, 0);
+    }
+
+    in = t;
+    t  = nn_tensor(1, 1, 64);
+    nn_layer(WM_NN_LAYER_AVG_POOL, in, t, 5, 25, 1, 0, 0);
+    in = t;
+    t  = nn_tensor(1, 1, 12);
+    nn_layer(WM_NN_LAYER_FC, in, t, 0, 0, 0, 0, 0);
+    in = t;
+    t  = nn_tensor(1, 1, 12);
+    nn_layer(WM_NN_LAYER_SOFTMAX, in, t, 0, 0, 0, 0, 0);
+
+    nn_header.output = t;
+}
+
+/* anomaly detection autoencoder of 128 features */
+static void nn_build_autoencoder(void)
+{
+    static const uint16_t dims[] = { 128, 64, 16, 64, 128 };
+    uint16_t in, t;
+    int i;
+
+    nn_begin();
+    t = nn_tensor(1, 1, dims[0]);
+    for (i = 1; i < sizeof(dims) / sizeof(dims[0]); i++) {
+        in = t;
+        t  = nn_tensor(1, 1, dims[i]);
+        nn_layer(WM_NN_LAYER_FC, in, t, 0, 0, 0, 0, 0);
+        nn_layer(i + 1 < sizeof(dims) / sizeof(dims[0]) ? WM_NN_LAYER_RELU : WM_NN_LAYER_SIGMOID, t, t, 0, 0, 0, 0, 0);
+    }
+
+    nn_header.output = t;
+}
+
+static const nn_case_t nn_cases[] = {
+    { "cifar10",     nn_build_cifar10     },
+    { "kws ds-cnn",  nn_build_kws         },
+    { "autoencoder", nn_build_autoencoder },
+};
+
+/* move the weights down to the end of the tables, returns the size of the model */
+static uint32_t nn_pack(void)
+{
+    uint8_t *p           = (uint8_t *)nn_model;
+    uint32_t tensor_size = nn_header.tensor_num * sizeof(wm_nn_tensor_desc_t);
+    uint32_t layer_size  = nn_header.layer_num * sizeof(wm_nn_layer_desc_t);
+    uint32_t desc_size   = sizeof(wm_nn_model_header_t) + tensor_size + layer_size;
+
+    memmove(p + desc_size, p + NN_DESC_MAX, nn_header.weight_size);
+    memcpy(p, &nn_header, sizeof(wm_nn_model_header_t));
+    memcpy(p + sizeof(wm_nn_model_header_t), nn_tensors, tensor_size);
+    memcpy(p + sizeof(wm_nn_model_header_t) + tensor_size, nn_layers, layer_size);
+
+    return desc_size + nn_header.weight_size;
+}
+
+/*
+ * Step through the layers, run each with the DSP kernels then again from the same input
+ * with the C kernels. The results must be the same, the table look up and the divisions
+ * of average pooling, sigmoid, tanh and softmax may round 1 off.
+ */
+static int nn_verify(wm_nn_model_t *model, uint32_t *c_us, uint32_t *dsp_us)
+{
+    wm_nn_model_info_t info;
+    wm_nn_layer_info_t layer;
+    wm_nn_tensor_t in, out;
+    int err_max;
+    uint32_t j;
+    uint16_t i;
+
+    wm_nn_model_get_info(model, &info);
+
+    for (i = 0; i < info.layer_num; i++) {
+        wm_nn_model_get_layer_info(model, i, &layer);
+        wm_nn_model_get_tensor(model, layer.in, &in);
+        wm_nn_model_get_tensor(model, layer.out, &out);
+        err_max = layer.type == WM_NN_LAYER_AVG_POOL || layer.type == WM_NN_LAYER_SIGMOID ||
+                  layer.type == WM_NN_LAYER_TANH || layer.type == WM_NN_LAYER_SOFTMAX;
+
+        /* the pooling and in place layers write their input */
+        memcpy(nn_snap, in.data, in.size);
+
+        wm_nn_model_use_reference(model, false);
+        wm_nn_model_run_layer(model, i);
+        wm_nn_model_get_layer_info(model, i, &layer);
+        dsp_us[i] = layer.time_us;
+        memcpy(nn_check, out.data, out.size);
+
+        memcpy(in.data, nn_snap, in.size);
+        wm_nn_model_use_reference(model, true);
+        wm_nn_model_run_layer(model, i);
+        wm_nn_model_get_layer_info(model, i, &layer);
+        c_us[i] = layer.time_us;
+
+        for (j = 0; j < out.size; j++) {
+            if (abs(out.data[j] - nn_check[j]) > err_max) {
+                wm_log_error("layer %u %s mismatch at %u: %d, reference %d", i, nn_type_name[layer.type], j,
+                             nn_check[j], out.data[j]);
+                return -1;
+            }
+        }
+    }
+
+    wm_nn_model_use_reference(model, false);
+
+    return 0;
+}
+
+/* per layer latency of both kernels, then the time of whole runs with the DSP kernels */
+static void nn_report(wm_nn_model_t *model, const uint32_t *c_us, const uint32_t *dsp_us, int cpu_mhz)
+{
+    wm_nn_model_info_t info;
+    wm_nn_layer_info_t layer;
+    wm_nn_tensor_t input, out;
+    uint32_t macs = 0;
+    uint32_t start, us, cpm;
+    uint16_t i;
+    int run;
+
+    wm_nn_model_get_info(model, &info);
+    wm_nn_model_get_input(model, &input);
+
+    wm_log_info("arena %u bytes, %u without planning, weights %u bytes", info.arena_size, info.total_size,
+                info.weight_size);
+    wm_log_info("%-3s %-8s %-11s %9s %9s %9s", "", "layer", "output", "macs", "C us", "DSP us");
+
+    for (i = 0; i < info.layer_num; i++) {
+        wm_nn_model_get_layer_info(model, i, &layer);
+        wm_nn_model_get_tensor(model, layer.out, &out);
+        wm_log_info("%-3u %-8s %3ux%3ux%3u %9u %9u %9u%s", i, nn_type_name[layer.type], out.dim_x, out.dim_y, out.ch,
+                    layer.macs, c_us[i], dsp_us[i], layer.dsp ? "" : " (C)");
+        macs += layer.macs;
+    }
+
+    start = wm_os_internal_get_time_ms();
+    for (run = 0; run < NN_BENCH_RUNS; run++) {
+        nn_random(input.data, input.size, -128, 127);
+        wm_nn_model_run(model);
+    }
+    us  = (wm_os_internal_get_time_ms() - start) * 1000 / NN_BENCH_RUNS;
+    cpm = macs ? (uint32_t)((uint64_t)us * cpu_mhz * 100 / macs) : 0;
+
+    wm_log_info("inference %u us, %u MACs, %u.%02u cycles/MAC", us, macs, cpm / 100, cpm % 100);
+}
+
+static int nn_bench_model(const char *name, wm_nn_model_t *model, void *arena, uint32_t arena_size, int cpu_mhz)
+{
+    wm_nn_model_info_t info;
+    wm_nn_tensor_t input;
+    uint32_t *c_us   = NULL;
+    uint32_t *dsp_us = NULL;
+    uint32_t max     = 0;
+    int err          = -1;
+    uint16_t i;
+
+    wm_nn_model_get_info(model, &info);
+    if (wm_nn_model_set_arena(model, arena, arena_size) != WM_ERR_SUCCESS) {
+        wm_log_error("%s: arena of %u bytes too small, %u needed", name, arena_size, info.arena_size);
+        return -1;
+    }
+
+    for (i = 0; i < info.tensor_num; i++) {
+        wm_nn_model_get_tensor(model, i, &input);
+        max = input.size > max ? input.size : max;
+    }
+
+    c_us     = wm_os_internal_malloc(info.layer_num * sizeof(uint32_t));
+    dsp_us   = wm_os_internal_malloc(info.layer_num * sizeof(uint32_t));
+    nn_snap  = wm_os_internal_malloc(max);
+    nn_check = wm_os_internal_malloc(max);
+
+    if (!c_us || !dsp_us || !nn_snap || !nn_check) {
+        wm_log_error("%s: no memory", name);
+    } else {
+        wm_log_info("---- %s", name);
+        wm_nn_model_get_input(model, &input);
+        nn_random(input.data, input.size, -128, 127);
+
+        if ((err = nn_verify(model, c_us, dsp_us)) == 0) {
+            nn_report(model, c_us, dsp_us, cpu_mhz);
+        }
+    }
+
+    wm_os_internal_free(c_us);
+    wm_os_internal_free(dsp_us);
+    wm_os_internal_free(nn_snap);
+    wm_os_internal_free(nn_check);
+
+    return err;
+}
+
+/* a model flashed to the nn_model partition, if any */
+static int nn_bench_partition(int cpu_mhz)
+{
+    wm_nn_model_t *model = NULL;
+    wm_nn_model_info_t info;
+    void *arena = NULL;
+    int err;
+
+    err = wm_nn_model_load_from_partition(NN_PARTITION, &model);
+    if (err == WM_ERR_NOT_FOUND) {
+        wm_log_info("no %s partition, skip the flashed model", NN_PARTITION);
+        return 0;
+    } else if (err != WM_ERR_SUCCESS) {
+        wm_log_error("load %s failed: %d", NN_PARTITION, err);
+        return -1;
+    }
+
+    wm_nn_model_get_info(model, &info);
+    arena = wm_os_internal_malloc(info.arena_size);
+    if (!arena) {
+        wm_log_error("no memory for the arena of %u bytes", info.arena_size);
+        wm_nn_model_unload(model);
+        return -1;
+    }
+
+    err = nn_bench_model(NN_PARTITION, model, arena, info.arena_size, cpu_mhz);
+
+    wm_nn_model_unload(model);
+    wm_os_internal_free(arena);
+
+    return err;
+}
+
+static int nn_bench(void)
+{
+    int cpu_mhz          = wm_drv_rcc_get_config_clock(wm_dt_get_device_by_name("rcc"), WM_RCC_TYPE_CPU);
+    wm_nn_model_t *model = NULL;
+    int err              = 0;
+    uint32_t size;
+    int i;
+
+    srand(1);
+
+    for (i = 0; i < sizeof(nn_cases) / sizeof(nn_cases[0]) && !err; i++) {
+        nn_cases[i].build();
+        size = nn_pack();
+
+        if (wm_nn_model_load(nn_model, size, &model) != WM_ERR_SUCCESS) {
+            wm_log_error("%s: load failed", nn_cases[i].name);
+            err = -1;
+            break;
+        }
+
+        err = nn_bench_model(nn_cases[i].name, model, nn_arena, sizeof(nn_arena), cpu_mhz);
+        wm_nn_model_unload(model);
+    }
+
+    if (!err) {
+        err = nn_bench_partition(cpu_mhz);
+    }
+
+    return err;
+}
+
+static void benchmark_test_task(void *parameters)
+{
+    if (nn_bench() != 0) {
+        wm_log_error("Example run failed!");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    wm_log_info("Example run successfully!");
+
+    vTaskDelete(NULL);
+}
+
+int main(void)
+{
+    xTaskCreate(benchmark_test_task, "benchmark", 2048, NULL, configMAX_PRIORITIES - 1, NULL);
+
+    return 0;
+}
@@ -30,6 +30,7 @@
 #include "wm_event.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "wm_drv_adc.h"
 #include "wm_drv_gpio.h"
 
@@ -41,6 +42,79 @@
 #define WM_ADC_TASK_STACK_SIZE 4906
 #define WM_ADC_TASK_PRIO       6
 #define WM_ADC_UNIT            1000
+#define WM_ADC_CONT_HALF_LEN   256 /* raw conversions in each half of the ring buffer */
+#define WM_ADC_CONT_OVERSAMPLE 4
+#define WM_ADC_CONT_BLOCKS     8 /* halves read before stopping */
+
+typedef struct {
+    int *buf;
+    uint32_t len;
+} wm_adc_block_t;
+
+static int g_adc_ring[WM_ADC_CONT_HALF_LEN * 2];
+static QueueHandle_t g_adc_queue = NULL;
+
+/* runs in the dma interrupt, only hand the half over to the task */
+static void wm_adc_continuous_callback(wm_adc_channel_t channel, int *buf, uint32_t len, bool full, void *user_data)
+{
+    portBASE_TYPE pxHigherPriorityTaskWoken = pdFALSE;
+    wm_adc_block_t block                    = { .buf = buf, .len = len };
+
+    xQueueSendFromISR(g_adc_queue, &block, &pxHigherPriorityTaskWoken);
+
+    if ((pdTRUE == pxHigherPriorityTaskWoken)) {
+        /*wake up the higher task after iterrupt end*/
+        portYIELD_FROM_ISR(pxHigherPriorityTaskWoken);
+    }
+}
+
+static void wm_adc_continuous(wm_device_t *adc_dev)
+{
+    const wm_adc_channel_t scan     = WM_ADC_CHANNEL_0;
+    wm_drv_adc_continuous_cfg_t cfg = {
+        .scan       = &scan,
+        .scan_count = 1,
+        .buf        = g_adc_ring,
+        .len        = WM_ADC_CONT_HALF_LEN * 2,
+        .oversample = WM_ADC_CONT_OVERSAMPLE,
+        .callback   = wm_adc_continuous_callback,
+    };
+    wm_adc_block_t block = { 0 };
+    int min, max, sum;
+    int err;
+
+    if (!g_adc_queue && !(g_adc_queue = xQueueCreate(2, sizeof(wm_adc_block_t)))) {
+        wm_log_error("create queue failed");
+        return;
+    }
+    xQueueReset(g_adc_queue);
+
+    if ((err = wm_drv_adc_start_continuous(adc_dev, &cfg)) != WM_ERR_SUCCESS) {
+        wm_log_error("start continuous failed %d", err);
+        return;
+    }
+
+    for (int i = 0; i < WM_ADC_CONT_BLOCKS; i++) {
+        if (xQueueReceive(g_adc_queue, &block, pdMS_TO_TICKS(1000)) != pdPASS) {
+            wm_log_error("continuous block %d timeout", i);
+            break;
+        }
+
+        /* the double precision calibration runs here in the task, not in the interrupt */
+        wm_drv_adc_cal_voltage_bulk(adc_dev, block.buf, block.len);
+
+        min = max = sum = block.buf[0];
+        for (uint32_t j = 1; j < block.len; j++) {
+            min = block.buf[j] < min ? block.buf[j] : min;
+            max = block.buf[j] > max ? block.buf[j] : max;
+            sum += block.buf[j];
+        }
+        wm_log_info("continuous block %d, %u samples, min %dmv max %dmv avg %dmv", i, block.len, min, max,
+                    sum / (int)block.len);
+    }
+
+    wm_drv_adc_stop_continuous(adc_dev);
+}
 
 static void wm_adc_task(void *arg)
 {
@@ -67,6 +141,8 @@ static void wm_adc_task(void *arg)
             wm_log_info("result %d %dmv", i, polling[i]);
         }
 
+        wm_adc_continuous(adc_dev);
+
         vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
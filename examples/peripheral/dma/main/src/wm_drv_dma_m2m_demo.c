@@ -21,6 +21,7 @@
  *  limitations under the License.
  */
 
+#include <stdlib.h>
 #include "wmsdk_config.h"
 #include "wm_types.h"
 #include "freertos/FreeRTOS.h"
@@ -41,6 +42,11 @@
 #define DRV_DMA_M2M_EXAMPLE_DUMP       wm_log_dump
 #define WM_DMA_TIME_DELAY              10
 
+#define DRV_DMA_M2M_EXAMPLE_CHAIN_LONG_LEN (WM_DRV_DMA_CHAIN_DESC_LEN_MAX + 0x100) /* split into two descs */
+#define DRV_DMA_M2M_EXAMPLE_CHAIN_FILL     (0x5a5a5a5a)
+#define DRV_DMA_M2M_EXAMPLE_CHAIN_LOOPS    (8)  /* segments done before the circular chain is stopped */
+#define DRV_DMA_M2M_EXAMPLE_CHAIN_WAIT_CNT (10) /* x 100ms */
+
 uint8_t dma_src_data[DRV_DMA_M2M_EXAMPLE_XFER_LIST_LEN][DRV_DMA_M2M_EXAMPLE_XFER_LEN] = { 0x0 };
 uint8_t dma_dest_buf[DRV_DMA_M2M_EXAMPLE_XFER_LIST_LEN][DRV_DMA_M2M_EXAMPLE_XFER_LEN] = { 0x0 };
 uint8_t dma_dest_buf_ref[DRV_DMA_M2M_EXAMPLE_XFER_LEN]                                = { 0x0 };
@@ -286,6 +292,149 @@ static void wm_drv_dma_example_m2m_transfer(void)
     wm_drv_dma_deinit(dma_dev);
 }
 
+/**
+ * @brief dma chain example callback record
+ */
+typedef struct {
+    volatile uint32_t cb_cnt;
+    volatile uint32_t last_seg;
+    volatile uint32_t seg_err; /* segments reported out of order */
+    uint32_t seg_num;
+    uint32_t stop_cnt; /* stop the chain after that many segments, circular only */
+} wm_drv_dma_example_chain_ctx_t;
+
+static void wm_drv_dma_example_chain_callback(wm_drv_dma_chain_t *chain, uint32_t seg, void *user_data)
+{
+    wm_drv_dma_example_chain_ctx_t *ctx = (wm_drv_dma_example_chain_ctx_t *)user_data;
+
+    if (ctx->stop_cnt && seg != (ctx->cb_cnt % ctx->seg_num)) {
+        ctx->seg_err++;
+    }
+    ctx->last_seg = seg;
+    ctx->cb_cnt++;
+
+    /* m2m never waits for a request, stop the loop here rather than flooding the cpu with irqs */
+    if (ctx->stop_cnt && ctx->cb_cnt >= ctx->stop_cnt) {
+        wm_drv_dma_chain_stop(chain);
+    }
+}
+
+static bool wm_drv_dma_example_chain_wait(wm_drv_dma_example_chain_ctx_t *ctx, uint32_t cb_cnt)
+{
+    int i;
+
+    for (i = 0; i < DRV_DMA_M2M_EXAMPLE_CHAIN_WAIT_CNT && ctx->cb_cnt < cb_cnt; i++) {
+        wm_os_internal_time_delay_ms(100);
+    }
+
+    return ctx->cb_cnt >= cb_cnt;
+}
+
+static bool wm_drv_dma_example_chain_check_fill(const uint8_t *buf, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        if (buf[i] != (uint8_t)DRV_DMA_M2M_EXAMPLE_CHAIN_FILL) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void wm_drv_dma_example_m2m_chain(void)
+{
+    static wm_device_t *dma_dev        = NULL;
+    wm_drv_dma_chain_cfg_t chain_cfg   = { 0 };
+    wm_drv_dma_chain_t *chain          = NULL;
+    wm_drv_dma_example_chain_ctx_t ctx = { 0 };
+    static uint32_t fill               = DRV_DMA_M2M_EXAMPLE_CHAIN_FILL;
+    uint8_t *long_buf                  = NULL;
+    uint8_t dma_ch                     = 0;
+    bool ok                            = true;
+    int run;
+
+    DRV_DMA_M2M_EXAMPLE_LOG_INFO("------start dma example: dma demo, dma desc chain ------");
+
+    long_buf = malloc(DRV_DMA_M2M_EXAMPLE_CHAIN_LONG_LEN);
+    if (long_buf == NULL) {
+        DRV_DMA_M2M_EXAMPLE_LOG_INFO("dma chain demo no mem");
+        return;
+    }
+
+    dma_dev = wm_drv_dma_init(DRV_DMA_M2M_EXAMPLE_DMA_NAME);
+    wm_drv_dma_request_ch(dma_dev, &dma_ch, DRV_DMA_M2M_EXAMPLE_TO_US);
+
+    /*
+     * one shot chain of three segments: two buffers copied and one fill longer than a desc can carry, the
+     * callback comes once for the last segment. Run it twice, a chain is restarted without adding it again.
+     */
+    chain_cfg.ch      = dma_ch;
+    chain_cfg.cb      = wm_drv_dma_example_chain_callback;
+    chain_cfg.cb_priv = &ctx;
+    wm_drv_dma_chain_create(dma_dev, &chain_cfg, &chain);
+    wm_drv_dma_chain_add(chain, (uint32_t)&dma_src_data[0][0], (uint32_t)&dma_dest_buf[0][0],
+                         DRV_DMA_M2M_EXAMPLE_XFER_LEN, WM_DRV_DMA_ADDR_INC, WM_DRV_DMA_ADDR_INC);
+    wm_drv_dma_chain_add(chain, (uint32_t)&dma_src_data[1][0], (uint32_t)&dma_dest_buf[1][0],
+                         DRV_DMA_M2M_EXAMPLE_XFER_LEN, WM_DRV_DMA_ADDR_INC, WM_DRV_DMA_ADDR_INC);
+    wm_drv_dma_chain_add(chain, (uint32_t)&fill, (uint32_t)long_buf, DRV_DMA_M2M_EXAMPLE_CHAIN_LONG_LEN,
+                         WM_DRV_DMA_ADDR_FIXED, WM_DRV_DMA_ADDR_INC);
+    ctx.seg_num = 3;
+
+    for (run = 0; run < 2 && ok; run++) {
+        DRV_DMA_M2M_EXAMPLE_MEMSET(&dma_src_data[0][0], 0x3a + run, sizeof(dma_src_data));
+        DRV_DMA_M2M_EXAMPLE_MEMSET(&dma_dest_buf[0][0], 0x0, sizeof(dma_dest_buf));
+        DRV_DMA_M2M_EXAMPLE_MEMSET(long_buf, 0x0, DRV_DMA_M2M_EXAMPLE_CHAIN_LONG_LEN);
+        ctx.cb_cnt = 0;
+
+        wm_drv_dma_chain_start(chain);
+
+        ok = wm_drv_dma_example_chain_wait(&ctx, 1);
+        /* nothing more may come after the chain is done */
+        wm_os_internal_time_delay_ms(WM_DMA_TIME_DELAY);
+        ok = ok && ctx.cb_cnt == 1 && ctx.last_seg == ctx.seg_num - 1;
+        ok = ok && !DRV_DMA_M2M_EXAMPLE_MEMCMP(dma_src_data, dma_dest_buf, sizeof(dma_src_data));
+        ok = ok && wm_drv_dma_example_chain_check_fill(long_buf, DRV_DMA_M2M_EXAMPLE_CHAIN_LONG_LEN);
+        DRV_DMA_M2M_EXAMPLE_LOG_INFO("dma chain run %d, callbacks %d, last seg %d", run, ctx.cb_cnt, ctx.last_seg);
+    }
+    wm_drv_dma_chain_delete(chain);
+
+    if (ok) {
+        /* circular ping-pong of two segments, each one reported in order until the callback stops the chain */
+        chain_cfg.circular = true;
+        wm_drv_dma_chain_create(dma_dev, &chain_cfg, &chain);
+        wm_drv_dma_chain_add(chain, (uint32_t)&dma_src_data[0][0], (uint32_t)&dma_dest_buf[0][0],
+                             DRV_DMA_M2M_EXAMPLE_XFER_LEN, WM_DRV_DMA_ADDR_INC, WM_DRV_DMA_ADDR_INC);
+        wm_drv_dma_chain_add(chain, (uint32_t)&dma_src_data[1][0], (uint32_t)&dma_dest_buf[1][0],
+                             DRV_DMA_M2M_EXAMPLE_XFER_LEN, WM_DRV_DMA_ADDR_INC, WM_DRV_DMA_ADDR_INC);
+        DRV_DMA_M2M_EXAMPLE_MEMSET(&dma_dest_buf[0][0], 0x0, sizeof(dma_dest_buf));
+        ctx.cb_cnt   = 0;
+        ctx.seg_err  = 0;
+        ctx.seg_num  = 2;
+        ctx.stop_cnt = DRV_DMA_M2M_EXAMPLE_CHAIN_LOOPS;
+
+        wm_drv_dma_chain_start(chain);
+
+        ok = wm_drv_dma_example_chain_wait(&ctx, DRV_DMA_M2M_EXAMPLE_CHAIN_LOOPS);
+        wm_os_internal_time_delay_ms(WM_DMA_TIME_DELAY);
+        ok = ok && ctx.cb_cnt == DRV_DMA_M2M_EXAMPLE_CHAIN_LOOPS && !ctx.seg_err;
+        ok = ok && !DRV_DMA_M2M_EXAMPLE_MEMCMP(dma_src_data, dma_dest_buf, sizeof(dma_src_data));
+        DRV_DMA_M2M_EXAMPLE_LOG_INFO("dma circular chain, callbacks %d, out of order %d", ctx.cb_cnt, ctx.seg_err);
+        wm_drv_dma_chain_delete(chain);
+    }
+
+    if (ok) {
+        DRV_DMA_M2M_EXAMPLE_LOG_INFO("dma m2m chain demo finish with success");
+    } else {
+        DRV_DMA_M2M_EXAMPLE_LOG_INFO("dma m2m chain demo finish with fail");
+    }
+
+    wm_drv_dma_release_ch(dma_dev, dma_ch, DRV_DMA_M2M_EXAMPLE_TO_US);
+    wm_drv_dma_deinit(dma_dev);
+    free(long_buf);
+}
+
 void wm_drv_dma_m2m_demo(void *p)
 {
     wm_device_t *dev = wm_drv_dma_init("dma");
@@ -306,6 +455,9 @@ void wm_drv_dma_m2m_demo(void *p)
             /* dma 4th demo - pass */
             wm_drv_dma_example_m2m_transfer();
 
+            /* dma 5th demo - desc chain */
+            wm_drv_dma_example_m2m_chain();
+
             wm_log_info("dma demo done! count %d ", count++);
             vTaskDelay(pdMS_TO_TICKS(1000));
         }
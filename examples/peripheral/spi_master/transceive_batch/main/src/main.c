@@ -0,0 +1,196 @@
+/**
+ * @file main.c
+ *
+ * @brief spi master transceive batch example
+ *
+ */
+
+/**
+ *  Copyright 2022-2024 Beijing WinnerMicroelectronics Co.,Ltd.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "wm_types.h"
+#include "wm_error.h"
+#include "wm_soc_cfgs.h"
+#include "wm_drv_spi_master.h"
+#include "wm_drv_gpio.h"
+
+#define LOG_TAG "exam_spim"
+#include "wm_log.h"
+
+#define EXAMPLE_FLASH_ADDR      0x1fb000 //flash address read by every transaction
+#define EXAMPLE_FLASH_READ      0x03     //read command, no dummy
+#define EXAMPLE_FLASH_FAST_READ 0x0B     //fast read command, 8 dummy bits
+#define EXAMPLE_DMA_LEN         256      //multiple of 4 and word aligned buffers, sent by DMA
+#define EXAMPLE_IT_LEN          61       //not a multiple of 4 so sent by IT, longer than the 32 bytes FIFO
+
+enum {
+    EXAMPLE_TRX_CMD_RX_DMA = 0, //cmd/addr/dummy phase, then RX by DMA
+    EXAMPLE_TRX_TX_DMA,         //TX by DMA, no cmd/addr phase
+    EXAMPLE_TRX_TX_RX_IT,       //TX and RX by IT, no cmd/addr phase
+    EXAMPLE_TRX_MAX
+};
+
+static SemaphoreHandle_t spim_batch_sem = NULL;
+static int spim_batch_result            = WM_ERR_FAILED;
+
+//word aligned for DMA
+static uint32_t dma_rx_buf[EXAMPLE_DMA_LEN / 4];
+static uint32_t dma_tx_buf[EXAMPLE_DMA_LEN / 4];
+static uint8_t it_tx_buf[EXAMPLE_IT_LEN];
+static uint8_t it_rx_buf[EXAMPLE_IT_LEN];
+
+static void example_spim_batch_callback(int result, void *data)
+{
+    spim_batch_result = result;
+    xSemaphoreGive(spim_batch_sem);
+}
+
+//fill a raw read command: command byte, 3 bytes address then 0xFF, what is clocked out after the address is ignored
+static void example_spim_fill_read_cmd(uint8_t *buf, uint32_t len)
+{
+    uint32_t addr = EXAMPLE_FLASH_ADDR;
+
+    memset(buf, 0xFF, len);
+    buf[0] = EXAMPLE_FLASH_READ;
+    memcpy(buf + 1, &addr, 3); //same byte order as the driver sends the addr of spim_transceive_ex_t
+}
+
+/*
+ * Read the same flash data three times in one batch, each transaction takes a different path of the driver:
+ * a cmd/addr phase followed by RX DMA, TX DMA without cmd/addr phase, and IT longer than the FIFO.
+ * Each transaction starts from the transfer done interrupt of the previous one.
+ */
+int example_spim_transceive_batch(wm_device_t *dev)
+{
+    int ret                                        = 0;
+    uint8_t *flash_data                            = (uint8_t *)dma_rx_buf;
+    spim_batch_transceive_t batch[EXAMPLE_TRX_MAX] = { 0 };
+    spim_transceive_ex_t *desc_ex                  = NULL;
+    wm_dt_hw_spim_dev_cfg_t config = {
+        .freq = 2 * 1000000, //2M clock
+        .mode = 0,
+        .pin_cs = {
+            .pin_num = WM_GPIO_NUM_20,
+            .pin_mux = WM_GPIO_IOMUX_FUN5,
+        },
+    };
+
+    wm_drv_gpio_iomux_func_sel(config.pin_cs.pin_num, WM_GPIO_IOMUX_FUN5);
+    wm_drv_gpio_set_pullmode(config.pin_cs.pin_num, WM_GPIO_FLOAT);
+    wm_drv_gpio_set_dir(config.pin_cs.pin_num, WM_GPIO_DIR_OUTPUT);
+    //default CS is invalid
+    wm_drv_gpio_data_set(config.pin_cs.pin_num);
+
+    spim_batch_sem = xSemaphoreCreateBinary();
+    assert(spim_batch_sem != NULL);
+
+    //fast read, the driver sends cmd, addr and dummy in a phase of their own, then reads by DMA
+    desc_ex               = &batch[EXAMPLE_TRX_CMD_RX_DMA].desc;
+    desc_ex->cmd          = EXAMPLE_FLASH_FAST_READ;
+    desc_ex->cmd_len      = 1;
+    desc_ex->addr         = EXAMPLE_FLASH_ADDR;
+    desc_ex->addr_len     = 3;
+    desc_ex->dummy_bits   = 8;
+    desc_ex->basic.flags  = SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_DUMMY_BITS;
+    desc_ex->basic.rx_buf = (uint8_t *)dma_rx_buf;
+    desc_ex->basic.rx_len = EXAMPLE_DMA_LEN;
+
+    //read command as raw data, sent by DMA, the data the flash returns is not received
+    example_spim_fill_read_cmd((uint8_t *)dma_tx_buf, EXAMPLE_DMA_LEN);
+    desc_ex               = &batch[EXAMPLE_TRX_TX_DMA].desc;
+    desc_ex->basic.tx_buf = (uint8_t *)dma_tx_buf;
+    desc_ex->basic.tx_len = EXAMPLE_DMA_LEN;
+
+    //read command as raw data, sent and received by IT, the flash data follows the 4 command bytes
+    example_spim_fill_read_cmd(it_tx_buf, EXAMPLE_IT_LEN);
+    memset(it_rx_buf, 0, EXAMPLE_IT_LEN);
+    desc_ex               = &batch[EXAMPLE_TRX_TX_RX_IT].desc;
+    desc_ex->basic.tx_buf = it_tx_buf;
+    desc_ex->basic.tx_len = EXAMPLE_IT_LEN;
+    desc_ex->basic.rx_buf = it_rx_buf;
+    desc_ex->basic.rx_len = EXAMPLE_IT_LEN;
+
+    for (int i = 0; i < EXAMPLE_TRX_MAX; i++) {
+        batch[i].config = &config;
+    }
+
+    ret = wm_drv_spim_transceive_batch_async(dev, batch, EXAMPLE_TRX_MAX, example_spim_batch_callback, NULL);
+    if (ret != WM_ERR_SUCCESS) {
+        wm_log_error("submit batch failed: %d", ret);
+        goto exit;
+    }
+
+    if (xSemaphoreTake(spim_batch_sem, pdMS_TO_TICKS(5000)) != pdTRUE) {
+        wm_log_error("batch timeout");
+        ret = WM_ERR_TIMEOUT;
+        goto exit;
+    }
+
+    ret = spim_batch_result;
+    if (ret != WM_ERR_SUCCESS) {
+        wm_log_error("batch failed: %d", ret);
+        goto exit;
+    }
+
+    //the IT transaction must have run to its end, the data past the FIFO size included
+    if (memcmp(it_rx_buf + 4, flash_data, EXAMPLE_IT_LEN - 4)) {
+        wm_log_error("IT data differ from DMA data");
+        wm_log_dump_error("dma_data", flash_data, EXAMPLE_IT_LEN - 4);
+        wm_log_dump_error("it_data", it_rx_buf + 4, EXAMPLE_IT_LEN - 4);
+        ret = WM_ERR_FAILED;
+        goto exit;
+    }
+
+    wm_log_info("batch done, flash data as below");
+    wm_log_dump_info("flash_data", flash_data, EXAMPLE_DMA_LEN);
+
+exit:
+    vSemaphoreDelete(spim_batch_sem);
+
+    return ret;
+}
+
+int main(void)
+{
+    wm_device_t *dev = NULL;
+
+    wm_log_info("spi master transceive batch example.");
+
+    /*initialize spi master*/
+    dev = wm_drv_spim_init("spim");
+
+    if (dev) {
+        /*start spi master batch transceive example*/
+        if (example_spim_transceive_batch(dev) == WM_ERR_SUCCESS) {
+            wm_log_info("Example run successfully!");
+        }
+    } else {
+        wm_log_error("example failed in spim init\n");
+    }
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    return 0;
+}
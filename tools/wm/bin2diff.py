@@ -0,0 +1,256 @@
+#!/usr/bin/python
+import sys
+import lzma
+import getopt
+import struct
+import binascii
+
+my_version          = "1.0.0"
+
+magic_no            = 0xA0FFFF9F
+delta_magic_no      = 0x50444D57 # "WMDP"
+delta_version       = 1
+
+header_size         = 64
+delta_header_size   = 32
+ctrl_size           = 12
+
+match_block         = 8   # bytes looked up in the base index
+match_min           = 16  # shortest exact match worth a record
+match_lookahead     = 64  # mismatching bytes tolerated while extending a match
+
+arg_base_image      = None
+arg_input_image     = None
+arg_output_name     = None
+
+help_usage = '''
+Usage:
+
+        bin2diff.py [options]
+
+options:
+    -h,--help                             = print usage information and exit.
+    -v,--version                          = print version number and exit.
+    -b,--base-image <file>                = firmware image running on the device (<project>.img).
+    -i,--input-image <file>               = new ota firmware image (<project>_ota.img).
+    -o,--output-name <file>               = output delta patch file.
+
+The patch rebuilds the new ota image from the running firmware on the device (CONFIG_OTA_DELTA).
+A compressed ota image is rebuilt uncompressed, the 'app_ota' partition must be large enough to hold it.
+The patch is not compressed, compress it for the download with bin2lzss.py (CONFIG_OTA_DECOMPRESS).
+'''
+
+def prase_argv(argv):
+    opts,args = getopt.getopt(argv[1:],'-h-v-b:-i:-o:',['help','version','base-image=','input-image=','output-name='])
+
+    global arg_base_image
+    global arg_input_image
+    global arg_output_name
+
+    for opt_name,opt_value in opts:
+        if opt_name in ('-h','--help'):
+            print(help_usage)
+            exit()
+        if opt_name in ('-v','--version'):
+            print("WinnerMicro delta patch tool, version is", my_version)
+            exit()
+        if opt_name in ('-b','--base-image'):
+            arg_base_image = opt_value
+        if opt_name in ('-i','--input-image'):
+            arg_input_image = opt_value
+        if opt_name in ('-o','--output-name'):
+            arg_output_name = opt_value
+
+    if arg_base_image is None or arg_input_image is None or arg_output_name is None:
+        print(help_usage)
+        exit(1)
+
+
+def safety_crc32(indata):
+    result = binascii.crc32(indata)
+    #for python2 add check
+    if result < 0:
+        result = result + 2 ** 32
+    return result
+
+def checksum(indata):
+    return safety_crc32(indata) ^ (0xFFFFFFFF)
+
+def check_image(data, name):
+    if len(data) < header_size or struct.unpack_from('<I', data, 0)[0] != magic_no:
+        raise ValueError("%s is not a firmware image" % name)
+    if checksum(data[:header_size - 4]) != struct.unpack_from('<I', data, header_size - 4)[0]:
+        raise ValueError("%s header checksum error" % name)
+
+def uncompress_image(data):
+    # Rebuild the ota image the device writes: same header, uncompressed payload.
+    attr = struct.unpack_from('<I', data, 4)[0]
+    img_len = struct.unpack_from('<I', data, 12)[0]
+    payload = data[header_size:header_size + img_len]
+
+    if (attr >> 20) & 0x3 == 1:
+        payload = lzma.LZMADecompressor().decompress(payload)
+    elif (attr >> 16) & 0x1:
+        raise ValueError("gzip images are not supported")
+    else:
+        return data
+
+    dummy = len(payload) % 4
+    if dummy != 0:
+        payload += bytes([0xFF] * (4 - dummy))
+
+    attr &= ~((0x1 << 16) | (0x3 << 20))
+    header = bytearray(data[:header_size])
+    struct.pack_into('<I', header, 4, attr)
+    struct.pack_into('<I', header, 12, len(payload))
+    struct.pack_into('<I', header, 24, checksum(payload))
+    struct.pack_into('<I', header, header_size - 4, checksum(bytes(header[:header_size - 4])))
+
+    return bytes(header) + payload
+
+def exact_len(old, o, new, n):
+    length = 0
+    limit = min(len(old) - o, len(new) - n)
+    while length + 64 <= limit and old[o + length:o + length + 64] == new[n + length:n + length + 64]:
+        length += 64
+    while length < limit and old[o + length] == new[n + length]:
+        length += 1
+    return length
+
+def extend_len(old, o, new, n, length):
+    # Keep going over mismatches as long as more bytes match than not, like bsdiff.
+    best = length
+    score = 0
+    best_score = 0
+    i = length
+    limit = min(len(old) - o, len(new) - n)
+    while i < limit and i - best <= match_lookahead:
+        if old[o + i] == new[n + i]:
+            score += 1
+        else:
+            score -= 1
+        i += 1
+        if score > best_score:
+            best_score = score
+            best = i
+    return best
+
+def find_matches(old, new):
+    index = {}
+    for i in range(len(old) - match_block, -1, -1):
+        index[old[i:i + match_block]] = i
+
+    matches = []
+    npos = 0
+    while npos + match_block <= len(new):
+        best_o = -1
+        best_len = 0
+
+        # Prefer carrying on at the offset of the previous match, code moves as a whole.
+        if matches:
+            pn, po, pl = matches[-1]
+            o = po + npos - pn
+            if o < len(old):
+                best_o = o
+                best_len = exact_len(old, o, new, npos)
+
+        if best_len < match_min:
+            o = index.get(new[npos:npos + match_block])
+            if o is not None:
+                length = exact_len(old, o, new, npos)
+                if length > best_len:
+                    best_o = o
+                    best_len = length
+
+        if best_len < match_min:
+            npos += 1
+            continue
+
+        best_len = extend_len(old, best_o, new, npos, best_len)
+        matches.append((npos, best_o, best_len))
+        npos += best_len
+
+    return matches
+
+def make_patch(old, new):
+    matches = find_matches(old, new)
+    body = bytearray()
+
+    # Record k adds match k-1 and copies the gap up to match k, record 0 has no diff bytes.
+    prev_n, prev_o, prev_l = 0, 0, 0
+    for n, o, l in matches + [(len(new), prev_o, 0)]:
+        diff = bytes((new[prev_n + i] - old[prev_o + i]) & 0xFF for i in range(prev_l))
+        extra = new[prev_n + prev_l:n]
+        seek = (o - (prev_o + prev_l)) if n < len(new) else 0
+        body += struct.pack('<IIi', prev_l, len(extra), seek) + diff + extra
+        prev_n, prev_o, prev_l = n, o, l
+
+    header = struct.pack('<IHHIIIII', delta_magic_no, delta_version, 0, delta_header_size + len(body),
+                         len(old), checksum(old), len(new), 0)
+    header += struct.pack('<I', checksum(header))
+
+    return header + bytes(body), len(matches)
+
+def apply_patch(old, patch):
+    # Same checks as the device, to catch a broken patch before it is released.
+    (magic, version, _, patch_size, old_size, old_crc, new_size, _) = struct.unpack_from('<IHHIIIII', patch, 0)
+    if magic != delta_magic_no or version != delta_version or patch_size != len(patch):
+        raise ValueError("invalid delta header")
+    if old_size != len(old) or old_crc != checksum(old):
+        raise ValueError("base image mismatch")
+
+    new = bytearray()
+    pos = delta_header_size
+    old_pos = 0
+    while len(new) < new_size:
+        diff_len, extra_len, seek = struct.unpack_from('<IIi', patch, pos)
+        pos += ctrl_size
+        if diff_len + extra_len > new_size - len(new) or old_pos + diff_len > old_size:
+            raise ValueError("invalid delta record")
+        new += bytes((old[old_pos + i] + patch[pos + i]) & 0xFF for i in range(diff_len))
+        pos += diff_len
+        old_pos += diff_len
+        new += patch[pos:pos + extra_len]
+        pos += extra_len
+        old_pos += seek
+        if old_pos < 0 or old_pos > old_size:
+            raise ValueError("invalid delta seek")
+    if pos != len(patch):
+        raise ValueError("trailing data in delta patch")
+
+    return bytes(new)
+
+def main(argv):
+    prase_argv(argv)
+
+    with open(arg_base_image, 'rb') as f:
+        old = f.read()
+    with open(arg_input_image, 'rb') as f:
+        new = f.read()
+
+    check_image(old, arg_base_image)
+    check_image(new, arg_input_image)
+
+    # The device reads the running image as header plus code, trailing padding is not part of it.
+    old = old[:header_size + struct.unpack_from('<I', old, 12)[0]]
+    new = uncompress_image(new)
+
+    patch, records = make_patch(old, new)
+    if apply_patch(old, patch) != new:
+        raise ValueError("delta patch verification failed")
+
+    try:
+        f_patch = open(arg_output_name, "wb+")
+    except IOError:
+        print("create %s file fail" % arg_output_name)
+        raise
+
+    f_patch.write(patch)
+    f_patch.close()
+
+    print("delta patch %s: %d bytes, %d records, rebuilds %d bytes from %d bytes"
+          % (arg_output_name, len(patch), records, len(new), len(old)))
+    exit()
+
+if __name__ == '__main__':
+    main(sys.argv)
@@ -0,0 +1,215 @@
+#!/usr/bin/python
+import sys
+import getopt
+import struct
+import binascii
+
+my_version          = "1.0.0"
+
+comp_magic_no       = 0x5A4D4D57 # "WMMZ"
+comp_version        = 1
+comp_method_lzss    = 1
+
+comp_header_size    = 32
+
+match_candidates    = 32  # earlier positions tried for each match
+
+arg_window_bits     = 12
+arg_lookahead_bits  = 5
+arg_input_binary    = None
+arg_output_name     = None
+
+help_usage = '''
+Usage:
+
+        bin2lzss.py [options]
+
+options:
+    -h,--help                             = print usage information and exit.
+    -v,--version                          = print version number and exit.
+    -i,--input-binary <file>              = ota image or delta patch to compress.
+    -o,--output-name <file>               = output compressed stream file.
+    -w,--window-bits <bits>               = window size 2^bits, must match CONFIG_OTA_DECOMPRESS_WINDOW_BITS, <8-15>.
+    -l,--lookahead-bits <bits>            = longest back reference 2^bits, less than window bits.
+
+The stream is decompressed by the device while it is downloaded (CONFIG_OTA_DECOMPRESS).
+Delta patches are mostly runs of zeros, they compress best with a long lookahead, e.g. -l 10.
+'''
+
+def prase_argv(argv):
+    opts,args = getopt.getopt(argv[1:],'-h-v-i:-o:-w:-l:',['help','version','input-binary=','output-name=','window-bits=','lookahead-bits='])
+
+    global arg_input_binary
+    global arg_output_name
+    global arg_window_bits
+    global arg_lookahead_bits
+
+    for opt_name,opt_value in opts:
+        if opt_name in ('-h','--help'):
+            print(help_usage)
+            exit()
+        if opt_name in ('-v','--version'):
+            print("WinnerMicro ota compression tool, version is", my_version)
+            exit()
+        if opt_name in ('-i','--input-binary'):
+            arg_input_binary = opt_value
+        if opt_name in ('-o','--output-name'):
+            arg_output_name = opt_value
+        if opt_name in ('-w','--window-bits'):
+            arg_window_bits = int(opt_value)
+        if opt_name in ('-l','--lookahead-bits'):
+            arg_lookahead_bits = int(opt_value)
+
+    if arg_input_binary is None or arg_output_name is None:
+        print(help_usage)
+        exit(1)
+    if arg_window_bits < 8 or arg_window_bits > 15 or arg_lookahead_bits < 1 or arg_lookahead_bits >= arg_window_bits:
+        print("invalid window or lookahead bits")
+        exit(1)
+
+
+def safety_crc32(indata):
+    result = binascii.crc32(indata)
+    #for python2 add check
+    if result < 0:
+        result = result + 2 ** 32
+    return result
+
+def checksum(indata):
+    return safety_crc32(indata) ^ (0xFFFFFFFF)
+
+class bit_writer:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.cnt = 0
+
+    def put(self, value, bits):
+        self.acc = (self.acc << bits) | value
+        self.cnt += bits
+        while self.cnt >= 8:
+            self.cnt -= 8
+            self.out.append((self.acc >> self.cnt) & 0xFF)
+        self.acc &= (1 << self.cnt) - 1
+
+    def flush(self):
+        # Padding bits are never a whole literal or back reference.
+        if self.cnt:
+            self.out.append((self.acc << (8 - self.cnt)) & 0xFF)
+            self.cnt = 0
+        return bytes(self.out)
+
+def compress(data, window_bits, lookahead_bits):
+    # LZSS in the heatshrink bit format, most significant bit first.
+    window = 1 << window_bits
+    max_count = 1 << lookahead_bits
+    ref_bits = 1 + window_bits + lookahead_bits
+    min_count = ref_bits // 9 + 1
+    heads = {}
+    bw = bit_writer()
+
+    def insert(pos):
+        key = data[pos:pos + 3]
+        chain = heads.get(key)
+        if chain is None:
+            heads[key] = [pos]
+        else:
+            chain.append(pos)
+            if len(chain) > 2 * match_candidates:
+                del chain[:match_candidates]
+
+    i = 0
+    n = len(data)
+    while i < n:
+        best_len = 0
+        best_dist = 0
+        limit = min(max_count, n - i)
+        chain = heads.get(data[i:i + 3]) if limit >= 3 else None
+        if chain:
+            for p in reversed(chain[-match_candidates:]):
+                if i - p > window:
+                    break
+                length = 0
+                while length < limit and data[p + length] == data[i + length]:
+                    length += 1
+                if length > best_len:
+                    best_len = length
+                    best_dist = i - p
+                    if length == limit:
+                        break
+
+        if best_len >= min_count:
+            bw.put(0, 1)
+            bw.put(best_dist - 1, window_bits)
+            bw.put(best_len - 1, lookahead_bits)
+            for k in range(i, i + best_len):
+                insert(k)
+            i += best_len
+        else:
+            bw.put(1, 1)
+            bw.put(data[i], 8)
+            insert(i)
+            i += 1
+
+    return bw.flush()
+
+def decompress(comp, window_bits, lookahead_bits, orig_size):
+    # Same decoding as the device, to catch a broken stream before it is released.
+    window = 1 << window_bits
+    out = bytearray()
+    acc = 0
+    cnt = 0
+    pos = 0
+    while len(out) < orig_size:
+        need = 9
+        while True:
+            if cnt >= 1:
+                need = 9 if (acc >> (cnt - 1)) & 1 else 1 + window_bits + lookahead_bits
+                if cnt >= need:
+                    break
+            if pos >= len(comp):
+                raise ValueError("truncated compressed stream")
+            acc = (acc << 8) | comp[pos]
+            cnt += 8
+            pos += 1
+        cnt -= need
+        if need == 9:
+            out.append((acc >> cnt) & 0xFF)
+        else:
+            index = (acc >> (cnt + lookahead_bits)) & (window - 1)
+            count = ((acc >> cnt) & ((1 << lookahead_bits) - 1)) + 1
+            for k in range(count):
+                src = len(out) - index - 1
+                out.append(out[src] if src >= 0 else 0)
+        acc &= (1 << cnt) - 1
+    return bytes(out[:orig_size])
+
+def main(argv):
+    prase_argv(argv)
+
+    with open(arg_input_binary, 'rb') as f:
+        data = f.read()
+
+    comp = compress(data, arg_window_bits, arg_lookahead_bits)
+    if decompress(comp, arg_window_bits, arg_lookahead_bits, len(data)) != data:
+        raise ValueError("compressed stream verification failed")
+
+    header = struct.pack('<IBBBBIIIII', comp_magic_no, comp_version, comp_method_lzss, arg_window_bits,
+                         arg_lookahead_bits, comp_header_size + len(comp), len(data), 0, 0, 0)
+    header += struct.pack('<I', checksum(header))
+
+    try:
+        f_out = open(arg_output_name, "wb+")
+    except IOError:
+        print("create %s file fail" % arg_output_name)
+        raise
+
+    f_out.write(header)
+    f_out.write(comp)
+    f_out.close()
+
+    print("compressed stream %s: %d bytes from %d bytes" % (arg_output_name, len(header) + len(comp), len(data)))
+    exit()
+
+if __name__ == '__main__':
+    main(sys.argv)